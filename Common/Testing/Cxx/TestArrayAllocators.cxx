@@ -0,0 +1,248 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestArrayAllocators.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME
+// .SECTION Description
+// Fills data arrays and id lists through each array allocator, checks
+// their contents and the allocator counters, and reports the time taken
+// to create, fill and delete many small arrays with each allocator.
+// Also fills arrays from several threads while another thread keeps
+// replacing the global allocator.
+
+#include "vtkArenaArrayAllocator.h"
+#include "vtkArrayAllocator.h"
+#include "vtkDoubleArray.h"
+#include "vtkIdList.h"
+#include "vtkIntArray.h"
+#include "vtkMultiThreader.h"
+#include "vtkPoolArrayAllocator.h"
+#include "vtkSmartPointer.h"
+#include "vtkTestUtilities.h"
+#include "vtkTimerLog.h"
+
+// Fill arrays and id lists through the given allocator (NULL means the
+// global allocator) and check their contents.
+static int FillArrays(vtkArrayAllocator *allocator, int numberOfValues)
+{
+  vtkIntArray *ints = vtkIntArray::New();
+  vtkDoubleArray *doubles = vtkDoubleArray::New();
+  vtkIdList *ids = vtkIdList::New();
+  ints->SetAllocator(allocator);
+  doubles->SetAllocator(allocator);
+  ids->SetAllocator(allocator);
+  doubles->SetNumberOfComponents(3);
+
+  int i;
+  for (i = 0; i < numberOfValues; i++)
+    {
+    ints->InsertNextValue(i);
+    doubles->InsertNextTuple3(i, 2*i, 3*i);
+    ids->InsertNextId(i);
+    }
+  // Shrink, copy and reallocate as well.
+  ints->Squeeze();
+  vtkIntArray *copy = vtkIntArray::New();
+  copy->SetAllocator(allocator);
+  copy->DeepCopy(ints);
+  copy->Resize(2*numberOfValues);
+  vtkIdList *idsCopy = vtkIdList::New();
+  idsCopy->SetAllocator(allocator);
+  idsCopy->DeepCopy(ids);
+
+  int ok = 1;
+  for (i = 0; i < numberOfValues && ok; i++)
+    {
+    ok = (ints->GetValue(i) == i && copy->GetValue(i) == i &&
+          doubles->GetComponent(i, 2) == 3*i &&
+          ids->GetId(i) == i && idsCopy->GetId(i) == i);
+    }
+
+  ints->Delete();
+  doubles->Delete();
+  ids->Delete();
+  copy->Delete();
+  idsCopy->Delete();
+
+  if (!ok)
+    {
+    cerr << "Wrong array contents with "
+         << (allocator ? allocator->GetClassName() : "the global allocator")
+         << endl;
+    }
+  return ok;
+}
+
+static int CheckAllocator(vtkArrayAllocator *allocator)
+{
+  const char *name = allocator->GetClassName();
+  if (!FillArrays(allocator, 10) || !FillArrays(allocator, 100000))
+    {
+    return 0;
+    }
+  if (allocator->GetBytesInUse() != 0)
+    {
+    cerr << name << ": " << allocator->GetBytesInUse()
+         << " bytes still in use" << endl;
+    return 0;
+    }
+  if (allocator->GetNumberOfAllocations() == 0 ||
+      allocator->GetBytesAllocated() == 0)
+    {
+    cerr << name << ": the allocator was not used" << endl;
+    return 0;
+    }
+
+  // The second round can reuse the memory of the first one.
+  allocator->ResetCounters();
+  if (!FillArrays(allocator, 10) || !FillArrays(allocator, 100000))
+    {
+    return 0;
+    }
+  cout << name << ": " << allocator->GetNumberOfAllocations()
+       << " allocations, " << allocator->GetBytesAllocated()
+       << " bytes allocated, " << allocator->GetBytesReused()
+       << " bytes reused" << endl;
+  if (allocator->IsA("vtkPoolArrayAllocator") &&
+      allocator->GetBytesReused() == 0)
+    {
+    cerr << name << ": no memory was reused" << endl;
+    return 0;
+    }
+
+  allocator->ReleaseCachedMemory();
+  return 1;
+}
+
+// Time the creation, filling and deletion of many small arrays.
+static double TimeSmallArrays(vtkArrayAllocator *allocator)
+{
+  vtkArrayAllocator::SetGlobalAllocator(allocator);
+  vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+  timer->StartTimer();
+  for (int n = 0; n < 20000; n++)
+    {
+    vtkIdList *ids = vtkIdList::New();
+    vtkDoubleArray *values = vtkDoubleArray::New();
+    for (int i = 0; i < 64; i++)
+      {
+      ids->InsertNextId(i);
+      values->InsertNextValue(i);
+      }
+    ids->Delete();
+    values->Delete();
+    }
+  timer->StopTimer();
+  vtkArrayAllocator::SetGlobalAllocator(0);
+  return timer->GetElapsedTime();
+}
+
+// Thread 0 replaces the global allocator with new ones, which only the
+// global reference and the arrays allocated from them keep alive. The
+// other threads fill arrays through the global allocator meanwhile.
+static VTK_THREAD_RETURN_TYPE ReplaceOrFill(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *info =
+    static_cast<vtkMultiThreader::ThreadInfo *>(arg);
+  int *status = static_cast<int *>(info->UserData);
+  for (int i = 0; i < 200; i++)
+    {
+    if (info->ThreadID == 0)
+      {
+      vtkPoolArrayAllocator *pool = vtkPoolArrayAllocator::New();
+      vtkArrayAllocator::SetGlobalAllocator(pool);
+      pool->Delete();
+      }
+    else if (!FillArrays(0, 100))
+      {
+      status[info->ThreadID] = 0;
+      }
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+int TestArrayAllocators(int, char *[])
+{
+  vtkSmartPointer<vtkArrayAllocator> mallocAllocator =
+    vtkSmartPointer<vtkArrayAllocator>::New();
+  vtkSmartPointer<vtkPoolArrayAllocator> pool =
+    vtkSmartPointer<vtkPoolArrayAllocator>::New();
+  vtkSmartPointer<vtkArenaArrayAllocator> arena =
+    vtkSmartPointer<vtkArenaArrayAllocator>::New();
+  arena->SetChunkSize(64*1024);
+
+  if (!CheckAllocator(mallocAllocator) || !CheckAllocator(pool) ||
+      !CheckAllocator(arena))
+    {
+    return 1;
+    }
+  if (pool->GetCachedBytes() != 0 || arena->GetNumberOfChunks() != 0)
+    {
+    cerr << "ReleaseCachedMemory did not release everything" << endl;
+    return 1;
+    }
+
+  // Through the global allocator.
+  vtkArrayAllocator::SetGlobalAllocator(pool);
+  int ok = FillArrays(0, 1000);
+  vtkArrayAllocator::SetGlobalAllocator(0);
+  if (!ok || pool->GetNumberOfAllocations() == 0 ||
+      pool->GetBytesInUse() != 0)
+    {
+    cerr << "The global allocator was not used" << endl;
+    return 1;
+    }
+
+  // Replace the global allocator while other threads allocate from it.
+  int threads = vtkTestUtilities::SetUpThreadPool(4);
+  int status[VTK_MAX_THREADS];
+  for (int i = 0; i < threads; i++)
+    {
+    status[i] = 1;
+    }
+  vtkSmartPointer<vtkMultiThreader> threader =
+    vtkSmartPointer<vtkMultiThreader>::New();
+  threader->SetNumberOfThreads(threads);
+  threader->SetSingleMethod(ReplaceOrFill, status);
+  threader->SingleMethodExecute();
+  vtkArrayAllocator::SetGlobalAllocator(0);
+  for (int i = 0; i < threads; i++)
+    {
+    if (!status[i])
+      {
+      cerr << "Wrong contents while replacing the global allocator" << endl;
+      return 1;
+      }
+    }
+
+  // An array keeps the allocator that allocated its memory.
+  vtkIntArray *array = vtkIntArray::New();
+  array->SetAllocator(arena);
+  array->SetNumberOfValues(100);
+  array->SetAllocator(pool);
+  array->SetNumberOfValues(200);
+  array->Delete();
+  if (arena->GetBytesInUse() != 0 || pool->GetBytesInUse() != 0)
+    {
+    cerr << "Memory was not released by its allocator" << endl;
+    return 1;
+    }
+
+  cout << "Small arrays with malloc: " << TimeSmallArrays(0) << " s" << endl;
+  cout << "Small arrays with the pool: " << TimeSmallArrays(pool) << " s"
+       << endl;
+  cout << "Small arrays with the arena: " << TimeSmallArrays(arena) << " s"
+       << endl;
+
+  return 0;
+}
@@ -0,0 +1,141 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestDataArrayAlignment.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME
+// .SECTION Description
+// Checks that data arrays given an alignment keep their storage aligned
+// through allocation, growth, squeezing and deep copies, with and without
+// an array allocator, and that the storage is released correctly.
+
+#include "vtkDoubleArray.h"
+#include "vtkFloatArray.h"
+#include "vtkPoolArrayAllocator.h"
+#include "vtkSmartPointer.h"
+#include "vtkUnsignedCharArray.h"
+
+#define CHECK(cond, msg) \
+  if (!(cond)) { cerr << msg << endl; return 0; }
+
+// Grow, squeeze and copy an array, checking its alignment and contents.
+static int CheckArray(vtkDataArray *array, int alignment)
+{
+  int i;
+  for (i = 0; i < 1000; i++)
+    {
+    array->InsertNextTuple1(i % 100);
+    CHECK(array->IsAligned(alignment),
+          array->GetClassName() << " not aligned after insertion " << i);
+    }
+  array->Squeeze();
+  CHECK(array->IsAligned(alignment),
+        array->GetClassName() << " not aligned after Squeeze");
+
+  vtkDataArray *copy = array->NewInstance();
+  copy->SetAlignment(array->GetAlignment());
+  copy->DeepCopy(array);
+  int copyAligned = copy->IsAligned(alignment);
+  copy->Allocate(5000);
+  int allocateAligned = copy->IsAligned(alignment);
+  copy->Delete();
+  CHECK(copyAligned, array->GetClassName() << " copy not aligned");
+  CHECK(allocateAligned,
+        array->GetClassName() << " not aligned after Allocate");
+
+  for (i = 0; i < 1000; i++)
+    {
+    CHECK(array->GetTuple1(i) == i % 100,
+          array->GetClassName() << " has a wrong value at " << i);
+    }
+  return 1;
+}
+
+static int CheckArrays(int alignment)
+{
+  vtkSmartPointer<vtkFloatArray> floats = vtkSmartPointer<vtkFloatArray>::New();
+  vtkSmartPointer<vtkDoubleArray> doubles =
+    vtkSmartPointer<vtkDoubleArray>::New();
+  vtkSmartPointer<vtkUnsignedCharArray> chars =
+    vtkSmartPointer<vtkUnsignedCharArray>::New();
+  return CheckArray(floats, alignment) && CheckArray(doubles, alignment) &&
+    CheckArray(chars, alignment);
+}
+
+int TestDataArrayAlignment(int, char *[])
+{
+  // Per-array alignment.
+  vtkSmartPointer<vtkFloatArray> floats = vtkSmartPointer<vtkFloatArray>::New();
+  floats->SetAlignment(64);
+  if (!CheckArray(floats, 64))
+    {
+    return 1;
+    }
+
+  // Invalid alignments are refused.
+  floats->SetAlignment(48);
+  if (floats->GetAlignment() != 64)
+    {
+    cerr << "An alignment that is not a power of two was accepted" << endl;
+    return 1;
+    }
+
+  // Global alignment, with malloc and with an allocator.
+  vtkDataArray::SetGlobalAlignment(32);
+  int ok = CheckArrays(32);
+  vtkSmartPointer<vtkPoolArrayAllocator> pool =
+    vtkSmartPointer<vtkPoolArrayAllocator>::New();
+  vtkArrayAllocator::SetGlobalAllocator(pool);
+  vtkDataArray::SetGlobalAlignment(64);
+  ok = ok && CheckArrays(64);
+  vtkArrayAllocator::SetGlobalAllocator(0);
+  vtkDataArray::SetGlobalAlignment(0);
+  if (!ok)
+    {
+    return 1;
+    }
+  if (pool->GetNumberOfAllocations() == 0 || pool->GetBytesInUse() != 0)
+    {
+    cerr << "Aligned storage was not released to the allocator" << endl;
+    return 1;
+    }
+
+  // Storage set by the user is used as is, and an aligned array moved to
+  // unaligned storage releases its aligned block.
+  static double values[3] = { 1.0, 2.0, 3.0 };
+  vtkSmartPointer<vtkDoubleArray> user = vtkSmartPointer<vtkDoubleArray>::New();
+  user->SetAlignment(32);
+  user->SetNumberOfValues(10);
+  user->SetArray(values, 3, 1);
+  if (user->GetPointer(0) != values || user->IsAligned(1) != 1)
+    {
+    cerr << "User storage was not used" << endl;
+    return 1;
+    }
+  user->InsertNextValue(4.0);
+  if (!user->IsAligned(32) || user->GetValue(2) != 3.0 ||
+      user->GetValue(3) != 4.0)
+    {
+    cerr << "User storage was not copied to aligned storage" << endl;
+    return 1;
+    }
+
+  vtkSmartPointer<vtkDoubleArray> empty =
+    vtkSmartPointer<vtkDoubleArray>::New();
+  if (empty->IsAligned(16))
+    {
+    cerr << "An array without storage reported aligned storage" << endl;
+    return 1;
+    }
+
+  return 0;
+}
@@ -0,0 +1,191 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestFunctionParser.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME
+// .SECTION Description
+// Checks that vtkFunctionParser::EvaluateBlock gives the same results as
+// the tuple-by-tuple evaluation, and reports the time taken by both.
+
+#include "vtkFunctionParser.h"
+#include "vtkMath.h"
+#include "vtkSmartPointer.h"
+#include "vtkTimerLog.h"
+
+#include <vtkstd/vector>
+
+static const char *TestFunctions[] = {
+  "A*B + C/2.5 - sin(A)",
+  "sqrt(abs(A)) + exp(-B*B) - ln(abs(C) + 1)",
+  "if(A > B, A, B) + min(A, C) - max(B, C)",
+  "V + W",
+  "A*V - W*B",
+  "cross(V, W)",
+  "norm(V) + mag(W)*iHat",
+  "V.W + mag(V)",
+  "if(A < 0 | B > 0.5, V, W)",
+  "-V + jHat - kHat",
+  "ln(A)",
+  NULL
+};
+
+// Evaluate the current function of parser for all tuples by setting the
+// variables one tuple at a time.
+static bool EvaluateTuples(vtkFunctionParser *parser, vtkIdType numTuples,
+                           const double *a, const double *b, const double *c,
+                           const double *v, const double *w,
+                           double *result)
+{
+  for (vtkIdType i = 0; i < numTuples; i++)
+    {
+    parser->SetScalarVariableValue(0, a[i]);
+    parser->SetScalarVariableValue(1, b[i]);
+    parser->SetScalarVariableValue(2, c[i]);
+    parser->SetVectorVariableValue(0, v[3*i], v[3*i+1], v[3*i+2]);
+    parser->SetVectorVariableValue(1, w[3*i], w[3*i+1], w[3*i+2]);
+    if (parser->IsScalarResult())
+      {
+      result[i] = parser->GetScalarResult();
+      }
+    else if (parser->IsVectorResult())
+      {
+      parser->GetVectorResult(result + 3*i);
+      }
+    else
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+int TestFunctionParser(int, char *[])
+{
+  const vtkIdType numTuples = 20000;
+  vtkIdType i;
+  int f, comp;
+
+  // Scalar inputs a, b, c and vector inputs v, w, in both interleaved
+  // and component-planar layouts.
+  vtkstd::vector<double> scalars(3*numTuples);
+  vtkstd::vector<double> vectors(6*numTuples);
+  vtkstd::vector<double> planar(6*numTuples);
+  vtkMath::RandomSeed(4321);
+  for (i = 0; i < 3*numTuples; i++)
+    {
+    scalars[i] = vtkMath::Random(-2.0, 2.0);
+    }
+  for (i = 0; i < 6*numTuples; i++)
+    {
+    vectors[i] = vtkMath::Random(-2.0, 2.0);
+    }
+  for (i = 0; i < numTuples; i++)
+    {
+    for (comp = 0; comp < 3; comp++)
+      {
+      planar[comp*numTuples + i] = vectors[3*i + comp];
+      planar[(3 + comp)*numTuples + i] = vectors[3*(numTuples + i) + comp];
+      }
+    }
+  const double *a = &scalars[0];
+  const double *b = a + numTuples;
+  const double *c = b + numTuples;
+  const double *v = &vectors[0];
+  const double *w = v + 3*numTuples;
+  const double *scalarValues[3] = { a, b, c };
+  const double *vectorValues[6];
+  for (comp = 0; comp < 6; comp++)
+    {
+    vectorValues[comp] = &planar[comp*numTuples];
+    }
+
+  vtkSmartPointer<vtkFunctionParser> parser =
+    vtkSmartPointer<vtkFunctionParser>::New();
+  parser->SetScalarVariableValue("A", 0.0);
+  parser->SetScalarVariableValue("B", 0.0);
+  parser->SetScalarVariableValue("C", 0.0);
+  parser->SetVectorVariableValue("V", 0.0, 0.0, 0.0);
+  parser->SetVectorVariableValue("W", 0.0, 0.0, 0.0);
+  parser->SetReplaceInvalidValues(1);
+  parser->SetReplacementValue(-1.0);
+
+  vtkstd::vector<double> expected(3*numTuples);
+  vtkstd::vector<double> result(3*numTuples);
+  vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+  double tupleTime = 0.0;
+  double blockTime = 0.0;
+
+  for (f = 0; TestFunctions[f]; f++)
+    {
+    parser->SetFunction(TestFunctions[f]);
+
+    timer->StartTimer();
+    if (!EvaluateTuples(parser, numTuples, a, b, c, v, w, &expected[0]))
+      {
+      cerr << "Could not evaluate " << TestFunctions[f] << endl;
+      return 1;
+      }
+    timer->StopTimer();
+    tupleTime += timer->GetElapsedTime();
+
+    int numComps = parser->GetNumberOfResultComponents();
+    if (numComps != (parser->IsScalarResult() ? 1 : 3))
+      {
+      cerr << "Wrong number of result components for "
+           << TestFunctions[f] << ": " << numComps << endl;
+      return 1;
+      }
+
+    timer->StartTimer();
+    if (!parser->EvaluateBlock(numTuples, scalarValues, vectorValues,
+                               &result[0]))
+      {
+      cerr << "EvaluateBlock failed for " << TestFunctions[f] << endl;
+      return 1;
+      }
+    timer->StopTimer();
+    blockTime += timer->GetElapsedTime();
+
+    for (i = 0; i < numComps*numTuples; i++)
+      {
+      if (result[i] != expected[i])
+        {
+        cerr << "Mismatch for " << TestFunctions[f] << " at value " << i
+             << ": " << result[i] << " != " << expected[i] << endl;
+        return 1;
+        }
+      }
+    }
+
+  // Without replacement, invalid values make the block evaluation fail.
+  parser->SetReplaceInvalidValues(0);
+  parser->SetFunction("sqrt(A)");
+  parser->SetScalarVariableValue(0, 1.0);
+  if (!parser->IsScalarResult())
+    {
+    cerr << "sqrt(A) should be a scalar function" << endl;
+    return 1;
+    }
+  cout << "Expecting an error about a negative square root:" << endl;
+  if (parser->EvaluateBlock(numTuples, scalarValues, vectorValues,
+                            &result[0]))
+    {
+    cerr << "EvaluateBlock should fail on invalid values" << endl;
+    return 1;
+    }
+
+  cout << "Tuple-by-tuple evaluation: " << tupleTime << " s" << endl;
+  cout << "Block evaluation: " << blockTime << " s" << endl;
+
+  return 0;
+}
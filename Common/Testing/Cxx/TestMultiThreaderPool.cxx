@@ -0,0 +1,238 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestMultiThreaderPool.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME
+// .SECTION Description
+// Checks that vtkMultiThreader runs every piece exactly once when it uses
+// the thread pool, including nested executions, and compares the cost of
+// executions with and without the pool.
+
+#include "vtkMultiThreader.h"
+#include "vtkMutexLock.h"
+#include "vtkSmartPointer.h"
+#include "vtkTimerLog.h"
+
+#include <vtkstd/vector>
+
+struct vtkPoolTestData
+{
+  vtkMutexLock *Lock;
+  vtkstd::vector<int> Counts;
+  int NumberOfThreadsSeen;
+  int Nested;
+  int Active;
+  int MaxActive;
+};
+
+static VTK_THREAD_RETURN_TYPE vtkPoolTestPiece(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *info =
+    static_cast<vtkMultiThreader::ThreadInfo *>(arg);
+  vtkPoolTestData *data = static_cast<vtkPoolTestData *>(info->UserData);
+
+  data->Lock->Lock();
+  data->Counts[info->ThreadID]++;
+  data->NumberOfThreadsSeen = info->NumberOfThreads;
+  data->Lock->Unlock();
+
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+// Records how many pieces run at the same time.
+static VTK_THREAD_RETURN_TYPE vtkPoolTestActivePiece(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *info =
+    static_cast<vtkMultiThreader::ThreadInfo *>(arg);
+  vtkPoolTestData *data = static_cast<vtkPoolTestData *>(info->UserData);
+
+  data->Lock->Lock();
+  data->Counts[info->ThreadID]++;
+  data->NumberOfThreadsSeen = info->NumberOfThreads;
+  if (++data->Active > data->MaxActive)
+    {
+    data->MaxActive = data->Active;
+    }
+  data->Lock->Unlock();
+
+  volatile double sum = 0.0;
+  for (int i = 0; i < 100000; i++)
+    {
+    sum += i;
+    }
+
+  data->Lock->Lock();
+  data->Active--;
+  data->Lock->Unlock();
+
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+static VTK_THREAD_RETURN_TYPE vtkPoolTestNestedPiece(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *info =
+    static_cast<vtkMultiThreader::ThreadInfo *>(arg);
+  vtkPoolTestData *data = static_cast<vtkPoolTestData *>(info->UserData);
+
+  // Each piece submits its own job to the pool.
+  vtkPoolTestData nested;
+  nested.Lock = data->Lock;
+  nested.Counts.resize(8, 0);
+  nested.NumberOfThreadsSeen = 0;
+  vtkSmartPointer<vtkMultiThreader> threader =
+    vtkSmartPointer<vtkMultiThreader>::New();
+  threader->UseThreadPoolOn();
+  threader->SetNumberOfPieces(8);
+  threader->SetSingleMethod(vtkPoolTestPiece, &nested);
+  threader->SingleMethodExecute();
+
+  int ok = 1;
+  for (int i = 0; i < 8; i++)
+    {
+    ok = ok && (nested.Counts[i] == 1);
+    }
+
+  data->Lock->Lock();
+  data->Counts[info->ThreadID]++;
+  data->NumberOfThreadsSeen = info->NumberOfThreads;
+  data->Nested += ok;
+  data->Lock->Unlock();
+
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+static int vtkPoolTestCheck(vtkPoolTestData &data, int expectedThreads,
+                            const char *name)
+{
+  for (size_t i = 0; i < data.Counts.size(); i++)
+    {
+    if (data.Counts[i] != 1)
+      {
+      cerr << name << ": piece " << i << " ran " << data.Counts[i]
+           << " times" << endl;
+      return 0;
+      }
+    }
+  if (data.NumberOfThreadsSeen != expectedThreads)
+    {
+    cerr << name << ": NumberOfThreads is " << data.NumberOfThreadsSeen
+         << " instead of " << expectedThreads << endl;
+    return 0;
+    }
+  return 1;
+}
+
+int TestMultiThreaderPool(int, char *[])
+{
+  // Make sure the pool has workers even on a single processor machine.
+  vtkMultiThreader::SetGlobalDefaultNumberOfThreads(4);
+
+  vtkSmartPointer<vtkMutexLock> lock = vtkSmartPointer<vtkMutexLock>::New();
+  vtkSmartPointer<vtkMultiThreader> threader =
+    vtkSmartPointer<vtkMultiThreader>::New();
+  threader->SetNumberOfThreads(4);
+  threader->UseThreadPoolOn();
+  vtkPoolTestData data;
+  data.Lock = lock;
+  data.Nested = 0;
+  data.Active = 0;
+  data.MaxActive = 0;
+  int i;
+
+  // More pieces than threads.
+  data.Counts.assign(1000, 0);
+  threader->SetNumberOfPieces(1000);
+  threader->SetSingleMethod(vtkPoolTestPiece, &data);
+  threader->SingleMethodExecute();
+  if (!vtkPoolTestCheck(data, 1000, "SingleMethodExecute"))
+    {
+    return 1;
+    }
+
+  // NumberOfPieces defaults to NumberOfThreads.
+  data.Counts.assign(4, 0);
+  threader->SetNumberOfPieces(0);
+  threader->SingleMethodExecute();
+  if (!vtkPoolTestCheck(data, 4, "SingleMethodExecute with 0 pieces"))
+    {
+    return 1;
+    }
+
+  data.Counts.assign(4, 0);
+  for (i = 0; i < 4; i++)
+    {
+    threader->SetMultipleMethod(i, vtkPoolTestPiece, &data);
+    }
+  threader->MultipleMethodExecute();
+  if (!vtkPoolTestCheck(data, 4, "MultipleMethodExecute"))
+    {
+    return 1;
+    }
+
+  data.Counts.assign(16, 0);
+  threader->SetNumberOfPieces(16);
+  threader->SetSingleMethod(vtkPoolTestNestedPiece, &data);
+  threader->SingleMethodExecute();
+  if (!vtkPoolTestCheck(data, 16, "Nested SingleMethodExecute") ||
+      data.Nested != 16)
+    {
+    cerr << "Nested executions did not run all their pieces" << endl;
+    return 1;
+    }
+
+  // An execution runs on at most NumberOfThreads threads of the pool.
+  data.Counts.assign(64, 0);
+  threader->SetNumberOfThreads(2);
+  threader->SetNumberOfPieces(64);
+  threader->SetSingleMethod(vtkPoolTestActivePiece, &data);
+  threader->SingleMethodExecute();
+  threader->SetNumberOfThreads(4);
+  if (!vtkPoolTestCheck(data, 64, "SingleMethodExecute on 2 threads"))
+    {
+    return 1;
+    }
+  if (data.MaxActive > 2)
+    {
+    cerr << data.MaxActive << " pieces ran at once on 2 threads" << endl;
+    return 1;
+    }
+
+  cout << "Thread pool threads: "
+       << vtkMultiThreader::GetNumberOfThreadPoolThreads() << endl;
+
+  // Compare the overhead of many small executions.
+  const int numberOfExecutions = 200;
+  vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+  threader->SetNumberOfPieces(0);
+  threader->SetSingleMethod(vtkPoolTestPiece, &data);
+  for (int usePool = 0; usePool < 2; usePool++)
+    {
+    threader->SetUseThreadPool(usePool);
+    timer->StartTimer();
+    for (i = 0; i < numberOfExecutions; i++)
+      {
+      data.Counts.assign(4, 0);
+      threader->SingleMethodExecute();
+      }
+    timer->StopTimer();
+    if (!vtkPoolTestCheck(data, 4, "Timing"))
+      {
+      return 1;
+      }
+    cout << numberOfExecutions << " executions "
+         << (usePool ? "with" : "without") << " the thread pool: "
+         << timer->GetElapsedTime() << " s" << endl;
+    }
+
+  return 0;
+}
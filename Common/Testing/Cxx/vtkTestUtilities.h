@@ -18,10 +18,13 @@
 // These include getting a command line argument or an environment variable,
 // or a default value. Particularly, there are specialized methods to get the
 // root directory for VTK Data, expanding a filename with this root directory.
+// It also sets up the vtkMultiThreader thread pool for the tests of
+// multithreaded code.
 
 #ifndef __vtkTestUtilities_h
 #define __vtkTestUtilities_h
 
+#include "vtkMultiThreader.h"
 #include "vtkSystemIncludes.h"
 
 #if defined( _MSC_VER )      /* Visual C++ (and Intel C++) */
@@ -66,6 +69,14 @@ struct vtkTestUtilities
                                                           const char* def, 
                                                           const char* fname,
                                                           int slash = 0);
+
+  // Description:
+  // Make sure the process-wide thread pool of vtkMultiThreader gets at least
+  // the given number of threads, so that multithreaded code really runs
+  // concurrently even on machines with fewer processors. Call it before
+  // anything uses the pool. Returns the default number of threads, which
+  // is the number to give to the code under test.
+  static inline int SetUpThreadPool(int minimumNumberOfThreads);
 };
 
 inline
@@ -176,4 +187,15 @@ char* vtkTestUtilities::ExpandFileNameWithArgOrEnvOrDefault(const char* arg,
   return fullName;
 }
 
+inline
+int vtkTestUtilities::SetUpThreadPool(int minimumNumberOfThreads)
+{
+  if (vtkMultiThreader::GetGlobalDefaultNumberOfThreads() <
+      minimumNumberOfThreads)
+    {
+    vtkMultiThreader::SetGlobalDefaultNumberOfThreads(minimumNumberOfThreads);
+    }
+  return vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+}
+
 #endif // __vtkTestUtilities_h
@@ -0,0 +1,290 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkArenaArrayAllocator.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkArenaArrayAllocator.h"
+
+#include "vtkCriticalSection.h"
+#include "vtkObjectFactory.h"
+
+#include <vtkstd/vector>
+
+vtkStandardNewMacro(vtkArenaArrayAllocator);
+
+struct vtkArenaArrayAllocatorChunk
+{
+  char *Data;
+  size_t Size;
+  size_t Used;      // offset of the first free byte
+  size_t HighWater; // largest value Used ever had
+  size_t LastBlock; // offset of the last block handed out
+  int NumberOfBlocks;
+};
+
+// Every block starts with a header pointing to its chunk. The header
+// keeps the data as aligned as malloc() does.
+union vtkArenaArrayAllocatorHeader
+{
+  vtkArenaArrayAllocatorChunk *Chunk; // NULL for blocks not in a chunk
+  double Align[2];
+};
+
+class vtkArenaArrayAllocatorInternals
+{
+public:
+  vtkArenaArrayAllocatorChunk *Current;
+  vtkstd::vector<vtkArenaArrayAllocatorChunk *> FreeChunks;
+  vtkIdType NumberOfChunks;
+
+  // Room taken in a chunk by a block of the given size.
+  static size_t BlockSize(size_t size)
+    {
+    const size_t align = sizeof(vtkArenaArrayAllocatorHeader);
+    return align + (size + align - 1)/align*align;
+    }
+};
+
+//----------------------------------------------------------------------------
+vtkArenaArrayAllocator::vtkArenaArrayAllocator()
+{
+  this->ChunkSize = 4*1024*1024;
+  this->Internals = new vtkArenaArrayAllocatorInternals;
+  this->Internals->Current = 0;
+  this->Internals->NumberOfChunks = 0;
+}
+
+//----------------------------------------------------------------------------
+vtkArenaArrayAllocator::~vtkArenaArrayAllocator()
+{
+  this->ReleaseCachedMemory();
+  delete this->Internals;
+}
+
+//----------------------------------------------------------------------------
+void *vtkArenaArrayAllocator::Allocate(size_t size)
+{
+  vtkArenaArrayAllocatorHeader *header;
+  size_t chunkSize = static_cast<size_t>(this->ChunkSize);
+
+  // Large blocks get their own memory.
+  if (size > chunkSize/4)
+    {
+    header = static_cast<vtkArenaArrayAllocatorHeader *>(
+      malloc(sizeof(vtkArenaArrayAllocatorHeader) + size));
+    if (!header)
+      {
+      return 0;
+      }
+    header->Chunk = 0;
+    this->Lock->Lock();
+    this->CountAllocation(size, 0);
+    this->Lock->Unlock();
+    return header + 1;
+    }
+
+  size_t blockSize = vtkArenaArrayAllocatorInternals::BlockSize(size);
+
+  this->Lock->Lock();
+  vtkArenaArrayAllocatorChunk *chunk = this->Internals->Current;
+  if (!chunk || chunk->Used + blockSize > chunk->Size)
+    {
+    // Switch to a free chunk, or to a new one.
+    if (!this->Internals->FreeChunks.empty())
+      {
+      chunk = this->Internals->FreeChunks.back();
+      this->Internals->FreeChunks.pop_back();
+      }
+    else
+      {
+      chunk = new vtkArenaArrayAllocatorChunk;
+      chunk->Data = static_cast<char *>(malloc(chunkSize));
+      if (!chunk->Data)
+        {
+        delete chunk;
+        this->Lock->Unlock();
+        return 0;
+        }
+      chunk->Size = chunkSize;
+      chunk->Used = 0;
+      chunk->HighWater = 0;
+      chunk->LastBlock = 0;
+      chunk->NumberOfBlocks = 0;
+      this->Internals->NumberOfChunks++;
+      }
+
+    // The previous chunk is freed when its last block is, unless that
+    // already happened.
+    vtkArenaArrayAllocatorChunk *previous = this->Internals->Current;
+    if (previous && previous->NumberOfBlocks == 0)
+      {
+      this->Internals->FreeChunks.push_back(previous);
+      }
+    this->Internals->Current = chunk;
+    }
+
+  header =
+    reinterpret_cast<vtkArenaArrayAllocatorHeader *>(chunk->Data + chunk->Used);
+  header->Chunk = chunk;
+  chunk->LastBlock = chunk->Used;
+  chunk->Used += blockSize;
+  chunk->NumberOfBlocks++;
+  int reused = (chunk->Used <= chunk->HighWater);
+  if (chunk->Used > chunk->HighWater)
+    {
+    chunk->HighWater = chunk->Used;
+    }
+  this->CountAllocation(size, reused);
+  this->Lock->Unlock();
+
+  return header + 1;
+}
+
+//----------------------------------------------------------------------------
+void *vtkArenaArrayAllocator::Reallocate(void *ptr, size_t oldSize,
+                                         size_t newSize)
+{
+  if (!ptr)
+    {
+    return this->Allocate(newSize);
+    }
+
+  vtkArenaArrayAllocatorHeader *header =
+    static_cast<vtkArenaArrayAllocatorHeader *>(ptr) - 1;
+  vtkArenaArrayAllocatorChunk *chunk = header->Chunk;
+
+  if (chunk)
+    {
+    // The last block of a chunk can change size in place.
+    size_t blockSize = vtkArenaArrayAllocatorInternals::BlockSize(newSize);
+    this->Lock->Lock();
+    size_t offset = reinterpret_cast<char *>(header) - chunk->Data;
+    if (offset == chunk->LastBlock && offset + blockSize <= chunk->Size &&
+        newSize <= static_cast<size_t>(this->ChunkSize)/4)
+      {
+      chunk->Used = offset + blockSize;
+      int reused = (chunk->Used <= chunk->HighWater);
+      if (chunk->Used > chunk->HighWater)
+        {
+        chunk->HighWater = chunk->Used;
+        }
+      this->CountFree(oldSize);
+      this->CountAllocation(newSize, reused);
+      this->Lock->Unlock();
+      return ptr;
+      }
+    this->Lock->Unlock();
+    }
+  else if (newSize > static_cast<size_t>(this->ChunkSize)/4)
+    {
+    vtkArenaArrayAllocatorHeader *newHeader =
+      static_cast<vtkArenaArrayAllocatorHeader *>(
+        realloc(header, sizeof(vtkArenaArrayAllocatorHeader) + newSize));
+    if (!newHeader)
+      {
+      return 0;
+      }
+    this->Lock->Lock();
+    this->CountFree(oldSize);
+    this->CountAllocation(newSize, 0);
+    this->Lock->Unlock();
+    return newHeader + 1;
+    }
+
+  void *newPtr = this->Allocate(newSize);
+  if (!newPtr)
+    {
+    return 0;
+    }
+  memcpy(newPtr, ptr, oldSize < newSize ? oldSize : newSize);
+  this->Free(ptr, oldSize);
+  return newPtr;
+}
+
+//----------------------------------------------------------------------------
+void vtkArenaArrayAllocator::Free(void *ptr, size_t size)
+{
+  if (!ptr)
+    {
+    return;
+    }
+
+  vtkArenaArrayAllocatorHeader *header =
+    static_cast<vtkArenaArrayAllocatorHeader *>(ptr) - 1;
+  vtkArenaArrayAllocatorChunk *chunk = header->Chunk;
+
+  this->Lock->Lock();
+  this->CountFree(size);
+  if (chunk)
+    {
+    // Give back the room of the last block right away, and the whole
+    // chunk once it holds no block.
+    size_t offset = reinterpret_cast<char *>(header) - chunk->Data;
+    if (offset == chunk->LastBlock)
+      {
+      chunk->Used = offset;
+      }
+    if (--chunk->NumberOfBlocks == 0)
+      {
+      chunk->Used = 0;
+      chunk->LastBlock = chunk->Size;
+      if (chunk != this->Internals->Current)
+        {
+        this->Internals->FreeChunks.push_back(chunk);
+        }
+      }
+    }
+  this->Lock->Unlock();
+
+  if (!chunk)
+    {
+    free(header);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkArenaArrayAllocator::ReleaseCachedMemory()
+{
+  this->Lock->Lock();
+  vtkArenaArrayAllocatorChunk *current = this->Internals->Current;
+  if (current && current->NumberOfBlocks == 0)
+    {
+    this->Internals->FreeChunks.push_back(current);
+    this->Internals->Current = 0;
+    }
+  for (size_t i = 0; i < this->Internals->FreeChunks.size(); i++)
+    {
+    free(this->Internals->FreeChunks[i]->Data);
+    delete this->Internals->FreeChunks[i];
+    this->Internals->NumberOfChunks--;
+    }
+  this->Internals->FreeChunks.clear();
+  this->Lock->Unlock();
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkArenaArrayAllocator::GetNumberOfChunks()
+{
+  this->Lock->Lock();
+  vtkIdType value = this->Internals->NumberOfChunks;
+  this->Lock->Unlock();
+  return value;
+}
+
+//----------------------------------------------------------------------------
+void vtkArenaArrayAllocator::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "ChunkSize: " << this->ChunkSize << "\n";
+  os << indent << "NumberOfChunks: " << this->GetNumberOfChunks() << "\n";
+}
@@ -0,0 +1,82 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkArenaArrayAllocator.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkArenaArrayAllocator - array allocator carving blocks out of chunks
+// .SECTION Description
+// vtkArenaArrayAllocator hands out consecutive blocks of large chunks of
+// memory. A chunk is recycled once every block allocated in it has been
+// freed, and the last block of a chunk can grow in place, which makes
+// the repeated ResizeAndExtend() of arrays filled with InsertNext*()
+// cheap. Requests larger than a quarter of ChunkSize are passed to the
+// system allocator.
+//
+// It suits the temporary arrays of a single pipeline update: set an arena
+// as the global allocator (see vtkArrayAllocator::SetGlobalAllocator())
+// before calling Update() and restore the previous allocator afterwards.
+// Arrays that outlive the update keep their chunk alive but are
+// otherwise unaffected. Freed chunks are kept for reuse until
+// ReleaseCachedMemory() is called.
+// .SECTION See also
+// vtkArrayAllocator vtkPoolArrayAllocator
+
+#ifndef __vtkArenaArrayAllocator_h
+#define __vtkArenaArrayAllocator_h
+
+#include "vtkArrayAllocator.h"
+
+//BTX
+class vtkArenaArrayAllocatorInternals;
+//ETX
+
+class VTK_COMMON_EXPORT vtkArenaArrayAllocator : public vtkArrayAllocator
+{
+public:
+  static vtkArenaArrayAllocator *New();
+  vtkTypeMacro(vtkArenaArrayAllocator,vtkArrayAllocator);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+//BTX
+  virtual void *Allocate(size_t size);
+  virtual void *Reallocate(void *ptr, size_t oldSize, size_t newSize);
+  virtual void Free(void *ptr, size_t size);
+//ETX
+
+  // Description:
+  // Free the chunks that hold no block.
+  virtual void ReleaseCachedMemory();
+
+  // Description:
+  // Size in bytes of the chunks allocated from now on. Initial value is
+  // 4 MB.
+  vtkSetClampMacro(ChunkSize, vtkIdType, 4096, VTK_LARGE_ID);
+  vtkGetMacro(ChunkSize, vtkIdType);
+
+  // Description:
+  // The number of chunks currently held, including the free ones.
+  vtkIdType GetNumberOfChunks();
+
+protected:
+  vtkArenaArrayAllocator();
+  ~vtkArenaArrayAllocator();
+
+  vtkIdType ChunkSize;
+
+  vtkArenaArrayAllocatorInternals *Internals;
+
+private:
+  vtkArenaArrayAllocator(const vtkArenaArrayAllocator&);  // Not implemented.
+  void operator=(const vtkArenaArrayAllocator&);  // Not implemented.
+};
+
+#endif
@@ -0,0 +1,238 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkArrayAllocator.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkArrayAllocator.h"
+
+#include "vtkCriticalSection.h"
+#include "vtkObjectFactory.h"
+
+vtkStandardNewMacro(vtkArrayAllocator);
+
+//----------------------------------------------------------------------------
+// The global allocator is released when the program exits. The lock keeps
+// it from being released between the time an array reads it and the time
+// the array registers it.
+static vtkArrayAllocator *vtkArrayAllocatorGlobalAllocator = 0;
+static vtkSimpleCriticalSection vtkArrayAllocatorGlobalLock;
+
+class vtkArrayAllocatorCleanup
+{
+public:
+  ~vtkArrayAllocatorCleanup()
+    {
+    vtkArrayAllocator::SetGlobalAllocator(0);
+    }
+};
+static vtkArrayAllocatorCleanup vtkArrayAllocatorCleanupInstance;
+
+//----------------------------------------------------------------------------
+vtkArrayAllocator::vtkArrayAllocator()
+{
+  this->Lock = new vtkSimpleCriticalSection;
+  this->NumberOfAllocations = 0;
+  this->BytesAllocated = 0;
+  this->BytesReused = 0;
+  this->BytesInUse = 0;
+}
+
+//----------------------------------------------------------------------------
+vtkArrayAllocator::~vtkArrayAllocator()
+{
+  delete this->Lock;
+}
+
+//----------------------------------------------------------------------------
+void vtkArrayAllocator::SetGlobalAllocator(vtkArrayAllocator *allocator)
+{
+  if (allocator)
+    {
+    allocator->Register(0);
+    }
+  vtkArrayAllocatorGlobalLock.Lock();
+  vtkArrayAllocator *old = vtkArrayAllocatorGlobalAllocator;
+  vtkArrayAllocatorGlobalAllocator = allocator;
+  vtkArrayAllocatorGlobalLock.Unlock();
+  if (old)
+    {
+    old->UnRegister(0);
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkArrayAllocator *vtkArrayAllocator::GetGlobalAllocator()
+{
+  vtkArrayAllocatorGlobalLock.Lock();
+  vtkArrayAllocator *allocator = vtkArrayAllocatorGlobalAllocator;
+  vtkArrayAllocatorGlobalLock.Unlock();
+  return allocator;
+}
+
+//----------------------------------------------------------------------------
+vtkArrayAllocator *
+vtkArrayAllocator::RegisterGlobalAllocator(vtkObjectBase *registrar)
+{
+  vtkArrayAllocatorGlobalLock.Lock();
+  vtkArrayAllocator *allocator = vtkArrayAllocatorGlobalAllocator;
+  if (allocator)
+    {
+    allocator->Register(registrar);
+    }
+  vtkArrayAllocatorGlobalLock.Unlock();
+  return allocator;
+}
+
+//----------------------------------------------------------------------------
+void vtkArrayAllocator::RegisterInternal(vtkObjectBase* o, int check)
+{
+  this->Lock->Lock();
+  this->Superclass::RegisterInternal(o, check);
+  this->Lock->Unlock();
+}
+
+//----------------------------------------------------------------------------
+void vtkArrayAllocator::UnRegisterInternal(vtkObjectBase* o, int check)
+{
+  this->Lock->Lock();
+  if (this->ReferenceCount > 1)
+    {
+    this->Superclass::UnRegisterInternal(o, check);
+    this->Lock->Unlock();
+    return;
+    }
+  this->Lock->Unlock();
+
+  // This is the last reference, so no other thread can use the allocator
+  // any more, and the lock goes away with it.
+  this->Superclass::UnRegisterInternal(o, check);
+}
+
+//----------------------------------------------------------------------------
+void *vtkArrayAllocator::Allocate(size_t size)
+{
+  void *ptr = malloc(size);
+  if (ptr)
+    {
+    this->Lock->Lock();
+    this->CountAllocation(size, 0);
+    this->Lock->Unlock();
+    }
+  return ptr;
+}
+
+//----------------------------------------------------------------------------
+void *vtkArrayAllocator::Reallocate(void *ptr, size_t oldSize,
+                                    size_t newSize)
+{
+  void *newPtr = realloc(ptr, newSize);
+  if (newPtr)
+    {
+    this->Lock->Lock();
+    this->CountFree(oldSize);
+    this->CountAllocation(newSize, 0);
+    this->Lock->Unlock();
+    }
+  return newPtr;
+}
+
+//----------------------------------------------------------------------------
+void vtkArrayAllocator::Free(void *ptr, size_t size)
+{
+  if (ptr)
+    {
+    free(ptr);
+    this->Lock->Lock();
+    this->CountFree(size);
+    this->Lock->Unlock();
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkArrayAllocator::CountAllocation(size_t size, int reused)
+{
+  this->NumberOfAllocations++;
+  if (reused)
+    {
+    this->BytesReused += static_cast<vtkIdType>(size);
+    }
+  else
+    {
+    this->BytesAllocated += static_cast<vtkIdType>(size);
+    }
+  this->BytesInUse += static_cast<vtkIdType>(size);
+}
+
+//----------------------------------------------------------------------------
+void vtkArrayAllocator::CountFree(size_t size)
+{
+  this->BytesInUse -= static_cast<vtkIdType>(size);
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkArrayAllocator::GetNumberOfAllocations()
+{
+  this->Lock->Lock();
+  vtkIdType value = this->NumberOfAllocations;
+  this->Lock->Unlock();
+  return value;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkArrayAllocator::GetBytesAllocated()
+{
+  this->Lock->Lock();
+  vtkIdType value = this->BytesAllocated;
+  this->Lock->Unlock();
+  return value;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkArrayAllocator::GetBytesReused()
+{
+  this->Lock->Lock();
+  vtkIdType value = this->BytesReused;
+  this->Lock->Unlock();
+  return value;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkArrayAllocator::GetBytesInUse()
+{
+  this->Lock->Lock();
+  vtkIdType value = this->BytesInUse;
+  this->Lock->Unlock();
+  return value;
+}
+
+//----------------------------------------------------------------------------
+// BytesInUse is not reset since the blocks it counts are still in use.
+void vtkArrayAllocator::ResetCounters()
+{
+  this->Lock->Lock();
+  this->NumberOfAllocations = 0;
+  this->BytesAllocated = 0;
+  this->BytesReused = 0;
+  this->Lock->Unlock();
+}
+
+//----------------------------------------------------------------------------
+void vtkArrayAllocator::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "NumberOfAllocations: "
+     << this->GetNumberOfAllocations() << "\n";
+  os << indent << "BytesAllocated: " << this->GetBytesAllocated() << "\n";
+  os << indent << "BytesReused: " << this->GetBytesReused() << "\n";
+  os << indent << "BytesInUse: " << this->GetBytesInUse() << "\n";
+}
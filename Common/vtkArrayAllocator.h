@@ -0,0 +1,126 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkArrayAllocator.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkArrayAllocator - allocates the storage of data arrays and id lists
+// .SECTION Description
+// vtkArrayAllocator provides the memory used by vtkDataArrayTemplate,
+// vtkIdList and vtkCellArray. This class allocates directly with malloc()
+// and keeps count of the memory it hands out; subclasses implement other
+// strategies, such as pooling freed blocks by size class
+// (vtkPoolArrayAllocator) or carving blocks out of large chunks
+// (vtkArenaArrayAllocator).
+//
+// An allocator can be set on a single array or list with SetAllocator(),
+// or for every array and list of the process with SetGlobalAllocator().
+// When neither is set, arrays use malloc() and id lists use new[]
+// directly, exactly as they always have.
+//
+// All the methods may be called from several threads at once.
+// .SECTION See also
+// vtkPoolArrayAllocator vtkArenaArrayAllocator
+
+#ifndef __vtkArrayAllocator_h
+#define __vtkArrayAllocator_h
+
+#include "vtkObject.h"
+
+class vtkSimpleCriticalSection;
+
+class VTK_COMMON_EXPORT vtkArrayAllocator : public vtkObject
+{
+public:
+  static vtkArrayAllocator *New();
+  vtkTypeMacro(vtkArrayAllocator,vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+//BTX
+  // Description:
+  // Allocate size bytes. Returns NULL on failure.
+  virtual void *Allocate(size_t size);
+
+  // Description:
+  // Change the size of a block returned by this allocator from oldSize to
+  // newSize bytes, keeping the first min(oldSize, newSize) bytes. The
+  // block may move. Returns NULL on failure, in which case the original
+  // block is left untouched.
+  virtual void *Reallocate(void *ptr, size_t oldSize, size_t newSize);
+
+  // Description:
+  // Release a block returned by this allocator. size must be the size
+  // the block was allocated (or last reallocated) with.
+  virtual void Free(void *ptr, size_t size);
+//ETX
+
+  // Description:
+  // Release any memory the allocator keeps for reuse. The base class does
+  // not keep any.
+  virtual void ReleaseCachedMemory() {}
+
+  // Description:
+  // Counters. BytesAllocated is the number of bytes handed out from memory
+  // newly obtained from the system, BytesReused the number of bytes handed
+  // out from memory that was freed before, and BytesInUse the number of
+  // bytes currently handed out. NumberOfAllocations counts the calls to
+  // Allocate() and Reallocate().
+  vtkIdType GetNumberOfAllocations();
+  vtkIdType GetBytesAllocated();
+  vtkIdType GetBytesReused();
+  vtkIdType GetBytesInUse();
+  void ResetCounters();
+
+  // Description:
+  // Set/Get the allocator used by the arrays and id lists that do not
+  // have one of their own. NULL, the default, means the system allocator.
+  // Arrays and lists keep a reference to the allocator their storage came
+  // from, so the global allocator may be replaced while other threads
+  // allocate. The pointer GetGlobalAllocator() returns is not registered,
+  // and may be released by such a replacement.
+  static void SetGlobalAllocator(vtkArrayAllocator *allocator);
+  static vtkArrayAllocator *GetGlobalAllocator();
+
+  // Description:
+  // Return the global allocator registered by registrar, or NULL if there
+  // is none. The caller must UnRegister() it.
+  static vtkArrayAllocator *RegisterGlobalAllocator(vtkObjectBase *registrar);
+
+protected:
+  vtkArrayAllocator();
+  ~vtkArrayAllocator();
+
+  // Description:
+  // The arrays of several threads register and unregister the same
+  // allocator, so the reference count is updated with the Lock held.
+  virtual void RegisterInternal(vtkObjectBase*, int check);
+  virtual void UnRegisterInternal(vtkObjectBase*, int check);
+
+  // Description:
+  // Update the counters. Must be called with the Lock held.
+  void CountAllocation(size_t size, int reused);
+  void CountFree(size_t size);
+
+  // Protects the reference count, the counters, and the state of
+  // subclasses.
+  vtkSimpleCriticalSection *Lock;
+
+  vtkIdType NumberOfAllocations;
+  vtkIdType BytesAllocated;
+  vtkIdType BytesReused;
+  vtkIdType BytesInUse;
+
+private:
+  vtkArrayAllocator(const vtkArrayAllocator&);  // Not implemented.
+  void operator=(const vtkArrayAllocator&);  // Not implemented.
+};
+
+#endif
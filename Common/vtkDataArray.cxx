@@ -35,10 +35,28 @@
 #include "vtkUnsignedLongArray.h"
 #include "vtkUnsignedShortArray.h"
 
+#ifdef _WIN32
+# include "vtkWindows.h"
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <sys/types.h>
+# include <unistd.h>
+#endif
+
 vtkInformationKeyMacro(vtkDataArray, PER_COMPONENT, InformationVector);
 vtkInformationKeyRestrictedMacro(vtkDataArray, COMPONENT_RANGE, DoubleVector, 2);
 vtkInformationKeyRestrictedMacro(vtkDataArray, L2_NORM_RANGE, DoubleVector, 2);
 
+static int vtkDataArrayGlobalAlignment = 0;
+
+//----------------------------------------------------------------------------
+// Alignments must be 0 or a power of two.
+static int vtkDataArrayIsValidAlignment(int alignment)
+{
+  return alignment >= 0 && (alignment & (alignment - 1)) == 0;
+}
 
 //----------------------------------------------------------------------------
 // Construct object with default tuple dimension (number of components) of 1.
@@ -50,6 +68,7 @@ vtkDataArray::vtkDataArray(vtkIdType numComp)
   this->Size = 0;
   this->MaxId = -1;
   this->LookupTable = NULL;
+  this->Alignment = 0;
 
   this->NumberOfComponents = static_cast<int>(numComp < 1 ? 1 : numComp);
   this->Name = 0;
@@ -1220,6 +1239,161 @@ double vtkDataArray::GetDataTypeMax(int type)
     }
 }
 
+//----------------------------------------------------------------------------
+void vtkDataArray::SetAlignment(int alignment)
+{
+  if (!vtkDataArrayIsValidAlignment(alignment))
+    {
+    vtkErrorMacro("Alignment " << alignment << " is not a power of two.");
+    return;
+    }
+  if (this->Alignment != alignment)
+    {
+    this->Alignment = alignment;
+    this->Modified();
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkDataArray::SetGlobalAlignment(int alignment)
+{
+  if (!vtkDataArrayIsValidAlignment(alignment))
+    {
+    vtkGenericWarningMacro("Alignment " << alignment
+                           << " is not a power of two.");
+    return;
+    }
+  vtkDataArrayGlobalAlignment = alignment;
+}
+
+//----------------------------------------------------------------------------
+int vtkDataArray::GetGlobalAlignment()
+{
+  return vtkDataArrayGlobalAlignment;
+}
+
+//----------------------------------------------------------------------------
+int vtkDataArray::IsAligned(int alignment)
+{
+  void *ptr = this->GetVoidPointer(0);
+  if (!ptr || alignment <= 0)
+    {
+    return 0;
+    }
+  return (reinterpret_cast<size_t>(ptr) % static_cast<size_t>(alignment)) == 0;
+}
+
+//----------------------------------------------------------------------------
+int vtkDataArray::MapFile(const char*, vtkTypeInt64, vtkIdType, int)
+{
+  vtkErrorMacro(<< this->GetClassName() << " arrays cannot be mapped.");
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+void* vtkDataArray::MapFileRegion(const char* fileName, vtkTypeInt64 offset,
+                                  size_t length, int mode,
+                                  void*& region, size_t& regionSize)
+{
+  region = 0;
+  regionSize = 0;
+  if (!fileName || offset < 0 || length == 0)
+    {
+    return 0;
+    }
+  int copyOnWrite = (mode == VTK_DATA_ARRAY_MAP_COPY_ON_WRITE);
+
+#ifdef _WIN32
+  // Views start on a multiple of the allocation granularity.
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  vtkTypeInt64 start = offset - offset % info.dwAllocationGranularity;
+  size_t delta = static_cast<size_t>(offset - start);
+
+  HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, NULL,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE)
+    {
+    return 0;
+    }
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(file, &fileSize) ||
+      fileSize.QuadPart < offset + static_cast<vtkTypeInt64>(length))
+    {
+    CloseHandle(file);
+    return 0;
+    }
+  HANDLE mapping = CreateFileMappingA(
+    file, NULL, copyOnWrite ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, NULL);
+  CloseHandle(file);
+  if (!mapping)
+    {
+    return 0;
+    }
+  // The view keeps the mapping alive once its handle is closed.
+  void* view = MapViewOfFile(
+    mapping, copyOnWrite ? FILE_MAP_COPY : FILE_MAP_READ,
+    static_cast<DWORD>(start >> 32), static_cast<DWORD>(start & 0xffffffff),
+    length + delta);
+  CloseHandle(mapping);
+  if (!view)
+    {
+    return 0;
+    }
+#else
+  // Mappings start on a page.
+  long pageSize = sysconf(_SC_PAGESIZE);
+  vtkTypeInt64 start = offset - offset % pageSize;
+  size_t delta = static_cast<size_t>(offset - start);
+  if (static_cast<vtkTypeInt64>(static_cast<off_t>(start)) != start)
+    {
+    return 0;
+    }
+
+  int fd = open(fileName, O_RDONLY);
+  if (fd < 0)
+    {
+    return 0;
+    }
+  // Pages past the end of the file cannot be accessed.
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0 ||
+      static_cast<vtkTypeInt64>(fileStat.st_size) <
+      offset + static_cast<vtkTypeInt64>(length))
+    {
+    close(fd);
+    return 0;
+    }
+  void* view = mmap(0, length + delta,
+                    copyOnWrite ? (PROT_READ | PROT_WRITE) : PROT_READ,
+                    MAP_PRIVATE, fd, static_cast<off_t>(start));
+  close(fd);
+  if (view == MAP_FAILED)
+    {
+    return 0;
+    }
+#endif
+
+  region = view;
+  regionSize = length + delta;
+  return static_cast<char*>(view) + delta;
+}
+
+//----------------------------------------------------------------------------
+void vtkDataArray::UnmapFileRegion(void* region, size_t regionSize)
+{
+  if (!region)
+    {
+    return;
+    }
+#ifdef _WIN32
+  (void)regionSize;
+  UnmapViewOfFile(region);
+#else
+  munmap(region, regionSize);
+#endif
+}
+
 //----------------------------------------------------------------------------
 void vtkDataArray::PrintSelf(ostream& os, vtkIndent indent)
 {
@@ -1238,6 +1412,7 @@ void vtkDataArray::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Number Of Tuples: " << this->GetNumberOfTuples() << "\n";
   os << indent << "Size: " << this->Size << "\n";
   os << indent << "MaxId: " << this->MaxId << "\n";
+  os << indent << "Alignment: " << this->Alignment << "\n";
   if ( this->LookupTable )
     {
     os << indent << "Lookup Table:\n";
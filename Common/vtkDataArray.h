@@ -371,6 +371,54 @@ public:
   // keys not inteneded to be coppied are excluded here.
   virtual int CopyInformation(vtkInformation *infoFrom, int deep=1);
 
+  // Description:
+  // Alignment in bytes of the storage allocated for this array from now
+  // on. It must be 0 or a power of two such as 16, 32 or 64; 0 (the
+  // default) uses the global alignment. Storage that is already allocated
+  // or that was given with SetVoidArray() is not moved. Arrays that do not
+  // use vtkDataArrayTemplate storage, such as vtkBitArray, ignore it.
+  void SetAlignment(int alignment);
+  vtkGetMacro(Alignment, int);
+
+  // Description:
+  // Alignment in bytes of the storage allocated for the arrays whose
+  // Alignment is 0. The default, 0, keeps the alignment of malloc().
+  static void SetGlobalAlignment(int alignment);
+  static int GetGlobalAlignment();
+
+  // Description:
+  // Return 1 if the first value of the array lies at an address that is a
+  // multiple of alignment bytes, 0 otherwise or when there is no storage.
+  // Vectorized filters use it to choose aligned loads and stores.
+  int IsAligned(int alignment);
+
+//BTX
+  enum MapMode
+  {
+    VTK_DATA_ARRAY_MAP_READ_ONLY,
+    VTK_DATA_ARRAY_MAP_COPY_ON_WRITE
+  };
+
+  // Description:
+  // Use numberOfValues values stored at the given byte offset of a file
+  // as the storage of this array, without reading them: the operating
+  // system reads the pages when they are first accessed, so arrays larger
+  // than the physical memory can be used. The file must hold the values
+  // in the layout and byte order of this array, and offset must be a
+  // multiple of the value size. With VTK_DATA_ARRAY_MAP_READ_ONLY the
+  // array must not be modified; with VTK_DATA_ARRAY_MAP_COPY_ON_WRITE
+  // modified pages are copied to memory and the file is never written.
+  // Resizing the array copies it to memory. Returns 1 on success and 0 if
+  // the file cannot be mapped, in which case the array is unchanged.
+  // Arrays that do not use vtkDataArrayTemplate storage cannot be mapped.
+  virtual int MapFile(const char* fileName, vtkTypeInt64 offset,
+                      vtkIdType numberOfValues, int mode);
+//ETX
+
+  // Description:
+  // Return 1 if the storage of this array is mapped from a file.
+  virtual int IsMapped() { return 0; }
+
 protected:
   // Description:
   // Compute the range for a specific component. If comp is set -1
@@ -388,6 +436,18 @@ protected:
 
   vtkLookupTable *LookupTable;
   double Range[2];
+  int Alignment;
+
+//BTX
+  // Description:
+  // Map length bytes at offset in a file, which need not be aligned on a
+  // page. Returns the address of the byte at offset and the region to
+  // give to UnmapFileRegion() in region and regionSize, or NULL.
+  static void* MapFileRegion(const char* fileName, vtkTypeInt64 offset,
+                             size_t length, int mode,
+                             void*& region, size_t& regionSize);
+  static void UnmapFileRegion(void* region, size_t regionSize);
+//ETX
 
 private:
   double* GetTupleN(vtkIdType i, int n);
@@ -23,6 +23,8 @@
 
 #include "vtkDataArray.h"
 
+class vtkArrayAllocator;
+
 template <class T>
 class vtkDataArrayTemplateLookup;
 
@@ -198,7 +200,8 @@ public:
   enum DeleteMethod
   {
     VTK_DATA_ARRAY_FREE,
-    VTK_DATA_ARRAY_DELETE
+    VTK_DATA_ARRAY_DELETE,
+    VTK_DATA_ARRAY_UNMAP
   };
 //ETX
 
@@ -212,6 +215,7 @@ public:
   // array will be deallocated. If the delete method is
   // VTK_DATA_ARRAY_FREE, free() will be used. If the delete method is
   // DELETE, delete[] will be used. The default is FREE.
+  // VTK_DATA_ARRAY_UNMAP is used by MapFile() and cannot be given here.
   void SetArray(T* array, vtkIdType size, int save, int deleteMethod);
   void SetArray(T* array, vtkIdType size, int save)
     { this->SetArray(array, size, save, VTK_DATA_ARRAY_FREE); }
@@ -225,6 +229,28 @@ public:
       this->SetArray(static_cast<T*>(array), size, save, deleteMethod);
     }
 
+//BTX
+  // Description:
+  // Map values stored in a file as the storage of this array.  See
+  // vtkDataArray::MapFile().
+  virtual int MapFile(const char* fileName, vtkTypeInt64 offset,
+                      vtkIdType numberOfValues, int mode);
+//ETX
+
+  // Description:
+  // Return 1 if the storage of this array is mapped from a file.
+  virtual int IsMapped()
+    { return this->Array && this->DeleteMethod == VTK_DATA_ARRAY_UNMAP; }
+
+  // Description:
+  // Set/Get the allocator used for the storage of this array. When it is
+  // NULL (the default) the global allocator is used, see
+  // vtkArrayAllocator::SetGlobalAllocator(), and when both are NULL the
+  // storage comes from malloc(). Storage allocated before the allocator
+  // is changed is still released by the allocator that allocated it.
+  void SetAllocator(vtkArrayAllocator* allocator);
+  vtkArrayAllocator* GetAllocator() { return this->Allocator; }
+
   // Description:
   // This method copies the array data to the void pointer specified
   // by the user.  It is up to the user to allocate enough memory for
@@ -280,6 +306,12 @@ protected:
   int SaveUserArray;
   int DeleteMethod;
 
+  vtkArrayAllocator* Allocator;        // allocator set by the user
+  vtkArrayAllocator* StorageAllocator; // allocator that owns Array
+  int StorageAlignment; // alignment Array was allocated with, 0 if none
+  void* MappedRegion;   // file region mapped by MapFile
+  size_t MappedRegionSize;
+
   virtual void ComputeScalarRange(int comp);
   virtual void ComputeVectorRange();
 private:
@@ -290,6 +322,10 @@ private:
   void UpdateLookup();
 
   void DeleteArray();
+  T* AllocateStorage(vtkIdType sz, vtkArrayAllocator*& allocator,
+                     int& alignment);
+  void SetStorage(T* array, vtkArrayAllocator* allocator, int alignment);
+  int GetEffectiveAlignment();
 };
 
 #if !defined(VTK_NO_EXPLICIT_TEMPLATE_INSTANTIATION)
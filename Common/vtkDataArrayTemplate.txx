@@ -17,6 +17,7 @@
 
 #include "vtkDataArrayTemplate.h"
 
+#include "vtkArrayAllocator.h"
 #include "vtkArrayIteratorTemplate.h"
 #include "vtkIdList.h"
 #include "vtkInformation.h"
@@ -76,6 +77,11 @@ vtkDataArrayTemplate<T>::vtkDataArrayTemplate(vtkIdType numComp):
   this->TupleSize = 0;
   this->SaveUserArray = 0;
   this->DeleteMethod = VTK_DATA_ARRAY_FREE;
+  this->Allocator = 0;
+  this->StorageAllocator = 0;
+  this->StorageAlignment = 0;
+  this->MappedRegion = 0;
+  this->MappedRegionSize = 0;
   this->Lookup = 0;
 }
 
@@ -92,6 +98,108 @@ vtkDataArrayTemplate<T>::~vtkDataArrayTemplate()
     {
     delete this->Lookup;
     }
+  this->SetAllocator(0);
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+void vtkDataArrayTemplate<T>::SetAllocator(vtkArrayAllocator* allocator)
+{
+  if(this->Allocator == allocator)
+    {
+    return;
+    }
+  if(allocator)
+    {
+    allocator->Register(this);
+    }
+  if(this->Allocator)
+    {
+    this->Allocator->UnRegister(this);
+    }
+  this->Allocator = allocator;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+// The alignment in effect for new storage: the one of this array, else
+// the global one.
+template <class T>
+int vtkDataArrayTemplate<T>::GetEffectiveAlignment()
+{
+  return this->Alignment ? this->Alignment :
+    vtkDataArray::GetGlobalAlignment();
+}
+
+//----------------------------------------------------------------------------
+// Number of bytes to allocate for sz values at the given alignment.  An
+// aligned block is padded so that it can be moved up to the next
+// multiple of the alignment, with room for a pointer to the start of
+// the block just before the data.
+template <class T>
+static size_t vtkDataArrayTemplateStorageBytes(vtkIdType sz, int alignment)
+{
+  size_t bytes = static_cast<size_t>(sz) * sizeof(T);
+  if(alignment > 0)
+    {
+    bytes += static_cast<size_t>(alignment) + sizeof(void*);
+    }
+  return bytes;
+}
+
+//----------------------------------------------------------------------------
+// Allocate memory for sz values with the allocator and alignment in
+// effect for this array, which are returned in allocator (NULL for
+// malloc) and alignment (0 for none).  The allocator is registered by
+// this array until SetStorage() takes the memory.
+template <class T>
+T* vtkDataArrayTemplate<T>::AllocateStorage(vtkIdType sz,
+                                            vtkArrayAllocator*& allocator,
+                                            int& alignment)
+{
+  allocator = this->Allocator;
+  if(allocator)
+    {
+    allocator->Register(this);
+    }
+  else
+    {
+    allocator = vtkArrayAllocator::RegisterGlobalAllocator(this);
+    }
+  alignment = this->GetEffectiveAlignment();
+  size_t bytes = vtkDataArrayTemplateStorageBytes<T>(sz, alignment);
+  void* block = allocator ? allocator->Allocate(bytes) : malloc(bytes);
+  if(!block && allocator)
+    {
+    allocator->UnRegister(this);
+    allocator = 0;
+    }
+  if(!block || alignment <= 0)
+    {
+    return static_cast<T*>(block);
+    }
+
+  size_t mask = static_cast<size_t>(alignment) - 1;
+  size_t address = reinterpret_cast<size_t>(block) + sizeof(void*);
+  void** aligned = reinterpret_cast<void**>((address + mask) & ~mask);
+  aligned[-1] = block;
+  return reinterpret_cast<T*>(aligned);
+}
+
+//----------------------------------------------------------------------------
+// Take ownership of memory returned by AllocateStorage.  The previous
+// storage must have been released with DeleteArray.
+template <class T>
+void vtkDataArrayTemplate<T>::SetStorage(T* array,
+                                         vtkArrayAllocator* allocator,
+                                         int alignment)
+{
+  this->Array = array;
+  if(array)
+    {
+    this->StorageAlignment = alignment;
+    this->StorageAllocator = allocator;
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -111,6 +219,13 @@ void vtkDataArrayTemplate<T>::SetArray(T* array,
 
   vtkDebugMacro(<<"Setting array to: " << static_cast<void*>(array));
 
+  if(deleteMethod == VTK_DATA_ARRAY_UNMAP)
+    {
+    vtkErrorMacro("VTK_DATA_ARRAY_UNMAP is reserved to MapFile, "
+                  "using VTK_DATA_ARRAY_FREE.");
+    deleteMethod = VTK_DATA_ARRAY_FREE;
+    }
+
   this->Array = array;
   this->Size = size;
   this->MaxId = size-1;
@@ -119,6 +234,46 @@ void vtkDataArrayTemplate<T>::SetArray(T* array,
   this->DataChanged();
 }
 
+//----------------------------------------------------------------------------
+template <class T>
+int vtkDataArrayTemplate<T>::MapFile(const char* fileName,
+                                     vtkTypeInt64 offset,
+                                     vtkIdType numberOfValues,
+                                     int mode)
+{
+  if(numberOfValues <= 0 || offset < 0 ||
+     offset % static_cast<vtkTypeInt64>(sizeof(T)) != 0)
+    {
+    vtkErrorMacro("Cannot map " << numberOfValues << " values at offset "
+                  << offset << ": the offset must be a multiple of "
+                  << sizeof(T) << ".");
+    return 0;
+    }
+
+  void* region;
+  size_t regionSize;
+  void* data = vtkDataArray::MapFileRegion(
+    fileName, offset, static_cast<size_t>(numberOfValues)*sizeof(T), mode,
+    region, regionSize);
+  if(!data)
+    {
+    vtkWarningMacro("Cannot map " << numberOfValues << " values at offset "
+                    << offset << " of file "
+                    << (fileName ? fileName : "(none)"));
+    return 0;
+    }
+
+  this->DeleteArray();
+  this->Array = static_cast<T*>(data);
+  this->Size = numberOfValues;
+  this->MaxId = numberOfValues-1;
+  this->DeleteMethod = VTK_DATA_ARRAY_UNMAP;
+  this->MappedRegion = region;
+  this->MappedRegionSize = regionSize;
+  this->DataChanged();
+  return 1;
+}
+
 //----------------------------------------------------------------------------
 // Allocate memory for this array. Delete old storage only if necessary.
 template <class T>
@@ -133,8 +288,10 @@ int vtkDataArrayTemplate<T>::Allocate(vtkIdType sz, vtkIdType)
     this->Size = 0;
 
     vtkIdType newSize = (sz > 0 ? sz : 1);
-    this->Array = static_cast<T*>(malloc(static_cast<size_t>(newSize)
-                                         * sizeof(T)));
+    vtkArrayAllocator* allocator;
+    int alignment;
+    T* newArray = this->AllocateStorage(newSize, allocator, alignment);
+    this->SetStorage(newArray, allocator, alignment);
     if(this->Array==0)
       {
       vtkErrorMacro("Unable to allocate " << newSize
@@ -204,8 +361,10 @@ void vtkDataArrayTemplate<T>::DeepCopy(vtkDataArray* fa)
   this->Size = fa->GetSize();
 
   this->Size = (this->Size > 0 ? this->Size : 1);
-  this->Array = static_cast<T* >(
-    malloc(static_cast<size_t>(this->Size) * sizeof(T)));
+  vtkArrayAllocator* allocator;
+  int alignment;
+  T* newArray = this->AllocateStorage(this->Size, allocator, alignment);
+  this->SetStorage(newArray, allocator, alignment);
   if(this->Array==0)
     {
     vtkErrorMacro("Unable to allocate " << this->Size
@@ -249,6 +408,7 @@ void vtkDataArrayTemplate<T>::PrintSelf(ostream& os, vtkIndent indent)
     {
     osw << indent << "Array: (null)\n";
     }
+  osw << indent << "Allocator: " << static_cast<void*>(this->Allocator) << "\n";
 }
 
 //----------------------------------------------------------------------------
@@ -257,7 +417,28 @@ void vtkDataArrayTemplate<T>::DeleteArray()
 {
   if ((this->Array) && (!this->SaveUserArray))
     {
-    if (this->DeleteMethod == VTK_DATA_ARRAY_FREE)
+    // Aligned storage is released from the start of its block.
+    void* block = this->Array;
+    if (this->StorageAlignment > 0)
+      {
+      block = reinterpret_cast<void**>(this->Array)[-1];
+      }
+    if (this->StorageAllocator)
+      {
+      this->StorageAllocator->Free(block,
+        vtkDataArrayTemplateStorageBytes<T>(this->Size,
+                                            this->StorageAlignment));
+      }
+    else if (this->StorageAlignment > 0)
+      {
+      free(block);
+      }
+    else if (this->DeleteMethod == VTK_DATA_ARRAY_UNMAP)
+      {
+      vtkDataArray::UnmapFileRegion(this->MappedRegion,
+                                    this->MappedRegionSize);
+      }
+    else if (this->DeleteMethod == VTK_DATA_ARRAY_FREE)
       {
       free(this->Array);
       }
@@ -266,6 +447,14 @@ void vtkDataArrayTemplate<T>::DeleteArray()
       delete[] this->Array;
       }
     }
+  if (this->StorageAllocator)
+    {
+    this->StorageAllocator->UnRegister(this);
+    this->StorageAllocator = 0;
+    }
+  this->StorageAlignment = 0;
+  this->MappedRegion = 0;
+  this->MappedRegionSize = 0;
   this->SaveUserArray = 0;
   this->DeleteMethod = VTK_DATA_ARRAY_FREE;
   this->Array = 0;
@@ -313,14 +502,49 @@ T* vtkDataArrayTemplate<T>::ResizeAndExtend(vtkIdType sz)
   dontUseRealloc=true;
   #endif
 
-  // Allocate the new array or reallocate the old.
-  if (this->Array
+  // Allocate the new array or reallocate the old.  Memory that came
+  // from an allocator is resized by that allocator, while memory that
+  // did not is moved to the allocator now in effect, if any.  Aligned
+  // storage is always moved, since reallocation does not keep the
+  // alignment.
+  vtkArrayAllocator* allocator = 0;
+  int alignment = 0;
+  bool aligned = (this->StorageAlignment > 0 ||
+                  this->GetEffectiveAlignment() > 0);
+  if (this->Array && this->StorageAllocator && !this->SaveUserArray &&
+      !aligned)
+    {
+    newArray = static_cast<T*>(this->StorageAllocator->Reallocate(
+      this->Array, static_cast<size_t>(this->Size)*sizeof(T),
+      static_cast<size_t>(newSize)*sizeof(T)));
+    if(!newArray)
+      {
+      vtkErrorMacro("Unable to allocate " << newSize
+                    << " elements of size " << sizeof(T)
+                    << " bytes. ");
+      #if !defined NDEBUG
+      // We're debugging, crash here preserving the stack
+      abort();
+      #elif !defined VTK_DONT_THROW_BAD_ALLOC
+      // We can throw something that has universal meaning
+      throw vtkstd::bad_alloc();
+      #else
+      // We indicate that malloc failed by return
+      return 0;
+      #endif
+      }
+    }
+  else if (this->Array
       &&
       (this->SaveUserArray
        || this->DeleteMethod==VTK_DATA_ARRAY_DELETE
-       || dontUseRealloc ))
+       || this->DeleteMethod==VTK_DATA_ARRAY_UNMAP
+       || dontUseRealloc
+       || aligned
+       || this->Allocator
+       || vtkArrayAllocator::GetGlobalAllocator()))
     {
-    newArray = static_cast<T*>(malloc(static_cast<size_t>(newSize)*sizeof(T)));
+    newArray = this->AllocateStorage(newSize, allocator, alignment);
     if(!newArray)
       {
       vtkErrorMacro("Unable to allocate " << newSize
@@ -345,6 +569,28 @@ T* vtkDataArrayTemplate<T>::ResizeAndExtend(vtkIdType sz)
 
     // Realease old array if we own
     this->DeleteArray();
+    this->SetStorage(newArray, allocator, alignment);
+    }
+  else if (!this->Array)
+    {
+    newArray = this->AllocateStorage(newSize, allocator, alignment);
+    if(!newArray)
+      {
+      vtkErrorMacro("Unable to allocate " << newSize
+                    << " elements of size " << sizeof(T)
+                    << " bytes. ");
+      #if !defined NDEBUG
+      // We're debugging, crash here preserving the stack
+      abort();
+      #elif !defined VTK_DONT_THROW_BAD_ALLOC
+      // We can throw something that has universal meaning
+      throw vtkstd::bad_alloc();
+      #else
+      // We indicate that malloc failed by return
+      return 0;
+      #endif
+      }
+    this->SetStorage(newArray, allocator, alignment);
     }
   else
     {
@@ -952,6 +952,671 @@ bool vtkFunctionParser::Evaluate()
   return true;
 }
 
+int vtkFunctionParser::GetNumberOfResultComponents()
+{
+  int stackPointer;
+
+  if (this->FunctionMTime.GetMTime() > this->ParseMTime.GetMTime() ||
+    this->VariableMTime.GetMTime() > this->ParseMTime.GetMTime())
+    {
+    if (this->Parse() == 0)
+      {
+      return 0;
+      }
+    }
+
+  // The stack layout does not depend on the variable values, so running
+  // the byte code over an empty block is enough to get the result type.
+  if (!this->EvaluateBlockInternal(0, 0, NULL, NULL, NULL, NULL,
+                                   stackPointer))
+    {
+    return 0;
+    }
+  if (stackPointer == 0)
+    {
+    return 1;
+    }
+  if (stackPointer == 2)
+    {
+    return 3;
+    }
+  return 0;
+}
+
+int vtkFunctionParser::EvaluateBlock(vtkIdType numberOfTuples,
+                                     const double* const* scalarValues,
+                                     const double* const* vectorValues,
+                                     double* result,
+                                     vtkIdType* numberOfInvalidTuples)
+{
+  vtkIdType offset;
+  int n, i, c, stackPointer;
+  int numComps = this->GetNumberOfResultComponents();
+
+  if (numComps == 0)
+    {
+    vtkErrorMacro("EvaluateBlock: no valid scalar or vector result");
+    return 0;
+    }
+  if (numberOfInvalidTuples)
+    {
+    *numberOfInvalidTuples = 0;
+    }
+  if (numberOfTuples <= 0)
+    {
+    return 1;
+    }
+
+  double *blockStack = new double[this->StackSize * VTK_PARSER_BLOCK_SIZE];
+  char *invalid = (numberOfInvalidTuples ?
+                   new char[VTK_PARSER_BLOCK_SIZE] : NULL);
+  for (offset = 0; offset < numberOfTuples; offset += VTK_PARSER_BLOCK_SIZE)
+    {
+    n = static_cast<int>(numberOfTuples - offset < VTK_PARSER_BLOCK_SIZE ?
+                         numberOfTuples - offset : VTK_PARSER_BLOCK_SIZE);
+    if (invalid)
+      {
+      memset(invalid, 0, n);
+      }
+    if (!this->EvaluateBlockInternal(n, offset, scalarValues, vectorValues,
+                                     blockStack, invalid, stackPointer))
+      {
+      delete [] blockStack;
+      delete [] invalid;
+      return 0;
+      }
+    if (numComps == 1)
+      {
+      double *out = result + offset;
+      for (i = 0; i < n; i++)
+        {
+        out[i] = blockStack[i];
+        }
+      }
+    else
+      {
+      double *out = result + 3*offset;
+      const double *x = blockStack;
+      const double *y = blockStack + VTK_PARSER_BLOCK_SIZE;
+      const double *z = blockStack + 2*VTK_PARSER_BLOCK_SIZE;
+      for (i = 0; i < n; i++)
+        {
+        out[3*i] = x[i];
+        out[3*i+1] = y[i];
+        out[3*i+2] = z[i];
+        }
+      }
+    if (invalid)
+      {
+      double *out = result + numComps*offset;
+      for (i = 0; i < n; i++)
+        {
+        if (invalid[i])
+          {
+          for (c = 0; c < numComps; c++)
+            {
+            out[numComps*i + c] = VTK_PARSER_ERROR_RESULT;
+            }
+          ++*numberOfInvalidTuples;
+          }
+        }
+      }
+    }
+  delete [] blockStack;
+  delete [] invalid;
+
+  return 1;
+}
+
+bool vtkFunctionParser::EvaluateBlockInternal(int n, vtkIdType offset,
+                                              const double* const* scalarValues,
+                                              const double* const* vectorValues,
+                                              double* blockStack,
+                                              char* invalid,
+                                              int& stackPointer)
+{
+  int numBytesProcessed;
+  int numImmediatesProcessed = 0;
+  int stackPosition = -1;
+  int i;
+  double *a, *b, *c, *d, *e, *f, *g;
+  double value;
+
+  // Slot k of the stack holds the values of stack position k for all the
+  // tuples of the block.
+#define vtkParserSlot(k) (blockStack + (k)*VTK_PARSER_BLOCK_SIZE)
+
+  for (numBytesProcessed = 0; numBytesProcessed < this->ByteCodeSize;
+       numBytesProcessed++)
+    {
+    switch (this->ByteCode[numBytesProcessed])
+      {
+      case VTK_PARSER_IMMEDIATE:
+        a = vtkParserSlot(++stackPosition);
+        value = this->Immediates[numImmediatesProcessed++];
+        for (i = 0; i < n; i++)
+          {
+          a[i] = value;
+          }
+        break;
+      case VTK_PARSER_UNARY_MINUS:
+        a = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          a[i] = -a[i];
+          }
+        break;
+      case VTK_PARSER_ADD:
+        a = vtkParserSlot(stackPosition-1);
+        b = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          a[i] += b[i];
+          }
+        stackPosition--;
+        break;
+      case VTK_PARSER_SUBTRACT:
+        a = vtkParserSlot(stackPosition-1);
+        b = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          a[i] -= b[i];
+          }
+        stackPosition--;
+        break;
+      case VTK_PARSER_MULTIPLY:
+        a = vtkParserSlot(stackPosition-1);
+        b = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          a[i] *= b[i];
+          }
+        stackPosition--;
+        break;
+      case VTK_PARSER_DIVIDE:
+        a = vtkParserSlot(stackPosition-1);
+        b = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          if (b[i] == 0)
+            {
+            if (!this->ReplaceInvalidValues)
+              {
+              if (!invalid)
+                {
+                vtkErrorMacro("Trying to divide by zero");
+                return false;
+                }
+              invalid[i] = 1;
+              }
+            a[i] = this->ReplacementValue;
+            }
+          else
+            {
+            a[i] /= b[i];
+            }
+          }
+        stackPosition--;
+        break;
+      case VTK_PARSER_POWER:
+        a = vtkParserSlot(stackPosition-1);
+        b = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          a[i] = pow(a[i], b[i]);
+          }
+        stackPosition--;
+        break;
+      case VTK_PARSER_ABSOLUTE_VALUE:
+        a = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          a[i] = fabs(a[i]);
+          }
+        break;
+      case VTK_PARSER_EXPONENT:
+        a = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          a[i] = exp(a[i]);
+          }
+        break;
+      case VTK_PARSER_CEILING:
+        a = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          a[i] = ceil(a[i]);
+          }
+        break;
+      case VTK_PARSER_FLOOR:
+        a = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          a[i] = floor(a[i]);
+          }
+        break;
+      case VTK_PARSER_LOGARITHM:
+      case VTK_PARSER_LOGARITHME:
+      case VTK_PARSER_LOGARITHM10:
+        a = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          if (a[i] <= 0)
+            {
+            if (!this->ReplaceInvalidValues)
+              {
+              if (!invalid)
+                {
+                vtkErrorMacro("Trying to take a logarithm of a negative value");
+                return false;
+                }
+              invalid[i] = 1;
+              }
+            a[i] = this->ReplacementValue;
+            }
+          else if (this->ByteCode[numBytesProcessed] ==
+                   VTK_PARSER_LOGARITHM10)
+            {
+            a[i] = log(a[i])/log(static_cast<double>(10));
+            }
+          else
+            {
+            a[i] = log(a[i]);
+            }
+          }
+        break;
+      case VTK_PARSER_SQUARE_ROOT:
+        a = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          if (a[i] < 0)
+            {
+            if (!this->ReplaceInvalidValues)
+              {
+              if (!invalid)
+                {
+                vtkErrorMacro("Trying to take a square root of a negative value");
+                return false;
+                }
+              invalid[i] = 1;
+              }
+            a[i] = this->ReplacementValue;
+            }
+          else
+            {
+            a[i] = sqrt(a[i]);
+            }
+          }
+        break;
+      case VTK_PARSER_SINE:
+        a = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          a[i] = sin(a[i]);
+          }
+        break;
+      case VTK_PARSER_COSINE:
+        a = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          a[i] = cos(a[i]);
+          }
+        break;
+      case VTK_PARSER_TANGENT:
+        a = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          a[i] = tan(a[i]);
+          }
+        break;
+      case VTK_PARSER_ARCSINE:
+      case VTK_PARSER_ARCCOSINE:
+        a = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          if (a[i] < -1 || a[i] > 1)
+            {
+            if (!this->ReplaceInvalidValues)
+              {
+              if (!invalid)
+                {
+                if (this->ByteCode[numBytesProcessed] == VTK_PARSER_ARCSINE)
+                  {
+                  vtkErrorMacro("Trying to take asin of a value < -1 or > 1");
+                  }
+                else
+                  {
+                  vtkErrorMacro("Trying to take acos of a value < -1 or > 1");
+                  }
+                return false;
+                }
+              invalid[i] = 1;
+              }
+            a[i] = this->ReplacementValue;
+            }
+          else if (this->ByteCode[numBytesProcessed] == VTK_PARSER_ARCSINE)
+            {
+            a[i] = asin(a[i]);
+            }
+          else
+            {
+            a[i] = acos(a[i]);
+            }
+          }
+        break;
+      case VTK_PARSER_ARCTANGENT:
+        a = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          a[i] = atan(a[i]);
+          }
+        break;
+      case VTK_PARSER_HYPERBOLIC_SINE:
+        a = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          a[i] = sinh(a[i]);
+          }
+        break;
+      case VTK_PARSER_HYPERBOLIC_COSINE:
+        a = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          a[i] = cosh(a[i]);
+          }
+        break;
+      case VTK_PARSER_HYPERBOLIC_TANGENT:
+        a = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          a[i] = tanh(a[i]);
+          }
+        break;
+      case VTK_PARSER_MIN:
+        a = vtkParserSlot(stackPosition-1);
+        b = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          a[i] = (b[i] < a[i] ? b[i] : a[i]);
+          }
+        stackPosition--;
+        break;
+      case VTK_PARSER_MAX:
+        a = vtkParserSlot(stackPosition-1);
+        b = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          a[i] = (b[i] > a[i] ? b[i] : a[i]);
+          }
+        stackPosition--;
+        break;
+      case VTK_PARSER_CROSS:
+        {
+        double *ux = vtkParserSlot(stackPosition-5);
+        double *uy = vtkParserSlot(stackPosition-4);
+        double *uz = vtkParserSlot(stackPosition-3);
+        double *vx = vtkParserSlot(stackPosition-2);
+        double *vy = vtkParserSlot(stackPosition-1);
+        double *vz = vtkParserSlot(stackPosition);
+        double tx, ty, tz;
+        for (i = 0; i < n; i++)
+          {
+          tx = uy[i]*vz[i] - uz[i]*vy[i];
+          ty = uz[i]*vx[i] - ux[i]*vz[i];
+          tz = ux[i]*vy[i] - uy[i]*vx[i];
+          ux[i] = tx;
+          uy[i] = ty;
+          uz[i] = tz;
+          }
+        stackPosition -= 3;
+        break;
+        }
+      case VTK_PARSER_SIGN:
+        a = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          a[i] = (a[i] < 0 ? -1 : (a[i] == 0 ? 0 : 1));
+          }
+        break;
+      case VTK_PARSER_VECTOR_UNARY_MINUS:
+        a = vtkParserSlot(stackPosition-2);
+        b = vtkParserSlot(stackPosition-1);
+        c = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          a[i] = -a[i];
+          b[i] = -b[i];
+          c[i] = -c[i];
+          }
+        break;
+      case VTK_PARSER_DOT_PRODUCT:
+        a = vtkParserSlot(stackPosition-5);
+        b = vtkParserSlot(stackPosition-4);
+        c = vtkParserSlot(stackPosition-3);
+        d = vtkParserSlot(stackPosition-2);
+        e = vtkParserSlot(stackPosition-1);
+        f = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          a[i] = a[i]*d[i] + b[i]*e[i] + c[i]*f[i];
+          }
+        stackPosition -= 5;
+        break;
+      case VTK_PARSER_VECTOR_ADD:
+        a = vtkParserSlot(stackPosition-5);
+        b = vtkParserSlot(stackPosition-4);
+        c = vtkParserSlot(stackPosition-3);
+        d = vtkParserSlot(stackPosition-2);
+        e = vtkParserSlot(stackPosition-1);
+        f = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          a[i] += d[i];
+          b[i] += e[i];
+          c[i] += f[i];
+          }
+        stackPosition -= 3;
+        break;
+      case VTK_PARSER_VECTOR_SUBTRACT:
+        a = vtkParserSlot(stackPosition-5);
+        b = vtkParserSlot(stackPosition-4);
+        c = vtkParserSlot(stackPosition-3);
+        d = vtkParserSlot(stackPosition-2);
+        e = vtkParserSlot(stackPosition-1);
+        f = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          a[i] -= d[i];
+          b[i] -= e[i];
+          c[i] -= f[i];
+          }
+        stackPosition -= 3;
+        break;
+      case VTK_PARSER_SCALAR_TIMES_VECTOR:
+        // the scalar below the vector is overwritten by the scaled vector
+        a = vtkParserSlot(stackPosition-3);
+        b = vtkParserSlot(stackPosition-2);
+        c = vtkParserSlot(stackPosition-1);
+        d = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          value = a[i];
+          a[i] = b[i]*value;
+          b[i] = c[i]*value;
+          c[i] = d[i]*value;
+          }
+        stackPosition--;
+        break;
+      case VTK_PARSER_VECTOR_TIMES_SCALAR:
+        a = vtkParserSlot(stackPosition-3);
+        b = vtkParserSlot(stackPosition-2);
+        c = vtkParserSlot(stackPosition-1);
+        d = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          a[i] *= d[i];
+          b[i] *= d[i];
+          c[i] *= d[i];
+          }
+        stackPosition--;
+        break;
+      case VTK_PARSER_MAGNITUDE:
+        a = vtkParserSlot(stackPosition-2);
+        b = vtkParserSlot(stackPosition-1);
+        c = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          a[i] = sqrt(c[i]*c[i] + b[i]*b[i] + a[i]*a[i]);
+          }
+        stackPosition -= 2;
+        break;
+      case VTK_PARSER_NORMALIZE:
+        a = vtkParserSlot(stackPosition-2);
+        b = vtkParserSlot(stackPosition-1);
+        c = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          value = sqrt(c[i]*c[i] + b[i]*b[i] + a[i]*a[i]);
+          if (value != 0)
+            {
+            a[i] /= value;
+            b[i] /= value;
+            c[i] /= value;
+            }
+          }
+        break;
+      case VTK_PARSER_IHAT:
+      case VTK_PARSER_JHAT:
+      case VTK_PARSER_KHAT:
+        a = vtkParserSlot(stackPosition+1);
+        b = vtkParserSlot(stackPosition+2);
+        c = vtkParserSlot(stackPosition+3);
+        for (i = 0; i < n; i++)
+          {
+          a[i] = (this->ByteCode[numBytesProcessed] == VTK_PARSER_IHAT);
+          b[i] = (this->ByteCode[numBytesProcessed] == VTK_PARSER_JHAT);
+          c[i] = (this->ByteCode[numBytesProcessed] == VTK_PARSER_KHAT);
+          }
+        stackPosition += 3;
+        break;
+      case VTK_PARSER_LESS_THAN:
+        a = vtkParserSlot(stackPosition-1);
+        b = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          a[i] = (a[i] < b[i]);
+          }
+        stackPosition--;
+        break;
+      case VTK_PARSER_GREATER_THAN:
+        a = vtkParserSlot(stackPosition-1);
+        b = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          a[i] = (a[i] > b[i]);
+          }
+        stackPosition--;
+        break;
+      case VTK_PARSER_EQUAL_TO:
+        a = vtkParserSlot(stackPosition-1);
+        b = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          a[i] = (a[i] == b[i]);
+          }
+        stackPosition--;
+        break;
+      case VTK_PARSER_AND:
+        a = vtkParserSlot(stackPosition-1);
+        b = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          a[i] = (a[i] && b[i]);
+          }
+        stackPosition--;
+        break;
+      case VTK_PARSER_OR:
+        a = vtkParserSlot(stackPosition-1);
+        b = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          a[i] = (a[i] || b[i]);
+          }
+        stackPosition--;
+        break;
+      case VTK_PARSER_IF:
+        // slot stackPosition is the bool argument, stackPosition-1 is
+        // valtrue and stackPosition-2 is valfalse (and the result).
+        a = vtkParserSlot(stackPosition-2);
+        b = vtkParserSlot(stackPosition-1);
+        c = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          a[i] = (c[i] ? b[i] : a[i]);
+          }
+        stackPosition -= 2;
+        break;
+      case VTK_PARSER_VECTOR_IF:
+        a = vtkParserSlot(stackPosition-6);
+        b = vtkParserSlot(stackPosition-5);
+        c = vtkParserSlot(stackPosition-4);
+        d = vtkParserSlot(stackPosition-3);
+        e = vtkParserSlot(stackPosition-2);
+        f = vtkParserSlot(stackPosition-1);
+        g = vtkParserSlot(stackPosition);
+        for (i = 0; i < n; i++)
+          {
+          if (g[i])
+            {
+            a[i] = d[i];
+            b[i] = e[i];
+            c[i] = f[i];
+            }
+          }
+        stackPosition -= 4;
+        break;
+      default:
+        if ((this->ByteCode[numBytesProcessed] -
+             VTK_PARSER_BEGIN_VARIABLES) < this->NumberOfScalarVariables)
+          {
+          a = vtkParserSlot(++stackPosition);
+          if (n > 0)
+            {
+            const double *src = scalarValues[this->ByteCode[numBytesProcessed] -
+                                             VTK_PARSER_BEGIN_VARIABLES] +
+              offset;
+            for (i = 0; i < n; i++)
+              {
+              a[i] = src[i];
+              }
+            }
+          }
+        else
+          {
+          int vectorNum = this->ByteCode[numBytesProcessed] -
+            VTK_PARSER_BEGIN_VARIABLES - this->NumberOfScalarVariables;
+          int comp;
+          for (comp = 0; comp < 3; comp++)
+            {
+            a = vtkParserSlot(++stackPosition);
+            if (n > 0)
+              {
+              const double *src = vectorValues[3*vectorNum+comp] + offset;
+              for (i = 0; i < n; i++)
+                {
+                a[i] = src[i];
+                }
+              }
+            }
+          }
+      }
+    }
+#undef vtkParserSlot
+
+  stackPointer = stackPosition;
+  return true;
+}
+
 int vtkFunctionParser::IsScalarResult()
 {
   if (this->VariableMTime.GetMTime() > this->EvaluateMTime.GetMTime() ||
@@ -112,6 +112,9 @@
 // the value that is retuned as a result if there is an error
 #define VTK_PARSER_ERROR_RESULT VTK_LARGE_FLOAT
 
+// the number of tuples processed together by EvaluateBlock
+#define VTK_PARSER_BLOCK_SIZE 256
+
 class VTK_COMMON_EXPORT vtkFunctionParser : public vtkObject
 {
 public:
@@ -145,6 +148,37 @@ public:
     double *r = this->GetVectorResult();
     result[0] = r[0]; result[1] = r[1]; result[2] = r[2]; };
 
+  // Description:
+  // Evaluate the function for numberOfTuples tuples at once.  Instead of
+  // interpreting the byte code once per tuple, each operation is applied
+  // to a whole block of tuples held in structure-of-arrays form, which
+  // amortizes the dispatch and lets the compiler vectorize the inner loops.
+  // scalarValues[i] points to numberOfTuples values of scalar variable i,
+  // and vectorValues[3*i+c] points to numberOfTuples values of component
+  // c of vector variable i.  The result is written interleaved into
+  // result, which must hold numberOfTuples values for a scalar function
+  // or 3*numberOfTuples values for a vector function (see
+  // GetNumberOfResultComponents()).  The values set with
+  // Set*VariableValue are ignored.  Returns 1 on success, 0 on failure.
+  // When numberOfInvalidTuples is given and ReplaceInvalidValues is off,
+  // invalid values are not reported and do not stop the evaluation: the
+  // results of the tuples that have one are set to
+  // VTK_PARSER_ERROR_RESULT and their number is stored in
+  // numberOfInvalidTuples, for the caller to report.
+  // Once the function has been parsed (e.g. by calling IsScalarResult()),
+  // this method does not modify the parser and may be called
+  // concurrently from several threads.
+  int EvaluateBlock(vtkIdType numberOfTuples,
+                    const double* const* scalarValues,
+                    const double* const* vectorValues,
+                    double* result,
+                    vtkIdType* numberOfInvalidTuples = 0);
+
+  // Description:
+  // Get the number of components (1 or 3) of the result of the parsed
+  // function, or 0 if the function can not be parsed.
+  int GetNumberOfResultComponents();
+
   // Description:
   // Set the value of a scalar variable.  If a variable with this name
   // exists, then its value will be set to the new value.  If there is not
@@ -232,6 +266,18 @@ protected:
   // Evaluate the function, returning true on success, false on failure.
   bool Evaluate();
 
+  // Description:
+  // Run the byte code over n tuples starting at tuple offset, using
+  // blockStack (StackSize*VTK_PARSER_BLOCK_SIZE values) as the stack.
+  // On success the final stack position is stored in stackPointer.  When
+  // invalid is not NULL, invalid values flag their tuple in it instead of
+  // being reported.
+  bool EvaluateBlockInternal(int n, vtkIdType offset,
+                             const double* const* scalarValues,
+                             const double* const* vectorValues,
+                             double* blockStack, char* invalid,
+                             int& stackPointer);
+
   int CheckSyntax();
   void RemoveSpaces();
   char* RemoveSpacesFrom(const char* variableName);
@@ -13,6 +13,8 @@
 
 =========================================================================*/
 #include "vtkIdList.h"
+
+#include "vtkArrayAllocator.h"
 #include "vtkObjectFactory.h"
 
 vtkStandardNewMacro(vtkIdList);
@@ -22,23 +24,99 @@ vtkIdList::vtkIdList()
   this->NumberOfIds = 0;
   this->Size = 0;
   this->Ids = NULL;
+  this->Allocator = NULL;
+  this->StorageAllocator = NULL;
 }
 
 vtkIdList::~vtkIdList()
 {
-  if ( this->Ids != NULL )
+  this->FreeIds();
+  this->SetAllocator(NULL);
+}
+
+void vtkIdList::SetAllocator(vtkArrayAllocator *allocator)
+{
+  if ( this->Allocator == allocator )
     {
-    delete [] this->Ids;
+    return;
     }
+  if ( allocator != NULL )
+    {
+    allocator->Register(this);
+    }
+  if ( this->Allocator != NULL )
+    {
+    this->Allocator->UnRegister(this);
+    }
+  this->Allocator = allocator;
+  this->Modified();
 }
 
-void vtkIdList::Initialize()
+// Allocate room for sz ids with the allocator in effect for this list,
+// which is returned in allocator (NULL for new[]). The allocator is
+// registered by this list until SetIds() takes the ids.
+vtkIdType *vtkIdList::AllocateIds(vtkIdType sz, vtkArrayAllocator *&allocator)
+{
+  allocator = this->Allocator;
+  if ( allocator != NULL )
+    {
+    allocator->Register(this);
+    }
+  else
+    {
+    allocator = vtkArrayAllocator::RegisterGlobalAllocator(this);
+    }
+  if ( allocator == NULL )
+    {
+    return new vtkIdType[sz];
+    }
+
+  vtkIdType *ids = static_cast<vtkIdType *>(
+    allocator->Allocate(static_cast<size_t>(sz) * sizeof(vtkIdType)));
+  if ( ids == NULL )
+    {
+    allocator->UnRegister(this);
+    allocator = NULL;
+    }
+  return ids;
+}
+
+// Take ownership of ids returned by AllocateIds. The previous ids must
+// have been released with FreeIds.
+void vtkIdList::SetIds(vtkIdType *ids, vtkArrayAllocator *allocator)
+{
+  this->Ids = ids;
+  if ( ids != NULL )
+    {
+    this->StorageAllocator = allocator;
+    }
+}
+
+void vtkIdList::FreeIds()
 {
   if ( this->Ids != NULL )
     {
-    delete [] this->Ids;
+    if ( this->StorageAllocator != NULL )
+      {
+      this->StorageAllocator->Free(
+        this->Ids, static_cast<size_t>(this->Size) * sizeof(vtkIdType));
+      }
+    else
+      {
+      delete [] this->Ids;
+      }
     this->Ids = NULL;
     }
+  if ( this->StorageAllocator != NULL )
+    {
+    this->StorageAllocator->UnRegister(this);
+    this->StorageAllocator = NULL;
+    }
+}
+
+void vtkIdList::Initialize()
+{
+  this->FreeIds();
   this->NumberOfIds = 0;
   this->Size = 0;
 }
@@ -49,8 +127,12 @@ int vtkIdList::Allocate(const vtkIdType sz, const int vtkNotUsed(strategy))
     {
     this->Initialize();
     this->Size = ( sz > 0 ? sz : 1);
-    if ( (this->Ids = new vtkIdType[this->Size]) == NULL )
+    vtkArrayAllocator *allocator;
+    vtkIdType *newIds = this->AllocateIds(this->Size, allocator);
+    this->SetIds(newIds, allocator);
+    if ( this->Ids == NULL )
       {
+      this->Size = 0;
       return 0;
       }
     }
@@ -133,7 +215,9 @@ void vtkIdList::DeepCopy(vtkIdList *ids)
   this->Initialize();
   this->NumberOfIds = ids->NumberOfIds;
   this->Size = ids->Size;
-  this->Ids = new vtkIdType [ids->Size];
+  vtkArrayAllocator *allocator;
+  vtkIdType *newIds = this->AllocateIds(ids->Size, allocator);
+  this->SetIds(newIds, allocator);
   for (vtkIdType i=0; i < ids->NumberOfIds; i++)
     {
     this->Ids[i] = ids->Ids[i];
@@ -164,7 +248,24 @@ vtkIdType *vtkIdList::Resize(const vtkIdType sz)
     return 0;
     }
 
-  if ( (newIds = new vtkIdType[newSize]) == NULL )
+  // Ids that came from an allocator are resized by that allocator.
+  if ( this->Ids != NULL && this->StorageAllocator != NULL )
+    {
+    newIds = static_cast<vtkIdType *>(this->StorageAllocator->Reallocate(
+      this->Ids, static_cast<size_t>(this->Size) * sizeof(vtkIdType),
+      static_cast<size_t>(newSize) * sizeof(vtkIdType)));
+    if ( newIds == NULL )
+      {
+      vtkErrorMacro(<< "Cannot allocate memory\n");
+      return 0;
+      }
+    this->Size = newSize;
+    this->Ids = newIds;
+    return this->Ids;
+    }
+
+  vtkArrayAllocator *allocator;
+  if ( (newIds = this->AllocateIds(newSize, allocator)) == NULL )
     { 
     vtkErrorMacro(<< "Cannot allocate memory\n");
     return 0;
@@ -174,11 +275,11 @@ vtkIdType *vtkIdList::Resize(const vtkIdType sz)
     {
     memcpy(newIds, this->Ids,
            static_cast<size_t>(sz < this->Size ? sz : this->Size) * sizeof(vtkIdType));
-    delete [] this->Ids;
+    this->FreeIds();
     }
 
   this->Size = newSize;
-  this->Ids = newIds;
+  this->SetIds(newIds, allocator);
   return this->Ids;
 }
 
@@ -236,4 +337,5 @@ void vtkIdList::PrintSelf(ostream& os, vtkIndent indent)
   this->Superclass::PrintSelf(os,indent);
 
   os << indent << "Number of Ids: " << this->NumberOfIds << "\n";
+  os << indent << "Allocator: " << this->Allocator << "\n";
 }
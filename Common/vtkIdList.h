@@ -23,6 +23,8 @@
 
 #include "vtkObject.h"
 
+class vtkArrayAllocator;
+
 class VTK_COMMON_EXPORT vtkIdList : public vtkObject
 {
 public:
@@ -102,6 +104,14 @@ public:
   // to result of intersection operation.
   void IntersectWith(vtkIdList& otherIds);
 
+  // Description:
+  // Set/Get the allocator used for the ids. When it is NULL (the default)
+  // the global allocator is used, see
+  // vtkArrayAllocator::SetGlobalAllocator(), and when both are NULL the
+  // ids are allocated with new[].
+  void SetAllocator(vtkArrayAllocator *allocator);
+  vtkGetObjectMacro(Allocator, vtkArrayAllocator);
+
 protected:
   vtkIdList();
   ~vtkIdList();
@@ -110,7 +120,13 @@ protected:
   vtkIdType Size; 
   vtkIdType *Ids;
 
+  vtkArrayAllocator *Allocator;        // allocator set by the user
+  vtkArrayAllocator *StorageAllocator; // allocator that owns Ids
+
   vtkIdType *Resize(const vtkIdType sz);
+  vtkIdType *AllocateIds(vtkIdType sz, vtkArrayAllocator *&allocator);
+  void SetIds(vtkIdType *ids, vtkArrayAllocator *allocator);
+  void FreeIds();
 private:
   vtkIdList(const vtkIdList&);  // Not implemented.
   void operator=(const vtkIdList&);  // Not implemented.
@@ -15,6 +15,7 @@
 #include "vtkInformation.h"
 
 #include "vtkCommand.h"
+#include "vtkDebugLeaks.h"
 #include "vtkGarbageCollector.h"
 #include "vtkInformationDataObjectKey.h"
 #include "vtkInformationDoubleKey.h"
@@ -25,7 +26,6 @@
 #include "vtkInformationIntegerKey.h"
 #include "vtkInformationIntegerPointerKey.h"
 #include "vtkInformationIntegerVectorKey.h"
-#include "vtkInformationIterator.h"
 #include "vtkInformationKeyVectorKey.h"
 #include "vtkInformationObjectBaseKey.h"
 #include "vtkInformationRequestKey.h"
@@ -33,7 +33,6 @@
 #include "vtkInformationStringVectorKey.h"
 #include "vtkInformationUnsignedLongKey.h"
 #include "vtkObjectFactory.h"
-#include "vtkSmartPointer.h"
 
 #include <vtkstd/algorithm>
 #include <vtkstd/utility>
@@ -76,12 +75,10 @@ void vtkInformation::PrintSelf(ostream& os, vtkIndent indent)
 //----------------------------------------------------------------------------
 void vtkInformation::PrintKeys(ostream& os, vtkIndent indent)
 {
-  typedef vtkInformationInternals::MapType MapType;
-  for(MapType::const_iterator i = this->Internal->Map.begin();
-      i != this->Internal->Map.end(); ++i)
+  for(int i = 0; i < this->Internal->NumberOfEntries; ++i)
     {
     // Print the key name first.
-    vtkInformationKey* key = i->first;
+    vtkInformationKey* key = this->Internal->Entries[i].Key;
     os << indent << key->GetName() << ": ";
 
     // Ask the key to print its value.
@@ -111,17 +108,7 @@ void vtkInformation::Modified(vtkInformationKey* key)
 // Return the number of keys as a result of iteration.
 int vtkInformation::GetNumberOfKeys()
 {
-  vtkSmartPointer<vtkInformationIterator> infoIterator = 
-    vtkSmartPointer<vtkInformationIterator>::New();
-  infoIterator->SetInformation( this );
-
-  int numberOfKeys = 0;
-  for (infoIterator->InitTraversal(); !infoIterator->IsDoneWithTraversal();
-    infoIterator->GoToNextItem())
-    {
-    numberOfKeys++;
-    }
-  return numberOfKeys;
+  return this->Internal->NumberOfEntries;
 }
 
 //----------------------------------------------------------------------------
@@ -132,26 +119,27 @@ void vtkInformation::SetAsObjectBase(vtkInformationKey* key,
     {
     return;
     }
-  typedef vtkInformationInternals::MapType MapType;
-  MapType::iterator i = this->Internal->Map.find(key);
-  if(i != this->Internal->Map.end())
+  if(vtkInformationInternals::Entry* entry = this->Internal->Find(key))
     {
-    vtkObjectBase* oldvalue = i->second;
     if(newvalue)
       {
-      i->second = newvalue;
+      vtkObjectBase* oldvalue = entry->Value;
+      entry->Value = newvalue;
+      entry->OutOfLine = 0;
       newvalue->Register(0);
+      if(oldvalue)
+        {
+        oldvalue->UnRegister(0);
+        }
       }
     else
       {
-      this->Internal->Map.erase(i);
+      this->Internal->Erase(entry);
       }
-    oldvalue->UnRegister(0);
     }
   else if(newvalue)
     {
-    MapType::value_type entry(key, newvalue);
-    this->Internal->Map.insert(entry);
+    this->Internal->Insert(key)->Value = newvalue;
     newvalue->Register(0);
     }
   this->Modified(key);
@@ -162,16 +150,122 @@ vtkObjectBase* vtkInformation::GetAsObjectBase(vtkInformationKey* key)
 {
   if(key)
     {
-    typedef vtkInformationInternals::MapType MapType;
-    MapType::const_iterator i = this->Internal->Map.find(key);
-    if(i != this->Internal->Map.end())
+    if(vtkInformationInternals::Entry* entry = this->Internal->Find(key))
       {
-      return i->second;
+      return entry->Value;
       }
     }
   return 0;
 }
 
+//----------------------------------------------------------------------------
+void vtkInformation::SetAsInteger(vtkInformationKey* key, int value)
+{
+  vtkInformationInternals::Entry* entry = this->Internal->Find(key);
+  if(!entry)
+    {
+    entry = this->Internal->Insert(key);
+    }
+  else if(entry->OutOfLine)
+    {
+    vtkInformationScalarValue* v =
+      static_cast<vtkInformationScalarValue*>(entry->Value);
+    if(v->Scalar.Integer != value)
+      {
+      v->Scalar.Integer = value;
+      this->Modified(key);
+      }
+    return;
+    }
+  else if(!entry->Value && entry->Scalar.Integer == value)
+    {
+    return;
+    }
+  if(vtkObjectBase* oldvalue = entry->Value)
+    {
+    entry->Value = 0;
+    oldvalue->UnRegister(0);
+    }
+  entry->Scalar.Integer = value;
+  this->Modified(key);
+}
+
+//----------------------------------------------------------------------------
+int* vtkInformation::GetAsIntegerAddress(vtkInformationKey* key)
+{
+  vtkInformationInternals::Entry* entry = this->Internal->Find(key);
+  if(entry && entry->OutOfLine)
+    {
+    return &static_cast<vtkInformationScalarValue*>(entry->Value)->Scalar.Integer;
+    }
+  return (entry && !entry->Value)? &entry->Scalar.Integer : 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkInformation::SetAsDouble(vtkInformationKey* key, double value)
+{
+  vtkInformationInternals::Entry* entry = this->Internal->Find(key);
+  if(!entry)
+    {
+    entry = this->Internal->Insert(key);
+    }
+  else if(entry->OutOfLine)
+    {
+    vtkInformationScalarValue* v =
+      static_cast<vtkInformationScalarValue*>(entry->Value);
+    if(v->Scalar.Double != value)
+      {
+      v->Scalar.Double = value;
+      this->Modified(key);
+      }
+    return;
+    }
+  else if(!entry->Value && entry->Scalar.Double == value)
+    {
+    return;
+    }
+  if(vtkObjectBase* oldvalue = entry->Value)
+    {
+    entry->Value = 0;
+    oldvalue->UnRegister(0);
+    }
+  entry->Scalar.Double = value;
+  this->Modified(key);
+}
+
+//----------------------------------------------------------------------------
+double* vtkInformation::GetAsDoubleAddress(vtkInformationKey* key)
+{
+  vtkInformationInternals::Entry* entry = this->Internal->Find(key);
+  if(entry && entry->OutOfLine)
+    {
+    return &static_cast<vtkInformationScalarValue*>(entry->Value)->Scalar.Double;
+    }
+  return (entry && !entry->Value)? &entry->Scalar.Double : 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkInformation::MoveScalarOutOfLine(vtkInformationKey* key)
+{
+  vtkInformationInternals::Entry* entry = this->Internal->Find(key);
+  if(entry && !entry->Value)
+    {
+    vtkInformationScalarValue* v = new vtkInformationScalarValue;
+#ifdef VTK_DEBUG_LEAKS
+    vtkDebugLeaks::ConstructClass("vtkInformationScalarValue");
+#endif
+    v->Scalar = entry->Scalar;
+    entry->Value = v;
+    entry->OutOfLine = 1;
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkInformation::HasEntry(vtkInformationKey* key)
+{
+  return (key && this->Internal->Find(key))? 1 : 0;
+}
+
 //----------------------------------------------------------------------------
 void vtkInformation::Clear()
 {
@@ -181,18 +275,17 @@ void vtkInformation::Clear()
 //----------------------------------------------------------------------------
 void vtkInformation::Copy(vtkInformation* from, int deep)
 {
-  vtkInformationInternals* oldInternal = this->Internal;
-  this->Internal = new vtkInformationInternals;
+  // The old entries are released after the copy in case they hold
+  // references to the source.
+  vtkInformationInternals oldInternal;
+  oldInternal.Swap(*this->Internal);
   if(from)
     {
-    typedef vtkInformationInternals::MapType MapType;
-    for(MapType::const_iterator i = from->Internal->Map.begin();
-        i != from->Internal->Map.end(); ++i)
+    for(int i = 0; i < from->Internal->NumberOfEntries; ++i)
       {
-      this->CopyEntry(from, i->first, deep);
+      this->CopyEntry(from, from->Internal->Entries[i].Key, deep);
       }
     }
-  delete oldInternal;
 }
 
 //----------------------------------------------------------------------------
@@ -805,11 +898,9 @@ void vtkInformation::ReportReferences(vtkGarbageCollector* collector)
 {
   this->Superclass::ReportReferences(collector);
   // Ask each key/value pair to report any references it holds.
-  typedef vtkInformationInternals::MapType MapType;
-  for(MapType::const_iterator i = this->Internal->Map.begin();
-      i != this->Internal->Map.end(); ++i)
+  for(int i = 0; i < this->Internal->NumberOfEntries; ++i)
     {
-    i->first->Report(this, collector);
+    this->Internal->Entries[i].Key->Report(this, collector);
     }
 }
 
@@ -819,11 +910,10 @@ void vtkInformation::ReportAsObjectBase(vtkInformationKey* key,
 {
   if(key)
     {
-    typedef vtkInformationInternals::MapType MapType;
-    MapType::iterator i = this->Internal->Map.find(key);
-    if(i != this->Internal->Map.end())
+    vtkInformationInternals::Entry* entry = this->Internal->Find(key);
+    if(entry && entry->Value)
       {
-      vtkGarbageCollectorReport(collector, i->second, key->GetName());
+      vtkGarbageCollectorReport(collector, entry->Value, key->GetName());
       }
     }
 }
@@ -462,6 +462,24 @@ protected:
   VTK_COMMON_EXPORT void SetAsObjectBase(vtkInformationKey* key, vtkObjectBase* value);
   VTK_COMMON_EXPORT vtkObjectBase* GetAsObjectBase(vtkInformationKey* key);
 
+  // Get/Set an entry holding an integer or a double value itself instead
+  // of an object.  The Get methods return NULL when there is no such
+  // entry.  The address is valid until an entry is added or removed,
+  // unless the value has been moved out of line.
+  VTK_COMMON_EXPORT void SetAsInteger(vtkInformationKey* key, int value);
+  VTK_COMMON_EXPORT int* GetAsIntegerAddress(vtkInformationKey* key);
+  VTK_COMMON_EXPORT void SetAsDouble(vtkInformationKey* key, double value);
+  VTK_COMMON_EXPORT double* GetAsDoubleAddress(vtkInformationKey* key);
+
+  // Move the integer or double value of an entry out of the entry array,
+  // so that its address stays valid for as long as the key keeps an
+  // integer or double value.  Used to hand out watch addresses.
+  VTK_COMMON_EXPORT void MoveScalarOutOfLine(vtkInformationKey* key);
+
+  // Check whether there is an entry for the given key, whatever holds
+  // its value.
+  VTK_COMMON_EXPORT int HasEntry(vtkInformationKey* key);
+
   // Internal implementation details.
   vtkInformationInternals* Internal;
 
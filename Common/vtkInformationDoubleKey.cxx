@@ -35,49 +35,19 @@ void vtkInformationDoubleKey::PrintSelf(ostream& os, vtkIndent indent)
   this->Superclass::PrintSelf(os, indent);
 }
 
-//----------------------------------------------------------------------------
-class vtkInformationDoubleValue: public vtkObjectBase
-{
-public:
-  vtkTypeMacro(vtkInformationDoubleValue, vtkObjectBase);
-  double Value;
-};
-
 //----------------------------------------------------------------------------
 void vtkInformationDoubleKey::Set(vtkInformation* info, double value)
 {
-  if(vtkInformationDoubleValue* oldv =
-     static_cast<vtkInformationDoubleValue *>(
-       this->GetAsObjectBase(info)))
-    {
-    if (oldv->Value != value)
-      {
-      // Replace the existing value.
-      oldv->Value = value;
-      // Since this sets a value without call SetAsObjectBase(),
-      // the info has to be modified here (instead of 
-      // vtkInformation::SetAsObjectBase()
-      info->Modified(this);
-      }
-    }
-  else
-    {
-    // Allocate a new value.
-    vtkInformationDoubleValue* v = new vtkInformationDoubleValue;
-    this->ConstructClass("vtkInformationDoubleValue");
-    v->Value = value;
-    this->SetAsObjectBase(info, v);
-    v->Delete();
-    }
+  // The value is stored in the information object itself, which only
+  // invokes a modified event if the value changes.
+  this->SetAsDouble(info, value);
 }
 
 //----------------------------------------------------------------------------
 double vtkInformationDoubleKey::Get(vtkInformation* info)
 {
-  vtkInformationDoubleValue* v =
-    static_cast<vtkInformationDoubleValue *>(
-      this->GetAsObjectBase(info));
-  return v?v->Value:0;
+  double* v = this->GetAsDoubleAddress(info);
+  return v?*v:0;
 }
 
 //----------------------------------------------------------------------------
@@ -106,11 +76,8 @@ void vtkInformationDoubleKey::Print(ostream& os, vtkInformation* info)
 //----------------------------------------------------------------------------
 double* vtkInformationDoubleKey::GetWatchAddress(vtkInformation* info)
 {
-  if(vtkInformationDoubleValue* v =
-     static_cast<vtkInformationDoubleValue *>(
-       this->GetAsObjectBase(info)))
-    {
-    return &v->Value;
-    }
-  return 0;
+  // The value is stored in the entry array of the information object
+  // and would move when other entries are added or removed.
+  this->MoveScalarOutOfLine(info);
+  return this->GetAsDoubleAddress(info);
 }
@@ -35,49 +35,19 @@ void vtkInformationIntegerKey::PrintSelf(ostream& os, vtkIndent indent)
   this->Superclass::PrintSelf(os, indent);
 }
 
-//----------------------------------------------------------------------------
-class vtkInformationIntegerValue: public vtkObjectBase
-{
-public:
-  vtkTypeMacro(vtkInformationIntegerValue, vtkObjectBase);
-  int Value;
-};
-
 //----------------------------------------------------------------------------
 void vtkInformationIntegerKey::Set(vtkInformation* info, int value)
 {
-  if(vtkInformationIntegerValue* oldv =
-     static_cast<vtkInformationIntegerValue *>
-     (this->GetAsObjectBase(info)))
-    {
-    if (oldv->Value != value)
-      {
-      // Replace the existing value.
-      oldv->Value = value;
-      // Since this sets a value without call SetAsObjectBase(),
-      // the info has to be modified here (instead of 
-      // vtkInformation::SetAsObjectBase()
-      info->Modified(this);
-      }
-   }
-  else
-    {
-    // Allocate a new value.
-    vtkInformationIntegerValue* v = new vtkInformationIntegerValue;
-    this->ConstructClass("vtkInformationIntegerValue");
-    v->Value = value;
-    this->SetAsObjectBase(info, v);
-    v->Delete();
-    }
+  // The value is stored in the information object itself, which only
+  // invokes a modified event if the value changes.
+  this->SetAsInteger(info, value);
 }
 
 //----------------------------------------------------------------------------
 int vtkInformationIntegerKey::Get(vtkInformation* info)
 {
-  vtkInformationIntegerValue* v =
-    static_cast<vtkInformationIntegerValue *>
-    (this->GetAsObjectBase(info));
-  return v?v->Value:0;
+  int* v = this->GetAsIntegerAddress(info);
+  return v?*v:0;
 }
 
 //----------------------------------------------------------------------------
@@ -106,11 +76,8 @@ void vtkInformationIntegerKey::Print(ostream& os, vtkInformation* info)
 //----------------------------------------------------------------------------
 int* vtkInformationIntegerKey::GetWatchAddress(vtkInformation* info)
 {
-  if(vtkInformationIntegerValue* v =
-     static_cast<vtkInformationIntegerValue *>
-     (this->GetAsObjectBase(info)))
-    {
-    return &v->Value;
-    }
-  return 0;
+  // The value is stored in the entry array of the information object
+  // and would move when other entries are added or removed.
+  this->MoveScalarOutOfLine(info);
+  return this->GetAsIntegerAddress(info);
 }
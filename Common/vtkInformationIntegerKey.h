@@ -53,7 +53,8 @@ protected:
   // Description:
   // Get the address at which the actual value is stored.  This is
   // meant for use from a debugger to add watches and is therefore not
-  // a public method.
+  // a public method.  The address stays valid until the value is
+  // removed from the information object.
   int* GetWatchAddress(vtkInformation* info);
 
 private:
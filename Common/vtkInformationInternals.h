@@ -17,6 +17,16 @@
 // vtkInformationInternals is used in internal implementation of
 // vtkInformation. This should only be accessed by friends
 // and sub-classes of that class.
+//
+// The entries are kept in one contiguous array. The first
+// VTK_INFORMATION_INLINE_ENTRIES entries are stored in the object itself,
+// which covers the information objects used by the pipeline without any
+// allocation, and are searched linearly. A mask of the indices of the
+// keys present rejects most lookups of absent keys without a search. A
+// hash index from keys to entries is only built when there are more
+// entries. Integer and double values are stored in the entries rather
+// than in separately allocated objects, until their address is handed
+// out to be watched.
 
 #ifndef __vtkInformationInternals_h
 #define __vtkInformationInternals_h
@@ -24,12 +34,11 @@
 #include "vtkInformationKey.h"
 #include "vtkObjectBase.h"
 
-#define VTK_INFORMATION_USE_HASH_MAP
-#ifdef VTK_INFORMATION_USE_HASH_MAP
-# include <vtksys/hash_map.hxx>
-#else
-# include <vtksys/stl/map>
-#endif
+#include <vtksys/hash_map.hxx>
+
+#include <string.h>
+
+#define VTK_INFORMATION_INLINE_ENTRIES 16
 
 //----------------------------------------------------------------------------
 class vtkInformationInternals
@@ -37,36 +46,224 @@ class vtkInformationInternals
 public:
   typedef vtkInformationKey* KeyType;
   typedef vtkObjectBase* DataType;
-#ifdef VTK_INFORMATION_USE_HASH_MAP
+
+  union ScalarType
+  {
+    int Integer;
+    double Double;
+  };
+
+  // An entry references the object holding its value, or holds the
+  // value itself when Value is NULL. An integer or double value whose
+  // address has been handed out is moved into a vtkInformationScalarValue
+  // referenced by Value, flagged by OutOfLine, so that the address stays
+  // valid when entries are added or removed.
+  struct Entry
+  {
+    KeyType Key;
+    DataType Value;
+    ScalarType Scalar;
+    int OutOfLine;
+  };
+
   struct HashFun
   {
     size_t operator()(KeyType key) const
       {
-      return static_cast<size_t>(key - KeyType(0));
+      return static_cast<size_t>(key->GetIndex());
       }
   };
-  typedef vtksys::hash_map<KeyType, DataType, HashFun> MapType;
-#else
-  typedef vtksys_stl::map<KeyType, DataType> MapType;
-#endif
-  MapType Map;
+  typedef vtksys::hash_map<KeyType, int, HashFun> IndexType;
 
-#ifdef VTK_INFORMATION_USE_HASH_MAP
-  vtkInformationInternals(): Map(33) {}
-#endif
+  Entry* Entries;
+  int NumberOfEntries;
+
+  vtkInformationInternals()
+    {
+    this->Entries = this->InlineEntries;
+    this->NumberOfEntries = 0;
+    this->Capacity = VTK_INFORMATION_INLINE_ENTRIES;
+    this->KeyMask = 0;
+    this->Index = 0;
+    }
 
   ~vtkInformationInternals()
     {
-    for(MapType::iterator i = this->Map.begin(); i != this->Map.end(); ++i)
+    for(int i = 0; i < this->NumberOfEntries; ++i)
       {
-      if(vtkObjectBase* value = i->second)
+      if(vtkObjectBase* value = this->Entries[i].Value)
         {
         value->UnRegister(0);
         }
       }
+    this->ReleaseStorage();
+    }
+
+  // Return the entry of the given key, or NULL.
+  Entry* Find(KeyType key)
+    {
+    if(this->Index)
+      {
+      IndexType::const_iterator i = this->Index->find(key);
+      return i != this->Index->end()? this->Entries + i->second : 0;
+      }
+    if(!(this->KeyMask & vtkInformationInternals::KeyBit(key)))
+      {
+      return 0;
+      }
+    for(Entry* e = this->Entries; e != this->Entries+this->NumberOfEntries; ++e)
+      {
+      if(e->Key == key)
+        {
+        return e;
+        }
+      }
+    return 0;
+    }
+
+  // Add an entry for a key that is not present yet. The entry has no
+  // value.
+  Entry* Insert(KeyType key)
+    {
+    if(this->NumberOfEntries == this->Capacity)
+      {
+      this->Grow();
+      }
+    int i = this->NumberOfEntries++;
+    Entry* e = this->Entries + i;
+    e->Key = key;
+    e->Value = 0;
+    e->Scalar.Double = 0.0;
+    e->OutOfLine = 0;
+    this->KeyMask |= vtkInformationInternals::KeyBit(key);
+    if(this->Index)
+      {
+      (*this->Index)[key] = i;
+      }
+    else if(this->NumberOfEntries > VTK_INFORMATION_INLINE_ENTRIES)
+      {
+      this->Index = new IndexType(2*this->Capacity);
+      for(int j = 0; j < this->NumberOfEntries; ++j)
+        {
+        (*this->Index)[this->Entries[j].Key] = j;
+        }
+      }
+    return e;
+    }
+
+  // Remove an entry, releasing its value. The last entry takes its place
+  // so pointers to entries do not survive this call.
+  void Erase(Entry* e)
+    {
+    vtkObjectBase* value = e->Value;
+    int i = static_cast<int>(e - this->Entries);
+    int last = --this->NumberOfEntries;
+    if(this->Index)
+      {
+      this->Index->erase(e->Key);
+      if(i != last)
+        {
+        (*this->Index)[this->Entries[last].Key] = i;
+        }
+      }
+    if(i != last)
+      {
+      this->Entries[i] = this->Entries[last];
+      }
+    if(this->Index && this->NumberOfEntries <= VTK_INFORMATION_INLINE_ENTRIES)
+      {
+      delete this->Index;
+      this->Index = 0;
+      }
+    if(!this->Index)
+      {
+      this->KeyMask = 0;
+      for(int j = 0; j < this->NumberOfEntries; ++j)
+        {
+        this->KeyMask |= vtkInformationInternals::KeyBit(this->Entries[j].Key);
+        }
+      }
+    if(value)
+      {
+      value->UnRegister(0);
+      }
+    }
+
+  // Exchange the entries of two information objects. Values keep their
+  // references.
+  void Swap(vtkInformationInternals& other)
+    {
+    // Only the inline entries in use are exchanged.
+    int n = (this->Entries == this->InlineEntries)? this->NumberOfEntries : 0;
+    if(other.Entries == other.InlineEntries && other.NumberOfEntries > n)
+      {
+      n = other.NumberOfEntries;
+      }
+    Entry inlineEntries[VTK_INFORMATION_INLINE_ENTRIES];
+    memcpy(inlineEntries, this->InlineEntries, n*sizeof(Entry));
+    memcpy(this->InlineEntries, other.InlineEntries, n*sizeof(Entry));
+    memcpy(other.InlineEntries, inlineEntries, n*sizeof(Entry));
+    Entry* entries = this->Entries;
+    this->Entries = (other.Entries == other.InlineEntries)?
+      this->InlineEntries : other.Entries;
+    other.Entries = (entries == this->InlineEntries)?
+      other.InlineEntries : entries;
+    n = this->NumberOfEntries;
+    this->NumberOfEntries = other.NumberOfEntries;
+    other.NumberOfEntries = n;
+    n = this->Capacity;
+    this->Capacity = other.Capacity;
+    other.Capacity = n;
+    vtkTypeUInt64 mask = this->KeyMask;
+    this->KeyMask = other.KeyMask;
+    other.KeyMask = mask;
+    IndexType* index = this->Index;
+    this->Index = other.Index;
+    other.Index = index;
+    }
+
+private:
+  Entry InlineEntries[VTK_INFORMATION_INLINE_ENTRIES];
+  int Capacity;
+  vtkTypeUInt64 KeyMask;
+  IndexType* Index;
+
+  static vtkTypeUInt64 KeyBit(KeyType key)
+    {
+    return static_cast<vtkTypeUInt64>(1) << (key->GetIndex() & 63);
+    }
+
+  void Grow()
+    {
+    int capacity = 2*this->Capacity;
+    Entry* entries = new Entry[capacity];
+    memcpy(entries, this->Entries, this->NumberOfEntries*sizeof(Entry));
+    if(this->Entries != this->InlineEntries)
+      {
+      delete [] this->Entries;
+      }
+    this->Entries = entries;
+    this->Capacity = capacity;
+    }
+
+  void ReleaseStorage()
+    {
+    if(this->Entries != this->InlineEntries)
+      {
+      delete [] this->Entries;
+      }
+    delete this->Index;
+    this->Index = 0;
     }
 };
 
-#undef VTK_INFORMATION_USE_HASH_MAP
+//----------------------------------------------------------------------------
+// Holds an integer or double value moved out of an entry.
+class vtkInformationScalarValue: public vtkObjectBase
+{
+public:
+  vtkTypeMacro(vtkInformationScalarValue, vtkObjectBase);
+  vtkInformationInternals::ScalarType Scalar;
+};
 
 #endif
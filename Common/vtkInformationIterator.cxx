@@ -26,13 +26,14 @@ vtkCxxSetObjectMacro(vtkInformationIterator, Information, vtkInformation);
 class vtkInformationIteratorInternals
 {
 public:
-  vtkInformationInternals::MapType::iterator Iterator;
+  int Index;
 };
 
 //----------------------------------------------------------------------------
 vtkInformationIterator::vtkInformationIterator()
 {
   this->Internal = new vtkInformationIteratorInternals;
+  this->Internal->Index = 0;
   this->Information = 0;
 }
 
@@ -54,7 +55,7 @@ void vtkInformationIterator::GoToFirstItem()
     vtkErrorMacro("No information has been set.");
     return;
     }
-  this->Internal->Iterator = this->Information->Internal->Map.begin();
+  this->Internal->Index = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -66,7 +67,7 @@ void vtkInformationIterator::GoToNextItem()
     return;
     }
 
-  ++this->Internal->Iterator;
+  ++this->Internal->Index;
 }
 
 //----------------------------------------------------------------------------
@@ -78,7 +79,7 @@ int vtkInformationIterator::IsDoneWithTraversal()
     return 1;
     }
 
-  if(this->Internal->Iterator == this->Information->Internal->Map.end())
+  if(this->Internal->Index >= this->Information->Internal->NumberOfEntries)
     {
     return 1;
     }
@@ -93,7 +94,7 @@ vtkInformationKey* vtkInformationIterator::GetCurrentKey()
     return 0;
     }
 
-  return this->Internal->Iterator->first;
+  return this->Information->Internal->Entries[this->Internal->Index].Key;
 }
 
 //----------------------------------------------------------------------------
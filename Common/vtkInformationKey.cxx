@@ -36,14 +36,48 @@ public:
     {
     info->ReportAsObjectBase(key, collector);
     }
+  static void SetAsInteger(vtkInformation* info, vtkInformationKey* key,
+                           int value)
+    {
+    info->SetAsInteger(key, value);
+    }
+  static int* GetAsIntegerAddress(vtkInformation* info,
+                                  vtkInformationKey* key)
+    {
+    return info->GetAsIntegerAddress(key);
+    }
+  static void SetAsDouble(vtkInformation* info, vtkInformationKey* key,
+                          double value)
+    {
+    info->SetAsDouble(key, value);
+    }
+  static double* GetAsDoubleAddress(vtkInformation* info,
+                                    vtkInformationKey* key)
+    {
+    return info->GetAsDoubleAddress(key);
+    }
+  static void MoveScalarOutOfLine(vtkInformation* info,
+                                  vtkInformationKey* key)
+    {
+    info->MoveScalarOutOfLine(key);
+    }
+  static int HasEntry(vtkInformation* info, vtkInformationKey* key)
+    {
+    return info->HasEntry(key);
+    }
 };
 
+//----------------------------------------------------------------------------
+// Index given to the next key created.
+static int vtkInformationKeyNextIndex = 0;
+
 //----------------------------------------------------------------------------
 vtkInformationKey::vtkInformationKey(const char* name, const char* location)
 {
   // Save the name and location.
   this->Name = name;
   this->Location = location;
+  this->Index = vtkInformationKeyNextIndex++;
 }
 
 //----------------------------------------------------------------------------
@@ -93,10 +127,42 @@ vtkObjectBase* vtkInformationKey::GetAsObjectBase(vtkInformation* info)
   return vtkInformationKeyToInformationFriendship::GetAsObjectBase(info, this);
 }
 
+//----------------------------------------------------------------------------
+void vtkInformationKey::SetAsInteger(vtkInformation* info, int value)
+{
+  vtkInformationKeyToInformationFriendship::SetAsInteger(info, this, value);
+}
+
+//----------------------------------------------------------------------------
+int* vtkInformationKey::GetAsIntegerAddress(vtkInformation* info)
+{
+  return vtkInformationKeyToInformationFriendship::GetAsIntegerAddress(info,
+                                                                      this);
+}
+
+//----------------------------------------------------------------------------
+void vtkInformationKey::SetAsDouble(vtkInformation* info, double value)
+{
+  vtkInformationKeyToInformationFriendship::SetAsDouble(info, this, value);
+}
+
+//----------------------------------------------------------------------------
+double* vtkInformationKey::GetAsDoubleAddress(vtkInformation* info)
+{
+  return vtkInformationKeyToInformationFriendship::GetAsDoubleAddress(info,
+                                                                     this);
+}
+
+//----------------------------------------------------------------------------
+void vtkInformationKey::MoveScalarOutOfLine(vtkInformation* info)
+{
+  vtkInformationKeyToInformationFriendship::MoveScalarOutOfLine(info, this);
+}
+
 //----------------------------------------------------------------------------
 int vtkInformationKey::Has(vtkInformation* info)
 {
-  return this->GetAsObjectBase(info)?1:0;
+  return vtkInformationKeyToInformationFriendship::HasEntry(info, this);
 }
 
 //----------------------------------------------------------------------------
@@ -55,6 +55,11 @@ public:
   // which the key is defined.
   const char* GetLocation();
 
+  // Description:
+  // Get the index of the key.  Keys are numbered in the order in which
+  // they are created; vtkInformation uses the index to find its entries.
+  int GetIndex() { return this->Index; }
+
   // Description:
   // Key instances are static data that need to be created and
   // destroyed.  The constructor and destructor must be public.  The
@@ -98,12 +103,25 @@ public:
 protected:
   const char* Name;
   const char* Location;
+  int Index;
 
   // Set/Get the value associated with this key instance in the given
   // information object.
   void SetAsObjectBase(vtkInformation* info, vtkObjectBase* value);
   vtkObjectBase* GetAsObjectBase(vtkInformation* info);
 
+  // Set/Get an integer or double value stored in the given information
+  // object itself, see vtkInformationIntegerKey and
+  // vtkInformationDoubleKey.
+  void SetAsInteger(vtkInformation* info, int value);
+  int* GetAsIntegerAddress(vtkInformation* info);
+  void SetAsDouble(vtkInformation* info, double value);
+  double* GetAsDoubleAddress(vtkInformation* info);
+
+  // Keep the address of the integer or double value stored in the given
+  // information object valid when other entries are added or removed.
+  void MoveScalarOutOfLine(vtkInformation* info);
+
   // Report the object associated with this key instance in the given
   // information object to the collector.
   void ReportAsObjectBase(vtkInformation* info,
@@ -14,10 +14,14 @@
 =========================================================================*/
 #include "vtkMultiThreader.h"
 
+#include "vtkConditionVariable.h"
 #include "vtkMutexLock.h"
 #include "vtkObjectFactory.h"
 #include "vtkWindows.h"
 
+#include <vtkstd/deque>
+#include <vtkstd/vector>
+
 vtkStandardNewMacro(vtkMultiThreader);
 
 // These are the includes necessary for multithreaded rendering on an SGI
@@ -45,6 +49,393 @@ typedef vtkThreadFunctionType vtkExternCThreadFunctionType;
 #include <sys/sysctl.h>
 #endif
 
+// The thread pool is only available with POSIX or Win32 threads.
+#if (defined(VTK_USE_PTHREADS) && !defined(VTK_HP_PTHREADS)) || \
+  defined(VTK_USE_WIN32_THREADS)
+#define VTK_MULTITHREADER_USE_POOL
+#endif
+
+#ifdef VTK_MULTITHREADER_USE_POOL
+//----------------------------------------------------------------------------
+// vtkMultiThreaderPool is the process-wide pool of persistent worker
+// threads used when UseThreadPool is on. A job is run by at most a given
+// number of threads, its runners, which take the tasks of the job one at a
+// time until none is left. The thread submitting a job is one of them; the
+// others are queued. Each worker owns a queue of runners. It runs the
+// runners from the front of its own queue and, once that is empty, steals
+// runners from the back of the other queues. The thread submitting a job
+// runs queued runners as well until all the runners of its job are done,
+// so jobs may be submitted from inside a task.
+class vtkMultiThreaderPool
+{
+public:
+  struct Task
+  {
+    vtkThreadFunctionType Function;
+    vtkMultiThreader::ThreadInfo *Info;
+  };
+
+  struct Job
+  {
+    Task *Tasks;
+    int NumberOfTasks;
+    int NextTask;
+    int Runners;
+  };
+
+  static vtkMultiThreaderPool *GetInstance();
+  static void DeleteInstance();
+  static int GetNumberOfThreads();
+
+  // Run the tasks on at most numberOfThreads threads, the calling thread
+  // included, and return once they have all completed.
+  void Execute(int numberOfTasks, Task *tasks, int numberOfThreads);
+
+protected:
+  vtkMultiThreaderPool();
+  ~vtkMultiThreaderPool();
+
+  static VTK_THREAD_RETURN_TYPE WorkerMain(void *arg);
+  void Resize(int numberOfWorkers);
+  int PopRunner(int queue, Job* &job);
+  void RunJob(Job *job);
+
+  // Lock protects everything but the queues, which have their own locks.
+  vtkSimpleMutexLock Lock;
+  vtkSimpleConditionVariable WorkAvailable;
+  vtkSimpleConditionVariable WorkDone;
+  int PendingRunners;
+  int Stop;
+  int NextQueue;
+  int NumberOfWorkers;
+  int NumberOfActiveWorkers;
+
+  vtkThreadProcessIDType Workers[VTK_MAX_THREADS];
+  vtkMultiThreader::ThreadInfo WorkerInfo[VTK_MAX_THREADS];
+  vtkstd::deque<Job *> Queues[VTK_MAX_THREADS];
+  vtkSimpleMutexLock QueueLocks[VTK_MAX_THREADS];
+
+  static vtkMultiThreaderPool *Instance;
+  static vtkSimpleMutexLock InstanceLock;
+};
+
+vtkMultiThreaderPool *vtkMultiThreaderPool::Instance = 0;
+vtkSimpleMutexLock vtkMultiThreaderPool::InstanceLock;
+
+// Stop the pool threads when the program exits.
+class vtkMultiThreaderPoolCleanup
+{
+public:
+  ~vtkMultiThreaderPoolCleanup() { vtkMultiThreaderPool::DeleteInstance(); }
+};
+static vtkMultiThreaderPoolCleanup vtkMultiThreaderPoolCleanupInstance;
+
+//----------------------------------------------------------------------------
+vtkMultiThreaderPool::vtkMultiThreaderPool()
+{
+  this->PendingRunners = 0;
+  this->Stop = 0;
+  this->NextQueue = 0;
+  this->NumberOfWorkers = 0;
+  this->NumberOfActiveWorkers = 0;
+  for (int i = 0; i < VTK_MAX_THREADS; i++)
+    {
+    this->WorkerInfo[i].ThreadID = i;
+    this->WorkerInfo[i].NumberOfThreads = 1;
+    this->WorkerInfo[i].ActiveFlag = NULL;
+    this->WorkerInfo[i].ActiveFlagLock = NULL;
+    this->WorkerInfo[i].UserData = this;
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkMultiThreaderPool::~vtkMultiThreaderPool()
+{
+  this->Lock.Lock();
+  this->Stop = 1;
+  this->WorkAvailable.Broadcast();
+  this->Lock.Unlock();
+
+  for (int i = 0; i < this->NumberOfWorkers; i++)
+    {
+#ifdef VTK_USE_WIN32_THREADS
+    WaitForSingleObject(this->Workers[i], INFINITE);
+    CloseHandle(this->Workers[i]);
+#else
+    pthread_join(this->Workers[i], NULL);
+#endif
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkMultiThreaderPool *vtkMultiThreaderPool::GetInstance()
+{
+  vtkMultiThreaderPool::InstanceLock.Lock();
+  if (!vtkMultiThreaderPool::Instance)
+    {
+    vtkMultiThreaderPool::Instance = new vtkMultiThreaderPool;
+    }
+  vtkMultiThreaderPool::InstanceLock.Unlock();
+  return vtkMultiThreaderPool::Instance;
+}
+
+//----------------------------------------------------------------------------
+void vtkMultiThreaderPool::DeleteInstance()
+{
+  vtkMultiThreaderPool::InstanceLock.Lock();
+  delete vtkMultiThreaderPool::Instance;
+  vtkMultiThreaderPool::Instance = 0;
+  vtkMultiThreaderPool::InstanceLock.Unlock();
+}
+
+//----------------------------------------------------------------------------
+int vtkMultiThreaderPool::GetNumberOfThreads()
+{
+  int num = 0;
+  vtkMultiThreaderPool::InstanceLock.Lock();
+  if (vtkMultiThreaderPool::Instance)
+    {
+    vtkMultiThreaderPool::Instance->Lock.Lock();
+    num = vtkMultiThreaderPool::Instance->NumberOfActiveWorkers;
+    vtkMultiThreaderPool::Instance->Lock.Unlock();
+    }
+  vtkMultiThreaderPool::InstanceLock.Unlock();
+  return num;
+}
+
+//----------------------------------------------------------------------------
+// Must be called with this->Lock held.
+void vtkMultiThreaderPool::Resize(int numberOfWorkers)
+{
+  if (numberOfWorkers > VTK_MAX_THREADS)
+    {
+    numberOfWorkers = VTK_MAX_THREADS;
+    }
+
+  // Workers are never destroyed before the pool is; the ones beyond
+  // numberOfWorkers simply stop taking tasks.
+  while (this->NumberOfWorkers < numberOfWorkers)
+    {
+    int i = this->NumberOfWorkers;
+#ifdef VTK_USE_WIN32_THREADS
+    DWORD threadId;
+    this->Workers[i] = CreateThread(NULL, 0, vtkMultiThreaderPool::WorkerMain,
+      static_cast<void *>(&this->WorkerInfo[i]), 0, &threadId);
+    if (this->Workers[i] == NULL)
+      {
+      break;
+      }
+#else
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    int threadError = pthread_create(&this->Workers[i], &attr,
+      reinterpret_cast<vtkExternCThreadFunctionType>(
+        vtkMultiThreaderPool::WorkerMain),
+      static_cast<void *>(&this->WorkerInfo[i]));
+    pthread_attr_destroy(&attr);
+    if (threadError != 0)
+      {
+      break;
+      }
+#endif
+    this->NumberOfWorkers++;
+    }
+
+  this->NumberOfActiveWorkers =
+    (numberOfWorkers < this->NumberOfWorkers ?
+     numberOfWorkers : this->NumberOfWorkers);
+}
+
+//----------------------------------------------------------------------------
+// Take a runner from the given queue, or steal one from another queue.
+int vtkMultiThreaderPool::PopRunner(int queue, Job* &job)
+{
+  int found = 0;
+  int i;
+
+  if (queue >= 0)
+    {
+    this->QueueLocks[queue].Lock();
+    if (!this->Queues[queue].empty())
+      {
+      job = this->Queues[queue].front();
+      this->Queues[queue].pop_front();
+      found = 1;
+      }
+    this->QueueLocks[queue].Unlock();
+    }
+
+  for (i = 0; !found && i < this->NumberOfWorkers; i++)
+    {
+    if (i == queue)
+      {
+      continue;
+      }
+    this->QueueLocks[i].Lock();
+    if (!this->Queues[i].empty())
+      {
+      job = this->Queues[i].back();
+      this->Queues[i].pop_back();
+      found = 1;
+      }
+    this->QueueLocks[i].Unlock();
+    }
+
+  if (found)
+    {
+    this->Lock.Lock();
+    this->PendingRunners--;
+    this->Lock.Unlock();
+    }
+  return found;
+}
+
+//----------------------------------------------------------------------------
+// Run the tasks of the job left to run, one at a time.
+void vtkMultiThreaderPool::RunJob(Job *job)
+{
+  for (;;)
+    {
+    this->Lock.Lock();
+    int next = job->NextTask++;
+    this->Lock.Unlock();
+    if (next >= job->NumberOfTasks)
+      {
+      break;
+      }
+    job->Tasks[next].Function(static_cast<void *>(job->Tasks[next].Info));
+    }
+
+  this->Lock.Lock();
+  if (--job->Runners == 0)
+    {
+    this->WorkDone.Broadcast();
+    }
+  this->Lock.Unlock();
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkMultiThreaderPool::WorkerMain(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *info =
+    static_cast<vtkMultiThreader::ThreadInfo *>(arg);
+  vtkMultiThreaderPool *self =
+    static_cast<vtkMultiThreaderPool *>(info->UserData);
+  int index = info->ThreadID;
+  vtkMultiThreaderPool::Job *job;
+
+  for (;;)
+    {
+    self->Lock.Lock();
+    while (!self->Stop &&
+           (self->PendingRunners <= 0 ||
+            index >= self->NumberOfActiveWorkers))
+      {
+      self->WorkAvailable.Wait(self->Lock);
+      }
+    int stop = self->Stop;
+    self->Lock.Unlock();
+    if (stop)
+      {
+      break;
+      }
+
+    if (self->PopRunner(index, job))
+      {
+      self->RunJob(job);
+      }
+    }
+
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+void vtkMultiThreaderPool::Execute(int numberOfTasks, Task *tasks,
+                                   int numberOfThreads)
+{
+  Job job;
+  int i;
+
+  // The calling thread is one of the threads running the tasks.
+  int numberOfWorkers = vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+  int maxThreads = vtkMultiThreader::GetGlobalMaximumNumberOfThreads();
+  if (maxThreads > 0 && numberOfWorkers > maxThreads)
+    {
+    numberOfWorkers = maxThreads;
+    }
+  numberOfWorkers--;
+
+  this->Lock.Lock();
+  this->Resize(numberOfWorkers);
+  int numberOfQueues = this->NumberOfActiveWorkers;
+  this->Lock.Unlock();
+
+  int numberOfRunners = numberOfThreads;
+  if (numberOfRunners > numberOfTasks)
+    {
+    numberOfRunners = numberOfTasks;
+    }
+  if (numberOfRunners > numberOfQueues + 1)
+    {
+    numberOfRunners = numberOfQueues + 1;
+    }
+
+  if (numberOfRunners <= 1)
+    {
+    for (i = 0; i < numberOfTasks; i++)
+      {
+      tasks[i].Function(static_cast<void *>(tasks[i].Info));
+      }
+    return;
+    }
+
+  job.Tasks = tasks;
+  job.NumberOfTasks = numberOfTasks;
+  job.NextTask = 0;
+  job.Runners = numberOfRunners;
+  for (i = 1; i < numberOfRunners; i++)
+    {
+    int queue;
+    this->Lock.Lock();
+    queue = this->NextQueue++ % numberOfQueues;
+    this->Lock.Unlock();
+    this->QueueLocks[queue].Lock();
+    this->Queues[queue].push_back(&job);
+    this->QueueLocks[queue].Unlock();
+    }
+
+  this->Lock.Lock();
+  this->PendingRunners += numberOfRunners - 1;
+  this->WorkAvailable.Broadcast();
+  this->Lock.Unlock();
+
+  this->RunJob(&job);
+
+  // Help with the queued runners, then wait for the ones still running.
+  Job *other;
+  for (;;)
+    {
+    if (this->PopRunner(-1, other))
+      {
+      this->RunJob(other);
+      continue;
+      }
+    this->Lock.Lock();
+    while (job.Runners > 0 && this->PendingRunners <= 0)
+      {
+      this->WorkDone.Wait(this->Lock);
+      }
+    int runners = job.Runners;
+    this->Lock.Unlock();
+    if (runners == 0)
+      {
+      break;
+      }
+    }
+}
+#endif
+
+
 // Initialize static member that controls global maximum number of threads
 static int vtkMultiThreaderGlobalMaximumNumberOfThreads = 0;
 
@@ -164,6 +555,8 @@ vtkMultiThreader::vtkMultiThreader()
   this->SingleMethod = NULL;
   this->NumberOfThreads = 
     vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
+  this->UseThreadPool = 0;
+  this->NumberOfPieces = 0;
 
 }
 
@@ -258,7 +651,29 @@ void vtkMultiThreader::SingleMethodExecute()
     {
     this->NumberOfThreads = vtkMultiThreaderGlobalMaximumNumberOfThreads;
     }
-  
+
+#ifdef VTK_MULTITHREADER_USE_POOL
+  if (this->UseThreadPool)
+    {
+    int numberOfPieces =
+      (this->NumberOfPieces > 0 ? this->NumberOfPieces : this->NumberOfThreads);
+    vtkstd::vector<ThreadInfo> info(numberOfPieces);
+    vtkstd::vector<vtkMultiThreaderPool::Task> tasks(numberOfPieces);
+    for (thread_loop = 0; thread_loop < numberOfPieces; thread_loop++)
+      {
+      info[thread_loop].ThreadID        = thread_loop;
+      info[thread_loop].NumberOfThreads = numberOfPieces;
+      info[thread_loop].ActiveFlag      = NULL;
+      info[thread_loop].ActiveFlagLock  = NULL;
+      info[thread_loop].UserData        = this->SingleData;
+      tasks[thread_loop].Function       = this->SingleMethod;
+      tasks[thread_loop].Info           = &info[thread_loop];
+      }
+    vtkMultiThreaderPool::GetInstance()->Execute(numberOfPieces, &tasks[0],
+                                                 this->NumberOfThreads);
+    return;
+    }
+#endif
     
   // We are using sproc (on SGIs), pthreads(on Suns), or a single thread
   // (the default)  
@@ -448,6 +863,25 @@ void vtkMultiThreader::MultipleMethodExecute()
       }
     }
 
+#ifdef VTK_MULTITHREADER_USE_POOL
+  if (this->UseThreadPool)
+    {
+    vtkMultiThreaderPool::Task tasks[VTK_MAX_THREADS];
+    for (thread_loop = 0; thread_loop < this->NumberOfThreads; thread_loop++)
+      {
+      this->ThreadInfoArray[thread_loop].UserData =
+        this->MultipleData[thread_loop];
+      this->ThreadInfoArray[thread_loop].NumberOfThreads =
+        this->NumberOfThreads;
+      tasks[thread_loop].Function = this->MultipleMethod[thread_loop];
+      tasks[thread_loop].Info = &this->ThreadInfoArray[thread_loop];
+      }
+    vtkMultiThreaderPool::GetInstance()->Execute(this->NumberOfThreads, tasks,
+                                                 this->NumberOfThreads);
+    return;
+    }
+#endif
+
   // We are using sproc (on SGIs), pthreads(on Suns), CreateThread
   // on a PC or a single thread (the default)  
 
@@ -764,6 +1198,16 @@ void vtkMultiThreader::TerminateThread( int threadID )
 
 }
 
+//----------------------------------------------------------------------------
+int vtkMultiThreader::GetNumberOfThreadPoolThreads()
+{
+#ifdef VTK_MULTITHREADER_USE_POOL
+  return vtkMultiThreaderPool::GetNumberOfThreads();
+#else
+  return 0;
+#endif
+}
+
 //----------------------------------------------------------------------------
 vtkMultiThreaderIDType vtkMultiThreader::GetCurrentThreadID()
 {
@@ -827,6 +1271,9 @@ void vtkMultiThreader::PrintSelf(ostream& os, vtkIndent indent)
   this->Superclass::PrintSelf(os,indent); 
 
   os << indent << "Thread Count: " << this->NumberOfThreads << "\n";
+  os << indent << "Use Thread Pool: "
+     << (this->UseThreadPool ? "On" : "Off") << "\n";
+  os << indent << "Number Of Pieces: " << this->NumberOfPieces << "\n";
   os << indent << "Global Maximum Number Of Threads: " << 
     vtkMultiThreaderGlobalMaximumNumberOfThreads << endl;
   os << "Thread system used: " <<
@@ -18,6 +18,14 @@
 // execution using sproc() on an SGI, or pthread_create on any platform
 // supporting POSIX threads.  This class can be used to execute a single
 // method on multiple threads, or to specify a method per thread. 
+//
+// By default each call to SingleMethodExecute() or MultipleMethodExecute()
+// creates and joins its own threads. When UseThreadPool is on, the methods
+// are instead run as tasks on a process-wide pool of persistent worker
+// threads, and SingleMethodExecute() may split the work into more pieces
+// than there are threads (see NumberOfPieces). The pieces are handed out
+// one at a time to at most NumberOfThreads threads of the pool, which
+// balances the load when pieces take different amounts of time.
 
 #ifndef __vtkMultiThreader_h
 #define __vtkMultiThreader_h
@@ -138,6 +146,34 @@ public:
   static void SetGlobalDefaultNumberOfThreads(int val);
   static int  GetGlobalDefaultNumberOfThreads();
 
+  // Description:
+  // When UseThreadPool is on, SingleMethodExecute and MultipleMethodExecute
+  // run their methods on the process-wide pool of persistent threads
+  // instead of creating new threads on every call. The pool has
+  // GetGlobalDefaultNumberOfThreads() threads (the calling thread
+  // included), capped by GetGlobalMaximumNumberOfThreads(), and each
+  // execution runs on at most NumberOfThreads of them. The pieces of one
+  // execution may run one after the other on the same thread, so the
+  // methods must not wait for each other (e.g. with a barrier). This is
+  // ignored when threads are implemented with sproc(). Initial value is off.
+  vtkSetMacro(UseThreadPool, int);
+  vtkGetMacro(UseThreadPool, int);
+  vtkBooleanMacro(UseThreadPool, int);
+
+  // Description:
+  // Number of pieces SingleMethodExecute splits the work into when
+  // UseThreadPool is on. The single method is called once per piece with
+  // a ThreadID in [0, NumberOfPieces) and a NumberOfThreads equal to the
+  // number of pieces. A value of zero (the default) uses NumberOfThreads
+  // pieces.
+  vtkSetClampMacro(NumberOfPieces, int, 0, VTK_LARGE_INTEGER);
+  vtkGetMacro(NumberOfPieces, int);
+
+  // Description:
+  // Get the number of threads currently in the process-wide thread pool,
+  // not counting the threads that submit work to it.
+  static int GetNumberOfThreadPoolThreads();
+
   // These methods are excluded from Tcl wrapping 1) because the
   // wrapper gives up on them and 2) because they really shouldn't be
   // called from a script anyway.
@@ -197,6 +233,10 @@ protected:
   // The number of threads to use
   int                        NumberOfThreads;
 
+  // Thread pool settings
+  int                        UseThreadPool;
+  int                        NumberOfPieces;
+
   // An array of thread info containing a thread id
   // (0, 1, 2, .. VTK_MAX_THREADS-1), the thread count, and a pointer
   // to void so that user data can be passed to each thread
@@ -0,0 +1,252 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkPoolArrayAllocator.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkPoolArrayAllocator.h"
+
+#include "vtkCriticalSection.h"
+#include "vtkObjectFactory.h"
+
+#include <vtkstd/vector>
+
+vtkStandardNewMacro(vtkPoolArrayAllocator);
+
+// Every block starts with a header recording its size class, so that the
+// block goes back to the right free list. The header keeps the data as
+// aligned as malloc() does.
+union vtkPoolArrayAllocatorHeader
+{
+  int SizeClass; // -1 for the blocks that bypass the pool
+  double Align[2];
+};
+
+class vtkPoolArrayAllocatorInternals
+{
+public:
+  // FreeLists[c] holds the free blocks of size class c.
+  vtkstd::vector<vtkstd::vector<vtkPoolArrayAllocatorHeader *> > FreeLists;
+};
+
+//----------------------------------------------------------------------------
+// Size classes: 64 bytes, then four classes per power of two, so that
+// less than a quarter of a block is ever wasted.
+static int vtkPoolArrayAllocatorSizeClass(size_t size)
+{
+  if (size <= 64)
+    {
+    return 0;
+    }
+  int k = 6;
+  while ((static_cast<size_t>(1) << (k+1)) < size)
+    {
+    ++k;
+    }
+  // 2^k < size <= 2^(k+1)
+  size_t base = static_cast<size_t>(1) << k;
+  size_t step = base >> 2;
+  int j = static_cast<int>((size - base + step - 1) / step);
+  return 1 + 4*(k-6) + (j-1);
+}
+
+//----------------------------------------------------------------------------
+static size_t vtkPoolArrayAllocatorClassSize(int sizeClass)
+{
+  if (sizeClass == 0)
+    {
+    return 64;
+    }
+  size_t base = static_cast<size_t>(1) << (6 + (sizeClass-1)/4);
+  return base + ((sizeClass-1)%4 + 1)*(base >> 2);
+}
+
+//----------------------------------------------------------------------------
+vtkPoolArrayAllocator::vtkPoolArrayAllocator()
+{
+  this->MaximumBlockSize = 64*1024*1024;
+  this->MaximumCachedBytes = 256*1024*1024;
+  this->CachedBytes = 0;
+  this->Internals = new vtkPoolArrayAllocatorInternals;
+}
+
+//----------------------------------------------------------------------------
+vtkPoolArrayAllocator::~vtkPoolArrayAllocator()
+{
+  this->ReleaseCachedMemory();
+  delete this->Internals;
+}
+
+//----------------------------------------------------------------------------
+void *vtkPoolArrayAllocator::Allocate(size_t size)
+{
+  vtkPoolArrayAllocatorHeader *header;
+  int sizeClass = -1;
+  size_t blockSize = size;
+
+  if (size <= static_cast<size_t>(this->MaximumBlockSize))
+    {
+    sizeClass = vtkPoolArrayAllocatorSizeClass(size);
+    blockSize = vtkPoolArrayAllocatorClassSize(sizeClass);
+
+    this->Lock->Lock();
+    if (sizeClass < static_cast<int>(this->Internals->FreeLists.size()) &&
+        !this->Internals->FreeLists[sizeClass].empty())
+      {
+      header = this->Internals->FreeLists[sizeClass].back();
+      this->Internals->FreeLists[sizeClass].pop_back();
+      this->CachedBytes -= static_cast<vtkIdType>(blockSize);
+      this->CountAllocation(size, 1);
+      this->Lock->Unlock();
+      return header + 1;
+      }
+    this->Lock->Unlock();
+    }
+
+  header = static_cast<vtkPoolArrayAllocatorHeader *>(
+    malloc(sizeof(vtkPoolArrayAllocatorHeader) + blockSize));
+  if (!header)
+    {
+    return 0;
+    }
+  header->SizeClass = sizeClass;
+
+  this->Lock->Lock();
+  this->CountAllocation(size, 0);
+  this->Lock->Unlock();
+  return header + 1;
+}
+
+//----------------------------------------------------------------------------
+void *vtkPoolArrayAllocator::Reallocate(void *ptr, size_t oldSize,
+                                        size_t newSize)
+{
+  if (!ptr)
+    {
+    return this->Allocate(newSize);
+    }
+
+  vtkPoolArrayAllocatorHeader *header =
+    static_cast<vtkPoolArrayAllocatorHeader *>(ptr) - 1;
+  int newFitsPool = (newSize <= static_cast<size_t>(this->MaximumBlockSize));
+
+  // The block is already big enough.
+  if (header->SizeClass >= 0 && newFitsPool &&
+      vtkPoolArrayAllocatorSizeClass(newSize) == header->SizeClass)
+    {
+    this->Lock->Lock();
+    this->CountFree(oldSize);
+    this->CountAllocation(newSize, 1);
+    this->Lock->Unlock();
+    return ptr;
+    }
+
+  // Neither the old nor the new size goes through the pool.
+  if (header->SizeClass < 0 && !newFitsPool)
+    {
+    vtkPoolArrayAllocatorHeader *newHeader =
+      static_cast<vtkPoolArrayAllocatorHeader *>(
+        realloc(header, sizeof(vtkPoolArrayAllocatorHeader) + newSize));
+    if (!newHeader)
+      {
+      return 0;
+      }
+    this->Lock->Lock();
+    this->CountFree(oldSize);
+    this->CountAllocation(newSize, 0);
+    this->Lock->Unlock();
+    return newHeader + 1;
+    }
+
+  void *newPtr = this->Allocate(newSize);
+  if (!newPtr)
+    {
+    return 0;
+    }
+  memcpy(newPtr, ptr, oldSize < newSize ? oldSize : newSize);
+  this->Free(ptr, oldSize);
+  return newPtr;
+}
+
+//----------------------------------------------------------------------------
+void vtkPoolArrayAllocator::Free(void *ptr, size_t size)
+{
+  if (!ptr)
+    {
+    return;
+    }
+
+  vtkPoolArrayAllocatorHeader *header =
+    static_cast<vtkPoolArrayAllocatorHeader *>(ptr) - 1;
+  int sizeClass = header->SizeClass;
+
+  this->Lock->Lock();
+  this->CountFree(size);
+  if (sizeClass >= 0)
+    {
+    size_t blockSize = vtkPoolArrayAllocatorClassSize(sizeClass);
+    if (this->CachedBytes + static_cast<vtkIdType>(blockSize) <=
+        this->MaximumCachedBytes)
+      {
+      if (sizeClass >= static_cast<int>(this->Internals->FreeLists.size()))
+        {
+        this->Internals->FreeLists.resize(sizeClass + 1);
+        }
+      this->Internals->FreeLists[sizeClass].push_back(header);
+      this->CachedBytes += static_cast<vtkIdType>(blockSize);
+      header = 0;
+      }
+    }
+  this->Lock->Unlock();
+
+  if (header)
+    {
+    free(header);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkPoolArrayAllocator::ReleaseCachedMemory()
+{
+  this->Lock->Lock();
+  size_t i, j;
+  for (i = 0; i < this->Internals->FreeLists.size(); i++)
+    {
+    vtkstd::vector<vtkPoolArrayAllocatorHeader *> &freeList =
+      this->Internals->FreeLists[i];
+    for (j = 0; j < freeList.size(); j++)
+      {
+      free(freeList[j]);
+      }
+    freeList.clear();
+    }
+  this->CachedBytes = 0;
+  this->Lock->Unlock();
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkPoolArrayAllocator::GetCachedBytes()
+{
+  this->Lock->Lock();
+  vtkIdType value = this->CachedBytes;
+  this->Lock->Unlock();
+  return value;
+}
+
+//----------------------------------------------------------------------------
+void vtkPoolArrayAllocator::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "MaximumBlockSize: " << this->MaximumBlockSize << "\n";
+  os << indent << "MaximumCachedBytes: " << this->MaximumCachedBytes << "\n";
+  os << indent << "CachedBytes: " << this->GetCachedBytes() << "\n";
+}
@@ -0,0 +1,85 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkPoolArrayAllocator.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkPoolArrayAllocator - array allocator that recycles freed blocks
+// .SECTION Description
+// vtkPoolArrayAllocator rounds every request up to one of a set of size
+// classes (four per power of two) and keeps freed blocks in a free list
+// per class, so that the next request of a similar size reuses a block
+// instead of going back to the system allocator. This removes most of
+// the malloc/free traffic of pipelines that create and discard arrays of
+// the same sizes on every update. Requests larger than MaximumBlockSize
+// bypass the pool, and at most MaximumCachedBytes are kept in the free
+// lists.
+// .SECTION See also
+// vtkArrayAllocator vtkArenaArrayAllocator
+
+#ifndef __vtkPoolArrayAllocator_h
+#define __vtkPoolArrayAllocator_h
+
+#include "vtkArrayAllocator.h"
+
+//BTX
+class vtkPoolArrayAllocatorInternals;
+//ETX
+
+class VTK_COMMON_EXPORT vtkPoolArrayAllocator : public vtkArrayAllocator
+{
+public:
+  static vtkPoolArrayAllocator *New();
+  vtkTypeMacro(vtkPoolArrayAllocator,vtkArrayAllocator);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+//BTX
+  virtual void *Allocate(size_t size);
+  virtual void *Reallocate(void *ptr, size_t oldSize, size_t newSize);
+  virtual void Free(void *ptr, size_t size);
+//ETX
+
+  // Description:
+  // Free all the blocks kept in the free lists.
+  virtual void ReleaseCachedMemory();
+
+  // Description:
+  // Requests larger than this many bytes are passed to the system
+  // allocator. Initial value is 64 MB.
+  vtkSetClampMacro(MaximumBlockSize, vtkIdType, 64, VTK_LARGE_ID);
+  vtkGetMacro(MaximumBlockSize, vtkIdType);
+
+  // Description:
+  // The largest number of bytes kept in the free lists. Blocks freed
+  // beyond that are returned to the system. Initial value is 256 MB.
+  vtkSetClampMacro(MaximumCachedBytes, vtkIdType, 0, VTK_LARGE_ID);
+  vtkGetMacro(MaximumCachedBytes, vtkIdType);
+
+  // Description:
+  // The number of bytes currently kept in the free lists.
+  vtkIdType GetCachedBytes();
+
+protected:
+  vtkPoolArrayAllocator();
+  ~vtkPoolArrayAllocator();
+
+  vtkIdType MaximumBlockSize;
+  vtkIdType MaximumCachedBytes;
+  vtkIdType CachedBytes;
+
+  vtkPoolArrayAllocatorInternals *Internals;
+
+private:
+  vtkPoolArrayAllocator(const vtkPoolArrayAllocator&);  // Not implemented.
+  void operator=(const vtkPoolArrayAllocator&);  // Not implemented.
+};
+
+#endif
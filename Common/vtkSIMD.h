@@ -0,0 +1,45 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkSIMD.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkSIMD - detect the vector instructions available to filters.
+// .SECTION Description
+// This header defines VTK_USE_SSE2 and includes the SSE2 intrinsics when
+// the compiler targets a processor that has them, which is always the
+// case on x86-64. Filters put their vectorized loops between
+// "#ifdef VTK_USE_SSE2" and "#endif" and keep a scalar loop for the
+// other processors. Define VTK_NO_SSE2 to compile the scalar loops only.
+//
+// vtkSIMDIsAligned() tells whether a pointer allows aligned loads and
+// stores. Data arrays can be given aligned storage with
+// vtkDataArray::SetAlignment() and vtkDataArray::SetGlobalAlignment().
+
+#ifndef __vtkSIMD_h
+#define __vtkSIMD_h
+
+#include "vtkSystemIncludes.h"
+
+#if !defined(VTK_NO_SSE2) && (defined(__SSE2__) || defined(_M_X64) || \
+  (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+# define VTK_USE_SSE2
+# include <emmintrin.h> // Needed for the SSE2 intrinsics
+#endif
+
+// Return true when ptr is a multiple of alignment bytes, which must be a
+// power of two.
+inline bool vtkSIMDIsAligned(const void *ptr, size_t alignment)
+{
+  return (reinterpret_cast<size_t>(ptr) & (alignment - 1)) == 0;
+}
+
+#endif
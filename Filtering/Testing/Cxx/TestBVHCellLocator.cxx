@@ -0,0 +1,363 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestBVHCellLocator.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME
+// .SECTION Description
+// Checks the queries of vtkBVHCellLocator against vtkModifiedBSPTree and
+// brute force searches on a triangulated surface and a volume, and
+// reports the time of ray casts with both locators and with packets.
+
+#include "vtkBVHCellLocator.h"
+#include "vtkCellArray.h"
+#include "vtkDoubleArray.h"
+#include "vtkGenericCell.h"
+#include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
+#include "vtkImageData.h"
+#include "vtkMath.h"
+#include "vtkModifiedBSPTree.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkTestUtilities.h"
+#include "vtkTimerLog.h"
+
+#include <math.h>
+
+// A bumpy sphere without its polar caps, made of 2*res*res triangles and
+// denser near one end.
+static vtkPolyData *MakeSurface(int res)
+{
+  vtkPoints *points = vtkPoints::New();
+  vtkCellArray *polys = vtkCellArray::New();
+  int i, j;
+  for (j = 0; j <= res; j++)
+    {
+    double v = static_cast<double>(j)/res;
+    double theta = vtkMath::DoublePi()*(0.02 + 0.96*v*v);
+    for (i = 0; i < res; i++)
+      {
+      double phi = 2.0*vtkMath::DoublePi()*i/res;
+      double r = 1.0 + 0.05*sin(7.0*phi)*sin(5.0*theta);
+      points->InsertNextPoint(r*sin(theta)*cos(phi), r*sin(theta)*sin(phi),
+                              r*cos(theta));
+      }
+    }
+  for (j = 0; j < res; j++)
+    {
+    for (i = 0; i < res; i++)
+      {
+      vtkIdType a = j*res + i, b = j*res + (i + 1) % res;
+      vtkIdType tri1[3] = {a, b, a + res};
+      vtkIdType tri2[3] = {b, b + res, a + res};
+      polys->InsertNextCell(3, tri1);
+      polys->InsertNextCell(3, tri2);
+      }
+    }
+  vtkPolyData *surface = vtkPolyData::New();
+  surface->SetPoints(points);
+  surface->SetPolys(polys);
+  points->Delete();
+  polys->Delete();
+  return surface;
+}
+
+static void RandomPoint(double x[3], double size)
+{
+  for (int j = 0; j < 3; j++)
+    {
+    x[j] = vtkMath::Random(-size, size);
+    }
+}
+
+static int TestRays(vtkPolyData *surface, int threads)
+{
+  vtkSmartPointer<vtkBVHCellLocator> bvh =
+    vtkSmartPointer<vtkBVHCellLocator>::New();
+  bvh->SetDataSet(surface);
+  bvh->SetNumberOfThreads(threads);
+  bvh->BuildLocator();
+  vtkSmartPointer<vtkModifiedBSPTree> bsp =
+    vtkSmartPointer<vtkModifiedBSPTree>::New();
+  bsp->SetDataSet(surface);
+  bsp->BuildLocator();
+
+  const int numRays = 5000;
+  vtkSmartPointer<vtkPoints> p1 = vtkSmartPointer<vtkPoints>::New();
+  vtkSmartPointer<vtkPoints> p2 = vtkSmartPointer<vtkPoints>::New();
+  p1->SetDataTypeToDouble();
+  p2->SetDataTypeToDouble();
+  p1->SetNumberOfPoints(numRays);
+  p2->SetNumberOfPoints(numRays);
+  double a[3], b[3], t1, t2, x1[3], x2[3], pcoords[3];
+  int subId, i, hits = 0;
+  vtkIdType cell1, cell2;
+  for (i = 0; i < numRays; i++)
+    {
+    // Segments from outside to random points, some of which stop short
+    // of the surface.
+    RandomPoint(a, 2.0);
+    RandomPoint(b, 1.2);
+    p1->SetPoint(i, a);
+    p2->SetPoint(i, b);
+    int hit1 = bvh->IntersectWithLine(a, b, 0.0, t1, x1, pcoords, subId,
+                                      cell1);
+    int hit2 = bsp->IntersectWithLine(a, b, 0.0, t2, x2, pcoords, subId,
+                                      cell2);
+    if (hit1 != hit2 || (hit1 && fabs(t1 - t2) > 1.0e-9))
+      {
+      cerr << "Ray " << i << " hits cell " << cell1 << " at " << t1
+           << " instead of " << cell2 << " at " << t2 << endl;
+      return 0;
+      }
+    hits += hit1;
+    }
+  if (hits < numRays/10)
+    {
+    cerr << "Only " << hits << " rays hit the surface" << endl;
+    return 0;
+    }
+
+  // Packets give the same hits as single rays.
+  vtkSmartPointer<vtkIdTypeArray> cellIds =
+    vtkSmartPointer<vtkIdTypeArray>::New();
+  vtkSmartPointer<vtkDoubleArray> ts = vtkSmartPointer<vtkDoubleArray>::New();
+  vtkSmartPointer<vtkPoints> xs = vtkSmartPointer<vtkPoints>::New();
+  xs->SetDataTypeToDouble();
+  if (bvh->IntersectWithLines(p1, p2, 0.0, cellIds, ts, xs) != hits)
+    {
+    cerr << "Packets hit the surface a different number of times" << endl;
+    return 0;
+    }
+  for (i = 0; i < numRays; i++)
+    {
+    p1->GetPoint(i, a);
+    p2->GetPoint(i, b);
+    if (!bvh->IntersectWithLine(a, b, 0.0, t1, x1, pcoords, subId, cell1))
+      {
+      cell1 = -1;
+      }
+    xs->GetPoint(i, x2);
+    if (cellIds->GetValue(i) != cell1 ||
+        (cell1 >= 0 && (ts->GetValue(i) != t1 ||
+                        vtkMath::Distance2BetweenPoints(x1, x2) != 0.0)))
+      {
+      cerr << "Packet ray " << i << " hits cell " << cellIds->GetValue(i)
+           << " instead of " << cell1 << endl;
+      return 0;
+      }
+    }
+
+  // Cells along a line and within bounds.
+  vtkSmartPointer<vtkIdList> cells = vtkSmartPointer<vtkIdList>::New();
+  double bounds[6] = {-0.3, 0.2, -1.5, 1.5, 0.1, 0.4};
+  bvh->FindCellsWithinBounds(bounds, cells);
+  vtkIdType count = 0;
+  for (i = 0; i < surface->GetNumberOfCells(); i++)
+    {
+    double cb[6];
+    surface->GetCellBounds(i, cb);
+    if (cb[0] <= bounds[1] && cb[1] >= bounds[0] && cb[2] <= bounds[3] &&
+        cb[3] >= bounds[2] && cb[4] <= bounds[5] && cb[5] >= bounds[4])
+      {
+      count++;
+      if (cells->IsId(i) < 0)
+        {
+        cerr << "Cell " << i << " missing within bounds" << endl;
+        return 0;
+        }
+      }
+    }
+  if (cells->GetNumberOfIds() != count)
+    {
+    cerr << cells->GetNumberOfIds() << " cells within bounds instead of "
+         << count << endl;
+    return 0;
+    }
+  p1->GetPoint(0, a);
+  p2->GetPoint(0, b);
+  bvh->FindCellsAlongLine(a, b, 0.0, cells);
+  if (bvh->IntersectWithLine(a, b, 0.0, t1, x1, pcoords, subId, cell1) &&
+      cells->IsId(cell1) < 0)
+    {
+    cerr << "Hit cell missing along the line" << endl;
+    return 0;
+    }
+
+  // Closest points against a brute force search.
+  vtkSmartPointer<vtkGenericCell> cell = vtkSmartPointer<vtkGenericCell>::New();
+  double weights[3], dist2, closest[3];
+  for (int q = 0; q < 50; q++)
+    {
+    RandomPoint(a, 1.5);
+    bvh->FindClosestPoint(a, closest, cell, cell1, subId, dist2);
+    double best = VTK_DOUBLE_MAX;
+    for (i = 0; i < surface->GetNumberOfCells(); i++)
+      {
+      double d2;
+      surface->GetCell(i, cell);
+      cell->EvaluatePosition(a, x2, subId, pcoords, d2, weights);
+      best = d2 < best ? d2 : best;
+      }
+    if (cell1 < 0 || fabs(dist2 - best) > 1.0e-12)
+      {
+      cerr << "Closest point at " << dist2 << " instead of " << best << endl;
+      return 0;
+      }
+    int inside;
+    if (bvh->FindClosestPointWithinRadius(a, 0.5*sqrt(best), closest, cell,
+                                          cell1, subId, dist2, inside))
+      {
+      cerr << "Closest point found beyond the radius" << endl;
+      return 0;
+      }
+    }
+  return 1;
+}
+
+static int TestVolume()
+{
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(20, 15, 10);
+  image->SetSpacing(0.5, 1.0, 2.0);
+  vtkSmartPointer<vtkBVHCellLocator> bvh =
+    vtkSmartPointer<vtkBVHCellLocator>::New();
+  bvh->SetDataSet(image);
+  bvh->BuildLocator();
+  vtkSmartPointer<vtkGenericCell> cell = vtkSmartPointer<vtkGenericCell>::New();
+  double x[3], pcoords[3], weights[8];
+  for (int q = 0; q < 500; q++)
+    {
+    x[0] = vtkMath::Random(-1.0, 10.5);
+    x[1] = vtkMath::Random(-1.0, 15.0);
+    x[2] = vtkMath::Random(-1.0, 19.0);
+    int ijk[3];
+    double pc[3];
+    vtkIdType expected = -1;
+    // ComputeStructuredCoordinates() accepts points up to a spacing
+    // beyond the last samples.
+    if (x[0] <= 9.5 && x[1] <= 14.0 && x[2] <= 18.0 &&
+        image->ComputeStructuredCoordinates(x, ijk, pc))
+      {
+      expected = image->ComputeCellId(ijk);
+      }
+    vtkIdType found = bvh->FindCell(x, 0.0, cell, pcoords, weights);
+    if (found != expected)
+      {
+      cerr << "Found cell " << found << " instead of " << expected << endl;
+      return 0;
+      }
+    }
+  return 1;
+}
+
+// Time rays through a grid of pixels, as when picking or casting shadows.
+static void TimeRays(vtkPolyData *surface, int threads)
+{
+  vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+  timer->StartTimer();
+  vtkSmartPointer<vtkBVHCellLocator> bvh =
+    vtkSmartPointer<vtkBVHCellLocator>::New();
+  bvh->SetDataSet(surface);
+  bvh->SetNumberOfThreads(threads);
+  bvh->BuildLocator();
+  timer->StopTimer();
+  double bvhBuild = timer->GetElapsedTime();
+  timer->StartTimer();
+  vtkSmartPointer<vtkModifiedBSPTree> bsp =
+    vtkSmartPointer<vtkModifiedBSPTree>::New();
+  bsp->SetDataSet(surface);
+  bsp->BuildLocator();
+  // vtkModifiedBSPTree builds its tree on the first query.
+  double a[3] = {0.0, 0.0, 5.0}, b[3] = {0.0, 0.0, -5.0};
+  double t, x[3], pcoords[3];
+  int subId;
+  vtkIdType cellId;
+  bsp->IntersectWithLine(a, b, 0.0, t, x, pcoords, subId, cellId);
+  timer->StopTimer();
+  double bspBuild = timer->GetElapsedTime();
+
+  const int size = 200;
+  vtkSmartPointer<vtkPoints> p1 = vtkSmartPointer<vtkPoints>::New();
+  vtkSmartPointer<vtkPoints> p2 = vtkSmartPointer<vtkPoints>::New();
+  p1->SetNumberOfPoints(size*size);
+  p2->SetNumberOfPoints(size*size);
+  vtkIdType i = 0;
+  // Tiles of 4x2 pixels make the packets.
+  for (int tj = 0; tj < size; tj += 2)
+    {
+    for (int ti = 0; ti < size; ti += 4)
+      {
+      for (int j = tj; j < tj + 2; j++)
+        {
+        for (int k = ti; k < ti + 4; k++, i++)
+          {
+          p1->SetPoint(i, 0.0, 0.0, 5.0);
+          p2->SetPoint(i, 3.0*k/size - 1.5, 3.0*j/size - 1.5, -5.0);
+          }
+        }
+      }
+    }
+
+  timer->StartTimer();
+  for (i = 0; i < size*size; i++)
+    {
+    p1->GetPoint(i, a);
+    p2->GetPoint(i, b);
+    bsp->IntersectWithLine(a, b, 0.0, t, x, pcoords, subId, cellId);
+    }
+  timer->StopTimer();
+  double bspRays = timer->GetElapsedTime();
+  timer->StartTimer();
+  for (i = 0; i < size*size; i++)
+    {
+    p1->GetPoint(i, a);
+    p2->GetPoint(i, b);
+    bvh->IntersectWithLine(a, b, 0.0, t, x, pcoords, subId, cellId);
+    }
+  timer->StopTimer();
+  double bvhRays = timer->GetElapsedTime();
+  vtkSmartPointer<vtkIdTypeArray> cellIds =
+    vtkSmartPointer<vtkIdTypeArray>::New();
+  timer->StartTimer();
+  bvh->IntersectWithLines(p1, p2, 0.0, cellIds);
+  timer->StopTimer();
+  double packets = timer->GetElapsedTime();
+
+  cout << surface->GetNumberOfCells() << " triangles, " << size*size
+       << " rays. vtkModifiedBSPTree: build " << bspBuild << " s, rays "
+       << bspRays << " s. vtkBVHCellLocator: build " << bvhBuild
+       << " s, rays " << bvhRays << " s, packets on "
+       << bvh->GetNumberOfThreads() << " threads " << packets << " s ("
+       << bvh->GetNumberOfNodes() << " nodes)" << endl;
+}
+
+int TestBVHCellLocator(int, char *[])
+{
+  int threads = vtkTestUtilities::SetUpThreadPool(4);
+  vtkMath::RandomSeed(4137);
+
+  vtkPolyData *surface = MakeSurface(60);
+  int ok = TestRays(surface, threads) && TestVolume();
+  surface->Delete();
+  if (!ok)
+    {
+    return 1;
+    }
+
+  surface = MakeSurface(400);
+  TimeRays(surface, threads);
+  surface->Delete();
+  return 0;
+}
@@ -0,0 +1,258 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestBVHCellLocatorRefit.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME
+// .SECTION Description
+// Deforms a triangulated surface over several time steps, refitting a
+// vtkBVHCellLocator after each one, and checks that its queries agree with
+// a locator built from scratch. Reports the refit and rebuild times.
+
+#include "vtkBVHCellLocator.h"
+#include "vtkCellArray.h"
+#include "vtkGenericCell.h"
+#include "vtkIdList.h"
+#include "vtkMath.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkTimerLog.h"
+
+#include <math.h>
+
+// A res x res height field of triangles, moving as a wave over time.
+static void MovePoints(vtkPoints *points, int res, double time)
+{
+  vtkIdType id = 0;
+  for (int j = 0; j < res; j++)
+    {
+    for (int i = 0; i < res; i++, id++)
+      {
+      double x = static_cast<double>(i)/(res - 1);
+      double y = static_cast<double>(j)/(res - 1);
+      points->SetPoint(id, x + 0.05*sin(3.0*time + 4.0*y), y,
+                       0.2*sin(6.0*x + time)*cos(5.0*y - 2.0*time));
+      }
+    }
+  points->Modified();
+}
+
+static vtkCellArray *MakeTriangles(int res, int skip)
+{
+  vtkCellArray *polys = vtkCellArray::New();
+  for (int j = 0; j < res - 1; j++)
+    {
+    for (int i = 0; i < res - 1; i++)
+      {
+      vtkIdType a = j*res + i;
+      vtkIdType tri1[3] = {a, a + 1, a + res + 1};
+      vtkIdType tri2[3] = {a, a + res + 1, a + res};
+      polys->InsertNextCell(3, tri1);
+      if (skip <= 0 || (i + j) % skip)
+        {
+        polys->InsertNextCell(3, tri2);
+        }
+      }
+    }
+  return polys;
+}
+
+// Shift the cells by one point.
+static void ShiftCells(vtkCellArray *cells, vtkIdType numPts)
+{
+  vtkIdType *ids = cells->GetPointer();
+  for (vtkIdType i = 0; i < cells->GetNumberOfConnectivityEntries();
+       i += ids[i] + 1)
+    {
+    for (vtkIdType k = i + 1; k <= i + ids[i]; k++)
+      {
+      ids[k] = (ids[k] + 1) % numPts;
+      }
+    }
+  cells->Modified();
+}
+
+// Is the tree of the locator the one built from scratch, comparing the
+// boxes of their leaves.
+static int IsRebuilt(vtkBVHCellLocator *locator, vtkPolyData *surface)
+{
+  vtkSmartPointer<vtkBVHCellLocator> fresh =
+    vtkSmartPointer<vtkBVHCellLocator>::New();
+  fresh->SetDataSet(surface);
+  fresh->BuildLocator();
+  vtkSmartPointer<vtkPolyData> boxes1 = vtkSmartPointer<vtkPolyData>::New();
+  vtkSmartPointer<vtkPolyData> boxes2 = vtkSmartPointer<vtkPolyData>::New();
+  locator->GenerateRepresentation(-1, boxes1);
+  fresh->GenerateRepresentation(-1, boxes2);
+  vtkIdType n = boxes1->GetNumberOfPoints();
+  if (boxes2->GetNumberOfPoints() != n)
+    {
+    return 0;
+    }
+  for (vtkIdType i = 0; i < n; i++)
+    {
+    double x1[3], x2[3];
+    boxes1->GetPoint(i, x1);
+    boxes2->GetPoint(i, x2);
+    if (x1[0] != x2[0] || x1[1] != x2[1] || x1[2] != x2[2])
+      {
+      return 0;
+      }
+    }
+  return 1;
+}
+
+// Cast rays down through the surface and compare the hits, and the cells
+// found within bounds.
+static int Compare(vtkBVHCellLocator *refit, vtkPolyData *surface)
+{
+  vtkSmartPointer<vtkBVHCellLocator> fresh =
+    vtkSmartPointer<vtkBVHCellLocator>::New();
+  fresh->SetDataSet(surface);
+  fresh->BuildLocator();
+
+  double p1[3], p2[3], t1, t2, x1[3], x2[3], pcoords[3];
+  int subId;
+  vtkIdType cell1, cell2;
+  for (int r = 0; r < 2000; r++)
+    {
+    p1[0] = vtkMath::Random(-0.1, 1.1);
+    p1[1] = vtkMath::Random(-0.1, 1.1);
+    p1[2] = 1.0;
+    p2[0] = p1[0] + vtkMath::Random(-0.2, 0.2);
+    p2[1] = p1[1] + vtkMath::Random(-0.2, 0.2);
+    p2[2] = -1.0;
+    int hit1 = refit->IntersectWithLine(p1, p2, 0.0, t1, x1, pcoords, subId,
+                                        cell1);
+    int hit2 = fresh->IntersectWithLine(p1, p2, 0.0, t2, x2, pcoords, subId,
+                                        cell2);
+    if (hit1 != hit2 || (hit1 && (cell1 != cell2 || t1 != t2)))
+      {
+      cerr << "Ray " << r << " hits cell " << cell1 << " at " << t1
+           << " instead of " << cell2 << " at " << t2 << endl;
+      return 0;
+      }
+    }
+
+  vtkSmartPointer<vtkIdList> cells1 = vtkSmartPointer<vtkIdList>::New();
+  vtkSmartPointer<vtkIdList> cells2 = vtkSmartPointer<vtkIdList>::New();
+  double bounds[6] = {0.3, 0.5, 0.1, 0.9, -0.05, 0.05};
+  refit->FindCellsWithinBounds(bounds, cells1);
+  fresh->FindCellsWithinBounds(bounds, cells2);
+  if (cells1->GetNumberOfIds() != cells2->GetNumberOfIds())
+    {
+    cerr << cells1->GetNumberOfIds() << " cells within bounds instead of "
+         << cells2->GetNumberOfIds() << endl;
+    return 0;
+    }
+  for (vtkIdType i = 0; i < cells2->GetNumberOfIds(); i++)
+    {
+    if (cells1->IsId(cells2->GetId(i)) < 0)
+      {
+      cerr << "Cell " << cells2->GetId(i) << " missing within bounds" << endl;
+      return 0;
+      }
+    }
+  return 1;
+}
+
+int TestBVHCellLocatorRefit(int, char *[])
+{
+  vtkMath::RandomSeed(2718);
+  const int res = 300;
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetNumberOfPoints(res*res);
+  MovePoints(points, res, 0.0);
+  vtkSmartPointer<vtkPolyData> surface = vtkSmartPointer<vtkPolyData>::New();
+  surface->SetPoints(points);
+  vtkCellArray *polys = MakeTriangles(res, 0);
+  surface->SetPolys(polys);
+  polys->Delete();
+  // Other cells, as many, older than any build of the locator.
+  vtkCellArray *older = MakeTriangles(res, 0);
+  ShiftCells(older, res*res);
+
+  vtkSmartPointer<vtkBVHCellLocator> locator =
+    vtkSmartPointer<vtkBVHCellLocator>::New();
+  locator->RefitSearchStructureOn();
+  locator->SetDataSet(surface);
+  vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+  timer->StartTimer();
+  locator->BuildLocator();
+  timer->StopTimer();
+  double buildTime = timer->GetElapsedTime();
+  vtkIdType numNodes = locator->GetNumberOfNodes();
+  locator->BuildLocator();
+  if (!IsRebuilt(locator, surface))
+    {
+    cerr << "The tree changed without changes of the surface" << endl;
+    return 1;
+    }
+
+  // Time steps that only move the points are refitted.
+  double refitTime = 0.0;
+  const int steps = 5;
+  for (int step = 1; step <= steps; step++)
+    {
+    MovePoints(points, res, 0.4*step);
+    timer->StartTimer();
+    locator->BuildLocator();
+    timer->StopTimer();
+    refitTime += timer->GetElapsedTime();
+    if (!Compare(locator, surface))
+      {
+      cerr << "Refitted locator differs at step " << step << endl;
+      return 1;
+      }
+    }
+  if (locator->GetNumberOfNodes() != numNodes ||
+      IsRebuilt(locator, surface))
+    {
+    cerr << "The tree was rebuilt instead of refitted" << endl;
+    return 1;
+    }
+  cout << surface->GetNumberOfCells() << " cells: build " << buildTime
+       << " s, refit " << refitTime/steps << " s per step" << endl;
+
+  // Cell arrays replaced by older ones force a rebuild.
+  surface->SetPolys(older);
+  older->Delete();
+  locator->BuildLocator();
+  if (!IsRebuilt(locator, surface) || !Compare(locator, surface))
+    {
+    cerr << "Locator was not rebuilt for older cells" << endl;
+    return 1;
+    }
+
+  // New cells force a rebuild.
+  polys = MakeTriangles(res, 3);
+  surface->SetPolys(polys);
+  polys->Delete();
+  locator->BuildLocator();
+  if (!IsRebuilt(locator, surface) || !Compare(locator, surface))
+    {
+    cerr << "Locator was not rebuilt for new cells" << endl;
+    return 1;
+    }
+
+  // As do new cells in place, with the same number of cells.
+  ShiftCells(surface->GetPolys(), res*res);
+  surface->BuildCells();
+  locator->BuildLocator();
+  if (!IsRebuilt(locator, surface) || !Compare(locator, surface))
+    {
+    cerr << "Locator was not rebuilt for changed cells" << endl;
+    return 1;
+    }
+  return 0;
+}
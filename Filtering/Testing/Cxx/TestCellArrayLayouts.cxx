@@ -0,0 +1,416 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestCellArrayLayouts.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME
+// .SECTION Description
+// Fills cell arrays in the legacy and offsets layouts, converts between
+// them and checks traversal, random access, in-place edits, the pointers
+// handed out to the point ids of cells and the use of offsets layouts in a
+// vtkPolyData.
+
+#include "vtkCellArray.h"
+#include "vtkCell.h"
+#include "vtkIdList.h"
+#include "vtkIntArray.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+
+#define NUMBER_OF_CELLS 1000
+
+// Cell i has 3 + i%4 points, i, i+1, ...
+static void FillCells(vtkCellArray *ca)
+{
+  vtkIdType pts[6];
+  for (vtkIdType i = 0; i < NUMBER_OF_CELLS; i++)
+    {
+    vtkIdType npts = 3 + i%4;
+    for (vtkIdType j = 0; j < npts; j++)
+      {
+      pts[j] = i + j;
+      }
+    if (i%2)
+      {
+      ca->InsertNextCell(npts, pts);
+      }
+    else
+      {
+      // Insert one point too many and fix the count afterwards.
+      ca->InsertNextCell(static_cast<int>(npts) + 1);
+      for (vtkIdType j = 0; j < npts; j++)
+        {
+        ca->InsertCellPoint(pts[j]);
+        }
+      ca->UpdateCellCount(static_cast<int>(npts));
+      }
+    }
+}
+
+static int CheckCell(vtkIdType i, vtkIdType npts, const vtkIdType *pts,
+                     const char *what)
+{
+  if (npts != 3 + i%4)
+    {
+    cerr << what << ": wrong size for cell " << i << endl;
+    return 0;
+    }
+  for (vtkIdType j = 0; j < npts; j++)
+    {
+    if (pts[j] != i + j)
+      {
+      cerr << what << ": wrong point for cell " << i << endl;
+      return 0;
+      }
+    }
+  return 1;
+}
+
+// Reads the cells without the methods handing out pointers into the cell
+// array, so that the layout does not change.
+static int CheckCells(vtkCellArray *ca, const char *what)
+{
+  if (ca->GetNumberOfCells() != NUMBER_OF_CELLS)
+    {
+    cerr << what << ": wrong number of cells" << endl;
+    return 0;
+    }
+  int layout = ca->GetLayout();
+  vtkIdType i, npts, *pts;
+  vtkSmartPointer<vtkIdList> buffer = vtkSmartPointer<vtkIdList>::New();
+  ca->InitTraversal();
+  for (i = 0; ca->GetNextCell(npts, pts, buffer); i++)
+    {
+    if (!CheckCell(i, npts, pts, what))
+      {
+      return 0;
+      }
+    }
+  if (i != NUMBER_OF_CELLS)
+    {
+    cerr << what << ": traversal ended after " << i << " cells" << endl;
+    return 0;
+    }
+  vtkSmartPointer<vtkIdList> ids = vtkSmartPointer<vtkIdList>::New();
+  for (i = 0, ca->InitTraversal(); ca->GetNextCell(ids); i++)
+    {
+    if (!CheckCell(i, ids->GetNumberOfIds(), ids->GetPointer(0), what))
+      {
+      return 0;
+      }
+    }
+  for (i = NUMBER_OF_CELLS - 1; i >= 0; i -= 7)
+    {
+    ca->GetCellAtId(i, ids);
+    if (!CheckCell(i, ids->GetNumberOfIds(), ids->GetPointer(0), what) ||
+        ca->GetCellSize(i) != ids->GetNumberOfIds())
+      {
+      return 0;
+      }
+    }
+  if (ca->GetMaxCellSize() != 6)
+    {
+    cerr << what << ": wrong maximum cell size" << endl;
+    return 0;
+    }
+  if (ca->GetLayout() != layout)
+    {
+    cerr << what << ": reading the cells changed the layout" << endl;
+    return 0;
+    }
+  return 1;
+}
+
+// The pointers handed out stay valid together and point into the cells, so
+// that writing through them changes the cells. In the 32-bit layout they
+// point into a copy, which follows ReplaceCell() and ReverseCell().
+static int CheckPointers(vtkCellArray *ca, const char *what)
+{
+  int layout = ca->GetLayout();
+  vtkIdType i, npts, *pts;
+  ca->InitTraversal();
+  for (i = 0; ca->GetNextCell(npts, pts); i++)
+    {
+    if (!CheckCell(i, npts, pts, what))
+      {
+      return 0;
+      }
+    }
+  vtkIdType npts1, *pts1, npts2, *pts2;
+  ca->GetCellAtId(10, npts1, pts1);
+  ca->GetCellAtId(11, npts2, pts2);
+  if (!CheckCell(10, npts1, pts1, what) || !CheckCell(11, npts2, pts2, what))
+    {
+    cerr << what << ": two cells could not be held at once" << endl;
+    return 0;
+    }
+
+  // The locations of cells 10 and 11, cell ids in the offsets layouts.
+  vtkIdType loc10 = 0, loc11 = 0;
+  ca->InitTraversal();
+  for (i = 0; i <= 11; i++)
+    {
+    ca->GetNextCell(npts, pts);
+    loc10 = (i == 10) ? ca->GetTraversalLocation(npts) : loc10;
+    loc11 = (i == 11) ? ca->GetTraversalLocation(npts) : loc11;
+    }
+
+  vtkIdType edited[5] = { 7, 11, 12, 13, 14 };
+  if (layout == VTK_CELL_ARRAY_OFFSETS_32)
+    {
+    ca->ReplaceCell(loc10, static_cast<int>(npts1), edited);
+    }
+  else
+    {
+    pts1[0] = 7;
+    }
+  vtkSmartPointer<vtkIdList> ids = vtkSmartPointer<vtkIdList>::New();
+  ca->GetCellAtId(10, npts, pts);
+  ca->GetCellAtId(10, ids);
+  if (pts[0] != 7 || pts1[0] != 7 || ids->GetId(0) != 7)
+    {
+    cerr << what << ": the edit of the cell was lost" << endl;
+    return 0;
+    }
+  edited[0] = 10;
+  ca->ReplaceCell(loc10, static_cast<int>(npts1), edited);
+  ca->ReverseCell(loc11);
+  if (pts2[0] != 11 + npts2 - 1)
+    {
+    cerr << what << ": the pointer does not follow ReverseCell()" << endl;
+    return 0;
+    }
+  ca->ReverseCell(loc11);
+
+  // Cells added after pointers were handed out.
+  vtkSmartPointer<vtkCellArray> grown = vtkSmartPointer<vtkCellArray>::New();
+  grown->DeepCopy(ca);
+  grown->GetCellAtId(0, npts, pts);
+  vtkIdType added[3] = { 1, 2, 3 };
+  vtkIdType last = grown->InsertNextCell(3, added);
+  grown->GetCellAtId(last, npts, pts);
+  if (npts != 3 || pts[0] != 1 || pts[2] != 3)
+    {
+    cerr << what << ": wrong points for an added cell" << endl;
+    return 0;
+    }
+  return ca->GetLayout() == layout && CheckCells(ca, what);
+}
+
+static int TestLayout(int layout, const char *what)
+{
+  vtkSmartPointer<vtkCellArray> ca = vtkSmartPointer<vtkCellArray>::New();
+  ca->SetLayout(layout);
+  FillCells(ca);
+  if (ca->GetLayout() != layout || !CheckCells(ca, what))
+    {
+    return 0;
+    }
+
+  // In place edits, with cell ids as locations.
+  vtkIdType npts, *pts;
+  vtkSmartPointer<vtkIdList> buffer = vtkSmartPointer<vtkIdList>::New();
+  ca->InitTraversal();
+  ca->GetNextCell(npts, pts, buffer);
+  ca->GetNextCell(npts, pts, buffer);
+  vtkIdType loc = ca->GetTraversalLocation(npts);
+  ca->ReverseCell(loc);
+  ca->GetCell(loc, npts, pts, buffer);
+  int ok = (npts == 4 && pts[0] == 4 && pts[3] == 1);
+  vtkIdType newPts[4] = { 1, 2, 3, 4 };
+  ca->ReplaceCell(loc, 4, newPts);
+  if (!ok || !CheckCells(ca, what))
+    {
+    cerr << what << ": ReverseCell or ReplaceCell failed" << endl;
+    return 0;
+    }
+
+  // Conversions keep the cells.
+  vtkSmartPointer<vtkCellArray> copy = vtkSmartPointer<vtkCellArray>::New();
+  copy->DeepCopy(ca);
+  if (copy->GetLayout() != layout || !CheckCells(copy, what))
+    {
+    return 0;
+    }
+  int layouts[3] = { VTK_CELL_ARRAY_LEGACY, VTK_CELL_ARRAY_OFFSETS_32,
+                     VTK_CELL_ARRAY_OFFSETS_64 };
+  for (int l = 0; l < 3; l++)
+    {
+    copy->SetLayout(layouts[l]);
+    if (copy->GetLayout() != layouts[l] || !CheckCells(copy, what))
+      {
+      cerr << what << ": conversion to layout " << layouts[l]
+           << " failed" << endl;
+      return 0;
+      }
+    }
+
+  // Access to the legacy list switches to the legacy layout.
+  vtkIdType entries = ca->GetNumberOfConnectivityEntries();
+  vtkIdTypeArray *data = ca->GetData();
+  if (ca->GetLayout() != VTK_CELL_ARRAY_LEGACY ||
+      data->GetNumberOfTuples() != entries ||
+      data->GetValue(0) != 3 || data->GetValue(5) != 1 ||
+      ca->GetPointer() != data->GetPointer(0) || !CheckCells(ca, what))
+    {
+    cerr << what << ": GetData() did not give the legacy list" << endl;
+    return 0;
+    }
+
+  copy->SetLayout(layout);
+  if (!CheckPointers(copy, what))
+    {
+    return 0;
+    }
+
+  ca->SetLayout(layout);
+  ca->Reset();
+  FillCells(ca);
+  if (!CheckCells(ca, what))
+    {
+    return 0;
+    }
+  return 1;
+}
+
+int TestCellArrayLayouts(int, char *[])
+{
+  if (!TestLayout(VTK_CELL_ARRAY_LEGACY, "Legacy") ||
+      !TestLayout(VTK_CELL_ARRAY_OFFSETS_32, "Offsets32") ||
+      !TestLayout(VTK_CELL_ARRAY_OFFSETS_64, "Offsets64"))
+    {
+    return 1;
+    }
+
+  // The 32-bit layout takes less memory than the legacy list as soon as
+  // ids are 64-bit.
+  vtkSmartPointer<vtkCellArray> legacy = vtkSmartPointer<vtkCellArray>::New();
+  vtkSmartPointer<vtkCellArray> offsets =
+    vtkSmartPointer<vtkCellArray>::New();
+  for (vtkIdType i = 0; i < 100000; i++)
+    {
+    vtkIdType tri[3] = { i, i+1, i+2 };
+    legacy->InsertNextCell(3, tri);
+    }
+  offsets->DeepCopy(legacy);
+  offsets->SetLayoutToOffsets32();
+  legacy->Squeeze();
+  offsets->Squeeze();
+  cout << "Legacy: " << legacy->GetActualMemorySize() << " kB, offsets32: "
+       << offsets->GetActualMemorySize() << " kB" << endl;
+  if (sizeof(vtkIdType) == 8 &&
+      offsets->GetActualMemorySize() >= legacy->GetActualMemorySize())
+    {
+    cerr << "The 32-bit layout does not save memory" << endl;
+    return 1;
+    }
+
+  // External offsets and connectivity arrays.
+  vtkSmartPointer<vtkIntArray> o = vtkSmartPointer<vtkIntArray>::New();
+  vtkSmartPointer<vtkIntArray> c = vtkSmartPointer<vtkIntArray>::New();
+  int oValues[3] = { 0, 3, 7 };
+  int cValues[7] = { 0, 1, 2, 2, 1, 3, 4 };
+  int i;
+  for (i = 0; i < 3; i++)
+    {
+    o->InsertNextValue(oValues[i]);
+    }
+  for (i = 0; i < 7; i++)
+    {
+    c->InsertNextValue(cValues[i]);
+    }
+  vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+  vtkSmartPointer<vtkIntArray> bad = vtkSmartPointer<vtkIntArray>::New();
+  bad->InsertNextValue(0);
+  bad->InsertNextValue(5);
+  if (polys->SetData(bad, c) ||
+      !polys->SetData(o, c) ||
+      polys->GetLayout() != VTK_CELL_ARRAY_OFFSETS_32 ||
+      polys->GetNumberOfCells() != 2)
+    {
+    cerr << "SetData() failed" << endl;
+    return 1;
+    }
+
+  // A polydata using the offsets layout.
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->InsertNextPoint(0, 0, 0);
+  points->InsertNextPoint(1, 0, 0);
+  points->InsertNextPoint(0, 1, 0);
+  points->InsertNextPoint(1, 1, 0);
+  points->InsertNextPoint(2, 1, 0);
+  vtkSmartPointer<vtkPolyData> pd = vtkSmartPointer<vtkPolyData>::New();
+  pd->SetPoints(points);
+  pd->SetPolys(polys);
+  pd->BuildCells();
+  vtkIdType tri[3] = { 1, 4, 3 };
+  pd->InsertNextCell(VTK_TRIANGLE, 3, tri);
+  vtkCell *cell = pd->GetCell(1);
+  if (pd->GetNumberOfCells() != 3 || cell->GetCellType() != VTK_QUAD ||
+      cell->GetPointId(3) != 4 || pd->GetCell(2)->GetPointId(1) != 4 ||
+      polys->GetLayout() != VTK_CELL_ARRAY_OFFSETS_32)
+    {
+    cerr << "Wrong cells in the polydata" << endl;
+    return 1;
+    }
+  pd->ReverseCell(1);
+  if (pd->GetCell(1)->GetPointId(0) != 4)
+    {
+    cerr << "vtkPolyData::ReverseCell() failed" << endl;
+    return 1;
+    }
+
+  // The legacy list switches the layout, after which the polydata locates
+  // its cells again.
+  polys->GetData();
+  pd->BuildCells();
+  vtkIdType npts, *pts;
+  pd->GetCellPoints(2, npts, pts);
+  if (polys->GetLayout() != VTK_CELL_ARRAY_LEGACY || npts != 3 ||
+      pts[1] != 4)
+    {
+    cerr << "GetData() lost the cells of the polydata" << endl;
+    return 1;
+    }
+
+  // Point lists of two cells held at once, in the 32-bit layout. The
+  // external arrays hold the cells edited above.
+  vtkIdType npts0, *pts0;
+  polys->SetData(o, c);
+  pd->BuildCells();
+  pd->GetCellPoints(0, npts0, pts0);
+  pd->GetCellPoints(1, npts, pts);
+  if (npts0 != 3 || pts0[0] != 0 || pts0[2] != 2 ||
+      npts != 4 || pts[0] != 4 || pts[3] != 2)
+    {
+    cerr << "GetCellPoints() overwrote the points of an earlier cell"
+         << endl;
+    return 1;
+    }
+  pd->BuildLinks();
+  if (!pd->IsTriangle(0, 1, 2) || pd->IsTriangle(1, 2, 3) ||
+      !pd->IsPointUsedByCell(3, 1))
+    {
+    cerr << "Wrong cell inquiries on the 32-bit cells" << endl;
+    return 1;
+    }
+  pd->ReplaceCellPoint(0, 0, 3);
+  if (pd->GetCell(0)->GetPointId(0) != 3 || c->GetValue(0) != 3 ||
+      polys->GetLayout() != VTK_CELL_ARRAY_OFFSETS_32)
+    {
+    cerr << "ReplaceCellPoint() was lost" << endl;
+    return 1;
+    }
+
+  return 0;
+}
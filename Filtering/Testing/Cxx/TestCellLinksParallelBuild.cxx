@@ -0,0 +1,312 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestCellLinksParallelBuild.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME
+// .SECTION Description
+// Builds cell links with one thread and with several, from unstructured
+// grids in each cell array layout, from polygonal data and from an image,
+// checks them against lists built by hand, edits and copies them, and
+// reports the build times.
+
+#include "vtkCellArray.h"
+#include "vtkCellLinks.h"
+#include "vtkCellType.h"
+#include "vtkIdList.h"
+#include "vtkImageData.h"
+#include "vtkMath.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkTestUtilities.h"
+#include "vtkTimerLog.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <vtkstd/vector>
+
+typedef vtkstd::vector<vtkstd::vector<vtkIdType> > vtkLinkLists;
+
+static int CheckLinks(vtkCellLinks *links, const vtkLinkLists &expected,
+                      const char *what)
+{
+  for (vtkIdType ptId = 0; ptId < static_cast<vtkIdType>(expected.size());
+       ptId++)
+    {
+    const vtkstd::vector<vtkIdType> &cells = expected[ptId];
+    int ok = links->GetNcells(ptId) == static_cast<int>(cells.size());
+    for (size_t i = 0; ok && i < cells.size(); i++)
+      {
+      ok = links->GetCells(ptId)[i] == cells[i];
+      }
+    if (!ok)
+      {
+      cerr << what << ": point " << ptId << " is used by "
+           << links->GetNcells(ptId) << " cells instead of " << cells.size()
+           << endl;
+      return 0;
+      }
+    }
+  return 1;
+}
+
+// Random cells of 1 to 8 points, which may repeat a point.
+static vtkCellArray *MakeCells(vtkIdType numPts, vtkIdType numCells,
+                               vtkLinkLists &expected)
+{
+  vtkCellArray *cells = vtkCellArray::New();
+  expected.assign(numPts, vtkstd::vector<vtkIdType>());
+  vtkIdType pts[8];
+  for (vtkIdType cellId = 0; cellId < numCells; cellId++)
+    {
+    int npts = 1 + static_cast<int>(vtkMath::Random(0.0, 7.999));
+    for (int j = 0; j < npts; j++)
+      {
+      pts[j] = static_cast<vtkIdType>(vtkMath::Random(0.0, numPts - 0.001));
+      expected[pts[j]].push_back(cellId);
+      }
+    cells->InsertNextCell(npts, pts);
+    }
+  return cells;
+}
+
+static vtkPoints *MakePoints(vtkIdType numPts)
+{
+  vtkPoints *points = vtkPoints::New();
+  points->SetNumberOfPoints(numPts);
+  for (vtkIdType i = 0; i < numPts; i++)
+    {
+    points->SetPoint(i, vtkMath::Random(), vtkMath::Random(),
+                     vtkMath::Random());
+    }
+  return points;
+}
+
+static int TestGrid(int layout, const char *what, vtkIdType numPts,
+                    vtkIdType numCells, int threads)
+{
+  vtkLinkLists expected;
+  vtkCellArray *cells = MakeCells(numPts, numCells, expected);
+  cells->SetLayout(layout);
+  vtkPoints *points = MakePoints(numPts);
+  vtkSmartPointer<vtkUnstructuredGrid> grid =
+    vtkSmartPointer<vtkUnstructuredGrid>::New();
+  grid->SetPoints(points);
+  vtkstd::vector<int> types(numCells, VTK_POLY_VERTEX);
+  grid->SetCells(&types[0], cells);
+  points->Delete();
+  cells->Delete();
+
+  vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+  double times[2];
+  for (int parallel = 0; parallel < 2; parallel++)
+    {
+    vtkSmartPointer<vtkCellLinks> links = vtkSmartPointer<vtkCellLinks>::New();
+    links->SetNumberOfThreads(parallel ? threads : 1);
+    links->Allocate(numPts);
+    timer->StartTimer();
+    links->BuildLinks(grid, grid->GetCells());
+    timer->StopTimer();
+    times[parallel] = timer->GetElapsedTime();
+    if (!CheckLinks(links, expected, what))
+      {
+      return 0;
+      }
+    }
+  cout << what << ", " << numCells << " cells: 1 thread " << times[0]
+       << " s, " << threads << " threads " << times[1] << " s" << endl;
+
+  // Through the dataset.
+  grid->BuildLinks();
+  return CheckLinks(grid->GetCellLinks(), expected, what);
+}
+
+static int TestPolyData(int threads)
+{
+  // Vertices, then lines, then polygons; in the 32-bit layout the cells
+  // are copied out of the arrays.
+  const vtkIdType numPts = 20000;
+  vtkLinkLists verts, polys;
+  vtkCellArray *arrays[3] = {MakeCells(numPts, 5000, verts),
+                             vtkCellArray::New(),
+                             MakeCells(numPts, 60000, polys)};
+  vtkIdType i, pts[2];
+  for (i = 0; i < 15000; i++)
+    {
+    pts[0] = i;
+    pts[1] = (7*i + 3) % numPts;
+    arrays[1]->InsertNextCell(2, pts);
+    }
+  arrays[2]->SetLayoutToOffsets32();
+
+  vtkPoints *points = MakePoints(numPts);
+  vtkSmartPointer<vtkPolyData> pd = vtkSmartPointer<vtkPolyData>::New();
+  pd->SetPoints(points);
+  pd->SetVerts(arrays[0]);
+  pd->SetLines(arrays[1]);
+  pd->SetPolys(arrays[2]);
+  points->Delete();
+
+  vtkLinkLists expected(numPts);
+  for (vtkIdType ptId = 0; ptId < numPts; ptId++)
+    {
+    expected[ptId] = verts[ptId];
+    }
+  for (i = 0; i < 15000; i++)
+    {
+    expected[i].push_back(5000 + i);
+    expected[(7*i + 3) % numPts].push_back(5000 + i);
+    }
+  for (vtkIdType ptId = 0; ptId < numPts; ptId++)
+    {
+    vtkstd::vector<vtkIdType> &list = expected[ptId];
+    for (size_t k = 0; k < polys[ptId].size(); k++)
+      {
+      list.push_back(20000 + polys[ptId][k]);
+      }
+    }
+
+  for (int parallel = 0; parallel < 2; parallel++)
+    {
+    vtkSmartPointer<vtkCellLinks> links = vtkSmartPointer<vtkCellLinks>::New();
+    links->SetNumberOfThreads(parallel ? threads : 1);
+    links->Allocate(numPts);
+    pd->BuildCells();
+    links->BuildLinks(pd);
+    if (!CheckLinks(links, expected, "Polygonal data"))
+      {
+      arrays[0]->Delete();
+      arrays[1]->Delete();
+      arrays[2]->Delete();
+      return 0;
+      }
+    }
+  arrays[0]->Delete();
+  arrays[1]->Delete();
+  arrays[2]->Delete();
+
+  // Edit the links of the polygonal data: a new cell, a cell losing a
+  // point and a point losing its cells.
+  pd->BuildLinks();
+  vtkIdType tri[3] = {0, 1, 2};
+  vtkIdType newCell = pd->InsertNextLinkedCell(VTK_TRIANGLE, 3, tri);
+  pd->RemoveReferenceToCell(3, expected[3][0]);
+  pd->DeletePoint(4);
+  for (int j = 0; j < 3; j++)
+    {
+    expected[j].push_back(newCell);
+    }
+  expected[3].erase(expected[3].begin());
+  expected[4].clear();
+  vtkSmartPointer<vtkIdList> cellIds = vtkSmartPointer<vtkIdList>::New();
+  for (vtkIdType ptId = 0; ptId < numPts; ptId++)
+    {
+    pd->GetPointCells(ptId, cellIds);
+    int ok = cellIds->GetNumberOfIds() ==
+      static_cast<vtkIdType>(expected[ptId].size());
+    for (vtkIdType k = 0; ok && k < cellIds->GetNumberOfIds(); k++)
+      {
+      ok = cellIds->GetId(k) == expected[ptId][k];
+      }
+    if (!ok)
+      {
+      cerr << "Edited links: point " << ptId << " is used by "
+           << cellIds->GetNumberOfIds() << " cells instead of "
+           << expected[ptId].size() << endl;
+      return 0;
+      }
+    }
+  pd->DeleteLinks();
+  return 1;
+}
+
+// The editing methods allocate resized lists alone, which are freed with
+// the lists built together, and copies have lists of their own.
+static int TestEditing(int threads)
+{
+  const vtkIdType numPts = 30000;
+  vtkLinkLists expected;
+  vtkCellArray *cells = MakeCells(numPts, 100000, expected);
+  vtkSmartPointer<vtkUnstructuredGrid> grid =
+    vtkSmartPointer<vtkUnstructuredGrid>::New();
+  vtkPoints *points = MakePoints(numPts);
+  grid->SetPoints(points);
+  points->Delete();
+  vtkstd::vector<int> types(100000, VTK_POLY_VERTEX);
+  grid->SetCells(&types[0], cells);
+  cells->Delete();
+
+  vtkCellLinks *links = vtkCellLinks::New();
+  links->SetNumberOfThreads(threads);
+  links->Allocate(numPts);
+  links->BuildLinks(grid, grid->GetCells());
+  for (vtkIdType ptId = 0; ptId < numPts; ptId += 3)
+    {
+    links->ResizeCellList(ptId, 1);
+    links->AddCellReference(100000, ptId);
+    expected[ptId].push_back(100000);
+    }
+  for (vtkIdType ptId = 1; ptId < numPts; ptId += 7)
+    {
+    links->DeletePoint(ptId);
+    expected[ptId].clear();
+    }
+  vtkCellLinks *copy = vtkCellLinks::New();
+  copy->DeepCopy(links);
+  int ok = CheckLinks(links, expected, "Edited links");
+  links->Delete();
+  ok = ok && CheckLinks(copy, expected, "Copied links");
+  copy->Delete();
+  return ok;
+}
+
+static int TestImage(int threads)
+{
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(60, 50, 40);
+  vtkLinkLists expected(image->GetNumberOfPoints());
+  vtkSmartPointer<vtkIdList> ptIds = vtkSmartPointer<vtkIdList>::New();
+  for (vtkIdType cellId = 0; cellId < image->GetNumberOfCells(); cellId++)
+    {
+    image->GetCellPoints(cellId, ptIds);
+    for (vtkIdType j = 0; j < ptIds->GetNumberOfIds(); j++)
+      {
+      expected[ptIds->GetId(j)].push_back(cellId);
+      }
+    }
+  vtkSmartPointer<vtkCellLinks> links = vtkSmartPointer<vtkCellLinks>::New();
+  links->SetNumberOfThreads(threads);
+  links->Allocate(image->GetNumberOfPoints());
+  links->BuildLinks(image);
+  return CheckLinks(links, expected, "Image");
+}
+
+int TestCellLinksParallelBuild(int, char *[])
+{
+  int threads = vtkTestUtilities::SetUpThreadPool(4);
+  vtkMath::RandomSeed(60221);
+
+  if (!TestGrid(VTK_CELL_ARRAY_LEGACY, "Legacy", 1000, 100000, threads) ||
+      !TestGrid(VTK_CELL_ARRAY_OFFSETS_64, "Offsets64", 50000, 200000,
+                threads) ||
+      !TestGrid(VTK_CELL_ARRAY_OFFSETS_32, "Offsets32", 50000, 200000,
+                threads) ||
+      !TestGrid(VTK_CELL_ARRAY_LEGACY, "Legacy", 500000, 2000000, threads) ||
+      !TestPolyData(threads) || !TestEditing(threads) ||
+      !TestImage(threads))
+    {
+    return 1;
+    }
+
+  // Fewer cells than a piece take the serial path.
+  return TestGrid(VTK_CELL_ARRAY_LEGACY, "Small", 100, 1000, threads) ? 0 : 1;
+}
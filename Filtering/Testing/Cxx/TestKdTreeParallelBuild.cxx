@@ -0,0 +1,184 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestKdTreeParallelBuild.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME
+// .SECTION Description
+// Builds k-d trees with one thread and with several, checks that they
+// have the same regions holding the same points or cells, and reports
+// the build times across point counts.
+
+#include "vtkIdTypeArray.h"
+#include "vtkImageData.h"
+#include "vtkKdTree.h"
+#include "vtkMath.h"
+#include "vtkPoints.h"
+#include "vtkSmartPointer.h"
+#include "vtkTestUtilities.h"
+#include "vtkTimerLog.h"
+
+#include <vtkstd/algorithm>
+
+static int CompareRegions(vtkKdTree *serial, vtkKdTree *parallel)
+{
+  int nregions = serial->GetNumberOfRegions();
+  if (parallel->GetNumberOfRegions() != nregions)
+    {
+    cerr << "Serial build has " << nregions << " regions, parallel build "
+         << parallel->GetNumberOfRegions() << endl;
+    return 0;
+    }
+  for (int region = 0; region < nregions; region++)
+    {
+    double b1[6], b2[6], d1[6], d2[6];
+    serial->GetRegionBounds(region, b1);
+    parallel->GetRegionBounds(region, b2);
+    serial->GetRegionDataBounds(region, d1);
+    parallel->GetRegionDataBounds(region, d2);
+    for (int i = 0; i < 6; i++)
+      {
+      if (b1[i] != b2[i] || d1[i] != d2[i])
+        {
+        cerr << "Region " << region << " has different bounds" << endl;
+        return 0;
+        }
+      }
+    }
+  return 1;
+}
+
+static int ComparePoints(vtkKdTree *serial, vtkKdTree *parallel)
+{
+  for (int region = 0; region < serial->GetNumberOfRegions(); region++)
+    {
+    vtkIdTypeArray *ids1 = serial->GetPointsInRegion(region);
+    vtkIdTypeArray *ids2 = parallel->GetPointsInRegion(region);
+    vtkIdType n = ids1->GetNumberOfTuples();
+    int same = (ids2->GetNumberOfTuples() == n);
+    if (same)
+      {
+      vtkIdType *p1 = ids1->GetPointer(0);
+      vtkIdType *p2 = ids2->GetPointer(0);
+      vtkstd::sort(p1, p1 + n);
+      vtkstd::sort(p2, p2 + n);
+      same = vtkstd::equal(p1, p1 + n, p2);
+      }
+    ids1->Delete();
+    ids2->Delete();
+    if (!same)
+      {
+      cerr << "Region " << region << " has different points" << endl;
+      return 0;
+      }
+    }
+  return 1;
+}
+
+// Build from points with one thread and with several, compare and time.
+static int TestPoints(const char *name, vtkPoints *points, int threads)
+{
+  vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+
+  vtkSmartPointer<vtkKdTree> serial = vtkSmartPointer<vtkKdTree>::New();
+  serial->SetNumberOfThreads(1);
+  timer->StartTimer();
+  serial->BuildLocatorFromPoints(points);
+  timer->StopTimer();
+  double serialTime = timer->GetElapsedTime();
+
+  vtkSmartPointer<vtkKdTree> parallel = vtkSmartPointer<vtkKdTree>::New();
+  parallel->SetNumberOfThreads(threads);
+  timer->StartTimer();
+  parallel->BuildLocatorFromPoints(points);
+  timer->StopTimer();
+  double parallelTime = timer->GetElapsedTime();
+
+  cout << name << ", " << points->GetNumberOfPoints() << " points, "
+       << serial->GetNumberOfRegions() << " regions: serial "
+       << serialTime << " s, " << threads << " threads "
+       << parallelTime << " s" << endl;
+
+  if (!CompareRegions(serial, parallel) || !ComparePoints(serial, parallel))
+    {
+    cerr << "Parallel build of " << name << " differs" << endl;
+    return 0;
+    }
+  return 1;
+}
+
+int TestKdTreeParallelBuild(int, char *[])
+{
+  int threads = vtkTestUtilities::SetUpThreadPool(4);
+  vtkMath::RandomSeed(8775070);
+
+  // Random points, below and above the parallel median find threshold.
+  int sizes[3] = {50000, 400000, 1500000};
+  for (int s = 0; s < 3; s++)
+    {
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    points->SetNumberOfPoints(sizes[s]);
+    for (vtkIdType i = 0; i < sizes[s]; i++)
+      {
+      points->SetPoint(i, vtkMath::Random(-1.0, 1.0),
+                       vtkMath::Random(-1.0, 1.0), vtkMath::Random(0.0, 4.0));
+      }
+    if (!TestPoints("Random", points, threads))
+      {
+      return 1;
+      }
+    }
+
+  // Points on a coarse lattice around the origin, so that many points
+  // share each coordinate, including -0 and +0.
+  vtkSmartPointer<vtkPoints> lattice = vtkSmartPointer<vtkPoints>::New();
+  lattice->SetNumberOfPoints(400000);
+  for (vtkIdType i = 0; i < 400000; i++)
+    {
+    double x = static_cast<int>(vtkMath::Random(-8.0, 8.0));
+    double y = static_cast<int>(vtkMath::Random(-3.0, 3.0));
+    lattice->SetPoint(i, (i % 7) ? x : -x, y, (i % 5) ? 1.0 : 0.0);
+    }
+  if (!TestPoints("Lattice", lattice, threads))
+    {
+    return 1;
+    }
+
+  // Cells, whose centers are divided without point ids.
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(80, 60, 60);
+  vtkSmartPointer<vtkKdTree> serial = vtkSmartPointer<vtkKdTree>::New();
+  serial->SetNumberOfThreads(1);
+  serial->SetDataSet(image);
+  serial->BuildLocator();
+  vtkSmartPointer<vtkKdTree> parallel = vtkSmartPointer<vtkKdTree>::New();
+  parallel->SetNumberOfThreads(threads);
+  parallel->SetDataSet(image);
+  parallel->BuildLocator();
+  if (!CompareRegions(serial, parallel))
+    {
+    cerr << "Parallel build from cells differs" << endl;
+    return 1;
+    }
+  int *regions1 = serial->AllGetRegionContainingCell();
+  int *regions2 = parallel->AllGetRegionContainingCell();
+  for (vtkIdType i = 0; i < image->GetNumberOfCells(); i++)
+    {
+    if (regions1[i] != regions2[i])
+      {
+      cerr << "Cell " << i << " is in region " << regions2[i]
+           << " instead of " << regions1[i] << endl;
+      return 1;
+      }
+    }
+  return 0;
+}
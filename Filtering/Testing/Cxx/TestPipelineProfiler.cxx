@@ -0,0 +1,184 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestPipelineProfiler.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME
+// .SECTION Description
+// Updates a small image pipeline with a global vtkPipelineProfiler and
+// checks the recorded passes, execution counts and output memory, and
+// the Chrome trace written from them.
+
+#include "vtkDemandDrivenPipeline.h"
+#include "vtkImageData.h"
+#include "vtkInformationRequestKey.h"
+#include "vtkObjectFactory.h"
+#include "vtkPipelineProfiler.h"
+#include "vtkPointData.h"
+#include "vtkSimpleImageToImageFilter.h"
+#include "vtkSmartPointer.h"
+#include "vtkStreamingDemandDrivenPipeline.h"
+#include "vtkTrivialProducer.h"
+
+#include <vtksys/ios/sstream>
+#include <vtkstd/string>
+
+class vtkProfilerTestFilter : public vtkSimpleImageToImageFilter
+{
+public:
+  static vtkProfilerTestFilter *New();
+  vtkTypeMacro(vtkProfilerTestFilter, vtkSimpleImageToImageFilter);
+
+  double Scale;
+
+protected:
+  vtkProfilerTestFilter() { this->Scale = 2.0; }
+
+  virtual void SimpleExecute(vtkImageData *input, vtkImageData *output)
+    {
+    vtkDataArray *in = input->GetPointData()->GetScalars();
+    vtkDataArray *out = output->GetPointData()->GetScalars();
+    for (vtkIdType i = 0; i < in->GetNumberOfTuples(); i++)
+      {
+      out->SetTuple1(i, this->Scale*in->GetTuple1(i));
+      }
+    }
+};
+
+vtkStandardNewMacro(vtkProfilerTestFilter);
+
+static int CheckCount(vtkPipelineProfiler *profiler, vtkAlgorithm *algorithm,
+                      const char *pass, int expected)
+{
+  int count = profiler->GetExecutionCount(algorithm, pass);
+  if (count != expected)
+    {
+    cerr << algorithm->GetClassName() << " executed " << pass << " "
+         << count << " times instead of " << expected << endl;
+    return 0;
+    }
+  return 1;
+}
+
+int TestPipelineProfiler(int, char *[])
+{
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(64, 64, 16);
+  image->SetScalarTypeToFloat();
+  image->AllocateScalars();
+  vtkDataArray *scalars = image->GetPointData()->GetScalars();
+  for (vtkIdType i = 0; i < scalars->GetNumberOfTuples(); i++)
+    {
+    scalars->SetTuple1(i, i%17);
+    }
+
+  vtkSmartPointer<vtkTrivialProducer> producer =
+    vtkSmartPointer<vtkTrivialProducer>::New();
+  producer->SetOutput(image);
+  vtkSmartPointer<vtkProfilerTestFilter> first =
+    vtkSmartPointer<vtkProfilerTestFilter>::New();
+  first->SetInputConnection(producer->GetOutputPort());
+  vtkSmartPointer<vtkProfilerTestFilter> second =
+    vtkSmartPointer<vtkProfilerTestFilter>::New();
+  second->SetInputConnection(first->GetOutputPort());
+
+  // Nothing is recorded without a global profiler.
+  vtkSmartPointer<vtkPipelineProfiler> profiler =
+    vtkSmartPointer<vtkPipelineProfiler>::New();
+  vtkPipelineProfiler::SetGlobalProfiler(0);
+  second->Update();
+  if (profiler->GetNumberOfEvents() != 0)
+    {
+    cerr << "Events recorded without a global profiler" << endl;
+    return 1;
+    }
+
+  vtkPipelineProfiler::SetGlobalProfiler(profiler);
+  first->Modified();
+  second->Update();
+  const char *data =
+    vtkDemandDrivenPipeline::REQUEST_DATA()->GetName();
+  const char *info =
+    vtkDemandDrivenPipeline::REQUEST_INFORMATION()->GetName();
+  const char *extent =
+    vtkStreamingDemandDrivenPipeline::REQUEST_UPDATE_EXTENT()->GetName();
+  if (!CheckCount(profiler, first, data, 1) ||
+      !CheckCount(profiler, second, data, 1) ||
+      !CheckCount(profiler, first, info, 1) ||
+      !CheckCount(profiler, first, extent, 1) ||
+      !CheckCount(profiler, second, extent, 1) ||
+      !CheckCount(profiler, producer, data, 0))
+    {
+    return 1;
+    }
+
+  // Only the modified filter and its consumer execute again.
+  second->Modified();
+  second->Update();
+  first->Modified();
+  second->Update();
+  if (!CheckCount(profiler, first, data, 2) ||
+      !CheckCount(profiler, second, data, 3))
+    {
+    return 1;
+    }
+
+  // The last event is the last execution of the second filter.
+  int last = profiler->GetNumberOfEvents() - 1;
+  unsigned long memory = second->GetOutput()->GetActualMemorySize();
+  if (vtkstd::string(profiler->GetEventPass(last)) != data ||
+      profiler->GetEventExecutionCount(last) != 3 ||
+      profiler->GetEventMemory(last) != memory || memory == 0 ||
+      profiler->GetEventWallTime(last) < 0.0 ||
+      profiler->GetEventStartTime(last) < profiler->GetEventStartTime(0))
+    {
+    cerr << "Wrong last event" << endl;
+    return 1;
+    }
+  for (int i = 0; i < last; i++)
+    {
+    if (vtkstd::string(profiler->GetEventPass(i)) != data &&
+        profiler->GetEventMemory(i) != 0)
+      {
+      cerr << "Memory recorded for a " << profiler->GetEventPass(i)
+           << " pass" << endl;
+      return 1;
+      }
+    }
+
+  vtksys_ios::ostringstream trace;
+  profiler->WriteChromeTrace(trace);
+  vtkstd::string json = trace.str();
+  vtkstd::string name = profiler->GetEventAlgorithmName(last);
+  if (json.find("{\"traceEvents\":[") != 0 ||
+      json.find("\"ph\":\"X\"") == vtkstd::string::npos ||
+      json.find("\"name\":\"" + name + "\"") == vtkstd::string::npos ||
+      json.find("\"execution\":3") == vtkstd::string::npos ||
+      json.find("]") == vtkstd::string::npos)
+    {
+    cerr << "Wrong trace:\n" << json << endl;
+    return 1;
+    }
+  profiler->PrintSummary(cout);
+
+  profiler->Clear();
+  vtkPipelineProfiler::SetGlobalProfiler(0);
+  first->Modified();
+  second->Update();
+  if (profiler->GetNumberOfEvents() != 0 ||
+      profiler->GetExecutionCount(first, data) != 0)
+    {
+    cerr << "Events recorded after the profiler was removed" << endl;
+    return 1;
+    }
+  return 0;
+}
@@ -0,0 +1,270 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestPipelineUpdateOverhead.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME
+// .SECTION Description
+// Measures the cost of the pipeline itself: Update() on a chain of 200
+// filters that do nothing but pass their input through, when nothing has
+// changed and when every filter has to execute again. Also checks the
+// vtkInformation operations the pipeline relies on.
+
+#include "vtkInformation.h"
+#include "vtkInformationDoubleKey.h"
+#include "vtkInformationIntegerKey.h"
+#include "vtkObjectFactory.h"
+#include "vtkPassInputTypeAlgorithm.h"
+#include "vtkPolyData.h"
+#include "vtkPoints.h"
+#include "vtkSmartPointer.h"
+#include "vtkTimerLog.h"
+#include "vtkTrivialProducer.h"
+
+#include <vtkstd/vector>
+
+#define NUMBER_OF_FILTERS 200
+
+class vtkNoOpFilter : public vtkPassInputTypeAlgorithm
+{
+public:
+  static vtkNoOpFilter *New();
+  vtkTypeMacro(vtkNoOpFilter, vtkPassInputTypeAlgorithm);
+
+  int Executions;
+
+protected:
+  vtkNoOpFilter() { this->Executions = 0; }
+
+  virtual int RequestData(vtkInformation *, vtkInformationVector **inputVector,
+                          vtkInformationVector *outputVector)
+    {
+    vtkDataObject *input = vtkDataObject::GetData(inputVector[0]);
+    vtkDataObject *output = vtkDataObject::GetData(outputVector);
+    output->ShallowCopy(input);
+    this->Executions++;
+    return 1;
+    }
+};
+
+vtkStandardNewMacro(vtkNoOpFilter);
+
+// Keys for the information checks.
+static vtkInformationIntegerKey *TestKey(int i)
+{
+  static vtkstd::vector<vtkInformationIntegerKey*> keys;
+  while (static_cast<int>(keys.size()) <= i)
+    {
+    // Keys register themselves with the key manager, which deletes them.
+    keys.push_back(new vtkInformationIntegerKey("TEST_KEY", "TestInfo"));
+    }
+  return keys[i];
+}
+
+// Keys exposing the watch addresses meant for debuggers.
+class vtkWatchedIntegerKey : public vtkInformationIntegerKey
+{
+public:
+  vtkWatchedIntegerKey(const char* name, const char* location)
+    : vtkInformationIntegerKey(name, location) {}
+  using vtkInformationIntegerKey::GetWatchAddress;
+};
+
+class vtkWatchedDoubleKey : public vtkInformationDoubleKey
+{
+public:
+  vtkWatchedDoubleKey(const char* name, const char* location)
+    : vtkInformationDoubleKey(name, location) {}
+  using vtkInformationDoubleKey::GetWatchAddress;
+};
+
+// Watch addresses must survive other entries being added and removed.
+static int TestWatchAddresses()
+{
+  vtkSmartPointer<vtkInformation> info = vtkSmartPointer<vtkInformation>::New();
+  vtkWatchedIntegerKey *intKey =
+    new vtkWatchedIntegerKey("TEST_WATCHED_INTEGER", "TestInfo");
+  vtkWatchedDoubleKey *doubleKey =
+    new vtkWatchedDoubleKey("TEST_WATCHED_DOUBLE", "TestInfo");
+  if (intKey->GetWatchAddress(info) || doubleKey->GetWatchAddress(info))
+    {
+    cerr << "Watch address of an absent key" << endl;
+    return 0;
+    }
+  TestKey(0)->Set(info, 0);
+  intKey->Set(info, 7);
+  doubleKey->Set(info, 0.5);
+  int *intAddress = intKey->GetWatchAddress(info);
+  double *doubleAddress = doubleKey->GetWatchAddress(info);
+  if (!intAddress || *intAddress != 7 || !doubleAddress ||
+      *doubleAddress != 0.5)
+    {
+    cerr << "Wrong watch addresses" << endl;
+    return 0;
+    }
+  int i;
+  for (i = 1; i < 100; i++)
+    {
+    TestKey(i)->Set(info, i);
+    }
+  TestKey(0)->Remove(info);
+  intKey->Set(info, 8);
+  doubleKey->Set(info, 1.5);
+  if (intKey->GetWatchAddress(info) != intAddress || *intAddress != 8 ||
+      doubleKey->GetWatchAddress(info) != doubleAddress ||
+      *doubleAddress != 1.5)
+    {
+    cerr << "Watch addresses moved with the entries" << endl;
+    return 0;
+    }
+  for (i = 1; i < 100; i++)
+    {
+    TestKey(i)->Remove(info);
+    }
+  if (intKey->Get(info) != 8 || doubleKey->Get(info) != 1.5 ||
+      info->GetNumberOfKeys() != 2)
+    {
+    cerr << "Wrong watched values after removals" << endl;
+    return 0;
+    }
+  vtkSmartPointer<vtkInformation> copy = vtkSmartPointer<vtkInformation>::New();
+  copy->Copy(info);
+  intKey->Set(info, 9);
+  if (intKey->Get(copy) != 8 || doubleKey->Get(copy) != 1.5)
+    {
+    cerr << "Copy() shares the watched values" << endl;
+    return 0;
+    }
+  return 1;
+}
+
+static int TestInformation()
+{
+  const int numberOfKeys = 100;
+  vtkSmartPointer<vtkInformation> info = vtkSmartPointer<vtkInformation>::New();
+  int i;
+  // Grow past any inline storage and check every key at each size.
+  for (i = 0; i < numberOfKeys; i++)
+    {
+    TestKey(i)->Set(info, i);
+    for (int j = 0; j <= i; j++)
+      {
+      if (!TestKey(j)->Has(info) || TestKey(j)->Get(info) != j)
+        {
+        cerr << "Key " << j << " lost after inserting " << i + 1
+             << " keys" << endl;
+        return 0;
+        }
+      }
+    if (TestKey(i + 1)->Has(info) || info->GetNumberOfKeys() != i + 1)
+      {
+      cerr << "Wrong keys after inserting " << i + 1 << " keys" << endl;
+      return 0;
+      }
+    }
+  vtkSmartPointer<vtkInformation> copy = vtkSmartPointer<vtkInformation>::New();
+  vtkInformationDoubleKey *doubleKey =
+    new vtkInformationDoubleKey("TEST_DOUBLE", "TestInfo");
+  doubleKey->Set(copy, 1.5);
+  copy->Copy(info);
+  if (doubleKey->Has(copy) || copy->GetNumberOfKeys() != numberOfKeys)
+    {
+    cerr << "Copy() did not replace the keys" << endl;
+    return 0;
+    }
+  // Remove every other key, shrinking back.
+  for (i = 0; i < numberOfKeys; i += 2)
+    {
+    TestKey(i)->Remove(copy);
+    }
+  for (i = 0; i < numberOfKeys; i++)
+    {
+    if (TestKey(i)->Has(copy) != (i % 2) ||
+        (i % 2 && TestKey(i)->Get(copy) != i))
+      {
+      cerr << "Wrong key " << i << " after removals" << endl;
+      return 0;
+      }
+    }
+  doubleKey->Set(copy, 2.5);
+  copy->Clear();
+  if (copy->GetNumberOfKeys() != 0 || doubleKey->Has(copy))
+    {
+    cerr << "Clear() left keys" << endl;
+    return 0;
+    }
+  return 1;
+}
+
+int TestPipelineUpdateOverhead(int, char *[])
+{
+  if (!TestInformation() || !TestWatchAddresses())
+    {
+    return 1;
+    }
+
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->InsertNextPoint(0.0, 0.0, 0.0);
+  vtkSmartPointer<vtkPolyData> pd = vtkSmartPointer<vtkPolyData>::New();
+  pd->SetPoints(points);
+  vtkSmartPointer<vtkTrivialProducer> producer =
+    vtkSmartPointer<vtkTrivialProducer>::New();
+  producer->SetOutput(pd);
+
+  vtkstd::vector<vtkSmartPointer<vtkNoOpFilter> > filters;
+  vtkAlgorithm *last = producer;
+  int i;
+  for (i = 0; i < NUMBER_OF_FILTERS; i++)
+    {
+    vtkSmartPointer<vtkNoOpFilter> filter =
+      vtkSmartPointer<vtkNoOpFilter>::New();
+    filter->SetInputConnection(last->GetOutputPort());
+    filters.push_back(filter);
+    last = filter;
+    }
+  last->Update();
+
+  vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+  const int upToDateUpdates = 200;
+  timer->StartTimer();
+  for (i = 0; i < upToDateUpdates; i++)
+    {
+    last->Update();
+    }
+  timer->StopTimer();
+  double upToDate = timer->GetElapsedTime()/upToDateUpdates;
+
+  const int fullUpdates = 50;
+  timer->StartTimer();
+  for (i = 0; i < fullUpdates; i++)
+    {
+    filters[0]->Modified();
+    last->Update();
+    }
+  timer->StopTimer();
+  double full = timer->GetElapsedTime()/fullUpdates;
+
+  cout << "Update() of " << NUMBER_OF_FILTERS << " filters: "
+       << 1.0e3*upToDate << " ms when up to date, "
+       << 1.0e3*full << " ms when every filter executes" << endl;
+
+  for (i = 0; i < NUMBER_OF_FILTERS; i++)
+    {
+    if (filters[i]->Executions != fullUpdates + 1)
+      {
+      cerr << "Filter " << i << " executed " << filters[i]->Executions
+           << " times" << endl;
+      return 1;
+      }
+    }
+  return 0;
+}
@@ -0,0 +1,206 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestPointLocatorBatchQueries.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME
+// .SECTION Description
+// Answers batches of closest point queries with several threads and
+// checks them against the queries asked one at a time, for each point
+// locator. Reports the time of both.
+
+#include "vtkDoubleArray.h"
+#include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
+#include "vtkKdTreePointLocator.h"
+#include "vtkMath.h"
+#include "vtkOctreePointLocator.h"
+#include "vtkPointLocator.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkTestUtilities.h"
+#include "vtkTimerLog.h"
+
+#define NUMBER_OF_CLOSEST 5
+
+static vtkPoints *RandomPoints(vtkIdType n, double min, double max)
+{
+  vtkPoints *points = vtkPoints::New();
+  points->SetNumberOfPoints(n);
+  for (vtkIdType i = 0; i < n; i++)
+    {
+    points->SetPoint(i, vtkMath::Random(min, max), vtkMath::Random(min, max),
+                     vtkMath::Random(min, max));
+    }
+  return points;
+}
+
+// Compare the distance of two answers rather than their ids, as points at
+// the same distance may be returned in either order.
+static int SameDistance(vtkDataSet *data, double *x, vtkIdType id1,
+                        vtkIdType id2, double dist2)
+{
+  if (id1 == id2)
+    {
+    return 1;
+    }
+  if (id1 < 0 || id2 < 0)
+    {
+    return 0;
+    }
+  double p1[3], p2[3];
+  data->GetPoint(id1, p1);
+  data->GetPoint(id2, p2);
+  return vtkMath::Distance2BetweenPoints(x, p1) ==
+    vtkMath::Distance2BetweenPoints(x, p2) &&
+    vtkMath::Distance2BetweenPoints(x, p2) == dist2;
+}
+
+static int TestLocator(vtkAbstractPointLocator *locator, vtkPolyData *data,
+                       vtkPoints *queries, int threads)
+{
+  const char *name = locator->GetClassName();
+  vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+  vtkIdType n = queries->GetNumberOfPoints();
+  vtkIdType i;
+  double x[3];
+
+  locator->SetDataSet(data);
+  locator->SetNumberOfThreads(threads);
+  vtkSmartPointer<vtkIdTypeArray> ids = vtkSmartPointer<vtkIdTypeArray>::New();
+  vtkSmartPointer<vtkDoubleArray> dist2 =
+    vtkSmartPointer<vtkDoubleArray>::New();
+  // The locator is built by the first query.
+  locator->BatchFindClosestPoint(queries, ids, dist2);
+  if (ids->GetNumberOfTuples() != n || dist2->GetNumberOfTuples() != n)
+    {
+    cerr << name << " answered " << ids->GetNumberOfTuples() << " queries"
+         << endl;
+    return 0;
+    }
+
+  timer->StartTimer();
+  locator->BatchFindClosestPoint(queries, ids, dist2);
+  timer->StopTimer();
+  double batchTime = timer->GetElapsedTime();
+
+  vtkSmartPointer<vtkIdTypeArray> serial =
+    vtkSmartPointer<vtkIdTypeArray>::New();
+  serial->SetNumberOfTuples(n);
+  timer->StartTimer();
+  for (i = 0; i < n; i++)
+    {
+    queries->GetPoint(i, x);
+    serial->SetValue(i, locator->FindClosestPoint(x));
+    }
+  timer->StopTimer();
+  double serialTime = timer->GetElapsedTime();
+
+  cout << name << ", " << n << " queries: one at a time " << serialTime
+       << " s, batch with " << threads << " threads " << batchTime << " s"
+       << endl;
+
+  for (i = 0; i < n; i++)
+    {
+    queries->GetPoint(i, x);
+    if (!SameDistance(data, x, serial->GetValue(i), ids->GetValue(i),
+                      dist2->GetValue(i)))
+      {
+      cerr << name << " found point " << ids->GetValue(i) << " for query "
+           << i << " instead of " << serial->GetValue(i) << endl;
+      return 0;
+      }
+    }
+
+  // The N closest points of the first queries.
+  vtkIdType nn = n / 20;
+  vtkSmartPointer<vtkPoints> some = vtkSmartPointer<vtkPoints>::New();
+  some->SetNumberOfPoints(nn);
+  for (i = 0; i < nn; i++)
+    {
+    some->SetPoint(i, queries->GetPoint(i));
+    }
+  locator->BatchFindClosestNPoints(NUMBER_OF_CLOSEST, some, ids, dist2);
+  if (ids->GetNumberOfComponents() != NUMBER_OF_CLOSEST ||
+      ids->GetNumberOfTuples() != nn)
+    {
+    cerr << name << " answered " << ids->GetNumberOfTuples() << " queries"
+         << " of " << ids->GetNumberOfComponents() << " points" << endl;
+    return 0;
+    }
+  vtkSmartPointer<vtkIdList> closest = vtkSmartPointer<vtkIdList>::New();
+  for (i = 0; i < nn; i++)
+    {
+    some->GetPoint(i, x);
+    locator->FindClosestNPoints(NUMBER_OF_CLOSEST, x, closest);
+    for (int k = 0; k < NUMBER_OF_CLOSEST; k++)
+      {
+      vtkIdType id = ids->GetValue(i*NUMBER_OF_CLOSEST + k);
+      if (!SameDistance(data, x, closest->GetId(k), id,
+                        dist2->GetValue(i*NUMBER_OF_CLOSEST + k)))
+        {
+        cerr << name << " found point " << id << " as closest " << k
+             << " for query " << i << " instead of " << closest->GetId(k)
+             << endl;
+        return 0;
+        }
+      }
+    }
+
+  // More points asked for than there are, which some locators warn about.
+  vtkSmartPointer<vtkPoints> few = vtkSmartPointer<vtkPoints>::New();
+  few->InsertNextPoint(0.0, 0.0, 0.0);
+  few->InsertNextPoint(1.0, 1.0, 1.0);
+  vtkSmartPointer<vtkPolyData> small = vtkSmartPointer<vtkPolyData>::New();
+  small->SetPoints(few);
+  vtkAbstractPointLocator *smallLocator = locator->NewInstance();
+  smallLocator->SetDataSet(small);
+  int warnings = vtkObject::GetGlobalWarningDisplay();
+  vtkObject::GlobalWarningDisplayOff();
+  smallLocator->BatchFindClosestNPoints(3, few, ids, dist2);
+  vtkObject::SetGlobalWarningDisplay(warnings);
+  smallLocator->Delete();
+  if (ids->GetValue(0) != 0 || ids->GetValue(1) != 1 ||
+      ids->GetValue(2) != -1 || dist2->GetValue(2) != VTK_DOUBLE_MAX ||
+      ids->GetValue(3) != 1 || dist2->GetValue(3) != 0.0)
+    {
+    cerr << name << " did not pad the missing points" << endl;
+    return 0;
+    }
+  return 1;
+}
+
+int TestPointLocatorBatchQueries(int, char *[])
+{
+  int threads = vtkTestUtilities::SetUpThreadPool(4);
+  vtkMath::RandomSeed(5470);
+
+  vtkPoints *points = RandomPoints(100000, -1.0, 1.0);
+  vtkSmartPointer<vtkPolyData> data = vtkSmartPointer<vtkPolyData>::New();
+  data->SetPoints(points);
+  points->Delete();
+  // Some queries fall outside the points.
+  vtkPoints *queries = RandomPoints(200000, -1.2, 1.2);
+
+  vtkSmartPointer<vtkPointLocator> pointLocator =
+    vtkSmartPointer<vtkPointLocator>::New();
+  vtkSmartPointer<vtkKdTreePointLocator> kdTreeLocator =
+    vtkSmartPointer<vtkKdTreePointLocator>::New();
+  vtkSmartPointer<vtkOctreePointLocator> octreeLocator =
+    vtkSmartPointer<vtkOctreePointLocator>::New();
+  int ok = TestLocator(pointLocator, data, queries, threads) &&
+    TestLocator(kdTreeLocator, data, queries, threads) &&
+    TestLocator(octreeLocator, data, queries, threads);
+  queries->Delete();
+  return ok ? 0 : 1;
+}
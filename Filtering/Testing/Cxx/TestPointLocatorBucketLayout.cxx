@@ -0,0 +1,237 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestPointLocatorBucketLayout.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME
+// .SECTION Description
+// Builds vtkPointLocator with buckets laid out row by row and along a
+// Morton curve, checks the searches of both against each other and a
+// brute force search, and the buckets against points inserted
+// incrementally. Reports build and search times.
+
+#include "vtkIdList.h"
+#include "vtkMath.h"
+#include "vtkPointLocator.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkTimerLog.h"
+
+static vtkIdType BruteForceClosest(vtkPoints *points, const double x[3])
+{
+  vtkIdType closest = -1;
+  double minDist2 = VTK_DOUBLE_MAX;
+  for (vtkIdType i = 0; i < points->GetNumberOfPoints(); i++)
+    {
+    double dist2 = vtkMath::Distance2BetweenPoints(x, points->GetPoint(i));
+    if (dist2 < minDist2)
+      {
+      minDist2 = dist2;
+      closest = i;
+      }
+    }
+  return closest;
+}
+
+static int SameIds(vtkIdList *ids1, vtkIdList *ids2)
+{
+  if (ids1->GetNumberOfIds() != ids2->GetNumberOfIds())
+    {
+    return 0;
+    }
+  for (vtkIdType i = 0; i < ids1->GetNumberOfIds(); i++)
+    {
+    if (ids1->GetId(i) != ids2->GetId(i))
+      {
+      return 0;
+      }
+    }
+  return 1;
+}
+
+// Compare the searches of locators built row by row and in Morton order,
+// which must be identical, with a brute force search, and the buckets
+// with those of a locator the same points were inserted into, which keeps
+// them in lists.
+static int CompareLocators(vtkPointLocator *rows, vtkPointLocator *morton,
+                           vtkPointLocator *inserted, vtkPoints *points,
+                           vtkPoints *queries)
+{
+  vtkSmartPointer<vtkIdList> ids1 = vtkSmartPointer<vtkIdList>::New();
+  vtkSmartPointer<vtkIdList> ids2 = vtkSmartPointer<vtkIdList>::New();
+  double x[3], dist2;
+  for (vtkIdType i = 0; i < queries->GetNumberOfPoints(); i++)
+    {
+    queries->GetPoint(i, x);
+    vtkIdType closest = rows->FindClosestPoint(x);
+    if (morton->FindClosestPoint(x) != closest ||
+        (i < 200 && closest != BruteForceClosest(points, x)))
+      {
+      cerr << "Wrong closest point for query " << i << endl;
+      return 0;
+      }
+    rows->FindClosestNPoints(10, x, ids1);
+    morton->FindClosestNPoints(10, x, ids2);
+    if (!SameIds(ids1, ids2) || ids1->GetNumberOfIds() != 10 ||
+        ids1->GetId(0) != closest)
+      {
+      cerr << "Wrong closest points for query " << i << endl;
+      return 0;
+      }
+    if (rows->FindClosestPointWithinRadius(0.1, x, dist2) !=
+        morton->FindClosestPointWithinRadius(0.1, x, dist2))
+      {
+      cerr << "Wrong closest point within radius for query " << i << endl;
+      return 0;
+      }
+    rows->FindPointsWithinRadius(0.05, x, ids1);
+    morton->FindPointsWithinRadius(0.05, x, ids2);
+    vtkIdType count = 0;
+    for (vtkIdType j = 0; i < 200 && j < points->GetNumberOfPoints(); j++)
+      {
+      count += vtkMath::Distance2BetweenPoints(x, points->GetPoint(j)) <=
+        0.05*0.05;
+      }
+    if (!SameIds(ids1, ids2) ||
+        (i < 200 && ids1->GetNumberOfIds() != count))
+      {
+      cerr << "Wrong points within radius for query " << i << endl;
+      return 0;
+      }
+    rows->FindDistributedPoints(2, x, ids1, 100);
+    morton->FindDistributedPoints(2, x, ids2, 100);
+    if (!SameIds(ids1, ids2))
+      {
+      cerr << "Wrong distributed points for query " << i << endl;
+      return 0;
+      }
+    int ijk1[3], ijk2[3];
+    const vtkIdType *ptIds;
+    vtkIdType numIds = morton->GetPointsInBucket(x, ijk1, ptIds);
+    morton->GetPointsInBucket(x, ijk1, ids1);
+    vtkIdList *built = morton->GetPointsInBucket(x, ijk1);
+    vtkIdList *bucket = inserted->GetPointsInBucket(x, ijk2);
+    inserted->GetPointsInBucket(x, ijk2, ids2);
+    if (numIds != ids1->GetNumberOfIds() ||
+        (numIds && ptIds[0] != ids1->GetId(0)) ||
+        (built == 0) != (numIds == 0) || (bucket == 0) != (numIds == 0) ||
+        (built && !SameIds(built, ids1)) ||
+        (bucket && !SameIds(bucket, ids2)) || !SameIds(ids1, ids2))
+      {
+      cerr << "Wrong bucket for query " << i << endl;
+      return 0;
+      }
+    }
+  return 1;
+}
+
+static double TimeSearches(vtkPointLocator *locator, vtkPoints *queries)
+{
+  vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+  vtkSmartPointer<vtkIdList> ids = vtkSmartPointer<vtkIdList>::New();
+  double x[3];
+  timer->StartTimer();
+  for (vtkIdType i = 0; i < queries->GetNumberOfPoints(); i++)
+    {
+    queries->GetPoint(i, x);
+    locator->FindClosestPoint(x);
+    locator->FindPointsWithinRadius(0.01, x, ids);
+    }
+  timer->StopTimer();
+  return timer->GetElapsedTime();
+}
+
+int TestPointLocatorBucketLayout(int, char *[])
+{
+  vtkMath::RandomSeed(1207);
+  const vtkIdType numPts = 20000;
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetNumberOfPoints(numPts);
+  vtkIdType i;
+  for (i = 0; i < numPts; i++)
+    {
+    // Clustered along x so that many buckets are empty.
+    double x = vtkMath::Random(0.0, 1.0);
+    points->SetPoint(i, x*x, vtkMath::Random(0.0, 0.5),
+                     vtkMath::Random(0.0, 0.25));
+    }
+  vtkSmartPointer<vtkPolyData> data = vtkSmartPointer<vtkPolyData>::New();
+  data->SetPoints(points);
+  vtkSmartPointer<vtkPoints> queries = vtkSmartPointer<vtkPoints>::New();
+  queries->SetNumberOfPoints(2000);
+  for (i = 0; i < 2000; i++)
+    {
+    queries->SetPoint(i, vtkMath::Random(-0.1, 1.1),
+                      vtkMath::Random(-0.1, 0.6), vtkMath::Random(-0.1, 0.35));
+    }
+
+  vtkSmartPointer<vtkPointLocator> rows =
+    vtkSmartPointer<vtkPointLocator>::New();
+  rows->SetDataSet(data);
+  rows->BuildLocator();
+  vtkSmartPointer<vtkPointLocator> morton =
+    vtkSmartPointer<vtkPointLocator>::New();
+  morton->MortonOrderOn();
+  morton->SetDataSet(data);
+  morton->BuildLocator();
+
+  // Insert the same points in buckets of the same size.
+  vtkSmartPointer<vtkPointLocator> inserted =
+    vtkSmartPointer<vtkPointLocator>::New();
+  inserted->AutomaticOff();
+  inserted->SetDivisions(rows->GetDivisions());
+  vtkSmartPointer<vtkPoints> newPoints = vtkSmartPointer<vtkPoints>::New();
+  inserted->InitPointInsertion(newPoints, rows->GetBounds());
+  for (i = 0; i < numPts; i++)
+    {
+    inserted->InsertPoint(i, points->GetPoint(i));
+    }
+  if (!CompareLocators(rows, morton, inserted, points, queries))
+    {
+    return 1;
+    }
+
+  // Time both layouts on a larger set.
+  const vtkIdType numLarge = 2000000;
+  vtkSmartPointer<vtkPoints> large = vtkSmartPointer<vtkPoints>::New();
+  large->SetNumberOfPoints(numLarge);
+  for (i = 0; i < numLarge; i++)
+    {
+    large->SetPoint(i, vtkMath::Random(0.0, 1.0), vtkMath::Random(0.0, 1.0),
+                    vtkMath::Random(0.0, 1.0));
+    }
+  data->SetPoints(large);
+  vtkSmartPointer<vtkPoints> largeQueries = vtkSmartPointer<vtkPoints>::New();
+  largeQueries->SetNumberOfPoints(200000);
+  for (i = 0; i < 200000; i++)
+    {
+    largeQueries->SetPoint(i, vtkMath::Random(0.0, 1.0),
+                           vtkMath::Random(0.0, 1.0), vtkMath::Random(0.0, 1.0));
+    }
+  vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+  for (int morton = 0; morton < 2; morton++)
+    {
+    vtkSmartPointer<vtkPointLocator> locator =
+      vtkSmartPointer<vtkPointLocator>::New();
+    locator->SetMortonOrder(morton);
+    locator->SetDataSet(data);
+    timer->StartTimer();
+    locator->BuildLocator();
+    timer->StopTimer();
+    double build = timer->GetElapsedTime();
+    cout << (morton ? "Morton" : "Row by row") << " layout, " << numLarge
+         << " points: build " << build << " s, searches "
+         << TimeSearches(locator, largeQueries) << " s" << endl;
+    }
+  return 0;
+}
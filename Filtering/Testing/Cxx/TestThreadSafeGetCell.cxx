@@ -0,0 +1,298 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestThreadSafeGetCell.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME
+// .SECTION Description
+// Calls GetCell(cellId, vtkGenericCell*), GetCellBounds(), GetCellType(),
+// GetCellPoints() and GetPoint(id, x) from several threads at once on a
+// polydata, an unstructured grid, an image and a structured grid, after
+// PrepareForThreadedAccess(), and checks that every thread sees the same
+// cells as a serial traversal.
+
+#include "vtkCellArray.h"
+#include "vtkCellType.h"
+#include "vtkGenericCell.h"
+#include "vtkIdList.h"
+#include "vtkImageData.h"
+#include "vtkMultiThreader.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkStructuredGrid.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <vtkstd/vector>
+
+#define NUMBER_OF_THREADS 4
+#define NX 12
+#define NY 10
+#define NZ 8
+
+// Reduces everything the read methods return for a cell to one value.
+static double CellSignature(vtkDataSet *ds, vtkIdType cellId,
+                            vtkGenericCell *cell, vtkIdList *ptIds)
+{
+  double signature = 0.0;
+  double bounds[6], x[3];
+  ds->GetCell(cellId, cell);
+  signature += 1000.0*cell->GetCellType() + cell->GetNumberOfPoints();
+  vtkIdType i;
+  for (i = 0; i < cell->GetNumberOfPoints(); i++)
+    {
+    signature += (i + 1)*cell->GetPointId(i);
+    double *p = cell->GetPoints()->GetPoint(i);
+    signature += 0.5*p[0] + 0.25*p[1] + 0.125*p[2];
+    }
+  ds->GetCellBounds(cellId, bounds);
+  for (i = 0; i < 6; i++)
+    {
+    signature += (i + 1)*bounds[i];
+    }
+  signature += 100.0*ds->GetCellType(cellId);
+  ds->GetCellPoints(cellId, ptIds);
+  for (i = 0; i < ptIds->GetNumberOfIds(); i++)
+    {
+    ds->GetPoint(ptIds->GetId(i), x);
+    signature += 3.0*(i + 1)*ptIds->GetId(i) + x[0] - x[1] + 2.0*x[2];
+    }
+  return signature;
+}
+
+struct ThreadData
+{
+  vtkDataSet *DataSet;
+  vtkstd::vector<double> Signatures[NUMBER_OF_THREADS];
+};
+
+// Every thread visits every cell, starting at a different place so that
+// the threads read the same cells at different times.
+static VTK_THREAD_RETURN_TYPE VisitCells(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *info =
+    static_cast<vtkMultiThreader::ThreadInfo *>(arg);
+  ThreadData *data = static_cast<ThreadData *>(info->UserData);
+  vtkDataSet *ds = data->DataSet;
+  vtkstd::vector<double> &signatures = data->Signatures[info->ThreadID];
+  vtkGenericCell *cell = vtkGenericCell::New();
+  vtkIdList *ptIds = vtkIdList::New();
+  vtkIdType numCells = ds->GetNumberOfCells();
+  signatures.resize(numCells);
+  vtkIdType start = info->ThreadID*numCells/NUMBER_OF_THREADS;
+  for (int pass = 0; pass < 3; pass++)
+    {
+    for (vtkIdType i = 0; i < numCells; i++)
+      {
+      vtkIdType cellId = (start + i) % numCells;
+      signatures[cellId] = CellSignature(ds, cellId, cell, ptIds);
+      }
+    }
+  cell->Delete();
+  ptIds->Delete();
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+static int CheckDataSet(vtkDataSet *ds, const char *what)
+{
+  ds->PrepareForThreadedAccess();
+
+  ThreadData data;
+  data.DataSet = ds;
+  vtkSmartPointer<vtkMultiThreader> threader =
+    vtkSmartPointer<vtkMultiThreader>::New();
+  threader->SetNumberOfThreads(NUMBER_OF_THREADS);
+  threader->SetSingleMethod(VisitCells, &data);
+  threader->SingleMethodExecute();
+
+  vtkSmartPointer<vtkGenericCell> cell = vtkSmartPointer<vtkGenericCell>::New();
+  vtkSmartPointer<vtkIdList> ptIds = vtkSmartPointer<vtkIdList>::New();
+  vtkIdType numCells = ds->GetNumberOfCells();
+  for (int t = 0; t < threader->GetNumberOfThreads(); t++)
+    {
+    if (static_cast<vtkIdType>(data.Signatures[t].size()) != numCells)
+      {
+      cerr << what << ": thread " << t << " did not run" << endl;
+      return 0;
+      }
+    for (vtkIdType i = 0; i < numCells; i++)
+      {
+      if (data.Signatures[t][i] != CellSignature(ds, i, cell, ptIds))
+        {
+        cerr << what << ": thread " << t << " got a wrong cell " << i << endl;
+        return 0;
+        }
+      }
+    }
+  return 1;
+}
+
+static vtkPoints *NewGridPoints()
+{
+  vtkPoints *points = vtkPoints::New();
+  for (int k = 0; k < NZ; k++)
+    {
+    for (int j = 0; j < NY; j++)
+      {
+      for (int i = 0; i < NX; i++)
+        {
+        points->InsertNextPoint(i + 0.1*j, j + 0.01*k*k, 0.5*k);
+        }
+      }
+    }
+  return points;
+}
+
+static vtkIdType PointId(int i, int j, int k)
+{
+  return (k*NY + j)*NX + i;
+}
+
+static int TestPolyData(int layout)
+{
+  vtkSmartPointer<vtkCellArray> verts = vtkSmartPointer<vtkCellArray>::New();
+  vtkSmartPointer<vtkCellArray> lines = vtkSmartPointer<vtkCellArray>::New();
+  vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+  vtkSmartPointer<vtkCellArray> strips = vtkSmartPointer<vtkCellArray>::New();
+  verts->SetLayout(layout);
+  lines->SetLayout(layout);
+  polys->SetLayout(layout);
+  strips->SetLayout(layout);
+  vtkIdType pts[NX];
+  int i, j;
+  for (i = 0; i < NX; i++)
+    {
+    pts[0] = PointId(i, 0, NZ-1);
+    verts->InsertNextCell(1, pts);
+    }
+  for (j = 0; j < NY; j++)
+    {
+    for (i = 0; i < NX; i++)
+      {
+      pts[i] = PointId(i, j, NZ-2);
+      }
+    lines->InsertNextCell(2 + j%(NX-1), pts);
+    }
+  for (j = 0; j < NY-1; j++)
+    {
+    for (i = 0; i < NX-1; i++)
+      {
+      pts[0] = PointId(i, j, 0);
+      pts[1] = PointId(i+1, j, 0);
+      pts[2] = PointId(i+1, j+1, 0);
+      pts[3] = PointId(i, j+1, 0);
+      polys->InsertNextCell((i+j)%2 ? 3 : 4, pts);
+      }
+    }
+  for (j = 0; j < NY-1; j++)
+    {
+    for (i = 0; i < NX/2; i++)
+      {
+      pts[2*i] = PointId(i, j, 1);
+      pts[2*i+1] = PointId(i, j+1, 1);
+      }
+    strips->InsertNextCell(NX, pts);
+    }
+
+  vtkSmartPointer<vtkPoints> points;
+  points.TakeReference(NewGridPoints());
+  vtkSmartPointer<vtkPolyData> pd = vtkSmartPointer<vtkPolyData>::New();
+  pd->SetPoints(points);
+  pd->SetVerts(verts);
+  pd->SetLines(lines);
+  pd->SetPolys(polys);
+  pd->SetStrips(strips);
+  return CheckDataSet(pd, layout == VTK_CELL_ARRAY_LEGACY ?
+                      "vtkPolyData" : "vtkPolyData with offsets");
+}
+
+static int TestUnstructuredGrid()
+{
+  vtkSmartPointer<vtkPoints> points;
+  points.TakeReference(NewGridPoints());
+  vtkSmartPointer<vtkUnstructuredGrid> ug =
+    vtkSmartPointer<vtkUnstructuredGrid>::New();
+  ug->SetPoints(points);
+  ug->Allocate();
+  vtkIdType pts[8];
+  for (int k = 0; k < NZ-1; k++)
+    {
+    for (int j = 0; j < NY-1; j++)
+      {
+      for (int i = 0; i < NX-1; i++)
+        {
+        pts[0] = PointId(i, j, k);
+        pts[1] = PointId(i+1, j, k);
+        pts[2] = PointId(i+1, j+1, k);
+        pts[3] = PointId(i, j+1, k);
+        pts[4] = PointId(i, j, k+1);
+        pts[5] = PointId(i+1, j, k+1);
+        pts[6] = PointId(i+1, j+1, k+1);
+        pts[7] = PointId(i, j+1, k+1);
+        switch ((i + j + k) % 3)
+          {
+          case 0:
+            ug->InsertNextCell(VTK_HEXAHEDRON, 8, pts);
+            break;
+          case 1:
+            ug->InsertNextCell(VTK_TETRA, 4, pts);
+            break;
+          default:
+            ug->InsertNextCell(VTK_QUAD, 4, pts + 4);
+            break;
+          }
+        }
+      }
+    }
+  return CheckDataSet(ug, "vtkUnstructuredGrid");
+}
+
+static int TestImageData()
+{
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetExtent(2, NX+1, -3, NY-4, 1, NZ);
+  image->SetOrigin(0.5, -1.0, 2.0);
+  image->SetSpacing(0.25, 1.5, 2.0);
+  if (!CheckDataSet(image, "vtkImageData"))
+    {
+    return 0;
+    }
+  // An image with a single slice has cells of a lower dimension.
+  image->SetExtent(0, NX-1, 0, 0, 0, NZ-1);
+  return CheckDataSet(image, "vtkImageData slice");
+}
+
+static int TestStructuredGrid()
+{
+  vtkSmartPointer<vtkPoints> points;
+  points.TakeReference(NewGridPoints());
+  vtkSmartPointer<vtkStructuredGrid> sg =
+    vtkSmartPointer<vtkStructuredGrid>::New();
+  sg->SetDimensions(NX, NY, NZ);
+  sg->SetPoints(points);
+  sg->BlankPoint(PointId(3, 4, 5));
+  sg->BlankCell(7);
+  return CheckDataSet(sg, "vtkStructuredGrid");
+}
+
+int TestThreadSafeGetCell(int, char *[])
+{
+  if (!TestPolyData(VTK_CELL_ARRAY_LEGACY) ||
+      !TestPolyData(VTK_CELL_ARRAY_OFFSETS_32) ||
+      !TestUnstructuredGrid() ||
+      !TestImageData() ||
+      !TestStructuredGrid())
+    {
+    return 1;
+    }
+  return 0;
+}
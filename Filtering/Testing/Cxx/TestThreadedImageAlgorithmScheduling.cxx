@@ -0,0 +1,235 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestThreadedImageAlgorithmScheduling.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME
+// .SECTION Description
+// Checks that every split mode of vtkThreadedImageAlgorithm::SplitExtent
+// partitions the extent, and that with dynamic scheduling every voxel of
+// the output is computed exactly once. Also reports the time taken by a
+// filter whose cost is concentrated in a few slices with the static and
+// the dynamic scheduling.
+
+#include "vtkThreadedImageAlgorithm.h"
+#include "vtkImageData.h"
+#include "vtkObjectFactory.h"
+#include "vtkSmartPointer.h"
+#include "vtkTimerLog.h"
+
+#include <vtkstd/vector>
+
+class vtkSchedulingTestFilter : public vtkThreadedImageAlgorithm
+{
+public:
+  static vtkSchedulingTestFilter *New();
+  vtkTypeMacro(vtkSchedulingTestFilter, vtkThreadedImageAlgorithm);
+
+  // Number of times each voxel of the whole extent was computed.
+  vtkstd::vector<int> Counts;
+  int WholeExtent[6];
+  // Slices with a z index below this are made expensive.
+  int ExpensiveSlices;
+
+  virtual void ThreadedRequestData(vtkInformation *,
+                                   vtkInformationVector **,
+                                   vtkInformationVector *,
+                                   vtkImageData ***inData,
+                                   vtkImageData **outData,
+                                   int ext[6], int)
+    {
+    int nx = this->WholeExtent[1] - this->WholeExtent[0] + 1;
+    int ny = this->WholeExtent[3] - this->WholeExtent[2] + 1;
+    for (int k = ext[4]; k <= ext[5]; k++)
+      {
+      for (int j = ext[2]; j <= ext[3]; j++)
+        {
+        float *inPtr = static_cast<float *>(
+          inData[0][0]->GetScalarPointer(ext[0], j, k));
+        float *outPtr = static_cast<float *>(
+          outData[0]->GetScalarPointer(ext[0], j, k));
+        for (int i = ext[0]; i <= ext[1]; i++)
+          {
+          double value = *inPtr++;
+          if (k < this->ExpensiveSlices)
+            {
+            for (int n = 0; n < 200; n++)
+              {
+              value = 0.5*value + 1.0;
+              }
+            }
+          *outPtr++ = static_cast<float>(2.0*value + 1.0);
+          this->Counts[(k*ny + j)*nx + i]++;
+          }
+        }
+      }
+    }
+
+protected:
+  vtkSchedulingTestFilter() { this->ExpensiveSlices = 0; }
+};
+
+vtkStandardNewMacro(vtkSchedulingTestFilter);
+
+// Check that the pieces of SplitExtent cover the extent exactly once.
+static int CheckSplit(vtkThreadedImageAlgorithm *filter, int ext[6],
+                      int total)
+{
+  int nx = ext[1] - ext[0] + 1;
+  int ny = ext[3] - ext[2] + 1;
+  int nz = ext[5] - ext[4] + 1;
+  vtkstd::vector<int> counts(nx*ny*nz, 0);
+  int splitExt[6];
+  int pieces = filter->SplitExtent(splitExt, ext, 0, total);
+  if (pieces < 1 || pieces > total)
+    {
+    cerr << filter->GetSplitModeAsString() << ": " << pieces
+         << " pieces for a total of " << total << endl;
+    return 0;
+    }
+  for (int piece = 0; piece < pieces; piece++)
+    {
+    filter->SplitExtent(splitExt, ext, piece, total);
+    if (filter->GetSplitMode() == VTK_IMAGE_SPLIT_MODE_BEAM &&
+        pieces > 1 && (splitExt[0] != ext[0] || splitExt[1] != ext[1]) &&
+        (ny > 1 || nz > 1))
+      {
+      cerr << "Beam mode split the x axis" << endl;
+      return 0;
+      }
+    for (int k = splitExt[4]; k <= splitExt[5]; k++)
+      {
+      for (int j = splitExt[2]; j <= splitExt[3]; j++)
+        {
+        for (int i = splitExt[0]; i <= splitExt[1]; i++)
+          {
+          counts[((k - ext[4])*ny + j - ext[2])*nx + i - ext[0]]++;
+          }
+        }
+      }
+    }
+  for (size_t n = 0; n < counts.size(); n++)
+    {
+    if (counts[n] != 1)
+      {
+      cerr << filter->GetSplitModeAsString() << " split into " << total
+           << " pieces covers a voxel " << counts[n] << " times" << endl;
+      return 0;
+      }
+    }
+  return 1;
+}
+
+int TestThreadedImageAlgorithmScheduling(int, char *[])
+{
+  int mode, total, i;
+
+  vtkSmartPointer<vtkSchedulingTestFilter> filter =
+    vtkSmartPointer<vtkSchedulingTestFilter>::New();
+
+  int extents[3][6] = {
+    { 0, 63, 0, 47, 0, 9 },
+    { -3, 20, 5, 40, 2, 2 },
+    { 0, 99, 0, 0, 0, 0 } };
+  int totals[5] = { 1, 3, 8, 37, 1000 };
+  for (mode = VTK_IMAGE_SPLIT_MODE_SLAB;
+       mode <= VTK_IMAGE_SPLIT_MODE_BLOCK; mode++)
+    {
+    filter->SetSplitMode(mode);
+    for (i = 0; i < 3; i++)
+      {
+      for (total = 0; total < 5; total++)
+        {
+        if (!CheckSplit(filter, extents[i], totals[total]))
+          {
+          return 1;
+          }
+        }
+      }
+    }
+
+  // Run the filter on an image with a few expensive slices.
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetExtent(0, 127, 0, 127, 0, 31);
+  image->SetScalarTypeToFloat();
+  image->SetNumberOfScalarComponents(1);
+  image->AllocateScalars();
+  float *inPtr = static_cast<float *>(image->GetScalarPointer());
+  vtkIdType numberOfVoxels = image->GetNumberOfPoints();
+  vtkIdType n;
+  for (n = 0; n < numberOfVoxels; n++)
+    {
+    inPtr[n] = static_cast<float>(n % 17);
+    }
+
+  filter->SetInput(image);
+  image->GetExtent(filter->WholeExtent);
+  filter->ExpensiveSlices = 4;
+  filter->SetNumberOfThreads(8);
+  filter->SetMinimumBlockSize(1024);
+
+  if (filter->GetUseThreadPool())
+    {
+    cerr << "The thread pool is used without asking for it" << endl;
+    return 1;
+    }
+
+  // Both schedulings, with threads of their own and on the thread pool.
+  vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+  for (int run = 0; run < 4; run++)
+    {
+    int dynamic = run % 2;
+    int pool = run / 2;
+    for (mode = VTK_IMAGE_SPLIT_MODE_SLAB;
+         mode <= VTK_IMAGE_SPLIT_MODE_BLOCK; mode++)
+      {
+      filter->SetUseDynamicScheduling(dynamic);
+      filter->SetUseThreadPool(pool);
+      filter->SetSplitMode(mode);
+      filter->Counts.assign(numberOfVoxels, 0);
+      filter->Modified();
+      timer->StartTimer();
+      filter->Update();
+      timer->StopTimer();
+
+      vtkImageData *output = filter->GetOutput();
+      if (output->GetScalarType() != VTK_FLOAT)
+        {
+        cerr << "Unexpected output scalar type" << endl;
+        return 1;
+        }
+      float *outPtr = static_cast<float *>(output->GetScalarPointer());
+      for (n = 0; n < numberOfVoxels; n++)
+        {
+        if (filter->Counts[n] != 1)
+          {
+          cerr << "Voxel " << n << " was computed " << filter->Counts[n]
+               << " times" << endl;
+          return 1;
+          }
+        // the expensive slices compute a different value
+        if (n >= filter->ExpensiveSlices*128*128 &&
+            outPtr[n] != 2.0f*inPtr[n] + 1.0f)
+          {
+          cerr << "Wrong value for voxel " << n << endl;
+          return 1;
+          }
+        }
+      cout << (dynamic ? "Dynamic" : "Static") << " scheduling"
+           << (pool ? " on the pool, " : ", ")
+           << filter->GetSplitModeAsString() << " split: "
+           << timer->GetElapsedTime() << " s" << endl;
+      }
+    }
+
+  return 0;
+}
@@ -22,6 +22,9 @@
 #include "vtkPoints.h"
 #include "vtkDataSet.h"
 #include "vtkMath.h"
+#include "vtkPolyData.h"
+#include "vtkUnsignedCharArray.h"
+#include "vtkUnstructuredGrid.h"
 //----------------------------------------------------------------------------
 //----------------------------------------------------------------------------
 vtkAbstractCellLocator::vtkAbstractCellLocator()
@@ -33,8 +36,13 @@ vtkAbstractCellLocator::vtkAbstractCellLocator()
   this->RetainCellLists            = 1;
   this->NumberOfCellsPerNode       = 32;
   this->UseExistingSearchStructure = 0;
+  this->RefitSearchStructure       = 0;
   this->LazyEvaluation             = 0;
   this->GenericCell                = vtkGenericCell::New();
+  for (int i = 0; i < 4; i++)
+    {
+    this->TopologyArrays[i] = NULL;
+    }
 }
 //----------------------------------------------------------------------------
 vtkAbstractCellLocator::~vtkAbstractCellLocator()
@@ -56,6 +64,58 @@ bool vtkAbstractCellLocator::StoreCellBounds()
   return true;
 }
 //----------------------------------------------------------------------------
+unsigned long vtkAbstractCellLocator::GetDataSetTopologyMTime()
+{
+  if (!this->DataSet)
+    {
+    return 0;
+    }
+  vtkObject *arrays[4] = {NULL, NULL, NULL, NULL};
+  vtkPolyData *pd = vtkPolyData::SafeDownCast(this->DataSet);
+  vtkUnstructuredGrid *ug = vtkUnstructuredGrid::SafeDownCast(this->DataSet);
+  if (pd)
+    {
+    arrays[0] = pd->GetVerts();
+    arrays[1] = pd->GetLines();
+    arrays[2] = pd->GetPolys();
+    arrays[3] = pd->GetStrips();
+    }
+  else if (ug)
+    {
+    arrays[0] = ug->GetCells();
+    arrays[1] = ug->GetCellTypesArray();
+    }
+  else
+    {
+    // Without separate cell arrays, any change of the dataset itself may
+    // change its cells.
+    return this->DataSet->vtkObject::GetMTime();
+    }
+
+  // An array replaced by another one may be older than the last build.
+  unsigned long mtime = 0, t;
+  int i, replaced = 0;
+  for (i = 0; i < 4; i++)
+    {
+    if (arrays[i] != this->TopologyArrays[i])
+      {
+      this->TopologyArrays[i] = arrays[i];
+      replaced = 1;
+      }
+    if (arrays[i])
+      {
+      t = arrays[i]->GetMTime();
+      mtime = t > mtime ? t : mtime;
+      }
+    }
+  if (replaced)
+    {
+    this->TopologyTime.Modified();
+    }
+  t = this->TopologyTime.GetMTime();
+  return t > mtime ? t : mtime;
+}
+//----------------------------------------------------------------------------
 void vtkAbstractCellLocator::FreeCellBounds()
 {
   if (this->CellBounds)
@@ -227,6 +287,8 @@ void vtkAbstractCellLocator::PrintSelf(ostream& os, vtkIndent indent)
      << this->NumberOfCellsPerNode << "\n";
   os << indent << "UseExistingSearchStructure: " 
      << this->UseExistingSearchStructure << "\n";
+  os << indent << "RefitSearchStructure: " 
+     << this->RefitSearchStructure << "\n";
   os << indent << "LazyEvaluation: " 
      << this->LazyEvaluation << "\n";
 }
@@ -94,6 +94,20 @@ public:
   vtkGetMacro(UseExistingSearchStructure,int);
   vtkBooleanMacro(UseExistingSearchStructure,int);
 
+  // Description:
+  // Some locators can refit their search structure when only the points of
+  // the dataset have moved, as with a deforming mesh: the hierarchy is kept
+  // and only its bounds are recomputed, in linear time instead of a full
+  // rebuild. Turning on this flag lets them refit when the cells of the
+  // dataset are unchanged since the last build. A structure refitted after
+  // large deformations answers queries more slowly; turn the flag off for
+  // one BuildLocator() to rebuild it. Only vtkBVHCellLocator refits: this
+  // class does not implement refitting, and the other locators, including
+  // vtkModifiedBSPTree and vtkCellLocator, ignore the flag and rebuild.
+  vtkSetMacro(RefitSearchStructure,int);
+  vtkGetMacro(RefitSearchStructure,int);
+  vtkBooleanMacro(RefitSearchStructure,int);
+
   // Description:
   // Return intersection point (if any) of finite line with cells contained
   // in cell locator.
@@ -252,12 +266,26 @@ protected:
   virtual bool StoreCellBounds();
   virtual void FreeCellBounds();
 
+  // Description:
+  // Return the modification time of the cells of the dataset, leaving out
+  // its points. For polygonal data and unstructured grids this is the time
+  // of their cell arrays, so that moving or replacing the points does not
+  // change it, or the time the dataset was found with other cell arrays
+  // than at the previous call, so that replacing a cell array by an older
+  // one does. Used by locators that support RefitSearchStructure.
+  unsigned long GetDataSetTopologyMTime();
+
   int NumberOfCellsPerNode;
   int RetainCellLists;
   int CacheCellBounds;
   int LazyEvaluation;
   int UseExistingSearchStructure;
+  int RefitSearchStructure;
   vtkGenericCell *GenericCell;
+  // The cell arrays GetDataSetTopologyMTime() last found, only compared
+  // (not referenced), and when they were last replaced.
+  vtkObject *TopologyArrays[4];
+  vtkTimeStamp TopologyTime;
 //BTX - begin tcl exclude
   double (*CellBounds)[6];
 //ETX - end tcl exclude
@@ -162,6 +162,11 @@ public:
   // Set the last cell id to -1 to incur a global cell search for the next point.
   void ClearLastCellId() { this->LastCellId = -1; }
 
+  // Description:
+  // Forget the most recently visited dataset so that the next point is
+  // searched for in the datasets in the order they were added.
+  void ClearLastDataSet() { this->LastDataSet = 0; this->LastDataSetIndex = 0; }
+
   // Description: 
   // Get the interpolation weights cached from last evaluation. Return 1 if the
   // cached cell is valid and 0 otherwise.
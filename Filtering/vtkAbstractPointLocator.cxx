@@ -15,8 +15,150 @@
 #include "vtkAbstractPointLocator.h"
 
 #include "vtkDataSet.h"
+#include "vtkDoubleArray.h"
 #include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
+#include "vtkMath.h"
+#include "vtkMultiThreader.h"
+#include "vtkPoints.h"
 
+// Batch queries are split in at most this many pieces per thread, for the
+// thread pool to balance.
+#define VTK_POINT_LOCATOR_PIECES_PER_THREAD 8
+// and pieces of at least this many queries.
+#define VTK_POINT_LOCATOR_MIN_PIECE_SIZE 256
+
+//----------------------------------------------------------------------------
+// A batch of queries, shared by the threads answering it.
+struct vtkAbstractPointLocatorBatch
+{
+  vtkAbstractPointLocator *Locator;
+  vtkPoints *Queries;
+  int N;              // 0 to find the closest point only
+  vtkIdType *Ids;
+  double *Dist2;      // NULL if not asked for
+  vtkIdType Begin;    // first query answered on the threads
+  int NumberOfPieces;
+};
+
+//----------------------------------------------------------------------------
+// Answer queries [begin, end) of a batch. scratch is the list used for
+// the N closest points.
+static void vtkAbstractPointLocatorAnswer(vtkAbstractPointLocatorBatch *batch,
+                                          vtkIdType begin, vtkIdType end,
+                                          vtkIdList *scratch)
+{
+  vtkAbstractPointLocator *locator = batch->Locator;
+  vtkDataSet *dataSet = locator->GetDataSet();
+  double x[3], p[3];
+
+  for (vtkIdType i = begin; i < end; i++)
+    {
+    batch->Queries->GetPoint(i, x);
+    if (batch->N == 0)
+      {
+      vtkIdType id = locator->FindClosestPoint(x);
+      batch->Ids[i] = id;
+      if (batch->Dist2)
+        {
+        if (id >= 0)
+          {
+          dataSet->GetPoint(id, p);
+          batch->Dist2[i] = vtkMath::Distance2BetweenPoints(x, p);
+          }
+        else
+          {
+          batch->Dist2[i] = VTK_DOUBLE_MAX;
+          }
+        }
+      continue;
+      }
+
+    locator->FindClosestNPoints(batch->N, x, scratch);
+    vtkIdType *ids = batch->Ids + i*batch->N;
+    double *dist2 = batch->Dist2 ? batch->Dist2 + i*batch->N : 0;
+    vtkIdType found = scratch->GetNumberOfIds();
+    for (int k = 0; k < batch->N; k++)
+      {
+      ids[k] = (k < found) ? scratch->GetId(k) : -1;
+      if (dist2)
+        {
+        if (ids[k] >= 0)
+          {
+          dataSet->GetPoint(ids[k], p);
+          dist2[k] = vtkMath::Distance2BetweenPoints(x, p);
+          }
+        else
+          {
+          dist2[k] = VTK_DOUBLE_MAX;
+          }
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+static VTK_THREAD_RETURN_TYPE vtkAbstractPointLocatorBatchExecute(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *info =
+    static_cast<vtkMultiThreader::ThreadInfo *>(arg);
+  vtkAbstractPointLocatorBatch *batch =
+    static_cast<vtkAbstractPointLocatorBatch *>(info->UserData);
+
+  vtkIdList *scratch = batch->N ? vtkIdList::New() : 0;
+  vtkIdType n = batch->Queries->GetNumberOfPoints() - batch->Begin;
+  for (int piece = info->ThreadID; piece < batch->NumberOfPieces;
+       piece += info->NumberOfThreads)
+    {
+    vtkAbstractPointLocatorAnswer(
+      batch, batch->Begin + n*piece/batch->NumberOfPieces,
+      batch->Begin + n*(piece + 1)/batch->NumberOfPieces, scratch);
+    }
+  if (scratch)
+    {
+    scratch->Delete();
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+// Answer the first query here, which builds the locator if needed, then
+// the others on the thread pool.
+static void vtkAbstractPointLocatorExecute(vtkAbstractPointLocatorBatch *batch,
+                                           int numberOfThreads)
+{
+  vtkIdType n = batch->Queries->GetNumberOfPoints();
+  if (n < 1)
+    {
+    return;
+    }
+
+  vtkIdList *scratch = vtkIdList::New();
+  vtkAbstractPointLocatorAnswer(batch, 0, 1, scratch);
+  batch->Begin = 1;
+
+  vtkIdType pieces = (n - 1) / VTK_POINT_LOCATOR_MIN_PIECE_SIZE;
+  if (pieces > numberOfThreads*VTK_POINT_LOCATOR_PIECES_PER_THREAD)
+    {
+    pieces = numberOfThreads*VTK_POINT_LOCATOR_PIECES_PER_THREAD;
+    }
+  if (numberOfThreads < 2 || pieces < 2)
+    {
+    vtkAbstractPointLocatorAnswer(batch, 1, n, scratch);
+    scratch->Delete();
+    return;
+    }
+  scratch->Delete();
+
+  batch->NumberOfPieces = static_cast<int>(pieces);
+  vtkMultiThreader *threader = vtkMultiThreader::New();
+  threader->UseThreadPoolOn();
+  threader->SetNumberOfThreads(numberOfThreads);
+  threader->SetNumberOfPieces(batch->NumberOfPieces);
+  threader->SetSingleMethod(vtkAbstractPointLocatorBatchExecute, batch);
+  threader->SingleMethodExecute();
+  threader->Delete();
+}
 
 vtkAbstractPointLocator::vtkAbstractPointLocator()
 {
@@ -24,6 +166,7 @@ vtkAbstractPointLocator::vtkAbstractPointLocator()
     {
     this->Bounds[i] = 0;
     }
+  this->NumberOfThreads = 1;
 }
 
 vtkAbstractPointLocator::~vtkAbstractPointLocator()
@@ -62,6 +205,56 @@ void vtkAbstractPointLocator::FindPointsWithinRadius(double R, double x,
   this->FindPointsWithinRadius(R,p,result);
 }
 
+void vtkAbstractPointLocator::BatchFindClosestPoint(vtkPoints *queries,
+                                                    vtkIdTypeArray *ids,
+                                                    vtkDoubleArray *dist2)
+{
+  vtkIdType n = queries->GetNumberOfPoints();
+  ids->SetNumberOfComponents(1);
+  ids->SetNumberOfTuples(n);
+  if (dist2)
+    {
+    dist2->SetNumberOfComponents(1);
+    dist2->SetNumberOfTuples(n);
+    }
+
+  vtkAbstractPointLocatorBatch batch;
+  batch.Locator = this;
+  batch.Queries = queries;
+  batch.N = 0;
+  batch.Ids = ids->GetPointer(0);
+  batch.Dist2 = dist2 ? dist2->GetPointer(0) : 0;
+  vtkAbstractPointLocatorExecute(&batch, this->NumberOfThreads);
+}
+
+void vtkAbstractPointLocator::BatchFindClosestNPoints(int N,
+                                                      vtkPoints *queries,
+                                                      vtkIdTypeArray *ids,
+                                                      vtkDoubleArray *dist2)
+{
+  if (N < 1)
+    {
+    vtkErrorMacro("The number of points to find must be positive.");
+    return;
+    }
+  vtkIdType n = queries->GetNumberOfPoints();
+  ids->SetNumberOfComponents(N);
+  ids->SetNumberOfTuples(n);
+  if (dist2)
+    {
+    dist2->SetNumberOfComponents(N);
+    dist2->SetNumberOfTuples(n);
+    }
+
+  vtkAbstractPointLocatorBatch batch;
+  batch.Locator = this;
+  batch.Queries = queries;
+  batch.N = N;
+  batch.Ids = ids->GetPointer(0);
+  batch.Dist2 = dist2 ? dist2->GetPointer(0) : 0;
+  vtkAbstractPointLocatorExecute(&batch, this->NumberOfThreads);
+}
+
 void vtkAbstractPointLocator::GetBounds(double* bnds)
 {
   for(int i=0;i<6;i++)
@@ -78,5 +271,6 @@ void vtkAbstractPointLocator::PrintSelf(ostream& os, vtkIndent indent)
     {
     os << indent << "Bounds[" << i << "]: " << this->Bounds[i] << "\n";
     }
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << "\n";
 }
 
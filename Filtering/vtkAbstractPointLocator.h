@@ -20,13 +20,19 @@
 // lie in each bucket. Typical operation involves giving a position in 3D 
 // and finding the closest point.  The points are provided from the specified 
 // dataset input.
+//
+// BatchFindClosestPoint() and BatchFindClosestNPoints() answer the same
+// queries for many positions at once, divided among several threads.
 
 #ifndef __vtkAbstractPointLocator_h
 #define __vtkAbstractPointLocator_h
 
 #include "vtkLocator.h"
 
+class vtkDoubleArray;
 class vtkIdList;
+class vtkIdTypeArray;
+class vtkPoints;
 
 class VTK_FILTERING_EXPORT vtkAbstractPointLocator : public vtkLocator
 {
@@ -71,6 +77,32 @@ public:
   void FindPointsWithinRadius(double R, double x, double y, double z, 
                                       vtkIdList *result);
   
+  // Description:
+  // Find the point closest to each point of queries, as FindClosestPoint()
+  // does. ids receives one id per query and, if dist2 is not NULL, dist2
+  // the squared distance to that point (-1 and VTK_DOUBLE_MAX when there
+  // is none). The queries are divided among NumberOfThreads threads after
+  // the first one has built the locator, so FindClosestPoint() must be
+  // thread safe on a built locator, as it is for vtkPointLocator,
+  // vtkKdTreePointLocator and vtkOctreePointLocator.
+  virtual void BatchFindClosestPoint(vtkPoints *queries, vtkIdTypeArray *ids,
+                                     vtkDoubleArray *dist2 = 0);
+
+  // Description:
+  // Find the N points closest to each point of queries, as
+  // FindClosestNPoints() does. ids and dist2 receive one tuple of N
+  // components per query, sorted from closest to farthest and padded
+  // with -1 and VTK_DOUBLE_MAX if there are fewer than N points. Each
+  // thread uses its own id list for the queries it answers.
+  virtual void BatchFindClosestNPoints(int N, vtkPoints *queries,
+                                       vtkIdTypeArray *ids,
+                                       vtkDoubleArray *dist2 = 0);
+
+  // Description:
+  // Set/Get the number of threads used by the batch queries. Default is 1.
+  vtkSetClampMacro(NumberOfThreads, int, 1, VTK_LARGE_INTEGER);
+  vtkGetMacro(NumberOfThreads, int);
+
   // Description:
   // Provide an accessor to the bounds.
   virtual double *GetBounds() { return this->Bounds; }
@@ -88,6 +120,7 @@ protected:
   virtual ~vtkAbstractPointLocator();
 
   double Bounds[6]; // bounds of points
+  int NumberOfThreads;
 
 private:
   vtkAbstractPointLocator(const vtkAbstractPointLocator&);  // Not implemented.
@@ -371,6 +371,15 @@ int vtkBSPIntersections::IntersectsSphere2(int regionId, double x, double y, dou
 //----------------------------------------------------------------------------
 int vtkBSPIntersections::IntersectsSphere2(int *ids, int len,
                        double x, double y, double z, double rSquared)
+{                            
+  return this->IntersectsSphere2(ids, len, x, y, z, rSquared,
+                                 this->ComputeIntersectionsUsingDataBounds);
+} 
+
+//----------------------------------------------------------------------------
+int vtkBSPIntersections::IntersectsSphere2(int *ids, int len,
+                       double x, double y, double z, double rSquared,
+                       int useDataBounds)
 {                            
   REGIONCHECK(0)
 
@@ -379,20 +388,20 @@ int vtkBSPIntersections::IntersectsSphere2(int *ids, int len,
   if (len > 0)
     {
     nnodes = this->_IntersectsSphere2(this->Cuts->GetKdNodeTree(), 
-      ids, len, x, y, z, rSquared);
+      ids, len, x, y, z, rSquared, useDataBounds);
     }                        
   return nnodes;
 } 
 
 //----------------------------------------------------------------------------
 int vtkBSPIntersections::_IntersectsSphere2(vtkKdNode *node, int *ids, int len,
-                                  double x, double y, double z, double rSquared)
+                                  double x, double y, double z, double rSquared,
+                                  int useDataBounds)
 {                            
   int result, nnodes1, nnodes2, listlen;
   int *idlist;
   
-  result = node->IntersectsSphere2(x, y, z, rSquared,
-                             this->ComputeIntersectionsUsingDataBounds);
+  result = node->IntersectsSphere2(x, y, z, rSquared, useDataBounds);
                              
   if (!result) 
     {
@@ -405,14 +414,16 @@ int vtkBSPIntersections::_IntersectsSphere2(vtkKdNode *node, int *ids, int len,
     return 1;
     }
     
-  nnodes1 = _IntersectsSphere2(node->GetLeft(), ids, len, x, y, z, rSquared);
+  nnodes1 = _IntersectsSphere2(node->GetLeft(), ids, len, x, y, z, rSquared,
+                               useDataBounds);
   
   idlist = ids + nnodes1;
   listlen = len - nnodes1;
   
   if (listlen > 0)
     {
-    nnodes2 = _IntersectsSphere2(node->GetRight(), idlist, listlen, x, y, z, rSquared);
+    nnodes2 = _IntersectsSphere2(node->GetRight(), idlist, listlen, x, y, z, rSquared,
+                                 useDataBounds);
     }
   else
     {
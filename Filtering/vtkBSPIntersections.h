@@ -107,6 +107,15 @@ public:
   int IntersectsSphere2(int *ids, int len, 
                         double x, double y, double z, double rSquared);
 
+  // Description:
+  //    Same as above, using the data bounds of the regions if
+  //    useDataBounds is set, whatever ComputeIntersectionsUsingDataBounds
+  //    is.  This can be called from several threads at once once the
+  //    region list is built (by GetNumberOfRegions() for example).
+  int IntersectsSphere2(int *ids, int len, 
+                        double x, double y, double z, double rSquared,
+                        int useDataBounds);
+
   // Description:
   //    Determine whether a region of the spatial decomposition
   //    intersects the given cell.  If you already
@@ -171,7 +180,8 @@ private:
                      double z0, double z1);
 
   int _IntersectsSphere2(vtkKdNode *node, int *ids, int len,
-                         double x, double y, double z, double rSquared);
+                         double x, double y, double z, double rSquared,
+                         int useDataBounds);
 
   int _IntersectsCell(vtkKdNode *node, int *ids, int len,
                       vtkCell *cell, int cellRegion=-1);
@@ -0,0 +1,1105 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkBVHCellLocator.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkBVHCellLocator.h"
+
+#include "vtkCellArray.h"
+#include "vtkDataSet.h"
+#include "vtkDoubleArray.h"
+#include "vtkGenericCell.h"
+#include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
+#include "vtkMultiThreader.h"
+#include "vtkObjectFactory.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+
+#include <vtkstd/algorithm>
+#include <vtkstd/vector>
+
+#include <float.h>
+#include <math.h>
+
+vtkStandardNewMacro(vtkBVHCellLocator);
+
+// The deepest tree, which bounds the traversal stacks.
+#define VTK_BVH_MAX_DEPTH 64
+// Number of bins the surface area heuristic evaluates splits between.
+#define VTK_BVH_BINS 16
+// Number of lines traced together by IntersectWithLines().
+#define VTK_BVH_PACKET_SIZE 8
+// Packets are split in at most this many pieces per thread.
+#define VTK_BVH_PIECES_PER_THREAD 8
+
+//----------------------------------------------------------------------------
+// Round to single precision, down or up, so that the bounds stored in the
+// tree always contain the double precision bounds.
+static inline float vtkBVHRoundDown(double v)
+{
+  float f = static_cast<float>(v);
+  if (f > v)
+    {
+    f -= fabs(f)*FLT_EPSILON + FLT_MIN;
+    }
+  return f;
+}
+
+static inline float vtkBVHRoundUp(double v)
+{
+  float f = static_cast<float>(v);
+  if (f < v)
+    {
+    f += fabs(f)*FLT_EPSILON + FLT_MIN;
+    }
+  return f;
+}
+
+//----------------------------------------------------------------------------
+// Bounds accumulated while building the tree.
+struct vtkBVHBox
+{
+  float Bounds[6];
+
+  void Reset()
+    {
+    this->Bounds[0] = this->Bounds[2] = this->Bounds[4] = VTK_FLOAT_MAX;
+    this->Bounds[1] = this->Bounds[3] = this->Bounds[5] = -VTK_FLOAT_MAX;
+    }
+  void Add(const float b[6])
+    {
+    for (int j = 0; j < 3; j++)
+      {
+      this->Bounds[2*j] = b[2*j] < this->Bounds[2*j] ?
+        b[2*j] : this->Bounds[2*j];
+      this->Bounds[2*j+1] = b[2*j+1] > this->Bounds[2*j+1] ?
+        b[2*j+1] : this->Bounds[2*j+1];
+      }
+    }
+  void Add(const vtkBVHBox &box)
+    {
+    this->Add(box.Bounds);
+    }
+  // Half the surface area, 0 for an empty box.
+  double Area() const
+    {
+    if (this->Bounds[0] > this->Bounds[1])
+      {
+      return 0.0;
+      }
+    double dx = this->Bounds[1] - this->Bounds[0];
+    double dy = this->Bounds[3] - this->Bounds[2];
+    double dz = this->Bounds[5] - this->Bounds[4];
+    return dx*dy + dy*dz + dz*dx;
+    }
+};
+
+//----------------------------------------------------------------------------
+// Builds the tree top down, splitting each node where the surface area
+// heuristic is lowest among VTK_BVH_BINS bins of cell centers per axis.
+class vtkBVHCellLocatorBuilder
+{
+public:
+  const float (*Bounds)[6]; // by cell id
+  vtkIdType *Ids;
+  vtkstd::vector<vtkBVHCellLocator::Node> Nodes;
+  int MaxCellsPerLeaf;
+  int MaxDepth;
+  vtkIdType NumberOfLeaves;
+  int Depth;
+
+  void Build(vtkIdType begin, vtkIdType end, int depth);
+
+  float Center(vtkIdType id, int axis) const
+    {
+    return 0.5f*(this->Bounds[id][2*axis] + this->Bounds[id][2*axis+1]);
+    }
+};
+
+// Partition predicate: is the center of a cell in the first bins.
+class vtkBVHBinPredicate
+{
+public:
+  const vtkBVHCellLocatorBuilder *Builder;
+  int Axis;
+  int LastBin;
+  float Min;
+  float Scale;
+
+  int Bin(vtkIdType id) const
+    {
+    int bin = static_cast<int>(
+      (this->Builder->Center(id, this->Axis) - this->Min)*this->Scale);
+    return bin < 0 ? 0 : (bin >= VTK_BVH_BINS ? VTK_BVH_BINS - 1 : bin);
+    }
+  bool operator()(vtkIdType id) const
+    {
+    return this->Bin(id) <= this->LastBin;
+    }
+};
+
+void vtkBVHCellLocatorBuilder::Build(vtkIdType begin, vtkIdType end,
+                                     int depth)
+{
+  vtkIdType nodeIndex = static_cast<vtkIdType>(this->Nodes.size());
+  this->Nodes.push_back(vtkBVHCellLocator::Node());
+  this->Depth = depth > this->Depth ? depth : this->Depth;
+
+  vtkIdType i, n = end - begin;
+  vtkBVHBox box, centers;
+  box.Reset();
+  centers.Reset();
+  for (i = begin; i < end; i++)
+    {
+    const float *b = this->Bounds[this->Ids[i]];
+    box.Add(b);
+    float c[6];
+    for (int j = 0; j < 3; j++)
+      {
+      c[2*j] = c[2*j+1] = this->Center(this->Ids[i], j);
+      }
+    centers.Add(c);
+    }
+  memcpy(this->Nodes[nodeIndex].Bounds, box.Bounds, sizeof(box.Bounds));
+
+  // Find the split with the lowest cost among the bins of each axis. The
+  // cost of a leaf is its number of cells, the cost of a split one box
+  // test plus the cells of each child weighted by their relative area.
+  double bestCost = VTK_DOUBLE_MAX;
+  vtkBVHBinPredicate split;
+  split.Builder = this;
+  split.Axis = -1;
+  split.LastBin = 0;
+  split.Min = 0.0f;
+  split.Scale = 0.0f;
+  double area = box.Area();
+  for (int axis = 0; n > 1 && depth < this->MaxDepth && axis < 3; axis++)
+    {
+    float min = centers.Bounds[2*axis], max = centers.Bounds[2*axis+1];
+    if (!(max > min))
+      {
+      continue;
+      }
+    vtkBVHBinPredicate bins;
+    bins.Builder = this;
+    bins.Axis = axis;
+    bins.Min = min;
+    bins.Scale = VTK_BVH_BINS/(max - min);
+    vtkIdType counts[VTK_BVH_BINS];
+    vtkBVHBox boxes[VTK_BVH_BINS];
+    int bin;
+    for (bin = 0; bin < VTK_BVH_BINS; bin++)
+      {
+      counts[bin] = 0;
+      boxes[bin].Reset();
+      }
+    for (i = begin; i < end; i++)
+      {
+      bin = bins.Bin(this->Ids[i]);
+      counts[bin]++;
+      boxes[bin].Add(this->Bounds[this->Ids[i]]);
+      }
+    // Sweep from the right, then from the left evaluating each split.
+    double rightCost[VTK_BVH_BINS];
+    vtkBVHBox sweep;
+    sweep.Reset();
+    vtkIdType count = 0;
+    for (bin = VTK_BVH_BINS - 1; bin > 0; bin--)
+      {
+      sweep.Add(boxes[bin]);
+      count += counts[bin];
+      rightCost[bin] = sweep.Area()*count;
+      }
+    sweep.Reset();
+    count = 0;
+    for (bin = 0; bin < VTK_BVH_BINS - 1; bin++)
+      {
+      sweep.Add(boxes[bin]);
+      count += counts[bin];
+      if (count == 0 || count == n)
+        {
+        continue;
+        }
+      double cost = 1.0 + (sweep.Area()*count + rightCost[bin+1])/
+        (area > 0.0 ? area : 1.0);
+      if (cost < bestCost)
+        {
+        bestCost = cost;
+        split = bins;
+        split.LastBin = bin;
+        }
+      }
+    }
+
+  if (n <= this->MaxCellsPerLeaf && bestCost >= n)
+    {
+    split.Axis = -1;
+    }
+  if (split.Axis < 0 && (n > this->MaxCellsPerLeaf && n > 1 &&
+                         depth < this->MaxDepth))
+    {
+    // The centers coincide, or no split separates them: divide the cells
+    // in two halves anyway to respect the number of cells per leaf.
+    split.Axis = 0;
+    split.LastBin = -1;
+    }
+  if (split.Axis < 0)
+    {
+    this->Nodes[nodeIndex].Index = static_cast<int>(begin);
+    this->Nodes[nodeIndex].Count = static_cast<int>(n);
+    this->NumberOfLeaves++;
+    return;
+    }
+
+  vtkIdType mid;
+  if (split.LastBin >= 0)
+    {
+    mid = vtkstd::partition(this->Ids + begin, this->Ids + end, split) -
+      this->Ids;
+    }
+  else
+    {
+    mid = begin + n/2;
+    }
+  this->Build(begin, mid, depth + 1);
+  this->Nodes[nodeIndex].Index = static_cast<int>(this->Nodes.size());
+  this->Nodes[nodeIndex].Count = -split.Axis;
+  this->Build(mid, end, depth + 1);
+}
+
+//----------------------------------------------------------------------------
+// A line traced through the tree.
+struct vtkBVHRay
+{
+  double P1[3];
+  double P2[3];
+  double InvDir[3];
+  int Parallel[3];
+  double T; // parametric coordinate of the closest hit so far
+  double X[3];
+  double PCoords[3];
+  int SubId;
+  vtkIdType CellId;
+
+  void Initialize(const double p1[3], const double p2[3])
+    {
+    for (int j = 0; j < 3; j++)
+      {
+      this->P1[j] = p1[j];
+      this->P2[j] = p2[j];
+      double dir = p2[j] - p1[j];
+      this->Parallel[j] = (dir == 0.0);
+      this->InvDir[j] = this->Parallel[j] ? 0.0 : 1.0/dir;
+      }
+    this->T = VTK_DOUBLE_MAX;
+    this->CellId = -1;
+    }
+
+  // Does the line cross the bounds, expanded by tol, before tmax.
+  int Crosses(const float b[6], double tol, double tmax) const
+    {
+    double tmin = 0.0;
+    for (int j = 0; j < 3; j++)
+      {
+      double lo = b[2*j] - tol, hi = b[2*j+1] + tol;
+      if (this->Parallel[j])
+        {
+        if (this->P1[j] < lo || this->P1[j] > hi)
+          {
+          return 0;
+          }
+        continue;
+        }
+      double t1 = (lo - this->P1[j])*this->InvDir[j];
+      double t2 = (hi - this->P1[j])*this->InvDir[j];
+      if (t1 > t2)
+        {
+        double tmp = t1;
+        t1 = t2;
+        t2 = tmp;
+        }
+      tmin = t1 > tmin ? t1 : tmin;
+      tmax = t2 < tmax ? t2 : tmax;
+      if (tmin > tmax)
+        {
+        return 0;
+        }
+      }
+    return 1;
+    }
+
+  double MaxT() const
+    {
+    return this->T < 1.0 ? this->T : 1.0;
+    }
+};
+
+static inline int vtkBVHOverlaps(const float b[6], const double bounds[6],
+                                 double tol)
+{
+  return b[0] <= bounds[1] + tol && b[1] >= bounds[0] - tol &&
+    b[2] <= bounds[3] + tol && b[3] >= bounds[2] - tol &&
+    b[4] <= bounds[5] + tol && b[5] >= bounds[4] - tol;
+}
+
+static inline double vtkBVHDistance2(const float b[6], const double x[3])
+{
+  double dist2 = 0.0;
+  for (int j = 0; j < 3; j++)
+    {
+    double d = x[j] < b[2*j] ? b[2*j] - x[j] :
+      (x[j] > b[2*j+1] ? x[j] - b[2*j+1] : 0.0);
+    dist2 += d*d;
+    }
+  return dist2;
+}
+
+//----------------------------------------------------------------------------
+// The queries, which only read the tree.
+class vtkBVHCellLocatorTraversal
+{
+public:
+  // Find the first hit of each of n <= VTK_BVH_PACKET_SIZE lines, which
+  // traverse the tree together: a node is visited if any of the lines
+  // still looking for a closer hit crosses it.
+  static void Trace(vtkBVHCellLocator *self, vtkBVHRay *rays, int n,
+                    double tol, vtkGenericCell *cell)
+    {
+    const vtkBVHCellLocator::Node *nodes = self->Nodes;
+    int stack[VTK_BVH_MAX_DEPTH + 2];
+    int size = 0;
+    stack[size++] = 0;
+    while (size)
+      {
+      int index = stack[--size];
+      const vtkBVHCellLocator::Node *node = nodes + index;
+      unsigned int mask = 0;
+      int r, first = -1;
+      for (r = 0; r < n; r++)
+        {
+        if (rays[r].Crosses(node->Bounds, tol, rays[r].MaxT()))
+          {
+          mask |= 1u << r;
+          first = first < 0 ? r : first;
+          }
+        }
+      if (!mask)
+        {
+        continue;
+        }
+      if (node->Count <= 0)
+        {
+        // Visit first the child the first line enters first.
+        int nearChild = index + 1, farChild = node->Index;
+        if (rays[first].InvDir[-node->Count] < 0.0)
+          {
+          nearChild = node->Index;
+          farChild = index + 1;
+          }
+        stack[size++] = farChild;
+        stack[size++] = nearChild;
+        continue;
+        }
+      for (vtkIdType c = node->Index; c < node->Index + node->Count; c++)
+        {
+        const float *b = self->LeafCellBounds[c];
+        int loaded = 0;
+        for (r = 0; r < n; r++)
+          {
+          if (!(mask & (1u << r)) || !rays[r].Crosses(b, tol, rays[r].MaxT()))
+            {
+            continue;
+            }
+          if (!loaded)
+            {
+            self->DataSet->GetCell(self->CellIds[c], cell);
+            loaded = 1;
+            }
+          double t, x[3], pcoords[3];
+          int subId;
+          if (cell->IntersectWithLine(rays[r].P1, rays[r].P2, tol, t, x,
+                                      pcoords, subId) && t < rays[r].T)
+            {
+            vtkBVHRay &ray = rays[r];
+            ray.T = t;
+            ray.CellId = self->CellIds[c];
+            ray.SubId = subId;
+            for (int j = 0; j < 3; j++)
+              {
+              ray.X[j] = x[j];
+              ray.PCoords[j] = pcoords[j];
+              }
+            }
+          }
+        }
+      }
+    }
+};
+
+//----------------------------------------------------------------------------
+// A batch of lines, shared by the threads tracing it.
+struct vtkBVHLineBatch
+{
+  vtkBVHCellLocator *Locator;
+  vtkPoints *P1;
+  vtkPoints *P2;
+  double Tolerance;
+  vtkIdType *CellIds;
+  double *T;
+  vtkPoints *X;
+  int NumberOfPieces;
+  vtkstd::vector<vtkIdType> Hits; // per piece
+};
+
+static VTK_THREAD_RETURN_TYPE vtkBVHCellLocatorTraceLines(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *info =
+    static_cast<vtkMultiThreader::ThreadInfo *>(arg);
+  vtkBVHLineBatch *batch = static_cast<vtkBVHLineBatch *>(info->UserData);
+  vtkGenericCell *cell = vtkGenericCell::New();
+  vtkBVHRay rays[VTK_BVH_PACKET_SIZE];
+  vtkIdType numLines = batch->P1->GetNumberOfPoints();
+  vtkIdType numPackets =
+    (numLines + VTK_BVH_PACKET_SIZE - 1) / VTK_BVH_PACKET_SIZE;
+  for (int piece = info->ThreadID; piece < batch->NumberOfPieces;
+       piece += info->NumberOfThreads)
+    {
+    vtkIdType hits = 0;
+    vtkIdType end = numPackets*(piece + 1)/batch->NumberOfPieces;
+    for (vtkIdType packet = numPackets*piece/batch->NumberOfPieces;
+         packet < end; packet++)
+      {
+      vtkIdType first = packet*VTK_BVH_PACKET_SIZE;
+      int n = static_cast<int>(numLines - first < VTK_BVH_PACKET_SIZE ?
+                               numLines - first : VTK_BVH_PACKET_SIZE);
+      int r;
+      double p1[3], p2[3];
+      for (r = 0; r < n; r++)
+        {
+        batch->P1->GetPoint(first + r, p1);
+        batch->P2->GetPoint(first + r, p2);
+        rays[r].Initialize(p1, p2);
+        }
+      vtkBVHCellLocatorTraversal::Trace(batch->Locator, rays, n,
+                                        batch->Tolerance, cell);
+      for (r = 0; r < n; r++)
+        {
+        vtkBVHRay &ray = rays[r];
+        batch->CellIds[first + r] = ray.CellId;
+        if (ray.CellId >= 0)
+          {
+          hits++;
+          }
+        if (batch->T)
+          {
+          batch->T[first + r] = ray.CellId >= 0 ? ray.T : VTK_DOUBLE_MAX;
+          }
+        if (batch->X)
+          {
+          if (ray.CellId < 0)
+            {
+            ray.X[0] = ray.X[1] = ray.X[2] = 0.0;
+            }
+          batch->X->SetPoint(first + r, ray.X);
+          }
+        }
+      }
+    batch->Hits[piece] = hits;
+    }
+  cell->Delete();
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+vtkBVHCellLocator::vtkBVHCellLocator()
+{
+  this->NumberOfCellsPerNode = 8;
+  this->MaxLevel = VTK_BVH_MAX_DEPTH;
+  this->NumberOfThreads = 1;
+  this->MaxCellSize = 0;
+  this->NumberOfCells = 0;
+  this->NumberOfNodes = 0;
+  this->NumberOfLeaves = 0;
+  this->Nodes = NULL;
+  this->CellIds = NULL;
+  this->LeafCellBounds = NULL;
+}
+
+//----------------------------------------------------------------------------
+vtkBVHCellLocator::~vtkBVHCellLocator()
+{
+  this->FreeSearchStructure();
+}
+
+//----------------------------------------------------------------------------
+void vtkBVHCellLocator::FreeSearchStructure()
+{
+  delete [] this->Nodes;
+  this->Nodes = NULL;
+  delete [] this->CellIds;
+  this->CellIds = NULL;
+  delete [] this->LeafCellBounds;
+  this->LeafCellBounds = NULL;
+  this->NumberOfCells = 0;
+  this->NumberOfNodes = 0;
+  this->NumberOfLeaves = 0;
+  this->Level = 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkBVHCellLocator::BuildLocator()
+{
+  if (this->LazyEvaluation)
+    {
+    return;
+    }
+  this->ForceBuildLocator();
+}
+
+//----------------------------------------------------------------------------
+void vtkBVHCellLocator::BuildLocatorIfNeeded()
+{
+  if (this->LazyEvaluation)
+    {
+    if (!this->Nodes || this->MTime > this->BuildTime)
+      {
+      this->Modified();
+      vtkDebugMacro(<< "Forcing BuildLocator");
+      this->ForceBuildLocator();
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkBVHCellLocator::ForceBuildLocator()
+{
+  // don't rebuild if build time is newer than modified and dataset
+  // modified time, including its cell arrays
+  if (this->Nodes && this->BuildTime > this->MTime &&
+      this->BuildTime > this->DataSet->GetMTime() &&
+      this->BuildTime > this->GetDataSetTopologyMTime())
+    {
+    return;
+    }
+  // don't rebuild if UseExistingSearchStructure is ON and a tree
+  // structure already exists
+  if (this->Nodes && this->UseExistingSearchStructure)
+    {
+    this->BuildTime.Modified();
+    vtkDebugMacro(<< "BuildLocator exited - UseExistingSearchStructure");
+    return;
+    }
+  // only refit when the points moved, the same dataset keeping its cells
+  if (this->Nodes && this->RefitSearchStructure &&
+      this->BuildTime > this->MTime &&
+      this->DataSet->GetNumberOfCells() == this->NumberOfCells &&
+      this->BuildTime > this->GetDataSetTopologyMTime())
+    {
+    this->RefitLocatorInternal();
+    return;
+    }
+  this->BuildLocatorInternal();
+}
+
+//----------------------------------------------------------------------------
+void vtkBVHCellLocator::BuildLocatorInternal()
+{
+  this->FreeSearchStructure();
+
+  vtkIdType numCells;
+  if (!this->DataSet || (numCells = this->DataSet->GetNumberOfCells()) < 1)
+    {
+    vtkErrorMacro(<< "No cells to subdivide");
+    return;
+    }
+  vtkDebugMacro(<< "Building BVH for " << numCells << " cells");
+
+  // The bounds of the cells by cell id, rounded outwards.
+  float (*bounds)[6] = new float[numCells][6];
+  vtkIdType i;
+  double b[6];
+  for (i = 0; i < numCells; i++)
+    {
+    this->DataSet->GetCellBounds(i, b);
+    for (int j = 0; j < 3; j++)
+      {
+      bounds[i][2*j] = vtkBVHRoundDown(b[2*j]);
+      bounds[i][2*j+1] = vtkBVHRoundUp(b[2*j+1]);
+      }
+    }
+  this->MaxCellSize = this->DataSet->GetMaxCellSize();
+
+  vtkBVHCellLocatorBuilder builder;
+  builder.Bounds = bounds;
+  builder.Ids = new vtkIdType[numCells];
+  for (i = 0; i < numCells; i++)
+    {
+    builder.Ids[i] = i;
+    }
+  builder.MaxCellsPerLeaf = this->NumberOfCellsPerNode;
+  builder.MaxDepth = this->MaxLevel < VTK_BVH_MAX_DEPTH ?
+    this->MaxLevel : VTK_BVH_MAX_DEPTH;
+  builder.NumberOfLeaves = 0;
+  builder.Depth = 0;
+  builder.Nodes.reserve(2*numCells/this->NumberOfCellsPerNode + 1);
+  builder.Build(0, numCells, 0);
+
+  this->NumberOfCells = numCells;
+  this->NumberOfNodes = static_cast<vtkIdType>(builder.Nodes.size());
+  this->NumberOfLeaves = builder.NumberOfLeaves;
+  this->Level = builder.Depth;
+  this->Nodes = new Node[this->NumberOfNodes];
+  memcpy(this->Nodes, &builder.Nodes[0], this->NumberOfNodes*sizeof(Node));
+  this->CellIds = builder.Ids;
+  this->LeafCellBounds = new float[numCells][6];
+  for (i = 0; i < numCells; i++)
+    {
+    memcpy(this->LeafCellBounds[i], bounds[this->CellIds[i]],
+           sizeof(this->LeafCellBounds[i]));
+    }
+  delete [] bounds;
+
+  this->BuildTime.Modified();
+  vtkDebugMacro(<< "BVH with " << this->NumberOfNodes << " nodes, "
+                << this->NumberOfLeaves << " leaves, depth " << this->Level);
+}
+
+//----------------------------------------------------------------------------
+void vtkBVHCellLocator::RefitLocatorInternal()
+{
+  vtkDebugMacro(<< "Refitting BVH for " << this->NumberOfCells << " cells");
+  vtkIdType i;
+  double b[6];
+  for (i = 0; i < this->NumberOfCells; i++)
+    {
+    this->DataSet->GetCellBounds(this->CellIds[i], b);
+    for (int j = 0; j < 3; j++)
+      {
+      this->LeafCellBounds[i][2*j] = vtkBVHRoundDown(b[2*j]);
+      this->LeafCellBounds[i][2*j+1] = vtkBVHRoundUp(b[2*j+1]);
+      }
+    }
+
+  // Children are stored after their parent, so a backward sweep visits
+  // them first.
+  vtkBVHBox box;
+  for (i = this->NumberOfNodes - 1; i >= 0; i--)
+    {
+    Node *node = this->Nodes + i;
+    box.Reset();
+    if (node->Count > 0)
+      {
+      for (vtkIdType c = node->Index; c < node->Index + node->Count; c++)
+        {
+        box.Add(this->LeafCellBounds[c]);
+        }
+      }
+    else
+      {
+      box.Add(this->Nodes[i + 1].Bounds);
+      box.Add(this->Nodes[node->Index].Bounds);
+      }
+    memcpy(node->Bounds, box.Bounds, sizeof(node->Bounds));
+    }
+
+  this->BuildTime.Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkBVHCellLocator::IntersectWithLine(
+  double p1[3], double p2[3], double tol, double& t, double x[3],
+  double pcoords[3], int &subId, vtkIdType &cellId, vtkGenericCell *cell)
+{
+  this->BuildLocatorIfNeeded();
+  cellId = -1;
+  if (!this->Nodes)
+    {
+    return 0;
+    }
+  vtkBVHRay ray;
+  ray.Initialize(p1, p2);
+  vtkBVHCellLocatorTraversal::Trace(this, &ray, 1, tol, cell);
+  if (ray.CellId < 0)
+    {
+    return 0;
+    }
+  t = ray.T;
+  subId = ray.SubId;
+  cellId = ray.CellId;
+  for (int j = 0; j < 3; j++)
+    {
+    x[j] = ray.X[j];
+    pcoords[j] = ray.PCoords[j];
+    }
+  this->DataSet->GetCell(cellId, cell);
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkBVHCellLocator::IntersectWithLines(vtkPoints *p1, vtkPoints *p2,
+                                                double tol,
+                                                vtkIdTypeArray *cellIds,
+                                                vtkDoubleArray *t,
+                                                vtkPoints *x)
+{
+  vtkIdType numLines = p1->GetNumberOfPoints();
+  if (p2->GetNumberOfPoints() != numLines)
+    {
+    vtkErrorMacro(<< "The lines have " << numLines << " start points and "
+                  << p2->GetNumberOfPoints() << " end points.");
+    return 0;
+    }
+  cellIds->SetNumberOfComponents(1);
+  cellIds->SetNumberOfTuples(numLines);
+  if (t)
+    {
+    t->SetNumberOfComponents(1);
+    t->SetNumberOfTuples(numLines);
+    }
+  if (x)
+    {
+    x->SetNumberOfPoints(numLines);
+    }
+
+  this->BuildLocatorIfNeeded();
+  if (!this->Nodes)
+    {
+    cellIds->FillComponent(0, -1);
+    if (t)
+      {
+      t->FillComponent(0, VTK_DOUBLE_MAX);
+      }
+    return 0;
+    }
+
+  vtkBVHLineBatch batch;
+  batch.Locator = this;
+  batch.P1 = p1;
+  batch.P2 = p2;
+  batch.Tolerance = tol;
+  batch.CellIds = cellIds->GetPointer(0);
+  batch.T = t ? t->GetPointer(0) : 0;
+  batch.X = x;
+  vtkIdType numPackets =
+    (numLines + VTK_BVH_PACKET_SIZE - 1) / VTK_BVH_PACKET_SIZE;
+  vtkIdType pieces = this->NumberOfThreads*VTK_BVH_PIECES_PER_THREAD;
+  batch.NumberOfPieces = static_cast<int>(
+    numPackets < pieces ? numPackets : pieces);
+  if (this->NumberOfThreads < 2 || batch.NumberOfPieces < 2)
+    {
+    batch.NumberOfPieces = 1;
+    }
+  batch.Hits.resize(batch.NumberOfPieces, 0);
+
+  if (batch.NumberOfPieces == 1)
+    {
+    vtkMultiThreader::ThreadInfo info;
+    info.ThreadID = 0;
+    info.NumberOfThreads = 1;
+    info.UserData = &batch;
+    vtkBVHCellLocatorTraceLines(&info);
+    }
+  else
+    {
+    vtkMultiThreader *threader = vtkMultiThreader::New();
+    threader->UseThreadPoolOn();
+    threader->SetNumberOfThreads(this->NumberOfThreads);
+    threader->SetNumberOfPieces(batch.NumberOfPieces);
+    threader->SetSingleMethod(vtkBVHCellLocatorTraceLines, &batch);
+    threader->SingleMethodExecute();
+    threader->Delete();
+    }
+
+  vtkIdType hits = 0;
+  for (int piece = 0; piece < batch.NumberOfPieces; piece++)
+    {
+    hits += batch.Hits[piece];
+    }
+  return hits;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkBVHCellLocator::FindClosestPointWithinRadius(
+  double x[3], double radius, double closestPoint[3], vtkGenericCell *cell,
+  vtkIdType &cellId, int &subId, double& dist2, int &inside)
+{
+  this->BuildLocatorIfNeeded();
+  cellId = -1;
+  if (!this->Nodes)
+    {
+    return 0;
+    }
+
+  double best = radius < sqrt(VTK_DOUBLE_MAX) ? radius*radius :
+    VTK_DOUBLE_MAX;
+  vtkstd::vector<double> weights(this->MaxCellSize > 0 ?
+                                 this->MaxCellSize : 1);
+  double point[3], pcoords[3], d2;
+  int sub;
+
+  // Visit the nodes nearest first, skipping those farther than the
+  // closest point found so far.
+  int stack[VTK_BVH_MAX_DEPTH + 2];
+  double stackDist2[VTK_BVH_MAX_DEPTH + 2];
+  int size = 0;
+  stack[size] = 0;
+  stackDist2[size++] = vtkBVHDistance2(this->Nodes[0].Bounds, x);
+  while (size)
+    {
+    size--;
+    int index = stack[size];
+    if (stackDist2[size] > best)
+      {
+      continue;
+      }
+    const Node *node = this->Nodes + index;
+    if (node->Count <= 0)
+      {
+      int children[2] = {index + 1, node->Index};
+      double d[2] = {vtkBVHDistance2(this->Nodes[children[0]].Bounds, x),
+                     vtkBVHDistance2(this->Nodes[children[1]].Bounds, x)};
+      int nearChild = d[1] < d[0] ? 1 : 0;
+      stack[size] = children[1 - nearChild];
+      stackDist2[size++] = d[1 - nearChild];
+      stack[size] = children[nearChild];
+      stackDist2[size++] = d[nearChild];
+      continue;
+      }
+    for (vtkIdType c = node->Index; c < node->Index + node->Count; c++)
+      {
+      if (vtkBVHDistance2(this->LeafCellBounds[c], x) > best)
+        {
+        continue;
+        }
+      this->DataSet->GetCell(this->CellIds[c], cell);
+      int result = cell->EvaluatePosition(x, point, sub, pcoords, d2,
+                                          &weights[0]);
+      if (result != -1 && (d2 < best || (cellId < 0 && d2 <= best)))
+        {
+        best = d2;
+        cellId = this->CellIds[c];
+        subId = sub;
+        inside = result;
+        closestPoint[0] = point[0];
+        closestPoint[1] = point[1];
+        closestPoint[2] = point[2];
+        }
+      }
+    }
+
+  if (cellId < 0)
+    {
+    return 0;
+    }
+  dist2 = best;
+  this->DataSet->GetCell(cellId, cell);
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkBVHCellLocator::FindClosestPoint(
+  double x[3], double closestPoint[3], vtkGenericCell *cell,
+  vtkIdType &cellId, int &subId, double& dist2)
+{
+  int inside;
+  if (!this->FindClosestPointWithinRadius(x, VTK_DOUBLE_MAX, closestPoint,
+                                          cell, cellId, subId, dist2, inside))
+    {
+    cellId = -1;
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkBVHCellLocator::FindCellsWithinBounds(double *bbox, vtkIdList *cells)
+{
+  this->BuildLocatorIfNeeded();
+  cells->Reset();
+  if (!this->Nodes)
+    {
+    return;
+    }
+  int stack[VTK_BVH_MAX_DEPTH + 2];
+  int size = 0;
+  stack[size++] = 0;
+  while (size)
+    {
+    int index = stack[--size];
+    const Node *node = this->Nodes + index;
+    if (!vtkBVHOverlaps(node->Bounds, bbox, 0.0))
+      {
+      continue;
+      }
+    if (node->Count <= 0)
+      {
+      stack[size++] = node->Index;
+      stack[size++] = index + 1;
+      continue;
+      }
+    for (vtkIdType c = node->Index; c < node->Index + node->Count; c++)
+      {
+      if (vtkBVHOverlaps(this->LeafCellBounds[c], bbox, 0.0))
+        {
+        cells->InsertNextId(this->CellIds[c]);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkBVHCellLocator::FindCellsAlongLine(double p1[3], double p2[3],
+                                           double tolerance,
+                                           vtkIdList *cells)
+{
+  this->BuildLocatorIfNeeded();
+  cells->Reset();
+  if (!this->Nodes)
+    {
+    return;
+    }
+  vtkBVHRay ray;
+  ray.Initialize(p1, p2);
+  int stack[VTK_BVH_MAX_DEPTH + 2];
+  int size = 0;
+  stack[size++] = 0;
+  while (size)
+    {
+    int index = stack[--size];
+    const Node *node = this->Nodes + index;
+    if (!ray.Crosses(node->Bounds, tolerance, 1.0))
+      {
+      continue;
+      }
+    if (node->Count <= 0)
+      {
+      stack[size++] = node->Index;
+      stack[size++] = index + 1;
+      continue;
+      }
+    for (vtkIdType c = node->Index; c < node->Index + node->Count; c++)
+      {
+      if (ray.Crosses(this->LeafCellBounds[c], tolerance, 1.0))
+        {
+        cells->InsertNextId(this->CellIds[c]);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkBVHCellLocator::FindCell(double x[3], double tol2,
+                                      vtkGenericCell *cell,
+                                      double pcoords[3], double *weights)
+{
+  this->BuildLocatorIfNeeded();
+  if (!this->Nodes)
+    {
+    return -1;
+    }
+  double tol = sqrt(tol2), bbox[6] = {x[0], x[0], x[1], x[1], x[2], x[2]};
+  double closestPoint[3], dist2;
+  int subId;
+  int stack[VTK_BVH_MAX_DEPTH + 2];
+  int size = 0;
+  stack[size++] = 0;
+  while (size)
+    {
+    int index = stack[--size];
+    const Node *node = this->Nodes + index;
+    if (!vtkBVHOverlaps(node->Bounds, bbox, tol))
+      {
+      continue;
+      }
+    if (node->Count <= 0)
+      {
+      stack[size++] = node->Index;
+      stack[size++] = index + 1;
+      continue;
+      }
+    for (vtkIdType c = node->Index; c < node->Index + node->Count; c++)
+      {
+      if (!vtkBVHOverlaps(this->LeafCellBounds[c], bbox, tol))
+        {
+        continue;
+        }
+      this->DataSet->GetCell(this->CellIds[c], cell);
+      if (cell->EvaluatePosition(x, closestPoint, subId, pcoords, dist2,
+                                 weights) == 1 && dist2 <= tol2)
+        {
+        return this->CellIds[c];
+        }
+      }
+    }
+  return -1;
+}
+
+//----------------------------------------------------------------------------
+void vtkBVHCellLocator::GenerateRepresentation(int level, vtkPolyData *pd)
+{
+  this->BuildLocatorIfNeeded();
+  if (!this->Nodes)
+    {
+    vtkErrorMacro(<<"No tree to generate representation from");
+    return;
+    }
+
+  vtkPoints *pts = vtkPoints::New();
+  vtkCellArray *polys = vtkCellArray::New();
+  static const int faces[6][4] = {{0,2,6,4}, {1,5,7,3}, {0,4,5,1},
+                                  {2,3,7,6}, {0,1,3,2}, {4,6,7,5}};
+  int stack[VTK_BVH_MAX_DEPTH + 2], depths[VTK_BVH_MAX_DEPTH + 2];
+  int size = 0;
+  stack[size] = 0;
+  depths[size++] = 0;
+  while (size)
+    {
+    size--;
+    int index = stack[size], depth = depths[size];
+    const Node *node = this->Nodes + index;
+    if (node->Count <= 0 && (level < 0 || depth < level))
+      {
+      stack[size] = node->Index;
+      depths[size++] = depth + 1;
+      stack[size] = index + 1;
+      depths[size++] = depth + 1;
+      continue;
+      }
+    vtkIdType ids[8];
+    for (int corner = 0; corner < 8; corner++)
+      {
+      ids[corner] = pts->InsertNextPoint(node->Bounds[corner & 1],
+                                         node->Bounds[2 + ((corner >> 1) & 1)],
+                                         node->Bounds[4 + ((corner >> 2) & 1)]);
+      }
+    for (int face = 0; face < 6; face++)
+      {
+      vtkIdType quad[4] = {ids[faces[face][0]], ids[faces[face][1]],
+                           ids[faces[face][2]], ids[faces[face][3]]};
+      polys->InsertNextCell(4, quad);
+      }
+    }
+
+  pd->SetPoints(pts);
+  pts->Delete();
+  pd->SetPolys(polys);
+  polys->Delete();
+  pd->Squeeze();
+}
+
+//----------------------------------------------------------------------------
+void vtkBVHCellLocator::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << "\n";
+  os << indent << "NumberOfNodes: " << this->NumberOfNodes << "\n";
+  os << indent << "NumberOfLeaves: " << this->NumberOfLeaves << "\n";
+}
@@ -0,0 +1,190 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkBVHCellLocator.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkBVHCellLocator - bounding volume hierarchy for ray casting cells
+// .SECTION Description
+// vtkBVHCellLocator is a cell locator built as a binary tree of axis
+// aligned bounding boxes (a bounding volume hierarchy). Each cell lies in
+// exactly one leaf, and each node is shrunk to the bounds of its cells.
+// Nodes are split where the surface area heuristic estimates that a ray
+// tests the fewest boxes and cells, which gives much tighter trees than
+// median splits on meshes of uneven density.
+//
+// The tree is stored in one array of 32 byte nodes in depth first order,
+// with single precision bounds rounded outwards, and the cells of each
+// leaf are stored contiguously together with their bounds. It is
+// intended for many IntersectWithLine() queries, such as picking and line
+// of sight tests on large surfaces. IntersectWithLines() traces batches of
+// lines, in packets of neighboring lines that traverse the tree together,
+// on several threads.
+//
+// With RefitSearchStructure on, BuildLocator() after the points of the
+// dataset have moved, its cells being unchanged, keeps the tree and only
+// recomputes the bounds of its cells and nodes. This is much faster than a
+// rebuild for deforming meshes, though the tree gets less efficient as the
+// cells move away from where it was built.
+//
+// NumberOfCellsPerNode is the largest number of cells in a leaf. Leaves
+// usually hold fewer cells, where the heuristic finds a split worthwhile.
+// MaxLevel is the largest depth of the tree, at most 64.
+//
+// .SECTION See Also
+// vtkAbstractCellLocator vtkModifiedBSPTree vtkCellLocator
+
+#ifndef __vtkBVHCellLocator_h
+#define __vtkBVHCellLocator_h
+
+#include "vtkAbstractCellLocator.h"
+
+class vtkDoubleArray;
+class vtkIdTypeArray;
+
+class VTK_FILTERING_EXPORT vtkBVHCellLocator : public vtkAbstractCellLocator
+{
+public:
+  vtkTypeMacro(vtkBVHCellLocator,vtkAbstractCellLocator);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  // Description:
+  // Construct with at most 8 cells per leaf.
+  static vtkBVHCellLocator *New();
+
+//BTX
+  using vtkAbstractCellLocator::IntersectWithLine;
+  using vtkAbstractCellLocator::FindClosestPoint;
+  using vtkAbstractCellLocator::FindClosestPointWithinRadius;
+//ETX
+
+  // Description:
+  // Return the first intersection (closest to p1) of the finite line
+  // from p1 to p2 with the cells, with its parametric coordinate t, the
+  // cell that was hit as a cell id and as a generic cell. This method is
+  // thread safe once the locator is built, as long as each thread passes
+  // its own cell.
+  virtual int IntersectWithLine(
+    double p1[3], double p2[3], double tol, double& t, double x[3],
+    double pcoords[3], int &subId, vtkIdType &cellId, vtkGenericCell *cell);
+
+  // Description:
+  // Intersect a batch of finite lines with the cells, each from a point
+  // of p1 to the point with the same id in p2. For each line, cellIds
+  // gets the id of the first cell hit or -1, t (if not NULL) the
+  // parametric coordinate of the hit along the line, and x (if not NULL)
+  // the hit point. Consecutive lines are traced together in packets, so
+  // lines that are close to each other, such as the rays through
+  // neighboring pixels, should be consecutive. The packets are divided
+  // among NumberOfThreads threads. Returns the number of lines that hit a
+  // cell.
+  virtual vtkIdType IntersectWithLines(vtkPoints *p1, vtkPoints *p2,
+                                       double tol, vtkIdTypeArray *cellIds,
+                                       vtkDoubleArray *t = 0,
+                                       vtkPoints *x = 0);
+
+  // Description:
+  // Return the closest point within a specified radius and the cell
+  // which is closest to the point x. See vtkAbstractCellLocator.
+  virtual vtkIdType FindClosestPointWithinRadius(
+    double x[3], double radius, double closestPoint[3],
+    vtkGenericCell *cell, vtkIdType &cellId, int &subId, double& dist2,
+    int &inside);
+
+  // Description:
+  // Return the closest point and the cell which is closest to the point
+  // x. See vtkAbstractCellLocator.
+  virtual void FindClosestPoint(
+    double x[3], double closestPoint[3], vtkGenericCell *cell,
+    vtkIdType &cellId, int &subId, double& dist2);
+
+  // Description:
+  // Return the ids of the cells whose bounds overlap the given bounds.
+  virtual void FindCellsWithinBounds(double *bbox, vtkIdList *cells);
+
+  // Description:
+  // Return the ids of the cells whose bounds, expanded by tolerance,
+  // overlap the finite line from p1 to p2.
+  virtual void FindCellsAlongLine(
+    double p1[3], double p2[3], double tolerance, vtkIdList *cells);
+
+  // Description:
+  // Return the id of the cell containing x, or -1. See
+  // vtkAbstractCellLocator.
+  virtual vtkIdType FindCell(double x[3])
+    { return this->Superclass::FindCell(x); }
+  virtual vtkIdType FindCell(
+    double x[3], double tol2, vtkGenericCell *GenCell,
+    double pcoords[3], double *weights);
+
+  // Description:
+  // Specify the number of threads IntersectWithLines() uses. Defaults to 1.
+  vtkSetClampMacro(NumberOfThreads, int, 1, VTK_LARGE_INTEGER);
+  vtkGetMacro(NumberOfThreads, int);
+
+  // Description:
+  // Return the number of nodes and leaves of the tree.
+  vtkIdType GetNumberOfNodes() { return this->NumberOfNodes; }
+  vtkIdType GetNumberOfLeaves() { return this->NumberOfLeaves; }
+
+  // Description:
+  // Satisfy vtkLocator abstract interface. GenerateRepresentation()
+  // outputs the boxes of the nodes at the given depth, and of the leaves
+  // above it. A negative level outputs the boxes of all the leaves.
+  void FreeSearchStructure();
+  void BuildLocator();
+  void GenerateRepresentation(int level, vtkPolyData *pd);
+
+//BTX
+  // Description:
+  // A node of the tree. Count > 0 for a leaf, which holds the Count cells
+  // from Index in the cell arrays. Otherwise the node splits along axis
+  // -Count, its first child follows it and Index is its second child.
+  struct Node
+  {
+    float Bounds[6];
+    int Index;
+    int Count;
+  };
+//ETX
+
+protected:
+  vtkBVHCellLocator();
+  ~vtkBVHCellLocator();
+
+  void BuildLocatorIfNeeded();
+  void ForceBuildLocator();
+  void BuildLocatorInternal();
+
+  // Description:
+  // Recompute the bounds of the cells and of the nodes of the existing
+  // tree, bottom up.
+  void RefitLocatorInternal();
+
+  int NumberOfThreads;
+  int MaxCellSize;
+  vtkIdType NumberOfCells;
+  vtkIdType NumberOfNodes;
+  vtkIdType NumberOfLeaves;
+//BTX
+  Node *Nodes;
+  vtkIdType *CellIds; // ids of the cells, in leaf order
+  float (*LeafCellBounds)[6]; // bounds of the cells, in leaf order
+
+  friend class vtkBVHCellLocatorTraversal;
+//ETX
+
+private:
+  vtkBVHCellLocator(const vtkBVHCellLocator&);  // Not implemented.
+  void operator=(const vtkBVHCellLocator&);  // Not implemented.
+};
+
+#endif
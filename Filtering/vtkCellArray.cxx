@@ -13,10 +13,143 @@
 
 =========================================================================*/
 #include "vtkCellArray.h"
+#include "vtkIntArray.h"
 #include "vtkObjectFactory.h"
 
 vtkStandardNewMacro(vtkCellArray);
 
+//----------------------------------------------------------------------------
+// Build the offsets and connectivity arrays from a legacy cell list.
+// Returns 0 if a value does not fit in the index type.
+template <class T>
+static int vtkCellArrayFromLegacy(vtkIdTypeArray *ia,
+                                  vtkDataArrayTemplate<T> *offsets,
+                                  vtkDataArrayTemplate<T> *connectivity,
+                                  vtkIdType &numCells)
+{
+  const vtkIdType *list = ia->GetPointer(0);
+  vtkIdType size = ia->GetMaxId() + 1;
+  vtkIdType loc, i;
+
+  numCells = 0;
+  for (loc = 0; loc < size; loc += list[loc] + 1)
+    {
+    numCells++;
+    }
+  T *o = offsets->WritePointer(0, numCells + 1);
+  T *c = connectivity->WritePointer(0, size - numCells);
+  vtkIdType offset = 0;
+  *o++ = 0;
+  for (loc = 0; loc < size; )
+    {
+    vtkIdType npts = list[loc++];
+    for (i = 0; i < npts; i++)
+      {
+      T id = static_cast<T>(list[loc]);
+      if (static_cast<vtkIdType>(id) != list[loc++])
+        {
+        return 0;
+        }
+      c[offset++] = id;
+      }
+    *o = static_cast<T>(offset);
+    if (static_cast<vtkIdType>(*o++) != offset)
+      {
+      return 0;
+      }
+    }
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+// Build a legacy cell list from the offsets and connectivity arrays.
+template <class T>
+static void vtkCellArrayToLegacy(vtkDataArrayTemplate<T> *offsets,
+                                 vtkDataArrayTemplate<T> *connectivity,
+                                 vtkIdType numCells, vtkIdTypeArray *ia)
+{
+  const T *o = offsets->GetPointer(0);
+  const T *c = connectivity->GetPointer(0);
+  vtkIdType *list = ia->WritePointer(0, numCells + o[numCells]);
+  for (vtkIdType cellId = 0; cellId < numCells; cellId++)
+    {
+    vtkIdType start = static_cast<vtkIdType>(o[cellId]);
+    vtkIdType end = static_cast<vtkIdType>(o[cellId+1]);
+    *list++ = end - start;
+    for (vtkIdType i = start; i < end; i++)
+      {
+      *list++ = static_cast<vtkIdType>(c[i]);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+static void vtkCellArrayInsertNextCell(vtkDataArrayTemplate<T> *offsets,
+                                       vtkDataArrayTemplate<T> *connectivity,
+                                       vtkIdType npts, const vtkIdType *pts)
+{
+  vtkIdType start = connectivity->GetMaxId() + 1;
+  T *c = connectivity->WritePointer(start, npts);
+  for (vtkIdType i = 0; i < npts; i++)
+    {
+    c[i] = static_cast<T>(pts[i]);
+    }
+  offsets->InsertNextValue(static_cast<T>(start + npts));
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+static void vtkCellArrayGetCellAtId(vtkDataArrayTemplate<T> *offsets,
+                                    vtkDataArrayTemplate<T> *connectivity,
+                                    vtkIdType cellId, vtkIdType npts,
+                                    vtkIdType *pts)
+{
+  const T *c = connectivity->GetPointer(offsets->GetValue(cellId));
+  for (vtkIdType i = 0; i < npts; i++)
+    {
+    pts[i] = static_cast<vtkIdType>(c[i]);
+    }
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+static void vtkCellArrayReverseCell(vtkDataArrayTemplate<T> *offsets,
+                                    vtkDataArrayTemplate<T> *connectivity,
+                                    vtkIdType cellId)
+{
+  T *first = connectivity->GetPointer(offsets->GetValue(cellId));
+  T *last = connectivity->GetPointer(offsets->GetValue(cellId+1)) - 1;
+  for (; first < last; ++first, --last)
+    {
+    T tmp = *first;
+    *first = *last;
+    *last = tmp;
+    }
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+static void vtkCellArrayReplaceCell(vtkDataArrayTemplate<T> *offsets,
+                                    vtkDataArrayTemplate<T> *connectivity,
+                                    vtkIdType cellId, int npts,
+                                    const vtkIdType *pts)
+{
+  T *c = connectivity->GetPointer(offsets->GetValue(cellId));
+  for (int i = 0; i < npts; i++)
+    {
+    c[i] = static_cast<T>(pts[i]);
+    }
+}
+
+// Typed access to the arrays of the offsets layouts.
+#define vtkCellArrayOffsets32(ca) static_cast<vtkIntArray *>((ca)->Offsets)
+#define vtkCellArrayConnectivity32(ca) \
+  static_cast<vtkIntArray *>((ca)->Connectivity)
+#define vtkCellArrayOffsets64(ca) static_cast<vtkIdTypeArray *>((ca)->Offsets)
+#define vtkCellArrayConnectivity64(ca) \
+  static_cast<vtkIdTypeArray *>((ca)->Connectivity)
+
 //----------------------------------------------------------------------------
 vtkCellArray::vtkCellArray()
 {
@@ -24,6 +157,10 @@ vtkCellArray::vtkCellArray()
   this->NumberOfCells = 0;
   this->InsertLocation = 0;
   this->TraversalLocation = 0;
+  this->Layout = VTK_CELL_ARRAY_LEGACY;
+  this->Offsets = NULL;
+  this->Connectivity = NULL;
+  this->ConnectivityIds = NULL;
 }
 
 //----------------------------------------------------------------------------
@@ -35,7 +172,21 @@ void vtkCellArray::DeepCopy (vtkCellArray *ca)
     return;
     }
 
-  this->Ia->DeepCopy(ca->Ia);
+  this->ReleaseOffsets();
+  if (ca->Connectivity)
+    {
+    this->Layout = ca->Layout;
+    this->Offsets = ca->Offsets->NewInstance();
+    this->Connectivity = ca->Connectivity->NewInstance();
+    this->SetAllocator(this->Ia->GetAllocator());
+    this->Offsets->DeepCopy(ca->Offsets);
+    this->Connectivity->DeepCopy(ca->Connectivity);
+    this->Ia->Initialize();
+    }
+  else
+    {
+    this->Ia->DeepCopy(ca->Ia);
+    }
   this->NumberOfCells = ca->NumberOfCells;
   this->InsertLocation = ca->InsertLocation;
   this->TraversalLocation = ca->TraversalLocation;
@@ -44,6 +195,7 @@ void vtkCellArray::DeepCopy (vtkCellArray *ca)
 //----------------------------------------------------------------------------
 vtkCellArray::~vtkCellArray()
 {
+  this->ReleaseOffsets();
   this->Ia->Delete();
 }
 
@@ -51,6 +203,12 @@ vtkCellArray::~vtkCellArray()
 void vtkCellArray::Initialize()
 {
   this->Ia->Initialize();
+  if (this->Connectivity)
+    {
+    this->Offsets->Initialize();
+    this->Connectivity->Initialize();
+    this->ResetOffsets();
+    }
   this->NumberOfCells = 0;
   this->InsertLocation = 0;
   this->TraversalLocation = 0;
@@ -63,6 +221,18 @@ int vtkCellArray::GetMaxCellSize()
 {
   int i, npts=0, maxSize=0;
 
+  if (this->Connectivity)
+    {
+    for (vtkIdType cellId = 0; cellId < this->NumberOfCells; cellId++)
+      {
+      if ( (npts=static_cast<int>(this->GetCellSize(cellId))) > maxSize )
+        {
+        maxSize = npts;
+        }
+      }
+    return maxSize;
+    }
+
   for (i=0; i<this->Ia->GetMaxId(); i+=(npts+1))
     {
     if ( (npts=this->Ia->GetValue(i)) > maxSize )
@@ -80,6 +250,7 @@ void vtkCellArray::SetCells(vtkIdType ncells, vtkIdTypeArray *cells)
   if ( cells && cells != this->Ia )
     {
     this->Modified();
+    this->ReleaseOffsets();
     this->Ia->Delete();
     this->Ia = cells;
     this->Ia->Register(this);
@@ -93,12 +264,31 @@ void vtkCellArray::SetCells(vtkIdType ncells, vtkIdTypeArray *cells)
 //----------------------------------------------------------------------------
 unsigned long vtkCellArray::GetActualMemorySize()
 {
-  return this->Ia->GetActualMemorySize();
+  unsigned long size = this->Ia->GetActualMemorySize();
+  if (this->Connectivity)
+    {
+    size += this->Offsets->GetActualMemorySize() +
+      this->Connectivity->GetActualMemorySize();
+    }
+  if (this->ConnectivityIds)
+    {
+    size += this->ConnectivityIds->GetActualMemorySize();
+    }
+  return size;
 }
 
 //----------------------------------------------------------------------------
 int vtkCellArray::GetNextCell(vtkIdList *pts)
 {
+  if (this->Connectivity)
+    {
+    if (this->TraversalLocation < this->NumberOfCells)
+      {
+      this->GetCellAtId(this->TraversalLocation++, pts);
+      return 1;
+      }
+    return 0;
+    }
   vtkIdType npts, *ppts;
   if (this->GetNextCell(npts, ppts))
     {
@@ -115,6 +305,11 @@ int vtkCellArray::GetNextCell(vtkIdList *pts)
 //----------------------------------------------------------------------------
 void vtkCellArray::GetCell(vtkIdType loc, vtkIdList *pts)
 {
+  if (this->Connectivity)
+    {
+    this->GetCellAtId(loc, pts);
+    return;
+    }
   vtkIdType npts = this->Ia->GetValue(loc++);
   vtkIdType *ppts = this->Ia->GetPointer(loc);
   pts->SetNumberOfIds(npts);
@@ -132,4 +327,435 @@ void vtkCellArray::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Number Of Cells: " << this->NumberOfCells << endl;
   os << indent << "Insert Location: " << this->InsertLocation << endl;
   os << indent << "Traversal Location: " << this->TraversalLocation << endl;
+  os << indent << "Layout: "
+     << (this->Layout == VTK_CELL_ARRAY_OFFSETS_32 ? "Offsets32" :
+         (this->Layout == VTK_CELL_ARRAY_OFFSETS_64 ? "Offsets64" : "Legacy"))
+     << endl;
+}
+
+//----------------------------------------------------------------------------
+void vtkCellArray::SetLayout(int layout)
+{
+  if (layout == this->Layout)
+    {
+    return;
+    }
+  if (layout != VTK_CELL_ARRAY_LEGACY && layout != VTK_CELL_ARRAY_OFFSETS_32 &&
+      layout != VTK_CELL_ARRAY_OFFSETS_64)
+    {
+    vtkErrorMacro("Unknown cell array layout " << layout);
+    return;
+    }
+
+  // Go through the legacy list, which conversions between the offsets
+  // layouts build temporarily.
+  if (this->Connectivity)
+    {
+    if (this->Layout == VTK_CELL_ARRAY_OFFSETS_32)
+      {
+      vtkCellArrayToLegacy(vtkCellArrayOffsets32(this),
+                           vtkCellArrayConnectivity32(this),
+                           this->NumberOfCells, this->Ia);
+      }
+    else
+      {
+      vtkCellArrayToLegacy(vtkCellArrayOffsets64(this),
+                           vtkCellArrayConnectivity64(this),
+                           this->NumberOfCells, this->Ia);
+      }
+    this->ReleaseOffsets();
+    this->InsertLocation = this->Ia->GetMaxId() + 1;
+    }
+
+  if (layout != VTK_CELL_ARRAY_LEGACY)
+    {
+    vtkDataArray *offsets;
+    vtkDataArray *connectivity;
+    vtkIdType numCells = 0;
+    int ok;
+    if (layout == VTK_CELL_ARRAY_OFFSETS_32)
+      {
+      vtkIntArray *o = vtkIntArray::New();
+      vtkIntArray *c = vtkIntArray::New();
+      o->SetAllocator(this->Ia->GetAllocator());
+      c->SetAllocator(this->Ia->GetAllocator());
+      ok = vtkCellArrayFromLegacy(this->Ia, o, c, numCells);
+      offsets = o;
+      connectivity = c;
+      }
+    else
+      {
+      vtkIdTypeArray *o = vtkIdTypeArray::New();
+      vtkIdTypeArray *c = vtkIdTypeArray::New();
+      o->SetAllocator(this->Ia->GetAllocator());
+      c->SetAllocator(this->Ia->GetAllocator());
+      ok = vtkCellArrayFromLegacy(this->Ia, o, c, numCells);
+      offsets = o;
+      connectivity = c;
+      }
+    if (!ok)
+      {
+      vtkErrorMacro("The cells do not fit in 32-bit offsets and ids, "
+                    "keeping the legacy layout.");
+      offsets->Delete();
+      connectivity->Delete();
+      this->Modified();
+      return;
+      }
+    this->Layout = layout;
+    this->Offsets = offsets;
+    this->Connectivity = connectivity;
+    this->Ia->Initialize();
+    this->NumberOfCells = numCells;
+    this->InsertLocation = connectivity->GetMaxId() + 1;
+    }
+  this->TraversalLocation = 0;
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+int vtkCellArray::SetData(vtkDataArray *offsets, vtkDataArray *connectivity)
+{
+  if (!offsets || !connectivity || offsets == connectivity)
+    {
+    vtkErrorMacro("Two distinct offsets and connectivity arrays are needed.");
+    return 0;
+    }
+
+  int layout;
+  vtkIdType first, last;
+  vtkIdType numOffsets = offsets->GetNumberOfTuples();
+  if (offsets->GetNumberOfComponents() != 1 ||
+      connectivity->GetNumberOfComponents() != 1 || numOffsets < 1)
+    {
+    vtkErrorMacro("The offsets array must have at least one value.");
+    return 0;
+    }
+  if (vtkIntArray::SafeDownCast(offsets) &&
+      vtkIntArray::SafeDownCast(connectivity))
+    {
+    layout = VTK_CELL_ARRAY_OFFSETS_32;
+    first = static_cast<vtkIntArray *>(offsets)->GetValue(0);
+    last = static_cast<vtkIntArray *>(offsets)->GetValue(numOffsets-1);
+    }
+  else if (vtkIdTypeArray::SafeDownCast(offsets) &&
+           vtkIdTypeArray::SafeDownCast(connectivity))
+    {
+    layout = VTK_CELL_ARRAY_OFFSETS_64;
+    first = static_cast<vtkIdTypeArray *>(offsets)->GetValue(0);
+    last = static_cast<vtkIdTypeArray *>(offsets)->GetValue(numOffsets-1);
+    }
+  else
+    {
+    vtkErrorMacro("The offsets and connectivity arrays must both be "
+                  "vtkIntArrays or both be vtkIdTypeArrays.");
+    return 0;
+    }
+  if (first != 0 || last != connectivity->GetNumberOfTuples())
+    {
+    vtkErrorMacro("The offsets must start at 0 and end with the number of "
+                  "connectivity entries.");
+    return 0;
+    }
+
+  offsets->Register(this);
+  connectivity->Register(this);
+  this->ReleaseOffsets();
+  this->Ia->Initialize();
+  this->Layout = layout;
+  this->Offsets = offsets;
+  this->Connectivity = connectivity;
+  this->NumberOfCells = numOffsets - 1;
+  this->InsertLocation = last;
+  this->TraversalLocation = 0;
+  this->Modified();
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkCellArray::SetAllocator(vtkArrayAllocator *allocator)
+{
+  this->Ia->SetAllocator(allocator);
+  if (this->Layout == VTK_CELL_ARRAY_OFFSETS_32)
+    {
+    vtkCellArrayOffsets32(this)->SetAllocator(allocator);
+    vtkCellArrayConnectivity32(this)->SetAllocator(allocator);
+    if (this->ConnectivityIds)
+      {
+      this->ConnectivityIds->SetAllocator(allocator);
+      }
+    }
+  else if (this->Layout == VTK_CELL_ARRAY_OFFSETS_64)
+    {
+    vtkCellArrayOffsets64(this)->SetAllocator(allocator);
+    vtkCellArrayConnectivity64(this)->SetAllocator(allocator);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkCellArray::GetCellAtId(vtkIdType cellId, vtkIdList *pts)
+{
+  vtkIdType npts = this->GetCellSize(cellId);
+  pts->SetNumberOfIds(npts);
+  if (this->Layout == VTK_CELL_ARRAY_OFFSETS_32)
+    {
+    vtkCellArrayGetCellAtId(vtkCellArrayOffsets32(this),
+                            vtkCellArrayConnectivity32(this), cellId, npts,
+                            pts->GetPointer(0));
+    }
+  else
+    {
+    vtkIdType *ppts;
+    this->GetCellAtId(cellId, npts, ppts);
+    for (vtkIdType i = 0; i < npts; i++)
+      {
+      pts->SetId(i, ppts[i]);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkCellArray::GetCell(vtkIdType loc, vtkIdType &npts, vtkIdType* &pts,
+                          vtkIdType *buffer, vtkIdType size)
+{
+  if (this->Layout != VTK_CELL_ARRAY_OFFSETS_32)
+    {
+    this->GetCell(loc, npts, pts);
+    return 1;
+    }
+  npts = this->GetCellSize(loc);
+  if (npts > size)
+    {
+    return 0;
+    }
+  vtkCellArrayGetCellAtId(vtkCellArrayOffsets32(this),
+                          vtkCellArrayConnectivity32(this), loc, npts, buffer);
+  pts = buffer;
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkCellArray::GetCellSize(vtkIdType cellId)
+{
+  if (this->Layout == VTK_CELL_ARRAY_OFFSETS_32)
+    {
+    const int *offsets = vtkCellArrayOffsets32(this)->GetPointer(cellId);
+    return offsets[1] - offsets[0];
+    }
+  vtkIdType npts, *pts;
+  this->GetCellAtId(cellId, npts, pts);
+  return npts;
+}
+
+//----------------------------------------------------------------------------
+// Hand out the point ids of the cell from the vtkIdType copy of the 32-bit
+// connectivity, widening the ids it lacks first.
+void vtkCellArray::GetCellAtIdWithOffsets32(vtkIdType cellId, vtkIdType &npts,
+                                            vtkIdType* &pts)
+{
+  const int *offsets = vtkCellArrayOffsets32(this)->GetPointer(cellId);
+  if (!this->ConnectivityIds ||
+      this->ConnectivityIds->GetMaxId() < offsets[1] - 1)
+    {
+    this->UpdateConnectivityIds();
+    }
+  npts = offsets[1] - offsets[0];
+  pts = this->ConnectivityIds->GetPointer(offsets[0]);
+}
+
+//----------------------------------------------------------------------------
+void vtkCellArray::PrepareForThreadedAccess()
+{
+  if (this->Layout == VTK_CELL_ARRAY_OFFSETS_32)
+    {
+    this->UpdateConnectivityIds();
+    }
+}
+
+//----------------------------------------------------------------------------
+// Widen the 32-bit ids inserted since the copy was last updated. The ids
+// already copied are kept in step by ReverseCell() and ReplaceCell().
+void vtkCellArray::UpdateConnectivityIds()
+{
+  if (!this->ConnectivityIds)
+    {
+    this->ConnectivityIds = vtkIdTypeArray::New();
+    this->ConnectivityIds->SetAllocator(this->Ia->GetAllocator());
+    }
+  vtkIntArray *connectivity = vtkCellArrayConnectivity32(this);
+  vtkIdType start = this->ConnectivityIds->GetMaxId() + 1;
+  vtkIdType end = connectivity->GetMaxId() + 1;
+  if (end <= start)
+    {
+    return;
+    }
+  const int *from = connectivity->GetPointer(start);
+  vtkIdType *to = this->ConnectivityIds->WritePointer(start, end - start);
+  for (vtkIdType i = 0; i < end - start; i++)
+    {
+    to[i] = from[i];
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkCellArray::ReleaseConnectivityIds()
+{
+  if (this->ConnectivityIds)
+    {
+    this->ConnectivityIds->Delete();
+    this->ConnectivityIds = NULL;
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkCellArray::InsertNextCellWithOffsets(vtkIdType npts,
+                                                  const vtkIdType* pts)
+{
+  if (this->Layout == VTK_CELL_ARRAY_OFFSETS_32)
+    {
+    vtkCellArrayInsertNextCell(vtkCellArrayOffsets32(this),
+                               vtkCellArrayConnectivity32(this), npts, pts);
+    }
+  else
+    {
+    vtkCellArrayInsertNextCell(vtkCellArrayOffsets64(this),
+                               vtkCellArrayConnectivity64(this), npts, pts);
+    }
+  this->InsertLocation = this->Connectivity->GetMaxId() + 1;
+  return this->NumberOfCells++;
+}
+
+//----------------------------------------------------------------------------
+// The cell is given its size right away; InsertCellPoint() fills it and
+// UpdateCellCount() corrects the size.
+vtkIdType vtkCellArray::InsertNextCellWithOffsets(int npts)
+{
+  this->InsertLocation = this->Connectivity->GetMaxId() + 1;
+  vtkIdType end = this->InsertLocation + npts;
+  if (this->Layout == VTK_CELL_ARRAY_OFFSETS_32)
+    {
+    vtkCellArrayOffsets32(this)->InsertNextValue(static_cast<int>(end));
+    }
+  else
+    {
+    vtkCellArrayOffsets64(this)->InsertNextValue(end);
+    }
+  return this->NumberOfCells++;
+}
+
+//----------------------------------------------------------------------------
+void vtkCellArray::InsertCellPointWithOffsets(vtkIdType id)
+{
+  if (this->Layout == VTK_CELL_ARRAY_OFFSETS_32)
+    {
+    vtkCellArrayConnectivity32(this)->InsertValue(this->InsertLocation++,
+                                                  static_cast<int>(id));
+    }
+  else
+    {
+    vtkCellArrayConnectivity64(this)->InsertValue(this->InsertLocation++, id);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkCellArray::UpdateCellCountWithOffsets(int npts)
+{
+  vtkIdType cellId = this->NumberOfCells - 1;
+  if (this->Layout == VTK_CELL_ARRAY_OFFSETS_32)
+    {
+    vtkIntArray *offsets = vtkCellArrayOffsets32(this);
+    offsets->SetValue(cellId + 1, offsets->GetValue(cellId) + npts);
+    }
+  else
+    {
+    vtkIdTypeArray *offsets = vtkCellArrayOffsets64(this);
+    offsets->SetValue(cellId + 1, offsets->GetValue(cellId) + npts);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkCellArray::ReverseCellWithOffsets(vtkIdType cellId)
+{
+  if (this->Layout == VTK_CELL_ARRAY_OFFSETS_32)
+    {
+    vtkCellArrayReverseCell(vtkCellArrayOffsets32(this),
+                            vtkCellArrayConnectivity32(this), cellId);
+    vtkIdType end = vtkCellArrayOffsets32(this)->GetValue(cellId + 1);
+    if (this->ConnectivityIds && this->ConnectivityIds->GetMaxId() >= end - 1)
+      {
+      vtkIdType npts, *pts;
+      this->GetCellAtIdWithOffsets32(cellId, npts, pts);
+      for (vtkIdType i = 0; i < npts/2; i++)
+        {
+        vtkIdType tmp = pts[i];
+        pts[i] = pts[npts-i-1];
+        pts[npts-i-1] = tmp;
+        }
+      }
+    }
+  else
+    {
+    vtkCellArrayReverseCell(vtkCellArrayOffsets64(this),
+                            vtkCellArrayConnectivity64(this), cellId);
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkCellArray::ReplaceCellWithOffsets(vtkIdType cellId, int npts,
+                                          const vtkIdType *pts)
+{
+  if (this->Layout == VTK_CELL_ARRAY_OFFSETS_32)
+    {
+    vtkCellArrayReplaceCell(vtkCellArrayOffsets32(this),
+                            vtkCellArrayConnectivity32(this), cellId, npts,
+                            pts);
+    vtkIdType end = vtkCellArrayOffsets32(this)->GetValue(cellId + 1);
+    if (this->ConnectivityIds && this->ConnectivityIds->GetMaxId() >= end - 1)
+      {
+      vtkIdType n, *ids;
+      this->GetCellAtIdWithOffsets32(cellId, n, ids);
+      for (int i = 0; i < npts; i++)
+        {
+        ids[i] = pts[i];
+        }
+      }
+    }
+  else
+    {
+    vtkCellArrayReplaceCell(vtkCellArrayOffsets64(this),
+                            vtkCellArrayConnectivity64(this), cellId, npts,
+                            pts);
+    }
+}
+
+//----------------------------------------------------------------------------
+// Empty the offsets layout arrays, leaving the leading zero offset.
+void vtkCellArray::ResetOffsets()
+{
+  this->ReleaseConnectivityIds();
+  this->Connectivity->Reset();
+  this->Offsets->Reset();
+  if (this->Layout == VTK_CELL_ARRAY_OFFSETS_32)
+    {
+    vtkCellArrayOffsets32(this)->InsertNextValue(0);
+    }
+  else
+    {
+    vtkCellArrayOffsets64(this)->InsertNextValue(0);
+    }
+}
+
+//----------------------------------------------------------------------------
+// Drop the offsets layout arrays and go back to the legacy layout.
+void vtkCellArray::ReleaseOffsets()
+{
+  this->ReleaseConnectivityIds();
+  if (this->Connectivity)
+    {
+    this->Offsets->UnRegister(this);
+    this->Connectivity->UnRegister(this);
+    this->Offsets = NULL;
+    this->Connectivity = NULL;
+    }
+  this->Layout = VTK_CELL_ARRAY_LEGACY;
 }
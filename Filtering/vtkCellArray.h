@@ -26,6 +26,27 @@
 // using the vtkCellTypes and vtkCellLinks objects to extend the definition of
 // the data structure.
 //
+// Alternatively the cells can be stored in two arrays (see SetLayout()): a
+// connectivity array holding the point ids of all the cells one after the
+// other, and an offsets array of NumberOfCells+1 entries where cell i
+// spans connectivity entries offsets[i] to offsets[i+1]-1. Both arrays
+// hold either 32-bit integers or vtkIdTypes. This layout gives random
+// access to any cell through GetCellAtId(), which makes it possible to
+// traverse the cells in parallel, and the 32-bit variant takes about half
+// the memory of the legacy list with 64-bit ids. In the offsets layouts
+// the "locations" used by GetCell(), ReverseCell(), ReplaceCell(),
+// GetInsertLocation() and GetTraversalLocation() are cell ids, so that
+// datasets recording these locations keep working. In the
+// VTK_CELL_ARRAY_OFFSETS_32 layout the methods handing out a pointer to
+// the point ids of a cell (GetNextCell(), GetCell() and GetCellAtId() with
+// npts and pts) point into a vtkIdType copy of the connectivity array,
+// which the first of them builds and which follows the changes made
+// through the methods of this class. Writing through such a pointer does
+// not change the cells; use ReplaceCell(). The vtkIdList signatures and
+// the signatures taking a buffer read the 32-bit layout in place.
+// GetData(), GetPointer(), WritePointer() and SetCells() switch to the
+// legacy layout, which invalidates locations recorded earlier.
+//
 // .SECTION See Also
 // vtkCellTypes vtkCellLinks
 
@@ -37,6 +58,11 @@
 #include "vtkIdTypeArray.h" // Needed for inline methods
 #include "vtkCell.h" // Needed for inline methods
 
+// Storage layouts of the cells.
+#define VTK_CELL_ARRAY_LEGACY     0
+#define VTK_CELL_ARRAY_OFFSETS_32 1
+#define VTK_CELL_ARRAY_OFFSETS_64 2
+
 class VTK_FILTERING_EXPORT vtkCellArray : public vtkObject
 {
 public:
@@ -50,7 +76,13 @@ public:
   // Description:
   // Allocate memory and set the size to extend by.
   int Allocate(const vtkIdType sz, const int ext=1000)
-    {return this->Ia->Allocate(sz,ext);}
+    {
+    if (this->Connectivity)
+      {
+      return this->Connectivity->Allocate(sz,ext);
+      }
+    return this->Ia->Allocate(sz,ext);
+    }
 
   // Description:
   // Free any memory and reset to an empty state.
@@ -93,16 +125,84 @@ public:
   int GetNextCell(vtkIdList *pts);
 
   // Description:
-  // Get the size of the allocated connectivity array.
+  // Same as GetNextCell(npts, pts), except that in the
+  // VTK_CELL_ARRAY_OFFSETS_32 layout the ids are copied into the given
+  // buffer (see GetCell() with a buffer).
+  int GetNextCell(vtkIdType& npts, vtkIdType* &pts, vtkIdList *buffer);
+
+  // Description:
+  // Get the size of the allocated connectivity array (of both arrays in the
+  // offsets layouts).
   vtkIdType GetSize()
-    {return this->Ia->GetSize();}
+    {
+    if (this->Connectivity)
+      {
+      return this->Connectivity->GetSize() + this->Offsets->GetSize();
+      }
+    return this->Ia->GetSize();
+    }
 
   // Description:
   // Get the total number of entries (i.e., data values) in the connectivity
   // array. This may be much less than the allocated size (i.e., return value
-  // from GetSize().)
+  // from GetSize().) In the offsets layouts, this is the number of entries
+  // of the equivalent legacy list, one per point id plus one per cell.
   vtkIdType GetNumberOfConnectivityEntries()
-    {return this->Ia->GetMaxId()+1;}
+    {
+    if (this->Connectivity)
+      {
+      return this->Connectivity->GetMaxId() + 1 + this->NumberOfCells;
+      }
+    return this->Ia->GetMaxId()+1;
+    }
+
+  // Description:
+  // Set/Get the storage layout: VTK_CELL_ARRAY_LEGACY (the interleaved
+  // list, the default), VTK_CELL_ARRAY_OFFSETS_32 (offsets and
+  // connectivity arrays of 32-bit integers) or VTK_CELL_ARRAY_OFFSETS_64
+  // (offsets and connectivity arrays of vtkIdTypes, which are 64 bits
+  // wide when VTK_USE_64BIT_IDS is on). The cells already inserted are
+  // converted. Switching to VTK_CELL_ARRAY_OFFSETS_32 fails with an error
+  // if an id or offset does not fit in 32 bits; ids inserted later are not
+  // checked.
+  void SetLayout(int layout);
+  vtkGetMacro(Layout, int);
+  void SetLayoutToLegacy()
+    {this->SetLayout(VTK_CELL_ARRAY_LEGACY);}
+  void SetLayoutToOffsets32()
+    {this->SetLayout(VTK_CELL_ARRAY_OFFSETS_32);}
+  void SetLayoutToOffsets64()
+    {this->SetLayout(VTK_CELL_ARRAY_OFFSETS_64);}
+
+  // Description:
+  // Get the offsets and connectivity arrays of the offsets layouts (a
+  // vtkIntArray or a vtkIdTypeArray). NULL in the legacy layout.
+  vtkDataArray *GetOffsetsArray()
+    {return this->Offsets;}
+  vtkDataArray *GetConnectivityArray()
+    {return this->Connectivity;}
+
+  // Description:
+  // Use the given offsets and connectivity arrays as the cells, in the
+  // offsets layout matching their type. Both must be vtkIntArrays or both
+  // vtkIdTypeArrays; offsets must start at 0, be one entry longer than
+  // the number of cells and end with the number of connectivity entries.
+  // Returns 0 (and leaves the cells unchanged) otherwise.
+  int SetData(vtkDataArray *offsets, vtkDataArray *connectivity);
+
+  // Description:
+  // Random access to the cell with the given id (its index in the order
+  // of insertion). Cheap in the offsets layouts; in the legacy layout the
+  // list is scanned from the beginning. pts points into the cell array (in
+  // the VTK_CELL_ARRAY_OFFSETS_32 layout into its vtkIdType copy, see the
+  // class description) and stays valid until cells are added or the
+  // layout changes. The vtkIdList signature reads the cell in place.
+  void GetCellAtId(vtkIdType cellId, vtkIdType &npts, vtkIdType* &pts);
+  void GetCellAtId(vtkIdType cellId, vtkIdList *pts);
+
+  // Description:
+  // Number of points of the cell with the given id, see GetCellAtId().
+  vtkIdType GetCellSize(vtkIdType cellId);
 
   // Description:
   // Internal method used to retrieve a cell given an offset into
@@ -114,6 +214,37 @@ public:
   // the internal array.
   void GetCell(vtkIdType loc, vtkIdList* pts);
 
+  // Description:
+  // Same as GetCell(loc, npts, pts), except that when the ids cannot be
+  // handed out in place (in the VTK_CELL_ARRAY_OFFSETS_32 layout) they are
+  // copied into the given buffer instead of the vtkIdType copy of the cell
+  // array. This makes it safe to call from several threads at once, each
+  // with its own buffer, without PrepareForThreadedAccess(). The buffer
+  // may be NULL in the other layouts.
+  void GetCell(vtkIdType loc, vtkIdType &npts, vtkIdType* &pts,
+               vtkIdList *buffer);
+
+  // Description:
+  // Same as GetCell(loc, npts, pts, buffer) with a buffer of size ids on
+  // the caller's side, typically on the stack. Returns 0, with npts set to
+  // the size of the cell, when the buffer is needed but too small.
+  int GetCell(vtkIdType loc, vtkIdType &npts, vtkIdType* &pts,
+              vtkIdType *buffer, vtkIdType size);
+
+  // Description:
+  // Return whether GetCell(loc, npts, pts, buffer) needs a buffer.
+  int GetCellNeedsBuffer()
+    {return this->Layout == VTK_CELL_ARRAY_OFFSETS_32;}
+
+  // Description:
+  // In the VTK_CELL_ARRAY_OFFSETS_32 layout, build the vtkIdType copy of
+  // the point ids that GetNextCell(), GetCell() and GetCellAtId() with npts
+  // and pts otherwise build on their first call. Afterwards, and as long as
+  // no cells are added, these methods only read the cell array, so several
+  // threads can call them at once. Does nothing in the other layouts.
+  // THIS METHOD IS NOT THREAD SAFE.
+  void PrepareForThreadedAccess();
+
   // Description:
   // Insert a cell object. Return the cell id of the cell.
   vtkIdType InsertNextCell(vtkCell *cell);
@@ -149,7 +280,13 @@ public:
   // Computes the current insertion location within the internal array.
   // Used in conjunction with GetCell(int loc,...).
   vtkIdType GetInsertLocation(int npts)
-    {return (this->InsertLocation - npts - 1);};
+    {
+    if (this->Connectivity)
+      {
+      return this->NumberOfCells - 1;
+      }
+    return (this->InsertLocation - npts - 1);
+    }
 
   // Description:
   // Get/Set the current traversal location.
@@ -162,7 +299,13 @@ public:
   // Computes the current traversal location within the internal array. Used
   // in conjunction with GetCell(int loc,...).
   vtkIdType GetTraversalLocation(vtkIdType npts)
-    {return(this->TraversalLocation-npts-1);}
+    {
+    if (this->Connectivity)
+      {
+      return this->TraversalLocation - 1;
+      }
+    return(this->TraversalLocation-npts-1);
+    }
 
   // Description:
   // Special method inverts ordering of current cell. Must be called
@@ -179,14 +322,15 @@ public:
   int GetMaxCellSize();
 
   // Description:
-  // Get pointer to array of cell data.
+  // Get pointer to array of cell data. Switches to the legacy layout, see
+  // GetData().
   vtkIdType *GetPointer()
-    {return this->Ia->GetPointer(0);}
+    {return this->GetData()->GetPointer(0);}
 
   // Description:
   // Get pointer to data array for purpose of direct writes of data. Size is the
   // total storage consumed by the cell array. ncells is the number of cells
-  // represented in the array.
+  // represented in the array. Switches to the legacy layout.
   vtkIdType *WritePointer(const vtkIdType ncells, const vtkIdType size);
 
   // Description:
@@ -196,7 +340,7 @@ public:
   // referring these cells becomes invalid (for example, if BuildCells() has
   // been called see vtkPolyData).  The traversal location is reset to the
   // beginning of the list; the insertion location is set to the end of the
-  // list.
+  // list. Switches to the legacy layout.
   void SetCells(vtkIdType ncells, vtkIdTypeArray *cells);
 
   // Description:
@@ -204,18 +348,46 @@ public:
   void DeepCopy(vtkCellArray *ca);
 
   // Description:
-  // Return the underlying data as a data array.
+  // Return the underlying data as a data array. In the offsets layouts,
+  // the cell array is first switched to the legacy layout, once, as with
+  // SetLayoutToLegacy(): the cells then live in the returned array, and
+  // the locations recorded earlier (for example by vtkPolyData::BuildCells())
+  // are invalid. Use GetOffsetsArray() and GetConnectivityArray() to read
+  // the offsets layouts without converting them.
   vtkIdTypeArray* GetData()
-    {return this->Ia;}
+    {
+    if (this->Connectivity)
+      {
+      this->SetLayout(VTK_CELL_ARRAY_LEGACY);
+      }
+    return this->Ia;
+    }
+
+  // Description:
+  // Set/Get the allocator used for the storage of the cells, see
+  // vtkDataArrayTemplate::SetAllocator(). SetCells() and SetData() replace
+  // the arrays holding the cells, and with them the allocator.
+  void SetAllocator(vtkArrayAllocator *allocator);
+  vtkArrayAllocator *GetAllocator()
+    {return this->Ia->GetAllocator();}
 
   // Description:
   // Reuse list. Reset to initial condition.
   void Reset();
 
   // Description:
-  // Reclaim any extra memory.
+  // Reclaim any extra memory, including the vtkIdType copy of the point
+  // ids of the VTK_CELL_ARRAY_OFFSETS_32 layout.
   void Squeeze()
-    {this->Ia->Squeeze();}
+    {
+    if (this->Connectivity)
+      {
+      this->Connectivity->Squeeze();
+      this->Offsets->Squeeze();
+      this->ReleaseConnectivityIds();
+      }
+    this->Ia->Squeeze();
+    }
 
   // Description:
   // Return the memory in kilobytes consumed by this cell array. Used to
@@ -235,6 +407,34 @@ protected:
   vtkIdType TraversalLocation;   //keep track of traversal position
   vtkIdTypeArray *Ia;
 
+  // The arrays of the offsets layouts, NULL in the legacy layout. The
+  // insertion location indexes Connectivity and the traversal location
+  // is a cell id in these layouts, where Ia is empty.
+  int Layout;
+  vtkDataArray *Offsets;
+  vtkDataArray *Connectivity;
+
+  // The connectivity of the 32-bit offsets layout as vtkIdTypes, for the
+  // methods handing out pointers to point ids. NULL until one of them is
+  // called. It may lag behind Connectivity when cells were added since;
+  // UpdateConnectivityIds() widens the missing ids.
+  vtkIdTypeArray *ConnectivityIds;
+
+  // Out of line versions of the inline methods for the offsets layouts.
+  vtkIdType InsertNextCellWithOffsets(vtkIdType npts, const vtkIdType* pts);
+  vtkIdType InsertNextCellWithOffsets(int npts);
+  void InsertCellPointWithOffsets(vtkIdType id);
+  void UpdateCellCountWithOffsets(int npts);
+  void GetCellAtIdWithOffsets32(vtkIdType cellId, vtkIdType &npts,
+                                vtkIdType* &pts);
+  void UpdateConnectivityIds();
+  void ReleaseConnectivityIds();
+  void ReverseCellWithOffsets(vtkIdType cellId);
+  void ReplaceCellWithOffsets(vtkIdType cellId, int npts,
+                              const vtkIdType *pts);
+  void ResetOffsets();
+  void ReleaseOffsets();
+
 private:
   vtkCellArray(const vtkCellArray&);  // Not implemented.
   void operator=(const vtkCellArray&);  // Not implemented.
@@ -245,6 +445,11 @@ private:
 inline vtkIdType vtkCellArray::InsertNextCell(vtkIdType npts,
                                               const vtkIdType* pts)
 {
+  if (this->Connectivity)
+    {
+    return this->InsertNextCellWithOffsets(npts, pts);
+    }
+
   vtkIdType i = this->Ia->GetMaxId() + 1;
   vtkIdType *ptr = this->Ia->WritePointer(i, npts+1);
 
@@ -262,6 +467,11 @@ inline vtkIdType vtkCellArray::InsertNextCell(vtkIdType npts,
 //----------------------------------------------------------------------------
 inline vtkIdType vtkCellArray::InsertNextCell(int npts)
 {
+  if (this->Connectivity)
+    {
+    return this->InsertNextCellWithOffsets(npts);
+    }
+
   this->InsertLocation = this->Ia->InsertNextValue(npts) + 1;
   this->NumberOfCells++;
 
@@ -271,12 +481,24 @@ inline vtkIdType vtkCellArray::InsertNextCell(int npts)
 //----------------------------------------------------------------------------
 inline void vtkCellArray::InsertCellPoint(vtkIdType id)
 {
+  if (this->Connectivity)
+    {
+    this->InsertCellPointWithOffsets(id);
+    return;
+    }
+
   this->Ia->InsertValue(this->InsertLocation++, id);
 }
 
 //----------------------------------------------------------------------------
 inline void vtkCellArray::UpdateCellCount(int npts)
 {
+  if (this->Connectivity)
+    {
+    this->UpdateCellCountWithOffsets(npts);
+    return;
+    }
+
   this->Ia->SetValue(this->InsertLocation-npts-1, npts);
 }
 
@@ -300,11 +522,24 @@ inline void vtkCellArray::Reset()
   this->InsertLocation = 0;
   this->TraversalLocation = 0;
   this->Ia->Reset();
+  if (this->Connectivity)
+    {
+    this->ResetOffsets();
+    }
 }
 
 //----------------------------------------------------------------------------
 inline int vtkCellArray::GetNextCell(vtkIdType& npts, vtkIdType* &pts)
 {
+  if (this->Connectivity)
+    {
+    if (this->TraversalLocation < this->NumberOfCells)
+      {
+      this->GetCellAtId(this->TraversalLocation++, npts, pts);
+      return 1;
+      }
+    return 0;
+    }
   if ( this->Ia->GetMaxId() >= 0 &&
        this->TraversalLocation <= this->Ia->GetMaxId() )
     {
@@ -320,6 +555,11 @@ inline int vtkCellArray::GetNextCell(vtkIdType& npts, vtkIdType* &pts)
 inline void vtkCellArray::GetCell(vtkIdType loc, vtkIdType &npts,
                                   vtkIdType* &pts)
 {
+  if (this->Connectivity)
+    {
+    this->GetCellAtId(loc, npts, pts);
+    return;
+    }
   npts = this->Ia->GetValue(loc++);
   pts  = this->Ia->GetPointer(loc);
 }
@@ -327,6 +567,11 @@ inline void vtkCellArray::GetCell(vtkIdType loc, vtkIdType &npts,
 //----------------------------------------------------------------------------
 inline void vtkCellArray::ReverseCell(vtkIdType loc)
 {
+  if (this->Connectivity)
+    {
+    this->ReverseCellWithOffsets(loc);
+    return;
+    }
   int i;
   vtkIdType tmp;
   vtkIdType npts=this->Ia->GetValue(loc);
@@ -343,6 +588,11 @@ inline void vtkCellArray::ReverseCell(vtkIdType loc)
 inline void vtkCellArray::ReplaceCell(vtkIdType loc, int npts,
                                       const vtkIdType *pts)
 {
+  if (this->Connectivity)
+    {
+    this->ReplaceCellWithOffsets(loc, npts, pts);
+    return;
+    }
   vtkIdType *oldPts=this->Ia->GetPointer(loc+1);
   for (int i=0; i < npts; i++)
     {
@@ -354,10 +604,74 @@ inline void vtkCellArray::ReplaceCell(vtkIdType loc, int npts,
 inline vtkIdType *vtkCellArray::WritePointer(const vtkIdType ncells,
                                              const vtkIdType size)
 {
+  if (this->Connectivity)
+    {
+    this->ReleaseOffsets();
+    }
   this->NumberOfCells = ncells;
   this->InsertLocation = 0;
   this->TraversalLocation = 0;
   return this->Ia->WritePointer(0,size);
 }
 
+//----------------------------------------------------------------------------
+inline void vtkCellArray::GetCellAtId(vtkIdType cellId, vtkIdType &npts,
+                                      vtkIdType* &pts)
+{
+  if (this->Layout == VTK_CELL_ARRAY_OFFSETS_32)
+    {
+    this->GetCellAtIdWithOffsets32(cellId, npts, pts);
+    }
+  else if (this->Layout == VTK_CELL_ARRAY_OFFSETS_64)
+    {
+    vtkIdType *offsets =
+      static_cast<vtkIdTypeArray *>(this->Offsets)->GetPointer(cellId);
+    npts = offsets[1] - offsets[0];
+    pts = static_cast<vtkIdTypeArray *>(this->Connectivity)->GetPointer(
+      offsets[0]);
+    }
+  else
+    {
+    vtkIdType loc = 0;
+    for (vtkIdType i = 0; i < cellId; i++)
+      {
+      loc += this->Ia->GetValue(loc) + 1;
+      }
+    npts = this->Ia->GetValue(loc);
+    pts = this->Ia->GetPointer(loc+1);
+    }
+}
+
+//----------------------------------------------------------------------------
+inline void vtkCellArray::GetCell(vtkIdType loc, vtkIdType &npts,
+                                  vtkIdType* &pts, vtkIdList *buffer)
+{
+  if (this->Layout == VTK_CELL_ARRAY_OFFSETS_32)
+    {
+    this->GetCellAtId(loc, buffer);
+    npts = buffer->GetNumberOfIds();
+    pts = buffer->GetPointer(0);
+    }
+  else
+    {
+    this->GetCell(loc, npts, pts);
+    }
+}
+
+//----------------------------------------------------------------------------
+inline int vtkCellArray::GetNextCell(vtkIdType& npts, vtkIdType* &pts,
+                                     vtkIdList *buffer)
+{
+  if (this->Layout == VTK_CELL_ARRAY_OFFSETS_32)
+    {
+    if (this->TraversalLocation < this->NumberOfCells)
+      {
+      this->GetCell(this->TraversalLocation++, npts, pts, buffer);
+      return 1;
+      }
+    return 0;
+    }
+  return this->GetNextCell(npts, pts);
+}
+
 #endif
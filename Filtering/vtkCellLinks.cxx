@@ -17,16 +17,281 @@
 #include "vtkCellArray.h"
 #include "vtkDataSet.h"
 #include "vtkGenericCell.h"
+#include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
+#include "vtkMultiThreader.h"
 #include "vtkObjectFactory.h"
 #include "vtkPolyData.h"
 
+#include <vtkstd/vector>
+
 vtkStandardNewMacro(vtkCellLinks);
 
+// BuildLinks() divides the cells in pieces of at least this many cells
+// among the threads.
+#define VTK_CELL_LINKS_MIN_PIECE_SIZE 16384
+#define VTK_CELL_LINKS_PIECES_PER_THREAD 4
+
+//----------------------------------------------------------------------------
+// The cells links are built from: the cells of a vtkCellArray, of a
+// vtkPolyData or of any other dataset. Cursors visit the point ids of
+// consecutive cells without modifying the cells, so that several threads
+// can visit different cells at once.
+class vtkCellLinksCells
+{
+public:
+  enum
+  {
+    LEGACY,          // vtkCellArray in the legacy layout
+    OFFSETS_64,      // vtkCellArray in the 64-bit offsets layout
+    OFFSETS_32,      // vtkCellArray in the 32-bit offsets layout
+    POLY_DATA,       // vtkPolyData::GetCellPoints()
+    POLY_DATA_COPY,  // vtkPolyData with cell arrays in the 32-bit layout
+    DATA_SET         // vtkDataSet::GetCell()
+  };
+  int Mode;
+  vtkCellArray *Cells;
+  vtkDataSet *Data;
+  const vtkIdType *List; // LEGACY
+  const vtkIdType *Offsets; // OFFSETS_64
+  const vtkIdType *Connectivity; // OFFSETS_64
+  vtkstd::vector<vtkIdType> Locations; // LEGACY, where each piece starts
+
+  // Record where the pieces of numCells cells start in the legacy list.
+  void SetNumberOfPieces(vtkIdType numCells, int pieces)
+    {
+    if (this->Mode != LEGACY)
+      {
+      return;
+      }
+    this->Locations.resize(pieces);
+    vtkIdType loc = 0, cellId = 0;
+    for (int piece = 0; piece < pieces; piece++)
+      {
+      vtkIdType begin = numCells*piece/pieces;
+      for (; cellId < begin; cellId++)
+        {
+        loc += this->List[loc] + 1;
+        }
+      this->Locations[piece] = loc;
+      }
+    }
+};
+
+class vtkCellLinksCursor
+{
+public:
+  vtkCellLinksCells *Cells;
+  vtkIdType CellId;
+  vtkIdType Location;
+  vtkIdList *Buffer;
+  vtkGenericCell *Cell;
+
+  vtkCellLinksCursor(vtkCellLinksCells *cells)
+    {
+    this->Cells = cells;
+    this->Buffer = vtkIdList::New();
+    this->Cell = cells->Mode == vtkCellLinksCells::DATA_SET ?
+      vtkGenericCell::New() : 0;
+    }
+  ~vtkCellLinksCursor()
+    {
+    this->Buffer->Delete();
+    if (this->Cell)
+      {
+      this->Cell->Delete();
+      }
+    }
+
+  // Start at the first cell of the piece starting at cell cellId.
+  void Start(vtkIdType cellId, int piece)
+    {
+    this->CellId = cellId;
+    if (this->Cells->Mode == vtkCellLinksCells::LEGACY)
+      {
+      this->Location = this->Cells->Locations.empty() ? 0 :
+        this->Cells->Locations[piece];
+      }
+    }
+
+  // Return the point ids of the current cell and move to the next.
+  void Next(vtkIdType &npts, const vtkIdType *&pts)
+    {
+    vtkIdType *ids;
+    switch (this->Cells->Mode)
+      {
+      case vtkCellLinksCells::LEGACY:
+        npts = this->Cells->List[this->Location];
+        pts = this->Cells->List + this->Location + 1;
+        this->Location += npts + 1;
+        break;
+      case vtkCellLinksCells::OFFSETS_64:
+        npts = this->Cells->Offsets[this->CellId + 1] -
+          this->Cells->Offsets[this->CellId];
+        pts = this->Cells->Connectivity + this->Cells->Offsets[this->CellId];
+        break;
+      case vtkCellLinksCells::OFFSETS_32:
+        this->Cells->Cells->GetCellAtId(this->CellId, this->Buffer);
+        npts = this->Buffer->GetNumberOfIds();
+        pts = this->Buffer->GetPointer(0);
+        break;
+      case vtkCellLinksCells::POLY_DATA:
+        static_cast<vtkPolyData *>(this->Cells->Data)->GetCellPoints(
+          this->CellId, npts, ids);
+        pts = ids;
+        break;
+      case vtkCellLinksCells::POLY_DATA_COPY:
+        this->Cells->Data->GetCellPoints(this->CellId, this->Buffer);
+        npts = this->Buffer->GetNumberOfIds();
+        pts = this->Buffer->GetPointer(0);
+        break;
+      default:
+        this->Cells->Data->GetCell(this->CellId, this->Cell);
+        npts = this->Cell->PointIds->GetNumberOfIds();
+        pts = this->Cell->PointIds->GetPointer(0);
+      }
+    this->CellId++;
+    }
+};
+
+//----------------------------------------------------------------------------
+// Builds the links in three passes over pieces of the cells, which are
+// also ranges of the points: count the uses of the points of each range
+// by each piece, copy the (point, cell) pairs of each piece to where they
+// go among the pairs sorted by range, then count and fill the lists of
+// each range from its pairs. The pairs of a range are in increasing cell
+// order, so the lists are the same as built serially.
+class vtkCellLinksBuilder
+{
+public:
+  vtkCellLinksCells *Cells;
+  vtkCellLinks::Link *Array;
+  vtkIdType NumberOfPoints;
+  vtkIdType NumberOfCells;
+  vtkIdType RangeSize;
+  int NumberOfPieces;
+  int Pass;
+  vtkIdType *Counts; // by piece and range, then where their pairs go
+  vtkIdType *RangeStarts;
+  vtkIdType *PairPoints;
+  vtkIdType *PairCells;
+  vtkIdType *Positions; // by point
+  vtkIdType *LinkData;
+
+  vtkIdType CellBegin(int piece)
+    {
+    return this->NumberOfCells*piece/this->NumberOfPieces;
+    }
+  vtkIdType PointBegin(int range)
+    {
+    vtkIdType begin = this->RangeSize*range;
+    return begin < this->NumberOfPoints ? begin : this->NumberOfPoints;
+    }
+  vtkIdType *PieceCounts(int piece)
+    {
+    return this->Counts + static_cast<vtkIdType>(piece)*this->NumberOfPieces;
+    }
+
+  void Execute(int piece, vtkCellLinksCursor &cursor);
+};
+
+void vtkCellLinksBuilder::Execute(int piece, vtkCellLinksCursor &cursor)
+{
+  vtkIdType npts, j, k;
+  const vtkIdType *pts;
+  vtkIdType *counts = this->PieceCounts(piece);
+  vtkIdType begin = this->CellBegin(piece), end = this->CellBegin(piece + 1);
+  if (this->Pass == 0)
+    {
+    cursor.Start(begin, piece);
+    for (vtkIdType cellId = begin; cellId < end; cellId++)
+      {
+      cursor.Next(npts, pts);
+      for (j = 0; j < npts; j++)
+        {
+        counts[pts[j]/this->RangeSize]++;
+        }
+      }
+    }
+  else if (this->Pass == 1)
+    {
+    cursor.Start(begin, piece);
+    for (vtkIdType cellId = begin; cellId < end; cellId++)
+      {
+      cursor.Next(npts, pts);
+      for (j = 0; j < npts; j++)
+        {
+        k = counts[pts[j]/this->RangeSize]++;
+        this->PairPoints[k] = pts[j];
+        this->PairCells[k] = cellId;
+        }
+      }
+    }
+  else
+    {
+    // The range of points with the same index as the piece.
+    vtkIdType ptBegin = this->PointBegin(piece);
+    vtkIdType ptEnd = this->PointBegin(piece + 1);
+    vtkIdType pairBegin = this->RangeStarts[piece];
+    vtkIdType pairEnd = this->RangeStarts[piece + 1];
+    vtkIdType ptId, *positions = this->Positions;
+    for (ptId = ptBegin; ptId < ptEnd; ptId++)
+      {
+      positions[ptId] = 0;
+      }
+    for (k = pairBegin; k < pairEnd; k++)
+      {
+      positions[this->PairPoints[k]]++;
+      }
+    vtkIdType position = pairBegin;
+    for (ptId = ptBegin; ptId < ptEnd; ptId++)
+      {
+      vtkIdType ncells = positions[ptId];
+      this->Array[ptId].ncells = static_cast<unsigned short>(ncells);
+      this->Array[ptId].cells = this->LinkData + position;
+      positions[ptId] = position;
+      position += ncells;
+      }
+    for (k = pairBegin; k < pairEnd; k++)
+      {
+      this->LinkData[positions[this->PairPoints[k]]++] = this->PairCells[k];
+      }
+    }
+}
+
+static VTK_THREAD_RETURN_TYPE vtkCellLinksBuildExecute(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *info =
+    static_cast<vtkMultiThreader::ThreadInfo *>(arg);
+  vtkCellLinksBuilder *builder =
+    static_cast<vtkCellLinksBuilder *>(info->UserData);
+  vtkCellLinksCursor cursor(builder->Cells);
+  for (int piece = info->ThreadID; piece < builder->NumberOfPieces;
+       piece += info->NumberOfThreads)
+    {
+    builder->Execute(piece, cursor);
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+vtkCellLinks::vtkCellLinks()
+{
+  this->Array = NULL;
+  this->Size = 0;
+  this->MaxId = -1;
+  this->Extend = 1000;
+  this->LinkData = NULL;
+  this->LinkDataSize = 0;
+  this->NumberOfThreads = 1;
+}
+
 //----------------------------------------------------------------------------
 void vtkCellLinks::Allocate(vtkIdType sz, vtkIdType ext)
 {
   static vtkCellLinks::Link linkInit = {0,NULL};
 
+  this->FreeLinks();
   this->Size = sz;
   if ( this->Array != NULL )
     {
@@ -45,20 +310,30 @@ void vtkCellLinks::Allocate(vtkIdType sz, vtkIdType ext)
 //----------------------------------------------------------------------------
 vtkCellLinks::~vtkCellLinks()
 {
-  if ( this->Array == NULL )
-    {
-    return;
-    }
+  this->FreeLinks();
+  delete [] this->Array;
+}
 
-  for (vtkIdType i=0; i<=this->MaxId; i++)
+//----------------------------------------------------------------------------
+// Free the lists of cells, those allocated alone and LinkData.
+void vtkCellLinks::FreeLinks()
+{
+  if ( this->Array != NULL )
     {
-    if ( this->Array[i].cells != NULL )
+    for (vtkIdType i=0; i<=this->MaxId; i++)
       {
-      delete [] this->Array[i].cells;
+      if ( this->Array[i].cells != NULL &&
+           !this->IsLinkData(this->Array[i].cells) )
+        {
+        delete [] this->Array[i].cells;
+        }
+      this->Array[i].cells = NULL;
+      this->Array[i].ncells = 0;
       }
     }
-
-  delete [] this->Array;
+  delete [] this->LinkData;
+  this->LinkData = NULL;
+  this->LinkDataSize = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -128,122 +403,192 @@ vtkCellLinks::Link *vtkCellLinks::Resize(vtkIdType sz)
 // Build the link list array.
 void vtkCellLinks::BuildLinks(vtkDataSet *data)
 {
-  vtkIdType numPts = data->GetNumberOfPoints();
-  vtkIdType numCells = data->GetNumberOfCells();
-  int j;
-  vtkIdType cellId;
-  unsigned short *linkLoc;
-
-  // fill out lists with number of references to cells
-  linkLoc = new unsigned short[numPts];
-  memset(linkLoc, 0, numPts*sizeof(unsigned short));
+  vtkCellLinksCells cells;
+  cells.Data = data;
+  cells.Cells = NULL;
+  cells.Mode = vtkCellLinksCells::DATA_SET;
 
   // Use fast path if polydata
   if ( data->GetDataObjectType() == VTK_POLY_DATA )
     {
-    vtkIdType *pts, npts;
-    
     vtkPolyData *pdata = static_cast<vtkPolyData *>(data);
-    // traverse data to determine number of uses of each point
-    for (cellId=0; cellId < numCells; cellId++)
+    vtkCellArray *arrays[4] = {pdata->GetVerts(), pdata->GetLines(),
+                               pdata->GetPolys(), pdata->GetStrips()};
+    cells.Mode = vtkCellLinksCells::POLY_DATA;
+    for (int i = 0; i < 4; i++)
       {
-      pdata->GetCellPoints(cellId, npts, pts);
-      for (j=0; j < npts; j++)
+      if ( arrays[i]->GetLayout() == VTK_CELL_ARRAY_OFFSETS_32 )
         {
-        this->IncrementLinkCount(pts[j]);      
-        }      
+        cells.Mode = vtkCellLinksCells::POLY_DATA_COPY;
+        }
       }
+    }
 
-    // now allocate storage for the links
-    this->AllocateLinks(numPts);
-    this->MaxId = numPts - 1;
+  this->BuildLinksInternal(&cells, data->GetNumberOfPoints(),
+                           data->GetNumberOfCells());
+}
 
-    for (cellId=0; cellId < numCells; cellId++)
+//----------------------------------------------------------------------------
+// Build the link list array.
+void vtkCellLinks::BuildLinks(vtkDataSet *data, vtkCellArray *Connectivity)
+{
+  vtkCellLinksCells cells;
+  cells.Data = data;
+  cells.Cells = Connectivity;
+  switch ( Connectivity->GetLayout() )
+    {
+    case VTK_CELL_ARRAY_OFFSETS_64:
+      cells.Mode = vtkCellLinksCells::OFFSETS_64;
+      cells.Offsets = static_cast<vtkIdTypeArray *>(
+        Connectivity->GetOffsetsArray())->GetPointer(0);
+      cells.Connectivity = static_cast<vtkIdTypeArray *>(
+        Connectivity->GetConnectivityArray())->GetPointer(0);
+      break;
+    case VTK_CELL_ARRAY_OFFSETS_32:
+      cells.Mode = vtkCellLinksCells::OFFSETS_32;
+      break;
+    default:
+      cells.Mode = vtkCellLinksCells::LEGACY;
+      cells.List = Connectivity->GetData()->GetPointer(0);
+    }
+
+  this->BuildLinksInternal(&cells, data->GetNumberOfPoints(),
+                           Connectivity->GetNumberOfCells());
+}
+
+//----------------------------------------------------------------------------
+void vtkCellLinks::BuildLinksInternal(vtkCellLinksCells *cells,
+                                      vtkIdType numPts, vtkIdType numCells)
+{
+  this->FreeLinks();
+  if ( numPts > this->Size )
+    {
+    this->Allocate(numPts, this->Extend);
+    }
+  this->MaxId = numPts - 1;
+  if ( numPts < 1 )
+    {
+    return;
+    }
+
+  int pieces = 1;
+  if ( this->NumberOfThreads > 1 )
+    {
+    vtkIdType n = numCells / VTK_CELL_LINKS_MIN_PIECE_SIZE;
+    if ( n > this->NumberOfThreads*VTK_CELL_LINKS_PIECES_PER_THREAD )
       {
-      pdata->GetCellPoints(cellId, npts, pts);
-      for (j=0; j < npts; j++)
-        {
-        this->InsertCellReference(pts[j], (linkLoc[pts[j]])++, cellId);      
-        }      
+      n = this->NumberOfThreads*VTK_CELL_LINKS_PIECES_PER_THREAD;
       }
+    pieces = static_cast<int>(n);
     }
 
-  else //any other type of dataset
-    {
-    vtkIdType numberOfPoints, ptId;
-    vtkGenericCell *cell=vtkGenericCell::New();
+  vtkIdType j, npts, cellId;
+  const vtkIdType *pts;
+  vtkIdType *positions = new vtkIdType[numPts];
 
-    // traverse data to determine number of uses of each point
+  if ( pieces < 2 )
+    {
+    // count the uses of each point, then fill the lists
+    memset(positions, 0, numPts*sizeof(vtkIdType));
+    vtkCellLinksCursor cursor(cells);
+    cells->SetNumberOfPieces(numCells, 1);
+    cursor.Start(0, 0);
     for (cellId=0; cellId < numCells; cellId++)
       {
-      data->GetCell(cellId,cell);
-      numberOfPoints = cell->GetNumberOfPoints();
-      for (j=0; j < numberOfPoints; j++)
+      cursor.Next(npts, pts);
+      for (j=0; j < npts; j++)
         {
-        this->IncrementLinkCount(cell->PointIds->GetId(j));      
-        }      
+        positions[pts[j]]++;
+        }
       }
-
-    // now allocate storage for the links
-    this->AllocateLinks(numPts);
-    this->MaxId = numPts - 1;
-
+    vtkIdType position = 0;
+    for (j=0; j < numPts; j++)
+      {
+      this->Array[j].ncells = static_cast<unsigned short>(positions[j]);
+      position += positions[j];
+      }
+    this->LinkDataSize = position;
+    this->LinkData = new vtkIdType[position > 0 ? position : 1];
+    position = 0;
+    for (j=0; j < numPts; j++)
+      {
+      vtkIdType ncells = positions[j];
+      this->Array[j].cells = this->LinkData + position;
+      positions[j] = position;
+      position += ncells;
+      }
+    cursor.Start(0, 0);
     for (cellId=0; cellId < numCells; cellId++)
       {
-      data->GetCell(cellId,cell);
-      numberOfPoints = cell->GetNumberOfPoints();
-      for (j=0; j < numberOfPoints; j++)
+      cursor.Next(npts, pts);
+      for (j=0; j < npts; j++)
         {
-        ptId = cell->PointIds->GetId(j);
-        this->InsertCellReference(ptId, (linkLoc[ptId])++, cellId);      
-        }      
+        this->LinkData[positions[pts[j]]++] = cellId;
+        }
       }
-    cell->Delete();
-    }//end else
-
-  delete [] linkLoc;
-}
+    delete [] positions;
+    return;
+    }
 
-//----------------------------------------------------------------------------
-// Build the link list array.
-void vtkCellLinks::BuildLinks(vtkDataSet *data, vtkCellArray *Connectivity)
-{
-  vtkIdType numPts = data->GetNumberOfPoints();
-  vtkIdType j, cellId;
-  unsigned short *linkLoc;
-  vtkIdType npts=0;
-  vtkIdType *pts=0;
-  vtkIdType loc = Connectivity->GetTraversalLocation();
-  
-  // traverse data to determine number of uses of each point
-  for (Connectivity->InitTraversal(); 
-       Connectivity->GetNextCell(npts,pts);)
+  if ( cells->Mode >= vtkCellLinksCells::POLY_DATA )
     {
-    for (j=0; j < npts; j++)
-      {
-      this->IncrementLinkCount(pts[j]);      
-      }      
+    // the GetCellPoints() returning a pointer, read in the POLY_DATA mode,
+    // assumes that the cell map of the polydata is built
+    cells->Data->PrepareForThreadedAccess();
     }
-
-  // now allocate storage for the links
-  this->AllocateLinks(numPts);
-  this->MaxId = numPts - 1;
-
-  // fill out lists with references to cells
-  linkLoc = new unsigned short[numPts];
-  memset(linkLoc, 0, numPts*sizeof(unsigned short));
-
-  cellId = 0;
-  for (Connectivity->InitTraversal(); 
-       Connectivity->GetNextCell(npts,pts); cellId++)
+  vtkCellLinksBuilder builder;
+  builder.Cells = cells;
+  builder.Array = this->Array;
+  builder.NumberOfPoints = numPts;
+  builder.NumberOfCells = numCells;
+  builder.NumberOfPieces = pieces;
+  builder.RangeSize = (numPts + pieces - 1) / pieces;
+  builder.Counts = new vtkIdType[pieces*pieces];
+  memset(builder.Counts, 0, pieces*pieces*sizeof(vtkIdType));
+  builder.RangeStarts = new vtkIdType[pieces + 1];
+  builder.Positions = positions;
+  cells->SetNumberOfPieces(numCells, pieces);
+
+  vtkMultiThreader *threader = vtkMultiThreader::New();
+  threader->UseThreadPoolOn();
+  threader->SetNumberOfThreads(this->NumberOfThreads);
+  threader->SetNumberOfPieces(pieces);
+  threader->SetSingleMethod(vtkCellLinksBuildExecute, &builder);
+
+  builder.Pass = 0;
+  threader->SingleMethodExecute();
+
+  // where the pairs of each piece and range go, ranges one after another
+  vtkIdType position = 0;
+  int piece, range;
+  for (range = 0; range < pieces; range++)
     {
-    for (j=0; j < npts; j++)
+    builder.RangeStarts[range] = position;
+    for (piece = 0; piece < pieces; piece++)
       {
-      this->InsertCellReference(pts[j], (linkLoc[pts[j]])++, cellId);      
-      }      
+      vtkIdType count = builder.PieceCounts(piece)[range];
+      builder.PieceCounts(piece)[range] = position;
+      position += count;
+      }
     }
-  delete [] linkLoc;
-  Connectivity->SetTraversalLocation(loc);
+  builder.RangeStarts[pieces] = position;
+  this->LinkDataSize = position;
+  this->LinkData = new vtkIdType[position > 0 ? position : 1];
+  builder.LinkData = this->LinkData;
+  builder.PairPoints = new vtkIdType[position > 0 ? position : 1];
+  builder.PairCells = new vtkIdType[position > 0 ? position : 1];
+
+  builder.Pass = 1;
+  threader->SingleMethodExecute();
+  builder.Pass = 2;
+  threader->SingleMethodExecute();
+  threader->Delete();
+
+  delete [] builder.PairPoints;
+  delete [] builder.PairCells;
+  delete [] builder.Counts;
+  delete [] builder.RangeStarts;
+  delete [] positions;
 }
 
 //----------------------------------------------------------------------------
@@ -280,8 +625,25 @@ unsigned long vtkCellLinks::GetActualMemorySize()
 void vtkCellLinks::DeepCopy(vtkCellLinks *src)
 {
   this->Allocate(src->Size, src->Extend);
-  memcpy(this->Array, src->Array, this->Size * sizeof(vtkCellLinks::Link));
   this->MaxId = src->MaxId;
+
+  // copy the lists into LinkData
+  vtkIdType ptId, size = 0;
+  for (ptId=0; ptId <= this->MaxId; ptId++)
+    {
+    size += src->Array[ptId].ncells;
+    }
+  this->LinkDataSize = size;
+  this->LinkData = new vtkIdType[size > 0 ? size : 1];
+  size = 0;
+  for (ptId=0; ptId <= this->MaxId; ptId++)
+    {
+    this->Array[ptId].ncells = src->Array[ptId].ncells;
+    this->Array[ptId].cells = this->LinkData + size;
+    memcpy(this->Array[ptId].cells, src->Array[ptId].cells,
+           src->Array[ptId].ncells*sizeof(vtkIdType));
+    size += src->Array[ptId].ncells;
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -292,4 +654,5 @@ void vtkCellLinks::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Size: " << this->Size << "\n";
   os << indent << "MaxId: " << this->MaxId << "\n";
   os << indent << "Extend: " << this->Extend << "\n";
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << "\n";
 }
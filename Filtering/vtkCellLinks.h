@@ -19,6 +19,13 @@
 // a list of Links, each link represents a dynamic list of cell id's using the 
 // point. The information provided by this object can be used to determine 
 // neighbors and construct other local topological information.
+//
+// BuildLinks() stores the lists of all the points one after the other in
+// a single array (a compressed sparse row layout), each list holding its
+// cell ids in increasing order. It counts the uses of the points, then
+// fills the lists, dividing the cells among NumberOfThreads threads when
+// there are many of them. Lists later resized or inserted by the editing
+// methods are allocated separately.
 // .SECTION See Also
 // vtkCellArray vtkCellTypes
 
@@ -28,6 +35,9 @@
 #include "vtkObject.h"
 class vtkDataSet;
 class vtkCellArray;
+//BTX
+class vtkCellLinksCells;
+//ETX
 
 class VTK_FILTERING_EXPORT vtkCellLinks : public vtkObject 
 {
@@ -70,6 +80,11 @@ public:
   // Return a list of cell ids using the point.
   vtkIdType *GetCells(vtkIdType ptId) {return this->Array[ptId].cells;};
 
+  // Description:
+  // Specify the number of threads BuildLinks() uses. Defaults to 1.
+  vtkSetClampMacro(NumberOfThreads, int, 1, VTK_LARGE_INTEGER);
+  vtkGetMacro(NumberOfThreads, int);
+
   // Description:
   // Insert a new point into the cell-links data structure. The size parameter
   // is the initial size of the list.
@@ -125,7 +140,7 @@ public:
   void DeepCopy(vtkCellLinks *src);
 
 protected:
-  vtkCellLinks():Array(NULL),Size(0),MaxId(-1),Extend(1000) {};
+  vtkCellLinks();
   ~vtkCellLinks();
 
   // Description:
@@ -134,6 +149,18 @@ protected:
 
   void AllocateLinks(vtkIdType n);
 
+  // Description:
+  // Build the lists of the numPts points in LinkData from the given cells.
+  void BuildLinksInternal(vtkCellLinksCells *cells, vtkIdType numPts,
+                          vtkIdType numCells);
+
+  // Description:
+  // Is the list of cells part of LinkData, rather than allocated alone.
+  int IsLinkData(const vtkIdType *cells)
+    {return this->LinkData && cells >= this->LinkData &&
+       cells <= this->LinkData + this->LinkDataSize;}
+  void FreeLinks();
+
   // Description:
   // Insert a cell id into the list of cells using the point.
   void InsertCellReference(vtkIdType ptId, unsigned short pos,
@@ -144,6 +171,9 @@ protected:
   vtkIdType MaxId;     // maximum index inserted thus far
   vtkIdType Extend;     // grow array by this point
   Link *Resize(vtkIdType sz);  // function to resize data
+  vtkIdType *LinkData;  // the lists built by BuildLinks(), one after another
+  vtkIdType LinkDataSize;
+  int NumberOfThreads;
 private:
   vtkCellLinks(const vtkCellLinks&);  // Not implemented.
   void operator=(const vtkCellLinks&);  // Not implemented.
@@ -161,7 +191,10 @@ inline void vtkCellLinks::InsertCellReference(vtkIdType ptId,
 inline void vtkCellLinks::DeletePoint(vtkIdType ptId)
 {
   this->Array[ptId].ncells = 0;
-  delete [] this->Array[ptId].cells;
+  if (!this->IsLinkData(this->Array[ptId].cells))
+    {
+    delete [] this->Array[ptId].cells;
+    }
   this->Array[ptId].cells = NULL;
 }
 
@@ -208,7 +241,10 @@ inline void vtkCellLinks::ResizeCellList(vtkIdType ptId, int size)
   cells = new vtkIdType[newSize];
   memcpy(cells, this->Array[ptId].cells,
          this->Array[ptId].ncells*sizeof(vtkIdType));
-  delete [] this->Array[ptId].cells;
+  if (!this->IsLinkData(this->Array[ptId].cells))
+    {
+    delete [] this->Array[ptId].cells;
+    }
   this->Array[ptId].cells = cells;
 }
 
@@ -158,6 +158,12 @@ double *vtkDataSet::GetScalarRange()
   return this->ScalarRange;
 }
 
+//----------------------------------------------------------------------------
+void vtkDataSet::PrepareForThreadedAccess()
+{
+  this->ComputeBounds();
+}
+
 //----------------------------------------------------------------------------
 // Return a pointer to the geometry bounding box in the form
 // (xmin,xmax, ymin,ymax, zmin,zmax).
@@ -85,7 +85,7 @@ public:
   // Copy point coordinates into user provided array x[3] for specified
   // point id.
   // THIS METHOD IS THREAD SAFE IF FIRST CALLED FROM A SINGLE THREAD AND
-  // THE DATASET IS NOT MODIFIED
+  // THE DATASET IS NOT MODIFIED, see PrepareForThreadedAccess().
   virtual void GetPoint(vtkIdType id, double x[3]);
 
   // Description:
@@ -98,7 +98,7 @@ public:
   // This is a thread-safe alternative to the previous GetCell()
   // method.
   // THIS METHOD IS THREAD SAFE IF FIRST CALLED FROM A SINGLE THREAD AND
-  // THE DATASET IS NOT MODIFIED
+  // THE DATASET IS NOT MODIFIED, see PrepareForThreadedAccess().
   virtual void GetCell(vtkIdType cellId, vtkGenericCell *cell) = 0;
 
   // Description:
@@ -110,13 +110,13 @@ public:
   // is available to all datasets.  Subclasses should override this method
   // to provide an efficient implementation.
   // THIS METHOD IS THREAD SAFE IF FIRST CALLED FROM A SINGLE THREAD AND
-  // THE DATASET IS NOT MODIFIED
+  // THE DATASET IS NOT MODIFIED, see PrepareForThreadedAccess().
   virtual void GetCellBounds(vtkIdType cellId, double bounds[6]);
   
   // Description:
   // Get type of cell with cellId such that: 0 <= cellId < NumberOfCells.
   // THIS METHOD IS THREAD SAFE IF FIRST CALLED FROM A SINGLE THREAD AND
-  // THE DATASET IS NOT MODIFIED
+  // THE DATASET IS NOT MODIFIED, see PrepareForThreadedAccess().
   virtual int GetCellType(vtkIdType cellId) = 0;
 
   // Description:
@@ -132,9 +132,22 @@ public:
   // Description:
   // Topological inquiry to get points defining cell.
   // THIS METHOD IS THREAD SAFE IF FIRST CALLED FROM A SINGLE THREAD AND
-  // THE DATASET IS NOT MODIFIED
+  // THE DATASET IS NOT MODIFIED, see PrepareForThreadedAccess().
   virtual void GetCellPoints(vtkIdType cellId, vtkIdList *ptIds) = 0;
 
+  // Description:
+  // Build up front everything that the read methods of this dataset
+  // would otherwise build on their first call (the bounds, and the cells
+  // of vtkPolyData). Afterwards, and as long as the dataset is not
+  // modified, GetPoint(vtkIdType, double[3]), GetCell(vtkIdType,
+  // vtkGenericCell*), GetCellBounds(), GetCellType(), GetCellPoints() and
+  // GetBounds() only read the dataset, so several threads can call them
+  // at once, each with its own vtkGenericCell and vtkIdList. The links
+  // used by GetPointCells() and GetCellNeighbors() are not built; call
+  // BuildLinks() of vtkPolyData or vtkUnstructuredGrid for that.
+  // THIS METHOD IS NOT THREAD SAFE.
+  virtual void PrepareForThreadedAccess();
+
   // Description:
   // Topological inquiry to get cells using point.
   // THIS METHOD IS THREAD SAFE IF FIRST CALLED FROM A SINGLE THREAD AND
@@ -33,7 +33,9 @@
 #include "vtkInformationVector.h"
 #include "vtkInstantiator.h"
 #include "vtkObjectFactory.h"
+#include "vtkPipelineProfiler.h"
 #include "vtkPointData.h"
+#include "vtkTimerLog.h"
 
 #include <vtkstd/vector>
 
@@ -449,6 +451,67 @@ int vtkDemandDrivenPipeline::UpdateData(int outputPort)
                               this->GetOutputInformation());
 }
 
+//----------------------------------------------------------------------------
+int vtkDemandDrivenPipeline::CallAlgorithm(vtkInformation* request,
+                                           int direction,
+                                           vtkInformationVector** inInfo,
+                                           vtkInformationVector* outInfo)
+{
+  vtkPipelineProfiler* profiler = vtkPipelineProfiler::GetGlobalProfiler();
+  vtkInformationRequestKey* pass =
+    profiler ? this->GetProfiledRequest(request) : 0;
+  if(!pass)
+    {
+    return this->Superclass::CallAlgorithm(request, direction,
+                                           inInfo, outInfo);
+    }
+
+  double startTime = vtkTimerLog::GetUniversalTime();
+  double startCPUTime = vtkTimerLog::GetCPUTime();
+  int result = this->Superclass::CallAlgorithm(request, direction,
+                                               inInfo, outInfo);
+  double wallTime = vtkTimerLog::GetUniversalTime() - startTime;
+  double cpuTime = vtkTimerLog::GetCPUTime() - startCPUTime;
+
+  // Memory held by the outputs that were just generated.
+  unsigned long memory = 0;
+  if(pass == REQUEST_DATA())
+    {
+    for(int i=0; i < outInfo->GetNumberOfInformationObjects(); ++i)
+      {
+      vtkInformation* info = outInfo->GetInformationObject(i);
+      vtkDataObject* data = info->Get(vtkDataObject::DATA_OBJECT());
+      if(data && !info->Get(DATA_NOT_GENERATED()))
+        {
+        memory += data->GetActualMemorySize();
+        }
+      }
+    }
+
+  profiler->RecordPass(this->Algorithm, pass->GetName(), startTime,
+                       wallTime, cpuTime, memory);
+  return result;
+}
+
+//----------------------------------------------------------------------------
+vtkInformationRequestKey*
+vtkDemandDrivenPipeline::GetProfiledRequest(vtkInformation* request)
+{
+  if(request->Has(REQUEST_DATA()))
+    {
+    return REQUEST_DATA();
+    }
+  if(request->Has(REQUEST_INFORMATION()))
+    {
+    return REQUEST_INFORMATION();
+    }
+  if(request->Has(REQUEST_DATA_OBJECT()))
+    {
+    return REQUEST_DATA_OBJECT();
+    }
+  return 0;
+}
+
 //----------------------------------------------------------------------------
 int vtkDemandDrivenPipeline::ExecuteDataObject(vtkInformation* request,
                                                vtkInformationVector** inInfo,
@@ -135,10 +135,23 @@ public:
   // passes when you modification time should not be taken into account.
   static vtkInformationIntegerKey* REQUEST_REGENERATE_INFORMATION();
 
+  // Description:
+  // Invoke the request on the algorithm. When a global
+  // vtkPipelineProfiler is set, the time spent in the algorithm and the
+  // memory used by its outputs are recorded for the passes returned by
+  // GetProfiledRequest().
+  virtual int CallAlgorithm(vtkInformation* request, int direction,
+                            vtkInformationVector** inInfo,
+                            vtkInformationVector* outInfo);
+
 protected:
   vtkDemandDrivenPipeline();
   ~vtkDemandDrivenPipeline();
 
+  // Return the key of the pass made by the given request if it is one
+  // recorded by the pipeline profiler, and NULL otherwise.
+  virtual vtkInformationRequestKey* GetProfiledRequest(vtkInformation* request);
+
   // Helper methods to send requests to the algorithm.
   virtual int ExecuteDataObject(vtkInformation* request,
                                 vtkInformationVector** inInfo,
@@ -621,6 +621,15 @@ void vtkImageData::GetCellBounds(vtkIdType cellId, double bounds[6])
 double *vtkImageData::GetPoint(vtkIdType ptId)
 {
   static double x[3];
+  this->GetPoint(ptId, x);
+  return x;
+}
+
+//----------------------------------------------------------------------------
+// Computes the point straight into x, which keeps this method thread safe
+// unlike the one above.
+void vtkImageData::GetPoint(vtkIdType ptId, double x[3])
+{
   int i, loc[3];
   const double *origin = this->Origin;
   const double *spacing = this->Spacing;
@@ -635,7 +644,7 @@ double *vtkImageData::GetPoint(vtkIdType ptId)
   if (dims[0] == 0 || dims[1] == 0 || dims[2] == 0)
     {
     vtkErrorMacro("Requesting a point from an empty image.");
-    return x;
+    return;
     }
 
   // "loc" holds the point x,y,z indices
@@ -644,7 +653,7 @@ double *vtkImageData::GetPoint(vtkIdType ptId)
   switch (this->DataDescription)
     {
     case VTK_EMPTY:
-      return x;
+      return;
 
     case VTK_SINGLE_POINT:
       break;
@@ -687,8 +696,6 @@ double *vtkImageData::GetPoint(vtkIdType ptId)
     {
     x[i] = origin[i] + (loc[i]+extent[i*2]) * spacing[i];
     }
-
-  return x;
 }
 
 //----------------------------------------------------------------------------
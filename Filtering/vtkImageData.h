@@ -398,13 +398,6 @@ private:
 };
 
 
-//----------------------------------------------------------------------------
-inline void vtkImageData::GetPoint(vtkIdType id, double x[3])
-{
-  const double *p = this->GetPoint(id);
-  x[0] = p[0]; x[1] = p[1]; x[2] = p[2];
-}
-
 //----------------------------------------------------------------------------
 inline vtkIdType vtkImageData::GetNumberOfPoints()
 {
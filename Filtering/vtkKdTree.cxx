@@ -36,6 +36,7 @@
 #include "vtkPoints.h"
 #include "vtkIdTypeArray.h"
 #include "vtkIntArray.h"
+#include "vtkMultiThreader.h"
 #include "vtkPointSet.h"
 #include "vtkImageData.h"
 #include "vtkUniformGrid.h"
@@ -50,6 +51,7 @@
 #include <vtkstd/map>
 #include <vtkstd/queue>
 #include <vtkstd/set>
+#include <vtkstd/vector>
 
 
 // Timing data ---------------------------------------------
@@ -192,6 +194,7 @@ vtkKdTree::vtkKdTree()
 
   this->MinCells = 100;
   this->NumberOfRegions     = 0;
+  this->NumberOfThreads = 1;
 
   this->DataSets = vtkDataSetCollection::New();
 
@@ -357,6 +360,10 @@ void vtkKdTree::SetCalculator(vtkKdNode *kd)
 
   this->BSPCalculator = vtkBSPIntersections::New();
   this->BSPCalculator->SetCuts(this->Cuts);
+
+  // Build the region list now, so that queries only read the calculator
+  // and can run on several threads.
+  this->BSPCalculator->GetNumberOfRegions();
 }
 //----------------------------------------------------------------------------
 void vtkKdTree::SetCuts(vtkBSPCuts *cuts)
@@ -1242,6 +1249,84 @@ int vtkKdTree::DivideTest(int size, int level)
 
   return 1;
 }
+//----------------------------------------------------------------------------
+// Parallel build.  When NumberOfThreads is more than one, the children of
+// regions of at least VTK_KD_TREE_PARALLEL_TASK_SIZE points are divided as
+// two tasks on the vtkMultiThreader thread pool, and regions of at least
+// VTK_KD_TREE_PARALLEL_SELECT_SIZE points are cut by a parallel median
+// find over VTK_KD_TREE_PARALLEL_PIECES pieces of their points.  Smaller
+// regions are divided serially, as before.
+
+#define VTK_KD_TREE_PARALLEL_TASK_SIZE 16384
+#define VTK_KD_TREE_PARALLEL_SELECT_SIZE 262144
+#define VTK_KD_TREE_PARALLEL_PIECES 64
+
+class vtkKdTreeParallelBuild
+{
+public:
+  // Divide the two children of kd, which are at the given level,
+  // concurrently.
+  static void DivideChildren(vtkKdTree *tree, vtkKdNode *kd, float *c1,
+                             int *ids, int level);
+
+  // Same as vtkKdTree::DoMedianFind.  The median is found a radix digit
+  // at a time from histograms of the pieces, then each piece is
+  // partitioned about it and the points still on the wrong side are
+  // exchanged.  The cut and the points on each side are the ones
+  // vtkKdTree::Select gives, since they only depend on the value of the
+  // median, but their order differs.
+  static void MedianFind(vtkKdTree *tree, vtkKdNode *kd, float *c1,
+                         int *ids, int dim1, int dim2, int dim3);
+
+private:
+  struct Piece
+  {
+    int Histogram[2048];
+    int NumberOfLess;
+    float LessMin;
+    float LessMax;
+    float GreaterMax;
+  };
+
+  struct SelectArgs
+  {
+    float *Points;
+    int *Ids;
+    int NumberOfPoints;
+    int Dim;
+    // Digit being counted, and the digits of the median found so far.
+    int Shift;
+    vtkTypeUInt32 DigitMask;
+    vtkTypeUInt32 PrefixMask;
+    vtkTypeUInt32 Prefix;
+    float Median;
+    Piece Pieces[VTK_KD_TREE_PARALLEL_PIECES];
+    // [begin, end) ranges of the points on the wrong side of the median
+    // after the pieces are partitioned, left and right of it.
+    vtkstd::vector<int> LeftRanges;
+    vtkstd::vector<int> RightRanges;
+    int NumberOfMisplaced;
+  };
+
+  struct DivideArgs
+  {
+    vtkKdTree *Tree;
+    vtkKdNode *Nodes[2];
+    float *Points[2];
+    int *Ids[2];
+    int Level;
+  };
+
+  static void Execute(vtkThreadFunctionType method, void *data,
+                      int pieces, int threads);
+  static void GetPieceRange(int n, int piece, int &begin, int &end);
+
+  static VTK_THREAD_RETURN_TYPE DivideChild(void *arg);
+  static VTK_THREAD_RETURN_TYPE CountDigits(void *arg);
+  static VTK_THREAD_RETURN_TYPE Partition(void *arg);
+  static VTK_THREAD_RETURN_TYPE ExchangeMisplaced(void *arg);
+};
+
 //----------------------------------------------------------------------------
 int vtkKdTree::DivideRegion(vtkKdNode *kd, float *c1, int *ids, int level)
 {
@@ -1296,7 +1381,18 @@ int vtkKdTree::DivideRegion(vtkKdNode *kd, float *c1, int *ids, int level)
       }
     }
 
-  this->DoMedianFind(kd, c1, ids, dim1, dim2, dim3);
+  int parallel = (this->NumberOfThreads > 1) &&
+    (kd->GetNumberOfPoints() >= VTK_KD_TREE_PARALLEL_TASK_SIZE);
+
+  if (parallel && 
+      (kd->GetNumberOfPoints() >= VTK_KD_TREE_PARALLEL_SELECT_SIZE))
+    {
+    vtkKdTreeParallelBuild::MedianFind(this, kd, c1, ids, dim1, dim2, dim3);
+    }
+  else
+    {
+    this->DoMedianFind(kd, c1, ids, dim1, dim2, dim3);
+    }
 
   if (kd->GetLeft() == NULL)
     {
@@ -1307,6 +1403,12 @@ int vtkKdTree::DivideRegion(vtkKdNode *kd, float *c1, int *ids, int level)
 
   int *leftIds  = ids;
   int *rightIds = ids ? ids + nleft : NULL;
+
+  if (parallel)
+    {
+    vtkKdTreeParallelBuild::DivideChildren(this, kd, c1, ids, level + 1);
+    return 0;
+    }
   
   this->DivideRegion(kd->GetLeft(), c1, leftIds, level + 1);
   
@@ -1356,6 +1458,15 @@ void vtkKdTree::DoMedianFind(vtkKdNode *kd, float *c1, int *ids,
 
 //----------------------------------------------------------------------------
 void vtkKdTree::AddNewRegions(vtkKdNode *kd, float *c1, int midpt, int dim, double coord)
+{
+  vtkKdTree::AddChildRegions(kd, midpt, dim, coord);
+
+  kd->GetLeft()->SetDataBounds(c1);
+  kd->GetRight()->SetDataBounds(c1 + midpt*3);
+}
+
+//----------------------------------------------------------------------------
+void vtkKdTree::AddChildRegions(vtkKdNode *kd, int midpt, int dim, double coord)
 {
   vtkKdNode *left = vtkKdNode::New();
   vtkKdNode *right = vtkKdNode::New();
@@ -1383,9 +1494,6 @@ void vtkKdTree::AddNewRegions(vtkKdNode *kd, float *c1, int midpt, int dim, doub
      ((dim == vtkKdTree::ZDIM) ? coord : bounds[4]), bounds[5]); 
   
   right->SetNumberOfPoints(nright);
-  
-  left->SetDataBounds(c1);
-  right->SetDataBounds(c1 + nleft*3);
 }
 // Use Floyd & Rivest (1975) to find the median:
 // Given an array X with element indices ranging from L to R, and
@@ -1626,6 +1734,404 @@ void vtkKdTree::_Select(int dim, float *X, int *ids,
     }
 }
 
+//----------------------------------------------------------------------------
+// Map a float to an unsigned integer of the same order, with -0 and +0
+// mapped to the same value, and back.
+static inline vtkTypeUInt32 vtkKdTreeFloatToKey(float v)
+{
+  if (v == 0.0f)
+    {
+    v = 0.0f;
+    }
+  vtkTypeUInt32 u;
+  memcpy(&u, &v, sizeof(u));
+  return (u & 0x80000000u) ? ~u : (u | 0x80000000u);
+}
+
+static inline float vtkKdTreeKeyToFloat(vtkTypeUInt32 key)
+{
+  vtkTypeUInt32 u = (key & 0x80000000u) ? (key & 0x7fffffffu) : ~key;
+  float v;
+  memcpy(&v, &u, sizeof(v));
+  return v;
+}
+
+//----------------------------------------------------------------------------
+void vtkKdTreeParallelBuild::Execute(vtkThreadFunctionType method, void *data,
+                                     int pieces, int threads)
+{
+  vtkMultiThreader *threader = vtkMultiThreader::New();
+  threader->UseThreadPoolOn();
+  threader->SetNumberOfPieces(pieces);
+  threader->SetNumberOfThreads(threads < pieces ? threads : pieces);
+  threader->SetSingleMethod(method, data);
+  threader->SingleMethodExecute();
+  threader->Delete();
+}
+
+//----------------------------------------------------------------------------
+void vtkKdTreeParallelBuild::GetPieceRange(int n, int piece,
+                                           int &begin, int &end)
+{
+  begin = static_cast<int>(static_cast<vtkIdType>(n) * piece /
+                           VTK_KD_TREE_PARALLEL_PIECES);
+  end = static_cast<int>(static_cast<vtkIdType>(n) * (piece + 1) /
+                         VTK_KD_TREE_PARALLEL_PIECES);
+}
+
+//----------------------------------------------------------------------------
+void vtkKdTreeParallelBuild::DivideChildren(vtkKdTree *tree, vtkKdNode *kd,
+                                            float *c1, int *ids, int level)
+{
+  int nleft = kd->GetLeft()->GetNumberOfPoints();
+
+  DivideArgs args;
+  args.Tree = tree;
+  args.Nodes[0] = kd->GetLeft();
+  args.Nodes[1] = kd->GetRight();
+  args.Points[0] = c1;
+  args.Points[1] = c1 + nleft*3;
+  args.Ids[0] = ids;
+  args.Ids[1] = ids ? ids + nleft : NULL;
+  args.Level = level;
+
+  vtkKdTreeParallelBuild::Execute(vtkKdTreeParallelBuild::DivideChild,
+                                  &args, 2, tree->NumberOfThreads);
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkKdTreeParallelBuild::DivideChild(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *info =
+    static_cast<vtkMultiThreader::ThreadInfo *>(arg);
+  DivideArgs *args = static_cast<DivideArgs *>(info->UserData);
+
+  for (int i = info->ThreadID; i < 2; i += info->NumberOfThreads)
+    {
+    args->Tree->DivideRegion(args->Nodes[i], args->Points[i], args->Ids[i],
+                             args->Level);
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+void vtkKdTreeParallelBuild::MedianFind(vtkKdTree *tree, vtkKdNode *kd,
+                                        float *c1, int *ids,
+                                        int dim1, int dim2, int dim3)
+{
+  // The radix digits of the keys, most significant first.
+  static const int shifts[3] = {21, 10, 0};
+  static const int widths[3] = {11, 11, 10};
+
+  int npoints = kd->GetNumberOfPoints();
+  int threads = tree->NumberOfThreads;
+
+  SelectArgs *args = new SelectArgs;
+  args->Points = c1;
+  args->Ids = ids;
+  args->NumberOfPoints = npoints;
+
+  int dims[3];
+  dims[0] = dim1; dims[1] = dim2; dims[2] = dim3;
+
+  int dim, piece;
+
+  for (dim = 0; dim < 3; dim++)
+    {
+    if (dims[dim] < 0)
+      {
+      break;
+      }
+
+    args->Dim = dims[dim];
+    args->PrefixMask = 0;
+    args->Prefix = 0;
+
+    // Find the key of rank npoints/2, the median vtkKdTree::Select
+    // finds, and the number of points below it.
+
+    int rank = npoints / 2;
+    int nleft = 0;
+
+    for (int pass = 0; pass < 3; pass++)
+      {
+      args->Shift = shifts[pass];
+      args->DigitMask = (1u << widths[pass]) - 1;
+
+      vtkKdTreeParallelBuild::Execute(vtkKdTreeParallelBuild::CountDigits,
+                                      args, VTK_KD_TREE_PARALLEL_PIECES,
+                                      threads);
+      int digit;
+      int ndigits = 1 << widths[pass];
+      for (digit = 0; digit < ndigits - 1; digit++)
+        {
+        int count = 0;
+        for (piece = 0; piece < VTK_KD_TREE_PARALLEL_PIECES; piece++)
+          {
+          count += args->Pieces[piece].Histogram[digit];
+          }
+        if (rank < count)
+          {
+          break;
+          }
+        rank -= count;
+        nleft += count;
+        }
+      args->Prefix |= static_cast<vtkTypeUInt32>(digit) << args->Shift;
+      args->PrefixMask |= args->DigitMask << args->Shift;
+      }
+
+    if (nleft == 0)
+      {
+      continue;    // all the points below the median equal it
+      }
+
+    args->Median = vtkKdTreeKeyToFloat(args->Prefix);
+
+    vtkKdTreeParallelBuild::Execute(vtkKdTreeParallelBuild::Partition,
+                                    args, VTK_KD_TREE_PARALLEL_PIECES,
+                                    threads);
+
+    // Each piece is now split about the median.  Pair up the points on
+    // the wrong side of nleft and exchange them.
+
+    args->LeftRanges.clear();
+    args->RightRanges.clear();
+    args->NumberOfMisplaced = 0;
+
+    float leftMin = args->Median;
+    float leftMax = args->Median;
+    float rightMax = args->Median;
+    int haveLeft = 0;
+
+    for (piece = 0; piece < VTK_KD_TREE_PARALLEL_PIECES; piece++)
+      {
+      Piece &p = args->Pieces[piece];
+      int begin, end;
+      vtkKdTreeParallelBuild::GetPieceRange(npoints, piece, begin, end);
+      int split = begin + p.NumberOfLess;
+
+      int rangeEnd = (end < nleft) ? end : nleft;
+      if (split < rangeEnd)
+        {
+        args->LeftRanges.push_back(split);
+        args->LeftRanges.push_back(rangeEnd);
+        args->NumberOfMisplaced += rangeEnd - split;
+        }
+      int rangeBegin = (begin > nleft) ? begin : nleft;
+      if (rangeBegin < split)
+        {
+        args->RightRanges.push_back(rangeBegin);
+        args->RightRanges.push_back(split);
+        }
+
+      if (p.NumberOfLess > 0)
+        {
+        if (!haveLeft || (p.LessMin < leftMin))
+          {
+          leftMin = p.LessMin;
+          }
+        if (!haveLeft || (p.LessMax > leftMax))
+          {
+          leftMax = p.LessMax;
+          }
+        haveLeft = 1;
+        }
+      if ((split < end) && (p.GreaterMax > rightMax))
+        {
+        rightMax = p.GreaterMax;
+        }
+      }
+
+    if (args->NumberOfMisplaced > 0)
+      {
+      vtkKdTreeParallelBuild::Execute(
+        vtkKdTreeParallelBuild::ExchangeMisplaced, args,
+        VTK_KD_TREE_PARALLEL_PIECES, threads);
+      }
+
+    // Same cut and data bounds as vtkKdTree::Select and
+    // vtkKdNode::SetDataBounds(float *) give.
+
+    double coord = (static_cast<double>(args->Median)
+                    + static_cast<double>(leftMax))/2.0;
+
+    kd->SetDim(dims[dim]);
+
+    vtkKdTree::AddChildRegions(kd, nleft, dims[dim], coord);
+
+    double bounds[6];
+    kd->GetDataBounds(bounds);
+    bounds[2*dims[dim]] = leftMin;
+    bounds[2*dims[dim] + 1] = leftMax;
+    kd->GetLeft()->SetDataBounds(bounds[0], bounds[1], bounds[2],
+                                 bounds[3], bounds[4], bounds[5]);
+    bounds[2*dims[dim]] = args->Median;
+    bounds[2*dims[dim] + 1] = rightMax;
+    kd->GetRight()->SetDataBounds(bounds[0], bounds[1], bounds[2],
+                                  bounds[3], bounds[4], bounds[5]);
+
+    break;   // division is fine
+    }
+
+  delete args;
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkKdTreeParallelBuild::CountDigits(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *info =
+    static_cast<vtkMultiThreader::ThreadInfo *>(arg);
+  SelectArgs *args = static_cast<SelectArgs *>(info->UserData);
+
+  const float *X = args->Points + args->Dim;
+  int shift = args->Shift;
+  vtkTypeUInt32 digitMask = args->DigitMask;
+  vtkTypeUInt32 prefixMask = args->PrefixMask;
+  vtkTypeUInt32 prefix = args->Prefix;
+
+  for (int piece = info->ThreadID; piece < VTK_KD_TREE_PARALLEL_PIECES;
+       piece += info->NumberOfThreads)
+    {
+    int *histogram = args->Pieces[piece].Histogram;
+    memset(histogram, 0, (digitMask + 1) * sizeof(int));
+
+    int begin, end;
+    vtkKdTreeParallelBuild::GetPieceRange(args->NumberOfPoints, piece,
+                                          begin, end);
+    for (int i = begin; i < end; i++)
+      {
+      vtkTypeUInt32 key = vtkKdTreeFloatToKey(X[3*i]);
+      if ((key & prefixMask) == prefix)
+        {
+        histogram[(key >> shift) & digitMask]++;
+        }
+      }
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkKdTreeParallelBuild::Partition(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *info =
+    static_cast<vtkMultiThreader::ThreadInfo *>(arg);
+  SelectArgs *args = static_cast<SelectArgs *>(info->UserData);
+
+  float *c1 = args->Points;
+  int *ids = args->Ids;
+  const float *X = c1 + args->Dim;
+  float median = args->Median;
+
+  for (int piece = info->ThreadID; piece < VTK_KD_TREE_PARALLEL_PIECES;
+       piece += info->NumberOfThreads)
+    {
+    Piece &p = args->Pieces[piece];
+    p.LessMin = VTK_FLOAT_MAX;
+    p.LessMax = -VTK_FLOAT_MAX;
+    p.GreaterMax = -VTK_FLOAT_MAX;
+
+    // [begin, I) is below the median, [J, end) is not.
+    int begin, end;
+    vtkKdTreeParallelBuild::GetPieceRange(args->NumberOfPoints, piece,
+                                          begin, end);
+    int I = begin;
+    int J = end;
+    for (;;)
+      {
+      while ((I < J) && (X[3*I] < median))
+        {
+        if (X[3*I] < p.LessMin)
+          {
+          p.LessMin = X[3*I];
+          }
+        if (X[3*I] > p.LessMax)
+          {
+          p.LessMax = X[3*I];
+          }
+        I++;
+        }
+      while ((I < J) && !(X[3*(J-1)] < median))
+        {
+        if (X[3*(J-1)] > p.GreaterMax)
+          {
+          p.GreaterMax = X[3*(J-1)];
+          }
+        J--;
+        }
+      if (I >= J)
+        {
+        break;
+        }
+      Exchange(c1, ids, I, (J-1));
+      }
+    p.NumberOfLess = I - begin;
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+// Position of the k-th point of a list of [begin, end) ranges.
+static void vtkKdTreeSeekRange(const vtkstd::vector<int> &ranges, int k,
+                               size_t &range, int &position)
+{
+  range = 0;
+  while (k >= ranges[range + 1] - ranges[range])
+    {
+    k -= ranges[range + 1] - ranges[range];
+    range += 2;
+    }
+  position = ranges[range] + k;
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkKdTreeParallelBuild::ExchangeMisplaced(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *info =
+    static_cast<vtkMultiThreader::ThreadInfo *>(arg);
+  SelectArgs *args = static_cast<SelectArgs *>(info->UserData);
+
+  float *c1 = args->Points;
+  int *ids = args->Ids;
+  const vtkstd::vector<int> &left = args->LeftRanges;
+  const vtkstd::vector<int> &right = args->RightRanges;
+
+  for (int piece = info->ThreadID; piece < VTK_KD_TREE_PARALLEL_PIECES;
+       piece += info->NumberOfThreads)
+    {
+    int begin, end;
+    vtkKdTreeParallelBuild::GetPieceRange(args->NumberOfMisplaced, piece,
+                                          begin, end);
+    if (begin == end)
+      {
+      continue;
+      }
+
+    // The k-th misplaced point on the left goes where the k-th misplaced
+    // point on the right is.
+    size_t l, r;
+    int I, J;
+    vtkKdTreeSeekRange(left, begin, l, I);
+    vtkKdTreeSeekRange(right, begin, r, J);
+
+    for (int k = begin; k < end; k++)
+      {
+      Exchange(c1, ids, I, J);
+      if ((++I == left[l + 1]) && (l + 2 < left.size()))
+        {
+        l += 2;
+        I = left[l];
+        }
+      if ((++J == right[r + 1]) && (r + 2 < right.size()))
+        {
+        r += 2;
+        J = right[r];
+        }
+      }
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
 //----------------------------------------------------------------------------
 void vtkKdTree::SelfRegister(vtkKdNode *kd)
 {
@@ -2402,12 +2908,8 @@ int vtkKdTree::FindClosestPointInSphere(double x, double y, double z,
     }
   int *regionIds = new int [this->NumberOfRegions];
 
-  this->BSPCalculator->ComputeIntersectionsUsingDataBoundsOn();
-
   int nRegions = 
-    this->BSPCalculator->IntersectsSphere2(regionIds, this->NumberOfRegions, x, y, z, radius*radius);
-
-  this->BSPCalculator->ComputeIntersectionsUsingDataBoundsOff();
+    this->BSPCalculator->IntersectsSphere2(regionIds, this->NumberOfRegions, x, y, z, radius*radius, 1);
 
   double minDistance2 = 4 * this->MaxWidth * this->MaxWidth;
   int localCloseId = -1;
@@ -4778,6 +5280,7 @@ void vtkKdTree::PrintSelf(ostream& os, vtkIndent indent)
 
   os << indent << "ValidDirections: " << this->ValidDirections << endl;
   os << indent << "MinCells: " << this->MinCells << endl;
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << endl;
   os << indent << "NumberOfRegionsOrLess: " << this->NumberOfRegionsOrLess << endl;
   os << indent << "NumberOfRegionsOrMore: " << this->NumberOfRegionsOrMore << endl;
 
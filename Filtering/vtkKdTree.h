@@ -104,6 +104,17 @@ public:
 
   vtkGetMacro(NumberOfRegionsOrMore, int);
   vtkSetMacro(NumberOfRegionsOrMore, int);
+
+  // Description:
+  //   Set/Get the number of threads used to build the k-d tree.  With
+  //   more than one, large regions are divided as separate tasks on the
+  //   vtkMultiThreader thread pool, and the median of the largest regions
+  //   is found and their points partitioned in parallel.  The regions
+  //   are the same as those of a serial build, but the order of the
+  //   points within a region may differ.  Default is 1.
+
+  vtkSetClampMacro(NumberOfThreads, int, 1, VTK_LARGE_INTEGER);
+  vtkGetMacro(NumberOfThreads, int);
   
   // Description:
   //  Some algorithms on k-d trees require a value that is a very
@@ -785,6 +796,13 @@ protected:
   static void AddNewRegions(vtkKdNode *kd, float *c1, 
                             int midpt, int dim, double coord);
 
+  // Description:
+  //   Add the two children of a region cut at coord, with midpt points
+  //   on the left, without computing their data bounds.
+
+  static void AddChildRegions(vtkKdNode *kd, int midpt, int dim,
+                              double coord);
+
   void NewPartitioningRequest(int req);
 
   int NumberOfRegionsOrLess;
@@ -806,6 +824,7 @@ protected:
 
   int MinCells;
   int NumberOfRegions;              // number of leaf nodes
+  int NumberOfThreads;
 
   int Timing;
   double FudgeFactor;   // a very small distance, relative to the dataset's size
@@ -836,6 +855,10 @@ protected:
   vtkBSPCuts *Cuts;
   double Progress;
 
+//BTX
+  friend class vtkKdTreeParallelBuild;
+//ETX
+
   vtkKdTree(const vtkKdTree&); // Not implemented
   void operator=(const vtkKdTree&); // Not implemented
 };
@@ -0,0 +1,326 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkPipelineProfiler.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkPipelineProfiler.h"
+
+#include "vtkAlgorithm.h"
+#include "vtkCriticalSection.h"
+#include "vtkDebugLeaksManager.h" // DebugLeaks exists longer than the profiler.
+#include "vtkMultiThreader.h"
+#include "vtkObjectFactory.h"
+#include "vtkTimerLog.h"
+
+#include <vtkstd/map>
+#include <vtkstd/string>
+#include <vtkstd/utility>
+#include <vtkstd/vector>
+#include <vtksys/ios/sstream>
+
+#include <stdlib.h>
+
+vtkStandardNewMacro(vtkPipelineProfiler);
+
+//----------------------------------------------------------------------------
+struct vtkPipelineProfilerEvent
+{
+  vtkstd::string AlgorithmName;
+  vtkstd::string Pass;
+  double StartTime;
+  double WallTime;
+  double CPUTime;
+  unsigned long Memory;
+  int ExecutionCount;
+  int Thread;
+};
+
+class vtkPipelineProfilerInternals
+{
+public:
+  typedef vtkstd::pair<vtkAlgorithm*, vtkstd::string> CountKey;
+
+  vtkstd::vector<vtkPipelineProfilerEvent> Events;
+  vtkstd::map<CountKey, int> ExecutionCounts;
+  vtkstd::vector<vtkMultiThreaderIDType> Threads;
+  vtkSimpleCriticalSection Lock;
+  double TimeOrigin;
+
+  // Small integer standing for the calling thread in the trace.
+  int GetThreadIndex()
+    {
+    vtkMultiThreaderIDType id = vtkMultiThreader::GetCurrentThreadID();
+    for (size_t i = 0; i < this->Threads.size(); i++)
+      {
+      if (vtkMultiThreader::ThreadsEqual(this->Threads[i], id))
+        {
+        return static_cast<int>(i);
+        }
+      }
+    this->Threads.push_back(id);
+    return static_cast<int>(this->Threads.size()) - 1;
+    }
+};
+
+//----------------------------------------------------------------------------
+// The global profiler. The environment is looked at the first time it is
+// asked for, and the profiler created for VTK_PIPELINE_PROFILE is deleted,
+// which writes the trace, when the application exits.
+static vtkPipelineProfiler *vtkPipelineProfilerGlobal = 0;
+static int vtkPipelineProfilerGlobalInitialized = 0;
+
+class vtkPipelineProfilerCleanup
+{
+public:
+  ~vtkPipelineProfilerCleanup()
+    {
+    vtkPipelineProfiler::SetGlobalProfiler(0);
+    }
+};
+static vtkPipelineProfilerCleanup vtkPipelineProfilerCleanupInstance;
+
+//----------------------------------------------------------------------------
+vtkPipelineProfiler *vtkPipelineProfiler::GetGlobalProfiler()
+{
+  if (!vtkPipelineProfilerGlobalInitialized)
+    {
+    vtkPipelineProfilerGlobalInitialized = 1;
+    const char *fileName = getenv("VTK_PIPELINE_PROFILE");
+    if (fileName && *fileName)
+      {
+      vtkPipelineProfilerGlobal = vtkPipelineProfiler::New();
+      vtkPipelineProfilerGlobal->SetTraceFileName(fileName);
+      }
+    }
+  return vtkPipelineProfilerGlobal;
+}
+
+//----------------------------------------------------------------------------
+void vtkPipelineProfiler::SetGlobalProfiler(vtkPipelineProfiler *profiler)
+{
+  vtkPipelineProfilerGlobalInitialized = 1;
+  if (profiler == vtkPipelineProfilerGlobal)
+    {
+    return;
+    }
+  if (profiler)
+    {
+    profiler->Register(0);
+    }
+  vtkPipelineProfiler *old = vtkPipelineProfilerGlobal;
+  vtkPipelineProfilerGlobal = profiler;
+  if (old)
+    {
+    old->UnRegister(0);
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkPipelineProfiler::vtkPipelineProfiler()
+{
+  this->TraceFileName = 0;
+  this->Internals = new vtkPipelineProfilerInternals;
+  this->Internals->TimeOrigin = vtkTimerLog::GetUniversalTime();
+}
+
+//----------------------------------------------------------------------------
+vtkPipelineProfiler::~vtkPipelineProfiler()
+{
+  if (this->TraceFileName && !this->WriteChromeTrace(this->TraceFileName))
+    {
+    vtkErrorMacro("Could not write the pipeline trace to "
+                  << this->TraceFileName);
+    }
+  this->SetTraceFileName(0);
+  delete this->Internals;
+}
+
+//----------------------------------------------------------------------------
+void vtkPipelineProfiler::RecordPass(vtkAlgorithm *algorithm,
+                                     const char *pass, double startTime,
+                                     double wallTime, double cpuTime,
+                                     unsigned long memory)
+{
+  vtksys_ios::ostringstream name;
+  name << algorithm->GetClassName() << "(" << algorithm << ")";
+
+  vtkPipelineProfilerEvent event;
+  event.AlgorithmName = name.str();
+  event.Pass = pass;
+  event.StartTime = startTime;
+  event.WallTime = wallTime;
+  event.CPUTime = cpuTime;
+  event.Memory = memory;
+
+  this->Internals->Lock.Lock();
+  event.ExecutionCount = ++this->Internals->ExecutionCounts[
+    vtkPipelineProfilerInternals::CountKey(algorithm, event.Pass)];
+  event.Thread = this->Internals->GetThreadIndex();
+  this->Internals->Events.push_back(event);
+  this->Internals->Lock.Unlock();
+}
+
+//----------------------------------------------------------------------------
+int vtkPipelineProfiler::GetNumberOfEvents()
+{
+  return static_cast<int>(this->Internals->Events.size());
+}
+
+//----------------------------------------------------------------------------
+const char *vtkPipelineProfiler::GetEventAlgorithmName(int i)
+{
+  return this->Internals->Events[i].AlgorithmName.c_str();
+}
+
+//----------------------------------------------------------------------------
+const char *vtkPipelineProfiler::GetEventPass(int i)
+{
+  return this->Internals->Events[i].Pass.c_str();
+}
+
+//----------------------------------------------------------------------------
+double vtkPipelineProfiler::GetEventStartTime(int i)
+{
+  return this->Internals->Events[i].StartTime;
+}
+
+//----------------------------------------------------------------------------
+double vtkPipelineProfiler::GetEventWallTime(int i)
+{
+  return this->Internals->Events[i].WallTime;
+}
+
+//----------------------------------------------------------------------------
+double vtkPipelineProfiler::GetEventCPUTime(int i)
+{
+  return this->Internals->Events[i].CPUTime;
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkPipelineProfiler::GetEventMemory(int i)
+{
+  return this->Internals->Events[i].Memory;
+}
+
+//----------------------------------------------------------------------------
+int vtkPipelineProfiler::GetEventExecutionCount(int i)
+{
+  return this->Internals->Events[i].ExecutionCount;
+}
+
+//----------------------------------------------------------------------------
+int vtkPipelineProfiler::GetExecutionCount(vtkAlgorithm *algorithm,
+                                           const char *pass)
+{
+  vtkstd::map<vtkPipelineProfilerInternals::CountKey, int>::iterator i =
+    this->Internals->ExecutionCounts.find(
+      vtkPipelineProfilerInternals::CountKey(algorithm, pass));
+  return i == this->Internals->ExecutionCounts.end() ? 0 : i->second;
+}
+
+//----------------------------------------------------------------------------
+void vtkPipelineProfiler::Clear()
+{
+  this->Internals->Lock.Lock();
+  this->Internals->Events.clear();
+  this->Internals->ExecutionCounts.clear();
+  this->Internals->TimeOrigin = vtkTimerLog::GetUniversalTime();
+  this->Internals->Lock.Unlock();
+}
+
+//----------------------------------------------------------------------------
+// Each event is a complete ("X") event, with times in microseconds since
+// the creation of the profiler or the last Clear().
+void vtkPipelineProfiler::WriteChromeTrace(ostream& os)
+{
+  os << "{\"traceEvents\":[";
+  for (size_t i = 0; i < this->Internals->Events.size(); i++)
+    {
+    const vtkPipelineProfilerEvent &e = this->Internals->Events[i];
+    vtksys_ios::ostringstream event;
+    event.setf(ios::fixed, ios::floatfield);
+    event.precision(3);
+    event << (i ? ",\n" : "\n")
+          << "{\"name\":\"" << e.AlgorithmName << "\","
+          << "\"cat\":\"" << e.Pass << "\",\"ph\":\"X\","
+          << "\"ts\":" << 1.0e6*(e.StartTime - this->Internals->TimeOrigin)
+          << ",\"dur\":" << 1.0e6*e.WallTime
+          << ",\"pid\":0,\"tid\":" << e.Thread
+          << ",\"args\":{\"pass\":\"" << e.Pass << "\","
+          << "\"cpu_ms\":" << 1.0e3*e.CPUTime << ","
+          << "\"memory_kb\":" << e.Memory << ","
+          << "\"execution\":" << e.ExecutionCount << "}}";
+    os << event.str().c_str();
+    }
+  os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+//----------------------------------------------------------------------------
+int vtkPipelineProfiler::WriteChromeTrace(const char *fileName)
+{
+  ofstream os(fileName, ios::out);
+  if (!os)
+    {
+    return 0;
+    }
+  this->WriteChromeTrace(os);
+  return os ? 1 : 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkPipelineProfiler::PrintSummary(ostream& os)
+{
+  // Totals per algorithm and pass, in the order algorithms first appear.
+  typedef vtkstd::pair<vtkstd::string, vtkstd::string> Key;
+  vtkstd::vector<Key> order;
+  vtkstd::map<Key, vtkPipelineProfilerEvent> totals;
+  for (size_t i = 0; i < this->Internals->Events.size(); i++)
+    {
+    const vtkPipelineProfilerEvent &e = this->Internals->Events[i];
+    Key key(e.AlgorithmName, e.Pass);
+    vtkstd::map<Key, vtkPipelineProfilerEvent>::iterator t =
+      totals.find(key);
+    if (t == totals.end())
+      {
+      order.push_back(key);
+      totals[key] = e;
+      }
+    else
+      {
+      t->second.WallTime += e.WallTime;
+      t->second.CPUTime += e.CPUTime;
+      t->second.Memory = e.Memory;
+      t->second.ExecutionCount = e.ExecutionCount;
+      }
+    }
+  for (size_t i = 0; i < order.size(); i++)
+    {
+    const vtkPipelineProfilerEvent &t = totals[order[i]];
+    os << t.AlgorithmName << " " << t.Pass << ": "
+       << t.ExecutionCount << " executions, "
+       << t.WallTime << " s wall, " << t.CPUTime << " s CPU";
+    if (t.Memory)
+      {
+      os << ", " << t.Memory << " kB output";
+      }
+    os << endl;
+    }
+}
+
+//----------------------------------------------------------------------------
+void vtkPipelineProfiler::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+  os << indent << "TraceFileName: "
+     << (this->TraceFileName ? this->TraceFileName : "(none)") << "\n";
+  os << indent << "NumberOfEvents: " << this->GetNumberOfEvents() << "\n";
+}
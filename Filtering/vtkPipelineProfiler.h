@@ -0,0 +1,119 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkPipelineProfiler.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkPipelineProfiler - record the cost of every pipeline pass
+// .SECTION Description
+// vtkPipelineProfiler collects one event each time an executive derived
+// from vtkDemandDrivenPipeline invokes an algorithm for one of the
+// REQUEST_DATA_OBJECT, REQUEST_INFORMATION, REQUEST_UPDATE_EXTENT or
+// REQUEST_DATA passes. An event holds the wall time and the process CPU
+// time spent in the algorithm, the memory used by its outputs after a
+// REQUEST_DATA pass and the number of times the algorithm has executed
+// that pass so far. Time spent in upstream algorithms is not included
+// since those execute before the request reaches the algorithm.
+//
+// Profiling is off until a global profiler is set with
+// SetGlobalProfiler(). Setting the environment variable
+// VTK_PIPELINE_PROFILE to a file name profiles a whole application
+// without code changes: a global profiler is then created on the first
+// pipeline request and writes its events to that file, in the Chrome
+// trace event format, when the application exits. The file can be
+// loaded in chrome://tracing.
+//
+// .SECTION See Also
+// vtkDemandDrivenPipeline vtkTimerLog
+
+#ifndef __vtkPipelineProfiler_h
+#define __vtkPipelineProfiler_h
+
+#include "vtkObject.h"
+
+class vtkAlgorithm;
+class vtkPipelineProfilerInternals;
+
+class VTK_FILTERING_EXPORT vtkPipelineProfiler : public vtkObject
+{
+public:
+  static vtkPipelineProfiler *New();
+  vtkTypeMacro(vtkPipelineProfiler,vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  // Description:
+  // Set/Get the profiler used by all executives. NULL, the default unless
+  // VTK_PIPELINE_PROFILE is set, turns profiling off.
+  static vtkPipelineProfiler *GetGlobalProfiler();
+  static void SetGlobalProfiler(vtkPipelineProfiler *profiler);
+
+  // Description:
+  // Name of a file the events are written to, as a Chrome trace, when the
+  // profiler is destroyed. Nothing is written when it is NULL (the
+  // default).
+  vtkSetStringMacro(TraceFileName);
+  vtkGetStringMacro(TraceFileName);
+
+  // Description:
+  // Record an event. Called by the executives: startTime is the wall time
+  // at which the pass started, as returned by
+  // vtkTimerLog::GetUniversalTime(), wallTime and cpuTime are in seconds
+  // and memory is in kilobytes. This method is thread safe.
+  void RecordPass(vtkAlgorithm *algorithm, const char *pass,
+                  double startTime, double wallTime, double cpuTime,
+                  unsigned long memory);
+
+  // Description:
+  // Access the recorded events, in the order in which the passes ended.
+  int GetNumberOfEvents();
+  const char *GetEventAlgorithmName(int i);
+  const char *GetEventPass(int i);
+  double GetEventStartTime(int i);
+  double GetEventWallTime(int i);
+  double GetEventCPUTime(int i);
+  unsigned long GetEventMemory(int i);
+  int GetEventExecutionCount(int i);
+
+  // Description:
+  // Return the number of times the given algorithm has executed the given
+  // pass since the last Clear().
+  int GetExecutionCount(vtkAlgorithm *algorithm, const char *pass);
+
+  // Description:
+  // Remove all events and reset the execution counts and the time origin
+  // of the trace.
+  void Clear();
+
+  // Description:
+  // Write the events in the Chrome trace event format. Returns 0 if the
+  // file cannot be written.
+  void WriteChromeTrace(ostream& os);
+  int WriteChromeTrace(const char *fileName);
+
+  // Description:
+  // Print, for each algorithm, the number of executions and the total
+  // time spent in each pass.
+  void PrintSummary(ostream& os);
+
+protected:
+  vtkPipelineProfiler();
+  ~vtkPipelineProfiler();
+
+  char *TraceFileName;
+
+  vtkPipelineProfilerInternals *Internals;
+
+private:
+  vtkPipelineProfiler(const vtkPipelineProfiler&);  // Not implemented.
+  void operator=(const vtkPipelineProfiler&);  // Not implemented.
+};
+
+#endif
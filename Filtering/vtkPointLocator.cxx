@@ -21,6 +21,10 @@
 #include "vtkObjectFactory.h"
 #include "vtkPolyData.h"
 
+#include <vtkstd/algorithm>
+#include <vtkstd/utility>
+#include <vtkstd/vector>
+
 vtkStandardNewMacro(vtkPointLocator);
 
 static const int VTK_INITIAL_SIZE=1000;
@@ -90,6 +94,63 @@ protected:
 };
 
 
+// Return the index of the bucket containing x, for buckets dividing the
+// given bounds in ndivs.
+static inline vtkIdType vtkPointLocatorGetBucket(const double x[3],
+                                                 const double bounds[6],
+                                                 const int ndivs[3])
+{
+  int ijk[3];
+  for (int j=0; j<3; j++)
+    {
+    ijk[j] = static_cast<int>(
+      static_cast<double>((x[j] - bounds[2*j]) / (bounds[2*j+1] - bounds[2*j]))
+      * ndivs[j]);
+    if (ijk[j] >= ndivs[j])
+      {
+      ijk[j] = ndivs[j] - 1;
+      }
+    }
+  return ijk[0] + ijk[1]*ndivs[0] +
+    ijk[2]*static_cast<vtkIdType>(ndivs[0])*ndivs[1];
+}
+
+// Compute the position of each bucket when the buckets are ordered along
+// a Morton (Z-order) curve through their i-j-k indices, so that buckets
+// close in space are mostly close in memory.
+static void vtkPointLocatorMortonOrder(const int ndivs[3], vtkIdType *order)
+{
+  typedef vtkstd::pair<vtkTypeUInt64, vtkIdType> CodeType;
+  vtkstd::vector<CodeType> codes;
+  codes.reserve(static_cast<vtkIdType>(ndivs[0])*ndivs[1]*ndivs[2]);
+  int ijk[3];
+  for (ijk[2]=0; ijk[2] < ndivs[2]; ijk[2]++)
+    {
+    for (ijk[1]=0; ijk[1] < ndivs[1]; ijk[1]++)
+      {
+      for (ijk[0]=0; ijk[0] < ndivs[0]; ijk[0]++)
+        {
+        // Interleave the bits of i, j and k.
+        vtkTypeUInt64 code = 0;
+        for (int bit=0; bit < 21; bit++)
+          {
+          for (int j=0; j<3; j++)
+            {
+            code |= static_cast<vtkTypeUInt64>((ijk[j] >> bit) & 1)
+              << (3*bit + j);
+            }
+          }
+        codes.push_back(CodeType(code, static_cast<vtkIdType>(codes.size())));
+        }
+      }
+    }
+  vtkstd::sort(codes.begin(), codes.end());
+  for (size_t pos=0; pos < codes.size(); pos++)
+    {
+    order[codes[pos].second] = static_cast<vtkIdType>(pos);
+    }
+}
+
 // Construct with automatic computation of divisions, averaging
 // 25 points per bucket.
 vtkPointLocator::vtkPointLocator()
@@ -99,6 +160,11 @@ vtkPointLocator::vtkPointLocator()
   this->Divisions[0] = this->Divisions[1] = this->Divisions[2] = 50;
   this->NumberOfPointsPerBucket = 3;
   this->HashTable = NULL;
+  this->BucketPoints = NULL;
+  this->BucketOffsets = NULL;
+  this->BucketOrder = NULL;
+  this->BucketList = NULL;
+  this->MortonOrder = 0;
   this->NumberOfBuckets = 0;
   this->H[0] = this->H[1] = this->H[2] = 0.0;
   this->InsertionPointId = 0;
@@ -114,6 +180,10 @@ vtkPointLocator::~vtkPointLocator()
     this->Points = NULL;
     }
   this->FreeSearchStructure();
+  if ( this->BucketList )
+    {
+    this->BucketList->Delete();
+    }
 }
 
 void vtkPointLocator::Initialize()
@@ -128,21 +198,52 @@ void vtkPointLocator::Initialize()
 
 void vtkPointLocator::FreeSearchStructure()
 {
-  vtkIdList *ptIds;
+  vtkIdList *bucket;
   vtkIdType i;
 
   if ( this->HashTable )
     {
     for (i=0; i<this->NumberOfBuckets; i++)
       {
-      if ( (ptIds = this->HashTable[i]) )
+      if ( (bucket = this->HashTable[i]) )
         {
-        ptIds->Delete();
+        bucket->Delete();
         }
       }
     delete [] this->HashTable;
     this->HashTable = NULL;
     }
+  delete [] this->BucketPoints;
+  this->BucketPoints = NULL;
+  delete [] this->BucketOffsets;
+  this->BucketOffsets = NULL;
+  delete [] this->BucketOrder;
+  this->BucketOrder = NULL;
+}
+
+// Return the number of points in bucket idx, and their ids in ptIds.
+inline vtkIdType vtkPointLocator::GetBucketPoints(vtkIdType idx,
+                                                  const vtkIdType *&ptIds)
+{
+  if ( this->BucketOffsets )
+    {
+    vtkIdType pos = this->BucketOrder ? this->BucketOrder[idx] : idx;
+    ptIds = this->BucketPoints + this->BucketOffsets[pos];
+    return this->BucketOffsets[pos+1] - this->BucketOffsets[pos];
+    }
+  vtkIdList *bucket = this->HashTable[idx];
+  if ( ! bucket )
+    {
+    return 0;
+    }
+  ptIds = bucket->GetPointer(0);
+  return bucket->GetNumberOfIds();
+}
+
+inline vtkIdType vtkPointLocator::GetBucketSize(vtkIdType idx)
+{
+  const vtkIdType *ptIds;
+  return this->GetBucketPoints(idx, ptIds);
 }
 
 // Given a position x, return the id of the point closest to it.
@@ -154,7 +255,8 @@ vtkIdType vtkPointLocator::FindClosestPoint(const double x[3])
   double pt[3];
   int closest, level;
   vtkIdType ptId, cno;
-  vtkIdList *ptIds;
+  const vtkIdType *ptIds;
+  vtkIdType numIds;
   int ijk[3], *nei;
   vtkNeighborPoints buckets;
 
@@ -200,11 +302,11 @@ vtkIdType vtkPointLocator::FindClosestPoint(const double x[3])
       cno = nei[0] + nei[1]*this->Divisions[0] + 
             nei[2]*this->Divisions[0]*this->Divisions[1];
 
-      if ( (ptIds = this->HashTable[cno]) != NULL )
+      if ( (numIds = this->GetBucketPoints(cno, ptIds)) > 0 )
         {
-        for (j=0; j < ptIds->GetNumberOfIds(); j++) 
+        for (j=0; j < numIds; j++) 
           {
-          ptId = ptIds->GetId(j);
+          ptId = ptIds[j];
           this->DataSet->GetPoint(ptId, pt);
           if ( (dist2 = vtkMath::Distance2BetweenPoints(x,pt)) < minDist2 ) 
             {
@@ -229,11 +331,11 @@ vtkIdType vtkPointLocator::FindClosestPoint(const double x[3])
       cno = nei[0] + nei[1]*this->Divisions[0] + 
             nei[2]*this->Divisions[0]*this->Divisions[1];
 
-      if ( (ptIds = this->HashTable[cno]) != NULL )
+      if ( (numIds = this->GetBucketPoints(cno, ptIds)) > 0 )
         {
-        for (j=0; j < ptIds->GetNumberOfIds(); j++) 
+        for (j=0; j < numIds; j++) 
           {
-          ptId = ptIds->GetId(j);
+          ptId = ptIds[j];
           this->DataSet->GetPoint(ptId, pt);
           if ( (dist2 = vtkMath::Distance2BetweenPoints(x,pt)) < minDist2 ) 
             {
@@ -263,8 +365,9 @@ vtkIdType vtkPointLocator::FindClosestPointWithinRadius(double radius,
 {
   int i, j;
   double pt[3];
-  vtkIdType ptId, closest = -1;
-  vtkIdList *ptIds;
+  vtkIdType ptId, cno, closest = -1;
+  const vtkIdType *ptIds;
+  vtkIdType numIds;
   int ijk[3], *nei;
   double minDist2;
   
@@ -305,12 +408,13 @@ vtkIdType vtkPointLocator::FindClosestPointWithinRadius(double radius,
 
   // Start by searching the bucket that the point is in.
   //
-  if ( (ptIds = this->HashTable[ijk[0] + ijk[1]*this->Divisions[0] + 
-    ijk[2]*this->Divisions[0]*this->Divisions[1]]) != NULL )
+  cno = ijk[0] + ijk[1]*this->Divisions[0] +
+    ijk[2]*this->Divisions[0]*this->Divisions[1];
+  if ( (numIds = this->GetBucketPoints(cno, ptIds)) > 0 )
     {
-    for (j=0; j < ptIds->GetNumberOfIds(); j++) 
+    for (j=0; j < numIds; j++) 
       {
-      ptId = ptIds->GetId(j);
+      ptId = ptIds[j];
       if (flag)
         {
         pointData->GetTuple(ptId, pt);
@@ -399,12 +503,12 @@ vtkIdType vtkPointLocator::FindClosestPointWithinRadius(double radius,
       // do we still need to test this bucket?
       if (this->Distance2ToBucket(x, nei) < refinedRadius2)
         {
-        ptIds = this->HashTable[nei[0] + nei[1]*this->Divisions[0] + 
-          nei[2]*numberOfBucketsPerPlane];
+        numIds = this->GetBucketPoints(nei[0] + nei[1]*this->Divisions[0] +
+                                       nei[2]*numberOfBucketsPerPlane, ptIds);
 
-        for (j=0; j < ptIds->GetNumberOfIds(); j++) 
+        for (j=0; j < numIds; j++) 
           {
-          ptId = ptIds->GetId(j);
+          ptId = ptIds[j];
           if (flag)
             {
             pointData->GetTuple(ptId, pt);
@@ -555,7 +659,8 @@ void vtkPointLocator::FindDistributedPoints(int N, const double x[3],
   double pt[3];
   int level;
   vtkIdType ptId, cno;
-  vtkIdList *ptIds;
+  const vtkIdType *ptIds;
+  vtkIdType numIds;
   int ijk[3], *nei;
   int oct;
   int pointsChecked = 0;
@@ -614,12 +719,12 @@ void vtkPointLocator::FindDistributedPoints(int N, const double x[3],
       cno = nei[0] + nei[1]*this->Divisions[0] + 
             nei[2]*this->Divisions[0]*this->Divisions[1];
 
-      if ( (ptIds = this->HashTable[cno]) != NULL )
+      if ( (numIds = this->GetBucketPoints(cno, ptIds)) > 0 )
         {
-        for (j=0; j < ptIds->GetNumberOfIds(); j++) 
+        for (j=0; j < numIds; j++) 
           {
           pointsChecked++;
-          ptId = ptIds->GetId(j);
+          ptId = ptIds[j];
           this->DataSet->GetPoint(ptId, pt);
           dist2 = vtkMath::Distance2BetweenPoints(x,pt);
           oct = GetOctent(x,pt);
@@ -669,12 +774,12 @@ void vtkPointLocator::FindDistributedPoints(int N, const double x[3],
     cno = nei[0] + nei[1]*this->Divisions[0] + 
       nei[2]*this->Divisions[0]*this->Divisions[1];
     
-    if ( (ptIds = this->HashTable[cno]) != NULL )
+    if ( (numIds = this->GetBucketPoints(cno, ptIds)) > 0 )
       {
-      for (j=0; j < ptIds->GetNumberOfIds(); j++) 
+      for (j=0; j < numIds; j++) 
         {
         pointsChecked++;
-        ptId = ptIds->GetId(j);
+        ptId = ptIds[j];
         this->DataSet->GetPoint(ptId, pt);
         dist2 = vtkMath::Distance2BetweenPoints(x,pt);
         oct = GetOctent(x,pt);
@@ -708,7 +813,8 @@ void vtkPointLocator::FindClosestNPoints(int N, const double x[3],
   double pt[3];
   int level;
   vtkIdType ptId, cno;
-  vtkIdList *ptIds;
+  const vtkIdType *ptIds;
+  vtkIdType numIds;
   int ijk[3], *nei;
   vtkNeighborPoints buckets;
   
@@ -753,11 +859,11 @@ void vtkPointLocator::FindClosestNPoints(int N, const double x[3],
       cno = nei[0] + nei[1]*this->Divisions[0] + 
             nei[2]*this->Divisions[0]*this->Divisions[1];
 
-      if ( (ptIds = this->HashTable[cno]) != NULL )
+      if ( (numIds = this->GetBucketPoints(cno, ptIds)) > 0 )
         {
-        for (j=0; j < ptIds->GetNumberOfIds(); j++) 
+        for (j=0; j < numIds; j++) 
           {
-          ptId = ptIds->GetId(j);
+          ptId = ptIds[j];
           this->DataSet->GetPoint(ptId, pt);
           dist2 = vtkMath::Distance2BetweenPoints(x,pt);
           if (currentCount < N)
@@ -800,11 +906,11 @@ void vtkPointLocator::FindClosestNPoints(int N, const double x[3],
     cno = nei[0] + nei[1]*this->Divisions[0] + 
       nei[2]*this->Divisions[0]*this->Divisions[1];
     
-    if ( (ptIds = this->HashTable[cno]) != NULL )
+    if ( (numIds = this->GetBucketPoints(cno, ptIds)) > 0 )
       {
-      for (j=0; j < ptIds->GetNumberOfIds(); j++) 
+      for (j=0; j < numIds; j++) 
         {
-        ptId = ptIds->GetId(j);
+        ptId = ptIds[j];
         this->DataSet->GetPoint(ptId, pt);
         dist2 = vtkMath::Distance2BetweenPoints(x,pt);
         if (dist2 < maxDistance)
@@ -835,7 +941,8 @@ void vtkPointLocator::FindPointsWithinRadius(double R, const double x[3],
   double dist2;
   double pt[3];
   vtkIdType ptId, cno;
-  vtkIdList *ptIds;
+  const vtkIdType *ptIds;
+  vtkIdType numIds;
   int ijk[3], *nei;
   double R2 = R*R;
   vtkNeighborPoints buckets;
@@ -874,11 +981,11 @@ void vtkPointLocator::FindPointsWithinRadius(double R, const double x[3],
     cno = nei[0] + nei[1]*this->Divisions[0] + 
       nei[2]*this->Divisions[0]*this->Divisions[1];
     
-    if ( (ptIds = this->HashTable[cno]) != NULL )
+    if ( (numIds = this->GetBucketPoints(cno, ptIds)) > 0 )
       {
-      for (j=0; j < ptIds->GetNumberOfIds(); j++) 
+      for (j=0; j < numIds; j++) 
         {
-        ptId = ptIds->GetId(j);
+        ptId = ptIds[j];
         this->DataSet->GetPoint(ptId, pt);
         dist2 = vtkMath::Distance2BetweenPoints(x,pt);
         if (dist2 <= R2)
@@ -901,15 +1008,13 @@ void vtkPointLocator::BuildLocator()
   double *bounds;
   vtkIdType numBuckets;
   double level;
-  int ndivs[3], product;
-  int i, j, ijk[3];
-  vtkIdType idx;
-  vtkIdList *bucket;
+  int ndivs[3];
+  int i;
+  vtkIdType idx, pos, ptId;
   vtkIdType numPts;
   double x[3];
-  typedef vtkIdList *vtkIdListPtr;
 
-  if ( (this->HashTable != NULL) && (this->BuildTime > this->MTime)
+  if ( (this->BucketOffsets != NULL) && (this->BuildTime > this->MTime)
        && (this->BuildTime > this->DataSet->GetMTime()) )
     {
     return;
@@ -926,10 +1031,7 @@ void vtkPointLocator::BuildLocator()
   //
   //  Make sure the appropriate data is available
   //
-  if ( this->HashTable )
-    {
-    this->FreeSearchStructure();
-    }
+  this->FreeSearchStructure();
   //
   //  Size the root bucket.  Initialize bucket data structure, compute 
   //  level and divisions.
@@ -969,9 +1071,8 @@ void vtkPointLocator::BuildLocator()
     this->Divisions[i] = ndivs[i];
     }
 
-  this->NumberOfBuckets = numBuckets = ndivs[0]*ndivs[1]*ndivs[2];
-  this->HashTable = new vtkIdListPtr[numBuckets];
-  memset (this->HashTable, 0, numBuckets*sizeof(vtkIdListPtr));
+  this->NumberOfBuckets = numBuckets =
+    static_cast<vtkIdType>(ndivs[0])*ndivs[1]*ndivs[2];
   //
   //  Compute width of bucket in three directions
   //
@@ -980,37 +1081,41 @@ void vtkPointLocator::BuildLocator()
     this->H[i] = (this->Bounds[2*i+1] - this->Bounds[2*i]) / ndivs[i] ;
     }
   //
-  //  Insert each point into the appropriate bucket.  Make sure point
-  //  falls within bucket.
+  //  Sort the point ids by bucket with a counting sort: count the points
+  //  in each bucket, turn the counts into offsets, then place the ids.
+  //  The ids of each bucket stay in increasing order.
   //
-  product = ndivs[0]*ndivs[1];
-  for (i=0; i<numPts; i++) 
+  if ( this->MortonOrder )
     {
-    this->DataSet->GetPoint(i, x);
-    for (j=0; j<3; j++) 
-      {
-      ijk[j] = static_cast<int>(
-        static_cast<double>((x[j] - this->Bounds[2*j]) / 
-                            (this->Bounds[2*j+1] - this->Bounds[2*j]))
-        * ndivs[j]);
-      
-      if (ijk[j] >= this->Divisions[j])
-        {
-        ijk[j] = this->Divisions[j] - 1;
-        }
-      }
-
-    idx = ijk[0] + ijk[1]*ndivs[0] + ijk[2]*product;
-    bucket = this->HashTable[idx];
-    if ( ! bucket )
-      {
-      bucket = vtkIdList::New();
-      bucket->Allocate(this->NumberOfPointsPerBucket,
-                       this->NumberOfPointsPerBucket/3);
-      this->HashTable[idx] = bucket;
-      }
-    bucket->InsertNextId(i);
+    this->BucketOrder = new vtkIdType[numBuckets];
+    vtkPointLocatorMortonOrder(ndivs, this->BucketOrder);
+    }
+  this->BucketOffsets = new vtkIdType[numBuckets+1];
+  memset (this->BucketOffsets, 0, (numBuckets+1)*sizeof(vtkIdType));
+  this->BucketPoints = new vtkIdType[numPts];
+  for (ptId=0; ptId<numPts; ptId++) 
+    {
+    this->DataSet->GetPoint(ptId, x);
+    idx = vtkPointLocatorGetBucket(x, this->Bounds, ndivs);
+    pos = this->BucketOrder ? this->BucketOrder[idx] : idx;
+    this->BucketOffsets[pos+1]++;
+    }
+  for (pos=0; pos<numBuckets; pos++)
+    {
+    this->BucketOffsets[pos+1] += this->BucketOffsets[pos];
     }
+  // Placing the ids moves each offset to the end of its bucket, which is
+  // the start of the next one.
+  for (ptId=0; ptId<numPts; ptId++) 
+    {
+    this->DataSet->GetPoint(ptId, x);
+    idx = vtkPointLocatorGetBucket(x, this->Bounds, ndivs);
+    pos = this->BucketOrder ? this->BucketOrder[idx] : idx;
+    this->BucketPoints[this->BucketOffsets[pos]++] = ptId;
+    }
+  memmove (this->BucketOffsets+1, this->BucketOffsets,
+           numBuckets*sizeof(vtkIdType));
+  this->BucketOffsets[0] = 0;
 
   this->BuildTime.Modified();
 }
@@ -1204,7 +1309,7 @@ void vtkPointLocator::GetOverlappingBuckets(vtkNeighborPoints* buckets,
           continue;
           }
         // if this bucket has any cells, add it to the list
-        if (this->HashTable[i + jFactor + kFactor])
+        if (this->GetBucketSize(i + jFactor + kFactor))
           {
           nei[0]=i; nei[1]=j; nei[2]=k;
           buckets->InsertNextPoint(nei);
@@ -1246,10 +1351,7 @@ int vtkPointLocator::InitPointInsertion(vtkPoints *newPts,
   double level;
 
   this->InsertionPointId = 0;
-  if ( this->HashTable )
-    {
-    this->FreeSearchStructure();
-    }
+  this->FreeSearchStructure();
   if ( newPts == NULL )
     {
     vtkErrorMacro(<<"Must define points for point insertion");
@@ -1435,7 +1537,8 @@ vtkIdType vtkPointLocator::IsInsertedPoint(const double x[3])
   //
   int *nei, lvtk;
   vtkIdType ptId, cno;
-  vtkIdList *ptIds;
+  const vtkIdType *ptIds;
+  vtkIdType numIds;
   double pt[3];
 
   for (lvtk=0; lvtk <= this->InsertionLevel; lvtk++)
@@ -1448,11 +1551,11 @@ vtkIdType vtkPointLocator::IsInsertedPoint(const double x[3])
       cno = nei[0] + nei[1]*this->Divisions[0] + 
         nei[2]*this->Divisions[0]*this->Divisions[1];
 
-      if ( (ptIds = this->HashTable[cno]) != NULL )
+      if ( (numIds = this->GetBucketPoints(cno, ptIds)) > 0 )
         {
-        for (j=0; j < ptIds->GetNumberOfIds(); j++) 
+        for (j=0; j < numIds; j++) 
           {
-          ptId = ptIds->GetId(j);
+          ptId = ptIds[j];
           this->Points->GetPoint(ptId, pt);
 
           if ( vtkMath::Distance2BetweenPoints(x,pt) <= this->InsertionTol2 )
@@ -1496,7 +1599,8 @@ vtkIdType vtkPointLocator::FindClosestInsertedPoint(const double x[3])
   int level;
   vtkIdType closest, j;
   vtkIdType ptId, cno;
-  vtkIdList *ptIds;
+  const vtkIdType *ptIds;
+  vtkIdType numIds;
   int ijk[3], *nei;
   int MULTIPLES;
   double diff;
@@ -1542,11 +1646,11 @@ vtkIdType vtkPointLocator::FindClosestInsertedPoint(const double x[3])
       cno = nei[0] + nei[1]*this->Divisions[0] + 
             nei[2]*this->Divisions[0]*this->Divisions[1];
 
-      if ( (ptIds = this->HashTable[cno]) != NULL )
+      if ( (numIds = this->GetBucketPoints(cno, ptIds)) > 0 )
         {
-        for (j=0; j < ptIds->GetNumberOfIds(); j++) 
+        for (j=0; j < numIds; j++) 
           {
-          ptId = ptIds->GetId(j);
+          ptId = ptIds[j];
           this->Points->GetPoint(ptId, pt);
           if ( (dist2 = vtkMath::Distance2BetweenPoints(x,pt)) < minDist2 ) 
             {
@@ -1585,11 +1689,11 @@ vtkIdType vtkPointLocator::FindClosestInsertedPoint(const double x[3])
         {
         cno = nei[0] + nei[1]*this->Divisions[0] + nei[2]*this->Divisions[0]*this->Divisions[1];
 
-        if ( (ptIds = this->HashTable[cno]) )
+        if ( (numIds = this->GetBucketPoints(cno, ptIds)) > 0 )
           {
-          for (j=0; j < ptIds->GetNumberOfIds(); j++) 
+          for (j=0; j < numIds; j++) 
             {
-            ptId = ptIds->GetId(j);
+            ptId = ptIds[j];
             this->Points->GetPoint(ptId, pt);
             if ( (dist2 = vtkMath::Distance2BetweenPoints(x,pt)) < minDist2 ) 
               {
@@ -1604,9 +1708,9 @@ vtkIdType vtkPointLocator::FindClosestInsertedPoint(const double x[3])
     return closest;
 }
 
-// Return the list of points in the bucket containing x.
-vtkIdList *vtkPointLocator::GetPointsInBucket(const double x[3],
-                                              int ijk[3])
+// Return the index of the bucket containing x, or -1 if x is outside the
+// locator.
+vtkIdType vtkPointLocator::GetBucketIndex(const double x[3], int ijk[3])
 {
   int i;
 
@@ -1616,7 +1720,7 @@ vtkIdList *vtkPointLocator::GetPointsInBucket(const double x[3],
     {
     if ( x[i] < this->Bounds[2*i] || x[i] > this->Bounds[2*i+1] )
       {
-      return NULL;
+      return -1;
       }
     }
 
@@ -1633,17 +1737,60 @@ vtkIdList *vtkPointLocator::GetPointsInBucket(const double x[3],
       }
     }
   
-  // Get the id list, if any
-  //
+  return ijk[0] + ijk[1]*this->Divisions[0] + 
+    ijk[2]*this->Divisions[0]*this->Divisions[1];
+}
+
+// Return the list of points in the bucket containing x.
+vtkIdList *vtkPointLocator::GetPointsInBucket(const double x[3],
+                                              int ijk[3])
+{
+  vtkIdType idx = this->GetBucketIndex(x, ijk);
+  if ( idx < 0 )
+    {
+    return NULL;
+    }
   if ( this->HashTable )
     {
-    int idx = ijk[0] + ijk[1]*this->Divisions[0] + 
-              ijk[2]*this->Divisions[0]*this->Divisions[1];
-
     return this->HashTable[idx];
     }
+  if ( ! this->BucketOffsets || this->GetBucketSize(idx) == 0 )
+    {
+    return NULL;
+    }
+  if ( ! this->BucketList )
+    {
+    this->BucketList = vtkIdList::New();
+    }
+  this->GetPointsInBucket(x, ijk, this->BucketList);
+  return this->BucketList;
+}
 
-  return NULL;
+// Return the number of points in the bucket containing x, and a pointer
+// to their ids.
+vtkIdType vtkPointLocator::GetPointsInBucket(const double x[3], int ijk[3],
+                                             const vtkIdType *&ptIds)
+{
+  ptIds = NULL;
+  vtkIdType idx = this->GetBucketIndex(x, ijk);
+  if ( idx < 0 || (this->HashTable == NULL && this->BucketOffsets == NULL) )
+    {
+    return 0;
+    }
+  return this->GetBucketPoints(idx, ptIds);
+}
+
+// Copy the ids of the points in the bucket containing x to the list.
+void vtkPointLocator::GetPointsInBucket(const double x[3], int ijk[3],
+                                        vtkIdList *result)
+{
+  const vtkIdType *ptIds;
+  vtkIdType numIds = this->GetPointsInBucket(x, ijk, ptIds);
+  result->SetNumberOfIds(numIds);
+  if ( numIds > 0 )
+    {
+    memcpy (result->GetPointer(0), ptIds, numIds*sizeof(vtkIdType));
+    }
 }
 
 
@@ -1656,7 +1803,7 @@ void vtkPointLocator::GenerateRepresentation(int vtkNotUsed(level),
   vtkCellArray *polys;
   int ii, i, j, k, idx, offset[3], minusOffset[3], inside, sliceSize;
 
-  if ( this->HashTable == NULL ) 
+  if ( this->HashTable == NULL && this->BucketOffsets == NULL ) 
     {
     vtkErrorMacro(<<"Can't build representation...no data!");
     return;
@@ -1682,7 +1829,7 @@ void vtkPointLocator::GenerateRepresentation(int vtkNotUsed(level),
         offset[0] = i;
         minusOffset[0] = i - 1;
         idx = offset[0] + offset[1] + offset[2];
-        if ( this->HashTable[idx] == NULL )
+        if ( this->GetBucketSize(idx) == 0 )
           {
           inside = 0;
           }
@@ -1716,8 +1863,8 @@ void vtkPointLocator::GenerateRepresentation(int vtkNotUsed(level),
               idx = offset[0] + offset[1] + minusOffset[2];
               }
 
-            if ( (this->HashTable[idx] == NULL && inside) ||
-            (this->HashTable[idx] != NULL && !inside) )
+            if ( (this->GetBucketSize(idx) == 0 && inside) ||
+            (this->GetBucketSize(idx) != 0 && !inside) )
               {
               this->GenerateFace(ii,i,j,k,pts,polys);
               }
@@ -1904,6 +2051,7 @@ void vtkPointLocator::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Number of Points Per Bucket: " << this->NumberOfPointsPerBucket << "\n";
   os << indent << "Divisions: (" << this->Divisions[0] << ", " 
      << this->Divisions[1] << ", " << this->Divisions[2] << ")\n";
+  os << indent << "Morton Order: " << (this->MortonOrder ? "On\n" : "Off\n");
   if ( this->Points )
     {
     os << indent << "Points:\n";
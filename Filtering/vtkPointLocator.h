@@ -24,6 +24,12 @@
 // method, you supply it with a dataset, and it operates on the points in 
 // the dataset. In the second method, you supply it with an array of points,
 // and the object operates on the array.
+//
+// When built from a dataset, the ids of the points are sorted by bucket
+// in one array, with the start of each bucket in a second array, so that
+// searches read the points of neighboring buckets from contiguous memory.
+// The buckets can also be laid out along a Morton (Z-order) curve. Points
+// inserted incrementally are kept in a list per bucket.
 
 // .SECTION Caveats
 // Many other types of spatial locators have been developed such as 
@@ -64,6 +70,15 @@ public:
   vtkSetClampMacro(NumberOfPointsPerBucket,int,1,VTK_LARGE_INTEGER);
   vtkGetMacro(NumberOfPointsPerBucket,int);
 
+  // Description:
+  // Lay out the buckets built by BuildLocator() along a Morton (Z-order)
+  // curve instead of row by row, so that buckets close in space in every
+  // direction are mostly close in memory. This does not change the results
+  // of the searches. Off by default.
+  vtkSetMacro(MortonOrder,int);
+  vtkGetMacro(MortonOrder,int);
+  vtkBooleanMacro(MortonOrder,int);
+
   // Description:
   // Given a position x, return the id of the point closest to it. Alternative
   // method requires separate x-y-z values.
@@ -180,9 +195,24 @@ public:
   // Given a position x, return the list of points in the bucket that
   // contains the point. It is possible that NULL is returned. The user
   // provides an ijk array that is the indices into the locator.
-  // This method is thread safe.
+  // The buckets of a locator built from a dataset are not stored in
+  // lists, so their ids are copied to a list of the locator, which is
+  // overwritten by the next call. This method is thread safe only for
+  // points inserted incrementally; otherwise use the signatures below.
   virtual vtkIdList *GetPointsInBucket(const double x[3], int ijk[3]);
 
+  // Description:
+  // Given a position x, return the number of points in the bucket that
+  // contains the point and set ptIds to their ids, which stay valid until
+  // the locator changes. Works for all locators and is thread safe. The
+  // user provides an ijk array that is the indices into the locator.
+  vtkIdType GetPointsInBucket(const double x[3], int ijk[3],
+                              const vtkIdType *&ptIds);
+
+  // Description:
+  // Same as above, but copy the point ids to the list provided.
+  void GetPointsInBucket(const double x[3], int ijk[3], vtkIdList *result);
+
   // Description:
   // Provide an accessor to the points.
   vtkGetObjectMacro(Points, vtkPoints);
@@ -214,10 +244,22 @@ protected:
   double Distance2ToBucket(const double x[3], const int nei[3]);
   double Distance2ToBounds(const double x[3], const double bounds[6]);
 
+  // Return the index of the bucket containing x, or -1 if x is outside.
+  vtkIdType GetBucketIndex(const double x[3], int ijk[3]);
+
+  // Return the number of points in bucket idx, and their ids in ptIds.
+  vtkIdType GetBucketPoints(vtkIdType idx, const vtkIdType *&ptIds);
+  vtkIdType GetBucketSize(vtkIdType idx);
+
   vtkPoints *Points; // Used for merging points
   int Divisions[3]; // Number of sub-divisions in x-y-z directions
   int NumberOfPointsPerBucket; //Used with previous boolean to control subdivide
-  vtkIdList **HashTable; // lists of point ids in buckets
+  vtkIdList **HashTable; // lists of point ids in buckets, when inserting
+  vtkIdType *BucketPoints; // point ids sorted by bucket, when built
+  vtkIdType *BucketOffsets; // start of each bucket in BucketPoints
+  vtkIdType *BucketOrder; // position of each bucket in Morton order, or NULL
+  vtkIdList *BucketList; // returned by GetPointsInBucket() when built
+  int MortonOrder;
   vtkIdType NumberOfBuckets; // total size of hash table
   double H[3]; // width of each bucket in x-y-z directions
 
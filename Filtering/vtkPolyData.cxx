@@ -241,6 +241,45 @@ void vtkPolyData::CopyStructure(vtkDataSet *ds)
     }
 }
 
+//----------------------------------------------------------------------------
+void vtkPolyData::PrepareForThreadedAccess()
+{
+  this->Superclass::PrepareForThreadedAccess();
+  if ( !this->Cells )
+    {
+    this->BuildCells();
+    }
+  vtkCellArray *cellArrays[4] =
+    { this->Verts, this->Lines, this->Polys, this->Strips };
+  for (int i = 0; i < 4; i++)
+    {
+    if ( cellArrays[i] )
+      {
+      cellArrays[i]->PrepareForThreadedAccess();
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkCellArray *vtkPolyData::GetCellArray(int cellType)
+{
+  switch (cellType)
+    {
+    case VTK_VERTEX: case VTK_POLY_VERTEX:
+      return this->Verts;
+
+    case VTK_LINE: case VTK_POLY_LINE:
+      return this->Lines;
+
+    case VTK_TRIANGLE: case VTK_QUAD: case VTK_POLYGON:
+      return this->Polys;
+
+    case VTK_TRIANGLE_STRIP:
+      return this->Strips;
+    }
+  return NULL;
+}
+
 //----------------------------------------------------------------------------
 int vtkPolyData::GetCellType(vtkIdType cellId)
 {
@@ -275,7 +314,7 @@ vtkCell *vtkPolyData::GetCell(vtkIdType cellId)
         this->Vertex = vtkVertex::New();
         }
       cell = this->Vertex;
-      this->Verts->GetCell(loc,numPts,pts);
+      this->Verts->GetCell(loc,numPts,pts,cell->PointIds);
       break;
 
     case VTK_POLY_VERTEX:
@@ -284,7 +323,7 @@ vtkCell *vtkPolyData::GetCell(vtkIdType cellId)
         this->PolyVertex = vtkPolyVertex::New();
         }
       cell = this->PolyVertex;
-      this->Verts->GetCell(loc,numPts,pts);
+      this->Verts->GetCell(loc,numPts,pts,cell->PointIds);
       cell->PointIds->SetNumberOfIds(numPts); //reset number of points
       cell->Points->SetNumberOfPoints(numPts);
       break;
@@ -295,7 +334,7 @@ vtkCell *vtkPolyData::GetCell(vtkIdType cellId)
         this->Line = vtkLine::New();
         }
       cell = this->Line;
-      this->Lines->GetCell(loc,numPts,pts);
+      this->Lines->GetCell(loc,numPts,pts,cell->PointIds);
       break;
 
     case VTK_POLY_LINE:
@@ -304,7 +343,7 @@ vtkCell *vtkPolyData::GetCell(vtkIdType cellId)
         this->PolyLine = vtkPolyLine::New();
         }
       cell = this->PolyLine;
-      this->Lines->GetCell(loc,numPts,pts);
+      this->Lines->GetCell(loc,numPts,pts,cell->PointIds);
       cell->PointIds->SetNumberOfIds(numPts); //reset number of points
       cell->Points->SetNumberOfPoints(numPts);
       break;
@@ -315,7 +354,7 @@ vtkCell *vtkPolyData::GetCell(vtkIdType cellId)
         this->Triangle = vtkTriangle::New();
         }
       cell = this->Triangle;
-      this->Polys->GetCell(loc,numPts,pts);
+      this->Polys->GetCell(loc,numPts,pts,cell->PointIds);
       break;
 
     case VTK_QUAD:
@@ -324,7 +363,7 @@ vtkCell *vtkPolyData::GetCell(vtkIdType cellId)
         this->Quad = vtkQuad::New();
         }
       cell = this->Quad;
-      this->Polys->GetCell(loc,numPts,pts);
+      this->Polys->GetCell(loc,numPts,pts,cell->PointIds);
       break;
 
     case VTK_POLYGON:
@@ -333,7 +372,7 @@ vtkCell *vtkPolyData::GetCell(vtkIdType cellId)
         this->Polygon = vtkPolygon::New();
         }
       cell = this->Polygon;
-      this->Polys->GetCell(loc,numPts,pts);
+      this->Polys->GetCell(loc,numPts,pts,cell->PointIds);
       cell->PointIds->SetNumberOfIds(numPts); //reset number of points
       cell->Points->SetNumberOfPoints(numPts);
       break;
@@ -344,7 +383,7 @@ vtkCell *vtkPolyData::GetCell(vtkIdType cellId)
         this->TriangleStrip = vtkTriangleStrip::New();
         }
       cell = this->TriangleStrip;
-      this->Strips->GetCell(loc,numPts,pts);
+      this->Strips->GetCell(loc,numPts,pts,cell->PointIds);
       cell->PointIds->SetNumberOfIds(numPts); //reset number of points
       cell->Points->SetNumberOfPoints(numPts);
       break;
@@ -389,48 +428,48 @@ void vtkPolyData::GetCell(vtkIdType cellId, vtkGenericCell *cell)
     {
     case VTK_VERTEX:
       cell->SetCellTypeToVertex();
-      this->Verts->GetCell(loc,numPts,pts);
+      this->Verts->GetCell(loc,numPts,pts,cell->PointIds);
       break;
 
     case VTK_POLY_VERTEX:
       cell->SetCellTypeToPolyVertex();
-      this->Verts->GetCell(loc,numPts,pts);
+      this->Verts->GetCell(loc,numPts,pts,cell->PointIds);
       cell->PointIds->SetNumberOfIds(numPts); //reset number of points
       cell->Points->SetNumberOfPoints(numPts);
       break;
 
     case VTK_LINE: 
       cell->SetCellTypeToLine();
-      this->Lines->GetCell(loc,numPts,pts);
+      this->Lines->GetCell(loc,numPts,pts,cell->PointIds);
       break;
 
     case VTK_POLY_LINE:
       cell->SetCellTypeToPolyLine();
-      this->Lines->GetCell(loc,numPts,pts);
+      this->Lines->GetCell(loc,numPts,pts,cell->PointIds);
       cell->PointIds->SetNumberOfIds(numPts); //reset number of points
       cell->Points->SetNumberOfPoints(numPts);
       break;
 
     case VTK_TRIANGLE:
       cell->SetCellTypeToTriangle();
-      this->Polys->GetCell(loc,numPts,pts);
+      this->Polys->GetCell(loc,numPts,pts,cell->PointIds);
       break;
 
     case VTK_QUAD:
       cell->SetCellTypeToQuad();
-      this->Polys->GetCell(loc,numPts,pts);
+      this->Polys->GetCell(loc,numPts,pts,cell->PointIds);
       break;
 
     case VTK_POLYGON:
       cell->SetCellTypeToPolygon();
-      this->Polys->GetCell(loc,numPts,pts);
+      this->Polys->GetCell(loc,numPts,pts,cell->PointIds);
       cell->PointIds->SetNumberOfIds(numPts); //reset number of points
       cell->Points->SetNumberOfPoints(numPts);
       break;
 
     case VTK_TRIANGLE_STRIP:
       cell->SetCellTypeToTriangleStrip();
-      this->Strips->GetCell(loc,numPts,pts);
+      this->Strips->GetCell(loc,numPts,pts,cell->PointIds);
       cell->PointIds->SetNumberOfIds(numPts); //reset number of points
       cell->Points->SetNumberOfPoints(numPts);
       break;
@@ -539,32 +578,21 @@ void vtkPolyData::GetCellBounds(vtkIdType cellId, double bounds[6])
   type = this->Cells->GetCellType(cellId);
   loc = this->Cells->GetCellLocation(cellId);
 
-  switch (type)
+  vtkCellArray *cells = this->GetCellArray(type);
+  if (!cells)
     {
-    case VTK_VERTEX:
-    case VTK_POLY_VERTEX:
-      this->Verts->GetCell(loc,numPts,pts);
-      break;
-
-    case VTK_LINE: 
-    case VTK_POLY_LINE:
-      this->Lines->GetCell(loc,numPts,pts);
-      break;
-
-    case VTK_TRIANGLE:
-    case VTK_QUAD:
-    case VTK_POLYGON:
-      this->Polys->GetCell(loc,numPts,pts);
-      break;
-
-    case VTK_TRIANGLE_STRIP:
-      this->Strips->GetCell(loc,numPts,pts);
-      break;
-
-    default:
-      bounds[0] = bounds[1] = bounds[2] = bounds[3] = bounds[4] = bounds[5]
-        = 0.0;
-      return;
+    bounds[0] = bounds[1] = bounds[2] = bounds[3] = bounds[4] = bounds[5]
+      = 0.0;
+    return;
+    }
+  // Only the 32-bit offsets layout needs a buffer to stay thread safe; the
+  // heap is used only for cells larger than VTK_CELL_SIZE.
+  vtkIdType stackBuffer[VTK_CELL_SIZE];
+  vtkIdList *buffer = NULL;
+  if (!cells->GetCell(loc,numPts,pts,stackBuffer,VTK_CELL_SIZE))
+    {
+    buffer = vtkIdList::New();
+    cells->GetCell(loc,numPts,pts,buffer);
     }
 
   // carefully compute the bounds
@@ -592,6 +620,10 @@ void vtkPolyData::GetCellBounds(vtkIdType cellId, double bounds[6])
     {
     vtkMath::UninitializeBounds(bounds);
     }
+  if (buffer)
+    {
+    buffer->Delete();
+    }
 }
 
 
@@ -612,6 +644,7 @@ void vtkPolyData::ComputeBounds()
     vtkIdType *pts = 0;
     vtkIdType npts = 0;
     double x[3];
+    vtkIdList *buffer = vtkIdList::New();
 
     vtkCellArray *cella[4];
 
@@ -628,7 +661,7 @@ void vtkPolyData::ComputeBounds()
     // Iterate over cells's points
     for (t = 0; t < 4; t++) 
       {
-      for (cella[t]->InitTraversal(); cella[t]->GetNextCell(npts,pts); )
+      for (cella[t]->InitTraversal(); cella[t]->GetNextCell(npts,pts,buffer);)
         {
         for (i = 0;  i < npts; i++)
           {
@@ -643,6 +676,7 @@ void vtkPolyData::ComputeBounds()
           }
         }
       }
+    buffer->Delete();
     if (!doneOne)
       {
       vtkMath::UninitializeBounds(this->Bounds);
@@ -961,6 +995,7 @@ void vtkPolyData::BuildCells()
   vtkCellArray *inStrips=this->GetStrips();
   vtkIdType npts=0;
   vtkIdType *pts=0;
+  vtkIdList *buffer;
   vtkCellTypes *cells;
 
   vtkDebugMacro (<< "Building PolyData cells.");
@@ -980,9 +1015,11 @@ void vtkPolyData::BuildCells()
   this->Cells->Register(this);
   cells->Delete();
   //
-  // Traverse various lists to create cell array
+  // Traverse various lists to create cell array. The buffer reads 32-bit
+  // offsets layouts in place.
   //
-  for (inVerts->InitTraversal(); inVerts->GetNextCell(npts,pts); )
+  buffer = vtkIdList::New();
+  for (inVerts->InitTraversal(); inVerts->GetNextCell(npts,pts,buffer); )
     {
     if ( npts > 1 )
       {
@@ -995,7 +1032,7 @@ void vtkPolyData::BuildCells()
       }
     }
 
-  for (inLines->InitTraversal(); inLines->GetNextCell(npts,pts); )
+  for (inLines->InitTraversal(); inLines->GetNextCell(npts,pts,buffer); )
     {
     if ( npts > 2 )
       {
@@ -1007,7 +1044,7 @@ void vtkPolyData::BuildCells()
       } 
     }
 
-  for (inPolys->InitTraversal(); inPolys->GetNextCell(npts,pts); )
+  for (inPolys->InitTraversal(); inPolys->GetNextCell(npts,pts,buffer); )
     {
     if ( npts == 3 )
       {
@@ -1023,11 +1060,12 @@ void vtkPolyData::BuildCells()
       }
     }
 
-  for (inStrips->InitTraversal(); inStrips->GetNextCell(npts,pts); )
+  for (inStrips->InitTraversal(); inStrips->GetNextCell(npts,pts,buffer); )
     {
     cells->InsertNextCell(VTK_TRIANGLE_STRIP,
                           inStrips->GetTraversalLocation(npts));
     }
+  buffer->Delete();
 }
 
 //----------------------------------------------------------------------------
@@ -1074,20 +1112,17 @@ void vtkPolyData::BuildLinks(int initialSize)
 // Copy a cells point ids into list provided. (Less efficient.)
 void vtkPolyData::GetCellPoints(vtkIdType cellId, vtkIdList *ptIds)
 {
-  vtkIdType i;
-  vtkIdType *pts, npts;
-  
   ptIds->Reset();
   if ( this->Cells == NULL )
     {
     this->BuildCells();
     }
 
-  this->vtkPolyData::GetCellPoints(cellId, npts, pts);
-  ptIds->InsertId (npts-1,pts[npts-1]);
-  for (i=0; i<npts-1; i++)
+  // Copy straight from the cell array, which reads every layout in place.
+  vtkCellArray *cells = this->GetCellArray(this->Cells->GetCellType(cellId));
+  if (cells)
     {
-    ptIds->SetId(i,pts[i]);
+    cells->GetCell(this->Cells->GetCellLocation(cellId), ptIds);
     }
 }
 
@@ -1558,6 +1593,32 @@ void vtkPolyData::ReplaceCell(vtkIdType cellId, int npts, vtkIdType *pts)
     }
 }
 
+//----------------------------------------------------------------------------
+void vtkPolyData::ReplaceCellPoint(vtkIdType cellId, vtkIdType oldPtId,
+                                   vtkIdType newPtId)
+{
+  int i;
+  vtkIdType *verts, nverts;
+  
+  this->GetCellPoints(cellId,nverts,verts);
+  for ( i=0; i < nverts; i++ )
+    {
+    if ( verts[i] == oldPtId ) 
+      {
+      verts[i] = newPtId; // this is very nasty! direct write!
+      // 32-bit cell arrays hand out a copy of the ids, store it back.
+      vtkCellArray *cells =
+        this->GetCellArray(this->Cells->GetCellType(cellId));
+      if ( cells->GetLayout() == VTK_CELL_ARRAY_OFFSETS_32 )
+        {
+        cells->ReplaceCell(this->Cells->GetCellLocation(cellId),
+                           static_cast<int>(nverts), verts);
+        }
+      return;
+      }
+    }
+}
+
 //----------------------------------------------------------------------------
 // Replace one cell with another in cell structure. This operator updates the
 // connectivity list and the point's link list. It does not delete references
@@ -1924,6 +1985,7 @@ void vtkPolyData::RemoveGhostCells(int level)
   vtkIdType inCellId, outCellId;
   vtkIdType npts=0;
   vtkIdType *pts=0;
+  vtkIdList *buffer;
 
   // Get a pointer to the cell ghost level array.
   vtkDataArray* temp = this->CellData->GetArray("vtkGhostLevels");
@@ -1946,12 +2008,14 @@ void vtkPolyData::RemoveGhostCells(int level)
   newCellData = vtkCellData::New();
   newCellData->CopyAllocate(this->CellData, this->GetNumberOfCells());
 
+  buffer = vtkIdList::New();
   inCellId = outCellId = 0;
   if (this->Verts)
     {
     newVerts = vtkCellArray::New();
     newVerts->Allocate(this->Verts->GetSize());
-    for (this->Verts->InitTraversal(); this->Verts->GetNextCell(npts, pts); )
+    for (this->Verts->InitTraversal();
+         this->Verts->GetNextCell(npts, pts, buffer); )
       {
       if (int(cellGhostLevels[inCellId]) < level)
         { // Keep the cell.
@@ -1970,7 +2034,8 @@ void vtkPolyData::RemoveGhostCells(int level)
     {
     newLines = vtkCellArray::New();
     newLines->Allocate(this->Lines->GetSize());
-    for (this->Lines->InitTraversal(); this->Lines->GetNextCell(npts, pts); )
+    for (this->Lines->InitTraversal();
+         this->Lines->GetNextCell(npts, pts, buffer); )
       {
       if (int(cellGhostLevels[inCellId]) < level)
         { // Keep the cell.
@@ -1989,7 +2054,8 @@ void vtkPolyData::RemoveGhostCells(int level)
     {
     newPolys = vtkCellArray::New();
     newPolys->Allocate(this->Polys->GetSize());
-    for (this->Polys->InitTraversal(); this->Polys->GetNextCell(npts, pts); )
+    for (this->Polys->InitTraversal();
+         this->Polys->GetNextCell(npts, pts, buffer); )
       {
       if (int(cellGhostLevels[inCellId]) < level)
         { // Keep the cell.
@@ -2008,7 +2074,8 @@ void vtkPolyData::RemoveGhostCells(int level)
     {
     newStrips = vtkCellArray::New();
     newStrips->Allocate(this->Strips->GetSize());
-    for (this->Strips->InitTraversal(); this->Strips->GetNextCell(npts, pts); )
+    for (this->Strips->InitTraversal();
+         this->Strips->GetNextCell(npts, pts, buffer); )
       {
       if (int(cellGhostLevels[inCellId]) < level)
         { // Keep the cell.
@@ -2023,6 +2090,8 @@ void vtkPolyData::RemoveGhostCells(int level)
     newStrips = NULL;
     }
 
+  buffer->Delete();
+
   // Save the results.
   this->CellData->ShallowCopy(newCellData);
   newCellData->Delete();
@@ -2051,12 +2120,14 @@ void  vtkPolyData::RemoveDeletedCells()
   vtkIdType npts=0;
   vtkIdType *pts=0;
   vtkIdType c = 0;
+  vtkIdList *buffer = vtkIdList::New();
 
   if (this->Verts)
     {
     vtkCellArray* newVerts = vtkCellArray::New();
     newVerts->Allocate(this->Verts->GetSize());
-    for (this->Verts->InitTraversal(); this->Verts->GetNextCell(npts, pts); c++)
+    for (this->Verts->InitTraversal();
+         this->Verts->GetNextCell(npts, pts, buffer); c++)
       {
       if (this->Cells->GetCellType(c)!=VTK_EMPTY_CELL)
         { // Keep the cell.
@@ -2074,7 +2145,8 @@ void  vtkPolyData::RemoveDeletedCells()
     {
     vtkCellArray* newLines = vtkCellArray::New();
     newLines->Allocate(this->Lines->GetSize());
-    for (this->Lines->InitTraversal(); this->Lines->GetNextCell(npts, pts); c++)
+    for (this->Lines->InitTraversal();
+         this->Lines->GetNextCell(npts, pts, buffer); c++)
       {
       if (this->Cells->GetCellType(c)!=VTK_EMPTY_CELL)
         { // Keep the cell.
@@ -2093,7 +2165,8 @@ void  vtkPolyData::RemoveDeletedCells()
     vtkCellArray *newPolys;
     newPolys = vtkCellArray::New();
     newPolys->Allocate(this->Polys->GetSize());
-    for (this->Polys->InitTraversal(); this->Polys->GetNextCell(npts, pts); c++)
+    for (this->Polys->InitTraversal();
+         this->Polys->GetNextCell(npts, pts, buffer); c++)
       {
       if (this->Cells->GetCellType(c)!=VTK_EMPTY_CELL)
         { // Keep the cell.
@@ -2111,7 +2184,8 @@ void  vtkPolyData::RemoveDeletedCells()
     {
     vtkCellArray* newStrips = vtkCellArray::New();
     newStrips->Allocate(this->Strips->GetSize());
-    for (this->Strips->InitTraversal(); this->Strips->GetNextCell(npts, pts); c++)
+    for (this->Strips->InitTraversal();
+         this->Strips->GetNextCell(npts, pts, buffer); c++)
       {
       if (this->Cells->GetCellType(c)!=VTK_EMPTY_CELL)
         { // Keep the cell.
@@ -2125,6 +2199,7 @@ void  vtkPolyData::RemoveDeletedCells()
     newStrips->Delete();
     }
 
+  buffer->Delete();
   
   // Save the results.
   if(inCellId != outCellId)
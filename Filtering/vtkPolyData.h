@@ -115,6 +115,13 @@ public:
   // Description:
   // Compute the (X, Y, Z)  bounds of the data.
   void ComputeBounds();
+
+  // Description:
+  // Build the cells (see BuildCells()), the bounds and the point ids that
+  // 32-bit cell arrays hand out (see vtkCellArray), so that the thread
+  // safe read methods can be called from several threads at once.
+  // See vtkDataSet::PrepareForThreadedAccess().
+  virtual void PrepareForThreadedAccess();
   
   // Description:
   // Recover extra allocated memory when creating data whose initial size
@@ -246,7 +253,9 @@ public:
 
   // Description:
   // Return a pointer to a list of point ids defining cell. (More efficient.)
-  // Assumes that cells have been built (with BuildCells()).
+  // Assumes that cells have been built (with BuildCells()). For cell
+  // arrays in the 32-bit offsets layout the ids are a copy, so writing
+  // through pts does not change the cell, see vtkCellArray.
   void GetCellPoints(vtkIdType cellId, vtkIdType& npts, vtkIdType* &pts);
 
   // Description:
@@ -464,6 +473,10 @@ protected:
   // dummy static member below used as a trick to simplify traversal
   static vtkCellArray *Dummy;
 
+  // The cell array holding the cells of the given type, NULL for types
+  // that a polydata cannot hold.
+  vtkCellArray *GetCellArray(int cellType);
+
   // supporting structures for more complex topological operations
   // built only when necessary
   vtkCellTypes *Cells;
@@ -581,23 +594,6 @@ inline void vtkPolyData::ResizeCellList(vtkIdType ptId, int size)
   this->Links->ResizeCellList(ptId,size);
 }
 
-inline void vtkPolyData::ReplaceCellPoint(vtkIdType cellId, vtkIdType oldPtId,
-                                          vtkIdType newPtId)
-{
-  int i;
-  vtkIdType *verts, nverts;
-  
-  this->GetCellPoints(cellId,nverts,verts);
-  for ( i=0; i < nverts; i++ )
-    {
-    if ( verts[i] == oldPtId ) 
-      {
-      verts[i] = newPtId; // this is very nasty! direct write!
-      return;
-      }
-    }
-}
-
 #endif
 
 
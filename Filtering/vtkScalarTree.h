@@ -24,10 +24,12 @@
 // To use subclasses of this class, you must specify a dataset to operate on,
 // and then specify a scalar value in the InitTraversal() method. Then
 // calls to GetNextCell() return cells whose scalar data contains the
-// scalar value specified.
+// scalar value specified. Trees that support it also hand out the cells
+// in batches of ids, which several threads may process at once (see
+// GetNumberOfCellBatches()).
 
 // .SECTION See Also
-// vtkSimpleScalarTree 
+// vtkSimpleScalarTree vtkSpanSpace
 
 #ifndef __vtkScalarTree_h
 #define __vtkScalarTree_h
@@ -51,6 +53,13 @@ public:
   virtual void SetDataSet(vtkDataSet*);
   vtkGetObjectMacro(DataSet,vtkDataSet);
 
+  // Description:
+  // Set the scalars to organize the cells by. If none are set, the active
+  // point scalars of the dataset are used. Only the first component is
+  // used.
+  virtual void SetScalars(vtkDataArray*);
+  vtkGetObjectMacro(Scalars,vtkDataArray);
+
   // Description:
   // Construct the scalar tree from the dataset provided. Checks build times
   // and modified time from input and reconstructs the tree if necessary.
@@ -73,12 +82,30 @@ public:
   virtual vtkCell *GetNextCell(vtkIdType &cellId, vtkIdList* &ptIds,
                                vtkDataArray *cellScalars) = 0;
 
+  // Description:
+  // Get the number of batches of cell ids that may contain the scalar
+  // value specified to InitTraversal(). Each batch is retrieved with
+  // GetCellBatch(). These methods only read the tree, so that once
+  // InitTraversal() returns, several threads can process the batches at
+  // once. Trees that do not support batches return 0, as does this
+  // implementation; use GetNextCell() then.
+  virtual vtkIdType GetNumberOfCellBatches() {return 0;}
+
+  // Description:
+  // Return the ids of the cells in batch batchNum, with
+  // 0 <= batchNum < GetNumberOfCellBatches(), and their number in
+  // numCells. The cells may not all contain the scalar value, so check
+  // their scalars.
+  virtual const vtkIdType *GetCellBatch(vtkIdType vtkNotUsed(batchNum),
+                                        vtkIdType &numCells)
+    {numCells = 0; return NULL;}
+
 protected:
   vtkScalarTree();
   ~vtkScalarTree();
 
   vtkDataSet   *DataSet;    //the dataset over which the scalar tree is built
-  vtkDataArray *Scalars;    //the scalars of the DataSet
+  vtkDataArray *Scalars;    //the scalars to organize, if not the DataSet's
 
   vtkTimeStamp BuildTime; //time at which tree was built
   double       ScalarValue; //current scalar value for traversal
@@ -43,6 +43,7 @@ vtkSimpleScalarTree::vtkSimpleScalarTree()
   this->BranchingFactor = 3;
   this->Tree = NULL;
   this->TreeSize = 0;
+  this->BuiltScalars = NULL;
 }
 
 vtkSimpleScalarTree::~vtkSimpleScalarTree()
@@ -85,15 +86,20 @@ void vtkSimpleScalarTree::BuildTree()
     }
 
   if ( this->Tree != NULL && this->BuildTime > this->MTime 
-    && this->BuildTime > this->DataSet->GetMTime() )
+    && this->BuildTime > this->DataSet->GetMTime()
+    && this->BuildTime > this->BuiltScalars->GetMTime() )
     {
     return;
     }
 
   vtkDebugMacro( << "Building scalar tree..." );
 
-  this->Scalars = this->DataSet->GetPointData()->GetScalars();
-  if ( ! this->Scalars )
+  this->BuiltScalars = this->Scalars;
+  if ( ! this->BuiltScalars )
+    {
+    this->BuiltScalars = this->DataSet->GetPointData()->GetScalars();
+    }
+  if ( ! this->BuiltScalars )
     {
     vtkErrorMacro( << "No scalar data to build trees with");
     return;
@@ -135,7 +141,7 @@ void vtkSimpleScalarTree::BuildTree()
       cellPts = cell->GetPointIds();
       numScalars = cellPts->GetNumberOfIds();
       cellScalars->SetNumberOfTuples(numScalars);
-      this->Scalars->GetTuples(cellPts, cellScalars);
+      this->BuiltScalars->GetTuples(cellPts, cellScalars);
       s = cellScalars->GetPointer(0);
 
       for ( j=0; j < numScalars; j++ )
@@ -299,7 +305,7 @@ vtkCell *vtkSimpleScalarTree::GetNextCell(vtkIdType& cellId,
                                           vtkIdList* &cellPts,
                                           vtkDataArray *cellScalars)
 {
-  double s, min=VTK_DOUBLE_MAX, max=(-VTK_DOUBLE_MAX);
+  double s, min, max;
   vtkIdType i, numScalars;
   vtkCell *cell;
   vtkIdType numCells = this->DataSet->GetNumberOfCells();
@@ -313,10 +319,12 @@ vtkCell *vtkSimpleScalarTree::GetNextCell(vtkIdType& cellId,
       cellPts = cell->GetPointIds();
       numScalars = cellPts->GetNumberOfIds();
       cellScalars->SetNumberOfTuples(numScalars);
-      this->Scalars->GetTuples(cellPts, cellScalars);
+      this->BuiltScalars->GetTuples(cellPts, cellScalars);
+      min = VTK_DOUBLE_MAX;
+      max = -VTK_DOUBLE_MAX;
       for (i=0; i < numScalars; i++)
         {
-        s = cellScalars->GetTuple1(i);
+        s = cellScalars->GetComponent(i, 0);
         if ( s < min )
           {
           min = s;
@@ -95,7 +95,7 @@ protected:
   vtkSimpleScalarTree();
   ~vtkSimpleScalarTree();
 
-  vtkDataArray *Scalars;
+  vtkDataArray *BuiltScalars; //the scalars the tree was built from
   int MaxLevel;
   int Level;
   int BranchingFactor; //number of children per node
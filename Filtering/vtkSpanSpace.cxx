@@ -0,0 +1,434 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkSpanSpace.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkSpanSpace.h"
+
+#include "vtkCell.h"
+#include "vtkDataArray.h"
+#include "vtkDataSet.h"
+#include "vtkIdList.h"
+#include "vtkMultiThreader.h"
+#include "vtkObjectFactory.h"
+#include "vtkPointData.h"
+
+#include <vtkstd/vector>
+
+#include <math.h>
+
+vtkStandardNewMacro(vtkSpanSpace);
+
+// Cells below which a piece is not worth a thread of its own.
+#define VTK_SPAN_SPACE_MIN_PIECE_CELLS 20000
+#define VTK_SPAN_SPACE_PIECES_PER_THREAD 4
+
+class vtkSpanSpaceInternals
+{
+public:
+  vtkSpanSpaceInternals()
+    {
+    this->Scalars = NULL;
+    this->Built = 0;
+    this->Resolution = 1;
+    this->Min = this->Max = this->Scale = 0.0;
+    this->Batch = this->Position = 0;
+    }
+
+  // The bucket of scalar value s along either axis of span space, for s
+  // in [Min,Max]. It never decreases as s increases, so the bucket of a
+  // value lies between the buckets of the range of any cell containing it.
+  int Bucket(double s) const
+    {
+    int b = static_cast<int>((s - this->Min)*this->Scale);
+    return (b < this->Resolution ? b : this->Resolution - 1);
+    }
+
+  vtkDataArray *Scalars; //the scalars the buckets were built from
+  int Built;
+  int Resolution; //resolution of the buckets
+  double Min;
+  double Max;
+  double Scale; //Resolution over the scalar range
+
+  // Cell ids sorted by bucket, the buckets in row major order: rows by
+  // the minimum of the cell scalars, columns by the maximum.
+  vtkstd::vector<vtkIdType> CellIds;
+  // Where the cells of each bucket start in CellIds, then their number.
+  vtkstd::vector<vtkIdType> Offsets;
+
+  // The beginning and end in CellIds of each batch of the traversal.
+  vtkstd::vector<vtkIdType> Batches;
+  vtkIdType Batch; //batch of GetNextCell()
+  vtkIdType Position; //position of GetNextCell() in CellIds
+};
+
+// Computes the bucket of each cell, dividing the cells among pieces.
+class vtkSpanSpaceBuilder
+{
+public:
+  vtkDataSet *DataSet;
+  vtkDataArray *Scalars;
+  vtkSpanSpaceInternals *Internals;
+  int *Keys; //bucket of each cell, or -1 for cells without points
+  vtkIdType NumberOfCells;
+  int NumberOfPieces;
+
+  void Execute(int piece);
+};
+
+template <class T>
+void vtkSpanSpaceComputeKeys(vtkSpanSpaceBuilder *builder, T *s,
+                             vtkIdType begin, vtkIdType end)
+{
+  vtkSpanSpaceInternals *internals = builder->Internals;
+  int numComps = builder->Scalars->GetNumberOfComponents();
+  vtkIdList *ptIds = vtkIdList::New();
+  ptIds->Allocate(VTK_CELL_SIZE);
+  for (vtkIdType cellId = begin; cellId < end; cellId++)
+    {
+    builder->DataSet->GetCellPoints(cellId, ptIds);
+    vtkIdType numPts = ptIds->GetNumberOfIds();
+    if ( numPts < 1 )
+      {
+      builder->Keys[cellId] = -1;
+      continue;
+      }
+    vtkIdType *pts = ptIds->GetPointer(0);
+    double min = s[pts[0]*numComps], max = min;
+    for (vtkIdType i = 1; i < numPts; i++)
+      {
+      double value = s[pts[i]*numComps];
+      if ( value < min )
+        {
+        min = value;
+        }
+      else if ( value > max )
+        {
+        max = value;
+        }
+      }
+    builder->Keys[cellId] = internals->Bucket(min)*internals->Resolution +
+      internals->Bucket(max);
+    }
+  ptIds->Delete();
+}
+
+void vtkSpanSpaceBuilder::Execute(int piece)
+{
+  vtkIdType begin = this->NumberOfCells*piece/this->NumberOfPieces;
+  vtkIdType end = this->NumberOfCells*(piece + 1)/this->NumberOfPieces;
+  void *s = this->Scalars->GetVoidPointer(0);
+  switch (this->Scalars->GetDataType())
+    {
+    vtkTemplateMacro(
+      vtkSpanSpaceComputeKeys(this, static_cast<VTK_TT *>(s), begin, end));
+    }
+}
+
+static VTK_THREAD_RETURN_TYPE vtkSpanSpaceBuildExecute(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *info =
+    static_cast<vtkMultiThreader::ThreadInfo *>(arg);
+  vtkSpanSpaceBuilder *builder =
+    static_cast<vtkSpanSpaceBuilder *>(info->UserData);
+
+  for (int piece = info->ThreadID; piece < builder->NumberOfPieces;
+       piece += info->NumberOfThreads)
+    {
+    builder->Execute(piece);
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+vtkSpanSpace::vtkSpanSpace()
+{
+  this->Resolution = 100;
+  this->ComputeResolution = 1;
+  this->NumberOfCellsPerBucket = 5;
+  this->BatchSize = 1000;
+  this->NumberOfThreads = 1;
+  this->Internals = new vtkSpanSpaceInternals;
+}
+
+vtkSpanSpace::~vtkSpanSpace()
+{
+  delete this->Internals;
+}
+
+// Initialize locator. Frees memory and resets object as appropriate.
+void vtkSpanSpace::Initialize()
+{
+  vtkSpanSpaceInternals *internals = this->Internals;
+  internals->Built = 0;
+  internals->Scalars = NULL;
+  vtkstd::vector<vtkIdType>().swap(internals->CellIds);
+  vtkstd::vector<vtkIdType>().swap(internals->Offsets);
+  internals->Batches.clear();
+  internals->Batch = internals->Position = 0;
+}
+
+// Construct the span space from the dataset provided. Checks build times
+// and modified time from input and reconstructs the tree if necessary.
+void vtkSpanSpace::BuildTree()
+{
+  vtkIdType numCells;
+  vtkSpanSpaceInternals *internals = this->Internals;
+
+  // Check input...see whether we have to rebuild
+  //
+  if ( !this->DataSet || (numCells = this->DataSet->GetNumberOfCells()) < 1 )
+    {
+    vtkErrorMacro( << "No data to build tree with");
+    return;
+    }
+
+  vtkDataArray *scalars = this->Scalars;
+  if ( !scalars )
+    {
+    scalars = this->DataSet->GetPointData()->GetScalars();
+    }
+  if ( !scalars || scalars->GetDataType() == VTK_BIT ||
+       scalars->GetNumberOfTuples() < this->DataSet->GetNumberOfPoints() )
+    {
+    vtkErrorMacro( << "No scalar data to build trees with");
+    return;
+    }
+
+  if ( internals->Built && internals->Scalars == scalars &&
+       this->BuildTime > this->MTime &&
+       this->BuildTime > this->DataSet->GetMTime() &&
+       this->BuildTime > scalars->GetMTime() )
+    {
+    return;
+    }
+
+  vtkDebugMacro( << "Building span space..." );
+
+  this->Initialize();
+  internals->Scalars = scalars;
+
+  // Buckets covering the range of the scalars
+  //
+  double *range = scalars->GetRange(0);
+  int res = this->Resolution;
+  if ( this->ComputeResolution )
+    {
+    res = static_cast<int>(
+      sqrt(static_cast<double>(numCells)/this->NumberOfCellsPerBucket));
+    res = (res < 1 ? 1 : (res > 10000 ? 10000 : res));
+    }
+  internals->Resolution = res;
+  internals->Min = range[0];
+  internals->Max = range[1];
+  internals->Scale = (range[1] > range[0] ? res/(range[1] - range[0]) : 0.0);
+
+  // The bucket of each cell, computed in pieces of cells
+  //
+  int *keys = new int[numCells];
+  vtkSpanSpaceBuilder builder;
+  builder.DataSet = this->DataSet;
+  builder.Scalars = scalars;
+  builder.Internals = internals;
+  builder.Keys = keys;
+  builder.NumberOfCells = numCells;
+  vtkIdType pieces = numCells / VTK_SPAN_SPACE_MIN_PIECE_CELLS;
+  if ( pieces > VTK_SPAN_SPACE_PIECES_PER_THREAD*this->NumberOfThreads )
+    {
+    pieces = VTK_SPAN_SPACE_PIECES_PER_THREAD*this->NumberOfThreads;
+    }
+  if ( this->NumberOfThreads < 2 || pieces < 2 )
+    {
+    builder.NumberOfPieces = 1;
+    builder.Execute(0);
+    }
+  else
+    {
+    // build the cell map of a polydata now, not from whichever thread
+    // calls GetCellPoints() first
+    this->DataSet->PrepareForThreadedAccess();
+    builder.NumberOfPieces = static_cast<int>(pieces);
+    vtkMultiThreader *threader = vtkMultiThreader::New();
+    threader->UseThreadPoolOn();
+    threader->SetNumberOfThreads(this->NumberOfThreads);
+    threader->SetNumberOfPieces(builder.NumberOfPieces);
+    threader->SetSingleMethod(vtkSpanSpaceBuildExecute, &builder);
+    threader->SingleMethodExecute();
+    threader->Delete();
+    }
+
+  // Sort the cells by bucket: count them, offset the buckets and place the
+  // cells, then shift the offsets, which now point at the end of each
+  // bucket, back to its start.
+  //
+  vtkIdType numBuckets = static_cast<vtkIdType>(res)*res, bucket, cellId;
+  internals->Offsets.assign(numBuckets + 1, 0);
+  vtkIdType *offsets = &internals->Offsets[0];
+  for (cellId=0; cellId < numCells; cellId++)
+    {
+    if ( keys[cellId] >= 0 )
+      {
+      offsets[keys[cellId] + 1]++;
+      }
+    }
+  for (bucket=1; bucket <= numBuckets; bucket++)
+    {
+    offsets[bucket] += offsets[bucket-1];
+    }
+  internals->CellIds.resize(offsets[numBuckets]);
+  if ( offsets[numBuckets] > 0 )
+    {
+    vtkIdType *cellIds = &internals->CellIds[0];
+    for (cellId=0; cellId < numCells; cellId++)
+      {
+      if ( keys[cellId] >= 0 )
+        {
+        cellIds[offsets[keys[cellId]]++] = cellId;
+        }
+      }
+    }
+  for (bucket=numBuckets; bucket > 0; bucket--)
+    {
+    offsets[bucket] = offsets[bucket-1];
+    }
+  offsets[0] = 0;
+  delete [] keys;
+
+  internals->Built = 1;
+  this->BuildTime.Modified();
+}
+
+// Begin to traverse the cells based on a scalar value. Returned cells
+// will have scalar values that span the scalar value specified.
+void vtkSpanSpace::InitTraversal(double scalarValue)
+{
+  vtkSpanSpaceInternals *internals = this->Internals;
+  this->BuildTree();
+
+  this->ScalarValue = scalarValue;
+  internals->Batches.clear();
+  internals->Batch = internals->Position = 0;
+  if ( !internals->Built || scalarValue < internals->Min ||
+       scalarValue > internals->Max )
+    {
+    return;
+    }
+
+  // The cells with a minimum at most the value, and a maximum at least the
+  // value: in each row up to the bucket of the value, the buckets from
+  // the column of the value on, which are contiguous.
+  int res = internals->Resolution;
+  int k = internals->Bucket(scalarValue);
+  vtkIdType *offsets = &internals->Offsets[0];
+  for (int i=0; i <= k; i++)
+    {
+    vtkIdType rowStart = static_cast<vtkIdType>(i)*res;
+    vtkIdType end = offsets[rowStart + res];
+    for (vtkIdType begin=offsets[rowStart + k]; begin < end;
+         begin += this->BatchSize)
+      {
+      internals->Batches.push_back(begin);
+      internals->Batches.push_back(
+        end - begin > this->BatchSize ? begin + this->BatchSize : end);
+      }
+    }
+  if ( !internals->Batches.empty() )
+    {
+    internals->Position = internals->Batches[0];
+    }
+}
+
+// Return the next cell that contains the scalar value specified to
+// initialize traversal. The value NULL is returned if the list is
+// exhausted. Make sure that InitTraversal() has been invoked first or
+// you'll get erratic behavior.
+vtkCell *vtkSpanSpace::GetNextCell(vtkIdType& cellId, vtkIdList* &cellPts,
+                                   vtkDataArray *cellScalars)
+{
+  vtkSpanSpaceInternals *internals = this->Internals;
+  vtkIdType numBatches = this->GetNumberOfCellBatches();
+  vtkIdType i, numScalars;
+  vtkCell *cell;
+  double s, min, max;
+
+  while ( internals->Batch < numBatches )
+    {
+    if ( internals->Position >= internals->Batches[2*internals->Batch + 1] )
+      {
+      if ( ++internals->Batch < numBatches )
+        {
+        internals->Position = internals->Batches[2*internals->Batch];
+        }
+      continue;
+      }
+
+    vtkIdType id = internals->CellIds[internals->Position++];
+    cell = this->DataSet->GetCell(id);
+    cellPts = cell->GetPointIds();
+    numScalars = cellPts->GetNumberOfIds();
+    cellScalars->SetNumberOfTuples(numScalars);
+    internals->Scalars->GetTuples(cellPts, cellScalars);
+    min = VTK_DOUBLE_MAX;
+    max = -VTK_DOUBLE_MAX;
+    for (i=0; i < numScalars; i++)
+      {
+      s = cellScalars->GetComponent(i, 0);
+      if ( s < min )
+        {
+        min = s;
+        }
+      if ( s > max )
+        {
+        max = s;
+        }
+      }
+    if ( this->ScalarValue >= min && this->ScalarValue <= max )
+      {
+      cellId = id;
+      return cell;
+      }
+    } //while not all batches visited
+
+  return NULL;
+}
+
+vtkIdType vtkSpanSpace::GetNumberOfCellBatches()
+{
+  return static_cast<vtkIdType>(this->Internals->Batches.size() / 2);
+}
+
+const vtkIdType *vtkSpanSpace::GetCellBatch(vtkIdType batchNum,
+                                            vtkIdType &numCells)
+{
+  vtkSpanSpaceInternals *internals = this->Internals;
+  if ( batchNum < 0 || batchNum >= this->GetNumberOfCellBatches() )
+    {
+    numCells = 0;
+    return NULL;
+    }
+  vtkIdType begin = internals->Batches[2*batchNum];
+  numCells = internals->Batches[2*batchNum + 1] - begin;
+  return &internals->CellIds[begin];
+}
+
+void vtkSpanSpace::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  os << indent << "Resolution: " << this->Resolution << "\n";
+  os << indent << "Compute Resolution: "
+     << (this->ComputeResolution ? "On\n" : "Off\n");
+  os << indent << "Number Of Cells Per Bucket: "
+     << this->NumberOfCellsPerBucket << "\n";
+  os << indent << "Batch Size: " << this->BatchSize << "\n";
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << "\n";
+}
@@ -0,0 +1,139 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkSpanSpace.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkSpanSpace - organize cells in span space to accelerate contouring
+// .SECTION Description
+// vtkSpanSpace is a scalar tree that places each cell at the point
+// (min,max) of its scalar range, in the "span space" of the scalars, and
+// sorts the cells into a Resolution x Resolution grid of buckets covering
+// the scalar range. The cells containing a scalar value s have min <= s
+// and max >= s: they lie in the rows of buckets up to the row of s, in the
+// columns from the column of s on. As the cells of a row are sorted by
+// column, these are one contiguous run of cell ids per row, so a traversal
+// only visits the cells of those buckets. All of them contain s except
+// some of the cells in the row and the column of s, which are checked.
+//
+// The buckets are built once, with the cell ranges computed by
+// NumberOfThreads threads, and are kept until the dataset, the scalars or
+// the tree are modified: contouring the same data at a sequence of values
+// (an interactive sweep, say) builds them only once. After
+// InitTraversal(), the candidate cells are also available in batches of at
+// most BatchSize ids, which several threads can process at once.
+
+// .SECTION See Also
+// vtkScalarTree vtkSimpleScalarTree vtkContourGrid vtkContourFilter
+
+#ifndef __vtkSpanSpace_h
+#define __vtkSpanSpace_h
+
+#include "vtkScalarTree.h"
+
+//BTX
+class vtkSpanSpaceInternals;
+//ETX
+
+class VTK_FILTERING_EXPORT vtkSpanSpace : public vtkScalarTree
+{
+public:
+  // Description:
+  // Instantiate a span space that computes its resolution from 5 cells
+  // per bucket, with batches of 1000 cells.
+  static vtkSpanSpace *New();
+
+  // Description:
+  // Standard type related macros and PrintSelf() method.
+  vtkTypeMacro(vtkSpanSpace,vtkScalarTree);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  // Description:
+  // Set/Get the number of buckets along each axis of span space, used when
+  // ComputeResolution is off. Larger values mean fewer cells to check for
+  // each scalar value, at the cost of Resolution*Resolution offsets.
+  vtkSetClampMacro(Resolution,int,1,10000);
+  vtkGetMacro(Resolution,int);
+
+  // Description:
+  // Set/Get whether to compute the resolution from the number of cells
+  // and NumberOfCellsPerBucket. On by default.
+  vtkSetMacro(ComputeResolution,int);
+  vtkGetMacro(ComputeResolution,int);
+  vtkBooleanMacro(ComputeResolution,int);
+
+  // Description:
+  // Set/Get the average number of cells per bucket the computed resolution
+  // aims at.
+  vtkSetClampMacro(NumberOfCellsPerBucket,int,1,VTK_LARGE_INTEGER);
+  vtkGetMacro(NumberOfCellsPerBucket,int);
+
+  // Description:
+  // Set/Get the largest number of cells in a batch returned by
+  // GetCellBatch().
+  vtkSetClampMacro(BatchSize,vtkIdType,1,VTK_LARGE_ID);
+  vtkGetMacro(BatchSize,vtkIdType);
+
+  // Description:
+  // Set/get the number of threads computing the ranges of the cells when
+  // the tree is built. Defaults to 1.
+  vtkSetClampMacro(NumberOfThreads, int, 1, VTK_LARGE_INTEGER);
+  vtkGetMacro(NumberOfThreads, int);
+
+  // Description:
+  // Construct the span space from the dataset provided. Checks build times
+  // and modified time from input and reconstructs the tree if necessary.
+  virtual void BuildTree();
+
+  // Description:
+  // Initialize locator. Frees memory and resets object as appropriate.
+  virtual void Initialize();
+
+  // Description:
+  // Begin to traverse the cells based on a scalar value. Returned cells
+  // will have scalar values that span the scalar value specified.
+  virtual void InitTraversal(double scalarValue);
+
+  // Description:
+  // Return the next cell that contains the scalar value specified to
+  // initialize traversal. The value NULL is returned if the list is
+  // exhausted. Make sure that InitTraversal() has been invoked first or
+  // you'll get erratic behavior.
+  virtual vtkCell *GetNextCell(vtkIdType &cellId, vtkIdList* &ptIds,
+                               vtkDataArray *cellScalars);
+
+  // Description:
+  // Get the batches of candidate cells of the scalar value specified to
+  // InitTraversal(). See vtkScalarTree.
+  virtual vtkIdType GetNumberOfCellBatches();
+  virtual const vtkIdType *GetCellBatch(vtkIdType batchNum,
+                                        vtkIdType &numCells);
+
+protected:
+  vtkSpanSpace();
+  ~vtkSpanSpace();
+
+  int Resolution;
+  int ComputeResolution;
+  int NumberOfCellsPerBucket;
+  vtkIdType BatchSize;
+  int NumberOfThreads;
+
+//BTX
+  vtkSpanSpaceInternals *Internals;
+//ETX
+
+private:
+  vtkSpanSpace(const vtkSpanSpace&);  // Not implemented.
+  void operator=(const vtkSpanSpace&);  // Not implemented.
+};
+
+#endif
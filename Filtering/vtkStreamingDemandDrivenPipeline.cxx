@@ -220,6 +220,17 @@ int vtkStreamingDemandDrivenPipeline
   return this->Superclass::ProcessRequest(request, inInfoVec, outInfoVec);
 }
 
+//----------------------------------------------------------------------------
+vtkInformationRequestKey*
+vtkStreamingDemandDrivenPipeline::GetProfiledRequest(vtkInformation* request)
+{
+  if(request->Has(REQUEST_UPDATE_EXTENT()))
+    {
+    return REQUEST_UPDATE_EXTENT();
+    }
+  return this->Superclass::GetProfiledRequest(request);
+}
+
 //----------------------------------------------------------------------------
 int vtkStreamingDemandDrivenPipeline::Update()
 {
@@ -286,6 +286,9 @@ protected:
   vtkStreamingDemandDrivenPipeline();
   ~vtkStreamingDemandDrivenPipeline();
 
+  // Adds the REQUEST_UPDATE_EXTENT pass to the profiled ones.
+  virtual vtkInformationRequestKey* GetProfiledRequest(vtkInformation* request);
+
   // Description:
   // Called before RequestUpdateExtent() pass on the algorithm. Here we remove
   // all update-related keys from the input information.
@@ -309,8 +309,8 @@ void vtkStructuredGrid::GetCell(vtkIdType cellId, vtkGenericCell *cell)
     return;
     }
 
-  // Update dimensions
-  this->GetDimensions();
+  int dims[3];
+  this->GetDimensions(dims);
 
   switch (this->DataDescription)
     {
@@ -343,11 +343,11 @@ void vtkStructuredGrid::GetCell(vtkIdType cellId, vtkGenericCell *cell)
 
     case VTK_XY_PLANE:
       cell->SetCellTypeToQuad();
-      i = cellId % (this->Dimensions[0]-1);
-      j = cellId / (this->Dimensions[0]-1);
-      idx = i + j*this->Dimensions[0];
+      i = cellId % (dims[0]-1);
+      j = cellId / (dims[0]-1);
+      idx = i + j*dims[0];
       offset1 = 1;
-      offset2 = this->Dimensions[0];
+      offset2 = dims[0];
 
       cell->PointIds->SetId(0,idx);
       cell->PointIds->SetId(1,idx+offset1);
@@ -357,11 +357,11 @@ void vtkStructuredGrid::GetCell(vtkIdType cellId, vtkGenericCell *cell)
 
     case VTK_YZ_PLANE:
       cell->SetCellTypeToQuad();
-      j = cellId % (this->Dimensions[1]-1);
-      k = cellId / (this->Dimensions[1]-1);
-      idx = j + k*this->Dimensions[1];
+      j = cellId % (dims[1]-1);
+      k = cellId / (dims[1]-1);
+      idx = j + k*dims[1];
       offset1 = 1;
-      offset2 = this->Dimensions[1];
+      offset2 = dims[1];
 
       cell->PointIds->SetId(0,idx);
       cell->PointIds->SetId(1,idx+offset1);
@@ -371,11 +371,11 @@ void vtkStructuredGrid::GetCell(vtkIdType cellId, vtkGenericCell *cell)
 
     case VTK_XZ_PLANE:
       cell->SetCellTypeToQuad();
-      i = cellId % (this->Dimensions[0]-1);
-      k = cellId / (this->Dimensions[0]-1);
-      idx = i + k*this->Dimensions[0];
+      i = cellId % (dims[0]-1);
+      k = cellId / (dims[0]-1);
+      idx = i + k*dims[0];
       offset1 = 1;
-      offset2 = this->Dimensions[0];
+      offset2 = dims[0];
 
       cell->PointIds->SetId(0,idx);
       cell->PointIds->SetId(1,idx+offset1);
@@ -385,13 +385,13 @@ void vtkStructuredGrid::GetCell(vtkIdType cellId, vtkGenericCell *cell)
 
     case VTK_XYZ_GRID:
       cell->SetCellTypeToHexahedron();
-      d01 = this->Dimensions[0]*this->Dimensions[1];
-      i = cellId % (this->Dimensions[0] - 1);
-      j = (cellId / (this->Dimensions[0] - 1)) % (this->Dimensions[1] - 1);
-      k = cellId / ((this->Dimensions[0] - 1) * (this->Dimensions[1] - 1));
-      idx = i+ j*this->Dimensions[0] + k*d01;
+      d01 = dims[0]*dims[1];
+      i = cellId % (dims[0] - 1);
+      j = (cellId / (dims[0] - 1)) % (dims[1] - 1);
+      k = cellId / ((dims[0] - 1) * (dims[1] - 1));
+      idx = i+ j*dims[0] + k*d01;
       offset1 = 1;
-      offset2 = this->Dimensions[0];
+      offset2 = dims[0];
 
       cell->PointIds->SetId(0,idx);
       cell->PointIds->SetId(1,idx+offset1);
@@ -438,8 +438,8 @@ void vtkStructuredGrid::GetCellBounds(vtkIdType cellId, double bounds[6])
   
   vtkMath::UninitializeBounds(bounds);
   
-  // Update dimensions
-  this->GetDimensions();
+  int dims[3];
+  this->GetDimensions(dims);
 
   switch (this->DataDescription)
     {
@@ -469,27 +469,27 @@ void vtkStructuredGrid::GetCellBounds(vtkIdType cellId, double bounds[6])
     case VTK_XZ_PLANE:
       if (this->DataDescription == VTK_XY_PLANE)
         {
-        i = cellId % (this->Dimensions[0]-1);
-        j = cellId / (this->Dimensions[0]-1);
-        idx = i + j*this->Dimensions[0];
+        i = cellId % (dims[0]-1);
+        j = cellId / (dims[0]-1);
+        idx = i + j*dims[0];
         offset1 = 1;
-        offset2 = this->Dimensions[0];
+        offset2 = dims[0];
         }
       else if (this->DataDescription == VTK_YZ_PLANE)
         {
-        j = cellId % (this->Dimensions[1]-1);
-        k = cellId / (this->Dimensions[1]-1);
-        idx = j + k*this->Dimensions[1];
+        j = cellId % (dims[1]-1);
+        k = cellId / (dims[1]-1);
+        idx = j + k*dims[1];
         offset1 = 1;
-        offset2 = this->Dimensions[1];
+        offset2 = dims[1];
         }
       else if (this->DataDescription == VTK_XZ_PLANE)
         {
-        i = cellId % (this->Dimensions[0]-1);
-        k = cellId / (this->Dimensions[0]-1);
-        idx = i + k*this->Dimensions[0];
+        i = cellId % (dims[0]-1);
+        k = cellId / (dims[0]-1);
+        idx = i + k*dims[0];
         offset1 = 1;
-        offset2 = this->Dimensions[0];
+        offset2 = dims[0];
         }
 
       this->Points->GetPoint(idx, x);
@@ -509,13 +509,13 @@ void vtkStructuredGrid::GetCellBounds(vtkIdType cellId, double bounds[6])
       break;
 
     case VTK_XYZ_GRID:
-      d01 = this->Dimensions[0]*this->Dimensions[1];
-      i = cellId % (this->Dimensions[0] - 1);
-      j = (cellId / (this->Dimensions[0] - 1)) % (this->Dimensions[1] - 1);
-      k = cellId / ((this->Dimensions[0] - 1) * (this->Dimensions[1] - 1));
-      idx = i+ j*this->Dimensions[0] + k*d01;
+      d01 = dims[0]*dims[1];
+      i = cellId % (dims[0] - 1);
+      j = (cellId / (dims[0] - 1)) % (dims[1] - 1);
+      k = cellId / ((dims[0] - 1) * (dims[1] - 1));
+      idx = i+ j*dims[0] + k*d01;
       offset1 = 1;
-      offset2 = this->Dimensions[0];
+      offset2 = dims[0];
 
       this->Points->GetPoint(idx, x);
       bounds[0] = bounds[1] = x[0];
@@ -622,13 +622,13 @@ unsigned char vtkStructuredGrid::IsCellVisible(vtkIdType cellId)
     return 0;
     }
 
-  // Update dimensions
-  this->GetDimensions();
+  int dims[3];
+  this->GetDimensions(dims);
 
   int numIds=0;
   vtkIdType ptIds[8];
   int iMin, iMax, jMin, jMax, kMin, kMax;
-  vtkIdType d01 = this->Dimensions[0]*this->Dimensions[1];
+  vtkIdType d01 = dims[0]*dims[1];
   iMin = iMax = jMin = jMax = kMin = kMax = 0;
 
   switch (this->DataDescription)
@@ -638,85 +638,85 @@ unsigned char vtkStructuredGrid::IsCellVisible(vtkIdType cellId)
 
     case VTK_SINGLE_POINT: // cellId can only be = 0
       numIds = 1;
-      ptIds[0] = iMin + jMin*this->Dimensions[0] + kMin*d01;
+      ptIds[0] = iMin + jMin*dims[0] + kMin*d01;
       break;
 
     case VTK_X_LINE:
       iMin = cellId;
       iMax = cellId + 1;
       numIds = 2;
-      ptIds[0] = iMin + jMin*this->Dimensions[0] + kMin*d01;
-      ptIds[1] = iMax + jMin*this->Dimensions[0] + kMin*d01;
+      ptIds[0] = iMin + jMin*dims[0] + kMin*d01;
+      ptIds[1] = iMax + jMin*dims[0] + kMin*d01;
       break;
 
     case VTK_Y_LINE:
       jMin = cellId;
       jMax = cellId + 1;
       numIds = 2;
-      ptIds[0] = iMin + jMin*this->Dimensions[0] + kMin*d01;
-      ptIds[1] = iMin + jMax*this->Dimensions[0] + kMin*d01;
+      ptIds[0] = iMin + jMin*dims[0] + kMin*d01;
+      ptIds[1] = iMin + jMax*dims[0] + kMin*d01;
       break;
 
     case VTK_Z_LINE:
       kMin = cellId;
       kMax = cellId + 1;
       numIds = 2;
-      ptIds[0] = iMin + jMin*this->Dimensions[0] + kMin*d01;
-      ptIds[1] = iMin + jMin*this->Dimensions[0] + kMax*d01;
+      ptIds[0] = iMin + jMin*dims[0] + kMin*d01;
+      ptIds[1] = iMin + jMin*dims[0] + kMax*d01;
       break;
 
     case VTK_XY_PLANE:
-      iMin = cellId % (this->Dimensions[0]-1);
+      iMin = cellId % (dims[0]-1);
       iMax = iMin + 1;
-      jMin = cellId / (this->Dimensions[0]-1);
+      jMin = cellId / (dims[0]-1);
       jMax = jMin + 1;
       numIds = 4;
-      ptIds[0] = iMin + jMin*this->Dimensions[0] + kMin*d01;
-      ptIds[1] = iMax + jMin*this->Dimensions[0] + kMin*d01;
-      ptIds[2] = iMax + jMax*this->Dimensions[0] + kMin*d01;
-      ptIds[3] = iMin + jMax*this->Dimensions[0] + kMin*d01;
+      ptIds[0] = iMin + jMin*dims[0] + kMin*d01;
+      ptIds[1] = iMax + jMin*dims[0] + kMin*d01;
+      ptIds[2] = iMax + jMax*dims[0] + kMin*d01;
+      ptIds[3] = iMin + jMax*dims[0] + kMin*d01;
       break;
 
     case VTK_YZ_PLANE:
-      jMin = cellId % (this->Dimensions[1]-1);
+      jMin = cellId % (dims[1]-1);
       jMax = jMin + 1;
-      kMin = cellId / (this->Dimensions[1]-1);
+      kMin = cellId / (dims[1]-1);
       kMax = kMin + 1;
       numIds = 4;
-      ptIds[0] = iMin + jMin*this->Dimensions[0] + kMin*d01;
-      ptIds[1] = iMin + jMax*this->Dimensions[0] + kMin*d01;
-      ptIds[2] = iMin + jMax*this->Dimensions[0] + kMax*d01;
-      ptIds[3] = iMin + jMin*this->Dimensions[0] + kMax*d01;
+      ptIds[0] = iMin + jMin*dims[0] + kMin*d01;
+      ptIds[1] = iMin + jMax*dims[0] + kMin*d01;
+      ptIds[2] = iMin + jMax*dims[0] + kMax*d01;
+      ptIds[3] = iMin + jMin*dims[0] + kMax*d01;
       break;
 
     case VTK_XZ_PLANE:
-      iMin = cellId % (this->Dimensions[0]-1);
+      iMin = cellId % (dims[0]-1);
       iMax = iMin + 1;
-      kMin = cellId / (this->Dimensions[0]-1);
+      kMin = cellId / (dims[0]-1);
       kMax = kMin + 1;
       numIds = 4;
-      ptIds[0] = iMin + jMin*this->Dimensions[0] + kMin*d01;
-      ptIds[1] = iMax + jMin*this->Dimensions[0] + kMin*d01;
-      ptIds[2] = iMax + jMin*this->Dimensions[0] + kMax*d01;
-      ptIds[3] = iMin + jMin*this->Dimensions[0] + kMax*d01;
+      ptIds[0] = iMin + jMin*dims[0] + kMin*d01;
+      ptIds[1] = iMax + jMin*dims[0] + kMin*d01;
+      ptIds[2] = iMax + jMin*dims[0] + kMax*d01;
+      ptIds[3] = iMin + jMin*dims[0] + kMax*d01;
       break;
 
     case VTK_XYZ_GRID:
-      iMin = cellId % (this->Dimensions[0] - 1);
+      iMin = cellId % (dims[0] - 1);
       iMax = iMin + 1;
-      jMin = (cellId / (this->Dimensions[0] - 1)) % (this->Dimensions[1] - 1);
+      jMin = (cellId / (dims[0] - 1)) % (dims[1] - 1);
       jMax = jMin + 1;
-      kMin = cellId / ((this->Dimensions[0] - 1) * (this->Dimensions[1] - 1));
+      kMin = cellId / ((dims[0] - 1) * (dims[1] - 1));
       kMax = kMin + 1;
       numIds = 8;
-      ptIds[0] = iMin + jMin*this->Dimensions[0] + kMin*d01;
-      ptIds[1] = iMax + jMin*this->Dimensions[0] + kMin*d01;
-      ptIds[2] = iMax + jMax*this->Dimensions[0] + kMin*d01;
-      ptIds[3] = iMin + jMax*this->Dimensions[0] + kMin*d01;
-      ptIds[4] = iMin + jMin*this->Dimensions[0] + kMax*d01;
-      ptIds[5] = iMax + jMin*this->Dimensions[0] + kMax*d01;
-      ptIds[6] = iMax + jMax*this->Dimensions[0] + kMax*d01;
-      ptIds[7] = iMin + jMax*this->Dimensions[0] + kMax*d01;
+      ptIds[0] = iMin + jMin*dims[0] + kMin*d01;
+      ptIds[1] = iMax + jMin*dims[0] + kMin*d01;
+      ptIds[2] = iMax + jMax*dims[0] + kMin*d01;
+      ptIds[3] = iMin + jMax*dims[0] + kMin*d01;
+      ptIds[4] = iMin + jMin*dims[0] + kMax*d01;
+      ptIds[5] = iMax + jMin*dims[0] + kMax*d01;
+      ptIds[6] = iMax + jMax*dims[0] + kMax*d01;
+      ptIds[7] = iMin + jMax*dims[0] + kMax*d01;
       break;
     }
 
@@ -749,11 +749,11 @@ void vtkStructuredGrid::SetDimensions(int dim[3])
 // Get the points defining a cell. (See vtkDataSet for more info.)
 void vtkStructuredGrid::GetCellPoints(vtkIdType cellId, vtkIdList *ptIds)
 {
-  // Update dimensions
-  this->GetDimensions();
+  int dims[3];
+  this->GetDimensions(dims);
 
   int iMin, iMax, jMin, jMax, kMin, kMax;
-  vtkIdType d01 = this->Dimensions[0]*this->Dimensions[1];
+  vtkIdType d01 = dims[0]*dims[1];
  
   ptIds->Reset();
   iMin = iMax = jMin = jMax = kMin = kMax = 0;
@@ -765,85 +765,85 @@ void vtkStructuredGrid::GetCellPoints(vtkIdType cellId, vtkIdList *ptIds)
 
     case VTK_SINGLE_POINT: // cellId can only be = 0
       ptIds->SetNumberOfIds(1);
-      ptIds->SetId(0, iMin + jMin*this->Dimensions[0] + kMin*d01);
+      ptIds->SetId(0, iMin + jMin*dims[0] + kMin*d01);
       break;
 
     case VTK_X_LINE:
       iMin = cellId;
       iMax = cellId + 1;
       ptIds->SetNumberOfIds(2);
-      ptIds->SetId(0, iMin + jMin*this->Dimensions[0] + kMin*d01);
-      ptIds->SetId(1, iMax + jMin*this->Dimensions[0] + kMin*d01);
+      ptIds->SetId(0, iMin + jMin*dims[0] + kMin*d01);
+      ptIds->SetId(1, iMax + jMin*dims[0] + kMin*d01);
       break;
 
     case VTK_Y_LINE:
       jMin = cellId;
       jMax = cellId + 1;
       ptIds->SetNumberOfIds(2);
-      ptIds->SetId(0, iMin + jMin*this->Dimensions[0] + kMin*d01);
-      ptIds->SetId(1, iMin + jMax*this->Dimensions[0] + kMin*d01);
+      ptIds->SetId(0, iMin + jMin*dims[0] + kMin*d01);
+      ptIds->SetId(1, iMin + jMax*dims[0] + kMin*d01);
       break;
 
     case VTK_Z_LINE:
       kMin = cellId;
       kMax = cellId + 1;
       ptIds->SetNumberOfIds(2);
-      ptIds->SetId(0, iMin + jMin*this->Dimensions[0] + kMin*d01);
-      ptIds->SetId(1, iMin + jMin*this->Dimensions[0] + kMax*d01);
+      ptIds->SetId(0, iMin + jMin*dims[0] + kMin*d01);
+      ptIds->SetId(1, iMin + jMin*dims[0] + kMax*d01);
       break;
 
     case VTK_XY_PLANE:
-      iMin = cellId % (this->Dimensions[0]-1);
+      iMin = cellId % (dims[0]-1);
       iMax = iMin + 1;
-      jMin = cellId / (this->Dimensions[0]-1);
+      jMin = cellId / (dims[0]-1);
       jMax = jMin + 1;
       ptIds->SetNumberOfIds(4);
-      ptIds->SetId(0, iMin + jMin*this->Dimensions[0] + kMin*d01);
-      ptIds->SetId(1, iMax + jMin*this->Dimensions[0] + kMin*d01);
-      ptIds->SetId(2, iMax + jMax*this->Dimensions[0] + kMin*d01);
-      ptIds->SetId(3, iMin + jMax*this->Dimensions[0] + kMin*d01);
+      ptIds->SetId(0, iMin + jMin*dims[0] + kMin*d01);
+      ptIds->SetId(1, iMax + jMin*dims[0] + kMin*d01);
+      ptIds->SetId(2, iMax + jMax*dims[0] + kMin*d01);
+      ptIds->SetId(3, iMin + jMax*dims[0] + kMin*d01);
       break;
 
     case VTK_YZ_PLANE:
-      jMin = cellId % (this->Dimensions[1]-1);
+      jMin = cellId % (dims[1]-1);
       jMax = jMin + 1;
-      kMin = cellId / (this->Dimensions[1]-1);
+      kMin = cellId / (dims[1]-1);
       kMax = kMin + 1;
       ptIds->SetNumberOfIds(4);
-      ptIds->SetId(0, iMin + jMin*this->Dimensions[0] + kMin*d01);
-      ptIds->SetId(1, iMin + jMax*this->Dimensions[0] + kMin*d01);
-      ptIds->SetId(2, iMin + jMax*this->Dimensions[0] + kMax*d01);
-      ptIds->SetId(3, iMin + jMin*this->Dimensions[0] + kMax*d01);
+      ptIds->SetId(0, iMin + jMin*dims[0] + kMin*d01);
+      ptIds->SetId(1, iMin + jMax*dims[0] + kMin*d01);
+      ptIds->SetId(2, iMin + jMax*dims[0] + kMax*d01);
+      ptIds->SetId(3, iMin + jMin*dims[0] + kMax*d01);
       break;
 
     case VTK_XZ_PLANE:
-      iMin = cellId % (this->Dimensions[0]-1);
+      iMin = cellId % (dims[0]-1);
       iMax = iMin + 1;
-      kMin = cellId / (this->Dimensions[0]-1);
+      kMin = cellId / (dims[0]-1);
       kMax = kMin + 1;
       ptIds->SetNumberOfIds(4);
-      ptIds->SetId(0, iMin + jMin*this->Dimensions[0] + kMin*d01);
-      ptIds->SetId(1, iMax + jMin*this->Dimensions[0] + kMin*d01);
-      ptIds->SetId(2, iMax + jMin*this->Dimensions[0] + kMax*d01);
-      ptIds->SetId(3, iMin + jMin*this->Dimensions[0] + kMax*d01);
+      ptIds->SetId(0, iMin + jMin*dims[0] + kMin*d01);
+      ptIds->SetId(1, iMax + jMin*dims[0] + kMin*d01);
+      ptIds->SetId(2, iMax + jMin*dims[0] + kMax*d01);
+      ptIds->SetId(3, iMin + jMin*dims[0] + kMax*d01);
       break;
 
     case VTK_XYZ_GRID:
-      iMin = cellId % (this->Dimensions[0] - 1);
+      iMin = cellId % (dims[0] - 1);
       iMax = iMin + 1;
-      jMin = (cellId / (this->Dimensions[0] - 1)) % (this->Dimensions[1] - 1);
+      jMin = (cellId / (dims[0] - 1)) % (dims[1] - 1);
       jMax = jMin + 1;
-      kMin = cellId / ((this->Dimensions[0] - 1) * (this->Dimensions[1] - 1));
+      kMin = cellId / ((dims[0] - 1) * (dims[1] - 1));
       kMax = kMin + 1;
       ptIds->SetNumberOfIds(8);
-      ptIds->SetId(0, iMin + jMin*this->Dimensions[0] + kMin*d01);
-      ptIds->SetId(1, iMax + jMin*this->Dimensions[0] + kMin*d01);
-      ptIds->SetId(2, iMax + jMax*this->Dimensions[0] + kMin*d01);
-      ptIds->SetId(3, iMin + jMax*this->Dimensions[0] + kMin*d01);
-      ptIds->SetId(4, iMin + jMin*this->Dimensions[0] + kMax*d01);
-      ptIds->SetId(5, iMax + jMin*this->Dimensions[0] + kMax*d01);
-      ptIds->SetId(6, iMax + jMax*this->Dimensions[0] + kMax*d01);
-      ptIds->SetId(7, iMin + jMax*this->Dimensions[0] + kMax*d01);
+      ptIds->SetId(0, iMin + jMin*dims[0] + kMin*d01);
+      ptIds->SetId(1, iMax + jMin*dims[0] + kMin*d01);
+      ptIds->SetId(2, iMax + jMax*dims[0] + kMin*d01);
+      ptIds->SetId(3, iMin + jMax*dims[0] + kMin*d01);
+      ptIds->SetId(4, iMin + jMin*dims[0] + kMax*d01);
+      ptIds->SetId(5, iMax + jMin*dims[0] + kMax*d01);
+      ptIds->SetId(6, iMax + jMax*dims[0] + kMax*d01);
+      ptIds->SetId(7, iMin + jMax*dims[0] + kMax*d01);
       break;
     }
 }
@@ -96,7 +96,9 @@ public:
   void SetDimensions(int dim[3]);
 
   // Description:
-  // Get dimensions of this structured points dataset.
+  // Get dimensions of this structured points dataset. The second signature
+  // does not write to the dataset, so the cell accessors use it to stay
+  // safe to call from several threads at once.
   virtual int *GetDimensions ();
   virtual void GetDimensions (int dim[3]);
 
@@ -21,6 +21,7 @@
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkMultiThreader.h"
+#include "vtkMutexLock.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
@@ -32,6 +33,10 @@ vtkThreadedImageAlgorithm::vtkThreadedImageAlgorithm()
 {
   this->Threader = vtkMultiThreader::New();
   this->NumberOfThreads = this->Threader->GetNumberOfThreads();
+  this->UseThreadPool = 0;
+  this->UseDynamicScheduling = 0;
+  this->MinimumBlockSize = 16384;
+  this->SplitMode = VTK_IMAGE_SPLIT_MODE_SLAB;
 }
 
 //----------------------------------------------------------------------------
@@ -46,6 +51,27 @@ void vtkThreadedImageAlgorithm::PrintSelf(ostream& os, vtkIndent indent)
   this->Superclass::PrintSelf(os,indent);
   
   os << indent << "NumberOfThreads: " << this->NumberOfThreads << "\n";
+  os << indent << "UseThreadPool: "
+     << (this->UseThreadPool ? "On" : "Off") << "\n";
+  os << indent << "UseDynamicScheduling: "
+     << (this->UseDynamicScheduling ? "On" : "Off") << "\n";
+  os << indent << "MinimumBlockSize: " << this->MinimumBlockSize << "\n";
+  os << indent << "SplitMode: " << this->GetSplitModeAsString() << "\n";
+}
+
+//----------------------------------------------------------------------------
+const char *vtkThreadedImageAlgorithm::GetSplitModeAsString()
+{
+  switch (this->SplitMode)
+    {
+    case VTK_IMAGE_SPLIT_MODE_SLAB:
+      return "Slab";
+    case VTK_IMAGE_SPLIT_MODE_BEAM:
+      return "Beam";
+    case VTK_IMAGE_SPLIT_MODE_BLOCK:
+      return "Block";
+    }
+  return "Unknown";
 }
 
 struct vtkImageThreadStruct
@@ -56,6 +82,13 @@ struct vtkImageThreadStruct
   vtkInformationVector *OutputsInfo;
   vtkImageData   ***Inputs;
   vtkImageData   **Outputs;
+
+  // Used by the dynamic scheduling only.
+  int Extent[6];
+  int NumberOfBlocks;
+  int BlockSplitTotal;
+  int NextBlock;
+  vtkSimpleMutexLock *BlockLock;
 };
 
 //----------------------------------------------------------------------------
@@ -80,6 +113,65 @@ int vtkThreadedImageAlgorithm::SplitExtent(int splitExt[6],
   // start with same extent
   memcpy(splitExt, startExt, 6 * sizeof(int));
 
+  if (this->SplitMode != VTK_IMAGE_SPLIT_MODE_SLAB)
+    {
+    // Divide the slowest varying axes first, so that every piece covers
+    // long runs of contiguous memory. Never make more than total pieces.
+    int size[3], divisions[3], index[3];
+    int pieces = 1;
+    for (splitAxis = 0; splitAxis < 3; ++splitAxis)
+      {
+      size[splitAxis] = startExt[splitAxis*2+1] - startExt[splitAxis*2] + 1;
+      divisions[splitAxis] = 1;
+      if (size[splitAxis] <= 0)
+        {
+        // empty extent so cannot split
+        return 1;
+        }
+      }
+    int lastAxis = (this->SplitMode == VTK_IMAGE_SPLIT_MODE_BEAM ? 1 : 0);
+    for (splitAxis = 2; splitAxis >= lastAxis; --splitAxis)
+      {
+      int needed = total / pieces;
+      divisions[splitAxis] =
+        (size[splitAxis] < needed ? size[splitAxis] : needed);
+      pieces *= divisions[splitAxis];
+      }
+    // In beam mode, rows are split only when nothing else can be.
+    if (pieces == 1 && size[0] > 1)
+      {
+      divisions[0] = (size[0] < total ? size[0] : total);
+      pieces = divisions[0];
+      }
+    if (pieces == 1)
+      {
+      vtkDebugMacro("  Cannot Split");
+      return 1;
+      }
+
+    if (num < pieces)
+      {
+      index[0] = num % divisions[0];
+      index[1] = (num / divisions[0]) % divisions[1];
+      index[2] = num / (divisions[0]*divisions[1]);
+      for (splitAxis = 0; splitAxis < 3; ++splitAxis)
+        {
+        vtkIdType axisSize = size[splitAxis];
+        splitExt[splitAxis*2] = startExt[splitAxis*2] + static_cast<int>(
+          axisSize*index[splitAxis]/divisions[splitAxis]);
+        splitExt[splitAxis*2+1] = startExt[splitAxis*2] - 1 +
+          static_cast<int>(
+            axisSize*(index[splitAxis]+1)/divisions[splitAxis]);
+        }
+      }
+
+    vtkDebugMacro("  Split Piece: ( " <<splitExt[0]<< ", " <<splitExt[1]<< ", "
+                  << splitExt[2] << ", " << splitExt[3] << ", "
+                  << splitExt[4] << ", " << splitExt[5] << ")");
+
+    return pieces;
+    }
+
   splitAxis = 2;
   min = startExt[4];
   max = startExt[5];
@@ -122,22 +214,12 @@ int vtkThreadedImageAlgorithm::SplitExtent(int splitExt[6],
 }
 
 
-// this mess is really a simple function. All it does is call
-// the ThreadedExecute method after setting the correct
-// extent for this thread. Its just a pain to calculate
-// the correct extent.
-VTK_THREAD_RETURN_TYPE vtkThreadedImageAlgorithmThreadedExecute( void *arg )
+//----------------------------------------------------------------------------
+// Get the extent to split among the threads. Returns 0 if there is
+// nothing to execute.
+static int vtkThreadedImageAlgorithmGetExtent(vtkImageThreadStruct *str,
+                                              int ext[6])
 {
-  vtkImageThreadStruct *str;
-  int ext[6], splitExt[6], total;
-  int threadId, threadCount;
-  
-  threadId = static_cast<vtkMultiThreader::ThreadInfo *>(arg)->ThreadID;
-  threadCount = static_cast<vtkMultiThreader::ThreadInfo *>(arg)->NumberOfThreads;
-  
-  str = static_cast<vtkImageThreadStruct *>
-    (static_cast<vtkMultiThreader::ThreadInfo *>(arg)->UserData);
-
   // if we have an output
   if (str->Filter->GetNumberOfOutputPorts())
     {
@@ -149,7 +231,7 @@ VTK_THREAD_RETURN_TYPE vtkThreadedImageAlgorithmThreadedExecute( void *arg )
     // update directly, for now an error
     if (outputPort == -1)
       {
-      return VTK_THREAD_RETURN_VALUE;
+      return 0;
       }
   
     // get the update extent from the output port
@@ -179,10 +261,34 @@ VTK_THREAD_RETURN_TYPE vtkThreadedImageAlgorithmThreadedExecute( void *arg )
       }
     if (inPort >= str->Filter->GetNumberOfInputPorts())
       {
-      return VTK_THREAD_RETURN_VALUE;
+      return 0;
       }
     }
+
+  return 1;
+}
+
+// this mess is really a simple function. All it does is call
+// the ThreadedExecute method after setting the correct
+// extent for this thread. Its just a pain to calculate
+// the correct extent.
+VTK_THREAD_RETURN_TYPE vtkThreadedImageAlgorithmThreadedExecute( void *arg )
+{
+  vtkImageThreadStruct *str;
+  int ext[6], splitExt[6], total;
+  int threadId, threadCount;
+  
+  threadId = static_cast<vtkMultiThreader::ThreadInfo *>(arg)->ThreadID;
+  threadCount = static_cast<vtkMultiThreader::ThreadInfo *>(arg)->NumberOfThreads;
   
+  str = static_cast<vtkImageThreadStruct *>
+    (static_cast<vtkMultiThreader::ThreadInfo *>(arg)->UserData);
+
+  if (!vtkThreadedImageAlgorithmGetExtent(str, ext))
+    {
+    return VTK_THREAD_RETURN_VALUE;
+    }
+
   // execute the actual method with appropriate extent
   // first find out how many pieces extent can be split into.
   total = str->Filter->SplitExtent(splitExt, ext, threadId, threadCount);
@@ -211,6 +317,46 @@ VTK_THREAD_RETURN_TYPE vtkThreadedImageAlgorithmThreadedExecute( void *arg )
   return VTK_THREAD_RETURN_VALUE;
 }
 
+// With dynamic scheduling each thread takes blocks of the extent from a
+// shared counter until there are none left.
+VTK_THREAD_RETURN_TYPE vtkThreadedImageAlgorithmDynamicExecute( void *arg )
+{
+  vtkImageThreadStruct *str;
+  int splitExt[6], block;
+  int threadId;
+
+  threadId = static_cast<vtkMultiThreader::ThreadInfo *>(arg)->ThreadID;
+  str = static_cast<vtkImageThreadStruct *>
+    (static_cast<vtkMultiThreader::ThreadInfo *>(arg)->UserData);
+
+  for (;;)
+    {
+    str->BlockLock->Lock();
+    block = str->NextBlock++;
+    str->BlockLock->Unlock();
+    if (block >= str->NumberOfBlocks)
+      {
+      break;
+      }
+
+    str->Filter->SplitExtent(splitExt, str->Extent, block,
+                             str->BlockSplitTotal);
+    // skip empty blocks
+    if (splitExt[1] < splitExt[0] ||
+        splitExt[3] < splitExt[2] ||
+        splitExt[5] < splitExt[4])
+      {
+      continue;
+      }
+    str->Filter->ThreadedRequestData(str->Request,
+                                     str->InputsInfo, str->OutputsInfo,
+                                     str->Inputs, str->Outputs,
+                                     splitExt, threadId);
+    }
+
+  return VTK_THREAD_RETURN_VALUE;
+}
+
 
 //----------------------------------------------------------------------------
 // This is the superclasses style of Execute method.  Convert it into
@@ -282,9 +428,45 @@ int vtkThreadedImageAlgorithm::RequestData(
     this->CopyAttributeData(str.Inputs[0][0],str.Outputs[0],inputVector);
     }
     
+  this->Threader->SetUseThreadPool(this->UseThreadPool);
   this->Threader->SetNumberOfThreads(this->NumberOfThreads);
   this->Threader->SetSingleMethod(vtkThreadedImageAlgorithmThreadedExecute, &str);  
 
+  vtkSimpleMutexLock blockLock;
+  str.BlockLock = &blockLock;
+  str.NextBlock = 0;
+  str.NumberOfBlocks = 0;
+  str.BlockSplitTotal = 1;
+  if (this->UseDynamicScheduling &&
+      vtkThreadedImageAlgorithmGetExtent(&str, str.Extent))
+    {
+    // Ask for as many blocks as the minimum block size allows; the split
+    // may produce fewer.
+    vtkIdType numberOfVoxels = 1;
+    for (i = 0; i < 3; ++i)
+      {
+      int size = str.Extent[2*i+1] - str.Extent[2*i] + 1;
+      numberOfVoxels *= (size > 0 ? size : 0);
+      }
+    vtkIdType numberOfBlocks = numberOfVoxels / this->MinimumBlockSize;
+    if (numberOfBlocks > VTK_LARGE_INTEGER)
+      {
+      numberOfBlocks = VTK_LARGE_INTEGER;
+      }
+    str.BlockSplitTotal =
+      (numberOfBlocks > 1 ? static_cast<int>(numberOfBlocks) : 1);
+
+    int splitExt[6];
+    str.NumberOfBlocks = (numberOfVoxels > 0 ?
+      this->SplitExtent(splitExt, str.Extent, 0, str.BlockSplitTotal) : 0);
+    this->Threader->SetNumberOfThreads(
+      str.NumberOfBlocks < this->NumberOfThreads ?
+      (str.NumberOfBlocks > 1 ? str.NumberOfBlocks : 1) :
+      this->NumberOfThreads);
+    this->Threader->SetSingleMethod(vtkThreadedImageAlgorithmDynamicExecute,
+                                    &str);
+    }
+
   // always shut off debugging to avoid threading problems with GetMacros
   int debug = this->Debug;
   this->Debug = 0;
@@ -19,6 +19,12 @@
 // into smaller extents so that the vtkImageData limits are observed. It 
 // also provides support for multithreading. If you don't need any of this
 // functionality, consider using vtkSimpleImageToImageAlgorithm instead.
+//
+// By default the update extent is split into one piece per thread. When
+// UseDynamicScheduling is on, it is instead split into many small blocks
+// (no smaller than MinimumBlockSize voxels) and each thread repeatedly
+// takes the next unprocessed block until none are left, so that threads
+// that finish early help with the rest of the extent.
 // .SECTION See also
 // vtkSimpleImageToImageAlgorithm
 
@@ -27,6 +33,10 @@
 
 #include "vtkImageAlgorithm.h"
 
+#define VTK_IMAGE_SPLIT_MODE_SLAB  0
+#define VTK_IMAGE_SPLIT_MODE_BEAM  1
+#define VTK_IMAGE_SPLIT_MODE_BLOCK 2
+
 class vtkImageData;
 class vtkMultiThreader;
 
@@ -58,6 +68,49 @@ public:
   vtkSetClampMacro( NumberOfThreads, int, 1, VTK_MAX_THREADS );
   vtkGetMacro( NumberOfThreads, int );
 
+  // Description:
+  // When on, the threads are taken from the process-wide pool of
+  // vtkMultiThreader instead of being created on every update (see
+  // vtkMultiThreader::SetUseThreadPool()). Initial value is off.
+  vtkSetMacro(UseThreadPool, int);
+  vtkGetMacro(UseThreadPool, int);
+  vtkBooleanMacro(UseThreadPool, int);
+
+  // Description:
+  // When on, split the update extent into many blocks that the threads
+  // take one at a time from a shared counter, instead of into exactly one
+  // piece per thread. ThreadedRequestData is then called several times
+  // per thread, always with the id of the thread making the call. This
+  // balances the load when some parts of the extent are much more
+  // expensive than others. Initial value is off.
+  vtkSetMacro(UseDynamicScheduling, int);
+  vtkGetMacro(UseDynamicScheduling, int);
+  vtkBooleanMacro(UseDynamicScheduling, int);
+
+  // Description:
+  // The smallest number of voxels per block when UseDynamicScheduling is
+  // on. Small blocks balance the load better, large blocks have less
+  // per-block overhead. Initial value is 16384.
+  vtkSetClampMacro(MinimumBlockSize, int, 1, VTK_LARGE_INTEGER);
+  vtkGetMacro(MinimumBlockSize, int);
+
+  // Description:
+  // Set how SplitExtent divides the extent. SLAB (the default) splits the
+  // slowest varying axis that can be split into slabs. BEAM also splits
+  // the y axis when there are more pieces than slices, but never x, so
+  // every piece still covers whole rows of contiguous memory. BLOCK
+  // splits all three axes, slowest varying first.
+  vtkSetClampMacro(SplitMode, int,
+                   VTK_IMAGE_SPLIT_MODE_SLAB, VTK_IMAGE_SPLIT_MODE_BLOCK);
+  vtkGetMacro(SplitMode, int);
+  void SetSplitModeToSlab()
+    {this->SetSplitMode(VTK_IMAGE_SPLIT_MODE_SLAB);}
+  void SetSplitModeToBeam()
+    {this->SetSplitMode(VTK_IMAGE_SPLIT_MODE_BEAM);}
+  void SetSplitModeToBlock()
+    {this->SetSplitMode(VTK_IMAGE_SPLIT_MODE_BLOCK);}
+  const char *GetSplitModeAsString();
+
   // Description:
   // Putting this here until I merge graphics and imaging streaming.
   virtual int SplitExtent(int splitExt[6], int startExt[6], 
@@ -69,7 +122,11 @@ protected:
 
   vtkMultiThreader *Threader;
   int NumberOfThreads;
-  
+  int UseThreadPool;
+  int UseDynamicScheduling;
+  int MinimumBlockSize;
+  int SplitMode;
+
   // Description:
   // This is called by the superclass.
   // This is the method you should override.
@@ -480,7 +480,6 @@ vtkCell *vtkUnstructuredGrid::GetCell(vtkIdType cellId)
 
   loc = this->Locations->GetValue(cellId);
   vtkDebugMacro(<< "location = " <<  loc);
-  this->Connectivity->GetCell(loc,numPts,pts);
 
   int cellType = static_cast<int>(this->Types->GetValue(cellId));
   switch (cellType)
@@ -763,6 +762,7 @@ vtkCell *vtkUnstructuredGrid::GetCell(vtkIdType cellId)
     }
 
   // Copy the points over to the cell.
+  this->Connectivity->GetCell(loc,numPts,pts,cell->PointIds);
   cell->PointIds->SetNumberOfIds(numPts);
   cell->Points->SetNumberOfPoints(numPts);
   for (i=0; i<numPts; i++)
@@ -793,7 +793,7 @@ void vtkUnstructuredGrid::GetCell(vtkIdType cellId, vtkGenericCell *cell)
   cell->SetCellType(cellType);
 
   loc = this->Locations->GetValue(cellId);
-  this->Connectivity->GetCell(loc,numPts,pts);
+  this->Connectivity->GetCell(loc,numPts,pts,cell->PointIds);
 
   cell->PointIds->SetNumberOfIds(numPts);
   cell->Points->SetNumberOfPoints(numPts);
@@ -830,7 +830,15 @@ void vtkUnstructuredGrid::GetCellBounds(vtkIdType cellId, double bounds[6])
   vtkIdType *pts, numPts;
 
   loc = this->Locations->GetValue(cellId);
-  this->Connectivity->GetCell(loc,numPts,pts);
+  // Only the 32-bit offsets layout needs a buffer to stay thread safe; the
+  // heap is used only for cells larger than VTK_CELL_SIZE.
+  vtkIdType stackBuffer[VTK_CELL_SIZE];
+  vtkIdList *buffer = NULL;
+  if (!this->Connectivity->GetCell(loc,numPts,pts,stackBuffer,VTK_CELL_SIZE))
+    {
+    buffer = vtkIdList::New();
+    this->Connectivity->GetCell(loc,numPts,pts,buffer);
+    }
 
   // carefully compute the bounds
   if (numPts)
@@ -857,6 +865,10 @@ void vtkUnstructuredGrid::GetCellBounds(vtkIdType cellId, double bounds[6])
     {
     vtkMath::UninitializeBounds(bounds);
     }
+  if (buffer)
+    {
+    buffer->Delete();
+    }
 
 }
 
@@ -959,13 +971,14 @@ vtkIdType vtkUnstructuredGrid::InsertNextCell(int type, vtkIdType npts,
         }
       }
     
-    // insert cell location
-    this->Locations->InsertNextValue(this->Connectivity->GetData()->GetMaxId()+1);
     // insert face location
     this->FaceLocations->InsertNextValue(this->Faces->GetMaxId()+1);
     // insert cell connectivity and faces stream
     vtkUnstructuredGrid::DecomposeAPolyhedronCell(
         npts, ptIds, realnpts, this->Connectivity, this->Faces);
+    // insert cell location, which works for all the cell array layouts
+    this->Locations->InsertNextValue(
+      this->Connectivity->GetInsertLocation(realnpts));
     }
 
   return this->Types->InsertNextValue(static_cast<unsigned char>(type));
@@ -1100,11 +1113,13 @@ void vtkUnstructuredGrid::SetCells(int *types, vtkCellArray *cells)
   if (!containPolyhedron)
     {
     // only need to build types and locations
-    for (i=0, cells->InitTraversal(); cells->GetNextCell(npts,pts); i++)
+    vtkIdList *buffer = vtkIdList::New();
+    for (i=0, cells->InitTraversal(); cells->GetNextCell(npts,pts,buffer); i++)
       {
       cellTypes->InsertNextValue(static_cast<unsigned char>(types[i]));
       cellLocations->InsertNextValue(cells->GetTraversalLocation(npts));
       }
+    buffer->Delete();
     
     this->SetCells(cellTypes, cellLocations, cells, NULL, NULL);
     
@@ -1124,7 +1139,8 @@ void vtkUnstructuredGrid::SetCells(int *types, vtkCellArray *cells)
   vtkIdTypeArray *faceLocations = vtkIdTypeArray::New();
   faceLocations->Allocate(ncells);
   
-  for (i=0, cells->InitTraversal(); cells->GetNextCell(npts,pts); i++)
+  vtkIdList *buffer = vtkIdList::New();
+  for (i=0, cells->InitTraversal(); cells->GetNextCell(npts,pts,buffer); i++)
     {
     cellTypes->InsertNextValue(static_cast<unsigned char>(types[i]));
     cellLocations->InsertNextValue(newCells->GetData()->GetMaxId()+1);
@@ -1140,6 +1156,7 @@ void vtkUnstructuredGrid::SetCells(int *types, vtkCellArray *cells)
         pts, realnpts, nfaces, newCells, faces);
       }
     }
+  buffer->Delete();
 
   this->SetCells(cellTypes, cellLocations, newCells, faceLocations, faces);
 
@@ -1187,7 +1204,8 @@ void vtkUnstructuredGrid::SetCells(vtkUnsignedCharArray *cellTypes,
   faceLocations->Allocate(ncells);
   
   vtkIdType i, npts, nfaces, realnpts, *pts;
-  for (i=0, cells->InitTraversal(); cells->GetNextCell(npts,pts); i++)
+  vtkIdList *buffer = vtkIdList::New();
+  for (i=0, cells->InitTraversal(); cells->GetNextCell(npts,pts,buffer); i++)
     {
     newCellLocations->InsertNextValue(newCells->GetData()->GetMaxId()+1);
     if (cellTypes->GetValue(i) != VTK_POLYHEDRON)
@@ -1202,6 +1220,7 @@ void vtkUnstructuredGrid::SetCells(vtkUnsignedCharArray *cellTypes,
         pts, realnpts, nfaces, newCells, faces);
       }
     }
+  buffer->Delete();
   
   // set the new cells
   this->SetCells(cellTypes, newCellLocations, newCells, faceLocations, faces);
@@ -1270,6 +1289,16 @@ void vtkUnstructuredGrid::SetCells(vtkUnsignedCharArray *cellTypes,
     }
 }
 
+//----------------------------------------------------------------------------
+void vtkUnstructuredGrid::PrepareForThreadedAccess()
+{
+  this->Superclass::PrepareForThreadedAccess();
+  if ( this->Connectivity )
+    {
+    this->Connectivity->PrepareForThreadedAccess();
+    }
+}
+
 //----------------------------------------------------------------------------
 void vtkUnstructuredGrid::BuildLinks()
 {
@@ -1289,17 +1318,7 @@ void vtkUnstructuredGrid::BuildLinks()
 //----------------------------------------------------------------------------
 void vtkUnstructuredGrid::GetCellPoints(vtkIdType cellId, vtkIdList *ptIds)
 {
-  vtkIdType i, loc;
-  vtkIdType *pts, numPts;
-
-  loc = this->Locations->GetValue(cellId);
-  this->Connectivity->GetCell(loc,numPts,pts);
-  ptIds->SetNumberOfIds(numPts);
-  for (i=0; i<numPts; i++)
-    {
-    ptIds->SetId(i,pts[i]);
-    }
-
+  this->Connectivity->GetCell(this->Locations->GetValue(cellId), ptIds);
 }
 
 //----------------------------------------------------------------------------
@@ -1968,12 +1987,14 @@ void vtkUnstructuredGrid::DecomposeAPolyhedronCell(vtkCellArray * polyhedronCell
 {
   vtkIdType *cellStream = 0;
   vtkIdType cellLength = 0;
+  vtkIdList *buffer = vtkIdList::New();
   
   polyhedronCell->InitTraversal();
-  polyhedronCell->GetNextCell(cellLength, cellStream);
+  polyhedronCell->GetNextCell(cellLength, cellStream, buffer);
   
   vtkUnstructuredGrid::DecomposeAPolyhedronCell(
     cellStream, numCellPts, nCellfaces, cellArray, faces);
+  buffer->Delete();
 }
 
 //----------------------------------------------------------------------------
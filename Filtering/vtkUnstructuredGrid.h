@@ -127,6 +127,16 @@ public:
   int GetMaxCellSize();
   void BuildLinks();
   vtkCellLinks *GetCellLinks() {return this->Links;};
+
+  // Description:
+  // Also build the point ids that a 32-bit connectivity hands out, see
+  // vtkDataSet::PrepareForThreadedAccess() and vtkCellArray.
+  virtual void PrepareForThreadedAccess();
+
+  // Description:
+  // Return a pointer to the point ids of the cell. When the connectivity
+  // is in the 32-bit offsets layout the ids are a copy, so writing through
+  // pts does not change the cell, see vtkCellArray.
   virtual void GetCellPoints(vtkIdType cellId, vtkIdType& npts,
                              vtkIdType* &pts);
   
@@ -0,0 +1,278 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestArrayCalculatorThreads.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME
+// .SECTION Description
+// Evaluates scalar and vector functions of point arrays and point
+// coordinates with vtkArrayCalculator, tuple by tuple and with block
+// evaluation on one thread and on several. Checks that the results are
+// identical, including the invalid values, replaced by ReplacementValue or
+// not, on a point set (coordinates read from the points array) and on an
+// image (coordinates from GetPoint()), and that block evaluation reports
+// the invalid values once. Reports the times.
+
+#include "vtkArrayCalculator.h"
+#include "vtkCallbackCommand.h"
+#include "vtkCommand.h"
+#include "vtkDataArray.h"
+#include "vtkDoubleArray.h"
+#include "vtkFloatArray.h"
+#include "vtkFunctionParser.h"
+#include "vtkImageData.h"
+#include "vtkMath.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkTestUtilities.h"
+#include "vtkTimerLog.h"
+
+static int CompareArrays(vtkDataArray *a1, vtkDataArray *a2)
+{
+  if (!a1 || !a2 ||
+      a1->GetDataType() != a2->GetDataType() ||
+      a1->GetNumberOfTuples() != a2->GetNumberOfTuples() ||
+      a1->GetNumberOfComponents() != a2->GetNumberOfComponents())
+    {
+    return 0;
+    }
+  int numComps = a1->GetNumberOfComponents();
+  for (vtkIdType i = 0; i < a1->GetNumberOfTuples(); i++)
+    {
+    for (int c = 0; c < numComps; c++)
+      {
+      if (a1->GetComponent(i, c) != a2->GetComponent(i, c))
+        {
+        return 0;
+        }
+      }
+    }
+  return 1;
+}
+
+static void CountErrors(vtkObject *, unsigned long, void *clientData,
+                        void *)
+{
+  ++*static_cast<int *>(clientData);
+}
+
+// Add the arrays the functions use to the point data: "s" and "t" are
+// scalars in [-1, 1] (so sqrt and ln get invalid arguments) and "v" is a
+// vector. The first tuple, which the calculator evaluates on its own to
+// find the result type, is kept valid.
+static void AddArrays(vtkDataSet *input)
+{
+  vtkIdType numPoints = input->GetNumberOfPoints();
+  vtkSmartPointer<vtkDoubleArray> s = vtkSmartPointer<vtkDoubleArray>::New();
+  s->SetName("s");
+  s->SetNumberOfTuples(numPoints);
+  vtkSmartPointer<vtkFloatArray> t = vtkSmartPointer<vtkFloatArray>::New();
+  t->SetName("t");
+  t->SetNumberOfTuples(numPoints);
+  vtkSmartPointer<vtkFloatArray> v = vtkSmartPointer<vtkFloatArray>::New();
+  v->SetName("v");
+  v->SetNumberOfComponents(3);
+  v->SetNumberOfTuples(numPoints);
+  for (vtkIdType i = 0; i < numPoints; i++)
+    {
+    s->SetValue(i, vtkMath::Random(-1.0, 1.0));
+    t->SetValue(i, vtkMath::Random(-1.0, 1.0));
+    v->SetTuple3(i, vtkMath::Random(-1.0, 1.0), vtkMath::Random(-1.0, 1.0),
+                 vtkMath::Random(-1.0, 1.0));
+    }
+  s->SetValue(0, 0.5);
+  t->SetValue(0, 0.5);
+  input->GetPointData()->AddArray(s);
+  input->GetPointData()->AddArray(t);
+  input->GetPointData()->AddArray(v);
+}
+
+// Evaluate the function over the point data of input and return the
+// result array. The errors the calculator reports are counted in errors.
+static vtkSmartPointer<vtkDataArray> Calculate(vtkDataSet *input,
+                                               const char *function,
+                                               int resultType,
+                                               int replaceInvalidValues,
+                                               int useBlockEvaluation,
+                                               int threads, double &time,
+                                               int &errors)
+{
+  vtkSmartPointer<vtkArrayCalculator> calc =
+    vtkSmartPointer<vtkArrayCalculator>::New();
+  calc->SetInput(input);
+  calc->SetAttributeModeToUsePointData();
+  calc->AddScalarArrayName("s");
+  calc->AddScalarArrayName("t");
+  calc->AddVectorArrayName("v");
+  calc->AddCoordinateScalarVariable("x", 0);
+  calc->AddCoordinateScalarVariable("y", 1);
+  calc->AddCoordinateScalarVariable("z", 2);
+  calc->AddCoordinateVectorVariable("p", 0, 1, 2);
+  calc->SetFunction(function);
+  calc->SetResultArrayName("result");
+  calc->SetResultArrayType(resultType);
+  calc->SetReplaceInvalidValues(replaceInvalidValues);
+  calc->SetReplacementValue(-42.0);
+  calc->SetUseBlockEvaluation(useBlockEvaluation);
+  calc->SetNumberOfThreads(threads);
+
+  vtkSmartPointer<vtkCallbackCommand> errorObserver =
+    vtkSmartPointer<vtkCallbackCommand>::New();
+  errorObserver->SetCallback(CountErrors);
+  errorObserver->SetClientData(&errors);
+  errors = 0;
+  calc->AddObserver(vtkCommand::ErrorEvent, errorObserver);
+
+  vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+  timer->StartTimer();
+  calc->Update();
+  timer->StopTimer();
+  time = timer->GetElapsedTime();
+
+  return calc->GetOutput()->GetPointData()->GetArray("result");
+}
+
+// Evaluate the functions tuple by tuple and with block evaluation on one
+// thread and on several, and return 0 if the results differ.
+static int TestFunctions(vtkDataSet *input, int threads, const char *what)
+{
+  static const char *functions[] = {
+    "s*t - sin(x) + y*z",
+    "s*v + cross(v, p) + x*iHat - z*kHat",
+    "sqrt(s) + ln(t) + mag(p)",
+    "sqrt(s)*v + ln(t)*p"
+  };
+  static const int numFunctions = sizeof(functions) / sizeof(functions[0]);
+  static const int resultTypes[] = { VTK_DOUBLE, VTK_FLOAT };
+
+  for (int f = 0; f < numFunctions; f++)
+    {
+    for (int r = 0; r < 2; r++)
+      {
+      for (int replace = 1; replace >= 0; replace--)
+        {
+        double serialTime, blockTime, threadedTime;
+        int serialErrors, blockErrors, threadedErrors;
+
+        // Tuple by tuple, the parser reports each invalid value itself.
+        vtkObject::GlobalWarningDisplayOff();
+        vtkSmartPointer<vtkDataArray> serial =
+          Calculate(input, functions[f], resultTypes[r], replace, 0, 1,
+                    serialTime, serialErrors);
+        vtkObject::GlobalWarningDisplayOn();
+        vtkSmartPointer<vtkDataArray> block =
+          Calculate(input, functions[f], resultTypes[r], replace, 1, 1,
+                    blockTime, blockErrors);
+        vtkSmartPointer<vtkDataArray> threaded =
+          Calculate(input, functions[f], resultTypes[r], replace, 1, threads,
+                    threadedTime, threadedErrors);
+        if (!serial ||
+            serial->GetNumberOfTuples() != input->GetNumberOfPoints())
+          {
+          cerr << what << ": no result for " << functions[f] << endl;
+          return 0;
+          }
+        if (!CompareArrays(serial, block))
+          {
+          cerr << what << ": block evaluation of " << functions[f]
+               << " differs from the tuple by tuple evaluation" << endl;
+          return 0;
+          }
+        if (!CompareArrays(serial, threaded))
+          {
+          cerr << what << ": block evaluation of " << functions[f]
+               << " with " << threads << " threads differs from the tuple "
+               << "by tuple evaluation" << endl;
+          return 0;
+          }
+
+        // The invalid values, whose results are VTK_PARSER_ERROR_RESULT
+        // (in double or float), are reported once whatever their number.
+        int invalid = 0;
+        for (vtkIdType i = 0; i < serial->GetNumberOfTuples(); i++)
+          {
+          if (serial->GetComponent(i, 0) > 0.5*VTK_PARSER_ERROR_RESULT)
+            {
+            invalid = 1;
+            }
+          }
+        if (blockErrors != invalid || threadedErrors != invalid)
+          {
+          cerr << what << ": block evaluation of " << functions[f]
+               << " reports " << blockErrors << " and " << threadedErrors
+               << " (with " << threads << " threads) errors instead of "
+               << invalid << endl;
+          return 0;
+          }
+
+        if (r == 0 && replace)
+          {
+          cout << what << ", " << functions[f] << ": " << serialTime
+               << " s tuple by tuple, " << blockTime << " s in blocks, "
+               << threadedTime << " s with " << threads << " threads" << endl;
+          }
+        }
+      }
+    }
+  return 1;
+}
+
+int TestArrayCalculatorThreads(int, char *[])
+{
+  int threads = vtkTestUtilities::SetUpThreadPool(4);
+
+  vtkSmartPointer<vtkArrayCalculator> calc =
+    vtkSmartPointer<vtkArrayCalculator>::New();
+  if (calc->GetUseBlockEvaluation())
+    {
+    cerr << "Block evaluation is used without asking for it" << endl;
+    return 1;
+    }
+
+  // Points whose coordinates are read from the points array, more than
+  // fit in one block, and fewer than there are threads.
+  static const vtkIdType numPoints[] = { 100003, 3 };
+  for (int n = 0; n < 2; n++)
+    {
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    points->SetNumberOfPoints(numPoints[n]);
+    for (vtkIdType i = 0; i < numPoints[n]; i++)
+      {
+      points->SetPoint(i, vtkMath::Random(-1.0, 1.0),
+                       vtkMath::Random(-1.0, 1.0),
+                       vtkMath::Random(-1.0, 1.0));
+      }
+    vtkSmartPointer<vtkPolyData> polyData =
+      vtkSmartPointer<vtkPolyData>::New();
+    polyData->SetPoints(points);
+    AddArrays(polyData);
+    if (!TestFunctions(polyData, threads, "Points"))
+      {
+      return 1;
+      }
+    }
+
+  // An image, whose coordinates come from GetPoint().
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetExtent(0, 46, 0, 30, 0, 20);
+  image->SetOrigin(-1.0, -0.5, -0.25);
+  image->SetSpacing(0.05, 0.04, 0.03);
+  AddArrays(image);
+  if (!TestFunctions(image, threads, "Image"))
+    {
+    return 1;
+    }
+
+  return 0;
+}
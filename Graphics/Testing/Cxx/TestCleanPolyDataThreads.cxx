@@ -0,0 +1,252 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestCleanPolyDataThreads.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME
+// .SECTION Description
+// Merges the points of spheres whose triangles each have their own
+// points, exactly and with some noise, and of a random cloud of vertices,
+// with vtkCleanPolyData, with the locator and in parallel with one thread
+// and with several. Checks that the outputs are identical, and reports the
+// times.
+
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkCleanPolyData.h"
+#include "vtkDataArray.h"
+#include "vtkFloatArray.h"
+#include "vtkIdTypeArray.h"
+#include "vtkMath.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkSphereSource.h"
+#include "vtkTestUtilities.h"
+#include "vtkTimerLog.h"
+
+static int CompareArrays(vtkDataArray *a1, vtkDataArray *a2)
+{
+  if (!a1 || !a2 ||
+      a1->GetNumberOfTuples() != a2->GetNumberOfTuples() ||
+      a1->GetNumberOfComponents() != a2->GetNumberOfComponents())
+    {
+    return 0;
+    }
+  int numComps = a1->GetNumberOfComponents();
+  for (vtkIdType i = 0; i < a1->GetNumberOfTuples(); i++)
+    {
+    for (int c = 0; c < numComps; c++)
+      {
+      if (a1->GetComponent(i, c) != a2->GetComponent(i, c))
+        {
+        return 0;
+        }
+      }
+    }
+  return 1;
+}
+
+static int CompareAttributes(vtkDataSetAttributes *d1,
+                             vtkDataSetAttributes *d2)
+{
+  if (d1->GetNumberOfArrays() != d2->GetNumberOfArrays())
+    {
+    return 0;
+    }
+  for (int i = 0; i < d1->GetNumberOfArrays(); i++)
+    {
+    if (!CompareArrays(d1->GetArray(i), d2->GetArray(i)))
+      {
+      return 0;
+      }
+    }
+  return 1;
+}
+
+static int ComparePolyData(vtkPolyData *pd1, vtkPolyData *pd2)
+{
+  if (!CompareArrays(pd1->GetPoints()->GetData(),
+                     pd2->GetPoints()->GetData()) ||
+      !CompareArrays(pd1->GetVerts()->GetData(),
+                     pd2->GetVerts()->GetData()) ||
+      !CompareArrays(pd1->GetLines()->GetData(),
+                     pd2->GetLines()->GetData()) ||
+      !CompareArrays(pd1->GetPolys()->GetData(),
+                     pd2->GetPolys()->GetData()))
+    {
+    cerr << "The points or the cells differ" << endl;
+    return 0;
+    }
+  if (!CompareAttributes(pd1->GetPointData(), pd2->GetPointData()) ||
+      !CompareAttributes(pd1->GetCellData(), pd2->GetCellData()))
+    {
+    cerr << "The point or cell data differ" << endl;
+    return 0;
+    }
+  return 1;
+}
+
+// Clean with the locator, and in parallel with one thread and with
+// several. With compareLocator off, only the parallel outputs are
+// compared.
+static int TestClean(vtkPolyData *input, double tolerance, int threads,
+                     int compareLocator, const char *what)
+{
+  vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+  vtkSmartPointer<vtkCleanPolyData> clean[3];
+  double times[3];
+  for (int i = 0; i < 3; i++)
+    {
+    clean[i] = vtkSmartPointer<vtkCleanPolyData>::New();
+    clean[i]->SetInput(input);
+    clean[i]->ToleranceIsAbsoluteOn();
+    clean[i]->SetAbsoluteTolerance(tolerance);
+    clean[i]->SetParallelMerging(i > 0);
+    clean[i]->SetNumberOfThreads(i == 2 ? threads : 1);
+    timer->StartTimer();
+    clean[i]->Update();
+    timer->StopTimer();
+    times[i] = timer->GetElapsedTime();
+    }
+
+  vtkPolyData *output = clean[1]->GetOutput();
+  cout << what << ", " << input->GetNumberOfPoints() << " points merged to "
+       << output->GetNumberOfPoints() << ": with the locator " << times[0]
+       << " s, in parallel " << times[1] << " s, with " << threads
+       << " threads " << times[2] << " s" << endl;
+  if (output->GetNumberOfPoints() == 0 ||
+      output->GetNumberOfPoints() == input->GetNumberOfPoints() ||
+      !ComparePolyData(output, clean[2]->GetOutput()))
+    {
+    cerr << what << " differs with " << threads << " threads" << endl;
+    return 0;
+    }
+  if (compareLocator && !ComparePolyData(clean[0]->GetOutput(), output))
+    {
+    cerr << what << " differs from the locator" << endl;
+    return 0;
+    }
+  return 1;
+}
+
+// The triangles of the sphere, each with its own points moved by up to
+// noise, followed by lines along some of their edges, with the input
+// point ids as point data and the cell ids as cell data.
+static void MakeSoup(vtkPolyData *sphere, double noise, vtkPolyData *soup)
+{
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  vtkSmartPointer<vtkCellArray> lines = vtkSmartPointer<vtkCellArray>::New();
+  vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+  vtkSmartPointer<vtkIdTypeArray> pointIds =
+    vtkSmartPointer<vtkIdTypeArray>::New();
+  pointIds->SetName("PointIds");
+  vtkCellArray *spherePolys = sphere->GetPolys();
+  vtkIdType npts, *pts, ids[3];
+  vtkIdType cellId = 0;
+  for (spherePolys->InitTraversal(); spherePolys->GetNextCell(npts, pts);
+       cellId++)
+    {
+    for (vtkIdType i = 0; i < 3; i++)
+      {
+      double x[3];
+      sphere->GetPoint(pts[i], x);
+      for (int j = 0; j < 3; j++)
+        {
+        x[j] += vtkMath::Random(-noise, noise);
+        }
+      ids[i] = points->InsertNextPoint(x);
+      pointIds->InsertNextValue(pts[i]);
+      }
+    polys->InsertNextCell(3, ids);
+    if (cellId % 7 == 0)
+      {
+      lines->InsertNextCell(2, ids);
+      }
+    }
+  vtkSmartPointer<vtkIdTypeArray> cellIds =
+    vtkSmartPointer<vtkIdTypeArray>::New();
+  cellIds->SetName("CellIds");
+  cellIds->SetNumberOfTuples(lines->GetNumberOfCells() +
+                             polys->GetNumberOfCells());
+  for (vtkIdType i = 0; i < cellIds->GetNumberOfTuples(); i++)
+    {
+    cellIds->SetValue(i, i);
+    }
+  soup->SetPoints(points);
+  soup->SetLines(lines);
+  soup->SetPolys(polys);
+  soup->GetPointData()->AddArray(pointIds);
+  soup->GetCellData()->AddArray(cellIds);
+}
+
+int TestCleanPolyDataThreads(int, char *[])
+{
+  int threads = vtkTestUtilities::SetUpThreadPool(4);
+
+  vtkSmartPointer<vtkSphereSource> sphere =
+    vtkSmartPointer<vtkSphereSource>::New();
+  sphere->SetThetaResolution(200);
+  sphere->SetPhiResolution(200);
+  sphere->Update();
+  vtkMath::RandomSeed(2468);
+
+  // Exact duplicates, in float and in double.
+  vtkSmartPointer<vtkPolyData> soup = vtkSmartPointer<vtkPolyData>::New();
+  MakeSoup(sphere->GetOutput(), 0.0, soup);
+  if (!TestClean(soup, 0.0, threads, 1, "Float duplicates"))
+    {
+    return 1;
+    }
+  vtkSmartPointer<vtkPoints> doublePoints = vtkSmartPointer<vtkPoints>::New();
+  doublePoints->SetDataTypeToDouble();
+  doublePoints->DeepCopy(soup->GetPoints());
+  vtkSmartPointer<vtkPolyData> doubleSoup =
+    vtkSmartPointer<vtkPolyData>::New();
+  doubleSoup->ShallowCopy(soup);
+  doubleSoup->SetPoints(doublePoints);
+  if (!TestClean(doubleSoup, 0.0, threads, 1, "Double duplicates"))
+    {
+    return 1;
+    }
+
+  // Duplicates moved by much less than the tolerance, which is much less
+  // than the distance between the points of the sphere, so that the
+  // locator finds a single point to merge with.
+  vtkSmartPointer<vtkPolyData> noisy = vtkSmartPointer<vtkPolyData>::New();
+  MakeSoup(sphere->GetOutput(), 1e-5, noisy);
+  if (!TestClean(noisy, 1e-4, threads, 1, "Noisy duplicates"))
+    {
+    return 1;
+    }
+
+  // A random cloud of vertices, where the points within the tolerance of
+  // a point may be within the tolerance of each other.
+  vtkSmartPointer<vtkPoints> cloudPoints = vtkSmartPointer<vtkPoints>::New();
+  vtkSmartPointer<vtkCellArray> verts = vtkSmartPointer<vtkCellArray>::New();
+  vtkIdType numPts = 200000;
+  for (vtkIdType i = 0; i < numPts; i++)
+    {
+    cloudPoints->InsertNextPoint(vtkMath::Random(), vtkMath::Random(),
+                                 vtkMath::Random());
+    verts->InsertNextCell(1, &i);
+    }
+  vtkSmartPointer<vtkPolyData> cloud = vtkSmartPointer<vtkPolyData>::New();
+  cloud->SetPoints(cloudPoints);
+  cloud->SetVerts(verts);
+  if (!TestClean(cloud, 0.01, threads, 0, "Cloud"))
+    {
+    return 1;
+    }
+  return 0;
+}
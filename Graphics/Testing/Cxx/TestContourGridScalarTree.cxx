@@ -0,0 +1,276 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestContourGridScalarTree.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME
+// .SECTION Description
+// Checks the cells vtkSpanSpace finds for contour values against all the
+// cells, with one thread and with several, and contours a tetrahedral
+// grid with vtkContourGrid with and without the span space. Reports the
+// times of a sweep through contour values.
+
+#include "vtkCell.h"
+#include "vtkContourGrid.h"
+#include "vtkDataArray.h"
+#include "vtkDataSetTriangleFilter.h"
+#include "vtkDoubleArray.h"
+#include "vtkIdList.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkRTAnalyticSource.h"
+#include "vtkSimpleScalarTree.h"
+#include "vtkSmartPointer.h"
+#include "vtkSpanSpace.h"
+#include "vtkTestUtilities.h"
+#include "vtkTimerLog.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <vtkstd/algorithm>
+#include <vtkstd/vector>
+
+#include <math.h>
+
+// The cells whose scalars span the value, found by visiting them all.
+static void CellsSpanning(vtkDataSet *grid, vtkDataArray *scalars,
+                          double value, vtkstd::vector<vtkIdType> &cells)
+{
+  vtkSmartPointer<vtkIdList> ptIds = vtkSmartPointer<vtkIdList>::New();
+  cells.clear();
+  for (vtkIdType cellId = 0; cellId < grid->GetNumberOfCells(); cellId++)
+    {
+    grid->GetCellPoints(cellId, ptIds);
+    double min = VTK_DOUBLE_MAX, max = -VTK_DOUBLE_MAX;
+    for (vtkIdType i = 0; i < ptIds->GetNumberOfIds(); i++)
+      {
+      double s = scalars->GetComponent(ptIds->GetId(i), 0);
+      min = (s < min ? s : min);
+      max = (s > max ? s : max);
+      }
+    if (value >= min && value <= max)
+      {
+      cells.push_back(cellId);
+      }
+    }
+}
+
+// GetNextCell() returns exactly the cells spanning each value, and the
+// batches hold each of them once, plus at most maxOthers others.
+static int TestTree(vtkScalarTree *tree, vtkSpanSpace *serial,
+                    vtkDataSet *grid, vtkDataArray *scalars,
+                    vtkIdType maxOthers, const char *what)
+{
+  vtkSmartPointer<vtkDoubleArray> cellScalars =
+    vtkSmartPointer<vtkDoubleArray>::New();
+  vtkstd::vector<vtkIdType> expected, found, batched, serialBatched;
+  double range[2];
+  scalars->GetRange(range, 0);
+  for (int v = -1; v <= 11; v++)
+    {
+    double value = range[0] + (range[1] - range[0])*v/10.0;
+    CellsSpanning(grid, scalars, value, expected);
+
+    found.clear();
+    tree->InitTraversal(value);
+    vtkIdType cellId;
+    vtkIdList *cellPts;
+    while (tree->GetNextCell(cellId, cellPts, cellScalars))
+      {
+      found.push_back(cellId);
+      }
+    vtkstd::sort(found.begin(), found.end());
+    if (found != expected)
+      {
+      cerr << what << ": " << found.size() << " cells found at " << value
+           << " instead of " << expected.size() << endl;
+      return 0;
+      }
+    if (!serial)
+      {
+      continue;
+      }
+
+    // Batches of the same cells whatever the number of threads.
+    batched.clear();
+    for (vtkIdType b = 0; b < tree->GetNumberOfCellBatches(); b++)
+      {
+      vtkIdType numCells;
+      const vtkIdType *cells = tree->GetCellBatch(b, numCells);
+      batched.insert(batched.end(), cells, cells + numCells);
+      }
+    serial->InitTraversal(value);
+    serialBatched.clear();
+    for (vtkIdType b = 0; b < serial->GetNumberOfCellBatches(); b++)
+      {
+      vtkIdType numCells;
+      const vtkIdType *cells = serial->GetCellBatch(b, numCells);
+      serialBatched.insert(serialBatched.end(), cells, cells + numCells);
+      }
+    if (batched != serialBatched)
+      {
+      cerr << what << ": the batches depend on the number of threads" << endl;
+      return 0;
+      }
+    vtkstd::sort(batched.begin(), batched.end());
+    if (vtkstd::adjacent_find(batched.begin(), batched.end()) !=
+        batched.end() ||
+        !vtkstd::includes(batched.begin(), batched.end(),
+                          expected.begin(), expected.end()) ||
+        batched.size() > expected.size() + maxOthers)
+      {
+      cerr << what << ": " << batched.size() << " cells in the batches at "
+           << value << " for " << expected.size() << " spanning it" << endl;
+      return 0;
+      }
+    }
+  return 1;
+}
+
+// Contour at the values, and return the contour and the time taken.
+static double Contour(vtkContourGrid *contour, int numValues, double *values,
+                      vtkPolyData *output)
+{
+  vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+  contour->SetNumberOfContours(numValues);
+  for (int i = 0; i < numValues; i++)
+    {
+    contour->SetValue(i, values[i]);
+    }
+  timer->StartTimer();
+  contour->Update();
+  timer->StopTimer();
+  output->DeepCopy(contour->GetOutput());
+  return timer->GetElapsedTime();
+}
+
+static int SameContour(vtkPolyData *pd1, vtkPolyData *pd2)
+{
+  if (pd1->GetNumberOfPoints() != pd2->GetNumberOfPoints() ||
+      pd1->GetNumberOfCells() != pd2->GetNumberOfCells())
+    {
+    cerr << pd2->GetNumberOfPoints() << " points and "
+         << pd2->GetNumberOfCells() << " cells instead of "
+         << pd1->GetNumberOfPoints() << " and " << pd1->GetNumberOfCells()
+         << endl;
+    return 0;
+    }
+  double sum1[3] = {0.0, 0.0, 0.0}, sum2[3] = {0.0, 0.0, 0.0}, x[3];
+  for (vtkIdType i = 0; i < pd1->GetNumberOfPoints(); i++)
+    {
+    pd1->GetPoint(i, x);
+    sum1[0] += x[0]; sum1[1] += x[1]; sum1[2] += x[2];
+    pd2->GetPoint(i, x);
+    sum2[0] += x[0]; sum2[1] += x[1]; sum2[2] += x[2];
+    }
+  for (int j = 0; j < 3; j++)
+    {
+    if (fabs(sum1[j] - sum2[j]) > 1e-6*pd1->GetNumberOfPoints())
+      {
+      cerr << "The contour points differ" << endl;
+      return 0;
+      }
+    }
+  return 1;
+}
+
+int TestContourGridScalarTree(int, char *[])
+{
+  int threads = vtkTestUtilities::SetUpThreadPool(4);
+
+  vtkSmartPointer<vtkRTAnalyticSource> source =
+    vtkSmartPointer<vtkRTAnalyticSource>::New();
+  source->SetWholeExtent(-20, 19, -20, 19, -20, 19);
+  vtkSmartPointer<vtkDataSetTriangleFilter> tetra =
+    vtkSmartPointer<vtkDataSetTriangleFilter>::New();
+  tetra->SetInputConnection(source->GetOutputPort());
+  tetra->Update();
+  vtkUnstructuredGrid *grid = tetra->GetOutput();
+  vtkDataArray *scalars = grid->GetPointData()->GetScalars();
+
+  // The trees, and the simple tree organizing the same scalars set
+  // explicitly.
+  vtkSmartPointer<vtkSpanSpace> serial = vtkSmartPointer<vtkSpanSpace>::New();
+  serial->SetDataSet(grid);
+  serial->SetNumberOfThreads(1);
+  vtkSmartPointer<vtkSpanSpace> spanSpace =
+    vtkSmartPointer<vtkSpanSpace>::New();
+  spanSpace->SetDataSet(grid);
+  spanSpace->SetNumberOfThreads(threads);
+  spanSpace->SetBatchSize(777);
+  serial->SetBatchSize(777);
+  vtkSmartPointer<vtkSimpleScalarTree> simple =
+    vtkSmartPointer<vtkSimpleScalarTree>::New();
+  simple->SetDataSet(grid);
+  simple->SetScalars(scalars);
+  vtkIdType numCells = grid->GetNumberOfCells();
+  if (!TestTree(spanSpace, serial, grid, scalars, numCells/50, "Span space") ||
+      !TestTree(simple, NULL, grid, scalars, 0, "Simple scalar tree"))
+    {
+    return 1;
+    }
+
+  // A coarse span space, with many cells to check in the row and column of
+  // each value.
+  spanSpace->ComputeResolutionOff();
+  spanSpace->SetResolution(7);
+  serial->ComputeResolutionOff();
+  serial->SetResolution(7);
+  if (!TestTree(spanSpace, serial, grid, scalars, numCells/2,
+                "Coarse span space"))
+    {
+    return 1;
+    }
+
+  // Sweep through contour values with and without the span space.
+  vtkSmartPointer<vtkContourGrid> plain =
+    vtkSmartPointer<vtkContourGrid>::New();
+  plain->SetInput(grid);
+  vtkSmartPointer<vtkContourGrid> accelerated =
+    vtkSmartPointer<vtkContourGrid>::New();
+  accelerated->SetInput(grid);
+  accelerated->UseScalarTreeOn();
+  vtkSmartPointer<vtkPolyData> output1 = vtkSmartPointer<vtkPolyData>::New();
+  vtkSmartPointer<vtkPolyData> output2 = vtkSmartPointer<vtkPolyData>::New();
+  double range[2];
+  scalars->GetRange(range);
+  double plainTime = 0.0, acceleratedTime = 0.0, firstTime = 0.0;
+  const int numSteps = 10;
+  for (int step = 0; step < numSteps; step++)
+    {
+    double values[2];
+    values[0] = range[0] + (range[1] - range[0])*(step + 0.5)/numSteps;
+    values[1] = values[0] + 0.02*(range[1] - range[0]);
+    plainTime += Contour(plain, 2, values, output1);
+    double t = Contour(accelerated, 2, values, output2);
+    acceleratedTime += t;
+    if (step == 0)
+      {
+      firstTime = t;
+      }
+    if (!SameContour(output1, output2))
+      {
+      cerr << "The span space changes the contour at " << values[0] << endl;
+      return 1;
+      }
+    }
+  if (!vtkSpanSpace::SafeDownCast(accelerated->GetScalarTree()))
+    {
+    cerr << "vtkContourGrid does not use a span space" << endl;
+    return 1;
+    }
+  cout << numCells << " tetrahedra, " << numSteps
+       << " contour pairs: without scalar tree " << plainTime
+       << " s, with span space " << acceleratedTime << " s (first "
+       << firstTime << " s, with the build)" << endl;
+  return 0;
+}
@@ -0,0 +1,216 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestFlyingEdges3D.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME
+// .SECTION Description
+// Contours a ramp and analytic volumes of increasing size with
+// vtkFlyingEdges3D, vtkSynchronizedTemplates3D and vtkMarchingCubes.
+// Checks that flying edges gives the points, normals and triangles of the
+// other two, and the same output with one thread and with several, and
+// reports the times.
+
+#include "vtkCellArray.h"
+#include "vtkDataArray.h"
+#include "vtkFlyingEdges3D.h"
+#include "vtkImageData.h"
+#include "vtkMarchingCubes.h"
+#include "vtkMath.h"
+#include "vtkPointData.h"
+#include "vtkPointLocator.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkRTAnalyticSource.h"
+#include "vtkSmartPointer.h"
+#include "vtkSynchronizedTemplates3D.h"
+#include "vtkTestUtilities.h"
+#include "vtkTimerLog.h"
+
+static int CompareArrays(vtkDataArray *a1, vtkDataArray *a2, const char *what)
+{
+  if (!a1 || !a2 ||
+      a1->GetNumberOfTuples() != a2->GetNumberOfTuples() ||
+      a1->GetNumberOfComponents() != a2->GetNumberOfComponents())
+    {
+    cerr << what << " differ in size" << endl;
+    return 0;
+    }
+  int numComps = a1->GetNumberOfComponents();
+  for (vtkIdType i = 0; i < a1->GetNumberOfTuples(); i++)
+    {
+    for (int c = 0; c < numComps; c++)
+      {
+      if (a1->GetComponent(i, c) != a2->GetComponent(i, c))
+        {
+        cerr << what << " differ at tuple " << i << endl;
+        return 0;
+        }
+      }
+    }
+  return 1;
+}
+
+// Every point of the flying edges surface is a point of the other surface,
+// with the same normal.
+static int ComparePoints(vtkPolyData *edges, vtkPolyData *other)
+{
+  if (edges->GetNumberOfPoints() != other->GetNumberOfPoints())
+    {
+    cerr << edges->GetNumberOfPoints() << " points instead of "
+         << other->GetNumberOfPoints() << endl;
+    return 0;
+    }
+  vtkSmartPointer<vtkPointLocator> locator =
+    vtkSmartPointer<vtkPointLocator>::New();
+  locator->SetDataSet(other);
+  locator->BuildLocator();
+  vtkDataArray *normals1 = edges->GetPointData()->GetNormals();
+  vtkDataArray *normals2 = other->GetPointData()->GetNormals();
+  double x[3], y[3], n1[3], n2[3];
+  for (vtkIdType i = 0; i < edges->GetNumberOfPoints(); i++)
+    {
+    edges->GetPoint(i, x);
+    vtkIdType id = locator->FindClosestPoint(x);
+    other->GetPoint(id, y);
+    normals1->GetTuple(i, n1);
+    normals2->GetTuple(id, n2);
+    if (vtkMath::Distance2BetweenPoints(x, y) > 1e-10 ||
+        vtkMath::Dot(n1, n2) < 0.9999)
+      {
+      cerr << "Point " << i << " differs" << endl;
+      return 0;
+      }
+    }
+  return 1;
+}
+
+static int TestImage(vtkImageData *image, double range[2], int threads,
+                     const char *what)
+{
+  vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+  vtkSmartPointer<vtkFlyingEdges3D> edges =
+    vtkSmartPointer<vtkFlyingEdges3D>::New();
+  edges->SetInput(image);
+  edges->GenerateValues(2, range);
+  edges->SetNumberOfThreads(1);
+  timer->StartTimer();
+  edges->Update();
+  timer->StopTimer();
+  double edgesTime = timer->GetElapsedTime();
+
+  vtkSmartPointer<vtkFlyingEdges3D> threaded =
+    vtkSmartPointer<vtkFlyingEdges3D>::New();
+  threaded->SetInput(image);
+  threaded->GenerateValues(2, range);
+  threaded->SetNumberOfThreads(threads);
+  timer->StartTimer();
+  threaded->Update();
+  timer->StopTimer();
+  double threadedTime = timer->GetElapsedTime();
+
+  vtkSmartPointer<vtkSynchronizedTemplates3D> templates =
+    vtkSmartPointer<vtkSynchronizedTemplates3D>::New();
+  templates->SetInput(image);
+  templates->GenerateValues(2, range);
+  templates->SetNumberOfThreads(1);
+  timer->StartTimer();
+  templates->Update();
+  timer->StopTimer();
+  double templatesTime = timer->GetElapsedTime();
+
+  vtkSmartPointer<vtkMarchingCubes> cubes =
+    vtkSmartPointer<vtkMarchingCubes>::New();
+  cubes->SetInput(image);
+  cubes->GenerateValues(2, range);
+  timer->StartTimer();
+  cubes->Update();
+  timer->StopTimer();
+  double cubesTime = timer->GetElapsedTime();
+
+  vtkPolyData *output = edges->GetOutput();
+  cout << what << ", " << output->GetNumberOfPolys()
+       << " triangles: flying edges " << edgesTime << " s, with " << threads
+       << " threads " << threadedTime << " s, synchronized templates "
+       << templatesTime << " s, marching cubes " << cubesTime << " s" << endl;
+
+  vtkPolyData *output2 = threaded->GetOutput();
+  if (!CompareArrays(output->GetPoints()->GetData(),
+                     output2->GetPoints()->GetData(), "Points") ||
+      !CompareArrays(output->GetPolys()->GetData(),
+                     output2->GetPolys()->GetData(), "Triangles") ||
+      !CompareArrays(output->GetPointData()->GetNormals(),
+                     output2->GetPointData()->GetNormals(), "Normals") ||
+      !CompareArrays(output->GetPointData()->GetScalars(),
+                     output2->GetPointData()->GetScalars(), "Scalars"))
+    {
+    cerr << "Flying edges differs with " << threads << " threads" << endl;
+    return 0;
+    }
+  if (output->GetNumberOfPolys() != templates->GetOutput()->GetNumberOfPolys() ||
+      output->GetNumberOfPolys() != cubes->GetOutput()->GetNumberOfPolys())
+    {
+    cerr << output->GetNumberOfPolys() << " triangles instead of "
+         << templates->GetOutput()->GetNumberOfPolys() << " and "
+         << cubes->GetOutput()->GetNumberOfPolys() << endl;
+    return 0;
+    }
+  return ComparePoints(output, templates->GetOutput());
+}
+
+int TestFlyingEdges3D(int, char *[])
+{
+  int threads = vtkTestUtilities::SetUpThreadPool(4);
+
+  // Rows of points along x that all lie on one side of the contours, which
+  // only crosses their y and z edges.
+  vtkSmartPointer<vtkImageData> ramp = vtkSmartPointer<vtkImageData>::New();
+  ramp->SetExtent(0, 40, -5, 30, 3, 33);
+  ramp->SetScalarTypeToFloat();
+  ramp->AllocateScalars();
+  vtkDataArray *scalars = ramp->GetPointData()->GetScalars();
+  vtkIdType id = 0;
+  for (int k = 3; k <= 33; k++)
+    {
+    for (int j = -5; j <= 30; j++)
+      {
+      for (int i = 0; i <= 40; i++, id++)
+        {
+        scalars->SetTuple1(id, j + 0.37*k);
+        }
+      }
+    }
+  double rampRange[2] = {4.1, 20.3};
+  if (!TestImage(ramp, rampRange, threads, "Ramp"))
+    {
+    return 1;
+    }
+
+  char what[64];
+  int sizes[3] = {32, 96, 160};
+  for (int i = 0; i < 3; i++)
+    {
+    vtkSmartPointer<vtkRTAnalyticSource> source =
+      vtkSmartPointer<vtkRTAnalyticSource>::New();
+    int size = sizes[i];
+    source->SetWholeExtent(-size/2, size/2 - 1, -size/2, size/2 - 1,
+                           -size/2, size/2 - 1);
+    source->Update();
+    double range[2] = {120.0, 220.0};
+    sprintf(what, "%d^3", size);
+    if (!TestImage(source->GetOutput(), range, threads, what))
+      {
+      return 1;
+      }
+    }
+  return 0;
+}
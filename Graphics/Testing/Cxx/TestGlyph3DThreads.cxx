@@ -0,0 +1,280 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestGlyph3DThreads.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME
+// .SECTION Description
+// Glyphs a cloud of points with vtkGlyph3D, with a sphere and with a table
+// of glyphs indexed by scalar, with one thread and with several. Checks
+// that the outputs are identical, and that the instances output places
+// the glyphs where the glyph geometry is. Reports the times.
+
+#include "vtkCellData.h"
+#include "vtkConeSource.h"
+#include "vtkDataArray.h"
+#include "vtkDoubleArray.h"
+#include "vtkFloatArray.h"
+#include "vtkGlyph3D.h"
+#include "vtkIdList.h"
+#include "vtkMath.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkSphereSource.h"
+#include "vtkTestUtilities.h"
+#include "vtkTimerLog.h"
+
+#include <math.h>
+
+static int CompareArrays(vtkDataArray *a1, vtkDataArray *a2)
+{
+  if (!a1 || !a2 ||
+      a1->GetNumberOfTuples() != a2->GetNumberOfTuples() ||
+      a1->GetNumberOfComponents() != a2->GetNumberOfComponents())
+    {
+    return 0;
+    }
+  int numComps = a1->GetNumberOfComponents();
+  for (vtkIdType i = 0; i < a1->GetNumberOfTuples(); i++)
+    {
+    for (int c = 0; c < numComps; c++)
+      {
+      if (a1->GetComponent(i, c) != a2->GetComponent(i, c))
+        {
+        return 0;
+        }
+      }
+    }
+  return 1;
+}
+
+static int CompareAttributes(vtkDataSetAttributes *d1,
+                             vtkDataSetAttributes *d2)
+{
+  if (d1->GetNumberOfArrays() != d2->GetNumberOfArrays())
+    {
+    return 0;
+    }
+  for (int i = 0; i < d1->GetNumberOfArrays(); i++)
+    {
+    if (!CompareArrays(d1->GetArray(i), d2->GetArray(i)) ||
+        strcmp(d1->GetArray(i)->GetName(), d2->GetArray(i)->GetName()))
+      {
+      return 0;
+      }
+    }
+  return 1;
+}
+
+static int CompareGlyphs(vtkPolyData *pd1, vtkPolyData *pd2)
+{
+  if (pd1->GetNumberOfCells() != pd2->GetNumberOfCells() ||
+      !CompareArrays(pd1->GetPoints()->GetData(),
+                     pd2->GetPoints()->GetData()))
+    {
+    cerr << "The points or the number of cells differ" << endl;
+    return 0;
+    }
+  vtkSmartPointer<vtkIdList> ids1 = vtkSmartPointer<vtkIdList>::New();
+  vtkSmartPointer<vtkIdList> ids2 = vtkSmartPointer<vtkIdList>::New();
+  for (vtkIdType cellId = 0; cellId < pd1->GetNumberOfCells(); cellId++)
+    {
+    pd1->GetCellPoints(cellId, ids1);
+    pd2->GetCellPoints(cellId, ids2);
+    int same = (pd1->GetCellType(cellId) == pd2->GetCellType(cellId) &&
+                ids1->GetNumberOfIds() == ids2->GetNumberOfIds());
+    for (vtkIdType i = 0; same && i < ids1->GetNumberOfIds(); i++)
+      {
+      same = (ids1->GetId(i) == ids2->GetId(i));
+      }
+    if (!same)
+      {
+      cerr << "Cell " << cellId << " differs" << endl;
+      return 0;
+      }
+    }
+  if (!CompareAttributes(pd1->GetPointData(), pd2->GetPointData()) ||
+      !CompareAttributes(pd1->GetCellData(), pd2->GetCellData()))
+    {
+    cerr << "The point or cell data differ" << endl;
+    return 0;
+    }
+  return 1;
+}
+
+// Glyph with one thread and with several, and return 0 if the outputs
+// differ.
+static int TestGlyph(vtkGlyph3D *serial, vtkGlyph3D *threaded, int threads,
+                     const char *what)
+{
+  vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+  serial->SetNumberOfThreads(1);
+  threaded->SetNumberOfThreads(threads);
+  timer->StartTimer();
+  serial->Update();
+  timer->StopTimer();
+  double serialTime = timer->GetElapsedTime();
+  timer->StartTimer();
+  threaded->Update();
+  timer->StopTimer();
+  double threadedTime = timer->GetElapsedTime();
+
+  vtkPolyData *output = serial->GetOutput();
+  cout << what << ", " << output->GetNumberOfPoints() << " points and "
+       << output->GetNumberOfCells() << " cells: " << serialTime
+       << " s, with " << threads << " threads " << threadedTime << " s"
+       << endl;
+  if (output->GetNumberOfCells() == 0 ||
+      !CompareGlyphs(output, threaded->GetOutput()))
+    {
+    cerr << what << " differs with " << threads << " threads" << endl;
+    return 0;
+    }
+  return 1;
+}
+
+int TestGlyph3DThreads(int, char *[])
+{
+  int threads = vtkTestUtilities::SetUpThreadPool(4);
+
+  // Random points with scalars, vectors and another array to copy.
+  vtkMath::RandomSeed(1234);
+  vtkIdType numPts = 20000;
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetNumberOfPoints(numPts);
+  vtkSmartPointer<vtkFloatArray> scalars =
+    vtkSmartPointer<vtkFloatArray>::New();
+  scalars->SetName("Scalars");
+  scalars->SetNumberOfTuples(numPts);
+  vtkSmartPointer<vtkDoubleArray> vectors =
+    vtkSmartPointer<vtkDoubleArray>::New();
+  vectors->SetName("Vectors");
+  vectors->SetNumberOfComponents(3);
+  vectors->SetNumberOfTuples(numPts);
+  vtkSmartPointer<vtkDoubleArray> other =
+    vtkSmartPointer<vtkDoubleArray>::New();
+  other->SetName("Other");
+  other->SetNumberOfComponents(2);
+  other->SetNumberOfTuples(numPts);
+  for (vtkIdType i = 0; i < numPts; i++)
+    {
+    points->SetPoint(i, vtkMath::Random(-50.0, 50.0),
+                     vtkMath::Random(-50.0, 50.0),
+                     vtkMath::Random(-50.0, 50.0));
+    scalars->SetValue(i, vtkMath::Random(0.0, 1.0));
+    double y = vtkMath::Random(-1.0, 1.0), z = vtkMath::Random(-1.0, 1.0);
+    vectors->SetTuple3(i, vtkMath::Random(-1.0, 1.0), (i % 7 ? y : 0.0),
+                       (i % 7 ? z : 0.0));
+    other->SetTuple2(i, i, -i);
+    }
+  vtkSmartPointer<vtkPolyData> cloud = vtkSmartPointer<vtkPolyData>::New();
+  cloud->SetPoints(points);
+  cloud->GetPointData()->SetScalars(scalars);
+  cloud->GetPointData()->SetVectors(vectors);
+  cloud->GetPointData()->AddArray(other);
+
+  // Spheres, scaled by vector and colored by scalar, with the point ids
+  // and the cell data.
+  vtkSmartPointer<vtkSphereSource> sphere =
+    vtkSmartPointer<vtkSphereSource>::New();
+  sphere->SetThetaResolution(12);
+  sphere->SetPhiResolution(8);
+  vtkSmartPointer<vtkGlyph3D> serial = vtkSmartPointer<vtkGlyph3D>::New();
+  vtkSmartPointer<vtkGlyph3D> threaded = vtkSmartPointer<vtkGlyph3D>::New();
+  vtkGlyph3D *glyphs[2] = {serial, threaded};
+  for (int i = 0; i < 2; i++)
+    {
+    glyphs[i]->SetInput(cloud);
+    glyphs[i]->SetSourceConnection(sphere->GetOutputPort());
+    glyphs[i]->SetScaleModeToScaleByVector();
+    glyphs[i]->SetColorModeToColorByScalar();
+    glyphs[i]->SetScaleFactor(0.5);
+    glyphs[i]->GeneratePointIdsOn();
+    glyphs[i]->FillCellDataOn();
+    }
+  if (!TestGlyph(serial, threaded, threads, "Spheres"))
+    {
+    return 1;
+    }
+
+  // A table of a sphere and a cone indexed by scalar, clamped.
+  vtkSmartPointer<vtkConeSource> cone = vtkSmartPointer<vtkConeSource>::New();
+  cone->SetResolution(10);
+  for (int i = 0; i < 2; i++)
+    {
+    glyphs[i]->SetSourceConnection(1, cone->GetOutputPort());
+    glyphs[i]->SetIndexModeToScalar();
+    glyphs[i]->SetColorModeToColorByScale();
+    glyphs[i]->SetScaleModeToScaleByScalar();
+    glyphs[i]->ClampingOn();
+    glyphs[i]->SetRange(0.1, 0.9);
+    }
+  if (!TestGlyph(serial, threaded, threads, "Table of glyphs"))
+    {
+    return 1;
+    }
+
+  // The instances, whose matrices place the glyph sources on the glyphs.
+  vtkSmartPointer<vtkPolyData> geometry = vtkSmartPointer<vtkPolyData>::New();
+  geometry->DeepCopy(serial->GetOutput());
+  serial->GenerateInstancesOn();
+  threaded->GenerateInstancesOn();
+  if (!TestGlyph(serial, threaded, threads, "Instances"))
+    {
+    return 1;
+    }
+  vtkPolyData *instances = threaded->GetOutput();
+  vtkDataArray *transforms =
+    instances->GetPointData()->GetArray("GlyphTransform");
+  vtkDataArray *indices = instances->GetPointData()->GetArray("GlyphIndex");
+  vtkDataArray *pointIds =
+    instances->GetPointData()->GetArray("InputPointIds");
+  if (!transforms || !indices || !pointIds ||
+      instances->GetNumberOfVerts() != instances->GetNumberOfPoints())
+    {
+    cerr << "The instances lack their arrays or vertices" << endl;
+    return 1;
+    }
+  vtkIdType ptId = 0;
+  for (vtkIdType i = 0; i < instances->GetNumberOfPoints(); i++)
+    {
+    vtkPolyData *source = threaded->GetSource(
+      static_cast<int>(indices->GetComponent(i, 0)));
+    double m[16];
+    transforms->GetTuple(i, m);
+    for (vtkIdType j = 0; j < source->GetNumberOfPoints(); j++, ptId++)
+      {
+      double x[3], y[3], z[3];
+      source->GetPoint(j, x);
+      geometry->GetPoint(ptId, z);
+      for (int k = 0; k < 3; k++)
+        {
+        y[k] = m[4*k]*x[0] + m[4*k+1]*x[1] + m[4*k+2]*x[2] + m[4*k+3];
+        }
+      if (vtkMath::Distance2BetweenPoints(y, z) > 1e-8 ||
+          geometry->GetPointData()->GetArray("InputPointIds")
+            ->GetComponent(ptId, 0) != pointIds->GetComponent(i, 0))
+        {
+        cerr << "Instance " << i << " is not at its glyph" << endl;
+        return 1;
+        }
+      }
+    }
+  if (ptId != geometry->GetNumberOfPoints())
+    {
+    cerr << "The instances do not cover the glyphs" << endl;
+    return 1;
+    }
+  return 0;
+}
@@ -0,0 +1,192 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestPolyDataNormalsThreads.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME
+// .SECTION Description
+// Computes the normals of a sphere whose polygons are randomly reversed,
+// and of a box-like superquadric as triangle strips, with
+// vtkPolyDataNormals, with one thread and with several, ordering the
+// polygons consistently or automatically, and splitting sharp edges.
+// Checks that the outputs are identical, and reports the times.
+
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkMath.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkPolyDataNormals.h"
+#include "vtkSmartPointer.h"
+#include "vtkSphereSource.h"
+#include "vtkStripper.h"
+#include "vtkSuperquadricSource.h"
+#include "vtkTestUtilities.h"
+#include "vtkTimerLog.h"
+
+static int CompareArrays(vtkDataArray *a1, vtkDataArray *a2)
+{
+  if (!a1 || !a2 ||
+      a1->GetNumberOfTuples() != a2->GetNumberOfTuples() ||
+      a1->GetNumberOfComponents() != a2->GetNumberOfComponents())
+    {
+    return 0;
+    }
+  int numComps = a1->GetNumberOfComponents();
+  for (vtkIdType i = 0; i < a1->GetNumberOfTuples(); i++)
+    {
+    for (int c = 0; c < numComps; c++)
+      {
+      if (a1->GetComponent(i, c) != a2->GetComponent(i, c))
+        {
+        return 0;
+        }
+      }
+    }
+  return 1;
+}
+
+static int CompareAttributes(vtkDataSetAttributes *d1,
+                             vtkDataSetAttributes *d2)
+{
+  if (d1->GetNumberOfArrays() != d2->GetNumberOfArrays())
+    {
+    return 0;
+    }
+  for (int i = 0; i < d1->GetNumberOfArrays(); i++)
+    {
+    if (!CompareArrays(d1->GetArray(i), d2->GetArray(i)))
+      {
+      return 0;
+      }
+    }
+  return 1;
+}
+
+static int ComparePolys(vtkPolyData *pd1, vtkPolyData *pd2)
+{
+  if (!CompareArrays(pd1->GetPoints()->GetData(),
+                     pd2->GetPoints()->GetData()) ||
+      !CompareArrays(pd1->GetPolys()->GetData(),
+                     pd2->GetPolys()->GetData()))
+    {
+    cerr << "The points or the polygons differ" << endl;
+    return 0;
+    }
+  if (!CompareAttributes(pd1->GetPointData(), pd2->GetPointData()) ||
+      !CompareAttributes(pd1->GetCellData(), pd2->GetCellData()))
+    {
+    cerr << "The point or cell data differ" << endl;
+    return 0;
+    }
+  return 1;
+}
+
+static int TestNormals(vtkPolyData *input, int threads, double featureAngle,
+                       int autoOrient, const char *what)
+{
+  vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+  vtkSmartPointer<vtkPolyDataNormals> serial =
+    vtkSmartPointer<vtkPolyDataNormals>::New();
+  vtkSmartPointer<vtkPolyDataNormals> threaded =
+    vtkSmartPointer<vtkPolyDataNormals>::New();
+  vtkPolyDataNormals *normals[2] = {serial, threaded};
+  for (int i = 0; i < 2; i++)
+    {
+    normals[i]->SetInput(input);
+    normals[i]->SetFeatureAngle(featureAngle);
+    normals[i]->SetAutoOrientNormals(autoOrient);
+    normals[i]->ComputeCellNormalsOn();
+    }
+  serial->SetNumberOfThreads(1);
+  threaded->SetNumberOfThreads(threads);
+
+  timer->StartTimer();
+  serial->Update();
+  timer->StopTimer();
+  double serialTime = timer->GetElapsedTime();
+  timer->StartTimer();
+  threaded->Update();
+  timer->StopTimer();
+  double threadedTime = timer->GetElapsedTime();
+
+  vtkPolyData *output = serial->GetOutput();
+  cout << what << ", " << input->GetNumberOfPoints() << " points split to "
+       << output->GetNumberOfPoints() << ": " << serialTime << " s, with "
+       << threads << " threads " << threadedTime << " s" << endl;
+  if (output->GetNumberOfPolys() == 0 ||
+      output->GetNumberOfPoints() == input->GetNumberOfPoints() ||
+      !ComparePolys(output, threaded->GetOutput()))
+    {
+    cerr << what << " differs with " << threads << " threads" << endl;
+    return 0;
+    }
+  return 1;
+}
+
+int TestPolyDataNormalsThreads(int, char *[])
+{
+  int threads = vtkTestUtilities::SetUpThreadPool(4);
+
+  // A sphere with a third of its triangles reversed.
+  vtkSmartPointer<vtkSphereSource> sphere =
+    vtkSmartPointer<vtkSphereSource>::New();
+  sphere->SetThetaResolution(300);
+  sphere->SetPhiResolution(300);
+  sphere->Update();
+  vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+  vtkCellArray *spherePolys = sphere->GetOutput()->GetPolys();
+  vtkIdType npts, *pts, reversed[VTK_CELL_SIZE];
+  vtkMath::RandomSeed(1234);
+  for (spherePolys->InitTraversal(); spherePolys->GetNextCell(npts, pts); )
+    {
+    if (vtkMath::Random() < 0.33)
+      {
+      for (vtkIdType i = 0; i < npts; i++)
+        {
+        reversed[i] = pts[npts - 1 - i];
+        }
+      polys->InsertNextCell(npts, reversed);
+      }
+    else
+      {
+      polys->InsertNextCell(npts, pts);
+      }
+    }
+  vtkSmartPointer<vtkPolyData> mixed = vtkSmartPointer<vtkPolyData>::New();
+  mixed->SetPoints(sphere->GetOutput()->GetPoints());
+  mixed->SetPolys(polys);
+  if (!TestNormals(mixed, threads, 1.0, 0, "Sphere") ||
+      !TestNormals(mixed, threads, 1.0, 1, "Sphere oriented automatically"))
+    {
+    return 1;
+    }
+
+  // A box with rounded edges, as triangle strips.
+  vtkSmartPointer<vtkSuperquadricSource> box =
+    vtkSmartPointer<vtkSuperquadricSource>::New();
+  box->SetThetaResolution(400);
+  box->SetPhiResolution(200);
+  box->SetThetaRoundness(0.2);
+  box->SetPhiRoundness(0.2);
+  vtkSmartPointer<vtkStripper> stripper = vtkSmartPointer<vtkStripper>::New();
+  stripper->SetInputConnection(box->GetOutputPort());
+  stripper->Update();
+  if (stripper->GetOutput()->GetNumberOfStrips() == 0 ||
+      !TestNormals(stripper->GetOutput(), threads, 30.0, 0, "Superquadric"))
+    {
+    return 1;
+    }
+  return 0;
+}
@@ -0,0 +1,182 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestPolyDataOffsets32.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME
+// .SECTION Description
+// Runs vtkPolyDataNormals, which splits and reorders the polygons of its
+// working copies through the pointers to their point ids, and
+// vtkTriangleFilter on a polydata whose cells are in the 32-bit offsets
+// layout of vtkCellArray. Checks that the outputs are those of the legacy
+// layout, that no error is reported and that the input keeps its layout.
+
+#include "vtkCallbackCommand.h"
+#include "vtkCellArray.h"
+#include "vtkCommand.h"
+#include "vtkDataArray.h"
+#include "vtkIdList.h"
+#include "vtkPointData.h"
+#include "vtkPolyData.h"
+#include "vtkPolyDataAlgorithm.h"
+#include "vtkPolyDataNormals.h"
+#include "vtkSmartPointer.h"
+#include "vtkSphereSource.h"
+#include "vtkTriangleFilter.h"
+
+static void CountErrors(vtkObject *, unsigned long, void *clientData,
+                        void *)
+{
+  ++*static_cast<int *>(clientData);
+}
+
+// Return 0 if the two polydata do not have the same points, cells and
+// point data arrays.
+static int ComparePolyData(vtkPolyData *pd1, vtkPolyData *pd2)
+{
+  if (pd1->GetNumberOfPoints() != pd2->GetNumberOfPoints() ||
+      pd1->GetNumberOfCells() != pd2->GetNumberOfCells())
+    {
+    return 0;
+    }
+  vtkIdType i;
+  for (i = 0; i < pd1->GetNumberOfPoints(); i++)
+    {
+    double p1[3], p2[3];
+    pd1->GetPoint(i, p1);
+    pd2->GetPoint(i, p2);
+    if (p1[0] != p2[0] || p1[1] != p2[1] || p1[2] != p2[2])
+      {
+      return 0;
+      }
+    }
+  vtkSmartPointer<vtkIdList> ids1 = vtkSmartPointer<vtkIdList>::New();
+  vtkSmartPointer<vtkIdList> ids2 = vtkSmartPointer<vtkIdList>::New();
+  for (i = 0; i < pd1->GetNumberOfCells(); i++)
+    {
+    pd1->GetCellPoints(i, ids1);
+    pd2->GetCellPoints(i, ids2);
+    if (pd1->GetCellType(i) != pd2->GetCellType(i) ||
+        ids1->GetNumberOfIds() != ids2->GetNumberOfIds())
+      {
+      return 0;
+      }
+    for (vtkIdType j = 0; j < ids1->GetNumberOfIds(); j++)
+      {
+      if (ids1->GetId(j) != ids2->GetId(j))
+        {
+        return 0;
+        }
+      }
+    }
+  vtkDataArray *normals1 = pd1->GetPointData()->GetNormals();
+  vtkDataArray *normals2 = pd2->GetPointData()->GetNormals();
+  if (!normals1 != !normals2)
+    {
+    return 0;
+    }
+  for (i = 0; normals1 && i < normals1->GetNumberOfTuples(); i++)
+    {
+    for (int c = 0; c < 3; c++)
+      {
+      if (normals1->GetComponent(i, c) != normals2->GetComponent(i, c))
+        {
+        return 0;
+        }
+      }
+    }
+  return 1;
+}
+
+// Run the filter on both inputs and return 0 if the outputs differ or the
+// filter reports errors.
+static int TestFilter(vtkPolyDataAlgorithm *filter, vtkPolyData *legacy,
+                      vtkPolyData *offsets32, const char *what)
+{
+  int errors = 0;
+  vtkSmartPointer<vtkCallbackCommand> errorObserver =
+    vtkSmartPointer<vtkCallbackCommand>::New();
+  errorObserver->SetCallback(CountErrors);
+  errorObserver->SetClientData(&errors);
+  filter->AddObserver(vtkCommand::ErrorEvent, errorObserver);
+
+  filter->SetInput(legacy);
+  filter->Update();
+  vtkSmartPointer<vtkPolyData> expected = vtkSmartPointer<vtkPolyData>::New();
+  expected->DeepCopy(filter->GetOutput());
+
+  filter->SetInput(offsets32);
+  filter->Update();
+  if (errors)
+    {
+    cerr << what << " reported " << errors << " errors" << endl;
+    return 0;
+    }
+  if (offsets32->GetPolys()->GetLayout() != VTK_CELL_ARRAY_OFFSETS_32)
+    {
+    cerr << what << " changed the layout of the input" << endl;
+    return 0;
+    }
+  if (expected->GetNumberOfCells() == 0 ||
+      !ComparePolyData(expected, filter->GetOutput()))
+    {
+    cerr << what << " gives another output for the 32-bit layout" << endl;
+    return 0;
+    }
+  return 1;
+}
+
+int TestPolyDataOffsets32(int, char *[])
+{
+  // A coarse sphere, whose edges are sharp enough to split the normals,
+  // with some polygons reversed so that the normals reorder them.
+  vtkSmartPointer<vtkSphereSource> sphere =
+    vtkSmartPointer<vtkSphereSource>::New();
+  sphere->SetThetaResolution(9);
+  sphere->SetPhiResolution(7);
+  sphere->Update();
+  vtkSmartPointer<vtkPolyData> legacy = vtkSmartPointer<vtkPolyData>::New();
+  legacy->DeepCopy(sphere->GetOutput());
+  for (vtkIdType i = 0; i < legacy->GetNumberOfCells(); i += 5)
+    {
+    legacy->ReverseCell(i);
+    }
+
+  vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+  polys->DeepCopy(legacy->GetPolys());
+  polys->SetLayoutToOffsets32();
+  vtkSmartPointer<vtkPolyData> offsets32 =
+    vtkSmartPointer<vtkPolyData>::New();
+  offsets32->SetPoints(legacy->GetPoints());
+  offsets32->SetPolys(polys);
+  offsets32->GetPointData()->ShallowCopy(legacy->GetPointData());
+
+  vtkSmartPointer<vtkPolyDataNormals> normals =
+    vtkSmartPointer<vtkPolyDataNormals>::New();
+  normals->SetFeatureAngle(20.0);
+  normals->SplittingOn();
+  normals->ConsistencyOn();
+  vtkSmartPointer<vtkTriangleFilter> triangles =
+    vtkSmartPointer<vtkTriangleFilter>::New();
+  if (!TestFilter(normals, legacy, offsets32, "vtkPolyDataNormals") ||
+      !TestFilter(triangles, legacy, offsets32, "vtkTriangleFilter"))
+    {
+    return 1;
+    }
+  if (normals->GetOutput()->GetNumberOfPoints() <=
+      legacy->GetNumberOfPoints())
+    {
+    cerr << "vtkPolyDataNormals did not split the sphere" << endl;
+    return 1;
+    }
+  return 0;
+}
@@ -0,0 +1,245 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestProbeFilterThreads.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME
+// .SECTION Description
+// Probes an image with a tilted plane, and a tetrahedral grid with random
+// points partly outside it, with vtkProbeFilter, with one thread and with
+// several. Checks that the image gives the same output, and that the grid
+// gives the same valid points, close values, and cell data of cells
+// containing the points. Reports the times.
+
+#include "vtkCellData.h"
+#include "vtkCharArray.h"
+#include "vtkDataArray.h"
+#include "vtkDataSetTriangleFilter.h"
+#include "vtkGenericCell.h"
+#include "vtkIdTypeArray.h"
+#include "vtkImageData.h"
+#include "vtkMath.h"
+#include "vtkPlaneSource.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkProbeFilter.h"
+#include "vtkRTAnalyticSource.h"
+#include "vtkSmartPointer.h"
+#include "vtkTestUtilities.h"
+#include "vtkTimerLog.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <math.h>
+
+// Probe the input with one thread and with several, and return 0 if the
+// valid points differ.
+static int Probe(vtkDataSet *input, vtkDataSet *source, int threads,
+                 const char *what, vtkProbeFilter *serial,
+                 vtkProbeFilter *threaded)
+{
+  vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+  serial->SetInput(input);
+  serial->SetSource(source);
+  serial->SetNumberOfThreads(1);
+  threaded->SetInput(input);
+  threaded->SetSource(source);
+  threaded->SetNumberOfThreads(threads);
+
+  timer->StartTimer();
+  serial->Update();
+  timer->StopTimer();
+  double serialTime = timer->GetElapsedTime();
+  timer->StartTimer();
+  threaded->Update();
+  timer->StopTimer();
+  double threadedTime = timer->GetElapsedTime();
+
+  vtkIdTypeArray *valid1 = serial->GetValidPoints();
+  vtkIdTypeArray *valid2 = threaded->GetValidPoints();
+  cout << what << ", " << valid1->GetNumberOfTuples() << " of "
+       << input->GetNumberOfPoints() << " points in the source: "
+       << serialTime << " s, with " << threads << " threads "
+       << threadedTime << " s" << endl;
+  if (valid1->GetNumberOfTuples() == 0 ||
+      valid1->GetNumberOfTuples() == input->GetNumberOfPoints() ||
+      valid1->GetNumberOfTuples() != valid2->GetNumberOfTuples())
+    {
+    cerr << what << ": " << valid2->GetNumberOfTuples()
+         << " valid points with " << threads << " threads" << endl;
+    return 0;
+    }
+  for (vtkIdType i = 0; i < valid1->GetNumberOfTuples(); i++)
+    {
+    if (valid1->GetValue(i) != valid2->GetValue(i))
+      {
+      cerr << what << ": valid point " << i << " differs" << endl;
+      return 0;
+      }
+    }
+  return 1;
+}
+
+// The arrays of the outputs agree within tol, relative to their range.
+static int CompareArrays(vtkDataSet *output1, vtkDataSet *output2,
+                         double tol)
+{
+  vtkPointData *pd1 = output1->GetPointData();
+  vtkPointData *pd2 = output2->GetPointData();
+  if (pd1->GetNumberOfArrays() != pd2->GetNumberOfArrays())
+    {
+    cerr << "The number of point arrays differs" << endl;
+    return 0;
+    }
+  for (int a = 0; a < pd1->GetNumberOfArrays(); a++)
+    {
+    vtkDataArray *a1 = pd1->GetArray(a);
+    vtkDataArray *a2 = pd2->GetArray(a1->GetName());
+    if (!a2 || a1->GetNumberOfTuples() != output1->GetNumberOfPoints() ||
+        a2->GetNumberOfTuples() != a1->GetNumberOfTuples() ||
+        a2->GetNumberOfComponents() != a1->GetNumberOfComponents())
+      {
+      cerr << "Array " << a1->GetName() << " differs in size" << endl;
+      return 0;
+      }
+    double range[2];
+    a1->GetRange(range, -1);
+    for (vtkIdType i = 0; i < a1->GetNumberOfTuples(); i++)
+      {
+      for (int c = 0; c < a1->GetNumberOfComponents(); c++)
+        {
+        if (fabs(a1->GetComponent(i, c) - a2->GetComponent(i, c)) >
+            tol*(range[1] - range[0]))
+          {
+          cerr << "Array " << a1->GetName() << " differs at " << i << endl;
+          return 0;
+          }
+        }
+      }
+    }
+  return 1;
+}
+
+int TestProbeFilterThreads(int, char *[])
+{
+  int threads = vtkTestUtilities::SetUpThreadPool(4);
+
+  vtkSmartPointer<vtkRTAnalyticSource> source =
+    vtkSmartPointer<vtkRTAnalyticSource>::New();
+  source->SetWholeExtent(-30, 29, -30, 29, -30, 29);
+  source->Update();
+  vtkImageData *image = source->GetOutput();
+
+  // A plane through the image, partly outside it.
+  vtkSmartPointer<vtkPlaneSource> plane =
+    vtkSmartPointer<vtkPlaneSource>::New();
+  plane->SetOrigin(-25.3, -40.1, -20.7);
+  plane->SetPoint1(28.9, -35.2, 10.4);
+  plane->SetPoint2(-30.2, 35.5, 25.1);
+  plane->SetResolution(300, 300);
+  plane->Update();
+  vtkSmartPointer<vtkProbeFilter> serial =
+    vtkSmartPointer<vtkProbeFilter>::New();
+  vtkSmartPointer<vtkProbeFilter> threaded =
+    vtkSmartPointer<vtkProbeFilter>::New();
+  if (serial->GetNumberOfThreads() != 1)
+    {
+    cerr << "Threads are used without asking for them" << endl;
+    return 1;
+    }
+  if (!Probe(plane->GetOutput(), image, threads, "Image", serial, threaded) ||
+      !CompareArrays(serial->GetOutput(), threaded->GetOutput(), 0.0))
+    {
+    return 1;
+    }
+
+  // Tetrahedra, with the ids of the cells as cell data.
+  vtkSmartPointer<vtkRTAnalyticSource> small =
+    vtkSmartPointer<vtkRTAnalyticSource>::New();
+  small->SetWholeExtent(-15, 14, -15, 14, -15, 14);
+  vtkSmartPointer<vtkDataSetTriangleFilter> tetra =
+    vtkSmartPointer<vtkDataSetTriangleFilter>::New();
+  tetra->SetInputConnection(small->GetOutputPort());
+  tetra->Update();
+  vtkSmartPointer<vtkUnstructuredGrid> grid =
+    vtkSmartPointer<vtkUnstructuredGrid>::New();
+  grid->ShallowCopy(tetra->GetOutput());
+  vtkSmartPointer<vtkIdTypeArray> cellIds =
+    vtkSmartPointer<vtkIdTypeArray>::New();
+  cellIds->SetName("CellIds");
+  cellIds->SetNumberOfTuples(grid->GetNumberOfCells());
+  for (vtkIdType cellId = 0; cellId < grid->GetNumberOfCells(); cellId++)
+    {
+    cellIds->SetValue(cellId, cellId);
+    }
+  grid->GetCellData()->AddArray(cellIds);
+
+  // Random points in a box a little larger than the grid.
+  vtkMath::RandomSeed(4321);
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetDataTypeToDouble();
+  vtkIdType numPts = 60000;
+  points->SetNumberOfPoints(numPts);
+  for (vtkIdType i = 0; i < numPts; i++)
+    {
+    points->SetPoint(i, vtkMath::Random(-17.0, 16.0),
+                     vtkMath::Random(-17.0, 16.0),
+                     vtkMath::Random(-17.0, 16.0));
+    }
+  vtkSmartPointer<vtkPolyData> cloud = vtkSmartPointer<vtkPolyData>::New();
+  cloud->SetPoints(points);
+  if (!Probe(cloud, grid, threads, "Tetrahedra", serial, threaded))
+    {
+    return 1;
+    }
+
+  // The cell data comes from a cell containing the point, which may be a
+  // neighbor of the cell the serial search found, as cells accept points
+  // a little outside them.
+  vtkDataSet *output = threaded->GetOutput();
+  vtkDataArray *outCellIds = output->GetPointData()->GetArray("CellIds");
+  vtkIdTypeArray *valid = threaded->GetValidPoints();
+  vtkSmartPointer<vtkGenericCell> cell =
+    vtkSmartPointer<vtkGenericCell>::New();
+  vtkIdType otherCells = 0;
+  for (vtkIdType i = 0; i < valid->GetNumberOfTuples(); i++)
+    {
+    vtkIdType ptId = valid->GetValue(i);
+    vtkIdType cellId = static_cast<vtkIdType>(outCellIds->GetComponent(ptId, 0));
+    double x[3], closestPoint[3], pcoords[3], weights[4], dist2;
+    int subId;
+    output->GetPoint(ptId, x);
+    grid->GetCell(cellId, cell);
+    if (cell->EvaluatePosition(x, closestPoint, subId, pcoords, dist2,
+                               weights) == -1 || dist2 > 1e-6)
+      {
+      cerr << "Point " << ptId << " is not in cell " << cellId << endl;
+      return 1;
+      }
+    if (cellId != static_cast<vtkIdType>(serial->GetOutput()->GetPointData()
+                                         ->GetArray("CellIds")
+                                         ->GetComponent(ptId, 0)))
+      {
+      otherCells++;
+      }
+    }
+  cout << otherCells << " points in another cell" << endl;
+
+  // The values interpolated in neighboring cells agree closely.
+  output->GetPointData()->RemoveArray("CellIds");
+  serial->GetOutput()->GetPointData()->RemoveArray("CellIds");
+  if (!CompareArrays(serial->GetOutput(), output, 1e-3))
+    {
+    return 1;
+    }
+  return 0;
+}
@@ -0,0 +1,239 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestStreamTracerThreads.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME
+// .SECTION Description
+// Traces streamlines of a swirling field from a plane of seeds with
+// vtkStreamTracer, through an image, through a tetrahedral grid and
+// through two images of different spacings sharing a face, with both
+// velocity field interpolators, with one thread and with several. Checks
+// that the outputs are identical, and reports the times.
+
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkDataSetTriangleFilter.h"
+#include "vtkDoubleArray.h"
+#include "vtkImageData.h"
+#include "vtkMultiBlockDataSet.h"
+#include "vtkPlaneSource.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkRTAnalyticSource.h"
+#include "vtkSmartPointer.h"
+#include "vtkStreamTracer.h"
+#include "vtkTestUtilities.h"
+#include "vtkTimerLog.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <math.h>
+
+static int CompareArrays(vtkDataArray *a1, vtkDataArray *a2)
+{
+  if (!a1 || !a2 ||
+      a1->GetNumberOfTuples() != a2->GetNumberOfTuples() ||
+      a1->GetNumberOfComponents() != a2->GetNumberOfComponents())
+    {
+    return 0;
+    }
+  int numComps = a1->GetNumberOfComponents();
+  for (vtkIdType i = 0; i < a1->GetNumberOfTuples(); i++)
+    {
+    for (int c = 0; c < numComps; c++)
+      {
+      if (a1->GetComponent(i, c) != a2->GetComponent(i, c))
+        {
+        return 0;
+        }
+      }
+    }
+  return 1;
+}
+
+static int CompareAttributes(vtkDataSetAttributes *d1,
+                             vtkDataSetAttributes *d2)
+{
+  if (d1->GetNumberOfArrays() != d2->GetNumberOfArrays())
+    {
+    return 0;
+    }
+  for (int i = 0; i < d1->GetNumberOfArrays(); i++)
+    {
+    if (!CompareArrays(d1->GetArray(i), d2->GetArray(i)) ||
+        strcmp(d1->GetArray(i)->GetName(), d2->GetArray(i)->GetName()))
+      {
+      return 0;
+      }
+    }
+  return 1;
+}
+
+static int CompareLines(vtkPolyData *pd1, vtkPolyData *pd2)
+{
+  if (!CompareArrays(pd1->GetPoints()->GetData(),
+                     pd2->GetPoints()->GetData()) ||
+      !CompareArrays(pd1->GetLines()->GetData(),
+                     pd2->GetLines()->GetData()))
+    {
+    cerr << "The points or the lines differ" << endl;
+    return 0;
+    }
+  if (!CompareAttributes(pd1->GetPointData(), pd2->GetPointData()) ||
+      !CompareAttributes(pd1->GetCellData(), pd2->GetCellData()))
+    {
+    cerr << "The point or cell data differ" << endl;
+    return 0;
+    }
+  return 1;
+}
+
+// Set the velocity of the field swirling about the z axis and rising along
+// it at the points of the image.
+static void SetVelocity(vtkImageData *image)
+{
+  vtkSmartPointer<vtkDoubleArray> velocity =
+    vtkSmartPointer<vtkDoubleArray>::New();
+  velocity->SetName("Velocity");
+  velocity->SetNumberOfComponents(3);
+  velocity->SetNumberOfTuples(image->GetNumberOfPoints());
+  for (vtkIdType i = 0; i < image->GetNumberOfPoints(); i++)
+    {
+    double x[3];
+    image->GetPoint(i, x);
+    velocity->SetTuple3(i, -x[1] - 0.05*x[0], x[0] - 0.05*x[1],
+                        0.3 + 0.2*sin(0.3*x[0]));
+    }
+  image->GetPointData()->SetVectors(velocity);
+}
+
+static int TestTrace(vtkDataObject *input, vtkPlaneSource *seeds,
+                     int interpolatorType, int threads, const char *what)
+{
+  vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+  vtkSmartPointer<vtkStreamTracer> serial =
+    vtkSmartPointer<vtkStreamTracer>::New();
+  vtkSmartPointer<vtkStreamTracer> threaded =
+    vtkSmartPointer<vtkStreamTracer>::New();
+  vtkStreamTracer *tracers[2] = {serial, threaded};
+  for (int i = 0; i < 2; i++)
+    {
+    tracers[i]->SetInput(input);
+    tracers[i]->SetSourceConnection(seeds->GetOutputPort());
+    tracers[i]->SetInterpolatorType(interpolatorType);
+    tracers[i]->SetIntegratorTypeToRungeKutta45();
+    tracers[i]->SetIntegrationDirectionToBoth();
+    tracers[i]->SetMaximumPropagation(80.0);
+    tracers[i]->SetInitialIntegrationStep(0.2);
+    }
+  serial->SetNumberOfThreads(1);
+  threaded->SetNumberOfThreads(threads);
+
+  timer->StartTimer();
+  serial->Update();
+  timer->StopTimer();
+  double serialTime = timer->GetElapsedTime();
+  timer->StartTimer();
+  threaded->Update();
+  timer->StopTimer();
+  double threadedTime = timer->GetElapsedTime();
+
+  vtkPolyData *output = serial->GetOutput();
+  cout << what << ", " << output->GetNumberOfLines() << " lines of "
+       << output->GetNumberOfPoints() << " points: " << serialTime
+       << " s, with " << threads << " threads " << threadedTime << " s"
+       << endl;
+  if (output->GetNumberOfLines() == 0 ||
+      !CompareLines(output, threaded->GetOutput()))
+    {
+    cerr << what << " differs with " << threads << " threads" << endl;
+    return 0;
+    }
+  return 1;
+}
+
+int TestStreamTracerThreads(int, char *[])
+{
+  int threads = vtkTestUtilities::SetUpThreadPool(4);
+
+  // A field swirling about the z axis and rising along it, with the
+  // analytic scalars to interpolate on the streamlines.
+  vtkSmartPointer<vtkRTAnalyticSource> source =
+    vtkSmartPointer<vtkRTAnalyticSource>::New();
+  source->SetWholeExtent(-20, 19, -20, 19, -10, 9);
+  source->Update();
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->ShallowCopy(source->GetOutput());
+  SetVelocity(image);
+
+  vtkSmartPointer<vtkPlaneSource> seeds =
+    vtkSmartPointer<vtkPlaneSource>::New();
+  seeds->SetOrigin(-15.5, -15.5, -5.5);
+  seeds->SetPoint1(15.5, -15.5, -5.5);
+  seeds->SetPoint2(-15.5, 15.5, 5.5);
+  seeds->SetResolution(24, 24);
+
+  if (!TestTrace(image, seeds,
+                 vtkStreamTracer::INTERPOLATOR_WITH_DATASET_POINT_LOCATOR,
+                 threads, "Image"))
+    {
+    return 1;
+    }
+
+  vtkSmartPointer<vtkDataSetTriangleFilter> tetra =
+    vtkSmartPointer<vtkDataSetTriangleFilter>::New();
+  tetra->SetInput(image);
+  tetra->Update();
+  if (!TestTrace(tetra->GetOutput(), seeds,
+                 vtkStreamTracer::INTERPOLATOR_WITH_DATASET_POINT_LOCATOR,
+                 threads, "Tetrahedra") ||
+      !TestTrace(tetra->GetOutput(), seeds,
+                 vtkStreamTracer::INTERPOLATOR_WITH_CELL_LOCATOR,
+                 threads, "Tetrahedra with a cell locator"))
+    {
+    return 1;
+    }
+
+  // The field in two blocks meeting at z = 0, the upper one twice as fine,
+  // seeded on the shared face: a seed must be traced from the same block
+  // whichever seed was traced before it.
+  vtkSmartPointer<vtkImageData> lower = vtkSmartPointer<vtkImageData>::New();
+  lower->SetExtent(-20, 19, -20, 19, -10, 0);
+  SetVelocity(lower);
+  vtkSmartPointer<vtkImageData> upper = vtkSmartPointer<vtkImageData>::New();
+  upper->SetExtent(-40, 38, -40, 38, 0, 18);
+  upper->SetSpacing(0.5, 0.5, 0.5);
+  SetVelocity(upper);
+  vtkSmartPointer<vtkMultiBlockDataSet> blocks =
+    vtkSmartPointer<vtkMultiBlockDataSet>::New();
+  blocks->SetNumberOfBlocks(2);
+  blocks->SetBlock(0, lower);
+  blocks->SetBlock(1, upper);
+  vtkSmartPointer<vtkPlaneSource> faceSeeds =
+    vtkSmartPointer<vtkPlaneSource>::New();
+  faceSeeds->SetOrigin(-15.5, -15.5, 0.0);
+  faceSeeds->SetPoint1(15.5, -15.5, 0.0);
+  faceSeeds->SetPoint2(-15.5, 15.5, 0.0);
+  faceSeeds->SetResolution(24, 24);
+  if (!TestTrace(blocks, faceSeeds,
+                 vtkStreamTracer::INTERPOLATOR_WITH_DATASET_POINT_LOCATOR,
+                 threads, "Two blocks") ||
+      !TestTrace(blocks, faceSeeds,
+                 vtkStreamTracer::INTERPOLATOR_WITH_CELL_LOCATOR,
+                 threads, "Two blocks with a cell locator"))
+    {
+    return 1;
+    }
+  return 0;
+}
@@ -0,0 +1,206 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestSynchronizedTemplates3DThreads.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME
+// .SECTION Description
+// Contours volumes with one thread and with several, and checks that the
+// outputs are identical: the same points, attributes and triangles in the
+// same order. Integer volumes with contour values equal to their samples
+// exercise the points shared across slabs. Reports the contouring times.
+
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkDoubleArray.h"
+#include "vtkIdTypeArray.h"
+#include "vtkImageData.h"
+#include "vtkMath.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkSynchronizedTemplates3D.h"
+#include "vtkTestUtilities.h"
+#include "vtkTimerLog.h"
+
+#include <math.h>
+
+static int CompareArrays(vtkDataArray *a1, vtkDataArray *a2, const char *what)
+{
+  if (!a1 || !a2 ||
+      a1->GetNumberOfTuples() != a2->GetNumberOfTuples() ||
+      a1->GetNumberOfComponents() != a2->GetNumberOfComponents())
+    {
+    cerr << what << " differ in size" << endl;
+    return 0;
+    }
+  int numComps = a1->GetNumberOfComponents();
+  for (vtkIdType i = 0; i < a1->GetNumberOfTuples(); i++)
+    {
+    for (int c = 0; c < numComps; c++)
+      {
+      if (a1->GetComponent(i, c) != a2->GetComponent(i, c))
+        {
+        cerr << what << " differ at tuple " << i << endl;
+        return 0;
+        }
+      }
+    }
+  return 1;
+}
+
+static int Compare(vtkPolyData *pd1, vtkPolyData *pd2)
+{
+  if (pd1->GetNumberOfPoints() == 0 || pd1->GetNumberOfPolys() == 0)
+    {
+    cerr << "Empty contour" << endl;
+    return 0;
+    }
+  if (!CompareArrays(pd1->GetPoints()->GetData(),
+                     pd2->GetPoints()->GetData(), "Points") ||
+      !CompareArrays(pd1->GetPolys()->GetData(), pd2->GetPolys()->GetData(),
+                     "Triangles"))
+    {
+    return 0;
+    }
+  if (pd1->GetPointData()->GetNumberOfArrays() !=
+      pd2->GetPointData()->GetNumberOfArrays() ||
+      pd1->GetCellData()->GetNumberOfArrays() !=
+      pd2->GetCellData()->GetNumberOfArrays())
+    {
+    cerr << "Attributes differ" << endl;
+    return 0;
+    }
+  int i;
+  for (i = 0; i < pd1->GetPointData()->GetNumberOfArrays(); i++)
+    {
+    vtkDataArray *a1 = pd1->GetPointData()->GetArray(i);
+    if (!CompareArrays(a1, pd2->GetPointData()->GetArray(i), "Point data"))
+      {
+      return 0;
+      }
+    }
+  for (i = 0; i < pd1->GetCellData()->GetNumberOfArrays(); i++)
+    {
+    vtkDataArray *a1 = pd1->GetCellData()->GetArray(i);
+    if (!CompareArrays(a1, pd2->GetCellData()->GetArray(i), "Cell data"))
+      {
+      return 0;
+      }
+    }
+  return 1;
+}
+
+// Contour with 1 thread, then with each number of threads.
+static int TestVolume(vtkImageData *image, const char *what, int numContours,
+                      double range[2], int gradients)
+{
+  vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+  vtkSmartPointer<vtkPolyData> serial;
+  double serialTime = 0.0;
+  int threads[4] = {1, 2, 3, 4};
+  for (int t = 0; t < 4; t++)
+    {
+    vtkSmartPointer<vtkSynchronizedTemplates3D> contour =
+      vtkSmartPointer<vtkSynchronizedTemplates3D>::New();
+    contour->SetInput(image);
+    contour->GenerateValues(numContours, range);
+    contour->SetComputeGradients(gradients);
+    contour->SetNumberOfThreads(threads[t]);
+    timer->StartTimer();
+    contour->Update();
+    timer->StopTimer();
+    if (t == 0)
+      {
+      serial = contour->GetOutput();
+      serialTime = timer->GetElapsedTime();
+      continue;
+      }
+    if (!Compare(serial, contour->GetOutput()))
+      {
+      cerr << what << ": " << threads[t] << " threads differ from 1" << endl;
+      return 0;
+      }
+    if (threads[t] == 4)
+      {
+      cout << what << ", " << serial->GetNumberOfPolys()
+           << " triangles: 1 thread " << serialTime << " s, 4 threads "
+           << timer->GetElapsedTime() << " s" << endl;
+      }
+    }
+  return 1;
+}
+
+int TestSynchronizedTemplates3DThreads(int, char *[])
+{
+  vtkTestUtilities::SetUpThreadPool(4);
+  vtkMath::RandomSeed(1618);
+
+  // Small integers, many of them equal to the contour values, with point
+  // and cell data to interpolate and copy. The extent starts at an odd
+  // negative slice.
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetExtent(-3, 36, 2, 31, -7, 52);
+  image->SetSpacing(0.5, 1.0, 0.75);
+  image->SetScalarTypeToShort();
+  image->AllocateScalars();
+  vtkDataArray *scalars = image->GetPointData()->GetScalars();
+  vtkSmartPointer<vtkDoubleArray> extra = vtkSmartPointer<vtkDoubleArray>::New();
+  extra->SetName("Extra");
+  extra->SetNumberOfComponents(2);
+  extra->SetNumberOfTuples(image->GetNumberOfPoints());
+  vtkIdType i;
+  for (i = 0; i < image->GetNumberOfPoints(); i++)
+    {
+    scalars->SetTuple1(i, static_cast<int>(vtkMath::Random(0.0, 5.999)));
+    extra->SetTuple2(i, vtkMath::Random(), i);
+    }
+  image->GetPointData()->AddArray(extra);
+  vtkSmartPointer<vtkIdTypeArray> cellIds =
+    vtkSmartPointer<vtkIdTypeArray>::New();
+  cellIds->SetName("CellIds");
+  cellIds->SetNumberOfTuples(image->GetNumberOfCells());
+  for (i = 0; i < image->GetNumberOfCells(); i++)
+    {
+    cellIds->SetValue(i, i);
+    }
+  image->GetCellData()->AddArray(cellIds);
+  double intRange[2] = {1.0, 4.0};
+  if (!TestVolume(image, "Integers", 4, intRange, 1))
+    {
+    return 1;
+    }
+
+  // A smooth field of nested surfaces.
+  const int res = 160;
+  vtkSmartPointer<vtkImageData> field = vtkSmartPointer<vtkImageData>::New();
+  field->SetDimensions(res, res, res);
+  field->SetScalarTypeToFloat();
+  field->AllocateScalars();
+  scalars = field->GetPointData()->GetScalars();
+  vtkIdType id = 0;
+  for (int k = 0; k < res; k++)
+    {
+    for (int j = 0; j < res; j++)
+      {
+      for (int l = 0; l < res; l++, id++)
+        {
+        double x = 8.0*l/res, y = 8.0*j/res, z = 8.0*k/res;
+        scalars->SetTuple1(id, sin(x)*cos(y) + sin(y)*cos(z) + sin(z)*cos(x));
+        }
+      }
+    }
+  double fieldRange[2] = {-0.5, 0.5};
+  return TestVolume(field, "Smooth field", 3, fieldRange, 0) ? 0 : 1;
+}
@@ -0,0 +1,247 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestTableBasedClipDataSetThreads.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME
+// .SECTION Description
+// Clips an image, a structured grid, an unstructured grid mixing cells the
+// tables clip with polygons they do not, and a polygonal sphere with
+// vtkTableBasedClipDataSet, with one thread and with several. Checks that
+// the outputs are identical, and reports the times.
+
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkDataSetTriangleFilter.h"
+#include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
+#include "vtkImageData.h"
+#include "vtkPlane.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkRTAnalyticSource.h"
+#include "vtkSmartPointer.h"
+#include "vtkSphereSource.h"
+#include "vtkStructuredGrid.h"
+#include "vtkTableBasedClipDataSet.h"
+#include "vtkTestUtilities.h"
+#include "vtkTimerLog.h"
+#include "vtkUnstructuredGrid.h"
+
+static int CompareArrays(vtkDataArray *a1, vtkDataArray *a2)
+{
+  if (!a1 || !a2 ||
+      a1->GetNumberOfTuples() != a2->GetNumberOfTuples() ||
+      a1->GetNumberOfComponents() != a2->GetNumberOfComponents())
+    {
+    return 0;
+    }
+  int numComps = a1->GetNumberOfComponents();
+  for (vtkIdType i = 0; i < a1->GetNumberOfTuples(); i++)
+    {
+    for (int c = 0; c < numComps; c++)
+      {
+      if (a1->GetComponent(i, c) != a2->GetComponent(i, c))
+        {
+        return 0;
+        }
+      }
+    }
+  return 1;
+}
+
+static int CompareAttributes(vtkDataSetAttributes *d1,
+                             vtkDataSetAttributes *d2)
+{
+  if (d1->GetNumberOfArrays() != d2->GetNumberOfArrays())
+    {
+    return 0;
+    }
+  for (int i = 0; i < d1->GetNumberOfArrays(); i++)
+    {
+    if (!CompareArrays(d1->GetArray(i), d2->GetArray(i)))
+      {
+      return 0;
+      }
+    }
+  return 1;
+}
+
+static int CompareGrids(vtkUnstructuredGrid *g1, vtkUnstructuredGrid *g2)
+{
+  if (g1->GetNumberOfCells() != g2->GetNumberOfCells() ||
+      !CompareArrays(g1->GetPoints()->GetData(), g2->GetPoints()->GetData()))
+    {
+    cerr << "The points or the number of cells differ" << endl;
+    return 0;
+    }
+  vtkSmartPointer<vtkIdList> ids1 = vtkSmartPointer<vtkIdList>::New();
+  vtkSmartPointer<vtkIdList> ids2 = vtkSmartPointer<vtkIdList>::New();
+  for (vtkIdType cellId = 0; cellId < g1->GetNumberOfCells(); cellId++)
+    {
+    g1->GetCellPoints(cellId, ids1);
+    g2->GetCellPoints(cellId, ids2);
+    int same = (g1->GetCellType(cellId) == g2->GetCellType(cellId) &&
+                ids1->GetNumberOfIds() == ids2->GetNumberOfIds());
+    for (vtkIdType i = 0; same && i < ids1->GetNumberOfIds(); i++)
+      {
+      same = (ids1->GetId(i) == ids2->GetId(i));
+      }
+    if (!same)
+      {
+      cerr << "Cell " << cellId << " differs" << endl;
+      return 0;
+      }
+    }
+  if (!CompareAttributes(g1->GetPointData(), g2->GetPointData()) ||
+      !CompareAttributes(g1->GetCellData(), g2->GetCellData()))
+    {
+    cerr << "The point or cell data differ" << endl;
+    return 0;
+    }
+  return 1;
+}
+
+static int TestClip(vtkDataSet *input, vtkPlane *plane, int threads,
+                    const char *what)
+{
+  vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+  vtkSmartPointer<vtkTableBasedClipDataSet> serial =
+    vtkSmartPointer<vtkTableBasedClipDataSet>::New();
+  serial->SetInput(input);
+  serial->SetNumberOfThreads(1);
+  vtkSmartPointer<vtkTableBasedClipDataSet> threaded =
+    vtkSmartPointer<vtkTableBasedClipDataSet>::New();
+  threaded->SetInput(input);
+  threaded->SetNumberOfThreads(threads);
+  if (plane)
+    {
+    serial->SetClipFunction(plane);
+    threaded->SetClipFunction(plane);
+    }
+  else
+    {
+    serial->SetValue(150.0);
+    threaded->SetValue(150.0);
+    }
+
+  for (int insideOut = 0; insideOut < 2; insideOut++)
+    {
+    serial->SetInsideOut(insideOut);
+    threaded->SetInsideOut(insideOut);
+    timer->StartTimer();
+    serial->Update();
+    timer->StopTimer();
+    double serialTime = timer->GetElapsedTime();
+    timer->StartTimer();
+    threaded->Update();
+    timer->StopTimer();
+    double threadedTime = timer->GetElapsedTime();
+
+    vtkUnstructuredGrid *output = serial->GetOutput();
+    cout << what << (insideOut ? " inside out, " : ", ")
+         << input->GetNumberOfCells() << " cells clipped to "
+         << output->GetNumberOfCells() << ": " << serialTime << " s, with "
+         << threads << " threads " << threadedTime << " s" << endl;
+    if (output->GetNumberOfCells() == 0 ||
+        !CompareGrids(output, threaded->GetOutput()))
+      {
+      cerr << what << " differs with " << threads << " threads" << endl;
+      return 0;
+      }
+    }
+  return 1;
+}
+
+int TestTableBasedClipDataSetThreads(int, char *[])
+{
+  int threads = vtkTestUtilities::SetUpThreadPool(4);
+
+  vtkSmartPointer<vtkRTAnalyticSource> source =
+    vtkSmartPointer<vtkRTAnalyticSource>::New();
+  source->SetWholeExtent(-25, 24, -25, 24, -25, 24);
+  source->Update();
+  vtkImageData *image = source->GetOutput();
+  if (!TestClip(image, NULL, threads, "Image"))
+    {
+    return 1;
+    }
+
+  // The image as a structured grid, clipped by a plane.
+  vtkSmartPointer<vtkStructuredGrid> structured =
+    vtkSmartPointer<vtkStructuredGrid>::New();
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetNumberOfPoints(image->GetNumberOfPoints());
+  for (vtkIdType i = 0; i < image->GetNumberOfPoints(); i++)
+    {
+    points->SetPoint(i, image->GetPoint(i));
+    }
+  structured->SetDimensions(image->GetDimensions());
+  structured->SetPoints(points);
+  structured->GetPointData()->PassData(image->GetPointData());
+  vtkSmartPointer<vtkPlane> plane = vtkSmartPointer<vtkPlane>::New();
+  plane->SetOrigin(1.5, -2.0, 0.5);
+  plane->SetNormal(0.3, 1.0, 0.6);
+  if (!TestClip(structured, plane, threads, "Structured grid"))
+    {
+    return 1;
+    }
+
+  // Tetrahedra with a polygon after every 997th, which the tables can not
+  // clip, and the ids of the input cells as cell data.
+  vtkSmartPointer<vtkRTAnalyticSource> small =
+    vtkSmartPointer<vtkRTAnalyticSource>::New();
+  small->SetWholeExtent(-15, 14, -15, 14, -15, 14);
+  vtkSmartPointer<vtkDataSetTriangleFilter> tetra =
+    vtkSmartPointer<vtkDataSetTriangleFilter>::New();
+  tetra->SetInputConnection(small->GetOutputPort());
+  tetra->Update();
+  vtkUnstructuredGrid *tets = tetra->GetOutput();
+  vtkSmartPointer<vtkUnstructuredGrid> mixed =
+    vtkSmartPointer<vtkUnstructuredGrid>::New();
+  mixed->SetPoints(tets->GetPoints());
+  mixed->GetPointData()->PassData(tets->GetPointData());
+  mixed->Allocate(tets->GetNumberOfCells());
+  vtkSmartPointer<vtkIdTypeArray> cellIds =
+    vtkSmartPointer<vtkIdTypeArray>::New();
+  cellIds->SetName("CellIds");
+  vtkSmartPointer<vtkIdList> ptIds = vtkSmartPointer<vtkIdList>::New();
+  for (vtkIdType cellId = 0; cellId < tets->GetNumberOfCells(); cellId++)
+    {
+    tets->GetCellPoints(cellId, ptIds);
+    cellIds->InsertNextValue(cellId);
+    mixed->InsertNextCell(tets->GetCellType(cellId), ptIds);
+    if (cellId % 997 == 0)
+      {
+      cellIds->InsertNextValue(-cellId);
+      mixed->InsertNextCell(VTK_POLYGON, ptIds);
+      }
+    }
+  mixed->GetCellData()->AddArray(cellIds);
+  if (!TestClip(mixed, NULL, threads, "Unstructured grid"))
+    {
+    return 1;
+    }
+
+  vtkSmartPointer<vtkSphereSource> sphere =
+    vtkSmartPointer<vtkSphereSource>::New();
+  sphere->SetThetaResolution(300);
+  sphere->SetPhiResolution(300);
+  sphere->SetRadius(10.0);
+  sphere->Update();
+  if (!TestClip(sphere->GetOutput(), plane, threads, "Sphere"))
+    {
+    return 1;
+    }
+  return 0;
+}
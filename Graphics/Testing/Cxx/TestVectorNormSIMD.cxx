@@ -0,0 +1,153 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestVectorNormSIMD.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME
+// .SECTION Description
+// Computes the norms of float and double point vectors with vtkVectorNorm,
+// once from aligned vectors (the vectorized loop) and once from vectors
+// one value past an aligned address (the scalar loop). Checks that both
+// give the norms computed here, normalized or not, for counts that leave
+// partial vectors before and after the aligned ones.
+
+#include "vtkDataArray.h"
+#include "vtkMath.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkVectorNorm.h"
+
+#include <vtkstd/vector>
+
+#include <math.h>
+
+// Compute the norms of the vectors in values, copied offset values past
+// an aligned address.
+static vtkSmartPointer<vtkDataArray> ComputeNorms(vtkPolyData *input,
+                                                  vtkDataArray *values,
+                                                  int offset, int normalize)
+{
+  vtkIdType numValues = values->GetNumberOfTuples();
+  vtkSmartPointer<vtkDataArray> storage;
+  storage.TakeReference(values->NewInstance());
+  storage->SetAlignment(16);
+  storage->SetNumberOfTuples(numValues + offset);
+
+  vtkDataArray *vectors = values->NewInstance();
+  vectors->SetNumberOfComponents(3);
+  vectors->SetVoidArray(storage->GetVoidPointer(offset), numValues, 1);
+  for (vtkIdType i = 0; i < numValues; i++)
+    {
+    vectors->SetComponent(i / 3, i % 3, values->GetComponent(i, 0));
+    }
+
+  vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+  polyData->SetPoints(input->GetPoints());
+  polyData->GetPointData()->SetVectors(vectors);
+  vectors->Delete();
+
+  vtkSmartPointer<vtkVectorNorm> norm = vtkSmartPointer<vtkVectorNorm>::New();
+  norm->SetInput(polyData);
+  norm->SetNormalize(normalize);
+  norm->Update();
+  return norm->GetOutput()->GetPointData()->GetScalars();
+}
+
+static int TestNorms(int dataType, vtkIdType numVectors, int normalize)
+{
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetNumberOfPoints(numVectors);
+  vtkIdType i;
+  for (i = 0; i < numVectors; i++)
+    {
+    points->SetPoint(i, i, 0.0, 0.0);
+    }
+  vtkSmartPointer<vtkPolyData> input = vtkSmartPointer<vtkPolyData>::New();
+  input->SetPoints(points);
+
+  vtkSmartPointer<vtkDataArray> values;
+  values.TakeReference(vtkDataArray::CreateDataArray(dataType));
+  values->SetNumberOfTuples(3*numVectors);
+  for (i = 0; i < 3*numVectors; i++)
+    {
+    values->SetComponent(i, 0, vtkMath::Random(-100.0, 100.0));
+    }
+
+  vtkSmartPointer<vtkDataArray> aligned =
+    ComputeNorms(input, values, 0, normalize);
+  vtkSmartPointer<vtkDataArray> misaligned =
+    ComputeNorms(input, values, 1, normalize);
+  if (!aligned || !misaligned ||
+      aligned->GetNumberOfTuples() != numVectors ||
+      misaligned->GetNumberOfTuples() != numVectors)
+    {
+    cerr << "Wrong number of norms for " << numVectors << " vectors" << endl;
+    return 0;
+    }
+
+  // The norms as the scalar loop computes them.
+  vtkstd::vector<float> norms(numVectors);
+  double maxNorm = 0.0;
+  for (i = 0; i < numVectors; i++)
+    {
+    double x = values->GetComponent(3*i, 0);
+    double y = values->GetComponent(3*i + 1, 0);
+    double z = values->GetComponent(3*i + 2, 0);
+    double norm = sqrt(x*x + y*y + z*z);
+    maxNorm = (norm > maxNorm) ? norm : maxNorm;
+    norms[i] = static_cast<float>(norm);
+    }
+
+  for (i = 0; i < numVectors; i++)
+    {
+    float expected = norms[i];
+    if (normalize)
+      {
+      expected = static_cast<float>(expected / maxNorm);
+      }
+    if (aligned->GetComponent(i, 0) != expected ||
+        misaligned->GetComponent(i, 0) != expected)
+      {
+      cerr << "Wrong norm for " << numVectors << " "
+           << vtkImageScalarTypeNameMacro(dataType) << " vectors, normalize "
+           << normalize << ", at " << i << ": " << aligned->GetComponent(i, 0)
+           << " (aligned) " << misaligned->GetComponent(i, 0)
+           << " (misaligned) " << expected << " (expected)" << endl;
+      return 0;
+      }
+    }
+  return 1;
+}
+
+int TestVectorNormSIMD(int, char *[])
+{
+  // Allocate the output scalars aligned, as the vectorized loop needs.
+  int alignment = vtkDataArray::GetGlobalAlignment();
+  vtkDataArray::SetGlobalAlignment(16);
+
+  static const vtkIdType counts[] = { 1, 2, 3, 4, 5, 7, 13, 64, 67, 1003 };
+  static const int numCounts = sizeof(counts) / sizeof(counts[0]);
+  int status = 1;
+  for (int c = 0; status && c < numCounts; c++)
+    {
+    for (int normalize = 0; status && normalize <= 1; normalize++)
+      {
+      status = TestNorms(VTK_FLOAT, counts[c], normalize) &&
+        TestNorms(VTK_DOUBLE, counts[c], normalize);
+      }
+    }
+
+  vtkDataArray::SetGlobalAlignment(alignment);
+  return !status;
+}
@@ -22,14 +22,198 @@
 #include "vtkGraph.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkMultiThreader.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
+#include "vtkPoints.h"
 #include "vtkPointSet.h"
 #include "vtkPolyData.h"
 #include "vtkUnstructuredGrid.h"
 
 vtkStandardNewMacro(vtkArrayCalculator);
 
+// Number of tuples gathered and evaluated together by each thread when
+// UseBlockEvaluation is on.
+#define VTK_ARRAY_CALCULATOR_CHUNK_SIZE (16*VTK_PARSER_BLOCK_SIZE)
+
+// The tuples are split in one range per thread. Each thread gathers the
+// values of the variables for a chunk of tuples at a time, evaluates them
+// with vtkFunctionParser::EvaluateBlock() and writes the results in place.
+class vtkArrayCalculatorBlocks
+{
+public:
+  vtkArrayCalculator *Self;
+  // Array and component providing each scalar variable and each component
+  // of each vector variable of the parser. A NULL array means that the
+  // values are the point coordinates of CoordinateSource.
+  vtkDataArray **ScalarSources;
+  int *ScalarComponents;
+  vtkDataArray **VectorSources;
+  int *VectorComponents;
+  vtkDataSet *CoordinateSource;
+  vtkDataArray *Result;
+  int NumberOfResultComponents;
+  vtkIdType NumberOfTuples;
+  // Number of tuples with invalid values found by each thread.
+  vtkIdType *NumberOfInvalidTuples;
+
+  vtkIdType Evaluate(vtkIdType begin, vtkIdType end);
+  static VTK_THREAD_RETURN_TYPE Execute(void *arg);
+};
+
+//----------------------------------------------------------------------------
+template <class T>
+void vtkArrayCalculatorGather(T *data, int numComps, int comp,
+                              vtkIdType begin, vtkIdType n, double *out)
+{
+  data += begin*numComps + comp;
+  for (vtkIdType i = 0; i < n; i++)
+    {
+    out[i] = static_cast<double>(data[i*numComps]);
+    }
+}
+
+//----------------------------------------------------------------------------
+static void vtkArrayCalculatorGatherValues(vtkDataArray *array, int comp,
+                                           vtkDataSet *coordinateSource,
+                                           vtkIdType begin, vtkIdType n,
+                                           double *out)
+{
+  vtkIdType i;
+  if (!array)
+    {
+    double x[3];
+    for (i = 0; i < n; i++)
+      {
+      coordinateSource->GetPoint(begin + i, x);
+      out[i] = x[comp];
+      }
+    return;
+    }
+  switch (array->GetDataType())
+    {
+    vtkTemplateMacro(
+      vtkArrayCalculatorGather(
+        static_cast<VTK_TT *>(array->GetVoidPointer(0)),
+        array->GetNumberOfComponents(), comp, begin, n, out));
+    default:
+      for (i = 0; i < n; i++)
+        {
+        out[i] = array->GetComponent(begin + i, comp);
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+void vtkArrayCalculatorScatter(const double *in, vtkIdType n, T *out)
+{
+  for (vtkIdType i = 0; i < n; i++)
+    {
+    out[i] = static_cast<T>(in[i]);
+    }
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkArrayCalculatorBlocks::Execute(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *info =
+    static_cast<vtkMultiThreader::ThreadInfo *>(arg);
+  vtkArrayCalculatorBlocks *self =
+    static_cast<vtkArrayCalculatorBlocks *>(info->UserData);
+
+  vtkIdType numTuples = self->NumberOfTuples;
+  vtkIdType begin = numTuples * info->ThreadID / info->NumberOfThreads;
+  vtkIdType end = numTuples * (info->ThreadID + 1) / info->NumberOfThreads;
+  if (begin < end)
+    {
+    self->NumberOfInvalidTuples[info->ThreadID] = self->Evaluate(begin, end);
+    }
+
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+// Evaluate the function for the tuples begin to end-1, and return the
+// number of tuples with invalid values. These are not reported here, as
+// the threads must not raise errors concurrently.
+vtkIdType vtkArrayCalculatorBlocks::Evaluate(vtkIdType begin, vtkIdType end)
+{
+  vtkFunctionParser *parser = this->Self->FunctionParser;
+  int numScalars = parser->GetNumberOfScalarVariables();
+  int numVectors = parser->GetNumberOfVectorVariables();
+  int numComps = this->NumberOfResultComponents;
+  vtkIdType chunk = VTK_ARRAY_CALCULATOR_CHUNK_SIZE;
+  vtkIdType start, n, t, numInvalid, totalInvalid = 0;
+  int i;
+
+  // One buffer of chunk values per scalar variable and per vector
+  // component, followed by the interleaved results.
+  int numBuffers = numScalars + 3*numVectors;
+  double *values = new double[(numBuffers + numComps)*chunk];
+  double *result = values + numBuffers*chunk;
+  double **scalarValues = new double *[numScalars + 1];
+  double **vectorValues = new double *[3*numVectors + 1];
+  for (i = 0; i < numScalars; i++)
+    {
+    scalarValues[i] = values + i*chunk;
+    }
+  for (i = 0; i < 3*numVectors; i++)
+    {
+    vectorValues[i] = values + (numScalars + i)*chunk;
+    }
+
+  for (start = begin; start < end; start += chunk)
+    {
+    n = (end - start < chunk ? end - start : chunk);
+    for (i = 0; i < numScalars; i++)
+      {
+      vtkArrayCalculatorGatherValues(this->ScalarSources[i],
+                                     this->ScalarComponents[i],
+                                     this->CoordinateSource, start, n,
+                                     scalarValues[i]);
+      }
+    for (i = 0; i < 3*numVectors; i++)
+      {
+      vtkArrayCalculatorGatherValues(this->VectorSources[i],
+                                     this->VectorComponents[i],
+                                     this->CoordinateSource, start, n,
+                                     vectorValues[i]);
+      }
+
+    // As with the tuple-by-tuple evaluation, only the invalid tuples are
+    // set to VTK_PARSER_ERROR_RESULT.
+    if (!parser->EvaluateBlock(n, scalarValues, vectorValues, result,
+                               &numInvalid))
+      {
+      for (t = 0; t < n*numComps; t++)
+        {
+        result[t] = VTK_PARSER_ERROR_RESULT;
+        }
+      numInvalid = n;
+      }
+    totalInvalid += numInvalid;
+
+    switch (this->Result->GetDataType())
+      {
+      vtkTemplateMacro(
+        vtkArrayCalculatorScatter(
+          result, n*numComps,
+          static_cast<VTK_TT *>(this->Result->GetVoidPointer(start*numComps))));
+      default:
+        for (t = 0; t < n; t++)
+          {
+          this->Result->SetTuple(start + t, result + numComps*t);
+          }
+      }
+    }
+
+  delete [] values;
+  delete [] scalarValues;
+  delete [] vectorValues;
+  return totalInvalid;
+}
+
 vtkArrayCalculator::vtkArrayCalculator()
 {
   this->FunctionParser = vtkFunctionParser::New();
@@ -56,6 +240,10 @@ vtkArrayCalculator::vtkArrayCalculator()
   this->ReplacementValue = 0.0;
 
   this->ResultArrayType=VTK_DOUBLE;
+
+  this->UseBlockEvaluation = 0;
+  this->Threader = vtkMultiThreader::New();
+  this->NumberOfThreads = this->Threader->GetNumberOfThreads();
 }
 
 vtkArrayCalculator::~vtkArrayCalculator()
@@ -64,6 +252,8 @@ vtkArrayCalculator::~vtkArrayCalculator()
   
   this->FunctionParser->Delete();
   this->FunctionParser = NULL;
+  this->Threader->Delete();
+  this->Threader = NULL;
   
   if (this->Function)
     {
@@ -443,60 +633,74 @@ int vtkArrayCalculator::RequestData(
     resultArray->SetTuple(0, this->FunctionParser->GetVectorResult());
     }
   
-  for (i = 1; i < numTuples; i++)
+  if (this->UseBlockEvaluation &&
+      this->FunctionParser->GetNumberOfScalarVariables() ==
+      this->NumberOfScalarArrays +
+      (attributeDataType == 0 ? this->NumberOfCoordinateScalarArrays : 0) &&
+      this->FunctionParser->GetNumberOfVectorVariables() ==
+      this->NumberOfVectorArrays +
+      (attributeDataType == 0 ? this->NumberOfCoordinateVectorArrays : 0))
     {
-    for (j = 0; j < this->NumberOfScalarArrays; j++)
-      {
-      currentArray = inFD->GetArray(this->ScalarArrayNames[j]);
-      this->FunctionParser->
-        SetScalarVariableValue(
-          j, currentArray->GetComponent(i, this->SelectedScalarComponents[j]));
-      }
-    for (j = 0; j < this->NumberOfVectorArrays; j++)
-      {
-      currentArray = inFD->GetArray(this->VectorArrayNames[j]);
-      this->FunctionParser->
-        SetVectorVariableValue(
-          j, currentArray->GetComponent(i, this->SelectedVectorComponents[j][0]),
-          currentArray->GetComponent(
-            i, this->SelectedVectorComponents[j][1]),
-          currentArray->GetComponent(i, this->SelectedVectorComponents[j][2]));
-      }
-    if(attributeDataType == 0)
+    this->BlockEvaluate(inFD, dsInput, graphInput, attributeDataType,
+                        numTuples, resultArray);
+    }
+  else
+    {
+    for (i = 1; i < numTuples; i++)
       {
-      double* pt = 0;
-      if (dsInput)
-        {
-        pt = dsInput->GetPoint(i);
-        }
-      else
-        {
-        pt = graphInput->GetPoint(i);
-        }
-      for (j = 0; j < this->NumberOfCoordinateScalarArrays; j++)
+      for (j = 0; j < this->NumberOfScalarArrays; j++)
         {
+        currentArray = inFD->GetArray(this->ScalarArrayNames[j]);
         this->FunctionParser->
           SetScalarVariableValue(
-            j+this->NumberOfScalarArrays, pt[this->SelectedCoordinateScalarComponents[j]]);
+            j, currentArray->GetComponent(i, this->SelectedScalarComponents[j]));
         }
-      for (j = 0; j < this->NumberOfCoordinateVectorArrays; j++)
+      for (j = 0; j < this->NumberOfVectorArrays; j++)
         {
+        currentArray = inFD->GetArray(this->VectorArrayNames[j]);
         this->FunctionParser->
           SetVectorVariableValue(
-            j+this->NumberOfVectorArrays,
-            pt[this->SelectedCoordinateVectorComponents[j][0]],
-            pt[this->SelectedCoordinateVectorComponents[j][1]],
-            pt[this->SelectedCoordinateVectorComponents[j][2]]);
+            j, currentArray->GetComponent(i, this->SelectedVectorComponents[j][0]),
+            currentArray->GetComponent(
+              i, this->SelectedVectorComponents[j][1]),
+            currentArray->GetComponent(i, this->SelectedVectorComponents[j][2]));
+        }
+      if(attributeDataType == 0)
+        {
+        double* pt = 0;
+        if (dsInput)
+          {
+          pt = dsInput->GetPoint(i);
+          }
+        else
+          {
+          pt = graphInput->GetPoint(i);
+          }
+        for (j = 0; j < this->NumberOfCoordinateScalarArrays; j++)
+          {
+          this->FunctionParser->
+            SetScalarVariableValue(
+              j+this->NumberOfScalarArrays, pt[this->SelectedCoordinateScalarComponents[j]]);
+          }
+        for (j = 0; j < this->NumberOfCoordinateVectorArrays; j++)
+          {
+          this->FunctionParser->
+            SetVectorVariableValue(
+              j+this->NumberOfVectorArrays,
+              pt[this->SelectedCoordinateVectorComponents[j][0]],
+              pt[this->SelectedCoordinateVectorComponents[j][1]],
+              pt[this->SelectedCoordinateVectorComponents[j][2]]);
+          }
+        }
+      if (resultType == 0)
+        {
+        scalarResult[0] = this->FunctionParser->GetScalarResult();
+        resultArray->SetTuple(i, scalarResult);
+        }
+      else
+        {
+        resultArray->SetTuple(i, this->FunctionParser->GetVectorResult());
         }
-      }
-    if (resultType == 0)
-      {
-      scalarResult[0] = this->FunctionParser->GetScalarResult();
-      resultArray->SetTuple(i, scalarResult);
-      }
-    else
-      {
-      resultArray->SetTuple(i, this->FunctionParser->GetVectorResult());
       }
     }
   
@@ -562,6 +766,115 @@ int vtkArrayCalculator::RequestData(
   return 1;
 }
 
+void vtkArrayCalculator::BlockEvaluate(vtkDataSetAttributes *inFD,
+                                       vtkDataSet *dsInput,
+                                       vtkGraph *graphInput,
+                                       int attributeDataType,
+                                       vtkIdType numTuples,
+                                       vtkDataArray *resultArray)
+{
+  int i, j;
+  int numScalars = this->FunctionParser->GetNumberOfScalarVariables();
+  int numVectors = this->FunctionParser->GetNumberOfVectorVariables();
+  int numThreads = this->NumberOfThreads;
+
+  vtkArrayCalculatorBlocks str;
+  str.Self = this;
+  str.ScalarSources = new vtkDataArray *[numScalars + 1];
+  str.ScalarComponents = new int[numScalars + 1];
+  str.VectorSources = new vtkDataArray *[3*numVectors + 1];
+  str.VectorComponents = new int[3*numVectors + 1];
+  str.CoordinateSource = dsInput;
+  str.Result = resultArray;
+  str.NumberOfResultComponents = resultArray->GetNumberOfComponents();
+  str.NumberOfTuples = numTuples;
+
+  for (i = 0; i < this->NumberOfScalarArrays; i++)
+    {
+    str.ScalarSources[i] = inFD->GetArray(this->ScalarArrayNames[i]);
+    str.ScalarComponents[i] = this->SelectedScalarComponents[i];
+    }
+  for (i = 0; i < this->NumberOfVectorArrays; i++)
+    {
+    for (j = 0; j < 3; j++)
+      {
+      str.VectorSources[3*i+j] = inFD->GetArray(this->VectorArrayNames[i]);
+      str.VectorComponents[3*i+j] = this->SelectedVectorComponents[i][j];
+      }
+    }
+
+  if (attributeDataType == 0)
+    {
+    // Read the coordinates straight from the points array when there is
+    // one. Otherwise they come from vtkDataSet::GetPoint(), which is not
+    // safe to call from several threads.
+    vtkDataArray *coordinates = 0;
+    vtkPointSet *psInput = vtkPointSet::SafeDownCast(dsInput);
+    if (psInput && psInput->GetPoints())
+      {
+      coordinates = psInput->GetPoints()->GetData();
+      }
+    else if (graphInput && graphInput->GetPoints())
+      {
+      coordinates = graphInput->GetPoints()->GetData();
+      }
+    if (!coordinates && (this->NumberOfCoordinateScalarArrays > 0 ||
+                         this->NumberOfCoordinateVectorArrays > 0))
+      {
+      numThreads = 1;
+      }
+    for (i = 0; i < this->NumberOfCoordinateScalarArrays; i++)
+      {
+      str.ScalarSources[this->NumberOfScalarArrays + i] = coordinates;
+      str.ScalarComponents[this->NumberOfScalarArrays + i] =
+        this->SelectedCoordinateScalarComponents[i];
+      }
+    for (i = 0; i < this->NumberOfCoordinateVectorArrays; i++)
+      {
+      for (j = 0; j < 3; j++)
+        {
+        int k = 3*(this->NumberOfVectorArrays + i) + j;
+        str.VectorSources[k] = coordinates;
+        str.VectorComponents[k] = this->SelectedCoordinateVectorComponents[i][j];
+        }
+      }
+    }
+
+  if (numTuples < numThreads)
+    {
+    numThreads = static_cast<int>(numTuples);
+    }
+  this->Threader->SetNumberOfThreads(numThreads);
+  numThreads = this->Threader->GetNumberOfThreads();
+  str.NumberOfInvalidTuples = new vtkIdType[numThreads];
+  for (i = 0; i < numThreads; i++)
+    {
+    str.NumberOfInvalidTuples[i] = 0;
+    }
+  this->Threader->SetSingleMethod(vtkArrayCalculatorBlocks::Execute, &str);
+  this->Threader->SingleMethodExecute();
+
+  // Report the invalid values once, from this thread.
+  vtkIdType numInvalid = 0;
+  for (i = 0; i < numThreads; i++)
+    {
+    numInvalid += str.NumberOfInvalidTuples[i];
+    }
+  if (numInvalid > 0)
+    {
+    vtkErrorMacro(<< "Invalid values in " << numInvalid << " of "
+                  << numTuples << " tuples, whose results are set to "
+                  << VTK_PARSER_ERROR_RESULT
+                  << ". Turn ReplaceInvalidValues on to replace them.");
+    }
+
+  delete [] str.ScalarSources;
+  delete [] str.ScalarComponents;
+  delete [] str.VectorSources;
+  delete [] str.VectorComponents;
+  delete [] str.NumberOfInvalidTuples;
+}
+
 void vtkArrayCalculator::SetFunction(const char* function)
 {
   if (this->Function && function &&
@@ -1219,4 +1532,7 @@ void vtkArrayCalculator::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Replace Invalid Values: " 
      << (this->ReplaceInvalidValues ? "On" : "Off") << endl;
   os << indent << "Replacement Value: " << this->ReplacementValue << endl;
+  os << indent << "Use Block Evaluation: "
+     << (this->UseBlockEvaluation ? "On" : "Off") << endl;
+  os << indent << "Number Of Threads: " << this->NumberOfThreads << endl;
 }
@@ -52,6 +52,11 @@
 // tuple-wise (i.e., tuple-by-tuple). The user must specify which arrays to use as
 // vectors and/or scalars, and the name of the output data array.
 //
+// When UseBlockEvaluation is on, the tuples are split over NumberOfThreads
+// threads and each thread evaluates the function over blocks of tuples
+// with vtkFunctionParser::EvaluateBlock(), instead of setting the
+// variables and evaluating the function once per tuple.
+//
 // .SECTION See Also
 // vtkFunctionParser
 
@@ -60,7 +65,11 @@
 
 #include "vtkDataSetAlgorithm.h"
 
+class vtkDataArray;
+class vtkDataSetAttributes;
 class vtkFunctionParser;
+class vtkGraph;
+class vtkMultiThreader;
 
 #define VTK_ATTRIBUTE_MODE_DEFAULT 0
 #define VTK_ATTRIBUTE_MODE_USE_POINT_DATA 1
@@ -200,11 +209,33 @@ public:
   vtkSetMacro(ReplacementValue,double);
   vtkGetMacro(ReplacementValue,double);
 
+  // Description:
+  // When UseBlockEvaluation is on, the function is evaluated over blocks
+  // of tuples by several threads (see NumberOfThreads). The results are
+  // the same as with the default tuple-by-tuple evaluation, but invalid
+  // values are reported in one error for all the tuples instead of one
+  // per tuple. Initial value is off.
+  vtkSetMacro(UseBlockEvaluation,int);
+  vtkGetMacro(UseBlockEvaluation,int);
+  vtkBooleanMacro(UseBlockEvaluation,int);
+
+  // Description:
+  // Get/Set the number of threads used when UseBlockEvaluation is on.
+  vtkSetClampMacro(NumberOfThreads, int, 1, VTK_MAX_THREADS);
+  vtkGetMacro(NumberOfThreads, int);
+
 protected:
   vtkArrayCalculator();
   ~vtkArrayCalculator();
 
   virtual int RequestData(vtkInformation *, vtkInformationVector **, vtkInformationVector *);
+
+  // Description:
+  // Evaluate the function for all the tuples of inFD with
+  // vtkFunctionParser::EvaluateBlock(), using NumberOfThreads threads.
+  void BlockEvaluate(vtkDataSetAttributes *inFD, vtkDataSet *dsInput,
+                     vtkGraph *graphInput, int attributeDataType,
+                     vtkIdType numTuples, vtkDataArray *resultArray);
   
   char  * Function;
   char  * ResultArrayName;
@@ -231,6 +262,12 @@ protected:
   int     NumberOfCoordinateVectorArrays;
 
   int     ResultArrayType;
+
+  int     UseBlockEvaluation;
+  int     NumberOfThreads;
+  vtkMultiThreader* Threader;
+
+  friend class vtkArrayCalculatorBlocks;
 private:
   vtkArrayCalculator(const vtkArrayCalculator&);  // Not implemented.
   void operator=(const vtkArrayCalculator&);  // Not implemented.
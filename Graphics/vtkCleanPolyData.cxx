@@ -19,14 +19,115 @@
 #include "vtkMergePoints.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkMath.h"
+#include "vtkMultiThreader.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkIncrementalPointLocator.h"
 
+#include <vtkstd/algorithm>
+#include <vtkstd/vector>
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+// The smallest run of points a thread merges, and the number of runs per
+// thread.
+#define VTK_CLEAN_POLY_DATA_MIN_PIECE_POINTS 5000
+#define VTK_CLEAN_POLY_DATA_PIECES_PER_THREAD 4
+
 vtkStandardNewMacro(vtkCleanPolyData);
 
+//---------------------------------------------------------------------------
+// A point to merge, sorted on the hash of the coordinates it has once
+// stored (or of its cell in the tolerance grid), then on these, then on
+// the order the cells use it in.
+struct vtkCleanPolyDataEntry
+{
+  vtkTypeUInt64 Key;
+  vtkTypeInt64 Cell[3];
+  vtkIdType Rank;
+
+  bool SameCell(const vtkCleanPolyDataEntry &e) const
+    {
+    return this->Key == e.Key && this->Cell[0] == e.Cell[0] &&
+      this->Cell[1] == e.Cell[1] && this->Cell[2] == e.Cell[2];
+    }
+  bool operator<(const vtkCleanPolyDataEntry &e) const
+    {
+    if (this->Key != e.Key)
+      {
+      return this->Key < e.Key;
+      }
+    for (int i = 0; i < 3; i++)
+      {
+      if (this->Cell[i] != e.Cell[i])
+        {
+        return this->Cell[i] < e.Cell[i];
+        }
+      }
+    return this->Rank < e.Rank;
+    }
+};
+
+static vtkTypeUInt64 vtkCleanPolyDataHash(const vtkTypeInt64 cell[3])
+{
+  vtkTypeUInt64 h = 0;
+  for (int i = 0; i < 3; i++)
+    {
+    vtkTypeUInt64 c = static_cast<vtkTypeUInt64>(cell[i]);
+    h = (h ^ c ^ (c >> 29)) * 2654435761u;
+    h ^= (h >> 32);
+    }
+  return h;
+}
+
+//---------------------------------------------------------------------------
+// The state of the threads merging the points. The points used by the
+// cells are ranked in the order the cells use them, and each is merged
+// with the point of lowest rank it merges with, which keeps its rank.
+class vtkCleanPolyDataMerge
+{
+public:
+  enum { MAP, SCATTER, SORT, CANDIDATES, POINTS };
+
+  vtkCleanPolyData *Self;
+  vtkPoints *InPoints;
+  int Pass;
+  int StoreFloat;
+  double Tolerance2;
+  double Reach;
+  double CellSize;
+  double Origin[3];
+  vtkIdType NumberOfPoints;
+  int NumberOfPieces;
+  vtkIdType *Order;   // input point of each rank
+  double *Mapped;     // point of each rank given by OperateOnPoint()
+  vtkIdType *Rep;     // rank of the point each rank merges with
+  vtkIdType *NewIds;  // new point of each rank keeping its point
+  vtkPoints *NewPoints;
+  vtkIdType *PointMap;
+  vtkstd::vector<vtkCleanPolyDataEntry> Entries;
+  vtkstd::vector<vtkIdType> Counts; // entries of each piece and partition
+  vtkstd::vector<vtkIdType> PartitionStart;
+  vtkstd::vector<vtkstd::vector<vtkIdType> > Candidates;
+  vtkstd::vector<vtkstd::vector<vtkIdType> > Tables; // grid cells
+
+  void Run(int pass);
+  void Stored(vtkIdType rank, double x[3]);
+  int MakeEntry(vtkIdType rank, vtkCleanPolyDataEntry &e);
+  void MapPiece(int piece);
+  void ScatterPiece(int piece);
+  void SortPiece(int piece);
+  const vtkCleanPolyDataEntry *FindCell(const vtkCleanPolyDataEntry &probe);
+  void CandidatesPiece(int piece);
+  void PointsPiece(int piece);
+  static VTK_THREAD_RETURN_TYPE Execute(void *arg);
+};
+
 //---------------------------------------------------------------------------
 // Specify a spatial locator for speeding the search process. By
 // default an instance of vtkPointLocator is used.
@@ -45,6 +146,8 @@ vtkCleanPolyData::vtkCleanPolyData()
   this->ConvertStripsToPolys = 1;
   this->Locator = NULL;
   this->PieceInvariant = 1;
+  this->ParallelMerging = 0;
+  this->NumberOfThreads = vtkMultiThreader::GetGlobalDefaultNumberOfThreads();
 }
 
 //--------------------------------------------------------------------------
@@ -186,9 +289,16 @@ int vtkCleanPolyData::RequestData(
   vtkPointData *inputPD = input->GetPointData();
   vtkCellData  *inputCD = input->GetCellData();
 
+  // Points stored as float or double may be merged by threads, which use
+  // the point map as when merging is off.
+  int mergeInPieces = ( this->PointMerging && this->ParallelMerging &&
+                        ( newPts->GetDataType() == VTK_FLOAT ||
+                          newPts->GetDataType() == VTK_DOUBLE ) );
+  int usePointMap = ( !this->PointMerging || mergeInPieces );
+
   // We must be careful to 'operate' on the bounds of the locator so
   // that all inserted points lie inside it
-  if ( this->PointMerging )
+  if ( !usePointMap )
     {
     this->CreateDefaultLocator(input);
     if (this->ToleranceIsAbsolute) 
@@ -218,6 +328,14 @@ int vtkCleanPolyData::RequestData(
   outputPD->CopyAllocate(inputPD);
   outputCD->CopyAllocate(inputCD);
 
+  if ( mergeInPieces )
+    {
+    double tol = ( this->ToleranceIsAbsolute ? this->AbsoluteTolerance :
+                   this->Tolerance*input->GetLength() );
+    numUsedPts = this->MergePointsInPieces(input, tol, newPts, pointMap,
+                                           outputPD);
+    }
+
   // Celldata needs to be copied correctly. If a poly is converted to
   // a line, or a line to a point, then using a CellCounter will not
   // do, as the cells should be ordered verts, lines, polys,
@@ -245,20 +363,25 @@ int vtkCleanPolyData::RequestData(
       {
       for ( numNewPts=0, i=0; i < npts; i++ ) 
         {
-        inPts->GetPoint(pts[i],x);
-        this->OperateOnPoint(x, newx);
-        if ( ! this->PointMerging )
+        if ( usePointMap )
           {
           if ( (ptId=pointMap[pts[i]]) == -1 )
             {
+            inPts->GetPoint(pts[i],x);
+            this->OperateOnPoint(x, newx);
             pointMap[pts[i]] = ptId = numUsedPts++;
             newPts->SetPoint(ptId,newx);
             outputPD->CopyData(inputPD,pts[i],ptId);
             }
           }
-        else if ( this->Locator->InsertUniquePoint(newx, ptId) ) 
+        else
           {
-          outputPD->CopyData(inputPD,pts[i],ptId);
+          inPts->GetPoint(pts[i],x);
+          this->OperateOnPoint(x, newx);
+          if ( this->Locator->InsertUniquePoint(newx, ptId) ) 
+            {
+            outputPD->CopyData(inputPD,pts[i],ptId);
+            }
           }
         updatedPts[numNewPts++] = ptId;
         }//for all points of vertex cell
@@ -290,20 +413,25 @@ int vtkCleanPolyData::RequestData(
       {
       for ( numNewPts=0, i=0; i<npts; i++ ) 
         {
-        inPts->GetPoint(pts[i],x);
-        this->OperateOnPoint(x, newx);
-        if ( ! this->PointMerging )
+        if ( usePointMap )
           {
           if ( (ptId=pointMap[pts[i]]) == -1 )
             {
+            inPts->GetPoint(pts[i],x);
+            this->OperateOnPoint(x, newx);
             pointMap[pts[i]] = ptId = numUsedPts++;
             newPts->SetPoint(ptId,newx);
             outputPD->CopyData(inputPD,pts[i],ptId);
             }
           }
-        else if ( this->Locator->InsertUniquePoint(newx, ptId) ) 
+        else
           {
-          outputPD->CopyData(inputPD,pts[i],ptId);
+          inPts->GetPoint(pts[i],x);
+          this->OperateOnPoint(x, newx);
+          if ( this->Locator->InsertUniquePoint(newx, ptId) ) 
+            {
+            outputPD->CopyData(inputPD,pts[i],ptId);
+            }
           }
         if ( i == 0 || ptId != updatedPts[numNewPts-1] ) 
           {
@@ -356,20 +484,25 @@ int vtkCleanPolyData::RequestData(
       {
       for ( numNewPts=0, i=0; i<npts; i++ ) 
         {
-        inPts->GetPoint(pts[i],x);
-        this->OperateOnPoint(x, newx);
-        if ( ! this->PointMerging )
+        if ( usePointMap )
           {
           if ( (ptId=pointMap[pts[i]]) == -1 )
             {
+            inPts->GetPoint(pts[i],x);
+            this->OperateOnPoint(x, newx);
             pointMap[pts[i]] = ptId = numUsedPts++;
             newPts->SetPoint(ptId,newx);
             outputPD->CopyData(inputPD,pts[i],ptId);
             }
           }
-        else if ( this->Locator->InsertUniquePoint(newx, ptId) ) 
+        else
           {
-          outputPD->CopyData(inputPD,pts[i],ptId);
+          inPts->GetPoint(pts[i],x);
+          this->OperateOnPoint(x, newx);
+          if ( this->Locator->InsertUniquePoint(newx, ptId) ) 
+            {
+            outputPD->CopyData(inputPD,pts[i],ptId);
+            }
           }
         if ( i == 0 || ptId != updatedPts[numNewPts-1] ) 
           {
@@ -442,20 +575,25 @@ int vtkCleanPolyData::RequestData(
       {
       for ( numNewPts=0, i=0; i < npts; i++ ) 
         {
-        inPts->GetPoint(pts[i],x);
-        this->OperateOnPoint(x, newx);
-        if ( ! this->PointMerging )
+        if ( usePointMap )
           {
           if ( (ptId=pointMap[pts[i]]) == -1 )
             {
+            inPts->GetPoint(pts[i],x);
+            this->OperateOnPoint(x, newx);
             pointMap[pts[i]] = ptId = numUsedPts++;
             newPts->SetPoint(ptId,newx);
             outputPD->CopyData(inputPD,pts[i],ptId);
             }
           }
-        else if ( this->Locator->InsertUniquePoint(newx, ptId) ) 
+        else
           {
-          outputPD->CopyData(inputPD,pts[i],ptId);
+          inPts->GetPoint(pts[i],x);
+          this->OperateOnPoint(x, newx);
+          if ( this->Locator->InsertUniquePoint(newx, ptId) ) 
+            {
+            outputPD->CopyData(inputPD,pts[i],ptId);
+            }
           }
         if ( i == 0 || ptId != updatedPts[numNewPts-1] ) 
           {
@@ -533,7 +671,7 @@ int vtkCleanPolyData::RequestData(
   // Update ourselves and release memory
   //
   delete [] updatedPts;
-  if ( this->PointMerging )
+  if ( !usePointMap )
     {
     this->Locator->Initialize(); //release memory.
     }
@@ -602,6 +740,444 @@ int vtkCleanPolyData::RequestData(
   return 1;
 }
 
+//--------------------------------------------------------------------------
+// Merge the used points with threads. The points are ranked in the order
+// the cells use them, which is the order the locator inserts them in, and
+// sorted into partitions on the hash of their key, so that the points with
+// the same key are next to each other in one partition.
+vtkIdType vtkCleanPolyData::MergePointsInPieces(vtkPolyData *input,
+                                                double tol,
+                                                vtkPoints *newPts,
+                                                vtkIdType *pointMap,
+                                                vtkPointData *outputPD)
+{
+  vtkPointData *inputPD = input->GetPointData();
+  vtkIdType numPts = input->GetNumberOfPoints();
+  vtkIdType *order = new vtkIdType[numPts];
+  vtkIdType numUsed = 0, npts, *pts, i, r;
+  vtkCellArray *cells[4];
+  cells[0] = input->GetVerts();
+  cells[1] = input->GetLines();
+  cells[2] = input->GetPolys();
+  cells[3] = input->GetStrips();
+  for (int c = 0; c < 4; c++)
+    {
+    for (cells[c]->InitTraversal(); cells[c]->GetNextCell(npts,pts); )
+      {
+      for (i=0; i < npts; i++)
+        {
+        if ( pointMap[pts[i]] == -1 )
+          {
+          pointMap[pts[i]] = numUsed;
+          order[numUsed++] = pts[i];
+          }
+        }
+      }
+    }
+
+  vtkCleanPolyDataMerge merge;
+  merge.Self = this;
+  merge.InPoints = input->GetPoints();
+  merge.StoreFloat = ( newPts->GetDataType() == VTK_FLOAT );
+  merge.Tolerance2 = tol*tol;
+  merge.NumberOfPoints = numUsed;
+  merge.Order = order;
+  merge.Mapped = new double[3*numUsed];
+  merge.Rep = new vtkIdType[numUsed];
+  merge.NewIds = new vtkIdType[numUsed];
+  merge.NewPoints = newPts;
+  merge.PointMap = pointMap;
+  vtkIdType numPieces = numUsed/VTK_CLEAN_POLY_DATA_MIN_PIECE_POINTS;
+  if ( numPieces > VTK_CLEAN_POLY_DATA_PIECES_PER_THREAD*this->NumberOfThreads )
+    {
+    numPieces = VTK_CLEAN_POLY_DATA_PIECES_PER_THREAD*this->NumberOfThreads;
+    }
+  merge.NumberOfPieces = static_cast<int>(numPieces > 1 ? numPieces : 1);
+
+  // With a tolerance, the points are keyed on their cell in a grid of
+  // twice the reach, a little more than the tolerance, so that the points
+  // within the tolerance of a point, once stored and rounded, are in its
+  // cell or in the neighboring cells on the sides it is within the reach
+  // of: 8 cells at most instead of 27.
+  double bounds[6], mappedBounds[6], maxAbs = 0.0;
+  input->GetBounds(bounds);
+  this->OperateOnBounds(bounds, mappedBounds);
+  for (i=0; i < 6; i++)
+    {
+    maxAbs = ( fabs(mappedBounds[i]) > maxAbs ? fabs(mappedBounds[i]) :
+               maxAbs );
+    }
+  for (i=0; i < 3; i++)
+    {
+    merge.Origin[i] = mappedBounds[2*i];
+    }
+  merge.Reach = 0.0;
+  if ( tol > 0.0 )
+    {
+    merge.Reach = 1.01*tol +
+      4.0*(merge.StoreFloat ? FLT_EPSILON : DBL_EPSILON)*maxAbs;
+    }
+  merge.CellSize = 2.0*merge.Reach;
+
+  // Key the points, and sort them into the partitions.
+  int numParts = merge.NumberOfPieces;
+  merge.Counts.assign(numParts*numParts, 0);
+  merge.Run(vtkCleanPolyDataMerge::MAP);
+  vtkIdType numEntries = 0;
+  merge.PartitionStart.resize(numParts + 1);
+  for (int part = 0; part < numParts; part++)
+    {
+    merge.PartitionStart[part] = numEntries;
+    for (int piece = 0; piece < numParts; piece++)
+      {
+      vtkIdType count = merge.Counts[piece*numParts + part];
+      merge.Counts[piece*numParts + part] = numEntries;
+      numEntries += count;
+      }
+    }
+  merge.PartitionStart[numParts] = numEntries;
+  merge.Entries.resize(numEntries);
+  merge.Run(vtkCleanPolyDataMerge::SCATTER);
+  merge.Tables.resize(numParts);
+  merge.Run(vtkCleanPolyDataMerge::SORT);
+
+  // With a tolerance, each point merges with the first point it is close
+  // to that keeps its rank, so the candidates are resolved in rank order.
+  if ( tol > 0.0 )
+    {
+    merge.Candidates.resize(merge.NumberOfPieces);
+    merge.Run(vtkCleanPolyDataMerge::CANDIDATES);
+    for (int piece = 0; piece < merge.NumberOfPieces; piece++)
+      {
+      vtkstd::vector<vtkIdType> &candidates = merge.Candidates[piece];
+      size_t c = 0;
+      while ( c < candidates.size() )
+        {
+        r = candidates[c++];
+        vtkIdType numCandidates = candidates[c++];
+        for (i=0; i < numCandidates; i++)
+          {
+          vtkIdType q = candidates[c + i];
+          if ( merge.Rep[q] == q )
+            {
+            merge.Rep[r] = q;
+            break;
+            }
+          }
+        c += numCandidates;
+        }
+      }
+    }
+
+  // Number the points keeping their rank in rank order, as the locator
+  // inserts them, and fill the new points and the point map.
+  vtkIdType numNewPts = 0;
+  for (r=0; r < numUsed; r++)
+    {
+    if ( merge.Rep[r] == r )
+      {
+      merge.NewIds[r] = numNewPts;
+      outputPD->CopyData(inputPD, order[r], numNewPts++);
+      }
+    }
+  newPts->SetNumberOfPoints(numNewPts);
+  merge.Run(vtkCleanPolyDataMerge::POINTS);
+
+  vtkDebugMacro(<<"Merged " << numUsed << " points into " << numNewPts
+                << " in " << merge.NumberOfPieces << " pieces");
+  delete [] order;
+  delete [] merge.Mapped;
+  delete [] merge.Rep;
+  delete [] merge.NewIds;
+  return numNewPts;
+}
+
+//--------------------------------------------------------------------------
+void vtkCleanPolyDataMerge::Run(int pass)
+{
+  this->Pass = pass;
+  vtkMultiThreader *threader = vtkMultiThreader::New();
+  threader->UseThreadPoolOn();
+  threader->SetNumberOfThreads(this->Self->NumberOfThreads);
+  threader->SetNumberOfPieces(this->NumberOfPieces);
+  threader->SetSingleMethod(vtkCleanPolyDataMerge::Execute, this);
+  threader->SingleMethodExecute();
+  threader->Delete();
+}
+
+//--------------------------------------------------------------------------
+// The point of the rank as the new points store it.
+void vtkCleanPolyDataMerge::Stored(vtkIdType rank, double x[3])
+{
+  const double *m = this->Mapped + 3*rank;
+  for (int i = 0; i < 3; i++)
+    {
+    x[i] = ( this->StoreFloat ? static_cast<float>(m[i]) : m[i] );
+    }
+}
+
+//--------------------------------------------------------------------------
+// Key the point of the rank on its cell in the tolerance grid or, without
+// a tolerance, on its stored coordinates, zero having a single sign.
+// Points with coordinates that are not finite are not keyed, and are never
+// merged.
+int vtkCleanPolyDataMerge::MakeEntry(vtkIdType rank, vtkCleanPolyDataEntry &e)
+{
+  const double *m = this->Mapped + 3*rank;
+  double x[3];
+  this->Stored(rank, x);
+  for (int i = 0; i < 3; i++)
+    {
+    if ( !(fabs(m[i]) <= VTK_DOUBLE_MAX) )
+      {
+      return 0;
+      }
+    if ( this->CellSize > 0.0 )
+      {
+      e.Cell[i] = static_cast<vtkTypeInt64>(
+        floor((m[i] - this->Origin[i])/this->CellSize));
+      }
+    else
+      {
+      double v = ( x[i] == 0.0 ? 0.0 : x[i] );
+      memcpy(e.Cell + i, &v, sizeof(double));
+      }
+    }
+  e.Key = vtkCleanPolyDataHash(e.Cell);
+  e.Rank = rank;
+  return 1;
+}
+
+//--------------------------------------------------------------------------
+void vtkCleanPolyDataMerge::MapPiece(int piece)
+{
+  vtkIdType first = this->NumberOfPoints*piece/this->NumberOfPieces;
+  vtkIdType last = this->NumberOfPoints*(piece + 1)/this->NumberOfPieces;
+  vtkIdType *counts = &this->Counts[piece*this->NumberOfPieces];
+  vtkCleanPolyDataEntry e;
+  double x[3];
+  for (vtkIdType r = first; r < last; r++)
+    {
+    this->InPoints->GetPoint(this->Order[r], x);
+    this->Self->OperateOnPoint(x, this->Mapped + 3*r);
+    this->Rep[r] = r;
+    if ( this->MakeEntry(r, e) )
+      {
+      counts[e.Key % this->NumberOfPieces]++;
+      }
+    }
+}
+
+//--------------------------------------------------------------------------
+void vtkCleanPolyDataMerge::ScatterPiece(int piece)
+{
+  vtkIdType first = this->NumberOfPoints*piece/this->NumberOfPieces;
+  vtkIdType last = this->NumberOfPoints*(piece + 1)/this->NumberOfPieces;
+  vtkIdType *offsets = &this->Counts[piece*this->NumberOfPieces];
+  vtkCleanPolyDataEntry e;
+  for (vtkIdType r = first; r < last; r++)
+    {
+    if ( this->MakeEntry(r, e) )
+      {
+      this->Entries[offsets[e.Key % this->NumberOfPieces]++] = e;
+      }
+    }
+}
+
+//--------------------------------------------------------------------------
+// Sort the partition of the piece. Without a tolerance, the points with
+// the same coordinates follow the first of them, with which they merge.
+// With a tolerance, the grid cells of the partition are hashed to their
+// first entry.
+void vtkCleanPolyDataMerge::SortPiece(int piece)
+{
+  if ( this->Entries.empty() )
+    {
+    return;
+    }
+  vtkCleanPolyDataEntry *begin = &this->Entries[0] +
+    this->PartitionStart[piece];
+  vtkCleanPolyDataEntry *end = &this->Entries[0] +
+    this->PartitionStart[piece + 1];
+  vtkstd::sort(begin, end);
+  vtkCleanPolyDataEntry *e;
+  if ( this->CellSize > 0.0 )
+    {
+    vtkIdType numCells = 0;
+    for (e = begin; e != end; ++e)
+      {
+      numCells += ( e == begin || !e->SameCell(*(e - 1)) );
+      }
+    vtkIdType size = 1;
+    while ( size < 2*numCells )
+      {
+      size *= 2;
+      }
+    vtkstd::vector<vtkIdType> &table = this->Tables[piece];
+    table.assign(size, -1);
+    for (e = begin; e != end; ++e)
+      {
+      if ( e == begin || !e->SameCell(*(e - 1)) )
+        {
+        vtkIdType slot = static_cast<vtkIdType>(
+          (e->Key / this->NumberOfPieces) & (size - 1));
+        while ( table[slot] >= 0 )
+          {
+          slot = (slot + 1) & (size - 1);
+          }
+        table[slot] = e - &this->Entries[0];
+        }
+      }
+    return;
+    }
+  for (e = begin; e != end; )
+    {
+    vtkCleanPolyDataEntry *same = e + 1;
+    for (; same != end && same->SameCell(*e); ++same)
+      {
+      this->Rep[same->Rank] = e->Rank;
+      }
+    e = same;
+    }
+}
+
+//--------------------------------------------------------------------------
+// The first entry of the grid cell of the probe, or NULL if the cell is
+// empty.
+const vtkCleanPolyDataEntry *vtkCleanPolyDataMerge::FindCell(
+  const vtkCleanPolyDataEntry &probe)
+{
+  vtkstd::vector<vtkIdType> &table =
+    this->Tables[probe.Key % this->NumberOfPieces];
+  if ( table.empty() )
+    {
+    return NULL;
+    }
+  vtkIdType size = static_cast<vtkIdType>(table.size());
+  vtkIdType slot = static_cast<vtkIdType>(
+    (probe.Key / this->NumberOfPieces) & (size - 1));
+  for (; table[slot] >= 0; slot = (slot + 1) & (size - 1))
+    {
+    const vtkCleanPolyDataEntry *e = &this->Entries[table[slot]];
+    if ( e->SameCell(probe) )
+      {
+      return e;
+      }
+    }
+  return NULL;
+}
+
+//--------------------------------------------------------------------------
+// List, for each point of the piece, the points of lower rank within the
+// tolerance in increasing rank, found in its grid cell and the neighboring
+// cells within the reach.
+void vtkCleanPolyDataMerge::CandidatesPiece(int piece)
+{
+  vtkIdType first = this->NumberOfPoints*piece/this->NumberOfPieces;
+  vtkIdType last = this->NumberOfPoints*(piece + 1)/this->NumberOfPieces;
+  vtkstd::vector<vtkIdType> &candidates = this->Candidates[piece];
+  vtkstd::vector<vtkIdType> close;
+  vtkCleanPolyDataEntry e, probe;
+  const vtkCleanPolyDataEntry *end = NULL;
+  if ( !this->Entries.empty() )
+    {
+    end = &this->Entries[0] + this->Entries.size();
+    }
+  double y[3];
+  for (vtkIdType r = first; r < last; r++)
+    {
+    if ( !this->MakeEntry(r, e) )
+      {
+      continue;
+      }
+    const double *x = this->Mapped + 3*r;
+    int lo[3], hi[3];
+    for (int a = 0; a < 3; a++)
+      {
+      double low = this->Origin[a] + e.Cell[a]*this->CellSize;
+      lo[a] = ( x[a] - low <= this->Reach ? -1 : 0 );
+      hi[a] = ( low + this->CellSize - x[a] <= this->Reach ? 1 : 0 );
+      }
+    close.clear();
+    for (int k = lo[2]; k <= hi[2]; k++)
+      {
+      for (int j = lo[1]; j <= hi[1]; j++)
+        {
+        for (int i = lo[0]; i <= hi[0]; i++)
+          {
+          probe.Cell[0] = e.Cell[0] + i;
+          probe.Cell[1] = e.Cell[1] + j;
+          probe.Cell[2] = e.Cell[2] + k;
+          probe.Key = vtkCleanPolyDataHash(probe.Cell);
+          for (const vtkCleanPolyDataEntry *q = this->FindCell(probe);
+               q && q != end && q->SameCell(probe) && q->Rank < r; ++q)
+            {
+            this->Stored(q->Rank, y);
+            if ( vtkMath::Distance2BetweenPoints(x, y) <= this->Tolerance2 )
+              {
+              close.push_back(q->Rank);
+              }
+            }
+          }
+        }
+      }
+    if ( !close.empty() )
+      {
+      vtkstd::sort(close.begin(), close.end());
+      candidates.push_back(r);
+      candidates.push_back(static_cast<vtkIdType>(close.size()));
+      candidates.insert(candidates.end(), close.begin(), close.end());
+      }
+    }
+}
+
+//--------------------------------------------------------------------------
+void vtkCleanPolyDataMerge::PointsPiece(int piece)
+{
+  vtkIdType first = this->NumberOfPoints*piece/this->NumberOfPieces;
+  vtkIdType last = this->NumberOfPoints*(piece + 1)/this->NumberOfPieces;
+  for (vtkIdType r = first; r < last; r++)
+    {
+    vtkIdType rep = this->Rep[r];
+    if ( rep == r )
+      {
+      this->NewPoints->SetPoint(this->NewIds[r], this->Mapped + 3*r);
+      }
+    this->PointMap[this->Order[r]] = this->NewIds[rep];
+    }
+}
+
+//--------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkCleanPolyDataMerge::Execute(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *info =
+    static_cast<vtkMultiThreader::ThreadInfo *>(arg);
+  vtkCleanPolyDataMerge *merge =
+    static_cast<vtkCleanPolyDataMerge *>(info->UserData);
+  for (int piece = info->ThreadID; piece < merge->NumberOfPieces;
+       piece += info->NumberOfThreads)
+    {
+    switch (merge->Pass)
+      {
+      case MAP:
+        merge->MapPiece(piece);
+        break;
+      case SCATTER:
+        merge->ScatterPiece(piece);
+        break;
+      case SORT:
+        merge->SortPiece(piece);
+        break;
+      case CANDIDATES:
+        merge->CandidatesPiece(piece);
+        break;
+      default:
+        merge->PointsPiece(piece);
+      }
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
 //--------------------------------------------------------------------------
 // Method manages creation of locators. It takes into account the potential
 // change of tolerance (zero to non-zero).
@@ -681,6 +1257,9 @@ void vtkCleanPolyData::PrintSelf(ostream& os, vtkIndent indent)
     }
   os << indent << "PieceInvariant: "
      << (this->PieceInvariant ? "On\n" : "Off\n");
+  os << indent << "ParallelMerging: "
+     << (this->ParallelMerging ? "On\n" : "Off\n");
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << "\n";
 }
 
 //--------------------------------------------------------------------------
@@ -43,6 +43,16 @@
 // Note that merging of points can be disabled. In this case, a point locator
 // will not be used, and points that are not used by any cells will be
 // eliminated, but never merged.
+//
+// When ParallelMerging is on, points are merged without a locator, by
+// threads sorting the points used by the cells on a hash of their
+// coordinates (or, with a tolerance, of the cell of a grid of the
+// tolerance size they are in) and comparing the points with equal keys
+// (or in neighboring grid cells). With a zero tolerance the points are
+// merged exactly as vtkMergePoints merges them. Otherwise a point merges
+// with the first point inserted before it within the tolerance, which is
+// the point the locator finds when no two inserted points are within the
+// tolerance of the point.
 
 // .SECTION Caveats
 // Merging points can alter topology, including introducing non-manifold
@@ -60,6 +70,8 @@
 #include "vtkPolyDataAlgorithm.h"
 
 class vtkIncrementalPointLocator;
+class vtkPointData;
+class vtkPoints;
 
 class VTK_GRAPHICS_EXPORT vtkCleanPolyData : public vtkPolyDataAlgorithm
 {
@@ -149,6 +161,21 @@ public:
   vtkGetMacro(PieceInvariant, int);
   vtkBooleanMacro(PieceInvariant, int);
 
+  // Description:
+  // Turn on/off merging the points with threads instead of with the
+  // locator. OperateOnPoint() is then called once per point, from several
+  // threads. Only points stored as float or double are merged this way.
+  // Default is Off.
+  vtkSetMacro(ParallelMerging,int);
+  vtkGetMacro(ParallelMerging,int);
+  vtkBooleanMacro(ParallelMerging,int);
+
+  // Description:
+  // Set/get the number of threads merging the points when ParallelMerging
+  // is on. Defaults to vtkMultiThreader::GetGlobalDefaultNumberOfThreads().
+  vtkSetClampMacro(NumberOfThreads, int, 1, VTK_LARGE_INTEGER);
+  vtkGetMacro(NumberOfThreads, int);
+
 protected:
   vtkCleanPolyData();
  ~vtkCleanPolyData();
@@ -168,6 +195,19 @@ protected:
   vtkIncrementalPointLocator *Locator;
 
   int PieceInvariant;
+  int ParallelMerging;
+  int NumberOfThreads;
+
+  // Merge the points used by the cells of the input with threads, in the
+  // order the cells use them, filling the new points, their point data and
+  // the map from the input points. Returns the number of new points.
+  vtkIdType MergePointsInPieces(vtkPolyData *input, double tol,
+                                vtkPoints *newPts, vtkIdType *pointMap,
+                                vtkPointData *outputPD);
+
+  //BTX
+  friend class vtkCleanPolyDataMerge;
+  //ETX
 private:
   vtkCleanPolyData(const vtkCleanPolyData&);  // Not implemented.
   void operator=(const vtkCleanPolyData&);  // Not implemented.
@@ -32,7 +32,7 @@
 #include "vtkPolyData.h"
 #include "vtkRectilinearGrid.h"
 #include "vtkRectilinearSynchronizedTemplates.h"
-#include "vtkSimpleScalarTree.h"
+#include "vtkSpanSpace.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkStructuredGrid.h"
 #include "vtkSynchronizedTemplates2D.h"
@@ -377,6 +377,16 @@ int vtkContourFilter::RequestData(
       {
       cgrid->SetLocator( this->Locator );
       }
+    if ( this->UseScalarTree )
+      {
+      // keep the tree, so that it is built once for all contour values
+      if ( this->ScalarTree == NULL )
+        {
+        this->ScalarTree = vtkSpanSpace::New();
+        }
+      cgrid->SetScalarTree( this->ScalarTree );
+      cgrid->UseScalarTreeOn();
+      }
       
     for (i = 0; i < numContours; i++)
       {
@@ -510,9 +520,10 @@ int vtkContourFilter::RequestData(
       vtkCell *cell;
       if ( this->ScalarTree == NULL )
         {
-        this->ScalarTree = vtkSimpleScalarTree::New();
+        this->ScalarTree = vtkSpanSpace::New();
         }
       this->ScalarTree->SetDataSet(input);
+      this->ScalarTree->SetScalars(inScalars);
       // Note: This will have problems when input contains 2D and 3D cells.
       // CellData will get scrabled because of the implicit ordering of
       // verts, lines and polys in vtkPolyData.  The solution
@@ -30,7 +30,8 @@
 // vtkScalarTree. A scalar tree is used to quickly locate cells that
 // contain a contour surface. This is especially effective if multiple
 // contours are being extracted. If you want to use a scalar tree,
-// invoke the method UseScalarTreeOn().
+// invoke the method UseScalarTreeOn(). The tree is kept, also for
+// unstructured grids, so it is only built again when the input changes.
 
 // .SECTION Caveats
 // For unstructured data or structured grids, normals and gradients
@@ -114,7 +115,8 @@ public:
   vtkBooleanMacro(UseScalarTree,int);
 
   // Description:
-  // Enable the use of a scalar tree to accelerate contour extraction.
+  // Specify the instance of vtkScalarTree to use. If not specified
+  // and UseScalarTree is enabled, then a vtkSpanSpace is used.
   virtual void SetScalarTree(vtkScalarTree*);
   vtkGetObjectMacro(ScalarTree,vtkScalarTree);
 
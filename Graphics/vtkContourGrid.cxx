@@ -19,12 +19,13 @@
 #include "vtkCellData.h"
 #include "vtkContourValues.h"
 #include "vtkFloatArray.h"
+#include "vtkGarbageCollector.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
-#include "vtkSimpleScalarTree.h"
+#include "vtkSpanSpace.h"
 #include "vtkUnstructuredGrid.h"
 #include "vtkCutter.h"
 #include "vtkMergePoints.h"
@@ -34,6 +35,7 @@
 #include <math.h>
 
 vtkStandardNewMacro(vtkContourGrid);
+vtkCxxSetObjectMacro(vtkContourGrid,ScalarTree,vtkScalarTree);
 
 // Construct object with initial range (0,1) and single contour value
 // of 0.0.
@@ -268,23 +270,65 @@ void vtkContourGridExecute(vtkContourGrid *self, vtkDataSet *input,
     //
     if ( scalarTree == NULL )
       {
-      scalarTree = vtkSimpleScalarTree::New();
+      scalarTree = vtkSpanSpace::New();
       }
+    // The tree is only rebuilt when the input or the scalars change.
     scalarTree->SetDataSet(input);
+    scalarTree->SetScalars(inScalars);
     //
     // Loop over all contour values.  Then for each contour value, 
-    // loop over all cells.
+    // loop over the cells the tree finds, in batches if it has them.
     //
-    for (i=0; i < numContours; i++)
+    vtkIdType batch, numBatches, numBatchCells, j;
+    const vtkIdType *batchCells;
+    for (i=0; i < numContours && !abortExecute; i++)
       {
-      for ( scalarTree->InitTraversal(values[i]); 
-          (cell=scalarTree->GetNextCell(cellId,cellPts,cellScalars)) != NULL; )
+      self->UpdateProgress (static_cast<double>(i)/numContours);
+      abortExecute = self->GetAbortExecute();
+      scalarTree->InitTraversal(values[i]);
+      numBatches = scalarTree->GetNumberOfCellBatches();
+      if ( numBatches == 0 )
         {
-        cell->Contour(values[i], cellScalars, locator,
-                      newVerts, newLines, newPolys, inPd, outPd,
-                      inCd, cellId, outCd);
-           //don't want to call Contour any more than necessary
-        } //for all cells
+        while ( (cell=scalarTree->GetNextCell(cellId,cellPts,cellScalars))
+                != NULL )
+          {
+          cell->Contour(values[i], cellScalars, locator,
+                        newVerts, newLines, newPolys, inPd, outPd,
+                        inCd, cellId, outCd);
+          } //for all cells
+        continue;
+        }
+      for (batch=0; batch < numBatches; batch++)
+        {
+        batchCells = scalarTree->GetCellBatch(batch, numBatchCells);
+        for (j=0; j < numBatchCells; j++)
+          {
+          // the batches may hold cells that the value does not cross
+          cellId = batchCells[j];
+          grid->GetCellPoints(cellId, numPoints, cellArrayPtr);
+          range[0] = range[1] = scalarArrayPtr[cellArrayPtr[0]];
+          for (vtkIdType k = 1; k < numPoints; k++)
+            {
+            tempScalar = scalarArrayPtr[cellArrayPtr[k]];
+            if (tempScalar < range[0])
+              {
+              range[0] = tempScalar;
+              }
+            if (tempScalar > range[1])
+              {
+              range[1] = tempScalar;
+              }
+            }
+          if ((values[i] >= range[0]) && (values[i] <= range[1]))
+            {
+            cell = input->GetCell(cellId);
+            inScalars->GetTuples(cell->GetPointIds(),cellScalars);
+            cell->Contour(values[i], cellScalars, locator,
+                          newVerts, newLines, newPolys, inPd, outPd,
+                          inCd, cellId, outCd);
+            }
+          } //for all cells of the batch
+        } //for all batches
       } //for all contour values
     } //using scalar tree
 
@@ -426,6 +470,14 @@ void vtkContourGrid::PrintSelf(ostream& os, vtkIndent indent)
      << (this->ComputeScalars ? "On\n" : "Off\n");
   os << indent << "Use Scalar Tree: " 
      << (this->UseScalarTree ? "On\n" : "Off\n");
+  if ( this->ScalarTree )
+    {
+    os << indent << "Scalar Tree: " << this->ScalarTree << "\n";
+    }
+  else
+    {
+    os << indent << "Scalar Tree: (none)\n";
+    }
 
   this->ContourValues->PrintSelf(os,indent.GetNextIndent());
 
@@ -438,3 +490,12 @@ void vtkContourGrid::PrintSelf(ostream& os, vtkIndent indent)
     os << indent << "Locator: (none)\n";
     }
 }
+
+//----------------------------------------------------------------------------
+void vtkContourGrid::ReportReferences(vtkGarbageCollector* collector)
+{
+  this->Superclass::ReportReferences(collector);
+  // The scalar tree shares our input and is therefore involved in a
+  // reference loop.
+  vtkGarbageCollectorReport(collector, this->ScalarTree, "ScalarTree");
+}
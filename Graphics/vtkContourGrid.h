@@ -30,7 +30,10 @@
 // vtkScalarTree. A scalar tree is used to quickly locate cells that
 // contain a contour surface. This is especially effective if multiple
 // contours are being extracted. If you want to use a scalar tree,
-// invoke the method UseScalarTreeOn().
+// invoke the method UseScalarTreeOn(). By default the scalar tree is a
+// vtkSpanSpace, which is built once and kept as long as the input does
+// not change, so that changing the contour values only visits the cells
+// the new values cross.
 //
 
 // .SECTION Caveats
@@ -112,6 +115,12 @@ public:
   vtkGetMacro(UseScalarTree,int);
   vtkBooleanMacro(UseScalarTree,int);
 
+  // Description:
+  // Specify the instance of vtkScalarTree to use. If not specified
+  // and UseScalarTree is enabled, then a vtkSpanSpace is used.
+  virtual void SetScalarTree(vtkScalarTree*);
+  vtkGetObjectMacro(ScalarTree,vtkScalarTree);
+
   // Description:
   // Set / get a spatial locator for merging points. By default, 
   // an instance of vtkMergePoints is used.
@@ -129,6 +138,7 @@ protected:
 
   virtual int RequestData(vtkInformation *, vtkInformationVector **, vtkInformationVector *);
   virtual int FillInputPortInformation(int port, vtkInformation *info);
+  virtual void ReportReferences(vtkGarbageCollector*);
 
   vtkContourValues *ContourValues;
   int ComputeNormals;
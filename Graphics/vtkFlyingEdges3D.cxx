@@ -0,0 +1,787 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkFlyingEdges3D.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkFlyingEdges3D.h"
+
+#include "vtkCellArray.h"
+#include "vtkFloatArray.h"
+#include "vtkImageData.h"
+#include "vtkInformation.h"
+#include "vtkInformationVector.h"
+#include "vtkMarchingCubesCases.h"
+#include "vtkMath.h"
+#include "vtkMultiThreader.h"
+#include "vtkObjectFactory.h"
+#include "vtkPointData.h"
+#include "vtkPolyData.h"
+
+vtkStandardNewMacro(vtkFlyingEdges3D);
+
+#define VTK_FLYING_EDGES_PIECES_PER_THREAD 4
+
+// The vertices of a voxel and its edges, numbered as in the marching cubes
+// case table.
+static const int vtkFlyingEdges3DVertices[8][3] = {
+  {0,0,0}, {1,0,0}, {1,1,0}, {0,1,0}, {0,0,1}, {1,0,1}, {1,1,1}, {0,1,1}};
+static const int vtkFlyingEdges3DEdges[12][2] = {
+  {0,1}, {1,2}, {3,2}, {0,3}, {4,5}, {5,6}, {7,6}, {4,7},
+  {0,4}, {1,5}, {3,7}, {2,6}};
+
+//----------------------------------------------------------------------------
+// The rows of points along x are numbered j + k*ny. Each row has the cases
+// of its x edges, 0 to 3 for the classification of their two points, and
+// six numbers: the number of points on its x edges, on the y edges and z
+// edges from its points and of triangles in the row of voxels from it,
+// which the prefix sum turns into the ids of the first ones, and the range
+// of x edges the contour crosses.
+template <class T>
+class vtkFlyingEdges3DAlgorithm
+{
+public:
+  enum { X_POINTS, Y_POINTS, Z_POINTS, TRIANGLES, X_MIN, X_MAX, ROW_SIZE };
+  enum { CLASSIFY, RECLASSIFY, COUNT, GENERATE };
+
+  T *Data; // the contoured component of the first point
+  int Dims[3];
+  vtkIdType Inc[3];
+  double Origin[3]; // of the first point
+  double *Spacing;
+  double Value;
+  int ComputeNormals;
+  int ComputeGradients;
+  int ComputeScalars;
+  int Pass;
+  int NumberOfPieces;
+
+  unsigned char *XCases;
+  vtkIdType *Rows;
+  unsigned short EdgeMasks[256]; // the edges each voxel case crosses
+  unsigned char TriangleCounts[256];
+  vtkMarchingCubesTriangleCases *Cases;
+
+  float *Points;
+  float *Scalars;
+  float *Normals;
+  float *Gradients;
+  vtkIdType *Polys;
+
+  vtkFlyingEdges3DAlgorithm();
+
+  unsigned char *RowCases(int j, int k)
+    {
+    return this->XCases +
+      (j + static_cast<vtkIdType>(k)*this->Dims[1])*(this->Dims[0] - 1);
+    }
+  vtkIdType *Row(int j, int k)
+    {
+    return this->Rows +
+      (j + static_cast<vtkIdType>(k)*this->Dims[1])*ROW_SIZE;
+    }
+  int VoxelCase(unsigned char *cases[4], int i)
+    {
+    unsigned char e0 = cases[0][i], e1 = cases[1][i];
+    unsigned char e2 = cases[2][i], e3 = cases[3][i];
+    return (e0 & 3) | ((e1 & 2) << 1) | ((e1 & 1) << 3) | ((e2 & 3) << 4) |
+      ((e3 & 2) << 5) | ((e3 & 1) << 7);
+    }
+
+  void Execute(int piece);
+  void ClassifyRow(int j, int k);
+  int ComputeTrim(int j, int k, unsigned char *cases[4], int &xL, int &xR);
+  void CountRow(int j, int k);
+  void GenerateRow(int j, int k);
+  void GeneratePoint(int edge, vtkIdType ptId, int i, int j, int k);
+  void ComputeGradient(int i, int j, int k, T *s, double g[3]);
+};
+
+//----------------------------------------------------------------------------
+template <class T>
+vtkFlyingEdges3DAlgorithm<T>::vtkFlyingEdges3DAlgorithm()
+{
+  this->Cases = vtkMarchingCubesTriangleCases::GetCases();
+  for (int index = 0; index < 256; index++)
+    {
+    unsigned short mask = 0;
+    for (int e = 0; e < 12; e++)
+      {
+      if (((index >> vtkFlyingEdges3DEdges[e][0]) ^
+           (index >> vtkFlyingEdges3DEdges[e][1])) & 1)
+        {
+        mask |= static_cast<unsigned short>(1 << e);
+        }
+      }
+    this->EdgeMasks[index] = mask;
+    int numTris = 0;
+    for (EDGE_LIST *edge = this->Cases[index].edges; *edge > -1; edge += 3)
+      {
+      numTris++;
+      }
+    this->TriangleCounts[index] = static_cast<unsigned char>(numTris);
+    }
+}
+
+//----------------------------------------------------------------------------
+// A piece is a range of slices of rows, the slices of points to classify
+// and the slices of voxels to count and generate.
+template <class T>
+void vtkFlyingEdges3DAlgorithm<T>::Execute(int piece)
+{
+  int numSlices = this->Dims[2] - (this->Pass >= COUNT ? 1 : 0);
+  int kBegin = static_cast<int>(
+    static_cast<vtkIdType>(numSlices)*piece/this->NumberOfPieces);
+  int kEnd = static_cast<int>(
+    static_cast<vtkIdType>(numSlices)*(piece + 1)/this->NumberOfPieces);
+  int numRows = this->Dims[1] - (this->Pass >= COUNT ? 1 : 0);
+  for (int k = kBegin; k < kEnd; k++)
+    {
+    for (int j = 0; j < numRows; j++)
+      {
+      if (this->Pass == COUNT)
+        {
+        this->CountRow(j, k);
+        }
+      else if (this->Pass == GENERATE)
+        {
+        this->GenerateRow(j, k);
+        }
+      else
+        {
+        this->ClassifyRow(j, k);
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Pass 1: classify the x edges of a row of points. Reclassifying for a
+// later contour leaves the numbers of the row alone.
+template <class T>
+void vtkFlyingEdges3DAlgorithm<T>::ClassifyRow(int j, int k)
+{
+  int nx = this->Dims[0];
+  double value = this->Value;
+  T *s = this->Data + j*this->Inc[1] + k*this->Inc[2];
+  unsigned char *cases = this->RowCases(j, k);
+  unsigned char v0 = (*s >= value ? 1 : 0), v1;
+  vtkIdType numPts = 0;
+  int xL = nx - 1, xR = 0;
+  for (int i = 0; i < nx - 1; i++)
+    {
+    s += this->Inc[0];
+    v1 = (*s >= value ? 1 : 0);
+    cases[i] = static_cast<unsigned char>(v0 | (v1 << 1));
+    if (v0 != v1)
+      {
+      if (!numPts)
+        {
+        xL = i;
+        }
+      xR = i + 1;
+      numPts++;
+      }
+    v0 = v1;
+    }
+  if (this->Pass == CLASSIFY)
+    {
+    vtkIdType *row = this->Row(j, k);
+    row[X_POINTS] = numPts;
+    row[Y_POINTS] = row[Z_POINTS] = row[TRIANGLES] = 0;
+    row[X_MIN] = xL;
+    row[X_MAX] = xR;
+    }
+}
+
+//----------------------------------------------------------------------------
+// The range of voxels from row (j,k) the contour may pass through. Outside
+// the x edges the four rows of the voxels cross, each row is all above or
+// all below the value, so the contour only passes through the voxels there
+// if the rows differ. Returns 0 if it passes through none.
+template <class T>
+int vtkFlyingEdges3DAlgorithm<T>::ComputeTrim(int j, int k,
+                                              unsigned char *cases[4],
+                                              int &xL, int &xR)
+{
+  vtkIdType *rows[4] = {this->Row(j, k), this->Row(j+1, k),
+                        this->Row(j, k+1), this->Row(j+1, k+1)};
+  cases[0] = this->RowCases(j, k);
+  cases[1] = this->RowCases(j+1, k);
+  cases[2] = this->RowCases(j, k+1);
+  cases[3] = this->RowCases(j+1, k+1);
+  xL = static_cast<int>(rows[0][X_MIN]);
+  xR = static_cast<int>(rows[0][X_MAX]);
+  int m;
+  for (m = 1; m < 4; m++)
+    {
+    if (rows[m][X_MIN] < xL)
+      {
+      xL = static_cast<int>(rows[m][X_MIN]);
+      }
+    if (rows[m][X_MAX] > xR)
+      {
+      xR = static_cast<int>(rows[m][X_MAX]);
+      }
+    }
+  int nx = this->Dims[0];
+  if (xL >= xR)
+    {
+    for (m = 1; m < 4; m++)
+      {
+      if ((cases[m][0] & 1) != (cases[0][0] & 1))
+        {
+        xL = 0;
+        xR = nx - 1;
+        return 1;
+        }
+      }
+    return 0;
+    }
+  for (m = 1; m < 4 && xL > 0; m++)
+    {
+    if ((cases[m][xL] & 1) != (cases[0][xL] & 1))
+      {
+      xL = 0;
+      }
+    }
+  for (m = 1; m < 4 && xR < nx - 1; m++)
+    {
+    if ((cases[m][xR-1] & 2) != (cases[0][xR-1] & 2))
+      {
+      xR = nx - 1;
+      }
+    }
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+// Pass 2: count the points on the y and z edges and the triangles of the
+// row of voxels from row (j,k). The voxels own the edges from their first
+// point, the last voxel of the row the edges from its last points too, and
+// the last rows of voxels in y and z the edges of the last rows of points.
+template <class T>
+void vtkFlyingEdges3DAlgorithm<T>::CountRow(int j, int k)
+{
+  unsigned char *cases[4];
+  int xL, xR;
+  if (!this->ComputeTrim(j, k, cases, xL, xR))
+    {
+    return;
+    }
+  int lastVoxel = this->Dims[0] - 2;
+  vtkIdType numY = 0, numZ = 0, numY2 = 0, numZ2 = 0, numTris = 0;
+  for (int i = xL; i < xR; i++)
+    {
+    int index = this->VoxelCase(cases, i);
+    if (index == 0 || index == 255)
+      {
+      continue;
+      }
+    int mask = this->EdgeMasks[index];
+    numY += (mask >> 3) & 1;
+    numZ += (mask >> 8) & 1;
+    numY2 += (mask >> 7) & 1;
+    numZ2 += (mask >> 10) & 1;
+    if (i == lastVoxel)
+      {
+      numY += (mask >> 1) & 1;
+      numZ += (mask >> 9) & 1;
+      numY2 += (mask >> 5) & 1;
+      numZ2 += (mask >> 11) & 1;
+      }
+    numTris += this->TriangleCounts[index];
+    }
+  vtkIdType *row = this->Row(j, k);
+  row[Y_POINTS] = numY;
+  row[Z_POINTS] = numZ;
+  row[TRIANGLES] = numTris;
+  if (k == this->Dims[2] - 2)
+    {
+    this->Row(j, k+1)[Y_POINTS] = numY2;
+    }
+  if (j == this->Dims[1] - 2)
+    {
+    this->Row(j+1, k)[Z_POINTS] = numZ2;
+    }
+}
+
+//----------------------------------------------------------------------------
+// Pass 4: generate the points the row of voxels owns and its triangles.
+// The ids of the points on the edges of each row increase along x from the
+// first id of the row, since the rows do not cross the contour before xL.
+template <class T>
+void vtkFlyingEdges3DAlgorithm<T>::GenerateRow(int j, int k)
+{
+  unsigned char *cases[4];
+  int xL, xR;
+  if (!this->ComputeTrim(j, k, cases, xL, xR))
+    {
+    return;
+    }
+  vtkIdType *row0 = this->Row(j, k), *row1 = this->Row(j+1, k);
+  vtkIdType *row2 = this->Row(j, k+1), *row3 = this->Row(j+1, k+1);
+  vtkIdType x0 = row0[X_POINTS], x1 = row1[X_POINTS];
+  vtkIdType x2 = row2[X_POINTS], x3 = row3[X_POINTS];
+  vtkIdType y0 = row0[Y_POINTS], y1 = row2[Y_POINTS];
+  vtkIdType z0 = row0[Z_POINTS], z1 = row1[Z_POINTS];
+  vtkIdType *polys = this->Polys + 4*row0[TRIANGLES];
+  int lastVoxel = this->Dims[0] - 2;
+  int lastY = (j == this->Dims[1] - 2), lastZ = (k == this->Dims[2] - 2);
+  vtkIdType ids[12];
+  for (int i = xL; i < xR; i++)
+    {
+    int index = this->VoxelCase(cases, i);
+    if (index == 0 || index == 255)
+      {
+      continue;
+      }
+    int mask = this->EdgeMasks[index];
+    ids[0] = x0;
+    ids[2] = x1;
+    ids[4] = x2;
+    ids[6] = x3;
+    ids[3] = y0;
+    ids[1] = y0 + ((mask >> 3) & 1);
+    ids[7] = y1;
+    ids[5] = y1 + ((mask >> 7) & 1);
+    ids[8] = z0;
+    ids[9] = z0 + ((mask >> 8) & 1);
+    ids[10] = z1;
+    ids[11] = z1 + ((mask >> 10) & 1);
+
+    int owned = 0x109; // edges 0, 3 and 8
+    if (i == lastVoxel)
+      {
+      owned |= 0x202; // edges 1 and 9
+      }
+    if (lastY)
+      {
+      owned |= (i == lastVoxel ? 0xc04 : 0x404); // edges 2, 10 (and 11)
+      }
+    if (lastZ)
+      {
+      owned |= (i == lastVoxel ? 0xb0 : 0x90); // edges 4, 7 (and 5)
+      }
+    if (lastY && lastZ)
+      {
+      owned |= 0x40; // edge 6
+      }
+    int generate = mask & owned;
+    for (int e = 0; generate; e++, generate >>= 1)
+      {
+      if (generate & 1)
+        {
+        this->GeneratePoint(e, ids[e], i, j, k);
+        }
+      }
+
+    for (EDGE_LIST *edge = this->Cases[index].edges; *edge > -1; edge += 3)
+      {
+      *polys++ = 3;
+      *polys++ = ids[edge[0]];
+      *polys++ = ids[edge[1]];
+      *polys++ = ids[edge[2]];
+      }
+
+    x0 += mask & 1;
+    x1 += (mask >> 2) & 1;
+    x2 += (mask >> 4) & 1;
+    x3 += (mask >> 6) & 1;
+    y0 += (mask >> 3) & 1;
+    y1 += (mask >> 7) & 1;
+    z0 += (mask >> 8) & 1;
+    z1 += (mask >> 10) & 1;
+    }
+}
+
+//----------------------------------------------------------------------------
+// Calculate the gradient using central difference.
+template <class T>
+void vtkFlyingEdges3DAlgorithm<T>::ComputeGradient(int i, int j, int k, T *s,
+                                                   double g[3])
+{
+  int ijk[3] = {i, j, k};
+  for (int axis = 0; axis < 3; axis++)
+    {
+    vtkIdType inc = this->Inc[axis];
+    if (ijk[axis] == 0)
+      {
+      g[axis] = (static_cast<double>(*(s + inc)) - *s) / this->Spacing[axis];
+      }
+    else if (ijk[axis] == this->Dims[axis] - 1)
+      {
+      g[axis] = (static_cast<double>(*s) - *(s - inc)) / this->Spacing[axis];
+      }
+    else
+      {
+      g[axis] = 0.5 * (static_cast<double>(*(s + inc)) - *(s - inc)) /
+        this->Spacing[axis];
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+void vtkFlyingEdges3DAlgorithm<T>::GeneratePoint(int edge, vtkIdType ptId,
+                                                 int i, int j, int k)
+{
+  const int *v0 = vtkFlyingEdges3DVertices[vtkFlyingEdges3DEdges[edge][0]];
+  const int *v1 = vtkFlyingEdges3DVertices[vtkFlyingEdges3DEdges[edge][1]];
+  int i0 = i + v0[0], j0 = j + v0[1], k0 = k + v0[2];
+  int i1 = i + v1[0], j1 = j + v1[1], k1 = k + v1[2];
+  T *s0 = this->Data + i0*this->Inc[0] + j0*this->Inc[1] + k0*this->Inc[2];
+  T *s1 = this->Data + i1*this->Inc[0] + j1*this->Inc[1] + k1*this->Inc[2];
+  double t = (this->Value - static_cast<double>(*s0)) /
+    (static_cast<double>(*s1) - static_cast<double>(*s0));
+
+  float *x = this->Points + 3*ptId;
+  x[0] = static_cast<float>(this->Origin[0] + this->Spacing[0]*(i0 + t*(i1 - i0)));
+  x[1] = static_cast<float>(this->Origin[1] + this->Spacing[1]*(j0 + t*(j1 - j0)));
+  x[2] = static_cast<float>(this->Origin[2] + this->Spacing[2]*(k0 + t*(k1 - k0)));
+
+  if (this->ComputeNormals || this->ComputeGradients)
+    {
+    double n0[3], n1[3], n[3];
+    this->ComputeGradient(i0, j0, k0, s0, n0);
+    this->ComputeGradient(i1, j1, k1, s1, n1);
+    for (int jj = 0; jj < 3; jj++)
+      {
+      n[jj] = n0[jj] + t * (n1[jj] - n0[jj]);
+      }
+    if (this->ComputeGradients)
+      {
+      float *g = this->Gradients + 3*ptId;
+      g[0] = static_cast<float>(n[0]);
+      g[1] = static_cast<float>(n[1]);
+      g[2] = static_cast<float>(n[2]);
+      }
+    if (this->ComputeNormals)
+      {
+      vtkMath::Normalize(n);
+      float *nn = this->Normals + 3*ptId;
+      nn[0] = static_cast<float>(-n[0]);
+      nn[1] = static_cast<float>(-n[1]);
+      nn[2] = static_cast<float>(-n[2]);
+      }
+    }
+  if (this->ComputeScalars)
+    {
+    this->Scalars[ptId] = static_cast<float>(this->Value);
+    }
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+static VTK_THREAD_RETURN_TYPE vtkFlyingEdges3DExecute(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *info =
+    static_cast<vtkMultiThreader::ThreadInfo *>(arg);
+  vtkFlyingEdges3DAlgorithm<T> *algo =
+    static_cast<vtkFlyingEdges3DAlgorithm<T> *>(info->UserData);
+  for (int piece = info->ThreadID; piece < algo->NumberOfPieces;
+       piece += info->NumberOfThreads)
+    {
+    algo->Execute(piece);
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+static void vtkFlyingEdges3DRunPass(vtkFlyingEdges3DAlgorithm<T> *algo,
+                                    vtkMultiThreader *threader, int pass)
+{
+  algo->Pass = pass;
+  if (threader)
+    {
+    threader->SingleMethodExecute();
+    return;
+    }
+  for (int piece = 0; piece < algo->NumberOfPieces; piece++)
+    {
+    algo->Execute(piece);
+    }
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+void vtkFlyingEdges3DContour(vtkFlyingEdges3D *self, vtkImageData *input,
+                             vtkDataArray *inScalars, T *ptr,
+                             vtkPolyData *output, vtkFloatArray *newScalars,
+                             vtkFloatArray *newNormals,
+                             vtkFloatArray *newGradients)
+{
+  typedef vtkFlyingEdges3DAlgorithm<T> Algorithm;
+  int numContours = self->GetNumberOfContours();
+  double *values = self->GetValues();
+  int *ext = input->GetExtent();
+  double *origin = input->GetOrigin();
+  int c, axis;
+
+  Algorithm algo;
+  algo.Data = ptr + self->GetArrayComponent();
+  algo.Spacing = input->GetSpacing();
+  for (axis = 0; axis < 3; axis++)
+    {
+    algo.Dims[axis] = ext[2*axis+1] - ext[2*axis] + 1;
+    algo.Origin[axis] = origin[axis] + algo.Spacing[axis]*ext[2*axis];
+    }
+  algo.Inc[0] = inScalars->GetNumberOfComponents();
+  algo.Inc[1] = algo.Inc[0]*algo.Dims[0];
+  algo.Inc[2] = algo.Inc[1]*algo.Dims[1];
+  algo.ComputeNormals = newNormals != NULL;
+  algo.ComputeGradients = newGradients != NULL;
+  algo.ComputeScalars = newScalars != NULL;
+
+  int numThreads = self->GetNumberOfThreads();
+  algo.NumberOfPieces = numThreads*VTK_FLYING_EDGES_PIECES_PER_THREAD;
+  if (algo.NumberOfPieces > algo.Dims[2] - 1)
+    {
+    algo.NumberOfPieces = algo.Dims[2] - 1;
+    }
+  vtkMultiThreader *threader = NULL;
+  if (numThreads > 1 && algo.NumberOfPieces > 1)
+    {
+    threader = vtkMultiThreader::New();
+    threader->UseThreadPoolOn();
+    threader->SetNumberOfThreads(numThreads);
+    threader->SetNumberOfPieces(algo.NumberOfPieces);
+    threader->SetSingleMethod(vtkFlyingEdges3DExecute<T>, &algo);
+    }
+
+  // Classify and count each contour, keeping the numbers of its rows.
+  vtkIdType numRows = static_cast<vtkIdType>(algo.Dims[1])*algo.Dims[2];
+  algo.XCases = new unsigned char[numRows*(algo.Dims[0] - 1)];
+  vtkIdType *rows = new vtkIdType[numContours*numRows*Algorithm::ROW_SIZE];
+  for (c = 0; c < numContours; c++)
+    {
+    algo.Value = values[c];
+    algo.Rows = rows + c*numRows*Algorithm::ROW_SIZE;
+    vtkFlyingEdges3DRunPass(&algo, threader, Algorithm::CLASSIFY);
+    vtkFlyingEdges3DRunPass(&algo, threader, Algorithm::COUNT);
+    self->UpdateProgress(0.5*(c + 1)/numContours);
+    }
+
+  // Pass 3: number the points and triangles, contour by contour, row by
+  // row, and allocate the output.
+  vtkIdType numPts = 0, numTris = 0, count, *row = rows;
+  for (vtkIdType r = 0; r < numContours*numRows; r++)
+    {
+    for (int type = Algorithm::X_POINTS; type <= Algorithm::Z_POINTS; type++)
+      {
+      count = row[type];
+      row[type] = numPts;
+      numPts += count;
+      }
+    count = row[Algorithm::TRIANGLES];
+    row[Algorithm::TRIANGLES] = numTris;
+    numTris += count;
+    row += Algorithm::ROW_SIZE;
+    }
+  vtkPoints *newPts = vtkPoints::New();
+  newPts->SetNumberOfPoints(numPts);
+  algo.Points = static_cast<vtkFloatArray *>(newPts->GetData())->GetPointer(0);
+  algo.Scalars = algo.Normals = algo.Gradients = NULL;
+  if (newScalars)
+    {
+    newScalars->SetNumberOfTuples(numPts);
+    algo.Scalars = newScalars->GetPointer(0);
+    }
+  if (newNormals)
+    {
+    newNormals->SetNumberOfTuples(numPts);
+    algo.Normals = newNormals->GetPointer(0);
+    }
+  if (newGradients)
+    {
+    newGradients->SetNumberOfTuples(numPts);
+    algo.Gradients = newGradients->GetPointer(0);
+    }
+  vtkCellArray *newPolys = vtkCellArray::New();
+  algo.Polys = newPolys->WritePointer(numTris, 4*numTris);
+
+  // The edge cases of the last contour are still there.
+  for (c = numContours - 1; c >= 0; c--)
+    {
+    algo.Value = values[c];
+    algo.Rows = rows + c*numRows*Algorithm::ROW_SIZE;
+    if (c < numContours - 1)
+      {
+      vtkFlyingEdges3DRunPass(&algo, threader, Algorithm::RECLASSIFY);
+      }
+    vtkFlyingEdges3DRunPass(&algo, threader, Algorithm::GENERATE);
+    self->UpdateProgress(0.5 + 0.5*(numContours - c)/numContours);
+    }
+
+  if (threader)
+    {
+    threader->Delete();
+    }
+  delete [] algo.XCases;
+  delete [] rows;
+
+  output->SetPoints(newPts);
+  newPts->Delete();
+  output->SetPolys(newPolys);
+  newPolys->Delete();
+}
+
+//----------------------------------------------------------------------------
+// Construct object with a single contour value of 0.0. ComputeNormals and
+// ComputeScalars are on, ComputeGradients is off.
+vtkFlyingEdges3D::vtkFlyingEdges3D()
+{
+  this->ContourValues = vtkContourValues::New();
+  this->ComputeNormals = 1;
+  this->ComputeGradients = 0;
+  this->ComputeScalars = 1;
+  this->ArrayComponent = 0;
+  this->NumberOfThreads = 1;
+
+  // by default process active point scalars
+  this->SetInputArrayToProcess(0,0,0,vtkDataObject::FIELD_ASSOCIATION_POINTS,
+                               vtkDataSetAttributes::SCALARS);
+}
+
+//----------------------------------------------------------------------------
+vtkFlyingEdges3D::~vtkFlyingEdges3D()
+{
+  this->ContourValues->Delete();
+}
+
+//----------------------------------------------------------------------------
+// Overload standard modified time function. If contour values are modified,
+// then this object is modified as well.
+unsigned long vtkFlyingEdges3D::GetMTime()
+{
+  unsigned long mTime=this->Superclass::GetMTime();
+  unsigned long mTime2=this->ContourValues->GetMTime();
+
+  mTime = ( mTime2 > mTime ? mTime2 : mTime );
+  return mTime;
+}
+
+//----------------------------------------------------------------------------
+int vtkFlyingEdges3D::RequestData(
+  vtkInformation *vtkNotUsed(request),
+  vtkInformationVector **inputVector,
+  vtkInformationVector *outputVector)
+{
+  vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
+  vtkInformation *outInfo = outputVector->GetInformationObject(0);
+
+  vtkImageData *input = vtkImageData::SafeDownCast(
+    inInfo->Get(vtkDataObject::DATA_OBJECT()));
+  vtkPolyData *output = vtkPolyData::SafeDownCast(
+    outInfo->Get(vtkDataObject::DATA_OBJECT()));
+
+  vtkDebugMacro(<< "Executing flying edges");
+
+  vtkDataArray *inScalars = this->GetInputArrayToProcess(0,inputVector);
+  if ( inScalars == NULL )
+    {
+    vtkErrorMacro(<<"Scalars must be defined for contouring");
+    return 1;
+    }
+  if ( input->GetDataDimension() != 3 )
+    {
+    vtkErrorMacro(<<"Cannot contour data of dimension != 3");
+    return 1;
+    }
+  int numComps = inScalars->GetNumberOfComponents();
+  if (this->ArrayComponent >= numComps)
+    {
+    vtkErrorMacro("Scalars have " << numComps << " components. "
+                  "ArrayComponent must be smaller than " << numComps);
+    return 1;
+    }
+  if (this->GetNumberOfContours() < 1)
+    {
+    return 1;
+    }
+
+  vtkFloatArray *newScalars = NULL;
+  vtkFloatArray *newNormals = NULL;
+  vtkFloatArray *newGradients = NULL;
+  if (this->ComputeScalars)
+    {
+    newScalars = vtkFloatArray::New();
+    newScalars->SetName(inScalars->GetName());
+    }
+  if (this->ComputeNormals)
+    {
+    newNormals = vtkFloatArray::New();
+    newNormals->SetNumberOfComponents(3);
+    newNormals->SetName("Normals");
+    }
+  if (this->ComputeGradients)
+    {
+    newGradients = vtkFloatArray::New();
+    newGradients->SetNumberOfComponents(3);
+    newGradients->SetName("Gradients");
+    }
+
+  void *ptr = inScalars->GetVoidPointer(0);
+  switch (inScalars->GetDataType())
+    {
+    vtkTemplateMacro(
+      vtkFlyingEdges3DContour(this, input, inScalars,
+                              static_cast<VTK_TT *>(ptr), output,
+                              newScalars, newNormals, newGradients));
+    default:
+      vtkErrorMacro(<< "Unsupported scalar type");
+    }
+
+  vtkDebugMacro(<<"Created: "
+               << output->GetNumberOfPoints() << " points, "
+               << output->GetNumberOfPolys() << " triangles");
+
+  if (newScalars)
+    {
+    int idx = output->GetPointData()->AddArray(newScalars);
+    output->GetPointData()->SetActiveAttribute(idx, vtkDataSetAttributes::SCALARS);
+    newScalars->Delete();
+    }
+  if (newGradients)
+    {
+    output->GetPointData()->SetVectors(newGradients);
+    newGradients->Delete();
+    }
+  if (newNormals)
+    {
+    output->GetPointData()->SetNormals(newNormals);
+    newNormals->Delete();
+    }
+
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkFlyingEdges3D::FillInputPortInformation(int, vtkInformation *info)
+{
+  info->Set(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE(), "vtkImageData");
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkFlyingEdges3D::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+
+  this->ContourValues->PrintSelf(os,indent.GetNextIndent());
+
+  os << indent << "Compute Normals: " << (this->ComputeNormals ? "On\n" : "Off\n");
+  os << indent << "Compute Gradients: " << (this->ComputeGradients ? "On\n" : "Off\n");
+  os << indent << "Compute Scalars: " << (this->ComputeScalars ? "On\n" : "Off\n");
+  os << indent << "ArrayComponent: " << this->ArrayComponent << endl;
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << endl;
+}
@@ -0,0 +1,155 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkFlyingEdges3D.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkFlyingEdges3D - generate isosurface from a volume in separate passes
+// .SECTION Description
+// vtkFlyingEdges3D generates isosurfaces from a volume (3D vtkImageData)
+// with the marching cubes case table, like vtkMarchingCubes, but in
+// separate passes over the rows of voxels along x:
+//
+// 1. classify the x edges of each row of points against the contour value
+// and find the range of each row the contour crosses;
+// 2. count the points on the y and z edges and the triangles of each row
+// of voxels, visiting only that range;
+// 3. number the points and triangles of the rows with a prefix sum and
+// allocate the output, exactly once;
+// 4. generate the points and triangles of each row into their place.
+//
+// Each pass treats the rows independently, so they are divided among
+// NumberOfThreads threads, and the output does not depend on the number
+// of threads. A point is generated once on each edge the contour crosses;
+// coincident points, where a sample equals the contour value, are not
+// merged. Like vtkMarchingCubes, the output has scalars, normals and
+// gradients but no other point data.
+
+// .SECTION See Also
+// vtkMarchingCubes vtkSynchronizedTemplates3D vtkContourFilter
+
+#ifndef __vtkFlyingEdges3D_h
+#define __vtkFlyingEdges3D_h
+
+#include "vtkPolyDataAlgorithm.h"
+#include "vtkContourValues.h" // Passes calls through
+
+class VTK_GRAPHICS_EXPORT vtkFlyingEdges3D : public vtkPolyDataAlgorithm
+{
+public:
+  static vtkFlyingEdges3D *New();
+  vtkTypeMacro(vtkFlyingEdges3D,vtkPolyDataAlgorithm);
+  void PrintSelf(ostream& os, vtkIndent indent);
+
+  // Description:
+  // Because we delegate to vtkContourValues
+  unsigned long int GetMTime();
+
+  // Description:
+  // Set/Get the computation of normals. Normal computation is fairly
+  // expensive in both time and storage. If the output data will be
+  // processed by filters that modify topology or geometry, it may be
+  // wise to turn Normals and Gradients off.
+  vtkSetMacro(ComputeNormals,int);
+  vtkGetMacro(ComputeNormals,int);
+  vtkBooleanMacro(ComputeNormals,int);
+
+  // Description:
+  // Set/Get the computation of gradients. Gradient computation is
+  // fairly expensive in both time and storage. Note that if
+  // ComputeNormals is on, gradients will have to be calculated, but
+  // will not be stored in the output dataset.
+  vtkSetMacro(ComputeGradients,int);
+  vtkGetMacro(ComputeGradients,int);
+  vtkBooleanMacro(ComputeGradients,int);
+
+  // Description:
+  // Set/Get the computation of scalars.
+  vtkSetMacro(ComputeScalars,int);
+  vtkGetMacro(ComputeScalars,int);
+  vtkBooleanMacro(ComputeScalars,int);
+
+  // Description:
+  // Set a particular contour value at contour number i. The index i ranges
+  // between 0<=i<NumberOfContours.
+  void SetValue(int i, double value) {this->ContourValues->SetValue(i,value);}
+
+  // Description:
+  // Get the ith contour value.
+  double GetValue(int i) {return this->ContourValues->GetValue(i);}
+
+  // Description:
+  // Get a pointer to an array of contour values. There will be
+  // GetNumberOfContours() values in the list.
+  double *GetValues() {return this->ContourValues->GetValues();}
+
+  // Description:
+  // Fill a supplied list with contour values. There will be
+  // GetNumberOfContours() values in the list. Make sure you allocate
+  // enough memory to hold the list.
+  void GetValues(double *contourValues) {
+    this->ContourValues->GetValues(contourValues);}
+
+  // Description:
+  // Set the number of contours to place into the list. You only really
+  // need to use this method to reduce list size. The method SetValue()
+  // will automatically increase list size as needed.
+  void SetNumberOfContours(int number) {
+    this->ContourValues->SetNumberOfContours(number);}
+
+  // Description:
+  // Get the number of contours in the list of contour values.
+  int GetNumberOfContours() {
+    return this->ContourValues->GetNumberOfContours();}
+
+  // Description:
+  // Generate numContours equally spaced contour values between specified
+  // range. Contour values will include min/max range values.
+  void GenerateValues(int numContours, double range[2]) {
+    this->ContourValues->GenerateValues(numContours, range);}
+
+  // Description:
+  // Generate numContours equally spaced contour values between specified
+  // range. Contour values will include min/max range values.
+  void GenerateValues(int numContours, double rangeStart, double rangeEnd)
+    {this->ContourValues->GenerateValues(numContours, rangeStart, rangeEnd);}
+
+  // Description:
+  // Set/get which component of the scalar array to contour on; defaults to 0.
+  vtkSetMacro(ArrayComponent, int);
+  vtkGetMacro(ArrayComponent, int);
+
+  // Description:
+  // Set/get the number of threads each pass is divided among. Defaults to 1.
+  vtkSetClampMacro(NumberOfThreads, int, 1, VTK_LARGE_INTEGER);
+  vtkGetMacro(NumberOfThreads, int);
+
+protected:
+  vtkFlyingEdges3D();
+  ~vtkFlyingEdges3D();
+
+  virtual int RequestData(vtkInformation *, vtkInformationVector **,
+                          vtkInformationVector *);
+  virtual int FillInputPortInformation(int port, vtkInformation *info);
+
+  vtkContourValues *ContourValues;
+  int ComputeNormals;
+  int ComputeGradients;
+  int ComputeScalars;
+  int ArrayComponent;
+  int NumberOfThreads;
+
+private:
+  vtkFlyingEdges3D(const vtkFlyingEdges3D&);  // Not implemented.
+  void operator=(const vtkFlyingEdges3D&);  // Not implemented.
+};
+
+#endif
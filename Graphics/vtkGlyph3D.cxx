@@ -15,14 +15,19 @@
 #include "vtkGlyph3D.h"
 
 #include "vtkCell.h"
+#include "vtkCellArray.h"
 #include "vtkCellData.h"
 #include "vtkDataSet.h"
+#include "vtkDoubleArray.h"
 #include "vtkFloatArray.h"
 #include "vtkIdList.h"
 #include "vtkIdTypeArray.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkIntArray.h"
 #include "vtkMath.h"
+#include "vtkMatrix4x4.h"
+#include "vtkMultiThreader.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
@@ -30,6 +35,13 @@
 #include "vtkTransform.h"
 #include "vtkUnsignedCharArray.h"
 
+#include <vtkstd/vector>
+
+// The smallest run of input points a thread glyphs, and the number of runs
+// per thread, to balance glyphs of different sizes and skipped points.
+#define VTK_GLYPH3D_MIN_PIECE_POINTS 1000
+#define VTK_GLYPH3D_PIECES_PER_THREAD 4
+
 vtkStandardNewMacro(vtkGlyph3D);
 
 //----------------------------------------------------------------------------
@@ -54,6 +66,8 @@ vtkGlyph3D::vtkGlyph3D()
   this->SetPointIdsName("InputPointIds");
   this->SetNumberOfInputPorts(2);
   this->FillCellData = 0;
+  this->GenerateInstances = 0;
+  this->NumberOfThreads = 1;
 
   // by default process active point scalars
   this->SetInputArrayToProcess(0,0,0,vtkDataObject::FIELD_ASSOCIATION_POINTS,
@@ -78,6 +92,160 @@ vtkGlyph3D::~vtkGlyph3D()
     }
 }
 
+//----------------------------------------------------------------------------
+vtkDataArray *vtkGlyph3D::SelectGlyphVectors(vtkDataArray *inVectors,
+                                             vtkDataArray *inNormals)
+{
+  if ( this->VectorMode == VTK_USE_VECTOR )
+    {
+    return inVectors;
+    }
+  if ( this->VectorMode == VTK_USE_NORMAL )
+    {
+    return inNormals;
+    }
+  return NULL;
+}
+
+//----------------------------------------------------------------------------
+void vtkGlyph3D::GetGlyphScale(vtkIdType inPtId, vtkDataArray *inSScalars,
+                               vtkDataArray *vectors, double den,
+                               double scale[3], double v[3], double &s,
+                               double &vMag)
+{
+  scale[0] = scale[1] = scale[2] = 1.0;
+  s = vMag = 0.0;
+
+  // Get the scalar and vector data
+  if ( inSScalars )
+    {
+    s = inSScalars->GetComponent(inPtId, 0);
+    if ( this->ScaleMode == VTK_SCALE_BY_SCALAR ||
+         this->ScaleMode == VTK_DATA_SCALING_OFF )
+      {
+      scale[0] = scale[1] = scale[2] = s;
+      }
+    }
+
+  if ( vectors )
+    {
+    vectors->GetTuple(inPtId, v);
+    vMag = vtkMath::Norm(v);
+    if ( this->ScaleMode == VTK_SCALE_BY_VECTORCOMPONENTS )
+      {
+      scale[0] = v[0];
+      scale[1] = v[1];
+      scale[2] = v[2];
+      }
+    else if ( this->ScaleMode == VTK_SCALE_BY_VECTOR )
+      {
+      scale[0] = scale[1] = scale[2] = vMag;
+      }
+    }
+
+  // Clamp data scale if enabled
+  if ( this->Clamping )
+    {
+    for (int i = 0; i < 3; i++)
+      {
+      scale[i] = (scale[i] < this->Range[0] ? this->Range[0] :
+                  (scale[i] > this->Range[1] ? this->Range[1] : scale[i]));
+      scale[i] = (scale[i] - this->Range[0]) / den;
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkGlyph3D::GetGlyphIndex(double s, double vMag, int numberOfSources,
+                              double den)
+{
+  if ( this->IndexMode == VTK_INDEXING_OFF )
+    {
+    return 0;
+    }
+  double value = (this->IndexMode == VTK_INDEXING_BY_SCALAR ? s : vMag);
+  int index = static_cast<int>((value - this->Range[0])*numberOfSources / den);
+  return (index < 0 ? 0 :
+          (index >= numberOfSources ? (numberOfSources-1) : index));
+}
+
+//----------------------------------------------------------------------------
+void vtkGlyph3D::TransformGlyph(vtkTransform *trans, double x[3], double v[3],
+                                double vMag, int haveVectors,
+                                double scale[3])
+{
+  // translate Source to Input point
+  trans->Identity();
+  trans->Translate(x[0], x[1], x[2]);
+
+  if ( haveVectors && this->Orient && (vMag > 0.0) )
+    {
+    // if there is no y or z component
+    if ( v[1] == 0.0 && v[2] == 0.0 )
+      {
+      if (v[0] < 0) //just flip x if we need to
+        {
+        trans->RotateWXYZ(180.0,0,1,0);
+        }
+      }
+    else
+      {
+      trans->RotateWXYZ(180.0, (v[0]+vMag) / 2.0, v[1] / 2.0, v[2] / 2.0);
+      }
+    }
+
+  // scale data if appropriate
+  if ( this->Scaling )
+    {
+    double factors[3];
+    for (int i = 0; i < 3; i++)
+      {
+      if ( this->ScaleMode == VTK_DATA_SCALING_OFF )
+        {
+        factors[i] = this->ScaleFactor;
+        }
+      else
+        {
+        factors[i] = scale[i] * this->ScaleFactor;
+        }
+      if ( factors[i] == 0.0 )
+        {
+        factors[i] = 1.0e-10;
+        }
+      }
+    trans->Scale(factors[0], factors[1], factors[2]);
+    }
+}
+
+//----------------------------------------------------------------------------
+vtkDataArray *vtkGlyph3D::NewGlyphScalars(vtkDataArray *inSScalars,
+                                          vtkDataArray *inCScalars,
+                                          int haveVectors)
+{
+  vtkDataArray *newScalars = NULL;
+  if ( this->ColorMode == VTK_COLOR_BY_SCALAR && inCScalars )
+    {
+    newScalars = inCScalars->NewInstance();
+    newScalars->SetNumberOfComponents(inCScalars->GetNumberOfComponents());
+    newScalars->SetName(inCScalars->GetName());
+    }
+  else if ( (this->ColorMode == VTK_COLOR_BY_SCALE) && inSScalars)
+    {
+    newScalars = vtkFloatArray::New();
+    newScalars->SetName("GlyphScale");
+    if (this->ScaleMode == VTK_SCALE_BY_SCALAR)
+      {
+      newScalars->SetName(inSScalars->GetName());
+      }
+    }
+  else if ( (this->ColorMode == VTK_COLOR_BY_VECTOR) && haveVectors)
+    {
+    newScalars = vtkFloatArray::New();
+    newScalars->SetName("VectorMagnitude");
+    }
+  return newScalars;
+}
+
 //----------------------------------------------------------------------------
 int vtkGlyph3D::RequestData(
   vtkInformation *vtkNotUsed(request),
@@ -97,7 +265,7 @@ int vtkGlyph3D::RequestData(
   vtkPointData *pd;
   vtkDataArray *inSScalars; // Scalars for Scaling
   vtkDataArray *inCScalars; // Scalars for Coloring
-  vtkDataArray *inVectors;
+  vtkDataArray *inVectors, *vectors;
   int requestedGhostLevel;
   unsigned char* inGhostLevels=0;
   vtkDataArray *inNormals, *sourceNormals = NULL;
@@ -110,7 +278,7 @@ int vtkGlyph3D::RequestData(
   vtkDataArray *newVectors=NULL;
   vtkDataArray *newNormals=NULL;
   vtkDataArray *newTCoords = NULL;
-  double x[3], v[3], vNew[3], s = 0.0, vMag = 0.0, value, tc[3];
+  double x[3], v[3], scale[3], s, vMag, tc[3];
   vtkTransform *trans = vtkTransform::New();
   vtkCell *cell;
   vtkIdList *cellPts;
@@ -118,7 +286,7 @@ int vtkGlyph3D::RequestData(
   vtkIdList *pts;
   vtkIdType ptIncr, cellIncr, cellId;
   int haveVectors, haveNormals, haveTCoords = 0;
-  double scalex,scaley,scalez, den;
+  double den;
   vtkPointData* outputPD = output->GetPointData();
   vtkCellData* outputCD = output->GetCellData();
   int numberOfSources = this->GetNumberOfInputConnections(1);
@@ -174,16 +342,8 @@ int vtkGlyph3D::RequestData(
     {
     den = 1.0;
     }
-  if ( this->VectorMode != VTK_VECTOR_ROTATION_OFF &&
-       ((this->VectorMode == VTK_USE_VECTOR && inVectors != NULL) ||
-        (this->VectorMode == VTK_USE_NORMAL && inNormals != NULL)) )
-    {
-    haveVectors = 1;
-    }
-  else
-    {
-    haveVectors = 0;
-    }
+  vectors = this->SelectGlyphVectors(inVectors, inNormals);
+  haveVectors = (vectors != NULL);
 
   if ( (this->IndexMode == VTK_INDEXING_BY_SCALAR && !inSScalars) ||
        (this->IndexMode == VTK_INDEXING_BY_VECTOR &&
@@ -230,6 +390,18 @@ int vtkGlyph3D::RequestData(
     defaultPoints->Delete();
     defaultPoints = NULL;
     }
+
+  // Instances, and many glyphs, are output in pieces.
+  if ( (this->GenerateInstances || (this->NumberOfThreads > 1 &&
+        numPts >= 2*VTK_GLYPH3D_MIN_PIECE_POINTS)) &&
+       this->GlyphInPieces(input, inputVector[1], output, inSScalars,
+                           inVectors, inNormals, inCScalars, inGhostLevels,
+                           requestedGhostLevel) )
+    {
+    pts->Delete();
+    trans->Delete();
+    return 1;
+    }
   
   if ( this->IndexMode != VTK_INDEXING_OFF )
     {
@@ -301,28 +473,11 @@ int vtkGlyph3D::RequestData(
     outputPD->AddArray(pointIds);
     pointIds->Delete();
     }
-  if ( this->ColorMode == VTK_COLOR_BY_SCALAR && inCScalars )
-    {
-    newScalars = inCScalars->NewInstance();
-    newScalars->SetNumberOfComponents(inCScalars->GetNumberOfComponents());
-    newScalars->Allocate(inCScalars->GetNumberOfComponents()*numPts*numSourcePts);
-    newScalars->SetName(inCScalars->GetName());
-    }
-  else if ( (this->ColorMode == VTK_COLOR_BY_SCALE) && inSScalars)
+  newScalars = this->NewGlyphScalars(inSScalars, inCScalars, haveVectors);
+  if ( newScalars )
     {
-    newScalars = vtkFloatArray::New();
-    newScalars->Allocate(numPts*numSourcePts);
-    newScalars->SetName("GlyphScale");
-    if (this->ScaleMode == VTK_SCALE_BY_SCALAR)
-      {
-      newScalars->SetName(inSScalars->GetName());
-      }
-    }
-  else if ( (this->ColorMode == VTK_COLOR_BY_VECTOR) && haveVectors)
-    {
-    newScalars = vtkFloatArray::New();
-    newScalars->Allocate(numPts*numSourcePts);
-    newScalars->SetName("VectorMagnitude");
+    newScalars->Allocate(newScalars->GetNumberOfComponents()*
+                         numPts*numSourcePts);
     }
   if ( haveVectors )
     {
@@ -365,7 +520,6 @@ int vtkGlyph3D::RequestData(
   cellIncr=0;
   for (inPtId=0; inPtId < numPts; inPtId++)
     {
-    scalex = scaley = scalez = 1.0;
     if ( ! (inPtId % 10000) )
       {
       this->UpdateProgress(static_cast<double>(inPtId)/numPts);
@@ -375,74 +529,11 @@ int vtkGlyph3D::RequestData(
         }
       }
 
-    // Get the scalar and vector data
-    if ( inSScalars )
-      {
-      s = inSScalars->GetComponent(inPtId, 0);
-      if ( this->ScaleMode == VTK_SCALE_BY_SCALAR ||
-           this->ScaleMode == VTK_DATA_SCALING_OFF )
-        {
-        scalex = scaley = scalez = s;
-        }
-      }
-    
-    if ( haveVectors )
-      {
-      if ( this->VectorMode == VTK_USE_NORMAL )
-        {
-        inNormals->GetTuple(inPtId, v);
-        }
-      else
-        {
-        inVectors->GetTuple(inPtId, v);
-        }
-      vMag = vtkMath::Norm(v);
-      if ( this->ScaleMode == VTK_SCALE_BY_VECTORCOMPONENTS )
-        {
-        scalex = v[0];
-        scaley = v[1];
-        scalez = v[2];
-        }
-      else if ( this->ScaleMode == VTK_SCALE_BY_VECTOR )
-        {
-        scalex = scaley = scalez = vMag;
-        }
-      }
-    
-    // Clamp data scale if enabled
-    if ( this->Clamping )
-      {
-      scalex = (scalex < this->Range[0] ? this->Range[0] :
-                (scalex > this->Range[1] ? this->Range[1] : scalex));
-      scalex = (scalex - this->Range[0]) / den;
-      scaley = (scaley < this->Range[0] ? this->Range[0] :
-                (scaley > this->Range[1] ? this->Range[1] : scaley));
-      scaley = (scaley - this->Range[0]) / den;
-      scalez = (scalez < this->Range[0] ? this->Range[0] :
-                (scalez > this->Range[1] ? this->Range[1] : scalez));
-      scalez = (scalez - this->Range[0]) / den;
-      }
-    
-    // Compute index into table of glyphs
-    if ( this->IndexMode == VTK_INDEXING_OFF )
+    // Get the scale and the vector, and the index into table of glyphs
+    this->GetGlyphScale(inPtId, inSScalars, vectors, den, scale, v, s, vMag);
+    index = this->GetGlyphIndex(s, vMag, numberOfSources, den);
+    if ( this->IndexMode != VTK_INDEXING_OFF )
       {
-      index = 0;
-      }
-    else 
-      {
-      if ( this->IndexMode == VTK_INDEXING_BY_SCALAR )
-        {
-        value = s;
-        }
-      else
-        {
-        value = vMag;
-        }
-      
-      index = static_cast<int>((value - this->Range[0])*numberOfSources / den);
-      index = (index < 0 ? 0 :
-              (index >= numberOfSources ? (numberOfSources-1) : index));
-      
       source = this->GetSource(index, inputVector[1]);
       if ( source != NULL )
         {
@@ -477,9 +568,6 @@ int vtkGlyph3D::RequestData(
       continue;
       }
     
-    // Now begin copying/transforming glyph
-    trans->Identity();
-    
     // Copy all topology (transformation independent)
     for (cellId=0; cellId < numSourceCells; cellId++)
       {
@@ -493,10 +581,6 @@ int vtkGlyph3D::RequestData(
       output->InsertNextCell(cell->GetCellType(),pts);
       }
     
-    // translate Source to Input point
-    input->GetPoint(inPtId, x);
-    trans->Translate(x[0], x[1], x[2]);
-    
     if ( haveVectors )
       {
       // Copy Input vector
@@ -504,24 +588,6 @@ int vtkGlyph3D::RequestData(
         {
         newVectors->InsertTuple(i+ptIncr, v);
         }
-      if (this->Orient && (vMag > 0.0))
-        {
-        // if there is no y or z component
-        if ( v[1] == 0.0 && v[2] == 0.0 )
-          {
-          if (v[0] < 0) //just flip x if we need to
-            {
-            trans->RotateWXYZ(180.0,0,1,0);
-            }
-          }
-        else
-          {
-          vNew[0] = (v[0]+vMag) / 2.0;
-          vNew[1] = v[1] / 2.0;
-          vNew[2] = v[2] / 2.0;
-          trans->RotateWXYZ(180.0,vNew[0],vNew[1],vNew[2]);
-          }
-        }
       }
     
     if (haveTCoords)
@@ -539,7 +605,7 @@ int vtkGlyph3D::RequestData(
       {
       for (i=0; i < numSourcePts; i++)
         {
-        newScalars->InsertTuple(i+ptIncr, &scalex); // = scaley = scalez
+        newScalars->InsertTuple(i+ptIncr, scale); // = scale[1] = scale[2]
         }
       }
     else if (inCScalars && (this->ColorMode == VTK_COLOR_BY_SCALAR))
@@ -557,34 +623,9 @@ int vtkGlyph3D::RequestData(
         }
       }
     
-    // scale data if appropriate
-    if ( this->Scaling )
-      {
-      if ( this->ScaleMode == VTK_DATA_SCALING_OFF )
-        {
-        scalex = scaley = scalez = this->ScaleFactor;
-        }
-      else
-        {
-        scalex *= this->ScaleFactor;
-        scaley *= this->ScaleFactor;
-        scalez *= this->ScaleFactor;
-        }
-      
-      if ( scalex == 0.0 )
-        {
-        scalex = 1.0e-10;
-        }
-      if ( scaley == 0.0 )
-        {
-        scaley = 1.0e-10;
-        }
-      if ( scalez == 0.0 )
-        {
-        scalez = 1.0e-10;
-        }
-      trans->Scale(scalex,scaley,scalez);
-      }
+    // translate, orient and scale the glyph
+    input->GetPoint(inPtId, x);
+    this->TransformGlyph(trans, x, v, vMag, haveVectors, scale);
     
     // multiply points and normals by resulting matrix
     trans->TransformPoints(sourcePts,newPts);
@@ -660,6 +701,700 @@ int vtkGlyph3D::RequestData(
   return 1;
 }
 
+//----------------------------------------------------------------------------
+// A glyph of the table as the pieces copy it, its cells flattened into a
+// list of (n,id1,...,idn) entries.
+class vtkGlyph3DGlyph
+{
+public:
+  vtkPolyData *Source;
+  vtkDataArray *Normals;
+  vtkDataArray *TCoords;
+  vtkIdType NumberOfPoints;
+  vtkIdType NumberOfCells;
+  vtkstd::vector<vtkIdType> Cells;
+};
+
+//----------------------------------------------------------------------------
+// Flatten the cells of the source into the list, if they all are in the
+// cell array of the given kind (vertices, lines, polygons or strips, set
+// by the first source with cells), and their number of points gives their
+// type, so that the output built from the lists has the cells of the
+// serial output. Returns 0 otherwise.
+static int vtkGlyph3DFlattenCells(vtkPolyData *source, int &kind,
+                                  vtkstd::vector<vtkIdType> &list)
+{
+  vtkCellArray *arrays[4];
+  arrays[0] = source->GetVerts();
+  arrays[1] = source->GetLines();
+  arrays[2] = source->GetPolys();
+  arrays[3] = source->GetStrips();
+  vtkIdType numCells = source->GetNumberOfCells();
+  list.clear();
+  if (numCells == 0)
+    {
+    return 1;
+    }
+  int k = 0;
+  while (k < 4 && arrays[k]->GetNumberOfCells() != numCells)
+    {
+    k++;
+    }
+  if (k == 4 || (kind >= 0 && kind != k))
+    {
+    return 0;
+    }
+  kind = k;
+
+  vtkCellArray *cells = arrays[kind];
+  vtkIdType npts, *pts, cellId = 0;
+  list.reserve(cells->GetNumberOfConnectivityEntries());
+  for (cells->InitTraversal(); cells->GetNextCell(npts, pts); cellId++)
+    {
+    int type;
+    switch (kind)
+      {
+      case 0:
+        type = (npts > 1 ? VTK_POLY_VERTEX : VTK_VERTEX);
+        break;
+      case 1:
+        type = (npts > 2 ? VTK_POLY_LINE : VTK_LINE);
+        break;
+      case 2:
+        type = (npts == 3 ? VTK_TRIANGLE :
+                (npts == 4 ? VTK_QUAD : VTK_POLYGON));
+        break;
+      default:
+        type = VTK_TRIANGLE_STRIP;
+      }
+    if (source->GetCellType(cellId) != type)
+      {
+      return 0;
+      }
+    list.push_back(npts);
+    list.insert(list.end(), pts, pts + npts);
+    }
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+// The state shared by the threads of GlyphInPieces(). Each piece is a run
+// of input points, whose glyphs start at the offsets of the piece in the
+// preallocated output.
+class vtkGlyph3DPieces
+{
+public:
+  vtkGlyph3D *Self;
+  vtkDataSet *Input;
+  vtkDataArray *InSScalars;
+  vtkDataArray *Vectors; // those selected by the VectorMode, or NULL
+  vtkDataArray *InCScalars;
+  double Den;
+  vtkstd::vector<vtkGlyph3DGlyph> Glyphs;
+  vtkstd::vector<int> Indices; // glyph of each point, -1 for none
+
+  int NumberOfPieces;
+  vtkstd::vector<vtkIdType> PointOffsets;
+  vtkstd::vector<vtkIdType> CellOffsets;
+  vtkstd::vector<vtkIdType> ConnectivityOffsets;
+
+  // The copied point data, written in place from the paired arrays, or
+  // with CopyData() when the arrays can not be paired (in one piece).
+  vtkPointData *InPD;
+  vtkPointData *OutPD;
+  vtkCellData *OutCD;
+  int PairedArrays;
+  vtkstd::vector<vtkDataArray *> PointFrom;
+  vtkstd::vector<vtkDataArray *> PointTo;
+  vtkstd::vector<vtkDataArray *> CellFrom;
+  vtkstd::vector<vtkDataArray *> CellTo;
+
+  float *NewPoints;
+  vtkIdType *NewCells;
+  vtkDataArray *NewScalars;
+  vtkDataArray *NewVectors;
+  vtkDataArray *NewNormals;
+  vtkDataArray *NewTCoords;
+  vtkIdType *PointIds;
+  double *Transforms;
+  int *GlyphIndices;
+
+  void GlyphPiece(int piece);
+  static VTK_THREAD_RETURN_TYPE Execute(void *arg);
+};
+
+//----------------------------------------------------------------------------
+// Glyph the points of a piece as RequestData() does, writing the glyphs in
+// place from the offsets of the piece.
+void vtkGlyph3DPieces::GlyphPiece(int piece)
+{
+  vtkGlyph3D *self = this->Self;
+  vtkIdType numPts = static_cast<vtkIdType>(this->Indices.size());
+  vtkIdType first = numPts*piece/this->NumberOfPieces;
+  vtkIdType last = numPts*(piece + 1)/this->NumberOfPieces;
+  vtkIdType ptIncr = this->PointOffsets[piece];
+  vtkIdType cellIncr = this->CellOffsets[piece];
+  vtkIdType *cells = this->NewCells + this->ConnectivityOffsets[piece];
+  int instances = self->GenerateInstances;
+
+  // The glyphs are transformed as RequestData() does, into these, then
+  // copied in place.
+  vtkTransform *trans = vtkTransform::New();
+  vtkPoints *glyphPts = vtkPoints::New();
+  vtkFloatArray *glyphNormals = vtkFloatArray::New();
+  glyphNormals->SetNumberOfComponents(3);
+
+  double x[3], v[3], scale[3], s, vMag, tc[3];
+  vtkIdType i;
+  size_t a;
+  for (vtkIdType inPtId = first; inPtId < last; inPtId++)
+    {
+    int index = this->Indices[inPtId];
+    if (index < 0)
+      {
+      continue;
+      }
+    vtkGlyph3DGlyph &glyph = this->Glyphs[index];
+    vtkIdType numSourcePts = (instances ? 1 : glyph.NumberOfPoints);
+    vtkIdType numSourceCells = (instances ? 1 : glyph.NumberOfCells);
+    self->GetGlyphScale(inPtId, this->InSScalars, this->Vectors, this->Den,
+                        scale, v, s, vMag);
+
+    if ( this->Vectors )
+      {
+      for (i=0; i < numSourcePts; i++)
+        {
+        this->NewVectors->SetTuple(i+ptIncr, v);
+        }
+      }
+
+    if (glyph.TCoords && !instances)
+      {
+      for (i = 0; i < numSourcePts; i++)
+        {
+        glyph.TCoords->GetTuple(i, tc);
+        this->NewTCoords->SetTuple(i+ptIncr, tc);
+        }
+      }
+
+    if (this->InSScalars && (self->ColorMode == VTK_COLOR_BY_SCALE))
+      {
+      for (i=0; i < numSourcePts; i++)
+        {
+        this->NewScalars->SetTuple(i+ptIncr, scale);
+        }
+      }
+    else if (this->InCScalars && (self->ColorMode == VTK_COLOR_BY_SCALAR))
+      {
+      for (i=0; i < numSourcePts; i++)
+        {
+        this->NewScalars->InsertTuple(ptIncr+i, inPtId, this->InCScalars);
+        }
+      }
+    if (this->Vectors && self->ColorMode == VTK_COLOR_BY_VECTOR)
+      {
+      for (i=0; i < numSourcePts; i++)
+        {
+        this->NewScalars->SetTuple(i+ptIncr, &vMag);
+        }
+      }
+
+    this->Input->GetPoint(inPtId, x);
+    self->TransformGlyph(trans, x, v, vMag, (this->Vectors != NULL), scale);
+
+    if (instances)
+      {
+      double *matrix = this->Transforms + 16*ptIncr;
+      vtkMatrix4x4 *m = trans->GetMatrix();
+      for (int j = 0; j < 4; j++)
+        {
+        for (int k = 0; k < 4; k++)
+          {
+          matrix[4*j+k] = m->GetElement(j, k);
+          }
+        }
+      if (this->GlyphIndices)
+        {
+        this->GlyphIndices[ptIncr] = index;
+        }
+      for (int j = 0; j < 3; j++)
+        {
+        this->NewPoints[3*ptIncr+j] = static_cast<float>(x[j]);
+        }
+      *cells++ = 1;
+      *cells++ = ptIncr;
+      }
+    else
+      {
+      vtkstd::vector<vtkIdType>::const_iterator glyphCells =
+        glyph.Cells.begin();
+      while (glyphCells != glyph.Cells.end())
+        {
+        vtkIdType npts = *glyphCells++;
+        *cells++ = npts;
+        for (i = 0; i < npts; i++)
+          {
+          *cells++ = *glyphCells++ + ptIncr;
+          }
+        }
+
+      if (numSourcePts > 0)
+        {
+        glyphPts->Reset();
+        trans->TransformPoints(glyph.Source->GetPoints(), glyphPts);
+        memcpy(this->NewPoints + 3*ptIncr, glyphPts->GetVoidPointer(0),
+               3*numSourcePts*sizeof(float));
+        }
+      if ( this->NewNormals && numSourcePts > 0 )
+        {
+        glyphNormals->Reset();
+        trans->TransformNormals(glyph.Normals, glyphNormals);
+        memcpy(this->NewNormals->GetVoidPointer(3*ptIncr),
+               glyphNormals->GetPointer(0), 3*numSourcePts*sizeof(float));
+        }
+      }
+
+    if ( this->InPD )
+      {
+      for (i=0; i < numSourcePts; i++)
+        {
+        if (this->PairedArrays)
+          {
+          for (a = 0; a < this->PointTo.size(); a++)
+            {
+            this->PointTo[a]->InsertTuple(ptIncr+i, inPtId,
+                                          this->PointFrom[a]);
+            }
+          }
+        else
+          {
+          this->OutPD->CopyData(this->InPD, inPtId, ptIncr+i);
+          }
+        }
+      if (self->FillCellData)
+        {
+        for (i=0; i < numSourceCells; i++)
+          {
+          if (this->PairedArrays)
+            {
+            for (a = 0; a < this->CellTo.size(); a++)
+              {
+              this->CellTo[a]->InsertTuple(cellIncr+i, inPtId,
+                                           this->CellFrom[a]);
+              }
+            }
+          else
+            {
+            this->OutCD->CopyData(this->InPD, inPtId, cellIncr+i);
+            }
+          }
+        }
+      }
+
+    if ( this->PointIds )
+      {
+      for (i=0; i < numSourcePts; i++)
+        {
+        this->PointIds[ptIncr+i] = inPtId;
+        }
+      }
+
+    ptIncr += numSourcePts;
+    cellIncr += numSourceCells;
+    }
+
+  glyphNormals->Delete();
+  glyphPts->Delete();
+  trans->Delete();
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkGlyph3DPieces::Execute(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *info =
+    static_cast<vtkMultiThreader::ThreadInfo *>(arg);
+  vtkGlyph3DPieces *pieces =
+    static_cast<vtkGlyph3DPieces *>(info->UserData);
+  for (int piece = info->ThreadID; piece < pieces->NumberOfPieces;
+       piece += info->NumberOfThreads)
+    {
+    pieces->GlyphPiece(piece);
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+// Pair the arrays of the output attributes with the input arrays of the
+// same name they copy, leaving out the skipped array.
+static void vtkGlyph3DPairArrays(vtkDataSetAttributes *in,
+                                 vtkDataSetAttributes *out,
+                                 vtkAbstractArray *skipped,
+                                 vtkstd::vector<vtkDataArray *> &from,
+                                 vtkstd::vector<vtkDataArray *> &to)
+{
+  for (int i = 0; i < out->GetNumberOfArrays(); i++)
+    {
+    vtkDataArray *array = out->GetArray(i);
+    vtkDataArray *inArray = in->GetArray(array->GetName());
+    if (array != skipped && inArray)
+      {
+      from.push_back(inArray);
+      to.push_back(array);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Set the number of tuples of all the arrays of the attributes.
+static void vtkGlyph3DSetNumberOfTuples(vtkDataSetAttributes *attributes,
+                                        vtkIdType numTuples)
+{
+  for (int i = 0; i < attributes->GetNumberOfArrays(); i++)
+    {
+    attributes->GetAbstractArray(i)->SetNumberOfTuples(numTuples);
+    }
+}
+
+//----------------------------------------------------------------------------
+int vtkGlyph3D::GlyphInPieces(vtkDataSet *input,
+                              vtkInformationVector *sourceVector,
+                              vtkPolyData *output, vtkDataArray *inSScalars,
+                              vtkDataArray *inVectors, vtkDataArray *inNormals,
+                              vtkDataArray *inCScalars,
+                              unsigned char *inGhostLevels,
+                              int requestedGhostLevel)
+{
+  vtkPointData *pd = input->GetPointData();
+  vtkPointData *outputPD = output->GetPointData();
+  vtkCellData *outputCD = output->GetCellData();
+  vtkIdType numPts = input->GetNumberOfPoints();
+  vtkIdType inPtId;
+  int i;
+
+  vtkGlyph3DPieces pieces;
+  pieces.Self = this;
+  pieces.Input = input;
+  pieces.InSScalars = inSScalars;
+  pieces.Vectors = this->SelectGlyphVectors(inVectors, inNormals);
+  pieces.InCScalars = inCScalars;
+  if ( (pieces.Den = this->Range[1] - this->Range[0]) == 0.0 )
+    {
+    pieces.Den = 1.0;
+    }
+  pieces.InPD = (this->IndexMode == VTK_INDEXING_OFF ? pd : NULL);
+  pieces.OutPD = outputPD;
+  pieces.OutCD = outputCD;
+
+  // The threads write the tuples of their glyphs in place, which the bits
+  // of a bit array, packed in bytes, and the strings of other arrays do
+  // not allow. The copied arrays are found by their names, which must be
+  // unique.
+  pieces.PairedArrays = 1;
+  if (pieces.InPD)
+    {
+    for (i = 0; i < pd->GetNumberOfArrays(); i++)
+      {
+      vtkDataArray *array = pd->GetArray(i);
+      vtkDataArray *named = NULL;
+      if (array && array->GetName())
+        {
+        int idx;
+        named = pd->GetArray(array->GetName(), idx);
+        named = (idx == i ? named : NULL);
+        }
+      if (!named || named->GetDataType() == VTK_BIT)
+        {
+        pieces.PairedArrays = 0;
+        }
+      }
+    }
+  if (this->ColorMode == VTK_COLOR_BY_SCALAR && inCScalars &&
+      inCScalars->GetDataType() == VTK_BIT)
+    {
+    pieces.PairedArrays = 0;
+    }
+  if (!pieces.PairedArrays && !this->GenerateInstances)
+    {
+    return 0;
+    }
+
+  // The glyphs of the table, all with normals or none, as RequestData()
+  // copies them.
+  int numGlyphs = (this->IndexMode == VTK_INDEXING_OFF ? 1 :
+                   this->GetNumberOfInputConnections(1));
+  int haveNormals = 1, cellKind = -1;
+  pieces.Glyphs.resize(numGlyphs);
+  for (i = 0; i < numGlyphs; i++)
+    {
+    vtkGlyph3DGlyph &glyph = pieces.Glyphs[i];
+    glyph.Source = this->GetSource(i, sourceVector);
+    glyph.Normals = glyph.TCoords = NULL;
+    glyph.NumberOfPoints = glyph.NumberOfCells = 0;
+    if (!glyph.Source)
+      {
+      continue;
+      }
+    glyph.Normals = glyph.Source->GetPointData()->GetNormals();
+    haveNormals = (haveNormals && glyph.Normals);
+    if (this->IndexMode == VTK_INDEXING_OFF)
+      {
+      glyph.TCoords = glyph.Source->GetPointData()->GetTCoords();
+      }
+    glyph.NumberOfPoints = glyph.Source->GetNumberOfPoints();
+    glyph.NumberOfCells = glyph.Source->GetNumberOfCells();
+    if (!this->GenerateInstances &&
+        !vtkGlyph3DFlattenCells(glyph.Source, cellKind, glyph.Cells))
+      {
+      return 0;
+      }
+    }
+  if (this->GenerateInstances)
+    {
+    haveNormals = 0;
+    cellKind = 0;
+    }
+
+  // Decide the glyph of each point, calling IsPointVisible() from this
+  // thread only.
+  pieces.Indices.resize(numPts);
+  double scale[3], v[3], s, vMag;
+  for (inPtId = 0; inPtId < numPts; inPtId++)
+    {
+    if ( ! (inPtId % 10000) )
+      {
+      this->UpdateProgress(static_cast<double>(inPtId)/numPts);
+      if (this->GetAbortExecute())
+        {
+        break;
+        }
+      }
+    this->GetGlyphScale(inPtId, inSScalars, pieces.Vectors, pieces.Den,
+                        scale, v, s, vMag);
+    int index = this->GetGlyphIndex(s, vMag,
+                                    static_cast<int>(pieces.Glyphs.size()),
+                                    pieces.Den);
+    if ( pieces.Glyphs[index].Source == NULL ||
+         (inGhostLevels && inGhostLevels[inPtId] > requestedGhostLevel) ||
+         !this->IsPointVisible(input, inPtId) )
+      {
+      index = -1;
+      }
+    pieces.Indices[inPtId] = index;
+    }
+  for (; inPtId < numPts; inPtId++)
+    {
+    pieces.Indices[inPtId] = -1;
+    }
+
+  // Split the points into runs, and count the output of each run.
+  vtkIdType numPieces = numPts/VTK_GLYPH3D_MIN_PIECE_POINTS;
+  if (numPieces > VTK_GLYPH3D_PIECES_PER_THREAD*this->NumberOfThreads)
+    {
+    numPieces = VTK_GLYPH3D_PIECES_PER_THREAD*this->NumberOfThreads;
+    }
+  if (this->NumberOfThreads == 1 || !pieces.PairedArrays || numPieces < 1)
+    {
+    numPieces = 1;
+    }
+  pieces.NumberOfPieces = static_cast<int>(numPieces);
+  pieces.PointOffsets.resize(numPieces + 1);
+  pieces.CellOffsets.resize(numPieces + 1);
+  pieces.ConnectivityOffsets.resize(numPieces + 1);
+  pieces.PointOffsets[0] = pieces.CellOffsets[0] = 0;
+  pieces.ConnectivityOffsets[0] = 0;
+  for (int piece = 0; piece < pieces.NumberOfPieces; piece++)
+    {
+    vtkIdType numNewPts = 0, numNewCells = 0, numEntries = 0;
+    vtkIdType last = numPts*(piece + 1)/numPieces;
+    for (inPtId = numPts*piece/numPieces; inPtId < last; inPtId++)
+      {
+      int index = pieces.Indices[inPtId];
+      if (index < 0)
+        {
+        continue;
+        }
+      if (this->GenerateInstances)
+        {
+        numNewPts++;
+        numNewCells++;
+        numEntries += 2;
+        }
+      else
+        {
+        vtkGlyph3DGlyph &glyph = pieces.Glyphs[index];
+        numNewPts += glyph.NumberOfPoints;
+        numNewCells += glyph.NumberOfCells;
+        numEntries += static_cast<vtkIdType>(glyph.Cells.size());
+        }
+      }
+    pieces.PointOffsets[piece+1] = pieces.PointOffsets[piece] + numNewPts;
+    pieces.CellOffsets[piece+1] = pieces.CellOffsets[piece] + numNewCells;
+    pieces.ConnectivityOffsets[piece+1] =
+      pieces.ConnectivityOffsets[piece] + numEntries;
+    }
+  vtkIdType numNewPts = pieces.PointOffsets[numPieces];
+  vtkIdType numNewCells = pieces.CellOffsets[numPieces];
+
+  // Allocate the output to its exact size, with the arrays of
+  // RequestData() in the same order.
+  if (pieces.InPD)
+    {
+    outputPD->CopyAllocate(pd, numNewPts);
+    vtkGlyph3DSetNumberOfTuples(outputPD, numNewPts);
+    if (this->FillCellData)
+      {
+      outputCD->CopyAllocate(pd, numNewCells);
+      vtkGlyph3DSetNumberOfTuples(outputCD, numNewCells);
+      }
+    }
+  vtkPoints *newPts = vtkPoints::New();
+  newPts->SetNumberOfPoints(numNewPts);
+  pieces.NewPoints = static_cast<float *>(newPts->GetVoidPointer(0));
+  vtkIdTypeArray *newCells = vtkIdTypeArray::New();
+  newCells->SetNumberOfTuples(pieces.ConnectivityOffsets[numPieces]);
+  pieces.NewCells = newCells->GetPointer(0);
+
+  vtkIdTypeArray *pointIds = NULL;
+  pieces.PointIds = NULL;
+  if ( this->GeneratePointIds )
+    {
+    pointIds = vtkIdTypeArray::New();
+    pointIds->SetName(this->PointIdsName);
+    pointIds->SetNumberOfTuples(numNewPts);
+    outputPD->AddArray(pointIds);
+    pointIds->Delete();
+    pieces.PointIds = pointIds->GetPointer(0);
+    }
+  if (pieces.InPD && pieces.PairedArrays)
+    {
+    vtkGlyph3DPairArrays(pd, outputPD, pointIds, pieces.PointFrom,
+                         pieces.PointTo);
+    vtkGlyph3DPairArrays(pd, outputCD, NULL, pieces.CellFrom,
+                         pieces.CellTo);
+    }
+
+  vtkDataArray *newScalars =
+    this->NewGlyphScalars(inSScalars, inCScalars, (pieces.Vectors != NULL));
+  if (newScalars)
+    {
+    newScalars->SetNumberOfTuples(numNewPts);
+    }
+  pieces.NewScalars = newScalars;
+  pieces.NewVectors = pieces.NewNormals = pieces.NewTCoords = NULL;
+  if ( pieces.Vectors )
+    {
+    pieces.NewVectors = vtkFloatArray::New();
+    pieces.NewVectors->SetNumberOfComponents(3);
+    pieces.NewVectors->SetNumberOfTuples(numNewPts);
+    pieces.NewVectors->SetName("GlyphVector");
+    }
+  if ( haveNormals )
+    {
+    pieces.NewNormals = vtkFloatArray::New();
+    pieces.NewNormals->SetNumberOfComponents(3);
+    pieces.NewNormals->SetNumberOfTuples(numNewPts);
+    pieces.NewNormals->SetName("Normals");
+    }
+  if ( !this->GenerateInstances && pieces.Glyphs[0].TCoords )
+    {
+    pieces.NewTCoords = vtkFloatArray::New();
+    pieces.NewTCoords->SetNumberOfComponents(
+      pieces.Glyphs[0].TCoords->GetNumberOfComponents());
+    pieces.NewTCoords->SetNumberOfTuples(numNewPts);
+    pieces.NewTCoords->SetName("TCoords");
+    }
+
+  vtkDoubleArray *transforms = NULL;
+  vtkIntArray *glyphIndices = NULL;
+  pieces.Transforms = NULL;
+  pieces.GlyphIndices = NULL;
+  if (this->GenerateInstances)
+    {
+    transforms = vtkDoubleArray::New();
+    transforms->SetName("GlyphTransform");
+    transforms->SetNumberOfComponents(16);
+    transforms->SetNumberOfTuples(numNewPts);
+    pieces.Transforms = transforms->GetPointer(0);
+    if (this->IndexMode != VTK_INDEXING_OFF)
+      {
+      glyphIndices = vtkIntArray::New();
+      glyphIndices->SetName("GlyphIndex");
+      glyphIndices->SetNumberOfTuples(numNewPts);
+      pieces.GlyphIndices = glyphIndices->GetPointer(0);
+      }
+    }
+
+  // Build, from this thread, what the input builds on its first use, so
+  // that the threads only read it.
+  input->PrepareForThreadedAccess();
+  vtkMultiThreader *threader = vtkMultiThreader::New();
+  threader->UseThreadPoolOn();
+  threader->SetNumberOfThreads(this->NumberOfThreads);
+  threader->SetNumberOfPieces(pieces.NumberOfPieces);
+  threader->SetSingleMethod(vtkGlyph3DPieces::Execute, &pieces);
+  threader->SingleMethodExecute();
+  threader->Delete();
+
+  // Update ourselves and release memory
+  //
+  output->SetPoints(newPts);
+  newPts->Delete();
+  if (cellKind >= 0)
+    {
+    vtkCellArray *cells = vtkCellArray::New();
+    cells->SetCells(numNewCells, newCells);
+    switch (cellKind)
+      {
+      case 0:
+        output->SetVerts(cells);
+        break;
+      case 1:
+        output->SetLines(cells);
+        break;
+      case 2:
+        output->SetPolys(cells);
+        break;
+      default:
+        output->SetStrips(cells);
+      }
+    cells->Delete();
+    }
+  newCells->Delete();
+
+  if (newScalars)
+    {
+    int idx = outputPD->AddArray(newScalars);
+    outputPD->SetActiveAttribute(idx, vtkDataSetAttributes::SCALARS);
+    newScalars->Delete();
+    }
+  if (pieces.NewVectors)
+    {
+    outputPD->SetVectors(pieces.NewVectors);
+    pieces.NewVectors->Delete();
+    }
+  if (pieces.NewNormals)
+    {
+    outputPD->SetNormals(pieces.NewNormals);
+    pieces.NewNormals->Delete();
+    }
+  if (pieces.NewTCoords)
+    {
+    outputPD->SetTCoords(pieces.NewTCoords);
+    pieces.NewTCoords->Delete();
+    }
+  if (transforms)
+    {
+    outputPD->AddArray(transforms);
+    transforms->Delete();
+    }
+  if (glyphIndices)
+    {
+    outputPD->AddArray(glyphIndices);
+    glyphIndices->Delete();
+    }
+  return 1;
+}
+
 //----------------------------------------------------------------------------
 // Specify a source object at a specified table location.
 void vtkGlyph3D::SetSourceConnection(int id, vtkAlgorithmOutput* algOutput)
@@ -801,6 +1536,9 @@ void vtkGlyph3D::PrintSelf(ostream& os, vtkIndent indent)
     }
 
   os << indent << "Fill Cell Data: " << (this->FillCellData ? "On\n" : "Off\n");
+  os << indent << "Generate Instances: "
+     << (this->GenerateInstances ? "On\n" : "Off\n");
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << "\n";
 }
 
 int vtkGlyph3D::RequestUpdateExtent(
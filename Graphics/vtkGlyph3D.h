@@ -65,6 +65,22 @@
 // color scalars by using the SetInputArrayToProcess methods in
 // vtkAlgorithm. The first array is scalars, the next vectors, the next
 // normals and finally color scalars.
+//
+// With many input points and NumberOfThreads greater than one, a first
+// pass decides which glyph each point gets and counts the output points
+// and cells, the output arrays are allocated to their exact size, and the
+// points are then split into runs which threads glyph concurrently, each
+// writing its glyphs in place. The output is the same as the serial one.
+// Sources mixing vertices, lines, polygons and strips, or cells whose type
+// their number of points does not give, are glyphed serially, to keep
+// their order and types.
+//
+// Instead of copying the glyphs, GenerateInstances makes the output hold
+// one vertex per glyph, at the input point, with the 4x4 matrix placing
+// the glyph source there in the "GlyphTransform" point array (16 values,
+// row by row) and, with a table of glyphs, the index of the source in the
+// "GlyphIndex" array. The glyph geometry stays in the sources, for
+// renderers drawing the same geometry many times.
 
 // .SECTION See Also
 // vtkTensorGlyph
@@ -91,6 +107,8 @@
 #define VTK_INDEXING_BY_SCALAR 1
 #define VTK_INDEXING_BY_VECTOR 2
 
+class vtkTransform;
+
 class VTK_GRAPHICS_EXPORT vtkGlyph3D : public vtkPolyDataAlgorithm
 {
 public:
@@ -228,6 +246,21 @@ public:
   vtkGetMacro(FillCellData,int);
   vtkBooleanMacro(FillCellData,int);
 
+  // Description:
+  // Enable/disable the output of one vertex per glyph with the matrix
+  // placing the glyph source, instead of the glyph geometry (see the class
+  // description). The scalars, vectors, point ids and copied point data
+  // are those of the glyph; the source normals and texture coordinates are
+  // not output. Off by default.
+  vtkSetMacro(GenerateInstances,int);
+  vtkGetMacro(GenerateInstances,int);
+  vtkBooleanMacro(GenerateInstances,int);
+
+  // Description:
+  // Set/get the number of threads glyphing the points. Defaults to 1.
+  vtkSetClampMacro(NumberOfThreads, int, 1, VTK_LARGE_INTEGER);
+  vtkGetMacro(NumberOfThreads, int);
+
   // Description:
   // This can be overwritten by subclass to return 0 when a point is
   // blanked. Default implementation is to always return 1;
@@ -243,6 +276,39 @@ protected:
 
   vtkPolyData* GetSource(int idx, vtkInformationVector *sourceInfo);
 
+  // Description:
+  // Glyph the points in runs, with NumberOfThreads threads, as instances
+  // or as geometry, using the arrays and ghost levels selected by
+  // RequestData(). Returns 0, without changing the output, if the glyph
+  // geometry has to be copied serially.
+  int GlyphInPieces(vtkDataSet *input, vtkInformationVector *sourceVector,
+                    vtkPolyData *output, vtkDataArray *inSScalars,
+                    vtkDataArray *inVectors, vtkDataArray *inNormals,
+                    vtkDataArray *inCScalars, unsigned char *inGhostLevels,
+                    int requestedGhostLevel);
+
+  // Description:
+  // The steps of glyphing a point that RequestData() and the threads of
+  // GlyphInPieces() share. They only read the filter, so that the threads
+  // can call them at once. SelectGlyphVectors() returns the vectors or
+  // normals orienting and scaling the glyphs as VectorMode selects them,
+  // or NULL. GetGlyphScale() returns the scale of the glyph of a point,
+  // clamped if enabled, its vector, and the scalar and vector magnitude
+  // that GetGlyphIndex() turns into the index of its glyph in the table.
+  // TransformGlyph() sets the transform placing the glyph at the point x.
+  // NewGlyphScalars() returns the empty array of the output scalars
+  // ColorMode selects, or NULL.
+  vtkDataArray *SelectGlyphVectors(vtkDataArray *inVectors,
+                                   vtkDataArray *inNormals);
+  void GetGlyphScale(vtkIdType inPtId, vtkDataArray *inSScalars,
+                     vtkDataArray *vectors, double den, double scale[3],
+                     double v[3], double &s, double &vMag);
+  int GetGlyphIndex(double s, double vMag, int numberOfSources, double den);
+  void TransformGlyph(vtkTransform *trans, double x[3], double v[3],
+                      double vMag, int haveVectors, double scale[3]);
+  vtkDataArray *NewGlyphScalars(vtkDataArray *inSScalars,
+                                vtkDataArray *inCScalars, int haveVectors);
+
   vtkPolyData **Source; // Geometry to copy to each point
   int Scaling; // Determine whether scaling of geometry is performed
   int ScaleMode; // Scale by scalar value or vector magnitude
@@ -256,7 +322,12 @@ protected:
   int GeneratePointIds; // produce input points ids for each output point
   int FillCellData; // whether to fill output cell data
   char *PointIdsName;
+  int GenerateInstances; // output the glyph matrices instead of geometry
+  int NumberOfThreads;
 
+  //BTX
+  friend class vtkGlyph3DPieces;
+  //ETX
 private:
   vtkGlyph3D(const vtkGlyph3D&);  // Not implemented.
   void operator=(const vtkGlyph3D&);  // Not implemented.
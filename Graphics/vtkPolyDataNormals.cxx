@@ -17,9 +17,11 @@
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
 #include "vtkFloatArray.h"
+#include "vtkIdList.h"
 #include "vtkMath.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkMultiThreader.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
@@ -27,6 +29,15 @@
 #include "vtkTriangleStrip.h"
 #include "vtkPriorityQueue.h"
 
+#include <vtkstd/vector>
+
+// The smallest run of polygons or points a thread processes, the smallest
+// run of polygons of a wave (waves are only as long as the front of the
+// traversal), and the number of runs per thread.
+#define VTK_POLY_DATA_NORMALS_MIN_PIECE_SIZE 2000
+#define VTK_POLY_DATA_NORMALS_MIN_WAVE_PIECE_SIZE 250
+#define VTK_POLY_DATA_NORMALS_PIECES_PER_THREAD 4
+
 vtkStandardNewMacro(vtkPolyDataNormals);
 
 // Construct with feature angle=30, splitting and consistency turned on, 
@@ -41,13 +52,44 @@ vtkPolyDataNormals::vtkPolyDataNormals()
   this->ComputeCellNormals = 0;
   this->NonManifoldTraversal = 1;
   this->AutoOrientNormals = 0;
+  this->NumberOfThreads = 1;
   // some internal data
   this->NumFlips = 0;
+  this->UseThreads = 0;
 }
 
 #define VTK_CELL_NOT_VISITED     0
 #define VTK_CELL_VISITED         1
 
+// The state shared by the threads of a pass of vtkPolyDataNormals. Each
+// piece is a run of the items of the pass (polygons of the wave, polygons
+// or points), and may leave its results in its own list, for the filter
+// to use in the order of the pieces.
+class vtkPolyDataNormalsPieces
+{
+public:
+  enum { WAVE, POLY_NORMALS, REGIONS, POINT_NORMALS };
+
+  vtkPolyDataNormals *Self;
+  int Pass;
+  vtkIdType NumberOfItems;
+  int NumberOfPieces;
+  vtkstd::vector<vtkstd::vector<vtkIdType> > Results;
+
+  // For the point normals.
+  vtkIdType NumberOfInputPoints;
+  float *Normals;
+  double FlipDirection;
+
+  void Run(int pass, vtkIdType numItems);
+  void WavePiece(int piece, vtkIdList *cellIds);
+  void PolyNormalsPiece(int piece);
+  void RegionsPiece(int piece, int *visited, vtkIdList *cellIds);
+  void PointNormalsPiece(int piece);
+  void SumPolyNormals(vtkIdType ptId, float sum[3]);
+  static VTK_THREAD_RETURN_TYPE Execute(void *arg);
+};
+
 // Generate normals for polygon meshes
 int vtkPolyDataNormals::RequestData(
   vtkInformation *vtkNotUsed(request),
@@ -158,6 +200,13 @@ int vtkPolyDataNormals::RequestData(
   this->NewMesh->SetPolys(newPolys);
   this->NewMesh->BuildCells(); //builds connectivity
 
+  // Many polygons are processed by threads, if their points can be handed
+  // out in place.
+  this->UseThreads = ( this->NumberOfThreads > 1 &&
+                       numPolys >= 2*VTK_POLY_DATA_NORMALS_MIN_PIECE_SIZE &&
+                       !polys->GetCellNeedsBuffer() &&
+                       !newPolys->GetCellNeedsBuffer() );
+
   // The visited array keeps track of which polygons have been visited.
   //
   if ( this->Consistency || this->Splitting || this->AutoOrientNormals ) 
@@ -316,19 +365,28 @@ int vtkPolyDataNormals::RequestData(
   this->PolyNormals->SetName("Normals");
   this->PolyNormals->SetNumberOfTuples(numPolys);
 
-  for (cellId=0, newPolys->InitTraversal(); newPolys->GetNextCell(npts,pts); 
-       cellId++ )
+  if ( this->UseThreads )
+    {
+    vtkPolyDataNormalsPieces pieces;
+    pieces.Self = this;
+    pieces.Run(vtkPolyDataNormalsPieces::POLY_NORMALS, numPolys);
+    }
+  else
     {
-    if ((cellId % 1000) == 0)
+    for (cellId=0, newPolys->InitTraversal(); newPolys->GetNextCell(npts,pts); 
+         cellId++ )
       {
-      this->UpdateProgress (0.333 + 0.333 * (double) cellId / (double) numPolys);
-      if (this->GetAbortExecute())
+      if ((cellId % 1000) == 0)
         {
-        break; 
+        this->UpdateProgress (0.333 + 0.333 * (double) cellId / (double) numPolys);
+        if (this->GetAbortExecute())
+          {
+          break; 
+          }
         }
+      vtkPolygon::ComputeNormal(inPts, npts, pts, n);
+      this->PolyNormals->SetTuple(cellId,n);
       }
-    vtkPolygon::ComputeNormal(inPts, npts, pts, n);
-    this->PolyNormals->SetTuple(cellId,n);
     }
 
   // Split mesh if sharp features
@@ -349,10 +407,17 @@ int vtkPolyDataNormals::RequestData(
       this->Map->SetId(i,i);
       }
 
-    for (ptId=0; ptId < numPts; ptId++)
+    if ( this->UseThreads )
+      {
+      this->ThreadedSplit(numPts);
+      }
+    else
       {
-      this->MarkAndSplit(ptId);
-      }//for all input points
+      for (ptId=0; ptId < numPts; ptId++)
+        {
+        this->MarkAndSplit(ptId);
+        }//for all input points
+      }
 
     numNewPts = this->Map->GetNumberOfIds();
 
@@ -370,7 +435,6 @@ int vtkPolyDataNormals::RequestData(
       newPts->SetPoint(ptId,inPts->GetPoint(oldId));
       outPD->CopyData(pd,oldId,ptId);
       }
-    this->Map->Delete();
     } //splitting
 
   else //no splitting, so no new points
@@ -406,7 +470,11 @@ int vtkPolyDataNormals::RequestData(
     newNormals->SetTuple(i,n);
     }
 
-  if (this->ComputePointNormals)
+  if (this->ComputePointNormals && this->UseThreads)
+    {
+    this->ThreadedPointNormals(newNormals, numNewPts, flipDirection);
+    }
+  else if (this->ComputePointNormals)
     {
     for (cellId=0, newPolys->InitTraversal(); newPolys->GetNextCell(npts,pts); 
           cellId++ )
@@ -438,6 +506,10 @@ int vtkPolyDataNormals::RequestData(
       newNormals->SetTuple(i,n);
       }
     }
+  if ( this->Splitting )
+    {
+    this->Map->Delete();
+    }
 
   //  Update ourselves.  If no new nodes have been created (i.e., no
   //  splitting), we can simply pass data through.
@@ -494,53 +566,61 @@ void vtkPolyDataNormals::TraverseAndOrder (void)
   // propagate wave until nothing left in wave
   while ( (numIds=this->Wave->GetNumberOfIds()) > 0 )
     {
-    for ( i=0; i < numIds; i++ )
+    if ( this->UseThreads &&
+         numIds >= 2*VTK_POLY_DATA_NORMALS_MIN_WAVE_PIECE_SIZE )
       {
-      cellId = this->Wave->GetId(i);
-
-      this->NewMesh->GetCellPoints(cellId, npts, pts);
-
-      for (j=0; j < npts; j++) //for each edge neighbor
+      this->ThreadedWave();
+      }
+    else
+      {
+      for ( i=0; i < numIds; i++ )
         {
-        p1 = pts[j];
-        p2 = pts[(j+1)%npts];
+        cellId = this->Wave->GetId(i);
 
-        this->OldMesh->GetCellEdgeNeighbors(cellId, p1, p2, this->CellIds);
+        this->NewMesh->GetCellPoints(cellId, npts, pts);
 
-        //  Check the direction of the neighbor ordering.  Should be
-        //  consistent with us (i.e., if we are n1->n2, 
-        // neighbor should be n2->n1).
-        if ( this->CellIds->GetNumberOfIds() == 1 ||
-             this->NonManifoldTraversal )
+        for (j=0; j < npts; j++) //for each edge neighbor
           {
-          for (k=0; k < this->CellIds->GetNumberOfIds(); k++) 
+          p1 = pts[j];
+          p2 = pts[(j+1)%npts];
+
+          this->OldMesh->GetCellEdgeNeighbors(cellId, p1, p2, this->CellIds);
+
+          //  Check the direction of the neighbor ordering.  Should be
+          //  consistent with us (i.e., if we are n1->n2, 
+          // neighbor should be n2->n1).
+          if ( this->CellIds->GetNumberOfIds() == 1 ||
+               this->NonManifoldTraversal )
             {
-            if (this->Visited[this->CellIds->GetId(k)]==VTK_CELL_NOT_VISITED) 
+            for (k=0; k < this->CellIds->GetNumberOfIds(); k++) 
               {
-              neighbor = this->CellIds->GetId(k);
-              this->NewMesh->GetCellPoints(neighbor,numNeiPts,neiPts);
-              for (l=0; l < numNeiPts; l++)
+              if (this->Visited[this->CellIds->GetId(k)]==VTK_CELL_NOT_VISITED) 
                 {
-                if (neiPts[l] == p2)
+                neighbor = this->CellIds->GetId(k);
+                this->NewMesh->GetCellPoints(neighbor,numNeiPts,neiPts);
+                for (l=0; l < numNeiPts; l++)
                   {
-                  break;
+                  if (neiPts[l] == p2)
+                    {
+                    break;
+                    }
                   }
-                }
 
-              //  Have to reverse ordering if neighbor not consistent
-              //
-              if ( neiPts[(l+1)%numNeiPts] != p1 ) 
-                {
-                this->NumFlips++;
-                this->NewMesh->ReverseCell(neighbor);
-                }
-              this->Visited[neighbor] = VTK_CELL_VISITED; 
-              this->Wave2->InsertNextId(neighbor);
-              }// if cell not visited
-            } // for each edge neighbor
-          } //for manifold or non-manifold traversal allowed
-        } // for all edges of this polygon
-      } //for all cells in wave
+                //  Have to reverse ordering if neighbor not consistent
+                //
+                if ( neiPts[(l+1)%numNeiPts] != p1 ) 
+                  {
+                  this->NumFlips++;
+                  this->NewMesh->ReverseCell(neighbor);
+                  }
+                this->Visited[neighbor] = VTK_CELL_VISITED; 
+                this->Wave2->InsertNextId(neighbor);
+                }// if cell not visited
+              } // for each edge neighbor
+            } //for manifold or non-manifold traversal allowed
+          } // for all edges of this polygon
+        } //for all cells in wave
+      }
 
     //swap wave and proceed with propagation
     tmpWave = this->Wave;
@@ -552,11 +632,84 @@ void vtkPolyDataNormals::TraverseAndOrder (void)
   return;
 }
 
+//
+//  Propagate one wave of TraverseAndOrder(). The threads list, for the
+//  polygons of the wave in order, the unvisited edge neighbors and whether
+//  to reverse them; the neighbors are then visited in that order, so the
+//  first polygon reaching a neighbor orders it, as in the serial wave.
+//
+void vtkPolyDataNormals::ThreadedWave (void)
+{
+  vtkPolyDataNormalsPieces pieces;
+  pieces.Self = this;
+  pieces.Run(vtkPolyDataNormalsPieces::WAVE, this->Wave->GetNumberOfIds());
+
+  for (int piece = 0; piece < pieces.NumberOfPieces; piece++)
+    {
+    vtkstd::vector<vtkIdType> &claims = pieces.Results[piece];
+    for (size_t c = 0; c < claims.size(); c += 2)
+      {
+      vtkIdType neighbor = claims[c];
+      if ( this->Visited[neighbor] == VTK_CELL_NOT_VISITED )
+        {
+        if ( claims[c+1] )
+          {
+          this->NumFlips++;
+          this->NewMesh->ReverseCell(neighbor);
+          }
+        this->Visited[neighbor] = VTK_CELL_VISITED;
+        this->Wave2->InsertNextId(neighbor);
+        }
+      }
+    }
+}
+
 //
 //  Mark polygons around vertex.  Create new vertex (if necessary) and
 //  replace (i.e., split mesh).
 //
 void vtkPolyDataNormals::MarkAndSplit (vtkIdType ptId)
+{
+  int j;
+
+  // Mark the regions of the cells using this point and make sure that we
+  // have to do something
+  int numRegions = this->MarkRegions(ptId, this->Visited, this->CellIds);
+  if ( numRegions <=1 )
+    {
+    return; //a single region, no splitting ever required
+    }
+
+  // Okay, for all cells not in the first region, the ptId is
+  // replaced with a new ptId, which is a duplicate of the first
+  // point, but disconnected topologically.
+  //
+  unsigned short ncells;
+  vtkIdType *cells;
+  this->OldMesh->GetPointCells(ptId,ncells,cells);
+  vtkIdType lastId = this->Map->GetNumberOfIds();
+  vtkIdType replacementPoint;
+  for (j=0; j<ncells; j++)
+    {
+    if (this->Visited[cells[j]] > 0 ) //replace point if splitting needed
+      {
+      replacementPoint = lastId + this->Visited[cells[j]] - 1;
+      
+      this->Map->InsertId(replacementPoint, ptId);
+
+      //replace ptId with split point
+      this->NewMesh->ReplaceCellPoint(cells[j], ptId, replacementPoint);
+      }//if not in first regions and requiring splitting
+    }//for all cells connected to ptId
+
+  return;
+}
+
+//
+//  Mark the region of each polygon around vertex.
+//
+int vtkPolyDataNormals::MarkRegions (vtkIdType ptId, int *visited,
+                                     vtkIdList *cellIds)
 {
   int i,j;
 
@@ -566,7 +719,7 @@ void vtkPolyDataNormals::MarkAndSplit (vtkIdType ptId)
   this->OldMesh->GetPointCells(ptId,ncells,cells);
   if ( ncells <= 1 )
     {
-    return; //point does not need to be further disconnected
+    return ncells; //point does not need to be further disconnected
     }
 
   // Start moving around the "cycle" of points using the point. Label
@@ -579,7 +732,7 @@ void vtkPolyDataNormals::MarkAndSplit (vtkIdType ptId)
   // Start by initializing the cells as unvisited
   for (i=0; i<ncells; i++)
     {
-    this->Visited[cells[i]] = -1;
+    visited[cells[i]] = -1;
     }
 
   // Loop over all cells and mark the region that each is in.
@@ -591,9 +744,9 @@ void vtkPolyDataNormals::MarkAndSplit (vtkIdType ptId)
   double thisNormal[3], neiNormal[3];
   for (j=0; j<ncells; j++) //for all cells connected to point
     {
-    if ( this->Visited[cells[j]] < 0 ) //for all unvisited cells
+    if ( visited[cells[j]] < 0 ) //for all unvisited cells
       {
-      this->Visited[cells[j]] = numRegions;
+      visited[cells[j]] = numRegions;
       //okay, mark all the cells connected to this seed cell and using ptId
       this->OldMesh->GetCellPoints(cells[j],numPts,pts);
 
@@ -628,9 +781,9 @@ void vtkPolyDataNormals::MarkAndSplit (vtkIdType ptId)
         nei = neiPt[i];
         while ( cellId >= 0 ) //while we can grow this region
           {
-          this->OldMesh->GetCellEdgeNeighbors(cellId,ptId,nei,this->CellIds);
-          if ( this->CellIds->GetNumberOfIds() == 1 && 
-               this->Visited[(neiCellId=this->CellIds->GetId(0))] < 0 )
+          this->OldMesh->GetCellEdgeNeighbors(cellId,ptId,nei,cellIds);
+          if ( cellIds->GetNumberOfIds() == 1 && 
+               visited[(neiCellId=cellIds->GetId(0))] < 0 )
             {
             this->PolyNormals->GetTuple(cellId, thisNormal);
             this->PolyNormals->GetTuple(neiCellId, neiNormal);
@@ -638,7 +791,7 @@ void vtkPolyDataNormals::MarkAndSplit (vtkIdType ptId)
             if ( vtkMath::Dot(thisNormal,neiNormal) > CosAngle )
               {
               //visit and arrange to visit next edge neighbor
-              this->Visited[neiCellId] = numRegions;
+              visited[neiCellId] = numRegions;
               cellId = neiCellId;
               this->OldMesh->GetCellPoints(cellId,numPts,pts);
 
@@ -678,39 +831,294 @@ void vtkPolyDataNormals::MarkAndSplit (vtkIdType ptId)
       numRegions++;
       }//if cell is unvisited
     }//for all cells connected to point ptId
-  
-  if ( numRegions <=1 )
+
+  return numRegions;
+}
+
+//
+//  Split the points as MarkAndSplit() does. The threads mark the regions
+//  around the points and list, for each point to split, the cells not in
+//  the first region with their region; the points are then split in order.
+//
+void vtkPolyDataNormals::ThreadedSplit (vtkIdType numPts)
+{
+  vtkPolyDataNormalsPieces pieces;
+  pieces.Self = this;
+  pieces.Run(vtkPolyDataNormalsPieces::REGIONS, numPts);
+
+  for (int piece = 0; piece < pieces.NumberOfPieces; piece++)
     {
-    return; //a single region, no splitting ever required
+    vtkstd::vector<vtkIdType> &splits = pieces.Results[piece];
+    size_t s = 0;
+    while (s < splits.size())
+      {
+      vtkIdType ptId = splits[s++];
+      vtkIdType numCells = splits[s++];
+      vtkIdType lastId = this->Map->GetNumberOfIds();
+      for (vtkIdType c = 0; c < numCells; c++, s += 2)
+        {
+        vtkIdType replacementPoint = lastId + splits[s+1] - 1;
+        this->Map->InsertId(replacementPoint, ptId);
+
+        this->NewMesh->ReplaceCellPoint(splits[s], ptId, replacementPoint);
+        }
+      }
     }
+}
 
-  // Okay, for all cells not in the first region, the ptId is
-  // replaced with a new ptId, which is a duplicate of the first
-  // point, but disconnected topologically.
-  //
-  vtkIdType lastId = this->Map->GetNumberOfIds();
-  vtkIdType replacementPoint;
-  for (j=0; j<ncells; j++)
+//
+//  Compute the point normals as RequestData() does. A point that no
+//  polygon uses, or whose polygon normals cancel, keeps the normal the
+//  serial loop leaves it: that of the previous point or, for the first
+//  point, the sum accumulated last.
+//
+void vtkPolyDataNormals::ThreadedPointNormals (vtkFloatArray *newNormals,
+                                               vtkIdType numNewPts,
+                                               double flipDirection)
+{
+  vtkPolyDataNormalsPieces pieces;
+  pieces.Self = this;
+  pieces.NumberOfInputPoints = this->OldMesh->GetNumberOfPoints();
+  pieces.Normals = newNormals->GetPointer(0);
+  pieces.FlipDirection = flipDirection;
+  pieces.Run(vtkPolyDataNormalsPieces::POINT_NORMALS, numNewPts);
+
+  vtkIdType numPolys = this->NewMesh->GetNumberOfPolys();
+  vtkIdType npts, *pts;
+  float previous[3];
+  this->NewMesh->GetCellPoints(numPolys-1, npts, pts);
+  pieces.SumPolyNormals(pts[npts-1], previous);
+  float *normal = pieces.Normals;
+  for (vtkIdType i=0; i < numNewPts; i++, normal += 3)
     {
-    if (this->Visited[cells[j]] > 0 ) //replace point if splitting needed
+    if ( normal[0] == 0.0 && normal[1] == 0.0 && normal[2] == 0.0 )
       {
-      replacementPoint = lastId + this->Visited[cells[j]] - 1;
-      
-      this->Map->InsertId(replacementPoint, ptId);
+      normal[0] = previous[0];
+      normal[1] = previous[1];
+      normal[2] = previous[2];
+      }
+    previous[0] = normal[0];
+    previous[1] = normal[1];
+    previous[2] = normal[2];
+    }
+}
 
-      this->NewMesh->GetCellPoints(cells[j],numPts,pts);
-      for (i=0; i < numPts; i++) 
+//----------------------------------------------------------------------------
+void vtkPolyDataNormalsPieces::Run(int pass, vtkIdType numItems)
+{
+  vtkPolyDataNormals *self = this->Self;
+  this->Pass = pass;
+  this->NumberOfItems = numItems;
+  vtkIdType numPieces = numItems/(pass == WAVE ?
+                                  VTK_POLY_DATA_NORMALS_MIN_WAVE_PIECE_SIZE :
+                                  VTK_POLY_DATA_NORMALS_MIN_PIECE_SIZE);
+  if (numPieces > VTK_POLY_DATA_NORMALS_PIECES_PER_THREAD*self->NumberOfThreads)
+    {
+    numPieces = VTK_POLY_DATA_NORMALS_PIECES_PER_THREAD*self->NumberOfThreads;
+    }
+  this->NumberOfPieces = static_cast<int>(numPieces > 1 ? numPieces : 1);
+  this->Results.clear();
+  this->Results.resize(this->NumberOfPieces);
+
+  vtkMultiThreader *threader = vtkMultiThreader::New();
+  threader->UseThreadPoolOn();
+  threader->SetNumberOfThreads(self->NumberOfThreads);
+  threader->SetNumberOfPieces(this->NumberOfPieces);
+  threader->SetSingleMethod(vtkPolyDataNormalsPieces::Execute, this);
+  threader->SingleMethodExecute();
+  threader->Delete();
+}
+
+//----------------------------------------------------------------------------
+// List the unvisited edge neighbors of the polygons of the piece of the
+// wave, each followed by whether its ordering has to be reversed, as
+// TraverseAndOrder() decides it.
+void vtkPolyDataNormalsPieces::WavePiece(int piece, vtkIdList *cellIds)
+{
+  vtkPolyDataNormals *self = this->Self;
+  vtkIdType first = this->NumberOfItems*piece/this->NumberOfPieces;
+  vtkIdType last = this->NumberOfItems*(piece + 1)/this->NumberOfPieces;
+  vtkstd::vector<vtkIdType> &claims = this->Results[piece];
+  vtkIdType p1, p2, k, npts, *pts, numNeiPts, *neiPts;
+  int j, l;
+  for (vtkIdType i = first; i < last; i++)
+    {
+    vtkIdType cellId = self->Wave->GetId(i);
+    self->NewMesh->GetCellPoints(cellId, npts, pts);
+    for (j=0; j < npts; j++)
+      {
+      p1 = pts[j];
+      p2 = pts[(j+1)%npts];
+      self->OldMesh->GetCellEdgeNeighbors(cellId, p1, p2, cellIds);
+      if ( cellIds->GetNumberOfIds() == 1 || self->NonManifoldTraversal )
         {
-        if ( pts[i] == ptId ) 
+        for (k=0; k < cellIds->GetNumberOfIds(); k++)
           {
-          pts[i] = replacementPoint; // this is very nasty! direct write!
-          break;
+          vtkIdType neighbor = cellIds->GetId(k);
+          if (self->Visited[neighbor] == VTK_CELL_NOT_VISITED)
+            {
+            self->NewMesh->GetCellPoints(neighbor,numNeiPts,neiPts);
+            for (l=0; l < numNeiPts; l++)
+              {
+              if (neiPts[l] == p2)
+                {
+                break;
+                }
+              }
+            claims.push_back(neighbor);
+            claims.push_back(neiPts[(l+1)%numNeiPts] != p1);
+            }
           }
-        }//replace ptId with split point
-      }//if not in first regions and requiring splitting
-    }//for all cells connected to ptId
+        }
+      }
+    }
+}
 
-  return;
+//----------------------------------------------------------------------------
+void vtkPolyDataNormalsPieces::PolyNormalsPiece(int piece)
+{
+  vtkPolyDataNormals *self = this->Self;
+  vtkIdType first = this->NumberOfItems*piece/this->NumberOfPieces;
+  vtkIdType last = this->NumberOfItems*(piece + 1)/this->NumberOfPieces;
+  vtkPoints *inPts = self->NewMesh->GetPoints();
+  vtkIdType npts, *pts;
+  double n[3];
+  for (vtkIdType cellId = first; cellId < last; cellId++)
+    {
+    self->NewMesh->GetCellPoints(cellId, npts, pts);
+    vtkPolygon::ComputeNormal(inPts, npts, pts, n);
+    self->PolyNormals->SetTuple(cellId,n);
+    }
+}
+
+//----------------------------------------------------------------------------
+// List each point of the piece to split, with its number of cells not in
+// the first region, then these cells with their region.
+void vtkPolyDataNormalsPieces::RegionsPiece(int piece, int *visited,
+                                            vtkIdList *cellIds)
+{
+  vtkPolyDataNormals *self = this->Self;
+  vtkIdType first = this->NumberOfItems*piece/this->NumberOfPieces;
+  vtkIdType last = this->NumberOfItems*(piece + 1)/this->NumberOfPieces;
+  vtkstd::vector<vtkIdType> &splits = this->Results[piece];
+  unsigned short ncells;
+  vtkIdType *cells;
+  for (vtkIdType ptId = first; ptId < last; ptId++)
+    {
+    if ( self->MarkRegions(ptId, visited, cellIds) <= 1 )
+      {
+      continue;
+      }
+    self->OldMesh->GetPointCells(ptId, ncells, cells);
+    splits.push_back(ptId);
+    size_t count = splits.size();
+    splits.push_back(0);
+    for (int j=0; j < ncells; j++)
+      {
+      if ( visited[cells[j]] > 0 )
+        {
+        splits.push_back(cells[j]);
+        splits.push_back(visited[cells[j]]);
+        splits[count]++;
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Sum the normals of the polygons using the point of the new mesh, in the
+// order and with the single precision of the serial accumulation.
+void vtkPolyDataNormalsPieces::SumPolyNormals(vtkIdType ptId, float sum[3])
+{
+  vtkPolyDataNormals *self = this->Self;
+  vtkIdType oldId = (ptId < this->NumberOfInputPoints ? ptId :
+                     self->Map->GetId(ptId));
+  unsigned short ncells;
+  vtkIdType *cells, npts, *pts;
+  double polyNormal[3];
+  self->OldMesh->GetPointCells(oldId, ncells, cells);
+  sum[0] = sum[1] = sum[2] = 0.0;
+  for (int c=0; c < ncells; c++)
+    {
+    if ( c > 0 && cells[c] == cells[c-1] )
+      {
+      continue; //a cell using the point twice is listed twice
+      }
+    self->NewMesh->GetCellPoints(cells[c], npts, pts);
+    self->PolyNormals->GetTuple(cells[c], polyNormal);
+    for (vtkIdType i=0; i < npts; i++)
+      {
+      if ( pts[i] == ptId )
+        {
+        for (int j=0; j < 3; j++)
+          {
+          sum[j] = static_cast<float>(sum[j] + polyNormal[j]);
+          }
+        }
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// Normalize the sums of the points of the piece, leaving zero the points
+// whose sum is zero.
+void vtkPolyDataNormalsPieces::PointNormalsPiece(int piece)
+{
+  vtkIdType first = this->NumberOfItems*piece/this->NumberOfPieces;
+  vtkIdType last = this->NumberOfItems*(piece + 1)/this->NumberOfPieces;
+  float sum[3];
+  double vertNormal[3], length;
+  for (vtkIdType ptId = first; ptId < last; ptId++)
+    {
+    this->SumPolyNormals(ptId, sum);
+    float *normal = this->Normals + 3*ptId;
+    vertNormal[0] = sum[0];
+    vertNormal[1] = sum[1];
+    vertNormal[2] = sum[2];
+    length = vtkMath::Norm(vertNormal);
+    for (int j=0; j < 3; j++)
+      {
+      normal[j] = (length != 0.0 ? static_cast<float>(
+                     vertNormal[j] / length * this->FlipDirection) : 0.0f);
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkPolyDataNormalsPieces::Execute(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *info =
+    static_cast<vtkMultiThreader::ThreadInfo *>(arg);
+  vtkPolyDataNormalsPieces *pieces =
+    static_cast<vtkPolyDataNormalsPieces *>(info->UserData);
+  vtkIdList *cellIds = vtkIdList::New();
+  cellIds->Allocate(VTK_CELL_SIZE);
+  int *visited = NULL;
+  if (pieces->Pass == REGIONS)
+    {
+    visited = new int[pieces->Self->OldMesh->GetNumberOfPolys()];
+    }
+  for (int piece = info->ThreadID; piece < pieces->NumberOfPieces;
+       piece += info->NumberOfThreads)
+    {
+    switch (pieces->Pass)
+      {
+      case WAVE:
+        pieces->WavePiece(piece, cellIds);
+        break;
+      case POLY_NORMALS:
+        pieces->PolyNormalsPiece(piece);
+        break;
+      case REGIONS:
+        pieces->RegionsPiece(piece, visited, cellIds);
+        break;
+      default:
+        pieces->PointNormalsPiece(piece);
+      }
+    }
+  delete [] visited;
+  cellIds->Delete();
+  return VTK_THREAD_RETURN_VALUE;
 }
 
 void vtkPolyDataNormals::PrintSelf(ostream& os, vtkIndent indent)
@@ -729,5 +1137,6 @@ void vtkPolyDataNormals::PrintSelf(ostream& os, vtkIndent indent)
      << (this->ComputeCellNormals ? "On\n" : "Off\n");
   os << indent << "Non-manifold Traversal: " 
      << (this->NonManifoldTraversal ? "On\n" : "Off\n");
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << "\n";
 }
 
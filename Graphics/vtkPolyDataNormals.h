@@ -24,6 +24,13 @@
 // averaging them at shared points. When sharp edges are present, the edges
 // are split and new points generated to prevent blurry edges (due to 
 // Gouraud shading).
+//
+// With many polygons and NumberOfThreads greater than one, the polygon
+// normals, the regions around each point that sharp edges split, and the
+// point normals are computed by threads over runs of polygons or points,
+// and each wave of the consistent ordering finds the neighbors of its
+// polygons concurrently, the polygons then being visited and reordered in
+// the serial order. The output is the same as the serial one.
 
 // .SECTION Caveats
 // Normals are computed only for polygons and triangle strips. Normals are
@@ -114,6 +121,11 @@ public:
   vtkSetMacro(NonManifoldTraversal,int);
   vtkGetMacro(NonManifoldTraversal,int);
   vtkBooleanMacro(NonManifoldTraversal,int);
+
+  // Description:
+  // Set/get the number of threads computing the normals. Defaults to 1.
+  vtkSetClampMacro(NumberOfThreads, int, 1, VTK_LARGE_INTEGER);
+  vtkGetMacro(NumberOfThreads, int);
   
 protected:
   vtkPolyDataNormals();
@@ -131,6 +143,7 @@ protected:
   int ComputePointNormals;
   int ComputeCellNormals;
   int NumFlips;
+  int NumberOfThreads;
 
 private:
   vtkIdList *Wave;
@@ -142,6 +155,7 @@ private:
   int *Visited;
   vtkFloatArray *PolyNormals;
   double CosAngle;
+  int UseThreads; // whether RequestData() runs the passes in threads
 
   // Uses the list of cell ids (this->Wave) to propagate a wave of
   // checked and properly ordered polygons.
@@ -152,6 +166,28 @@ private:
   // separate the mesh.
   void MarkAndSplit(vtkIdType ptId);
 
+  // Mark the cells using the point with the number of the region they are
+  // in, the regions being the groups of cells around the point not
+  // separated by feature edges. Returns the number of regions. Only reads
+  // the meshes, so threads may mark points at once with their own visited
+  // array and cell list.
+  int MarkRegions(vtkIdType ptId, int *visited, vtkIdList *cellIds);
+
+  // Propagate one wave of TraverseAndOrder() with threads.
+  void ThreadedWave(void);
+
+  // Split the points on feature edges as MarkAndSplit() does, marking the
+  // regions with threads.
+  void ThreadedSplit(vtkIdType numPts);
+
+  // Accumulate the polygon normals at the points of the new mesh with
+  // threads, and normalize them, as RequestData() does serially.
+  void ThreadedPointNormals(vtkFloatArray *newNormals, vtkIdType numNewPts,
+                            double flipDirection);
+
+  //BTX
+  friend class vtkPolyDataNormalsPieces;
+  //ETX
 private:
   vtkPolyDataNormals(const vtkPolyDataNormals&);  // Not implemented.
   void operator=(const vtkPolyDataNormals&);  // Not implemented.
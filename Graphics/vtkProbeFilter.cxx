@@ -16,17 +16,31 @@
 
 #include "vtkCellData.h"
 #include "vtkCell.h"
+#include "vtkCellLocator.h"
 #include "vtkCharArray.h"
+#include "vtkGenericCell.h"
 #include "vtkIdTypeArray.h"
 #include "vtkImageData.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkMultiThreader.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
+#include "vtkPointSet.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 
 #include <vtkstd/vector>
 
+#include <math.h>
+
+// Probe the points with several threads only when there are at least this
+// many per piece. The work is split into up to this many pieces per thread.
+#define VTK_PROBE_MIN_PIECE_POINTS 5000
+#define VTK_PROBE_PIECES_PER_THREAD 4
+
+// The average number of points per bin when sorting the points to probe.
+#define VTK_PROBE_POINTS_PER_BIN 16
+
 vtkStandardNewMacro(vtkProbeFilter);
 
 class vtkProbeFilter::vtkVectorOfArrays : 
@@ -51,6 +65,8 @@ vtkProbeFilter::vtkProbeFilter()
   this->CellList = 0;
 
   this->UseNullPoint = true;
+
+  this->NumberOfThreads = 1;
 }
 
 //----------------------------------------------------------------------------
@@ -230,17 +246,6 @@ void vtkProbeFilter::ProbeEmptyPoints(vtkDataSet *input,
   pd = source->GetPointData();
   cd = source->GetCellData();
 
-  // lets use a stack allocated array if possible for performance reasons
-  int mcs = source->GetMaxCellSize();
-  if (mcs<=256)
-    {
-    weights = fastweights;
-    }
-  else
-    {
-    weights = new double[mcs];
-    }
-
   numPts = input->GetNumberOfPoints();
   outPD = output->GetPointData();
 
@@ -268,6 +273,24 @@ void vtkProbeFilter::ProbeEmptyPoints(vtkDataSet *input,
   double minRes2 = minRes * minRes;
   tol2 = tol2 > minRes2 ? minRes2 : tol2;
 
+  if (this->NumberOfThreads > 1 &&
+      numPts >= 2*VTK_PROBE_MIN_PIECE_POINTS &&
+      this->ThreadedProbeEmptyPoints(input, srcIdx, source, output, tol2))
+    {
+    return;
+    }
+
+  // lets use a stack allocated array if possible for performance reasons
+  int mcs = source->GetMaxCellSize();
+  if (mcs<=256)
+    {
+    weights = fastweights;
+    }
+  else
+    {
+    weights = new double[mcs];
+    }
+
   // Loop over all input points, interpolating source data
   //
   int abort=0;
@@ -334,6 +357,320 @@ void vtkProbeFilter::ProbeEmptyPoints(vtkDataSet *input,
     }
 }
 
+//----------------------------------------------------------------------------
+// Sort the points of the input that remain to be probed into bins of a
+// regular grid over its bounds, so that consecutive points are close in
+// space.
+static void vtkProbeFilterSortPoints(vtkDataSet *input, const char *maskArray,
+                                     vtkstd::vector<vtkIdType> &order)
+{
+  vtkIdType numPts = input->GetNumberOfPoints();
+  double bounds[6], length[3], x[3];
+  input->GetBounds(bounds);
+
+  // Bins of the same width along the axes the points span.
+  int i, numAxes = 0;
+  double volume = 1.0;
+  for (i = 0; i < 3; i++)
+    {
+    length[i] = bounds[2*i+1] - bounds[2*i];
+    if (length[i] > 0.0)
+      {
+      volume *= length[i];
+      numAxes++;
+      }
+    }
+  int divs[3] = {1, 1, 1};
+  if (numAxes > 0)
+    {
+    double width = pow(volume*VTK_PROBE_POINTS_PER_BIN/numPts, 1.0/numAxes);
+    for (i = 0; i < 3; i++)
+      {
+      if (length[i] > 0.0)
+        {
+        divs[i] = static_cast<int>(length[i]/width);
+        divs[i] = (divs[i] < 1 ? 1 : (divs[i] > 1024 ? 1024 : divs[i]));
+        }
+      }
+    }
+  vtkIdType numBins = static_cast<vtkIdType>(divs[0])*divs[1]*divs[2];
+
+  // A counting sort of the points by bin, in the order of the bins.
+  vtkstd::vector<vtkIdType> bins(numPts);
+  vtkstd::vector<vtkIdType> offsets(numBins + 1, 0);
+  vtkIdType ptId;
+  for (ptId = 0; ptId < numPts; ptId++)
+    {
+    if (maskArray[ptId] == static_cast<char>(1))
+      {
+      bins[ptId] = -1;
+      continue;
+      }
+    input->GetPoint(ptId, x);
+    vtkIdType bin = 0;
+    for (i = 2; i >= 0; i--)
+      {
+      int ijk = 0;
+      if (length[i] > 0.0)
+        {
+        ijk = static_cast<int>((x[i] - bounds[2*i])/length[i]*divs[i]);
+        ijk = (ijk < 0 ? 0 : (ijk >= divs[i] ? divs[i] - 1 : ijk));
+        }
+      bin = bin*divs[i] + ijk;
+      }
+    bins[ptId] = bin;
+    offsets[bin + 1]++;
+    }
+  for (vtkIdType bin = 0; bin < numBins; bin++)
+    {
+    offsets[bin + 1] += offsets[bin];
+    }
+  order.resize(offsets[numBins]);
+  for (ptId = 0; ptId < numPts; ptId++)
+    {
+    if (bins[ptId] >= 0)
+      {
+      order[offsets[bins[ptId]]++] = ptId;
+      }
+    }
+}
+
+//----------------------------------------------------------------------------
+// The state shared by the threads of ThreadedProbeEmptyPoints(). Each
+// piece is a run of the sorted points.
+class vtkProbeFilterPieces
+{
+public:
+  vtkProbeFilter *Self;
+  vtkDataSet *Input;
+  int SrcIdx;
+  vtkDataSet *Source;
+  vtkPointData *OutPD;
+  vtkAbstractCellLocator *Locator;
+  double Tol2;
+  char *MaskArray;
+  int MaxNumberOfComponents;
+  int NumberOfPieces;
+  vtkstd::vector<vtkIdType> Order;
+
+  void ProbePiece(int piece);
+  static VTK_THREAD_RETURN_TYPE Execute(void *arg);
+};
+
+//----------------------------------------------------------------------------
+// Probe the points of a piece as ProbeEmptyPoints() does, writing the
+// tuples of each point in place. The points found are marked with 2 in the
+// mask, to be added to the valid points in order afterwards.
+void vtkProbeFilterPieces::ProbePiece(int piece)
+{
+  vtkIdType numPts = static_cast<vtkIdType>(this->Order.size());
+  vtkIdType first = numPts*piece/this->NumberOfPieces;
+  vtkIdType last = numPts*(piece + 1)/this->NumberOfPieces;
+  vtkPointData *pd = this->Source->GetPointData();
+  vtkCellData *cd = this->Source->GetCellData();
+  vtkGenericCell *cell = vtkGenericCell::New();
+  int mcs = this->Source->GetMaxCellSize();
+  double *weights = new double[mcs > 0 ? mcs : 1];
+  double *nullTuple = new double[this->MaxNumberOfComponents];
+  for (int j = 0; j < this->MaxNumberOfComponents; j++)
+    {
+    nullTuple[j] = 0.0;
+    }
+
+  double x[3], pcoords[3], closestPoint[3], dist2;
+  int subId;
+  vtkIdType prevCellId = -1;
+  for (vtkIdType k = first; k < last; k++)
+    {
+    if (!((k - first) % 1000) && this->Self->GetAbortExecute())
+      {
+      break;
+      }
+    vtkIdType ptId = this->Order[k];
+    this->Input->GetPoint(ptId, x);
+
+    // Try the cell of the previous point, then the locator, then the
+    // search of the source within the tolerance, which the locator
+    // ignores.
+    vtkIdType cellId = -1;
+    if (this->Locator)
+      {
+      if (prevCellId >= 0)
+        {
+        this->Source->GetCell(prevCellId, cell);
+        if (cell->EvaluatePosition(x, closestPoint, subId, pcoords, dist2,
+                                   weights) == 1)
+          {
+          cellId = prevCellId;
+          }
+        }
+      if (cellId < 0)
+        {
+        cellId = this->Locator->FindCell(x, this->Tol2, cell, pcoords,
+                                         weights);
+        }
+      }
+    if (cellId < 0)
+      {
+      cellId = this->Source->FindCell(x, NULL, cell, -1, this->Tol2, subId,
+                                      pcoords, weights);
+      if (cellId >= 0)
+        {
+        this->Source->GetCell(cellId, cell);
+        }
+      }
+
+    if (cellId >= 0)
+      {
+      this->OutPD->InterpolatePoint((*this->Self->PointList), pd,
+        this->SrcIdx, ptId, cell->PointIds, weights);
+      vtkProbeFilter::vtkVectorOfArrays::iterator iter;
+      for (iter = this->Self->CellArrays->begin();
+           iter != this->Self->CellArrays->end(); ++iter)
+        {
+        vtkDataArray* inArray = cd->GetArray((*iter)->GetName());
+        if (inArray)
+          {
+          this->OutPD->CopyTuple(inArray, *iter, cellId, ptId);
+          }
+        }
+      this->MaskArray[ptId] = static_cast<char>(2);
+      prevCellId = cellId;
+      }
+    else if (this->Self->UseNullPoint)
+      {
+      for (int i = 0; i < this->OutPD->GetNumberOfArrays(); i++)
+        {
+        this->OutPD->GetArray(i)->SetTuple(ptId, nullTuple);
+        }
+      }
+    }
+
+  delete [] nullTuple;
+  delete [] weights;
+  cell->Delete();
+}
+
+//----------------------------------------------------------------------------
+VTK_THREAD_RETURN_TYPE vtkProbeFilterPieces::Execute(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *info =
+    static_cast<vtkMultiThreader::ThreadInfo *>(arg);
+  vtkProbeFilterPieces *pieces =
+    static_cast<vtkProbeFilterPieces *>(info->UserData);
+  for (int piece = info->ThreadID; piece < pieces->NumberOfPieces;
+       piece += info->NumberOfThreads)
+    {
+    pieces->ProbePiece(piece);
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+int vtkProbeFilter::ThreadedProbeEmptyPoints(vtkDataSet *input, int srcIdx,
+  vtkDataSet *source, vtkDataSet *output, double tol2)
+{
+  vtkPointData *outPD = output->GetPointData();
+  vtkIdType numPts = input->GetNumberOfPoints();
+
+  // The threads write the tuples of their points in place, which the bits
+  // of a bit array, packed in bytes, and the strings of other arrays do
+  // not allow.
+  int i, maxNumComps = 1;
+  for (i = 0; i < outPD->GetNumberOfArrays(); i++)
+    {
+    vtkDataArray *array = outPD->GetArray(i);
+    if (!array || array->GetDataType() == VTK_BIT)
+      {
+      return 0;
+      }
+    if (array->GetNumberOfComponents() > maxNumComps)
+      {
+      maxNumComps = array->GetNumberOfComponents();
+      }
+    }
+
+  // Give the arrays all their tuples, the new ones null.
+  for (i = 0; i < outPD->GetNumberOfArrays(); i++)
+    {
+    vtkDataArray *array = outPD->GetArray(i);
+    vtkIdType numTuples = array->GetNumberOfTuples();
+    if (numTuples < numPts)
+      {
+      int numComps = array->GetNumberOfComponents();
+      array->SetNumberOfTuples(numPts);
+      memset(array->GetVoidPointer(numTuples*numComps), 0,
+             (numPts - numTuples)*numComps*array->GetDataTypeSize());
+      }
+    }
+
+  vtkProbeFilterPieces pieces;
+  pieces.Self = this;
+  pieces.Input = input;
+  pieces.SrcIdx = srcIdx;
+  pieces.Source = source;
+  pieces.OutPD = outPD;
+  pieces.Locator = 0;
+  pieces.Tol2 = tol2;
+  pieces.MaskArray = this->MaskPoints->GetPointer(0);
+  pieces.MaxNumberOfComponents = maxNumComps;
+
+  // Build, from this thread, the cell locator of a point set, and what the
+  // datasets build on their first use, so that the threads only read them.
+  input->PrepareForThreadedAccess();
+  source->PrepareForThreadedAccess();
+  if (vtkPointSet::SafeDownCast(source) && source->GetNumberOfCells() > 0)
+    {
+    vtkCellLocator *locator = vtkCellLocator::New();
+    locator->SetDataSet(source);
+    locator->BuildLocator();
+    pieces.Locator = locator;
+
+    double x[3], pcoords[3];
+    int subId;
+    double *weights = new double[source->GetMaxCellSize()];
+    vtkGenericCell *cell = vtkGenericCell::New();
+    source->GetPoint(0, x);
+    source->FindCell(x, NULL, cell, -1, tol2, subId, pcoords, weights);
+    cell->Delete();
+    delete [] weights;
+    }
+
+  vtkProbeFilterSortPoints(input, pieces.MaskArray, pieces.Order);
+  vtkIdType numPieces =
+    static_cast<vtkIdType>(pieces.Order.size())/VTK_PROBE_MIN_PIECE_POINTS;
+  if (numPieces > VTK_PROBE_PIECES_PER_THREAD*this->NumberOfThreads)
+    {
+    numPieces = VTK_PROBE_PIECES_PER_THREAD*this->NumberOfThreads;
+    }
+  pieces.NumberOfPieces = static_cast<int>(numPieces > 1 ? numPieces : 1);
+
+  vtkMultiThreader *threader = vtkMultiThreader::New();
+  threader->UseThreadPoolOn();
+  threader->SetNumberOfThreads(this->NumberOfThreads);
+  threader->SetNumberOfPieces(pieces.NumberOfPieces);
+  threader->SetSingleMethod(vtkProbeFilterPieces::Execute, &pieces);
+  threader->SingleMethodExecute();
+  threader->Delete();
+  if (pieces.Locator)
+    {
+    pieces.Locator->Delete();
+    }
+
+  // The valid points in increasing order, as the serial probe finds them.
+  char *maskArray = pieces.MaskArray;
+  for (vtkIdType ptId = 0; ptId < numPts; ptId++)
+    {
+    if (maskArray[ptId] == static_cast<char>(2))
+      {
+      maskArray[ptId] = static_cast<char>(1);
+      this->ValidPoints->InsertNextValue(ptId);
+      this->NumberOfValidPoints++;
+      }
+    }
+  return 1;
+}
+
 //----------------------------------------------------------------------------
 int vtkProbeFilter::RequestInformation(
   vtkInformation *vtkNotUsed(request),
@@ -510,4 +847,5 @@ void vtkProbeFilter::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "ValidPointMaskArrayName: " << (this->ValidPointMaskArrayName?
     this->ValidPointMaskArrayName : "vtkValidPointMask") << "\n";
   os << indent << "ValidPoints: " << this->ValidPoints << "\n";
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << "\n";
 }
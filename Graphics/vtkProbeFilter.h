@@ -31,6 +31,16 @@
 // rendering techniques can be used to visualize the results. Another example:
 // a line or curve can be used to probe data to produce x-y plots along
 // that line or curve.
+//
+// With many points to probe and NumberOfThreads greater than one, the
+// points are sorted into spatial bins and split into runs of neighboring
+// points, which threads probe concurrently into the preallocated output
+// arrays. A source that is a point set is searched with one cell locator
+// built up front and shared by the threads, each thread first trying the
+// cell of its previous point. As cells accept points a little outside
+// them, a point near a face may then be found in the neighbor of the cell
+// the serial search finds, and get slightly different interpolated values
+// and the cell data of that neighbor.
 
 #ifndef __vtkProbeFilter_h
 #define __vtkProbeFilter_h
@@ -85,6 +95,13 @@ public:
   vtkSetStringMacro(ValidPointMaskArrayName)
   vtkGetStringMacro(ValidPointMaskArrayName)
 
+  // Description:
+  // Set/get the number of threads probing the points. Defaults to 1, as
+  // the threaded search may find a neighbor of the cell the serial search
+  // finds (see the class description).
+  vtkSetClampMacro(NumberOfThreads, int, 1, VTK_LARGE_INTEGER);
+  vtkGetMacro(NumberOfThreads, int);
+
 //BTX 
 protected:
   vtkProbeFilter();
@@ -119,6 +136,13 @@ protected:
   void ProbeEmptyPoints(vtkDataSet *input, int srcIdx, vtkDataSet *source, 
     vtkDataSet *output);
 
+  // Description:
+  // Probe the points of ProbeEmptyPoints() with NumberOfThreads threads,
+  // using the tolerance tol2. Returns 0, without probing, if some output
+  // array can not be written by several threads at once.
+  int ThreadedProbeEmptyPoints(vtkDataSet *input, int srcIdx,
+    vtkDataSet *source, vtkDataSet *output, double tol2);
+
   char* ValidPointMaskArrayName;
   vtkIdTypeArray *ValidPoints;
   vtkCharArray* MaskPoints;
@@ -132,6 +156,10 @@ protected:
 
   vtkDataSetAttributes::FieldList* CellList;
   vtkDataSetAttributes::FieldList* PointList;
+
+  int NumberOfThreads;
+
+  friend class vtkProbeFilterPieces;
 private:
   vtkProbeFilter(const vtkProbeFilter&);  // Not implemented.
   void operator=(const vtkProbeFilter&);  // Not implemented.
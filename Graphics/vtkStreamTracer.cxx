@@ -19,6 +19,7 @@ PURPOSE.  See the above copyright notice for more information.
 #include "vtkCompositeDataIterator.h"
 #include "vtkCompositeDataPipeline.h"
 #include "vtkCompositeDataSet.h"
+#include "vtkCriticalSection.h"
 #include "vtkDataSetAttributes.h"
 #include "vtkDoubleArray.h"
 #include "vtkExecutive.h"
@@ -34,6 +35,7 @@ PURPOSE.  See the above copyright notice for more information.
 #include "vtkCellLocatorInterpolatedVelocityField.h"
 #include "vtkMath.h"
 #include "vtkMultiBlockDataSet.h"
+#include "vtkMultiThreader.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPointSet.h"
@@ -44,6 +46,14 @@ PURPOSE.  See the above copyright notice for more information.
 #include "vtkRungeKutta45.h"
 #include "vtkSmartPointer.h"
 
+#include <vtkstd/vector>
+
+// The seeds are handed out to the threads in chunks of at least this many
+// seeds, and in up to this many chunks per thread: streamlines differ in
+// length, so the idle threads have chunks left to take.
+#define VTK_STREAM_TRACER_MIN_CHUNK_SEEDS 8
+#define VTK_STREAM_TRACER_CHUNKS_PER_THREAD 16
+
 vtkStandardNewMacro(vtkStreamTracer);
 vtkCxxSetObjectMacro(vtkStreamTracer,Integrator,vtkInitialValueProblemSolver);
 vtkCxxSetObjectMacro(vtkStreamTracer,InterpolatorPrototype,vtkAbstractInterpolatedVelocityField);
@@ -75,6 +85,8 @@ vtkStreamTracer::vtkStreamTracer()
   this->LastUsedStepSize = 0.0;
 
   this->GenerateNormalsInIntegrate = true;
+  this->ThreadedIntegration = false;
+  this->NumberOfThreads = 1;
 
   this->InterpolatorPrototype = 0;
   
@@ -498,14 +510,25 @@ int vtkStreamTracer::RequestData(
     if (vectors)
       {
       const char *vecName = vectors->GetName();
-      double propagation = 0;
-      vtkIdType numSteps = 0;
-      this->Integrate(input0, output,
-                      seeds, seedIds, 
-                      integrationDirections, 
-                      lastPoint, func,
-                      maxCellSize, vecName,
-                      propagation, numSteps);
+      if (this->NumberOfThreads > 1 && this->Integrator &&
+          seedIds->GetNumberOfIds() >= 2*VTK_STREAM_TRACER_MIN_CHUNK_SEEDS)
+        {
+        this->ThreadedIntegrate(input0, output,
+                                seeds, seedIds,
+                                integrationDirections,
+                                func, maxCellSize, vecName);
+        }
+      else
+        {
+        double propagation = 0;
+        vtkIdType numSteps = 0;
+        this->Integrate(input0, output,
+                        seeds, seedIds, 
+                        integrationDirections, 
+                        lastPoint, func,
+                        maxCellSize, vecName,
+                        propagation, numSteps);
+        }
       }
     func->Delete();
     seeds->Delete();
@@ -710,7 +733,10 @@ void vtkStreamTracer::Integrate(vtkDataSet *input0,
     {
 
     double progress = static_cast<double>(currentLine)/numLines;
-    this->UpdateProgress(progress);
+    if (!this->ThreadedIntegration)
+      {
+      this->UpdateProgress(progress);
+      }
 
     switch (integrationDirections->GetValue(currentLine))
       {
@@ -727,8 +753,11 @@ void vtkStreamTracer::Integrate(vtkDataSet *input0,
     vtkIdType index, numPts=0;
     
     // Clear the last cell to avoid starting a search from
-    // the last point in the streamline
+    // the last point in the streamline. Clear the last dataset too: with a
+    // composite input, a seed shared by two blocks is then always found in
+    // the same block, whichever seed was integrated before.
     func->ClearLastCellId();
+    func->ClearLastDataSet();
 
     // Initial point
     seedSource->GetTuple(seedIds->GetId(currentLine), point1);
@@ -822,9 +851,12 @@ void vtkStreamTracer::Integrate(vtkDataSet *input0,
 
       if ( numSteps++ % 1000 == 1 )
         {
-        progress = 
-          ( currentLine + propagation / this->MaximumPropagation ) / numLines;
-        this->UpdateProgress(progress);
+        if (!this->ThreadedIntegration)
+          {
+          progress = 
+            ( currentLine + propagation / this->MaximumPropagation ) / numLines;
+          this->UpdateProgress(progress);
+          }
 
         if (this->GetAbortExecute())
           {
@@ -857,7 +889,10 @@ void vtkStreamTracer::Integrate(vtkDataSet *input0,
           }
         maxStep = stepSize.Interval;
         }
-      this->LastUsedStepSize = stepSize.Interval;
+      if (!this->ThreadedIntegration)
+        {
+        this->LastUsedStepSize = stepSize.Interval;
+        }
       
       // Calculate the next step using the integrator provided
       // Break if the next point is out of bounds.
@@ -1023,7 +1058,7 @@ void vtkStreamTracer::Integrate(vtkDataSet *input0,
       {
       // Assign geometry and attributes
       output->SetLines(outputLines);
-      if (this->GenerateNormalsInIntegrate)
+      if (this->GenerateNormalsInIntegrate && !this->ThreadedIntegration)
         {
         this->GenerateNormals(output, 0, vecName);
         }
@@ -1060,6 +1095,260 @@ void vtkStreamTracer::Integrate(vtkDataSet *input0,
   return;
 }
 
+// The state shared by the threads of ThreadedIntegrate(). Each thread
+// integrates with its own interpolator, taking the next chunk of seeds
+// until there are none left, into the output of the chunk.
+class vtkStreamTracerChunks
+{
+public:
+  vtkStreamTracer *Self;
+  vtkDataSet *Input0;
+  vtkDataArray *SeedSource;
+  vtkIdList *SeedIds;
+  vtkIntArray *IntegrationDirections;
+  int MaxCellSize;
+  const char *VecName;
+  int NumberOfChunks;
+  int NextChunk;
+  vtkSimpleCriticalSection NextChunkLock;
+  vtkstd::vector<vtkAbstractInterpolatedVelocityField*> Functions;
+  vtkstd::vector<vtkPolyData*> Outputs;
+
+  void IntegrateChunks(vtkAbstractInterpolatedVelocityField *func);
+  static VTK_THREAD_RETURN_TYPE Execute(void *arg);
+};
+
+void vtkStreamTracerChunks::IntegrateChunks(
+  vtkAbstractInterpolatedVelocityField *func)
+{
+  vtkIdType numSeeds = this->SeedIds->GetNumberOfIds();
+  vtkIdList *seedIds = vtkIdList::New();
+  vtkIntArray *integrationDirections = vtkIntArray::New();
+  for (;;)
+    {
+    this->NextChunkLock.Lock();
+    int chunk = this->NextChunk++;
+    this->NextChunkLock.Unlock();
+    if (chunk >= this->NumberOfChunks || this->Self->GetAbortExecute())
+      {
+      break;
+      }
+
+    vtkIdType first = numSeeds*chunk/this->NumberOfChunks;
+    vtkIdType last = numSeeds*(chunk + 1)/this->NumberOfChunks;
+    seedIds->SetNumberOfIds(last - first);
+    integrationDirections->SetNumberOfValues(last - first);
+    for (vtkIdType i = first; i < last; i++)
+      {
+      seedIds->SetId(i - first, this->SeedIds->GetId(i));
+      integrationDirections->SetValue(
+        i - first, this->IntegrationDirections->GetValue(i));
+      }
+
+    vtkPolyData *output = vtkPolyData::New();
+    double lastPoint[3];
+    double propagation = 0;
+    vtkIdType numSteps = 0;
+    this->Self->Integrate(this->Input0, output, this->SeedSource, seedIds,
+                          integrationDirections, lastPoint, func,
+                          this->MaxCellSize, this->VecName,
+                          propagation, numSteps);
+    this->Outputs[chunk] = output;
+    }
+  seedIds->Delete();
+  integrationDirections->Delete();
+}
+
+VTK_THREAD_RETURN_TYPE vtkStreamTracerChunks::Execute(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *info =
+    static_cast<vtkMultiThreader::ThreadInfo *>(arg);
+  vtkStreamTracerChunks *chunks =
+    static_cast<vtkStreamTracerChunks *>(info->UserData);
+  int numFunctions = static_cast<int>(chunks->Functions.size());
+  for (int i = info->ThreadID; i < numFunctions; i += info->NumberOfThreads)
+    {
+    chunks->IntegrateChunks(chunks->Functions[i]);
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+// Append the tuples of an array to another array of the same type.
+static void vtkStreamTracerAppendTuples(vtkAbstractArray *to,
+                                        vtkAbstractArray *from)
+{
+  vtkIdType numTuples = from->GetNumberOfTuples();
+  for (vtkIdType i = 0; i < numTuples; i++)
+    {
+    to->InsertNextTuple(i, from);
+    }
+}
+
+void vtkStreamTracer::ThreadedIntegrate(vtkDataSet *input0,
+                                        vtkPolyData* output,
+                                        vtkDataArray* seedSource,
+                                        vtkIdList* seedIds,
+                                        vtkIntArray* integrationDirections,
+                                        vtkAbstractInterpolatedVelocityField* func,
+                                        int maxCellSize,
+                                        const char *vecName)
+{
+  vtkIdType numSeeds = seedIds->GetNumberOfIds();
+  vtkIdType numChunks = numSeeds / VTK_STREAM_TRACER_MIN_CHUNK_SEEDS;
+  if (numChunks > VTK_STREAM_TRACER_CHUNKS_PER_THREAD*this->NumberOfThreads)
+    {
+    numChunks = VTK_STREAM_TRACER_CHUNKS_PER_THREAD*this->NumberOfThreads;
+    }
+  int numThreads = this->NumberOfThreads;
+  if (numThreads > numChunks)
+    {
+    numThreads = static_cast<int>(numChunks);
+    }
+
+  // Build, from this thread, what the datasets build on their first cell
+  // search (the point locator and the links of point sets), so that the
+  // interpolators only read them.
+  vtkCompositeDataIterator* iter = this->InputData->NewIterator();
+  vtkGenericCell *cell = vtkGenericCell::New();
+  for (iter->GoToFirstItem(); !iter->IsDoneWithTraversal();
+       iter->GoToNextItem())
+    {
+    vtkDataSet *input = vtkDataSet::SafeDownCast(iter->GetCurrentDataObject());
+    if (input)
+      {
+      input->PrepareForThreadedAccess();
+      if (input->GetNumberOfPoints() > 0 && input->GetNumberOfCells() > 0)
+        {
+        double x[3], pcoords[3];
+        int subId;
+        double *weights = new double[input->GetMaxCellSize()];
+        input->GetPoint(0, x);
+        input->FindCell(x, 0, cell, -1, 0.0, subId, pcoords, weights);
+        delete [] weights;
+        }
+      }
+    }
+  cell->Delete();
+  iter->Delete();
+
+  // One interpolator per thread, each with its own cell cache.
+  vtkStreamTracerChunks chunks;
+  chunks.Self = this;
+  chunks.Input0 = input0;
+  chunks.SeedSource = seedSource;
+  chunks.SeedIds = seedIds;
+  chunks.IntegrationDirections = integrationDirections;
+  chunks.MaxCellSize = maxCellSize;
+  chunks.VecName = vecName;
+  chunks.NumberOfChunks = static_cast<int>(numChunks);
+  chunks.NextChunk = 0;
+  chunks.Outputs.resize(numChunks, static_cast<vtkPolyData*>(0));
+  chunks.Functions.push_back(func);
+  for (int i = 1; i < numThreads; i++)
+    {
+    vtkAbstractInterpolatedVelocityField *threadFunc = 0;
+    int cellSize = 0;
+    this->CheckInputs(threadFunc, &cellSize);
+    chunks.Functions.push_back(threadFunc);
+    }
+
+  this->ThreadedIntegration = true;
+  vtkMultiThreader *threader = vtkMultiThreader::New();
+  threader->UseThreadPoolOn();
+  threader->SetNumberOfThreads(numThreads);
+  threader->SetNumberOfPieces(numThreads);
+  threader->SetSingleMethod(vtkStreamTracerChunks::Execute, &chunks);
+  threader->SingleMethodExecute();
+  threader->Delete();
+  this->ThreadedIntegration = false;
+
+  for (int i = 1; i < numThreads; i++)
+    {
+    chunks.Functions[i]->Delete();
+    }
+
+  // An aborted integration leaves the output empty, as in Integrate().
+  int aborted = this->GetAbortExecute();
+  for (vtkIdType chunk = 0; chunk < numChunks && !aborted; chunk++)
+    {
+    aborted = (!chunks.Outputs[chunk] || !chunks.Outputs[chunk]->GetPoints());
+    }
+
+  if (!aborted)
+    {
+    // Append the chunks in seed order. Every chunk has the point arrays of
+    // the first one, in the same order, and the lines of a chunk are
+    // renumbered after the points of the previous chunks, including those
+    // of the seeds that did not make a line.
+    vtkPolyData *first = chunks.Outputs[0];
+    vtkPoints *outputPoints = vtkPoints::New();
+    outputPoints->DeepCopy(first->GetPoints());
+    vtkDataSetAttributes *outputPD = output->GetPointData();
+    outputPD->DeepCopy(first->GetPointData());
+    vtkCellArray *outputLines = vtkCellArray::New();
+    vtkIntArray *retVals = vtkIntArray::New();
+    retVals->SetName("ReasonForTermination");
+
+    vtkIdType offset = 0;
+    for (vtkIdType chunk = 0; chunk < numChunks; chunk++)
+      {
+      vtkPolyData *piece = chunks.Outputs[chunk];
+      if (chunk > 0)
+        {
+        vtkStreamTracerAppendTuples(outputPoints->GetData(),
+                                    piece->GetPoints()->GetData());
+        vtkPointData *piecePD = piece->GetPointData();
+        for (int i = 0; i < outputPD->GetNumberOfArrays(); i++)
+          {
+          vtkStreamTracerAppendTuples(outputPD->GetAbstractArray(i),
+                                      piecePD->GetAbstractArray(i));
+          }
+        }
+
+      vtkCellArray *lines = piece->GetLines();
+      vtkIdType npts, *pts;
+      for (lines->InitTraversal(); lines->GetNextCell(npts, pts); )
+        {
+        outputLines->InsertNextCell(static_cast<int>(npts));
+        for (vtkIdType i = 0; i < npts; i++)
+          {
+          outputLines->InsertCellPoint(pts[i] + offset);
+          }
+        }
+      vtkDataArray *pieceRetVals =
+        piece->GetCellData()->GetArray("ReasonForTermination");
+      if (pieceRetVals)
+        {
+        vtkStreamTracerAppendTuples(retVals, pieceRetVals);
+        }
+      offset += piece->GetNumberOfPoints();
+      }
+
+    output->SetPoints(outputPoints);
+    if (outputPoints->GetNumberOfPoints() > 1)
+      {
+      output->SetLines(outputLines);
+      if (this->GenerateNormalsInIntegrate)
+        {
+        this->GenerateNormals(output, 0, vecName);
+        }
+      output->GetCellData()->AddArray(retVals);
+      }
+    outputPoints->Delete();
+    outputLines->Delete();
+    retVals->Delete();
+    output->Squeeze();
+    }
+
+  for (vtkIdType chunk = 0; chunk < numChunks; chunk++)
+    {
+    if (chunks.Outputs[chunk])
+      {
+      chunks.Outputs[chunk]->Delete();
+      }
+    }
+}
+
 void vtkStreamTracer::GenerateNormals(vtkPolyData* output, double* firstNormal, 
                                       const char *vecName)
 {
@@ -1270,6 +1559,7 @@ void vtkStreamTracer::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Vorticity computation: " 
      << (this->ComputeVorticity ? " On" : " Off") << endl;
   os << indent << "Rotation scale: " << this->RotationScale << endl;
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << endl;
 }
 
 vtkExecutive* vtkStreamTracer::CreateDefaultExecutive()
@@ -67,6 +67,12 @@
 // a source object, traces will be generated from each point in the source
 // that is inside the dataset.
 //
+// With many seeds, the streamlines are integrated by NumberOfThreads
+// threads. The seeds are handed out to the threads in small consecutive
+// chunks as the threads become idle, each thread integrating with its own
+// copy of the velocity field interpolator, and the lines of the chunks are
+// appended in seed order: the output is that of a single thread.
+//
 // .SECTION See Also
 // vtkRibbonFilter vtkRuledSurfaceFilter vtkInitialValueProblemSolver 
 // vtkRungeKutta2 vtkRungeKutta4 vtkRungeKutta45 vtkTemporalStreamTracer
@@ -240,6 +246,12 @@ public:
   // Specify the terminal speed value, below which integration is terminated.
   vtkSetMacro(TerminalSpeed, double);
   vtkGetMacro(TerminalSpeed, double);
+
+  // Description:
+  // Set/get the number of threads integrating the streamlines of many
+  // seeds. Defaults to 1.
+  vtkSetClampMacro(NumberOfThreads, int, 1, VTK_LARGE_INTEGER);
+  vtkGetMacro(NumberOfThreads, int);
   
 //BTX
   enum
@@ -332,8 +344,25 @@ protected:
                   int* maxCellSize);
   void GenerateNormals(vtkPolyData* output, double* firstNormal, const char *vecName);
 
+  // Integrate the seeds with NumberOfThreads threads, each calling
+  // Integrate() on chunks of seeds, and append the chunks to the output.
+  void ThreadedIntegrate(vtkDataSet *input0,
+                         vtkPolyData* output,
+                         vtkDataArray* seedSource,
+                         vtkIdList* seedIds,
+                         vtkIntArray* integrationDirections,
+                         vtkAbstractInterpolatedVelocityField* func,
+                         int maxCellSize,
+                         const char *vecFieldName);
+
   bool GenerateNormalsInIntegrate;
 
+  // True while Integrate() runs on several threads: it then neither
+  // reports progress, nor sets LastUsedStepSize, nor generates normals.
+  bool ThreadedIntegration;
+
+  int NumberOfThreads;
+
   // starting from global x-y-z position
   double StartPosition[3];
 
@@ -384,6 +413,10 @@ protected:
 
   vtkCompositeDataSet* InputData;
 
+//BTX
+  friend class vtkStreamTracerChunks;
+//ETX
+
 private:
   vtkStreamTracer(const vtkStreamTracer&);  // Not implemented.
   void operator=(const vtkStreamTracer&);  // Not implemented.
@@ -25,6 +25,7 @@
 #include "vtkIntArray.h"
 #include "vtkLongArray.h"
 #include "vtkMath.h"
+#include "vtkMultiThreader.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
@@ -38,6 +39,8 @@
 
 #include <math.h>
 
+#include <vtkstd/vector>
+
 vtkStandardNewMacro(vtkSynchronizedTemplates3D);
 
 //----------------------------------------------------------------------------
@@ -57,6 +60,8 @@ vtkSynchronizedTemplates3D::vtkSynchronizedTemplates3D()
 
   this->ArrayComponent = 0;
 
+  this->NumberOfThreads = 1;
+
   // by default process active point scalars
   this->SetInputArrayToProcess(0,0,0,vtkDataObject::FIELD_ASSOCIATION_POINTS,
                                vtkDataSetAttributes::SCALARS);
@@ -217,126 +222,426 @@ void vtkSTComputePointGradient(int i, int j, int k, T *s, int *wholeExt,
 }
 
 //----------------------------------------------------------------------------
-#define VTK_CSP3PA(i2,j2,k2,s) \
-if (NeedGradients) \
-{ \
-  if (!g0) \
-    { \
-    vtkSTComputePointGradient(i, j, k, s0, wholeExt, xInc, yInc, zInc, spacing, n0); \
-    g0 = 1; \
-    } \
-  vtkSTComputePointGradient(i2, j2, k2, s, wholeExt, xInc, yInc, zInc, spacing, n1); \
-  for (jj=0; jj<3; jj++) \
-    { \
-    n[jj] = n0[jj] + t * (n1[jj] - n0[jj]); \
-    } \
-  if (ComputeGradients) \
-    { \
-    newGradients->InsertNextTuple(n); \
-    } \
-  if (ComputeNormals) \
-    { \
-    vtkMath::Normalize(n); \
-    n[0] = -n[0]; n[1] = -n[1]; n[2] = -n[2]; \
-    newNormals->InsertNextTuple(n); \
-    }   \
-} \
-if (ComputeScalars) \
-{ \
-  newScalars->InsertNextTuple(&value); \
-}
+// Contours an image one layer of points at a time. ContourImage() contours
+// the layers in order, inserting the points and triangles in the output.
+// The threaded path contours slabs of layers concurrently, giving the points
+// and triangles the ids and order ContourImage() gives them. Pass 0 counts
+// the new points of each layer of each contour, pass 1 generates the points
+// and triangles of each slab, numbering the new points of a layer after
+// those of the layers before, and pass 2 copies the triangles of the slabs
+// into the output. In pass 1 a slab first renumbers the layer below it,
+// whose points its first triangles use, and the layer below that, whose
+// points on the edges up into the layer below may be reused.
+#define VTK_ST3D_MIN_SLAB_LAYERS 8
+#define VTK_ST3D_SLABS_PER_THREAD 4
 
-//----------------------------------------------------------------------------
-//
-// Contouring filter specialized for images
-//
 template <class T>
-void ContourImage(vtkSynchronizedTemplates3D *self, int *exExt,
-                  vtkInformation *inInfo,
-                  vtkImageData *data, vtkPolyData *output, T *ptr, 
-                  vtkDataArray *inScalars)
+class vtkSynchronizedTemplates3DLayers
 {
-  int *inExt = data->GetExtent();
-  int xdim = exExt[1] - exExt[0] + 1;
-  int ydim = exExt[3] - exExt[2] + 1;
-  double *values = self->GetValues();
-  int numContours = self->GetNumberOfContours();
-  T *inPtrX, *inPtrY, *inPtrZ;
-  T *s0, *s1, *s2, *s3;
-  int xMin, xMax, yMin, yMax, zMin, zMax;
-  int xInc, yInc, zInc;
-  double *origin = data->GetOrigin();
-  double *spacing = data->GetSpacing();
-  int *isect1Ptr, *isect2Ptr;
-  double y, z, t;
-  int i, j, k;
-  int zstep, yisectstep;
-  int offsets[12];
-  int ComputeNormals = self->GetComputeNormals();
-  int ComputeGradients = self->GetComputeGradients();
-  int ComputeScalars = self->GetComputeScalars();
-  int NeedGradients = ComputeGradients || ComputeNormals;
-  double n[3], n0[3], n1[3];
-  int jj, g0;
-  int *tablePtr;
-  int idx, vidx;
-  double x[3], xz[3];
-  int v0, v1, v2, v3;
-  vtkIdType ptIds[3];
-  double value;
-  int *wholeExt;
-  // We need to know the edgePointId's for interpolating attributes.
-  int edgePtId, inCellId, outCellId;
-  vtkPointData *inPD = data->GetPointData();
-  vtkCellData *inCD = data->GetCellData();
-  vtkPointData *outPD = output->GetPointData();  
-  vtkCellData *outCD = output->GetCellData();  
-  // Use to be arguments
-  vtkFloatArray *newScalars = NULL;
-  vtkFloatArray *newNormals = NULL;
-  vtkFloatArray *newGradients = NULL;
-  vtkPoints *newPts;
-  vtkCellArray *newPolys;
-  ptr += self->GetArrayComponent();
-  
-  if (ComputeScalars)
+public:
+  // How a layer is contoured: inserting its points and triangles in the
+  // output, numbering its new points from zero, numbering them from their
+  // ids, or generating its points and triangles in pre-sized arrays.
+  enum { INSERT, COUNT, NUMBER, GENERATE };
+
+  T *Data; // the contoured component at the first point of the extent
+  int Extent[6];
+  int *InExt;
+  int *WholeExt;
+  int Inc[3];
+  double *Origin;
+  double *Spacing;
+  double *Values;
+  int ComputeNormals;
+  int ComputeGradients;
+  int ComputeScalars;
+
+  // The output arrays.
+  vtkPoints *NewPoints;
+  vtkCellArray *NewPolys;
+  vtkFloatArray *NewScalars;
+  vtkFloatArray *NewNormals;
+  vtkFloatArray *NewGradients;
+  vtkPointData *InPD;
+  vtkPointData *OutPD;
+  vtkCellData *InCD;
+  vtkCellData *OutCD;
+
+  int NumberOfLayers;
+  int NumberOfSlabs;
+  int NumberOfPieces;
+  int Pass;
+
+  // The number of new points of each layer of each contour in pass 0, then
+  // the id of their first point.
+  vtkIdType *LayerStarts;
+
+  // Pre-sized output, and the input points and weight each point is
+  // interpolated from (if not NULL).
+  float *Points;
+  float *Scalars;
+  float *Normals;
+  float *Gradients;
+  vtkIdType *EdgePoints;
+  double *EdgeWeights;
+
+  // The triangles of each piece, their input cells (if not NULL) and their
+  // position in the output.
+  vtkstd::vector<vtkIdType> *Triangles;
+  vtkstd::vector<vtkIdType> *CellIds;
+  vtkIdType *TriangleStarts;
+  vtkIdType *Polys;
+
+  vtkIdType &LayerStart(int contour, int k)
     {
-    newScalars = vtkFloatArray::New();
+    return this->LayerStarts[contour*this->NumberOfLayers + k - this->Extent[4]];
     }
-  if (ComputeNormals)
+  int SlabBegin(int slab)
     {
-    newNormals = vtkFloatArray::New();
+    return this->Extent[4] + this->NumberOfLayers*slab/this->NumberOfSlabs;
     }
-  if (ComputeGradients)
+  int *LayerBuffer(int *isect, int k)
     {
-    newGradients = vtkFloatArray::New();
+    int xdim = this->Extent[1] - this->Extent[0] + 1;
+    int ydim = this->Extent[3] - this->Extent[2] + 1;
+    return (k%2 ? isect + xdim*ydim*3 : isect);
     }
-  vtkSynchronizedTemplates3DInitializeOutput(exExt, 
-                                             data, output, 
-                                             newScalars, newNormals, 
-                                             newGradients, inScalars);
-  newPts = output->GetPoints();
-  newPolys = output->GetPolys();
-  
-  // this is an exploded execute extent.
-  xMin = exExt[0];
-  xMax = exExt[1];
-  yMin = exExt[2];
-  yMax = exExt[3];
-  zMin = exExt[4];
-  zMax = exExt[5];
-  
+
+  void Initialize(vtkSynchronizedTemplates3D *self, int *exExt,
+                  vtkInformation *inInfo, vtkImageData *data,
+                  vtkPolyData *output, T *ptr, vtkDataArray *inScalars);
+  void Finish(vtkPolyData *output, vtkDataArray *inScalars);
+  int *NewIntersections();
+  void Execute(int piece);
+  void MarkLayer(int *isect, double value, int k);
+  vtkIdType ContourLayer(int *isect, double value, int k, int mode,
+                         vtkIdType ptId, int piece);
+  void AddPoint(int mode, vtkIdType ptId, double x[3], double value, double t,
+                vtkIdType edgePtId, int edgeInc, int i, int j, int k,
+                T *s0, int i2, int j2, int k2, T *s, int &g0, double n0[3]);
+};
+
+//----------------------------------------------------------------------------
+// Set up the contouring of the execute extent and the output arrays.
+template <class T>
+void vtkSynchronizedTemplates3DLayers<T>::Initialize(
+  vtkSynchronizedTemplates3D *self, int *exExt, vtkInformation *inInfo,
+  vtkImageData *data, vtkPolyData *output, T *ptr, vtkDataArray *inScalars)
+{
+  int *inExt = data->GetExtent();
+  this->Data = ptr + self->GetArrayComponent();
+  for (int idx = 0; idx < 6; idx++)
+    {
+    this->Extent[idx] = exExt[idx];
+    }
+  this->InExt = inExt;
+  this->WholeExt =
+    inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT());
   // increments to move through scalars. Compute these ourself because
   // we may be contouring an array other than scalars.
-  xInc = inScalars->GetNumberOfComponents();
-  yInc = xInc*(inExt[1]-inExt[0]+1);
-  zInc = yInc*(inExt[3]-inExt[2]+1);
+  this->Inc[0] = inScalars->GetNumberOfComponents();
+  this->Inc[1] = this->Inc[0]*(inExt[1]-inExt[0]+1);
+  this->Inc[2] = this->Inc[1]*(inExt[3]-inExt[2]+1);
+  this->Origin = data->GetOrigin();
+  this->Spacing = data->GetSpacing();
+  this->Values = self->GetValues();
+  this->ComputeNormals = self->GetComputeNormals();
+  this->ComputeGradients = self->GetComputeGradients();
+  this->ComputeScalars = self->GetComputeScalars();
+
+  this->NewScalars = NULL;
+  this->NewNormals = NULL;
+  this->NewGradients = NULL;
+  if (this->ComputeScalars)
+    {
+    this->NewScalars = vtkFloatArray::New();
+    }
+  if (this->ComputeNormals)
+    {
+    this->NewNormals = vtkFloatArray::New();
+    }
+  if (this->ComputeGradients)
+    {
+    this->NewGradients = vtkFloatArray::New();
+    }
+  vtkSynchronizedTemplates3DInitializeOutput(exExt, data, output,
+                                             this->NewScalars,
+                                             this->NewNormals,
+                                             this->NewGradients, inScalars);
+  this->NewPoints = output->GetPoints();
+  this->NewPolys = output->GetPolys();
+  this->InPD = data->GetPointData();
+  this->OutPD = output->GetPointData();
+  this->InCD = data->GetCellData();
+  this->OutCD = output->GetCellData();
+}
 
-  wholeExt = inInfo->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT());
-  
+//----------------------------------------------------------------------------
+// Add the computed arrays to the output.
+template <class T>
+void vtkSynchronizedTemplates3DLayers<T>::Finish(vtkPolyData *output,
+                                                 vtkDataArray *inScalars)
+{
+  int idx;
+  if (this->NewScalars)
+    {
+    // Lets set the name of the scalars here.
+    if (inScalars)
+      {
+      this->NewScalars->SetName(inScalars->GetName());
+      }
+    idx = output->GetPointData()->AddArray(this->NewScalars);
+    output->GetPointData()->SetActiveAttribute(idx,
+                                               vtkDataSetAttributes::SCALARS);
+    this->NewScalars->Delete();
+    this->NewScalars = NULL;
+    }
+  if (this->NewGradients)
+    {
+    idx = output->GetPointData()->AddArray(this->NewGradients);
+    output->GetPointData()->SetActiveAttribute(idx,
+                                               vtkDataSetAttributes::VECTORS);
+    this->NewGradients->Delete();
+    this->NewGradients = NULL;
+    }
+  if (this->NewNormals)
+    {
+    output->GetPointData()->SetNormals(this->NewNormals);
+    this->NewNormals->Delete();
+    this->NewNormals = NULL;
+    }
+}
+
+//----------------------------------------------------------------------------
+// Allocate the intersections of two layers, with the impossible edges set
+// to -1. The caller deletes them.
+template <class T>
+int *vtkSynchronizedTemplates3DLayers<T>::NewIntersections()
+{
+  int xdim = this->Extent[1] - this->Extent[0] + 1;
+  int ydim = this->Extent[3] - this->Extent[2] + 1;
+  int *isect = new int [xdim*ydim*3*2];
+  int i;
+  for (i = 0; i < ydim; i++)
+    {
+    isect[(i+1)*xdim*3-3] = -1;
+    isect[(i+1)*xdim*3*2-3] = -1;
+    }
+  for (i = 0; i < xdim; i++)
+    {
+    isect[((ydim-1)*xdim + i)*3 + 1] = -1;
+    isect[((ydim-1)*xdim + i)*3*2 + 1] = -1;
+    }
+  return isect;
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+void vtkSynchronizedTemplates3DLayers<T>::Execute(int piece)
+{
+  int contour = piece / this->NumberOfSlabs;
+  int slab = piece % this->NumberOfSlabs;
+  int k0 = this->SlabBegin(slab), k1 = this->SlabBegin(slab + 1);
+  int zMin = this->Extent[4];
+  double value = this->Values[contour];
+  int k;
+
+  if (this->Pass == 2)
+    {
+    vtkstd::vector<vtkIdType> &tris = this->Triangles[piece];
+    vtkIdType *polys = this->Polys + 4*this->TriangleStarts[piece];
+    for (size_t i = 0; i < tris.size(); i += 3)
+      {
+      *polys++ = 3;
+      *polys++ = tris[i];
+      *polys++ = tris[i+1];
+      *polys++ = tris[i+2];
+      }
+    return;
+    }
+
+  int *isect = this->NewIntersections();
+  if (this->Pass == 0)
+    {
+    if (k0 > zMin)
+      {
+      this->MarkLayer(isect, value, k0 - 1);
+      }
+    for (k = k0; k < k1; k++)
+      {
+      this->LayerStart(contour, k) =
+        this->ContourLayer(isect, value, k, COUNT, 0, piece);
+      }
+    }
+  else
+    {
+    k = (k0 - 2 > zMin ? k0 - 2 : zMin);
+    if (k > zMin)
+      {
+      this->MarkLayer(isect, value, k - 1);
+      }
+    for (; k < k0; k++)
+      {
+      this->ContourLayer(isect, value, k, NUMBER,
+                         this->LayerStart(contour, k), piece);
+      }
+    for (; k < k1; k++)
+      {
+      this->ContourLayer(isect, value, k, GENERATE,
+                         this->LayerStart(contour, k), piece);
+      }
+    }
+  delete [] isect;
+}
+
+//----------------------------------------------------------------------------
+// Mark the edges up from layer k that the contour crosses, the only edges
+// of a layer the next one looks at when it is not generated.
+template <class T>
+void vtkSynchronizedTemplates3DLayers<T>::MarkLayer(int *isect, double value,
+                                                    int k)
+{
+  int *isectPtr = this->LayerBuffer(isect, k);
+  T *inPtrY = this->Data + (k - this->Extent[4])*this->Inc[2];
+  for (int j = this->Extent[2]; j <= this->Extent[3]; j++)
+    {
+    T *s0 = inPtrY;
+    for (int i = this->Extent[0]; i <= this->Extent[1]; i++)
+      {
+      int v0 = (*s0 < value ? 0 : 1);
+      int v3 = (*(s0 + this->Inc[2]) < value ? 0 : 1);
+      isectPtr[0] = -1;
+      isectPtr[1] = -1;
+      isectPtr[2] = (v0 ^ v3 ? 0 : -1);
+      isectPtr += 3;
+      s0 += this->Inc[0];
+      }
+    inPtrY += this->Inc[1];
+    }
+}
+
+//----------------------------------------------------------------------------
+// Add point ptId at x on the edge from s0 to s, at t along the edge, with
+// its attributes.
+template <class T>
+void vtkSynchronizedTemplates3DLayers<T>::AddPoint(
+  int mode, vtkIdType ptId, double x[3], double value, double t,
+  vtkIdType edgePtId, int edgeInc, int i, int j, int k, T *s0,
+  int i2, int j2, int k2, T *s, int &g0, double n0[3])
+{
+  if (mode == INSERT)
+    {
+    this->NewPoints->InsertNextPoint(x);
+    }
+  else
+    {
+    float *p = this->Points + 3*ptId;
+    p[0] = static_cast<float>(x[0]);
+    p[1] = static_cast<float>(x[1]);
+    p[2] = static_cast<float>(x[2]);
+    }
+  if (this->ComputeNormals || this->ComputeGradients)
+    {
+    double n[3], n1[3];
+    // g0 keeps us from computing the gradient of point s0 twice.
+    if (!g0)
+      {
+      vtkSTComputePointGradient(i, j, k, s0, this->WholeExt, this->Inc[0],
+                                this->Inc[1], this->Inc[2], this->Spacing, n0);
+      g0 = 1;
+      }
+    vtkSTComputePointGradient(i2, j2, k2, s, this->WholeExt, this->Inc[0],
+                              this->Inc[1], this->Inc[2], this->Spacing, n1);
+    for (int jj = 0; jj < 3; jj++)
+      {
+      n[jj] = n0[jj] + t * (n1[jj] - n0[jj]);
+      }
+    if (this->ComputeGradients)
+      {
+      if (mode == INSERT)
+        {
+        this->NewGradients->InsertNextTuple(n);
+        }
+      else
+        {
+        float *g = this->Gradients + 3*ptId;
+        g[0] = static_cast<float>(n[0]);
+        g[1] = static_cast<float>(n[1]);
+        g[2] = static_cast<float>(n[2]);
+        }
+      }
+    if (this->ComputeNormals)
+      {
+      vtkMath::Normalize(n);
+      n[0] = -n[0]; n[1] = -n[1]; n[2] = -n[2];
+      if (mode == INSERT)
+        {
+        this->NewNormals->InsertNextTuple(n);
+        }
+      else
+        {
+        float *nn = this->Normals + 3*ptId;
+        nn[0] = static_cast<float>(n[0]);
+        nn[1] = static_cast<float>(n[1]);
+        nn[2] = static_cast<float>(n[2]);
+        }
+      }
+    }
+  if (this->ComputeScalars)
+    {
+    if (mode == INSERT)
+      {
+      this->NewScalars->InsertNextTuple(&value);
+      }
+    else
+      {
+      this->Scalars[ptId] = static_cast<float>(value);
+      }
+    }
+  if (mode == INSERT)
+    {
+    this->OutPD->InterpolateEdge(this->InPD, ptId, edgePtId,
+                                 edgePtId + edgeInc, t);
+    }
+  else if (this->EdgePoints)
+    {
+    this->EdgePoints[2*ptId] = edgePtId;
+    this->EdgePoints[2*ptId+1] = edgePtId + edgeInc;
+    this->EdgeWeights[ptId] = t;
+    }
+}
+
+//----------------------------------------------------------------------------
+// Contour layer k, numbering its new points from ptId. Returns the number
+// of new points.
+template <class T>
+vtkIdType vtkSynchronizedTemplates3DLayers<T>::ContourLayer(
+  int *isect, double value, int k, int mode, vtkIdType ptId, int piece)
+{
+  int xMin = this->Extent[0], xMax = this->Extent[1];
+  int yMin = this->Extent[2], yMax = this->Extent[3];
+  int zMin = this->Extent[4], zMax = this->Extent[5];
+  int *inExt = this->InExt;
+  int xInc = this->Inc[0], yInc = this->Inc[1], zInc = this->Inc[2];
+  double *origin = this->Origin;
+  double *spacing = this->Spacing;
+  int xdim = xMax - xMin + 1;
+  int ydim = yMax - yMin + 1;
   // Kens increments, probably to do with edge array
-  zstep = xdim*ydim;
-  yisectstep = xdim*3;
+  int zstep = xdim*ydim;
+  int yisectstep = xdim*3;
+  int offsets[12];
+  int *isect1Ptr, *isect2Ptr;
+  T *inPtrX, *inPtrY, *s0, *s1, *s2, *s3;
+  int i, j, v0, v1, v2, v3, g0, idx, *tablePtr;
+  // We need to know the edgePointId's for interpolating attributes.
+  int edgePtId, inCellId;
+  vtkIdType outCellId;
+  double x[3], xz[3], n0[3], y, z, t;
+  vtkIdType ptIds[3];
+  vtkIdType firstId = ptId;
+  int generate = (mode == INSERT || mode == GENERATE);
+
   // compute offsets probably how to get to the edges in the edge array.
   offsets[0] = -xdim*3;
   offsets[1] = -xdim*3 + 1;
@@ -346,295 +651,432 @@ void ContourImage(vtkSynchronizedTemplates3D *self, int *exExt,
   offsets[5] = 0;
   offsets[6] = 2;
   offsets[7] = 5;
-  offsets[8] = (zstep - xdim)*3;
-  offsets[9] = (zstep - xdim)*3 + 1;
-  offsets[10] = (zstep - xdim)*3 + 4;
-  offsets[11] = zstep*3;
-    
-  // allocate storage array
-  int *isect1 = new int [xdim*ydim*3*2];
-  // set impossible edges to -1
-  for (i = 0; i < ydim; i++)
+  // swap the buffers
+  if (k%2)
     {
-    isect1[(i+1)*xdim*3-3] = -1;
-    isect1[(i+1)*xdim*3*2-3] = -1;
+    offsets[8] = (zstep - xdim)*3;
+    offsets[9] = (zstep - xdim)*3 + 1;
+    offsets[10] = (zstep - xdim)*3 + 4;
+    offsets[11] = zstep*3;
+    isect1Ptr = isect;
+    isect2Ptr = isect + xdim*ydim*3;
     }
-  for (i = 0; i < xdim; i++)
+  else
     {
-    isect1[((ydim-1)*xdim + i)*3 + 1] = -1;
-    isect1[((ydim-1)*xdim + i)*3*2 + 1] = -1;
+    offsets[8] = (-zstep - xdim)*3;
+    offsets[9] = (-zstep - xdim)*3 + 1;
+    offsets[10] = (-zstep - xdim)*3 + 4;
+    offsets[11] = -zstep*3;
+    isect1Ptr = isect + xdim*ydim*3;
+    isect2Ptr = isect;
     }
 
-  // for each contour
-  for (vidx = 0; vidx < numContours; vidx++)
+  z = origin[2] + spacing[2]*k;
+  x[2] = z;
+  inPtrY = this->Data + (k - zMin)*zInc;
+  for (j = yMin; j <= yMax; j++)
     {
-    value = values[vidx];
-    inPtrZ = ptr;
-
-    //==================================================================
-    for (k = zMin; k <= zMax; k++)
+    // Should not impact perfomance here/
+    edgePtId = (j-inExt[2])*yInc + (k-inExt[4])*zInc;
+    // Increments are different for cells.  Since the cells are not
+    // contoured until the second row of templates, subtract 1 from
+    // i,j,and k.  Note: first cube is formed when i=0, j=1, and k=1.
+    inCellId =
+      (xMin-inExt[0]) + (inExt[1]-inExt[0])*
+      ( (j-inExt[2]-1) + (k-inExt[4]-1)*(inExt[3]-inExt[2]) );
+
+    y = origin[1] + j*spacing[1];
+    xz[1] = y;
+    s1 = inPtrY;
+    v1 = (*s1 < value ? 0 : 1);
+
+    inPtrX = inPtrY;
+    for (i = xMin; i <= xMax; i++)
       {
-      self->UpdateProgress((double)vidx/numContours + 
-                           (k-zMin)/((zMax - zMin+1.0)*numContours));
-      z = origin[2] + spacing[2]*k;
-      x[2] = z;
-
-      // swap the buffers
-      if (k%2)
+      s0 = s1;
+      v0 = v1;
+      // this flag keeps up from computing gradient for grid point 0 twice.
+      g0 = 0;
+      *isect2Ptr = -1;
+      *(isect2Ptr + 1) = -1;
+      *(isect2Ptr + 2) = -1;
+      if (i < xMax)
         {
-        offsets[8] = (zstep - xdim)*3;
-        offsets[9] = (zstep - xdim)*3 + 1;
-        offsets[10] = (zstep - xdim)*3 + 4;
-        offsets[11] = zstep*3;
-        isect1Ptr = isect1;
-        isect2Ptr = isect1 + xdim*ydim*3;
-        }
-      else
-        { 
-        offsets[8] = (-zstep - xdim)*3;
-        offsets[9] = (-zstep - xdim)*3 + 1;
-        offsets[10] = (-zstep - xdim)*3 + 4;
-        offsets[11] = -zstep*3;
-        isect1Ptr = isect1 + xdim*ydim*3;
-        isect2Ptr = isect1;
+        s1 = (inPtrX + xInc);
+        v1 = (*s1 < value ? 0 : 1);
+        if (v0 ^ v1)
+          {
+          // watch for degenerate points
+          if (*s0 == value)
+            {
+            if (i > xMin && *(isect2Ptr-3) > -1)
+              {
+              *isect2Ptr = *(isect2Ptr-3);
+              }
+            else if (j > yMin && *(isect2Ptr - yisectstep + 1) > -1)
+              {
+              *isect2Ptr = *(isect2Ptr - yisectstep + 1);
+              }
+            else if (k > zMin && *(isect1Ptr+2) > -1)
+              {
+              *isect2Ptr = *(isect1Ptr+2);
+              }
+            }
+          else if (*s1 == value)
+            {
+            if (j > yMin && *(isect2Ptr - yisectstep +4) > -1)
+              {
+              *isect2Ptr = *(isect2Ptr - yisectstep + 4);
+              }
+            else if (k > zMin && i < xMax && *(isect1Ptr + 5) > -1)
+              {
+              *isect2Ptr = *(isect1Ptr + 5);
+              }
+            }
+          // if the edge has not been set yet then it is a new point
+          if (*isect2Ptr == -1)
+            {
+            if (generate)
+              {
+              t = (value - (double)(*s0)) / ((double)(*s1) - (double)(*s0));
+              x[0] = origin[0] + spacing[0]*(i+t);
+              x[1] = y;
+              this->AddPoint(mode, ptId, x, value, t, edgePtId, xInc,
+                             i, j, k, s0, i+1, j, k, s1, g0, n0);
+              }
+            *isect2Ptr = static_cast<int>(ptId++);
+            }
+          }
         }
-
-      inPtrY = inPtrZ;
-      for (j = yMin; j <= yMax; j++)
+      if (j < yMax)
         {
-        // Should not impact perfomance here/
-        edgePtId = (j-inExt[2])*yInc + (k-inExt[4])*zInc;
-        // Increments are different for cells.  Since the cells are not
-        // contoured until the second row of templates, subtract 1 from
-        // i,j,and k.  Note: first cube is formed when i=0, j=1, and k=1.
-        inCellId = 
-          (xMin-inExt[0]) + (inExt[1]-inExt[0])*
-          ( (j-inExt[2]-1) + (k-inExt[4]-1)*(inExt[3]-inExt[2]) );
-
-        y = origin[1] + j*spacing[1];
-        xz[1] = y;
-        s1 = inPtrY;
-        v1 = (*s1 < value ? 0 : 1);
-        
-        inPtrX = inPtrY;
-        for (i = xMin; i <= xMax; i++)
+        s2 = (inPtrX + yInc);
+        v2 = (*s2 < value ? 0 : 1);
+        if (v0 ^ v2)
           {
-          s0 = s1;
-          v0 = v1;
-          // this flag keeps up from computing gradient for grid point 0 twice.
-          g0 = 0;
-          *isect2Ptr = -1;
-          *(isect2Ptr + 1) = -1;
-          *(isect2Ptr + 2) = -1;
-          if (i < xMax)
+          if (*s0 == value)
             {
-            s1 = (inPtrX + xInc);
-            v1 = (*s1 < value ? 0 : 1);
-            if (v0 ^ v1)
+            if (*isect2Ptr > -1)
               {
-              // watch for degenerate points
-              if (*s0 == value)
-                {
-                if (i > xMin && *(isect2Ptr-3) > -1)
-                  {
-                  *isect2Ptr = *(isect2Ptr-3);
-                  }
-                else if (j > yMin && *(isect2Ptr - yisectstep + 1) > -1)
-                  {
-                  *isect2Ptr = *(isect2Ptr - yisectstep + 1);
-                  }
-                else if (k > zMin && *(isect1Ptr+2) > -1)
-                  {
-                  *isect2Ptr = *(isect1Ptr+2);
-                  }
-                }
-              else if (*s1 == value)
-                {
-                if (j > yMin && *(isect2Ptr - yisectstep +4) > -1)
-                  {
-                  *isect2Ptr = *(isect2Ptr - yisectstep + 4);
-                  }
-                else if (k > zMin && i < xMax && *(isect1Ptr + 5) > -1)
-                  {
-                  *isect2Ptr = *(isect1Ptr + 5);
-                  }
-                }
-              // if the edge has not been set yet then it is a new point
-              if (*isect2Ptr == -1)
-                {
-                t = (value - (double)(*s0)) / ((double)(*s1) - (double)(*s0));
-                x[0] = origin[0] + spacing[0]*(i+t);
-                x[1] = y;
-                *isect2Ptr = newPts->InsertNextPoint(x);
-                VTK_CSP3PA(i+1,j,k,s1);
-                outPD->InterpolateEdge(inPD, *isect2Ptr, edgePtId, edgePtId+1, t);
-                }
+              *(isect2Ptr + 1) = *isect2Ptr;
+              }
+            else if (i > xMin && *(isect2Ptr-3) > -1)
+              {
+              *(isect2Ptr + 1) = *(isect2Ptr-3);
+              }
+            else if (j > yMin && *(isect2Ptr - yisectstep + 1) > -1)
+              {
+              *(isect2Ptr + 1) = *(isect2Ptr - yisectstep + 1);
+              }
+            else if (k > zMin && *(isect1Ptr+2) > -1)
+              {
+              *(isect2Ptr + 1) = *(isect1Ptr+2);
               }
             }
-          if (j < yMax)
+          else if (*s2 == value && k > zMin && *(isect1Ptr + yisectstep + 2) > -1)
             {
-            s2 = (inPtrX + yInc);
-            v2 = (*s2 < value ? 0 : 1);
-            if (v0 ^ v2)
+            *(isect2Ptr+1) = *(isect1Ptr + yisectstep + 2);
+            }
+          // if the edge has not been set yet then it is a new point
+          if (*(isect2Ptr + 1) == -1)
+            {
+            if (generate)
               {
-              if (*s0 == value)
-                {
-                if (*isect2Ptr > -1)
-                  {
-                  *(isect2Ptr + 1) = *isect2Ptr;
-                  }
-                else if (i > xMin && *(isect2Ptr-3) > -1)
-                  {
-                  *(isect2Ptr + 1) = *(isect2Ptr-3);
-                  }
-                else if (j > yMin && *(isect2Ptr - yisectstep + 1) > -1)
-                  {
-                  *(isect2Ptr + 1) = *(isect2Ptr - yisectstep + 1);
-                  }
-                else if (k > zMin && *(isect1Ptr+2) > -1)
-                  {
-                  *(isect2Ptr + 1) = *(isect1Ptr+2);
-                  }
-                }
-              else if (*s2 == value && k > zMin && *(isect1Ptr + yisectstep + 2) > -1)
-                {
-                *(isect2Ptr+1) = *(isect1Ptr + yisectstep + 2);
-                }
-              // if the edge has not been set yet then it is a new point
-              if (*(isect2Ptr + 1) == -1)
-                {
-                t = (value - (double)(*s0)) / ((double)(*s2) - (double)(*s0));
-                x[0] = origin[0] + spacing[0]*i;
-                x[1] = y + spacing[1]*t;
-                *(isect2Ptr + 1) = newPts->InsertNextPoint(x);
-                VTK_CSP3PA(i,j+1,k,s2);
-                outPD->InterpolateEdge(inPD, *(isect2Ptr+1), edgePtId, edgePtId+yInc, t);
-                }
+              t = (value - (double)(*s0)) / ((double)(*s2) - (double)(*s0));
+              x[0] = origin[0] + spacing[0]*i;
+              x[1] = y + spacing[1]*t;
+              this->AddPoint(mode, ptId, x, value, t, edgePtId, yInc,
+                             i, j, k, s0, i, j+1, k, s2, g0, n0);
               }
+            *(isect2Ptr + 1) = static_cast<int>(ptId++);
             }
-          if (k < zMax)
+          }
+        }
+      if (k < zMax)
+        {
+        s3 = (inPtrX + zInc);
+        v3 = (*s3 < value ? 0 : 1);
+        if (v0 ^ v3)
+          {
+          if (*s0 == value)
             {
-            s3 = (inPtrX + zInc);
-            v3 = (*s3 < value ? 0 : 1);
-            if (v0 ^ v3)
+            if (*isect2Ptr > -1)
               {
-              if (*s0 == value)
-                {
-                if (*isect2Ptr > -1)
-                  {
-                  *(isect2Ptr + 2) = *isect2Ptr;
-                  }
-                else if (*(isect2Ptr+1) > -1)
-                  {
-                  *(isect2Ptr + 2) = *(isect2Ptr+1);
-                  }
-                else if (i > xMin && *(isect2Ptr-3) > -1)
-                  {
-                  *(isect2Ptr + 2) = *(isect2Ptr-3);
-                  }
-                else if (j > yMin && *(isect2Ptr - yisectstep + 1) > -1)
-                  {
-                  *(isect2Ptr + 2) = *(isect2Ptr - yisectstep + 1);
-                  }
-                else if (k > zMin && *(isect1Ptr+2) > -1)
-                  {
-                  *(isect2Ptr + 2) = *(isect1Ptr+2);
-                  }
-                }
-              if (*(isect2Ptr + 2) == -1)
-                {
-                t = (value - (double)(*s0)) / ((double)(*s3) - (double)(*s0));
-                xz[0] = origin[0] + spacing[0]*i;
-                xz[2] = z + spacing[2]*t;
-                *(isect2Ptr + 2) = newPts->InsertNextPoint(xz);
-                VTK_CSP3PA(i,j,k+1,s3);
-                outPD->InterpolateEdge(inPD, *(isect2Ptr+2), edgePtId, edgePtId+zInc, t);
-                }
+              *(isect2Ptr + 2) = *isect2Ptr;
               }
+            else if (*(isect2Ptr+1) > -1)
+              {
+              *(isect2Ptr + 2) = *(isect2Ptr+1);
+              }
+            else if (i > xMin && *(isect2Ptr-3) > -1)
+              {
+              *(isect2Ptr + 2) = *(isect2Ptr-3);
+              }
+            else if (j > yMin && *(isect2Ptr - yisectstep + 1) > -1)
+              {
+              *(isect2Ptr + 2) = *(isect2Ptr - yisectstep + 1);
+              }
+            else if (k > zMin && *(isect1Ptr+2) > -1)
+              {
+              *(isect2Ptr + 2) = *(isect1Ptr+2);
+              }
+            }
+          if (*(isect2Ptr + 2) == -1)
+            {
+            if (generate)
+              {
+              t = (value - (double)(*s0)) / ((double)(*s3) - (double)(*s0));
+              xz[0] = origin[0] + spacing[0]*i;
+              xz[2] = z + spacing[2]*t;
+              this->AddPoint(mode, ptId, xz, value, t, edgePtId, zInc,
+                             i, j, k, s0, i, j, k+1, s3, g0, n0);
+              }
+            *(isect2Ptr + 2) = static_cast<int>(ptId++);
             }
-          // To keep track of ids for interpolating attributes.
-          ++edgePtId;
-          
-          // now add any polys that need to be added
-          // basically look at the isect values, 
-          // form an index and lookup the polys
-          if (j > yMin && i < xMax && k > zMin)
+          }
+        }
+      // To keep track of ids for interpolating attributes.
+      ++edgePtId;
+
+      // now add any polys that need to be added
+      // basically look at the isect values,
+      // form an index and lookup the polys
+      if (generate && j > yMin && i < xMax && k > zMin)
+        {
+        idx = (v0 ? 4096 : 0);
+        idx = idx + (*(isect1Ptr - yisectstep) > -1 ? 2048 : 0);
+        idx = idx + (*(isect1Ptr -yisectstep +1) > -1 ? 1024 : 0);
+        idx = idx + (*(isect1Ptr -yisectstep +2) > -1 ? 512 : 0);
+        idx = idx + (*(isect1Ptr -yisectstep +4) > -1 ? 256 : 0);
+        idx = idx + (*(isect1Ptr -yisectstep +5) > -1 ? 128 : 0);
+        idx = idx + (*(isect1Ptr) > -1 ? 64 : 0);
+        idx = idx + (*(isect1Ptr + 2) > -1 ? 32 : 0);
+        idx = idx + (*(isect1Ptr + 5) > -1 ? 16 : 0);
+        idx = idx + (*(isect2Ptr -yisectstep) > -1 ? 8 : 0);
+        idx = idx + (*(isect2Ptr -yisectstep +1) > -1 ? 4 : 0);
+        idx = idx + (*(isect2Ptr -yisectstep +4) > -1 ? 2 : 0);
+        idx = idx + (*(isect2Ptr) > -1 ? 1 : 0);
+
+        tablePtr = VTK_SYNCHRONIZED_TEMPLATES_3D_TABLE_2
+          + VTK_SYNCHRONIZED_TEMPLATES_3D_TABLE_1[idx];
+        while (*tablePtr != -1)
+          {
+          ptIds[0] = *(isect1Ptr + offsets[*tablePtr]);
+          tablePtr++;
+          ptIds[1] = *(isect1Ptr + offsets[*tablePtr]);
+          tablePtr++;
+          ptIds[2] = *(isect1Ptr + offsets[*tablePtr]);
+          tablePtr++;
+          if (ptIds[0] != ptIds[1] &&
+              ptIds[0] != ptIds[2] &&
+              ptIds[1] != ptIds[2])
             {
-            idx = (v0 ? 4096 : 0);
-            idx = idx + (*(isect1Ptr - yisectstep) > -1 ? 2048 : 0);
-            idx = idx + (*(isect1Ptr -yisectstep +1) > -1 ? 1024 : 0);
-            idx = idx + (*(isect1Ptr -yisectstep +2) > -1 ? 512 : 0);
-            idx = idx + (*(isect1Ptr -yisectstep +4) > -1 ? 256 : 0);
-            idx = idx + (*(isect1Ptr -yisectstep +5) > -1 ? 128 : 0);
-            idx = idx + (*(isect1Ptr) > -1 ? 64 : 0);
-            idx = idx + (*(isect1Ptr + 2) > -1 ? 32 : 0);
-            idx = idx + (*(isect1Ptr + 5) > -1 ? 16 : 0);
-            idx = idx + (*(isect2Ptr -yisectstep) > -1 ? 8 : 0);
-            idx = idx + (*(isect2Ptr -yisectstep +1) > -1 ? 4 : 0);
-            idx = idx + (*(isect2Ptr -yisectstep +4) > -1 ? 2 : 0);
-            idx = idx + (*(isect2Ptr) > -1 ? 1 : 0);
-            
-            tablePtr = VTK_SYNCHRONIZED_TEMPLATES_3D_TABLE_2 
-              + VTK_SYNCHRONIZED_TEMPLATES_3D_TABLE_1[idx];
-            while (*tablePtr != -1)
+            if (mode == INSERT)
+              {
+              outCellId = this->NewPolys->InsertNextCell(3,ptIds);
+              this->OutCD->CopyData(this->InCD, inCellId, outCellId);
+              }
+            else
               {
-              ptIds[0] = *(isect1Ptr + offsets[*tablePtr]);
-              tablePtr++;
-              ptIds[1] = *(isect1Ptr + offsets[*tablePtr]);
-              tablePtr++;
-              ptIds[2] = *(isect1Ptr + offsets[*tablePtr]);
-              tablePtr++;
-              if (ptIds[0] != ptIds[1] &&
-                  ptIds[0] != ptIds[2] &&
-                  ptIds[1] != ptIds[2])
+              vtkstd::vector<vtkIdType> &tris = this->Triangles[piece];
+              tris.push_back(ptIds[0]);
+              tris.push_back(ptIds[1]);
+              tris.push_back(ptIds[2]);
+              if (this->CellIds)
                 {
-                outCellId = newPolys->InsertNextCell(3,ptIds);
-                outCD->CopyData(inCD, inCellId, outCellId);
+                this->CellIds[piece].push_back(inCellId);
                 }
               }
             }
-          inPtrX += xInc;
-          isect2Ptr += 3;
-          isect1Ptr += 3;
-          // To keep track of ids for copying cell attributes..
-          ++inCellId;
           }
-        inPtrY += yInc;
         }
-      inPtrZ += zInc;
+      inPtrX += xInc;
+      isect2Ptr += 3;
+      isect1Ptr += 3;
+      // To keep track of ids for copying cell attributes..
+      ++inCellId;
       }
+    inPtrY += yInc;
     }
-  delete [] isect1;
+  return ptId - firstId;
+}
+
+//----------------------------------------------------------------------------
+//
+// Contouring filter specialized for images
+//
+template <class T>
+void ContourImage(vtkSynchronizedTemplates3D *self, int *exExt,
+                  vtkInformation *inInfo,
+                  vtkImageData *data, vtkPolyData *output, T *ptr,
+                  vtkDataArray *inScalars)
+{
+  int numContours = self->GetNumberOfContours();
+  int zMin = exExt[4], zMax = exExt[5];
+  vtkSynchronizedTemplates3DLayers<T> layers;
+  layers.Initialize(self, exExt, inInfo, data, output, ptr, inScalars);
 
-  if (newScalars)
+  int *isect = layers.NewIntersections();
+  vtkIdType ptId = layers.NewPoints->GetNumberOfPoints();
+  // for each contour
+  for (int vidx = 0; vidx < numContours; vidx++)
     {
-    // Lets set the name of the scalars here.
-    if (inScalars)
+    for (int k = zMin; k <= zMax; k++)
       {
-      newScalars->SetName(inScalars->GetName());
+      self->UpdateProgress((double)vidx/numContours +
+                           (k-zMin)/((zMax - zMin+1.0)*numContours));
+      ptId += layers.ContourLayer(isect, layers.Values[vidx], k,
+                                  vtkSynchronizedTemplates3DLayers<T>::INSERT,
+                                  ptId, 0);
       }
-    idx = output->GetPointData()->AddArray(newScalars);
-    output->GetPointData()->SetActiveAttribute(idx, vtkDataSetAttributes::SCALARS);
-    newScalars->Delete();
-    newScalars = NULL;
     }
-  if (newGradients)
+  delete [] isect;
+
+  layers.Finish(output, inScalars);
+}
+
+//----------------------------------------------------------------------------
+template <class T>
+static VTK_THREAD_RETURN_TYPE vtkSynchronizedTemplates3DExecute(void *arg)
+{
+  vtkMultiThreader::ThreadInfo *info =
+    static_cast<vtkMultiThreader::ThreadInfo *>(arg);
+  vtkSynchronizedTemplates3DLayers<T> *layers =
+    static_cast<vtkSynchronizedTemplates3DLayers<T> *>(info->UserData);
+  for (int piece = info->ThreadID; piece < layers->NumberOfPieces;
+       piece += info->NumberOfThreads)
     {
-    idx = output->GetPointData()->AddArray(newGradients);
-    output->GetPointData()->SetActiveAttribute(idx, vtkDataSetAttributes::VECTORS);
-    newGradients->Delete();
-    newGradients = NULL;
+    layers->Execute(piece);
     }
-  if (newNormals)
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+//----------------------------------------------------------------------------
+// Contouring filter specialized for images, on several threads.
+template <class T>
+void ContourImageThreaded(vtkSynchronizedTemplates3D *self, int *exExt,
+                          vtkInformation *inInfo, vtkImageData *data,
+                          vtkPolyData *output, T *ptr,
+                          vtkDataArray *inScalars)
+{
+  int numContours = self->GetNumberOfContours();
+  int numLayers = exExt[5] - exExt[4] + 1;
+  int piece, idx;
+
+  vtkSynchronizedTemplates3DLayers<T> slabs;
+  slabs.Initialize(self, exExt, inInfo, data, output, ptr, inScalars);
+  slabs.NumberOfLayers = numLayers;
+  slabs.NumberOfSlabs = self->GetNumberOfThreads()*VTK_ST3D_SLABS_PER_THREAD;
+  if (slabs.NumberOfSlabs > numLayers / VTK_ST3D_MIN_SLAB_LAYERS)
     {
-    output->GetPointData()->SetNormals(newNormals);
-    newNormals->Delete();
-    newNormals = NULL;
+    slabs.NumberOfSlabs = numLayers / VTK_ST3D_MIN_SLAB_LAYERS;
     }
-}
+  slabs.NumberOfPieces = numContours*slabs.NumberOfSlabs;
+  int interpolate = slabs.OutPD->GetNumberOfArrays() > 0;
+  int copyCells = slabs.OutCD->GetNumberOfArrays() > 0;
+
+  vtkMultiThreader *threader = vtkMultiThreader::New();
+  threader->UseThreadPoolOn();
+  threader->SetNumberOfThreads(self->GetNumberOfThreads());
+  threader->SetNumberOfPieces(slabs.NumberOfPieces);
+  threader->SetSingleMethod(vtkSynchronizedTemplates3DExecute<T>, &slabs);
+
+  // Count the points of the layers, and number them contour by contour,
+  // layer by layer.
+  vtkIdType numLayerStarts = static_cast<vtkIdType>(numContours)*numLayers;
+  slabs.LayerStarts = new vtkIdType[numLayerStarts + 1];
+  slabs.Triangles = new vtkstd::vector<vtkIdType>[slabs.NumberOfPieces];
+  slabs.CellIds = NULL;
+  if (copyCells)
+    {
+    slabs.CellIds = new vtkstd::vector<vtkIdType>[slabs.NumberOfPieces];
+    }
+  slabs.Pass = 0;
+  threader->SingleMethodExecute();
+  vtkIdType numPts = 0, numTris = 0, count;
+  for (idx = 0; idx < numLayerStarts; idx++)
+    {
+    count = slabs.LayerStarts[idx];
+    slabs.LayerStarts[idx] = numPts;
+    numPts += count;
+    }
+  slabs.LayerStarts[numLayerStarts] = numPts;
+  self->UpdateProgress(0.2);
+
+  slabs.NewPoints->SetNumberOfPoints(numPts);
+  // vtkSynchronizedTemplates3DInitializeOutput() makes float points
+  slabs.Points =
+    static_cast<vtkFloatArray *>(slabs.NewPoints->GetData())->GetPointer(0);
+  slabs.Scalars = slabs.Normals = slabs.Gradients = NULL;
+  if (slabs.NewScalars)
+    {
+    slabs.NewScalars->SetNumberOfTuples(numPts);
+    slabs.Scalars = slabs.NewScalars->GetPointer(0);
+    }
+  if (slabs.NewNormals)
+    {
+    slabs.NewNormals->SetNumberOfTuples(numPts);
+    slabs.Normals = slabs.NewNormals->GetPointer(0);
+    }
+  if (slabs.NewGradients)
+    {
+    slabs.NewGradients->SetNumberOfTuples(numPts);
+    slabs.Gradients = slabs.NewGradients->GetPointer(0);
+    }
+  slabs.EdgePoints = NULL;
+  slabs.EdgeWeights = NULL;
+  if (interpolate)
+    {
+    slabs.EdgePoints = new vtkIdType[2*numPts];
+    slabs.EdgeWeights = new double[numPts];
+    }
+  slabs.Pass = 1;
+  threader->SingleMethodExecute();
+  self->UpdateProgress(0.8);
 
+  slabs.TriangleStarts = new vtkIdType[slabs.NumberOfPieces];
+  for (piece = 0; piece < slabs.NumberOfPieces; piece++)
+    {
+    slabs.TriangleStarts[piece] = numTris;
+    numTris += static_cast<vtkIdType>(slabs.Triangles[piece].size()/3);
+    }
+  slabs.Polys = slabs.NewPolys->WritePointer(numTris, 4*numTris);
+  slabs.Pass = 2;
+  threader->SingleMethodExecute();
+  threader->Delete();
 
+  // Attributes are interpolated and copied in order by this thread.
+  if (interpolate)
+    {
+    for (vtkIdType ptId = 0; ptId < numPts; ptId++)
+      {
+      slabs.OutPD->InterpolateEdge(slabs.InPD, ptId,
+                                   slabs.EdgePoints[2*ptId],
+                                   slabs.EdgePoints[2*ptId+1],
+                                   slabs.EdgeWeights[ptId]);
+      }
+    delete [] slabs.EdgePoints;
+    delete [] slabs.EdgeWeights;
+    }
+  if (copyCells)
+    {
+    vtkIdType outCellId = 0;
+    for (piece = 0; piece < slabs.NumberOfPieces; piece++)
+      {
+      vtkstd::vector<vtkIdType> &cellIds = slabs.CellIds[piece];
+      for (size_t i = 0; i < cellIds.size(); i++)
+        {
+        slabs.OutCD->CopyData(slabs.InCD, cellIds[i], outCellId++);
+        }
+      }
+    delete [] slabs.CellIds;
+    }
+  delete [] slabs.Triangles;
+  delete [] slabs.TriangleStarts;
+  delete [] slabs.LayerStarts;
 
+  slabs.Finish(output, inScalars);
+}
 
 //----------------------------------------------------------------------------
 void vtkSynchronizedTemplates3D::SetInputMemoryLimit(
@@ -698,6 +1140,17 @@ void vtkSynchronizedTemplates3D::ThreadedExecute(vtkImageData *data,
     }
   
   ptr = data->GetArrayPointerForExtent(inScalars, exExt);
+  if (this->NumberOfThreads > 1 &&
+      exExt[5] - exExt[4] + 1 >= 2*VTK_ST3D_MIN_SLAB_LAYERS)
+    {
+    switch (inScalars->GetDataType())
+      {
+      vtkTemplateMacro(
+        ContourImageThreaded(this, exExt, inInfo, data, output,
+                             (VTK_TT *)ptr, inScalars));
+      }
+    return;
+    }
   switch (inScalars->GetDataType())
     {
     vtkTemplateMacro(
@@ -856,6 +1309,7 @@ void vtkSynchronizedTemplates3D::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Compute Gradients: " << (this->ComputeGradients ? "On\n" : "Off\n");
   os << indent << "Compute Scalars: " << (this->ComputeScalars ? "On\n" : "Off\n");
   os << indent << "ArrayComponent: " << this->ArrayComponent << endl;
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << endl;
 }
 
 
@@ -18,6 +18,11 @@
 // vtkSynchronizedTemplates3D is a 3D implementation of the synchronized 
 // template algorithm. Note that vtkContourFilter will automatically
 // use this class when appropriate.
+//
+// With NumberOfThreads greater than one, slabs of the volume are contoured
+// concurrently. The output is identical to the output of a single thread:
+// points and triangles have the same ids and order whatever the number of
+// threads.
 
 // .SECTION Caveats
 // This filter is specialized to 3D images (aka volumes).
@@ -135,6 +140,13 @@ public:
   vtkSetMacro(ArrayComponent, int);
   vtkGetMacro(ArrayComponent, int);
 
+  // Description:
+  // Set/get the number of threads contouring slabs of the volume.
+  // Defaults to 1.
+  // Volumes of few slices are contoured by a single thread.
+  vtkSetClampMacro(NumberOfThreads, int, 1, VTK_LARGE_INTEGER);
+  vtkGetMacro(NumberOfThreads, int);
+
 protected:
   vtkSynchronizedTemplates3D();
   ~vtkSynchronizedTemplates3D();
@@ -152,6 +164,8 @@ protected:
 
   int ArrayComponent;
 
+  int NumberOfThreads;
+
 private:
   vtkSynchronizedTemplates3D(const vtkSynchronizedTemplates3D&);  // Not implemented.
   void operator=(const vtkSynchronizedTemplates3D&);  // Not implemented.
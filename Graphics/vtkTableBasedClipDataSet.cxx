@@ -37,6 +37,7 @@
 #include "vtkObjectFactory.h"
 #include "vtkCallbackCommand.h"
 #include "vtkInformationVector.h"
+#include "vtkMultiThreader.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 
 #include "vtkMergePoints.h"
@@ -57,9 +58,12 @@
 #include "vtkRectilinearGrid.h"
 #include "vtkUnstructuredGrid.h"
 #include "vtkGenericCell.h"
+#include "vtkIdList.h"
 
 #include "vtkTableBasedClipCases.h"
 
+#include <vtkstd/vector>
+
 vtkStandardNewMacro( vtkTableBasedClipDataSet );
 vtkCxxSetObjectMacro( vtkTableBasedClipDataSet, ClipFunction, vtkImplicitFunction );
 
@@ -197,6 +201,14 @@ class  vtkTableBasedClipperDataSetFromVolume
     
     int  AddPoint( int p1, int p2, double percent )
          { return numPrevPts + edges.AddPoint( p1, p2, percent ); }
+         
+    // Add a point without looking for one on the same edge.
+    int  AppendPoint( int p1, int p2, double percent )
+         { return numPrevPts + pt_list.AddPoint( p1, p2, percent ); }
+         
+    int  GetNumberOfPreviousPoints() const { return numPrevPts; }
+    const vtkTableBasedClipperPointList & GetPointList() const
+         { return pt_list; }
 
   protected:
     int           numPrevPts;
@@ -467,6 +479,7 @@ class vtkTableBasedClipperShapeList
     int            GetTotalNumberOfShapes() const;
     int            GetNumberOfLists() const;
     int            GetList(int, const int *& ) const;
+    void           AddShape( int, const int * );
   protected:
     int         ** list;
     int            currentList;
@@ -632,6 +645,14 @@ class  vtkTableBasedClipperVolumeFromVolume :
              { this->lines.AddLine( z, v0, v1 ); }
     void     AddVertex(int z, int v0)
              { this->vertices.AddVertex( z, v0 ); }
+    void     AddShape( int i, int z, const int * v )
+             { this->shapes[i]->AddShape( z, v ); }
+
+    const vtkTableBasedClipperCentroidPointList & GetCentroidList() const
+             { return centroid_list; }
+    int      GetNumberOfShapeLists() const { return nshapes; }
+    const vtkTableBasedClipperShapeList * GetShapeList( int i ) const
+             { return shapes[i]; }
 
   protected:
     vtkTableBasedClipperCentroidPointList centroid_list;
@@ -827,6 +848,43 @@ int  vtkTableBasedClipperShapeList::GetTotalNumberOfShapes() const
   return numFullLists * shapesPerList + numExtra;
 }
 
+void vtkTableBasedClipperShapeList::AddShape( int cellId, const int * ptIds )
+{
+  if ( currentShape >= shapesPerList )
+    {
+    if (  ( currentList + 1 )  >=  listSize  )
+      {
+      int ** tmpList = new int * [ 2 * listSize ];
+      
+      for ( int i = 0; i < listSize; i ++ )
+        {
+        tmpList[i] = list[i];
+        }
+        
+      for ( int i = listSize; i < listSize * 2; i ++ )
+        {
+        tmpList[i] = NULL;
+        }
+
+      listSize *= 2;
+      delete [] list;
+      list = tmpList;
+      }
+ 
+    currentList ++;
+    list[ currentList ] = new int[  ( shapeSize + 1 ) * shapesPerList  ];
+    currentShape = 0;
+    }
+ 
+  int * shape = list[ currentList ] + ( shapeSize + 1 ) * currentShape;
+  shape[0] = cellId;
+  for ( int i = 0; i < shapeSize; i ++ )
+    {
+    shape[ i + 1 ] = ptIds[i];
+    }
+  currentShape ++;
+}
+
 vtkTableBasedClipperHexList::vtkTableBasedClipperHexList()
     : vtkTableBasedClipperShapeList( 8 )
 {
@@ -1569,6 +1627,325 @@ inline void GetPoint( double * pt, const double * X, const double * Y,
 // ============================================================================
 
 
+// ============================================================================
+// =================== vtkTableBasedClipperPieces (begin) =====================
+// ============================================================================
+
+
+// Cells below which a piece is not worth a thread of its own.
+#define VTK_TABLE_BASED_CLIP_MIN_PIECE_CELLS 10000
+#define VTK_TABLE_BASED_CLIP_PIECES_PER_THREAD 4
+
+// Clips pieces of consecutive cells concurrently, each into a volume of its
+// own, and merges the volumes into the volume clipping all the cells in
+// order gives. The points that the pieces add on the same edge become one:
+// the edges are divided into partitions, one thread finding for each point
+// of a partition the first point on its edge, then the points, centroids
+// and shapes are appended piece after piece with their ids renumbered.
+class vtkTableBasedClipperPieces
+{
+  public:
+    vtkTableBasedClipperPieces( vtkTableBasedClipDataSet * self,
+                                vtkDataSet * inputGrd, vtkDataArray * clipAray,
+                                double isoValue, int numPieces );
+    ~vtkTableBasedClipperPieces();
+
+    void  ClipPiece( int piece );
+    void  FindFirstPoints( int partition );
+    vtkTableBasedClipperVolumeFromVolume * Merge( int numThreads, 
+                                                  vtkIdList * cantIds );
+
+    int   NumberOfPieces;
+    int   NumberOfPartitions;
+
+  protected:
+    vtkTableBasedClipDataSet * Self;
+    vtkDataSet   * InputGrd;
+    vtkDataArray * ClipAray;
+    double         IsoValue;
+    vtkIdType      NumberOfCells;
+    vtkstd::vector< vtkTableBasedClipperVolumeFromVolume * > Volumes;
+    vtkstd::vector< vtkIdList * > CantIds;
+
+    // For each point of the pieces, in order, the position of the first
+    // point on the same edge.
+    vtkstd::vector< int > FirstPoints;
+
+    int   GetPartition( const TableBasedClipperPointEntry & pe ) const
+    {
+      unsigned int key = static_cast< unsigned int >( pe.ptIds[0] ) * 
+                         2654435761U + 
+                         static_cast< unsigned int >( pe.ptIds[1] ) * 40503U;
+      return static_cast< int >( ( key >> 16 ) % NumberOfPartitions );
+    }
+
+  private:
+  vtkTableBasedClipperPieces
+    ( const vtkTableBasedClipperPieces & ); // Not implemented.
+  void operator = 
+    ( const vtkTableBasedClipperPieces & ); // Not implemented.
+};
+
+// The id in the merged volume of point ptIndx of a piece, the edge points
+// of which have the ids pntIndxs and the centroids of which come after
+// cntStart centroids.
+static inline int vtkTableBasedClipperMapPoint( int ptIndx, int numbPrev,
+                                                const int * pntIndxs,
+                                                int cntStart )
+{
+  if ( ptIndx < 0 )
+    {
+    return ptIndx - cntStart;
+    }
+  if ( ptIndx >= numbPrev )
+    {
+    return pntIndxs[ ptIndx - numbPrev ];
+    }
+  return ptIndx;
+}
+
+vtkTableBasedClipperPieces::vtkTableBasedClipperPieces
+  ( vtkTableBasedClipDataSet * self, vtkDataSet * inputGrd,
+    vtkDataArray * clipAray, double isoValue, int numPieces )
+{
+  this->Self     = self;
+  this->InputGrd = inputGrd;
+  this->ClipAray = clipAray;
+  this->IsoValue = isoValue;
+  this->NumberOfCells      = inputGrd->GetNumberOfCells();
+  this->NumberOfPieces     = numPieces;
+  this->NumberOfPartitions = 1;
+
+  int numbPnts = inputGrd->GetNumberOfPoints();
+  for ( int i = 0; i < numPieces; i ++ )
+    {
+    double numCells = double( this->NumberOfCells ) / numPieces;
+    this->Volumes.push_back( new vtkTableBasedClipperVolumeFromVolume
+      (  numbPnts, int(  pow( numCells, double( 0.6667f ) )  ) * 5 + 100  ) );
+    this->CantIds.push_back( vtkIdList::New() );
+    }
+}
+
+vtkTableBasedClipperPieces::~vtkTableBasedClipperPieces()
+{
+  for ( int i = 0; i < this->NumberOfPieces; i ++ )
+    {
+    delete this->Volumes[i];
+    this->CantIds[i]->Delete();
+    }
+  this->Self     = NULL;
+  this->InputGrd = NULL;
+  this->ClipAray = NULL;
+}
+
+void vtkTableBasedClipperPieces::ClipPiece( int piece )
+{
+  vtkIdType firstCell = this->NumberOfCells * piece / this->NumberOfPieces;
+  vtkIdType lastCell  = this->NumberOfCells * ( piece + 1 ) / 
+                        this->NumberOfPieces;
+  this->Self->ClipCellRange( this->InputGrd, this->ClipAray, this->IsoValue,
+                             firstCell, lastCell, this->Volumes[ piece ],
+                             this->CantIds[ piece ] );
+}
+
+void vtkTableBasedClipperPieces::FindFirstPoints( int partition )
+{
+  int numbPnts = static_cast< int > ( this->FirstPoints.size() );
+  vtkTableBasedClipperPointList     partPnts;
+  vtkTableBasedClipperEdgeHashTable edgeHash
+    ( numbPnts / this->NumberOfPartitions + 100, partPnts );
+
+  // the position of the first point of each edge of the partition
+  vtkstd::vector< int > firstPts;
+  int position = 0;
+  for ( int p = 0; p < this->NumberOfPieces; p ++ )
+    {
+    const vtkTableBasedClipperPointList & pt_list = 
+      this->Volumes[p]->GetPointList();
+    int nLists = pt_list.GetNumberOfLists();
+    for ( int i = 0; i < nLists; i ++ )
+      {
+      const TableBasedClipperPointEntry * pe_list = NULL;
+      int nPts = pt_list.GetList( i, pe_list );
+      for ( int j = 0; j < nPts; j ++, position ++ )
+        {
+        const TableBasedClipperPointEntry & pe = pe_list[j];
+        if ( this->GetPartition( pe ) != partition )
+          {
+          continue;
+          }
+          
+        int edgeIndx = edgeHash.AddPoint( pe.ptIds[0], pe.ptIds[1], 
+                                          pe.percent );
+        if ( edgeIndx == static_cast< int > ( firstPts.size() ) )
+          {
+          firstPts.push_back( position );
+          }
+        this->FirstPoints[ position ] = firstPts[ edgeIndx ];
+        }
+      }
+    }
+}
+
+static VTK_THREAD_RETURN_TYPE vtkTableBasedClipperClipPieces( void * arg )
+{
+  vtkMultiThreader::ThreadInfo * info = 
+    static_cast< vtkMultiThreader::ThreadInfo * > ( arg );
+  vtkTableBasedClipperPieces * pieces = 
+    static_cast< vtkTableBasedClipperPieces * > ( info->UserData );
+
+  for ( int piece = info->ThreadID; piece < pieces->NumberOfPieces;
+        piece += info->NumberOfThreads )
+    {
+    pieces->ClipPiece( piece );
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+static VTK_THREAD_RETURN_TYPE vtkTableBasedClipperFindFirstPoints( void * arg )
+{
+  vtkMultiThreader::ThreadInfo * info = 
+    static_cast< vtkMultiThreader::ThreadInfo * > ( arg );
+  vtkTableBasedClipperPieces * pieces = 
+    static_cast< vtkTableBasedClipperPieces * > ( info->UserData );
+
+  for ( int partition = info->ThreadID; 
+        partition < pieces->NumberOfPartitions;
+        partition += info->NumberOfThreads )
+    {
+    pieces->FindFirstPoints( partition );
+    }
+  return VTK_THREAD_RETURN_VALUE;
+}
+
+vtkTableBasedClipperVolumeFromVolume * vtkTableBasedClipperPieces::Merge
+  ( int numThreads, vtkIdList * cantIds )
+{
+  int i, j, k, p;
+  int numbPrev = this->Volumes[0]->GetNumberOfPreviousPoints();
+
+  // where the edge points and the centroids of each piece start among those
+  // of all the pieces
+  vtkstd::vector< int > pntStart( this->NumberOfPieces + 1, 0 );
+  vtkstd::vector< int > cntStart( this->NumberOfPieces + 1, 0 );
+  for ( p = 0; p < this->NumberOfPieces; p ++ )
+    {
+    pntStart[ p + 1 ] = pntStart[p] + 
+      this->Volumes[p]->GetPointList().GetTotalNumberOfPoints();
+    cntStart[ p + 1 ] = cntStart[p] + 
+      this->Volumes[p]->GetCentroidList().GetTotalNumberOfPoints();
+    }
+  int numbPnts = pntStart[ this->NumberOfPieces ];
+
+  // the first point on the edge of each point, one partition of the edges
+  // per thread
+  this->FirstPoints.assign( numbPnts, 0 );
+  if ( numbPnts > 0 )
+    {
+    this->NumberOfPartitions = numThreads;
+    vtkMultiThreader * threader = vtkMultiThreader::New();
+    threader->UseThreadPoolOn();
+    threader->SetNumberOfThreads( numThreads );
+    threader->SetNumberOfPieces( this->NumberOfPartitions );
+    threader->SetSingleMethod( vtkTableBasedClipperFindFirstPoints, this );
+    threader->SingleMethodExecute();
+    threader->Delete();
+    }
+
+  // Keep the first point on each edge, in order, and give the others its id.
+  vtkTableBasedClipperVolumeFromVolume * visItVFV = new
+  vtkTableBasedClipperVolumeFromVolume( numbPrev, 1 );
+  vtkstd::vector< int > pntIndxs( numbPnts + 1 );
+  int position = 0;
+  for ( p = 0; p < this->NumberOfPieces; p ++ )
+    {
+    const vtkTableBasedClipperPointList & pt_list = 
+      this->Volumes[p]->GetPointList();
+    int nLists = pt_list.GetNumberOfLists();
+    for ( i = 0; i < nLists; i ++ )
+      {
+      const TableBasedClipperPointEntry * pe_list = NULL;
+      int nPts = pt_list.GetList( i, pe_list );
+      for ( j = 0; j < nPts; j ++, position ++ )
+        {
+        const TableBasedClipperPointEntry & pe = pe_list[j];
+        int firstPnt = this->FirstPoints[ position ];
+        pntIndxs[ position ] = ( firstPnt == position ) 
+          ? visItVFV->AppendPoint( pe.ptIds[0], pe.ptIds[1], pe.percent )
+          : pntIndxs[ firstPnt ];
+        }
+      }
+    }
+
+  // Append the centroids piece after piece.
+  int shapeIds[8];
+  for ( p = 0; p < this->NumberOfPieces; p ++ )
+    {
+    const vtkTableBasedClipperCentroidPointList & centroid_list = 
+      this->Volumes[p]->GetCentroidList();
+    int nLists = centroid_list.GetNumberOfLists();
+    for ( i = 0; i < nLists; i ++ )
+      {
+      const TableBasedClipperCentroidPointEntry * ce_list = NULL;
+      int nPts = centroid_list.GetList( i, ce_list );
+      for ( j = 0; j < nPts; j ++ )
+        {
+        const TableBasedClipperCentroidPointEntry & ce = ce_list[j];
+        for ( k = 0; k < ce.nPts; k ++ )
+          {
+          shapeIds[k] = vtkTableBasedClipperMapPoint( ce.ptIds[k], numbPrev,
+                          &pntIndxs[ pntStart[p] ], cntStart[p] );
+          }
+        visItVFV->AddCentroidPoint( ce.nPts, shapeIds );
+        }
+      }
+    }
+
+  // Append the shapes of each type piece after piece.
+  for ( int s = 0; s < visItVFV->GetNumberOfShapeLists(); s ++ )
+    {
+    for ( p = 0; p < this->NumberOfPieces; p ++ )
+      {
+      const vtkTableBasedClipperShapeList * shapes = 
+        this->Volumes[p]->GetShapeList( s );
+      int shapeSize = shapes->GetShapeSize();
+      int nLists    = shapes->GetNumberOfLists();
+      for ( i = 0; i < nLists; i ++ )
+        {
+        const int * list = NULL;
+        int listSize = shapes->GetList( i, list );
+        for ( j = 0; j < listSize; j ++, list += shapeSize + 1 )
+          {
+          for ( k = 0; k < shapeSize; k ++ )
+            {
+            shapeIds[k] = vtkTableBasedClipperMapPoint( list[ k + 1 ], 
+                            numbPrev, &pntIndxs[ pntStart[p] ], cntStart[p] );
+            }
+          visItVFV->AddShape( s, list[0], shapeIds );
+          }
+        }
+      }
+    }
+
+  // the cells not clipped, in order
+  if ( cantIds )
+    {
+    for ( p = 0; p < this->NumberOfPieces; p ++ )
+      {
+      for ( i = 0; i < this->CantIds[p]->GetNumberOfIds(); i ++ )
+        {
+        cantIds->InsertNextId( this->CantIds[p]->GetId( i ) );
+        }
+      }
+    }
+
+  return visItVFV;
+}
+// ============================================================================
+// =================== vtkTableBasedClipperPieces ( end ) =====================
+// ============================================================================
+
+
 //-----------------------------------------------------------------------------
 // Construct with user-specified implicit function; InsideOut turned off; value
 // set to 0.0; and generate clip scalars turned off.
@@ -1589,6 +1966,7 @@ vtkTableBasedClipDataSet::vtkTableBasedClipDataSet( vtkImplicitFunction * cf )
   this->UseValueAsOffset      = true;
   this->GenerateClipScalars   = 0;
   this->GenerateClippedOutput = 0;
+  this->NumberOfThreads = 1;
 
   this->SetNumberOfOutputPorts( 2 );
   vtkUnstructuredGrid * output2 = vtkUnstructuredGrid::New();
@@ -2075,31 +2453,94 @@ void vtkTableBasedClipDataSet::ClipImageData( vtkDataSet * inputGrd,
 }
 
 //-----------------------------------------------------------------------------
-void vtkTableBasedClipDataSet::ClipPolyData( vtkDataSet * inputGrd, 
-     vtkDataArray * clipAray, double isoValue, vtkUnstructuredGrid * outputUG )
+vtkTableBasedClipperVolumeFromVolume * vtkTableBasedClipDataSet::ClipCells
+  ( vtkDataSet * inputGrd, vtkDataArray * clipAray, double isoValue,
+    vtkIdList * cantIds )
 {
-  vtkPolyData * polyData = vtkPolyData::SafeDownCast( inputGrd );
-  int           numCells = polyData->GetNumberOfCells();
+  vtkIdType numCells = inputGrd->GetNumberOfCells();
+  vtkIdType numPiece = numCells / VTK_TABLE_BASED_CLIP_MIN_PIECE_CELLS;
+  if ( numPiece > VTK_TABLE_BASED_CLIP_PIECES_PER_THREAD * 
+                  this->NumberOfThreads )
+    {
+    numPiece = VTK_TABLE_BASED_CLIP_PIECES_PER_THREAD * this->NumberOfThreads;
+    }
+    
+  if ( this->NumberOfThreads < 2 || numPiece < 2 )
+    {
+    vtkTableBasedClipperVolumeFromVolume   * visItVFV = new
+    vtkTableBasedClipperVolumeFromVolume(    inputGrd->GetNumberOfPoints(),
+      int(   pow(  double( numCells ), double( 0.6667f )  )   ) * 5 + 100    );
+    this->ClipCellRange( inputGrd, clipAray, isoValue, 0, numCells, 
+                         visItVFV, cantIds );
+    return visItVFV;
+    }
+
+  // ClipPolyDataCells() looks the cells up with GetCellType(), which
+  // would otherwise build the cell map of the polydata in the first piece
+  inputGrd->PrepareForThreadedAccess();
+  vtkTableBasedClipperPieces pieces( this, inputGrd, clipAray, isoValue,
+                                     static_cast< int > ( numPiece ) );
+  vtkMultiThreader * threader = vtkMultiThreader::New();
+  threader->UseThreadPoolOn();
+  threader->SetNumberOfThreads( this->NumberOfThreads );
+  threader->SetNumberOfPieces( pieces.NumberOfPieces );
+  threader->SetSingleMethod( vtkTableBasedClipperClipPieces, &pieces );
+  threader->SingleMethodExecute();
+  threader->Delete();
+  
+  return pieces.Merge( this->NumberOfThreads, cantIds );
+}
 
-  vtkTableBasedClipperVolumeFromVolume   * visItVFV = new
-  vtkTableBasedClipperVolumeFromVolume(    polyData->GetNumberOfPoints(),
-     int(   pow(  double( numCells ),  double( 0.6667f )  )   ) * 5 + 100    );
+//-----------------------------------------------------------------------------
+void vtkTableBasedClipDataSet::ClipCellRange( vtkDataSet * inputGrd, 
+     vtkDataArray * clipAray, double isoValue, vtkIdType firstCell, 
+     vtkIdType lastCell, vtkTableBasedClipperVolumeFromVolume * visItVFV,
+     vtkIdList * cantIds )
+{
+  switch ( inputGrd->GetDataObjectType() )
+    {
+    case VTK_POLY_DATA:
+      this->ClipPolyDataCells( inputGrd, clipAray, isoValue, firstCell, 
+                               lastCell, visItVFV, cantIds );
+      break;
+      
+    case VTK_RECTILINEAR_GRID:
+      this->ClipRectilinearGridCells( inputGrd, clipAray, isoValue, 
+                                      firstCell, lastCell, visItVFV );
+      break;
+      
+    case VTK_STRUCTURED_GRID:
+      this->ClipStructuredGridCells( inputGrd, clipAray, isoValue, 
+                                     firstCell, lastCell, visItVFV );
+      break;
+      
+    case VTK_UNSTRUCTURED_GRID:
+      this->ClipUnstructuredGridCells( inputGrd, clipAray, isoValue, 
+                                       firstCell, lastCell, visItVFV, cantIds );
+      break;
+    }
+}
 
-  vtkUnstructuredGrid * specials = vtkUnstructuredGrid::New();
-  specials->SetPoints( polyData->GetPoints() );
-  specials->GetPointData()->ShallowCopy( polyData->GetPointData() );
-  specials->Allocate( numCells );
+//-----------------------------------------------------------------------------
+void vtkTableBasedClipDataSet::ClipPolyDataCells( vtkDataSet * inputGrd, 
+     vtkDataArray * clipAray, double isoValue, vtkIdType firstCell, 
+     vtkIdType lastCell, vtkTableBasedClipperVolumeFromVolume * visItVFV,
+     vtkIdList * cantIds )
+{
+  vtkPolyData * polyData = vtkPolyData::SafeDownCast( inputGrd );
+  vtkIdList   * cellPnts = vtkIdList::New();
 
   vtkIdType   i, j;
   vtkIdType   numbPnts = 0;
-  int         numCants = 0;  // number of cells not clipped by this filter
   
-  for ( i = 0; i < numCells; i ++ )
+  for ( i = firstCell; i < lastCell; i ++ )
     {
     int         cellType = polyData->GetCellType( i );
     bool        bCanClip = false;
     vtkIdType * pntIndxs = NULL;
-    polyData->GetCellPoints( i, numbPnts, pntIndxs );
+    polyData->GetCellPoints( i, cellPnts );
+    numbPnts = cellPnts->GetNumberOfIds();
+    pntIndxs = cellPnts->GetPointer( 0 );
     
     switch ( cellType )
       {
@@ -2364,21 +2805,52 @@ void vtkTableBasedClipDataSet::ClipPolyData( vtkDataSet * inputGrd,
       }
     else
       {
-      if ( numCants == 0 )
-        {
-        specials->GetCellData()
-                ->CopyAllocate( polyData->GetCellData(), numCells );
-        }
-
-      specials->InsertNextCell( cellType, numbPnts, pntIndxs );
-      specials->GetCellData()
-              ->CopyData( polyData->GetCellData(), i, numCants );
-      numCants ++;
+      cantIds->InsertNextId( i );
       }
       
     pntIndxs = NULL;
     }
   
+  cellPnts->Delete();
+  cellPnts = NULL;
+  polyData = NULL;
+}
+
+//-----------------------------------------------------------------------------
+void vtkTableBasedClipDataSet::ClipPolyData( vtkDataSet * inputGrd, 
+     vtkDataArray * clipAray, double isoValue, vtkUnstructuredGrid * outputUG )
+{
+  vtkPolyData * polyData = vtkPolyData::SafeDownCast( inputGrd );
+  vtkIdList   * cantIds  = vtkIdList::New(); // cells not clipped by this filter
+
+  vtkTableBasedClipperVolumeFromVolume   * visItVFV = 
+  this->ClipCells( polyData, clipAray, isoValue, cantIds );
+
+  vtkIdType   i;
+  vtkIdType   numbPnts = 0;
+  vtkIdType * pntIndxs = NULL;
+  int         numCants = cantIds->GetNumberOfIds();
+
+  vtkUnstructuredGrid * specials = vtkUnstructuredGrid::New();
+  specials->SetPoints( polyData->GetPoints() );
+  specials->GetPointData()->ShallowCopy( polyData->GetPointData() );
+  specials->Allocate( numCants );
+  specials->GetCellData()->CopyAllocate( polyData->GetCellData(), numCants );
+
+  for ( i = 0; i < numCants; i ++ )
+    {
+    vtkIdType cellIndx = cantIds->GetId( i );
+    polyData->GetCellPoints( cellIndx, numbPnts, pntIndxs );
+    specials->InsertNextCell
+              ( polyData->GetCellType( cellIndx ), numbPnts, pntIndxs );
+    specials->GetCellData()
+            ->CopyData( polyData->GetCellData(), cellIndx, i );
+    }
+  cantIds->Delete();
+  cantIds  = NULL;
+  pntIndxs = NULL;
+  
+  
 
   int         toDelete = 0;
   double    * theCords = NULL;
@@ -2443,22 +2915,17 @@ void vtkTableBasedClipDataSet::ClipPolyData( vtkDataSet * inputGrd,
 }
 
 //-----------------------------------------------------------------------------
-void vtkTableBasedClipDataSet::ClipRectilinearGridData( vtkDataSet * inputGrd, 
-     vtkDataArray * clipAray, double isoValue, vtkUnstructuredGrid * outputUG )
+void vtkTableBasedClipDataSet::ClipRectilinearGridCells( vtkDataSet * inputGrd,
+     vtkDataArray * clipAray, double isoValue, vtkIdType firstCell, 
+     vtkIdType lastCell, vtkTableBasedClipperVolumeFromVolume * visItVFV )
 {
   vtkRectilinearGrid * rectGrid = vtkRectilinearGrid::SafeDownCast( inputGrd );
   
   int   i, j;
-  int   numCells = 0;
   int   isTwoDim = 0;
   int   rectDims[3];
   rectGrid->GetDimensions( rectDims );
   isTwoDim = int( rectDims[2] <= 1 );
-  numCells = rectGrid->GetNumberOfCells();
-
-  vtkTableBasedClipperVolumeFromVolume   * visItVFV = new
-  vtkTableBasedClipperVolumeFromVolume(    rectGrid->GetNumberOfPoints(),
-      int(   pow(  double( numCells ), double( 0.6667f )  )   ) * 5 + 100    );
 
   int   shiftLUT[3][8] = { 
                            { 0, 1, 1, 0, 0, 1, 1, 0 },
@@ -2471,7 +2938,7 @@ void vtkTableBasedClipDataSet::ClipRectilinearGridData( vtkDataSet * inputGrd,
   int   pyStride    = rectDims[0];
   int   pzStride    = rectDims[0] * rectDims[1];
   
-  for ( i = 0; i < numCells; i ++ )
+  for ( i = static_cast< int >( firstCell ); i < lastCell; i ++ )
     {     
     int    caseIndx = 0;   
     int    nCellPts = isTwoDim ? 4 : 8;
@@ -2712,6 +3179,21 @@ void vtkTableBasedClipDataSet::ClipRectilinearGridData( vtkDataSet * inputGrd,
     thisCase = NULL;
     }
   
+  rectGrid = NULL;
+}
+
+//-----------------------------------------------------------------------------
+void vtkTableBasedClipDataSet::ClipRectilinearGridData( vtkDataSet * inputGrd, 
+     vtkDataArray * clipAray, double isoValue, vtkUnstructuredGrid * outputUG )
+{
+  vtkRectilinearGrid * rectGrid = vtkRectilinearGrid::SafeDownCast( inputGrd );
+  
+  int   i, j;
+  int   rectDims[3];
+  rectGrid->GetDimensions( rectDims );
+
+  vtkTableBasedClipperVolumeFromVolume   * visItVFV = 
+  this->ClipCells( rectGrid, clipAray, isoValue, NULL );
   
   int            toDelete    = 0;
   double       * theCords[3] = { NULL, NULL, NULL };
@@ -2765,24 +3247,18 @@ void vtkTableBasedClipDataSet::ClipRectilinearGridData( vtkDataSet * inputGrd,
 }
 
 //-----------------------------------------------------------------------------
-void vtkTableBasedClipDataSet::ClipStructuredGridData( vtkDataSet * inputGrd, 
-     vtkDataArray * clipAray, double isoValue, vtkUnstructuredGrid * outputUG )
+void vtkTableBasedClipDataSet::ClipStructuredGridCells( vtkDataSet * inputGrd,
+     vtkDataArray * clipAray, double isoValue, vtkIdType firstCell, 
+     vtkIdType lastCell, vtkTableBasedClipperVolumeFromVolume * visItVFV )
 {
   vtkStructuredGrid * strcGrid = vtkStructuredGrid::SafeDownCast( inputGrd );
   
   int   i, j;
   int   isTwoDim    = 0;
-  int   numCells    = 0;
   int   gridDims[3] = { 0, 0, 0 };
   strcGrid->GetDimensions( gridDims );
   isTwoDim = int( gridDims[2] <= 1 );
-  numCells = strcGrid->GetNumberOfCells();
-
-  vtkTableBasedClipperVolumeFromVolume  *  visItVFV = new
-  vtkTableBasedClipperVolumeFromVolume(    strcGrid->GetNumberOfPoints(),
-      int(   pow(  double( numCells ), double( 0.6667f )  )   ) * 5 + 100    );
 
-  
   int   shiftLUT[3][8] = { 
                            { 0, 1, 1, 0, 0, 1, 1, 0 },
                            { 0, 0, 1, 1, 0, 0, 1, 1 },
@@ -2795,7 +3271,7 @@ void vtkTableBasedClipDataSet::ClipStructuredGridData( vtkDataSet * inputGrd,
   int   pyStride    = gridDims[0];
   int   pzStride    = gridDims[0] * gridDims[1];
   
-  for ( i = 0; i < numCells; i ++ )
+  for ( i = static_cast< int >( firstCell ); i < lastCell; i ++ )
     {
     int    caseIndx = 0;
     int    theCellI = i % cellDims[0];
@@ -3012,6 +3488,21 @@ void vtkTableBasedClipDataSet::ClipStructuredGridData( vtkDataSet * inputGrd,
     thisCase = NULL;
     }
   
+  strcGrid = NULL;
+}
+
+//-----------------------------------------------------------------------------
+void vtkTableBasedClipDataSet::ClipStructuredGridData( vtkDataSet * inputGrd, 
+     vtkDataArray * clipAray, double isoValue, vtkUnstructuredGrid * outputUG )
+{
+  vtkStructuredGrid * strcGrid = vtkStructuredGrid::SafeDownCast( inputGrd );
+  
+  int   i;
+  int   numbPnts = 0;
+
+  vtkTableBasedClipperVolumeFromVolume  *  visItVFV = 
+  this->ClipCells( strcGrid, clipAray, isoValue, NULL );
+  
   int         toDelete = 0;
   double    * theCords = NULL;
   vtkPoints * inputPts = strcGrid->GetPoints();
@@ -3046,32 +3537,24 @@ void vtkTableBasedClipDataSet::ClipStructuredGridData( vtkDataSet * inputGrd,
 }
 
 //-----------------------------------------------------------------------------
-void vtkTableBasedClipDataSet::ClipUnstructuredGridData( vtkDataSet * inputGrd, 
-     vtkDataArray * clipAray, double isoValue, vtkUnstructuredGrid * outputUG )
+void vtkTableBasedClipDataSet::ClipUnstructuredGridCells( vtkDataSet * inputGrd,
+     vtkDataArray * clipAray, double isoValue, vtkIdType firstCell, 
+     vtkIdType lastCell, vtkTableBasedClipperVolumeFromVolume * visItVFV,
+     vtkIdList * cantIds )
 { 
   vtkUnstructuredGrid * unstruct = vtkUnstructuredGrid::SafeDownCast( inputGrd );
+  vtkIdList           * cellPnts = vtkIdList::New();
   
   vtkIdType   i, j;
   vtkIdType   numbPnts = 0;
-  int         numCants = 0; // number of cells not clipped by this filter
-  int         numCells = unstruct->GetNumberOfCells();
-  
-  // volume from volume
-  vtkTableBasedClipperVolumeFromVolume   * visItVFV = new
-  vtkTableBasedClipperVolumeFromVolume(    unstruct->GetNumberOfPoints(), 
-      int(   pow(  double( numCells ), double( 0.6667f )  )   ) * 5 + 100    );
 
-  // the stuffs that can not be clipped by this filter
-  vtkUnstructuredGrid * specials = vtkUnstructuredGrid::New();
-  specials->SetPoints( unstruct->GetPoints() );
-  specials->GetPointData()->ShallowCopy( unstruct->GetPointData() );
-  specials->Allocate( numCells );
-
-  for ( i = 0; i < numCells; i ++ )
+  for ( i = firstCell; i < lastCell; i ++ )
     {
     int         cellType = unstruct->GetCellType( i );
     vtkIdType * pntIndxs = NULL;
-    unstruct->GetCellPoints( i, numbPnts, pntIndxs );
+    unstruct->GetCellPoints( i, cellPnts );
+    numbPnts = cellPnts->GetNumberOfIds();
+    pntIndxs = cellPnts->GetPointer( 0 );
     
     bool     bCanClip = false;
     switch ( cellType )
@@ -3360,36 +3843,62 @@ void vtkTableBasedClipDataSet::ClipUnstructuredGridData( vtkDataSet * inputGrd,
       edgeVtxs = NULL;
       thisCase = NULL;
       }
-    else if (cellType == VTK_POLYHEDRON)
-      {
-      if ( numCants == 0 )
-        {
-          specials->GetCellData()
-                  ->CopyAllocate( unstruct->GetCellData(), numCells );
-        }
-      vtkIdType nfaces, *facePtIds;
-      unstruct->GetFaceStream(i, nfaces, facePtIds);
-      specials->InsertNextCell(cellType, nfaces, facePtIds);
-      specials->GetCellData()
-              ->CopyData( unstruct->GetCellData(), i, numCants );
-      numCants ++;
-      }
     else
       {
-      if ( numCants == 0 )
-        {
-          specials->GetCellData()
-                  ->CopyAllocate( unstruct->GetCellData(), numCells );
-        }
-      specials->InsertNextCell( cellType, numbPnts, pntIndxs );
-      specials->GetCellData()
-              ->CopyData( unstruct->GetCellData(), i, numCants );
-      numCants ++;
+      cantIds->InsertNextId( i );
       }
       
     pntIndxs = NULL;
     }
   
+  cellPnts->Delete();
+  cellPnts = NULL;
+  unstruct = NULL;
+}
+
+//-----------------------------------------------------------------------------
+void vtkTableBasedClipDataSet::ClipUnstructuredGridData( vtkDataSet * inputGrd, 
+     vtkDataArray * clipAray, double isoValue, vtkUnstructuredGrid * outputUG )
+{ 
+  vtkUnstructuredGrid * unstruct = vtkUnstructuredGrid::SafeDownCast( inputGrd );
+  vtkIdList           * cantIds  = vtkIdList::New(); // cells not clipped
+  
+  // volume from volume
+  vtkTableBasedClipperVolumeFromVolume   * visItVFV = 
+  this->ClipCells( unstruct, clipAray, isoValue, cantIds );
+
+  vtkIdType   i;
+  vtkIdType   numbPnts = 0;
+  vtkIdType * pntIndxs = NULL;
+  int         numCants = cantIds->GetNumberOfIds();
+
+  // the stuffs that can not be clipped by this filter
+  vtkUnstructuredGrid * specials = vtkUnstructuredGrid::New();
+  specials->SetPoints( unstruct->GetPoints() );
+  specials->GetPointData()->ShallowCopy( unstruct->GetPointData() );
+  specials->Allocate( numCants );
+  specials->GetCellData()->CopyAllocate( unstruct->GetCellData(), numCants );
+
+  for ( i = 0; i < numCants; i ++ )
+    {
+    vtkIdType cellIndx = cantIds->GetId( i );
+    int       cellType = unstruct->GetCellType( cellIndx );
+    if ( cellType == VTK_POLYHEDRON )
+      {
+      unstruct->GetFaceStream( cellIndx, numbPnts, pntIndxs );
+      }
+    else
+      {
+      unstruct->GetCellPoints( cellIndx, numbPnts, pntIndxs );
+      }
+    specials->InsertNextCell( cellType, numbPnts, pntIndxs );
+    specials->GetCellData()
+            ->CopyData( unstruct->GetCellData(), cellIndx, i );
+    }
+  cantIds->Delete();
+  cantIds  = NULL;
+  pntIndxs = NULL;
+  
   int         toDelete = 0;
   double    * theCords = NULL;
   vtkPoints * inputPts = unstruct->GetPoints();
@@ -3485,4 +3994,6 @@ void vtkTableBasedClipDataSet::PrintSelf( ostream & os, vtkIndent indent )
 
   os << indent << "UseValueAsOffset: " 
      << (this->UseValueAsOffset ? "On\n" : "Off\n");
+
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << "\n";
 }
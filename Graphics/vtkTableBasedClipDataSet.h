@@ -94,8 +94,12 @@
 #include "vtkUnstructuredGridAlgorithm.h"
 
 class vtkCallbackCommand;
+class vtkIdList;
 class vtkImplicitFunction;
 class vtkIncrementalPointLocator;
+//BTX
+class vtkTableBasedClipperVolumeFromVolume;
+//ETX
 
 class VTK_GRAPHICS_EXPORT vtkTableBasedClipDataSet : public vtkUnstructuredGridAlgorithm
 {
@@ -187,6 +191,14 @@ public:
   // Return the clipped output.
   vtkUnstructuredGrid * GetClippedOutput();
 
+  // Description:
+  // Set/Get the number of threads clipping the cells. A dataset of more
+  // than a few tens of thousands of cells is clipped in pieces of
+  // consecutive cells by this many threads, and the pieces are merged into
+  // exactly the output clipping the cells in order gives. Defaults to 1.
+  vtkSetClampMacro( NumberOfThreads, int, 1, VTK_LARGE_INTEGER );
+  vtkGetMacro( NumberOfThreads, int );
+
   // Description:
   // Overridden to process REQUEST_UPDATE_EXTENT_INFORMATION.
   virtual int ProcessRequest( vtkInformation *,
@@ -244,6 +256,46 @@ protected:
   // (provided via SetClipFunction()). The clipping result is exported to outputUG.
   void ClipUnstructuredGridData( vtkDataSet * inputGrd, vtkDataArray * clipAray, 
                                  double isoValue, vtkUnstructuredGrid * outputUG );
+
+//BTX
+  // Description:
+  // This function clips all the cells of a vtkPolyData, vtkRectilinearGrid,
+  // vtkStructuredGrid or vtkUnstructuredGrid into a new volume, which the
+  // caller deletes, in pieces by NumberOfThreads threads when there are
+  // enough cells. The ids of the cells that this filter can not clip are
+  // appended to cantIds in order.
+  vtkTableBasedClipperVolumeFromVolume * ClipCells( vtkDataSet * inputGrd,
+    vtkDataArray * clipAray, double isoValue, vtkIdList * cantIds );
+
+  // Description:
+  // These functions clip cells firstCell to lastCell - 1 of a dataset into
+  // visItVFV, appending the ids of the cells that can not be clipped to
+  // cantIds. They only read the dataset, so that several threads clip
+  // different cells into different volumes at once.
+  void ClipCellRange( vtkDataSet * inputGrd, vtkDataArray * clipAray, 
+                      double isoValue, vtkIdType firstCell, vtkIdType lastCell,
+                      vtkTableBasedClipperVolumeFromVolume * visItVFV,
+                      vtkIdList * cantIds );
+  void ClipPolyDataCells( vtkDataSet * inputGrd, vtkDataArray * clipAray, 
+                          double isoValue, vtkIdType firstCell, 
+                          vtkIdType lastCell, 
+                          vtkTableBasedClipperVolumeFromVolume * visItVFV,
+                          vtkIdList * cantIds );
+  void ClipRectilinearGridCells( vtkDataSet * inputGrd, vtkDataArray * clipAray,
+                                 double isoValue, vtkIdType firstCell, 
+                                 vtkIdType lastCell, 
+                                 vtkTableBasedClipperVolumeFromVolume * visItVFV );
+  void ClipStructuredGridCells( vtkDataSet * inputGrd, vtkDataArray * clipAray,
+                                double isoValue, vtkIdType firstCell, 
+                                vtkIdType lastCell, 
+                                vtkTableBasedClipperVolumeFromVolume * visItVFV );
+  void ClipUnstructuredGridCells( vtkDataSet * inputGrd, vtkDataArray * clipAray,
+                                  double isoValue, vtkIdType firstCell, 
+                                  vtkIdType lastCell, 
+                                  vtkTableBasedClipperVolumeFromVolume * visItVFV,
+                                  vtkIdList * cantIds );
+  friend class vtkTableBasedClipperPieces;
+//ETX
        
   
   // Description:
@@ -262,6 +314,7 @@ protected:
   bool   UseValueAsOffset;
   double Value;
   double MergeTolerance;
+  int    NumberOfThreads;
   vtkCallbackCommand         * InternalProgressObserver;
   vtkImplicitFunction        * ClipFunction;
   vtkIncrementalPointLocator * Locator;
@@ -21,11 +21,174 @@
 #include "vtkInformationVector.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
+#include "vtkSIMD.h"
 
 #include <math.h>
 
 vtkStandardNewMacro(vtkVectorNorm);
 
+//----------------------------------------------------------------------------
+// Norms of the vectors begin to end-1 of a 3-component array of type T.
+template <class T>
+static void vtkVectorNormScalar(const T *v, float *s,
+                                vtkIdType begin, vtkIdType end,
+                                double &maxScalar)
+{
+  for (vtkIdType i = begin; i < end; i++)
+    {
+    const T *p = v + 3*i;
+    double norm = sqrt(static_cast<double>(p[0])*p[0] +
+                       static_cast<double>(p[1])*p[1] +
+                       static_cast<double>(p[2])*p[2]);
+    if ( norm > maxScalar )
+      {
+      maxScalar = norm;
+      }
+    s[i] = static_cast<float>(norm);
+    }
+}
+
+#ifdef VTK_USE_SSE2
+//----------------------------------------------------------------------------
+// Four float vectors (three aligned loads) at a time, once both arrays are
+// aligned.  The norms are computed in double precision in the same order
+// as in vtkVectorNormScalar, so they are the same.  Returns the first
+// vector left to do.
+static vtkIdType vtkVectorNormSSE2(const float *v, float *s,
+                                   vtkIdType begin, vtkIdType end,
+                                   double &maxScalar)
+{
+  if (!vtkSIMDIsAligned(v, 16) || !vtkSIMDIsAligned(s, 16))
+    {
+    return begin;
+    }
+  vtkIdType i = (begin + 3) / 4 * 4;
+  if (i >= end)
+    {
+    return begin;
+    }
+  vtkVectorNormScalar(v, s, begin, i, maxScalar);
+
+  __m128d m = _mm_set1_pd(maxScalar);
+  for (; i + 4 <= end; i += 4)
+    {
+    const float *p = v + 3*i;
+    __m128 a = _mm_load_ps(p);
+    __m128 b = _mm_load_ps(p + 4);
+    __m128 c = _mm_load_ps(p + 8);
+    __m128d a0 = _mm_cvtps_pd(a);                 // x0 y0
+    __m128d a1 = _mm_cvtps_pd(_mm_movehl_ps(a, a)); // z0 x1
+    __m128d b0 = _mm_cvtps_pd(b);                 // y1 z1
+    __m128d b1 = _mm_cvtps_pd(_mm_movehl_ps(b, b)); // x2 y2
+    __m128d c0 = _mm_cvtps_pd(c);                 // z2 x3
+    __m128d c1 = _mm_cvtps_pd(_mm_movehl_ps(c, c)); // y3 z3
+
+    __m128d x = _mm_shuffle_pd(a0, a1, 2);
+    __m128d y = _mm_shuffle_pd(a0, b0, 1);
+    __m128d z = _mm_shuffle_pd(a1, b0, 2);
+    __m128d n0 = _mm_sqrt_pd(_mm_add_pd(
+      _mm_add_pd(_mm_mul_pd(x, x), _mm_mul_pd(y, y)), _mm_mul_pd(z, z)));
+    x = _mm_shuffle_pd(b1, c0, 2);
+    y = _mm_shuffle_pd(b1, c1, 1);
+    z = _mm_shuffle_pd(c0, c1, 2);
+    __m128d n1 = _mm_sqrt_pd(_mm_add_pd(
+      _mm_add_pd(_mm_mul_pd(x, x), _mm_mul_pd(y, y)), _mm_mul_pd(z, z)));
+
+    m = _mm_max_pd(n0, m);
+    m = _mm_max_pd(n1, m);
+    _mm_store_ps(s + i, _mm_movelh_ps(_mm_cvtpd_ps(n0), _mm_cvtpd_ps(n1)));
+    }
+
+  double lanes[2];
+  _mm_storeu_pd(lanes, m);
+  maxScalar = (lanes[0] > lanes[1]) ? lanes[0] : lanes[1];
+  return i;
+}
+
+//----------------------------------------------------------------------------
+// Two double vectors (three aligned loads) at a time.
+static vtkIdType vtkVectorNormSSE2(const double *v, float *s,
+                                   vtkIdType begin, vtkIdType end,
+                                   double &maxScalar)
+{
+  if (!vtkSIMDIsAligned(v, 16) || !vtkSIMDIsAligned(s, 16))
+    {
+    return begin;
+    }
+  vtkIdType i = (begin + 1) / 2 * 2;
+  if (i >= end)
+    {
+    return begin;
+    }
+  vtkVectorNormScalar(v, s, begin, i, maxScalar);
+
+  __m128d m = _mm_set1_pd(maxScalar);
+  for (; i + 2 <= end; i += 2)
+    {
+    const double *p = v + 3*i;
+    __m128d a = _mm_load_pd(p);     // x0 y0
+    __m128d b = _mm_load_pd(p + 2); // z0 x1
+    __m128d c = _mm_load_pd(p + 4); // y1 z1
+    __m128d x = _mm_shuffle_pd(a, b, 2);
+    __m128d y = _mm_shuffle_pd(a, c, 1);
+    __m128d z = _mm_shuffle_pd(b, c, 2);
+    __m128d n = _mm_sqrt_pd(_mm_add_pd(
+      _mm_add_pd(_mm_mul_pd(x, x), _mm_mul_pd(y, y)), _mm_mul_pd(z, z)));
+    m = _mm_max_pd(n, m);
+    _mm_storel_pi(reinterpret_cast<__m64*>(s + i), _mm_cvtpd_ps(n));
+    }
+
+  double lanes[2];
+  _mm_storeu_pd(lanes, m);
+  maxScalar = (lanes[0] > lanes[1]) ? lanes[0] : lanes[1];
+  return i;
+}
+#endif
+
+//----------------------------------------------------------------------------
+// Compute the norms of the vectors begin to end-1 into scalars and update
+// maxScalar.  Float and double vectors are read directly, with SSE2 when
+// the arrays are aligned, and the other types through GetTuple().
+static void vtkVectorNormExecute(vtkDataArray *vectors, vtkFloatArray *scalars,
+                                 vtkIdType begin, vtkIdType end,
+                                 double &maxScalar)
+{
+  float *s = scalars->GetPointer(0);
+  vtkIdType i = begin;
+  if (vectors->GetNumberOfComponents() == 3 &&
+      vectors->GetDataType() == VTK_FLOAT)
+    {
+    const float *v = static_cast<float *>(vectors->GetVoidPointer(0));
+#ifdef VTK_USE_SSE2
+    i = vtkVectorNormSSE2(v, s, begin, end, maxScalar);
+#endif
+    vtkVectorNormScalar(v, s, i, end, maxScalar);
+    return;
+    }
+  if (vectors->GetNumberOfComponents() == 3 &&
+      vectors->GetDataType() == VTK_DOUBLE)
+    {
+    const double *v = static_cast<double *>(vectors->GetVoidPointer(0));
+#ifdef VTK_USE_SSE2
+    i = vtkVectorNormSSE2(v, s, begin, end, maxScalar);
+#endif
+    vtkVectorNormScalar(v, s, i, end, maxScalar);
+    return;
+    }
+
+  double v[3], norm;
+  for (; i < end; i++)
+    {
+    vectors->GetTuple(i, v);
+    norm = sqrt((double)v[0]*v[0] + v[1]*v[1] + v[2]*v[2]);
+    if ( norm > maxScalar )
+      {
+      maxScalar = norm;
+      }
+    s[i] = static_cast<float>(norm);
+    }
+}
+
 // Construct with normalize flag off.
 vtkVectorNorm::vtkVectorNorm()
 {
@@ -51,7 +214,8 @@ int vtkVectorNorm::RequestData(
   vtkIdType numVectors, i;
   int computePtScalars=1, computeCellScalars=1;
   vtkFloatArray *newScalars;
-  double v[3], s, maxScalar;
+  float *s;
+  double maxScalar;
   vtkDataArray *ptVectors, *cellVectors;
   vtkPointData *pd=input->GetPointData(), *outPD=output->GetPointData();
   vtkCellData *cd=input->GetCellData(), *outCD=output->GetCellData();
@@ -90,31 +254,22 @@ int vtkVectorNorm::RequestData(
     newScalars->SetNumberOfTuples(numVectors);
 
     progressInterval=numVectors/10+1;
-    for (maxScalar=0.0, i=0; i < numVectors && !abort; i++)
+    for (maxScalar=0.0, i=0; i < numVectors && !abort; i += progressInterval)
       {
-      ptVectors->GetTuple(i, v);
-      s = sqrt((double)v[0]*v[0] + v[1]*v[1] + v[2]*v[2]);
-      if ( s > maxScalar )
-        {
-        maxScalar = s;
-        }
-      newScalars->SetComponent(i,0,s);
-
-      if ( ! (i % progressInterval) ) 
-        {
-        vtkDebugMacro(<<"Computing point vector norm #" << i);
-        this->UpdateProgress (0.5*i/numVectors);
-        }
+      vtkDebugMacro(<<"Computing point vector norm #" << i);
+      this->UpdateProgress (0.5*i/numVectors);
+      vtkVectorNormExecute(ptVectors, newScalars, i,
+                           (numVectors - i > progressInterval ?
+                            i + progressInterval : numVectors), maxScalar);
       }
 
     // If necessary, normalize
     if ( this->Normalize && maxScalar > 0.0 )
       {
+      s = newScalars->GetPointer(0);
       for (i=0; i < numVectors; i++)
         {
-        s = newScalars->GetComponent(i,0);
-        s /= maxScalar;
-        newScalars->SetComponent(i,0,s);
+        s[i] = static_cast<float>(s[i] / maxScalar);
         }
       }
 
@@ -132,30 +287,22 @@ int vtkVectorNorm::RequestData(
     newScalars->SetNumberOfTuples(numVectors);
 
     progressInterval=numVectors/10+1;
-    for (maxScalar=0.0, i=0; i < numVectors && !abort; i++)
+    for (maxScalar=0.0, i=0; i < numVectors && !abort; i += progressInterval)
       {
-      cellVectors->GetTuple(i, v);
-      s = sqrt((double)v[0]*v[0] + v[1]*v[1] + v[2]*v[2]);
-      if ( s > maxScalar )
-        {
-        maxScalar = s;
-        }
-      newScalars->SetComponent(i,0,s);
-      if ( ! (i % progressInterval) ) 
-        {
-        vtkDebugMacro(<<"Computing cell vector norm #" << i);
-        this->UpdateProgress (0.5+0.5*i/numVectors);
-        }
+      vtkDebugMacro(<<"Computing cell vector norm #" << i);
+      this->UpdateProgress (0.5+0.5*i/numVectors);
+      vtkVectorNormExecute(cellVectors, newScalars, i,
+                           (numVectors - i > progressInterval ?
+                            i + progressInterval : numVectors), maxScalar);
       }
 
     // If necessary, normalize
     if ( this->Normalize && maxScalar > 0.0 )
       {
+      s = newScalars->GetPointer(0);
       for (i=0; i < numVectors; i++)
         {
-        s = newScalars->GetComponent(i,0);
-        s /= maxScalar;
-        newScalars->SetComponent(i,0,s);
+        s[i] = static_cast<float>(s[i] / maxScalar);
         }
       }
 
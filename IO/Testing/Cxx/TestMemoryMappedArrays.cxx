@@ -0,0 +1,252 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestMemoryMappedArrays.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME
+// .SECTION Description
+// Writes a raw volume and an XML image file with raw appended data, reads
+// them back with MemoryMapArrays on, and checks that the arrays are
+// mapped, hold the right values and that modifying them does not modify
+// the files.
+
+#include "vtkFloatArray.h"
+#include "vtkImageData.h"
+#include "vtkImageReader2.h"
+#include "vtkPointData.h"
+#include "vtkSmartPointer.h"
+#include "vtkTestUtilities.h"
+#include "vtkUnsignedCharArray.h"
+#include "vtkXMLImageDataReader.h"
+#include "vtkXMLImageDataWriter.h"
+
+#include <vtkstd/string>
+
+#define DIM_X 16
+#define DIM_Y 12
+#define DIM_Z 5
+#define HEADER_SIZE 16
+
+static float ExpectedValue(vtkIdType i)
+{
+  return 0.5f*static_cast<float>(i) - 7.0f;
+}
+
+static int CheckValues(vtkDataArray *array, vtkIdType first,
+                       vtkIdType numberOfValues, const char *what)
+{
+  if (!array || array->GetNumberOfTuples() != numberOfValues)
+    {
+    cerr << what << ": wrong number of values" << endl;
+    return 0;
+    }
+  for (vtkIdType i = 0; i < numberOfValues; i++)
+    {
+    if (array->GetTuple1(i) != ExpectedValue(first + i))
+      {
+      cerr << what << ": wrong value at " << i << endl;
+      return 0;
+      }
+    }
+  return 1;
+}
+
+// Read the raw volume with vtkImageReader2.
+static vtkImageReader2 *NewRawReader(const char *fileName, int map)
+{
+  vtkImageReader2 *reader = vtkImageReader2::New();
+  reader->SetFileName(fileName);
+  reader->SetDataScalarTypeToFloat();
+  reader->SetDataExtent(0, DIM_X-1, 0, DIM_Y-1, 0, DIM_Z-1);
+  reader->SetFileDimensionality(3);
+  reader->SetHeaderSize(HEADER_SIZE);
+  reader->FileLowerLeftOn();
+  reader->SetMemoryMapArrays(map);
+  return reader;
+}
+
+static int TestRawFile(const char *fileName)
+{
+  const vtkIdType numberOfValues = DIM_X*DIM_Y*DIM_Z;
+  const vtkIdType sliceSize = DIM_X*DIM_Y;
+
+  ofstream file(fileName, ios::out | ios::binary);
+  char header[HEADER_SIZE] = { 0 };
+  file.write(header, HEADER_SIZE);
+  for (vtkIdType i = 0; i < numberOfValues; i++)
+    {
+    float value = ExpectedValue(i);
+    file.write(reinterpret_cast<char *>(&value), sizeof(float));
+    }
+  file.close();
+
+  vtkImageReader2 *reader = NewRawReader(fileName, 1);
+  reader->Update();
+  vtkDataArray *scalars = reader->GetOutput()->GetPointData()->GetScalars();
+  if (!scalars || !scalars->IsMapped())
+    {
+    cerr << "vtkImageReader2 did not map the volume" << endl;
+    reader->Delete();
+    return 0;
+    }
+  if (!CheckValues(scalars, 0, numberOfValues, "vtkImageReader2"))
+    {
+    reader->Delete();
+    return 0;
+    }
+
+  // Pages are copied on write.
+  scalars->SetTuple1(0, 1234.0);
+  if (scalars->GetTuple1(0) != 1234.0)
+    {
+    cerr << "Could not modify the mapped volume" << endl;
+    reader->Delete();
+    return 0;
+    }
+
+  reader->Delete();
+
+  // A range of slices is mapped at its offset in the file.
+  reader = NewRawReader(fileName, 1);
+  reader->UpdateInformation();
+  reader->GetOutput()->SetUpdateExtent(0, DIM_X-1, 0, DIM_Y-1, 2, 3);
+  reader->Update();
+  scalars = reader->GetOutput()->GetPointData()->GetScalars();
+  int ok = (scalars && scalars->IsMapped() &&
+            CheckValues(scalars, 2*sliceSize, 2*sliceSize,
+                        "vtkImageReader2 slices"));
+  reader->Delete();
+  if (!ok)
+    {
+    return 0;
+    }
+
+  // Partial rows cannot be mapped and are read as usual.
+  reader = NewRawReader(fileName, 1);
+  reader->UpdateInformation();
+  reader->GetOutput()->SetUpdateExtent(1, DIM_X-1, 0, DIM_Y-1, 0, 0);
+  reader->Update();
+  scalars = reader->GetOutput()->GetPointData()->GetScalars();
+  ok = (scalars && !scalars->IsMapped() &&
+        scalars->GetTuple1(0) == ExpectedValue(1));
+  reader->Delete();
+  if (!ok)
+    {
+    cerr << "Partial rows were not read" << endl;
+    return 0;
+    }
+
+  // The file itself was not modified.
+  reader = NewRawReader(fileName, 0);
+  reader->Update();
+  scalars = reader->GetOutput()->GetPointData()->GetScalars();
+  ok = (scalars && !scalars->IsMapped() &&
+        CheckValues(scalars, 0, numberOfValues, "Raw file"));
+  reader->Delete();
+  return ok;
+}
+
+static int TestXMLFile(const char *fileName)
+{
+  const vtkIdType numberOfValues = DIM_X*DIM_Y*DIM_Z;
+
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(DIM_X, DIM_Y, DIM_Z);
+  vtkSmartPointer<vtkFloatArray> floats =
+    vtkSmartPointer<vtkFloatArray>::New();
+  vtkSmartPointer<vtkUnsignedCharArray> bytes =
+    vtkSmartPointer<vtkUnsignedCharArray>::New();
+  floats->SetName("floats");
+  bytes->SetName("bytes");
+  floats->SetNumberOfTuples(numberOfValues);
+  bytes->SetNumberOfTuples(numberOfValues);
+  for (vtkIdType i = 0; i < numberOfValues; i++)
+    {
+    floats->SetValue(i, ExpectedValue(i));
+    bytes->SetValue(i, static_cast<unsigned char>(i % 251));
+    }
+  image->GetPointData()->AddArray(bytes);
+  image->GetPointData()->AddArray(floats);
+
+  vtkSmartPointer<vtkXMLImageDataWriter> writer =
+    vtkSmartPointer<vtkXMLImageDataWriter>::New();
+  writer->SetInput(image);
+  writer->SetFileName(fileName);
+  writer->SetDataModeToAppended();
+  writer->EncodeAppendedDataOff();
+  writer->SetCompressor(0);
+  if (!writer->Write())
+    {
+    cerr << "Could not write " << fileName << endl;
+    return 0;
+    }
+
+  vtkSmartPointer<vtkXMLImageDataReader> reader =
+    vtkSmartPointer<vtkXMLImageDataReader>::New();
+  reader->SetFileName(fileName);
+  reader->MemoryMapArraysOn();
+  reader->Update();
+  vtkPointData *pd = reader->GetOutput()->GetPointData();
+
+  // Single bytes are always aligned, floats only when their offset in
+  // the file happens to be.
+  vtkDataArray *readBytes = pd->GetArray("bytes");
+  if (!readBytes || !readBytes->IsMapped() ||
+      readBytes->GetNumberOfTuples() != numberOfValues)
+    {
+    cerr << "vtkXMLImageDataReader did not map the bytes" << endl;
+    return 0;
+    }
+  for (vtkIdType i = 0; i < numberOfValues; i++)
+    {
+    if (readBytes->GetTuple1(i) != i % 251)
+      {
+      cerr << "vtkXMLImageDataReader: wrong byte at " << i << endl;
+      return 0;
+      }
+    }
+  if (!CheckValues(pd->GetArray("floats"), 0, numberOfValues,
+                   "vtkXMLImageDataReader"))
+    {
+    return 0;
+    }
+
+  readBytes->SetTuple1(0, 200);
+  vtkSmartPointer<vtkXMLImageDataReader> check =
+    vtkSmartPointer<vtkXMLImageDataReader>::New();
+  check->SetFileName(fileName);
+  check->Update();
+  readBytes = check->GetOutput()->GetPointData()->GetArray("bytes");
+  if (!readBytes || readBytes->IsMapped() || readBytes->GetTuple1(0) != 0)
+    {
+    cerr << "The XML file was modified" << endl;
+    return 0;
+    }
+  return 1;
+}
+
+int TestMemoryMappedArrays(int argc, char *argv[])
+{
+  char *tempDir = vtkTestUtilities::GetArgOrEnvOrDefault(
+    "-T", argc, argv, "VTK_TEMP_DIR", "Testing/Temporary");
+  vtkstd::string rawFile = tempDir;
+  rawFile += "/TestMemoryMappedArrays.raw";
+  vtkstd::string xmlFile = tempDir;
+  xmlFile += "/TestMemoryMappedArrays.vti";
+  delete [] tempDir;
+
+  if (!TestRawFile(rawFile.c_str()) || !TestXMLFile(xmlFile.c_str()))
+    {
+    return 1;
+    }
+  return 0;
+}
@@ -26,6 +26,8 @@
 
 #include <sys/stat.h>
 
+#include <vtkstd/string>
+
 vtkStandardNewMacro(vtkImageReader2);
 
 #ifdef read
@@ -71,6 +73,7 @@ vtkImageReader2::vtkImageReader2()
   // Left over from short reader
   this->SwapBytes = 0;
   this->FileLowerLeft = 0;
+  this->MemoryMapArrays = 0;
   this->FileDimensionality = 2;
   this->SetNumberOfInputPorts(0);
 }
@@ -450,6 +453,8 @@ void vtkImageReader2::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "File Lower Left: " << 
     (this->FileLowerLeft ? "On\n" : "Off\n");
 
+  os << indent << "MemoryMapArrays: " << this->MemoryMapArrays << "\n";
+
   os << indent << "Swap Bytes: " << (this->SwapBytes ? "On\n" : "Off\n");
 
   os << indent << "DataIncrements: (" << this->DataIncrements[0];
@@ -797,7 +802,13 @@ void vtkImageReader2Update(vtkImageReader2 *self, vtkImageData *data, OT *outPtr
 // are assumed to be the same as the file extent/order.
 void vtkImageReader2::ExecuteData(vtkDataObject *output)
 {
-  vtkImageData *data = this->AllocateOutputData(output);
+  vtkImageData *data = vtkImageData::SafeDownCast(output);
+  if (this->MemoryMapArrays && data && this->MapOutputData(data))
+    {
+    return;
+    }
+
+  data = this->AllocateOutputData(output);
   
   void *ptr;
   int *ext;
@@ -828,6 +839,90 @@ void vtkImageReader2::ExecuteData(vtkDataObject *output)
 }
 
 
+//----------------------------------------------------------------------------
+// Map the requested extent of the file when it is one contiguous block
+// laid out as in memory.
+int vtkImageReader2::MapOutputData(vtkImageData *data)
+{
+  vtkStreamingDemandDrivenPipeline *sddp =
+    vtkStreamingDemandDrivenPipeline::SafeDownCast(this->GetExecutive());
+  if (!sddp || sddp->GetNumberOfOutputPorts() != 1 ||
+      !this->FileLowerLeft || this->SwapBytes ||
+      (!this->FileName && !this->FilePattern))
+    {
+    return 0;
+    }
+
+  int ext[6];
+  sddp->GetOutputInformation(0)->Get(
+    vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), ext);
+
+  // Rows must be whole, and so must slices unless there is only one.
+  if (ext[0] != this->DataExtent[0] || ext[1] != this->DataExtent[1] ||
+      ext[0] > ext[1] || ext[2] > ext[3] || ext[4] > ext[5])
+    {
+    return 0;
+    }
+  int dim = this->GetFileDimensionality();
+  if (ext[4] != ext[5] &&
+      (dim != 3 ||
+       ext[2] != this->DataExtent[2] || ext[3] != this->DataExtent[3]))
+    {
+    return 0;
+    }
+  if (dim != 2 && dim != 3)
+    {
+    return 0;
+    }
+
+  this->ComputeDataIncrements();
+  this->ComputeInternalFileName(dim == 3 ? 0 : ext[4]);
+  if (!this->OpenFile())
+    {
+    return 0;
+    }
+  // SeekFile() may recompute the internal file name, keep the one opened.
+  vtkstd::string fileName = this->InternalFileName;
+  this->SeekFile(ext[0], ext[2], ext[4]);
+  vtkTypeInt64 offset = static_cast<vtkTypeInt64>(this->File->tellg());
+  this->File->close();
+  delete this->File;
+  this->File = NULL;
+  if (offset < 0)
+    {
+    return 0;
+    }
+
+  vtkDataArray *array = vtkDataArray::CreateDataArray(this->DataScalarType);
+  if (!array)
+    {
+    return 0;
+    }
+  int numComponents = this->NumberOfScalarComponents;
+  vtkIdType numValues = static_cast<vtkIdType>(ext[1] - ext[0] + 1) *
+    (ext[3] - ext[2] + 1) * (ext[5] - ext[4] + 1) * numComponents;
+  array->SetNumberOfComponents(numComponents);
+  if (offset % array->GetDataTypeSize() != 0 ||
+      !array->MapFile(fileName.c_str(), offset, numValues,
+                      vtkDataArray::VTK_DATA_ARRAY_MAP_COPY_ON_WRITE))
+    {
+    array->Delete();
+    return 0;
+    }
+
+  vtkDebugMacro("Mapping extent: " << ext[0] << ", " << ext[1] << ", "
+                << ext[2] << ", " << ext[3] << ", " << ext[4] << ", "
+                << ext[5] << " of " << fileName.c_str());
+
+  data->SetExtent(ext);
+  data->SetScalarType(this->DataScalarType);
+  data->SetNumberOfScalarComponents(numComponents);
+  array->SetName("ImageFile");
+  data->GetPointData()->SetScalars(array);
+  array->Delete();
+  return 1;
+}
+
 //----------------------------------------------------------------------------
 // Set the data type of pixels in the file.  
 // If you want the output scalar type to have a different value, set it
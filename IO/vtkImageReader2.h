@@ -181,6 +181,17 @@ public:
   vtkGetMacro(FileLowerLeft, int);
   vtkSetMacro(FileLowerLeft, int);
 
+  // Description:
+  // When on, the output scalars are mapped straight from the file
+  // (copy-on-write) instead of being read into memory, so that only the
+  // pages actually used are loaded. This is only done when the file
+  // layout matches the memory layout: FileLowerLeft on, no byte
+  // swapping, whole rows and slices requested, and values aligned in
+  // the file. Otherwise the file is read as usual. Off by default.
+  vtkSetMacro(MemoryMapArrays, int);
+  vtkGetMacro(MemoryMapArrays, int);
+  vtkBooleanMacro(MemoryMapArrays, int);
+
   // Description:
   // Set/Get the internal file name
   virtual void ComputeInternalFileName(int slice);
@@ -226,6 +237,7 @@ protected:
   char *FilePattern;
   int NumberOfScalarComponents;
   int FileLowerLeft;
+  int MemoryMapArrays;
 
   ifstream *File;
   unsigned long DataIncrements[4];
@@ -249,6 +261,12 @@ protected:
   virtual void ExecuteInformation();
   virtual void ExecuteData(vtkDataObject *data);
   virtual void ComputeDataIncrements();
+
+  // Description:
+  // Map the update extent of the file into the scalars of the given
+  // output. Returns 0 when the extent cannot be mapped, in which case
+  // the output is left untouched.
+  int MapOutputData(vtkImageData *data);
 private:
   vtkImageReader2(const vtkImageReader2&);  // Not implemented.
   void operator=(const vtkImageReader2&);  // Not implemented.
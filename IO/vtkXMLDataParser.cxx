@@ -911,6 +911,50 @@ vtkXMLDataParser::ReadAppendedData(OffsetType offset,
   return this->ReadBinaryData(buffer, startWord, numWords, wordType);
 }
 
+//----------------------------------------------------------------------------
+vtkXMLDataParser::OffsetType
+vtkXMLDataParser::GetAppendedDataPosition(OffsetType offset,
+                                          OffsetType startWord,
+                                          OffsetType numWords,
+                                          int wordType)
+{
+  // Only raw data in the byte order of this machine is usable in place.
+#ifdef VTK_WORDS_BIGENDIAN
+  const int nativeByteOrder = vtkXMLDataParser::BigEndian;
+#else
+  const int nativeByteOrder = vtkXMLDataParser::LittleEndian;
+#endif
+  if(this->Compressor || this->ByteOrder != nativeByteOrder ||
+     !this->AppendedDataPosition ||
+     this->AppendedDataStream->IsA("vtkBase64InputStream"))
+    {
+    return -1;
+    }
+
+  // Read the length of the data to check the range of words.
+  HeaderType rsize;
+  const unsigned long len = sizeof(HeaderType);
+  this->DataStream = this->AppendedDataStream;
+  this->SeekG(this->AppendedDataPosition+offset);
+  this->DataStream->SetStream(this->Stream);
+  this->DataStream->StartReading();
+  unsigned long n =
+    this->DataStream->Read(reinterpret_cast<unsigned char*>(&rsize), len);
+  this->DataStream->EndReading();
+  if(n < len)
+    {
+    return -1;
+    }
+
+  OffsetType wordSize = this->GetWordTypeSize(wordType);
+  if(startWord < 0 || numWords < 0 ||
+     (startWord+numWords)*wordSize > static_cast<OffsetType>(rsize))
+    {
+    return -1;
+    }
+  return this->AppendedDataPosition + offset + len + startWord*wordSize;
+}
+
 //----------------------------------------------------------------------------
 //----------------------------------------------------------------------------
 // Define a parsing function template.  The extra "long" argument is used
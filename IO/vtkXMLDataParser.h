@@ -90,6 +90,15 @@ public:
   // stream.  Returns the number of words read.
   OffsetType ReadBinaryData(void* buffer, OffsetType startWord,
                             OffsetType maxWords, int wordType);
+
+  // Description:
+  // Get the position in the input stream of words of an appended data
+  // section that are stored raw, uncompressed and in the byte order of
+  // this machine, so that they can be mapped instead of read.  Returns -1
+  // when the words are encoded, compressed, swapped or out of range.
+  OffsetType GetAppendedDataPosition(OffsetType offset,
+                                     OffsetType startWord,
+                                     OffsetType numWords, int wordType);
   //ETX
 
   // Description:
@@ -40,6 +40,7 @@ vtkXMLDataReader::vtkXMLDataReader()
   this->NumberOfPointArrays = 0;
   this->NumberOfCellArrays = 0;
   this->InReadData = 0;
+  this->MemoryMapArrays = 0;
   
   // Setup a callback for when the XMLParser's data reading routines
   // report progress.
@@ -81,6 +82,8 @@ vtkXMLDataReader::~vtkXMLDataReader()
 void vtkXMLDataReader::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "MemoryMapArrays: "
+     << (this->MemoryMapArrays ? "On" : "Off") << "\n";
 }
 
 //----------------------------------------------------------------------------
@@ -756,6 +759,12 @@ int vtkXMLDataReader::ReadArrayValues(vtkXMLDataElement* da, vtkIdType arrayInde
     {
     return 0;
     }
+  // Whole arrays may be mapped from the file instead.
+  if (arrayIndex == 0 &&
+      this->MapArrayValues(da, array, startIndex, numValues))
+    {
+    return 1;
+    }
   this->InReadData = 1;
   int result;
   // All arrays types except vtkBitArray.
@@ -776,6 +785,33 @@ int vtkXMLDataReader::ReadArrayValues(vtkXMLDataElement* da, vtkIdType arrayInde
   return result;
 }
 
+//----------------------------------------------------------------------------
+int vtkXMLDataReader::MapArrayValues(vtkXMLDataElement* da,
+  vtkAbstractArray* array, vtkIdType startIndex, vtkIdType numValues)
+{
+  vtkDataArray* dataArray = vtkDataArray::SafeDownCast(array);
+  if (!this->MemoryMapArrays || !dataArray ||
+      dataArray->GetDataType() == VTK_BIT || !this->IsReadingFile() ||
+      numValues != dataArray->GetNumberOfTuples() *
+      dataArray->GetNumberOfComponents() ||
+      !da->GetAttribute("offset"))
+    {
+    return 0;
+    }
+
+  unsigned long offset = 0;
+  da->GetScalarAttribute("offset", offset);
+  vtkXMLDataParser::OffsetType position =
+    this->XMLParser->GetAppendedDataPosition(offset, startIndex, numValues,
+                                             dataArray->GetDataType());
+  if (position < 0 || position % dataArray->GetDataTypeSize() != 0)
+    {
+    return 0;
+    }
+  return dataArray->MapFile(this->FileName, position, numValues,
+                            vtkDataArray::VTK_DATA_ARRAY_MAP_COPY_ON_WRITE);
+}
+
 //----------------------------------------------------------------------------
 void vtkXMLDataReader::DataProgressCallbackFunction(vtkObject*, unsigned long,
                                                     void* clientdata, void*)
@@ -44,6 +44,17 @@ public:
   // SetupOutputInformation to outInfo
   virtual void CopyOutputInformation(vtkInformation *outInfo, int port);
 
+  // Description:
+  // When on, arrays stored whole in the raw appended data of a file,
+  // uncompressed and in the byte order of this machine, are mapped from
+  // the file instead of read: their values are read from disk when first
+  // accessed, and modifying them does not change the file (see
+  // vtkDataArray::MapFile()). Other arrays are read as usual. Off by
+  // default.
+  vtkSetMacro(MemoryMapArrays, int);
+  vtkGetMacro(MemoryMapArrays, int);
+  vtkBooleanMacro(MemoryMapArrays, int);
+
 protected:
   vtkXMLDataReader();
   ~vtkXMLDataReader();  
@@ -87,6 +98,12 @@ protected:
   // values will be put in the array.
   int ReadArrayValues(vtkXMLDataElement* da, vtkIdType arrayIndex, vtkAbstractArray* array,
     vtkIdType startIndex, vtkIdType numValues);
+
+  // Map the values of a whole array from the file when MemoryMapArrays
+  // is on and the values are stored in a form that allows it.  Returns 0
+  // if they must be read instead.
+  int MapArrayValues(vtkXMLDataElement* da, vtkAbstractArray* array,
+    vtkIdType startIndex, vtkIdType numValues);
     
 
   
@@ -114,6 +131,8 @@ protected:
   // Flag for whether DataProgressCallback should actually update
   // progress.
   int InReadData;
+
+  int MemoryMapArrays;
   
   // The observer to report progress from reading data from XMLParser.
   vtkCallbackCommand* DataProgressObserver;  
@@ -243,6 +243,12 @@ int vtkXMLReader::OpenVTKFile()
   return 1;
 }
 
+//----------------------------------------------------------------------------
+int vtkXMLReader::IsReadingFile()
+{
+  return this->FileStream && this->Stream == this->FileStream;
+}
+
 //----------------------------------------------------------------------------
 void vtkXMLReader::CloseVTKFile()
 {
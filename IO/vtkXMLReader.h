@@ -269,6 +269,10 @@ protected:
 
   vtkDataObject* GetCurrentOutput();
   vtkInformation* GetCurrentOutputInformation();
+
+  // Return 1 if the input is read from the file FileName, 0 if it is read
+  // from a stream given by the user.
+  int IsReadingFile();
   
 private:
   // The stream used to read the input if it is in a file.
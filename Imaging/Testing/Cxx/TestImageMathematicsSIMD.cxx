@@ -0,0 +1,174 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestImageMathematicsSIMD.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME
+// .SECTION Description
+// Runs the vtkImageMathematics operations that have a vectorized loop
+// (add, subtract, multiply, min and max) on float and double images, and
+// checks the outputs against the pixel operation computed here. Each
+// input starts at each offset from an aligned address and the odd row
+// lengths leave the output rows misaligned in turn, so the head, aligned,
+// unaligned and tail loops all run. Some values are equal in both inputs
+// to check which one min and max return.
+
+#include "vtkDataArray.h"
+#include "vtkImageData.h"
+#include "vtkImageMathematics.h"
+#include "vtkMath.h"
+#include "vtkPointData.h"
+#include "vtkSmartPointer.h"
+
+// Make a width x 3 x 2 image whose scalars start offset values past an
+// aligned address in storage.
+static vtkSmartPointer<vtkImageData> MakeImage(int dataType, int width,
+                                               int components, int offset,
+                                               vtkDataArray *storage)
+{
+  vtkIdType n = width*3*2*components;
+  storage->SetAlignment(16);
+  storage->SetNumberOfComponents(1);
+  storage->SetNumberOfTuples(n + 4);
+
+  vtkDataArray *scalars = vtkDataArray::CreateDataArray(dataType);
+  scalars->SetNumberOfComponents(components);
+  scalars->SetVoidArray(storage->GetVoidPointer(offset), n, 1);
+
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetExtent(0, width - 1, 0, 2, 0, 1);
+  image->SetScalarType(dataType);
+  image->SetNumberOfScalarComponents(components);
+  image->GetPointData()->SetScalars(scalars);
+  scalars->Delete();
+  return image;
+}
+
+// The pixel operation of vtkImageMathematics, in the image type.
+template <class T>
+static T PixelOperation(int op, T in1, T in2)
+{
+  switch (op)
+    {
+    case VTK_ADD:
+      return in1 + in2;
+    case VTK_SUBTRACT:
+      return in1 - in2;
+    case VTK_MULTIPLY:
+      return in1 * in2;
+    case VTK_MIN:
+      return (in1 < in2) ? in1 : in2;
+    default:
+      return (in1 > in2) ? in1 : in2;
+    }
+}
+
+template <class T>
+static int TestOperation(int dataType, int op, int width, int components,
+                         int offset1, int offset2, T *)
+{
+  vtkSmartPointer<vtkDataArray> storage1;
+  storage1.TakeReference(vtkDataArray::CreateDataArray(dataType));
+  vtkSmartPointer<vtkDataArray> storage2;
+  storage2.TakeReference(vtkDataArray::CreateDataArray(dataType));
+  vtkSmartPointer<vtkImageData> image1 =
+    MakeImage(dataType, width, components, offset1, storage1);
+  vtkSmartPointer<vtkImageData> image2 =
+    MakeImage(dataType, width, components, offset2, storage2);
+
+  T *in1 = static_cast<T *>(image1->GetScalarPointer());
+  T *in2 = static_cast<T *>(image2->GetScalarPointer());
+  vtkIdType n = width*3*2*components;
+  vtkIdType i;
+  for (i = 0; i < n; i++)
+    {
+    in1[i] = static_cast<T>(vtkMath::Random(-1000.0, 1000.0));
+    in2[i] = (i % 5 == 0) ? in1[i] :
+      static_cast<T>(vtkMath::Random(-1000.0, 1000.0));
+    }
+
+  vtkSmartPointer<vtkImageMathematics> math =
+    vtkSmartPointer<vtkImageMathematics>::New();
+  math->SetInput1(image1);
+  math->SetInput2(image2);
+  math->SetOperation(op);
+  math->Update();
+
+  vtkImageData *output = math->GetOutput();
+  if (output->GetScalarType() != dataType ||
+      output->GetPointData()->GetScalars()->GetNumberOfTuples() * components
+      != n)
+    {
+    cerr << "Wrong output for operation " << op << endl;
+    return 0;
+    }
+  T *out = static_cast<T *>(output->GetScalarPointer());
+  for (i = 0; i < n; i++)
+    {
+    if (out[i] != PixelOperation(op, in1[i], in2[i]))
+      {
+      cerr << "Wrong value for operation " << op << " on "
+           << vtkImageScalarTypeNameMacro(dataType) << " width " << width
+           << " components " << components << " offsets " << offset1
+           << " " << offset2 << " at " << i << ": " << out[i] << " instead of "
+           << PixelOperation(op, in1[i], in2[i]) << endl;
+      return 0;
+      }
+    }
+  return 1;
+}
+
+template <class T>
+static int TestOperations(int dataType, int numOffsets, T *)
+{
+  static const int ops[] = { VTK_ADD, VTK_SUBTRACT, VTK_MULTIPLY,
+                             VTK_MIN, VTK_MAX };
+  static const int numOps = sizeof(ops) / sizeof(ops[0]);
+  static const int widths[] = { 1, 2, 3, 4, 5, 7, 13, 64, 67 };
+  static const int numWidths = sizeof(widths) / sizeof(widths[0]);
+
+  for (int o = 0; o < numOps; o++)
+    {
+    for (int w = 0; w < numWidths; w++)
+      {
+      for (int components = 1; components <= 3; components += 2)
+        {
+        for (int offset1 = 0; offset1 < numOffsets; offset1++)
+          {
+          for (int offset2 = 0; offset2 < numOffsets; offset2++)
+            {
+            if (!TestOperation(dataType, ops[o], widths[w], components,
+                               offset1, offset2, static_cast<T *>(0)))
+              {
+              return 0;
+              }
+            }
+          }
+        }
+      }
+    }
+  return 1;
+}
+
+int TestImageMathematicsSIMD(int, char *[])
+{
+  // Allocate the outputs aligned, as the rows start on the alignment
+  // boundaries the image dimensions allow.
+  int alignment = vtkDataArray::GetGlobalAlignment();
+  vtkDataArray::SetGlobalAlignment(16);
+
+  int status = TestOperations(VTK_FLOAT, 4, static_cast<float *>(0)) &&
+    TestOperations(VTK_DOUBLE, 2, static_cast<double *>(0));
+
+  vtkDataArray::SetGlobalAlignment(alignment);
+  return !status;
+}
@@ -0,0 +1,152 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestImageShiftScaleSIMD.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME
+// .SECTION Description
+// Shifts and scales float and double images with vtkImageShiftScale,
+// unclamped (the vectorized loop where there is one) and clamped (the
+// scalar loop), and checks that both give the value of the pixel
+// operation. The inputs start at each offset from an aligned address and
+// the odd row lengths leave the output rows misaligned in turn, so the
+// head, aligned, unaligned and tail loops all run.
+
+#include "vtkDataArray.h"
+#include "vtkImageData.h"
+#include "vtkImageShiftScale.h"
+#include "vtkMath.h"
+#include "vtkPointData.h"
+#include "vtkSmartPointer.h"
+
+// Make a width x 3 x 2 image whose scalars start offset values past an
+// aligned address in storage.
+static vtkSmartPointer<vtkImageData> MakeImage(int dataType, int width,
+                                               int components, int offset,
+                                               vtkDataArray *storage)
+{
+  vtkIdType n = width*3*2*components;
+  storage->SetAlignment(16);
+  storage->SetNumberOfComponents(1);
+  storage->SetNumberOfTuples(n + 4);
+
+  vtkDataArray *scalars = vtkDataArray::CreateDataArray(dataType);
+  scalars->SetNumberOfComponents(components);
+  scalars->SetVoidArray(storage->GetVoidPointer(offset), n, 1);
+  for (vtkIdType i = 0; i < n; i++)
+    {
+    scalars->SetComponent(i / components, i % components,
+                          vtkMath::Random(-1000.0, 1000.0));
+    }
+
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetExtent(0, width - 1, 0, 2, 0, 1);
+  image->SetScalarType(dataType);
+  image->SetNumberOfScalarComponents(components);
+  image->GetPointData()->SetScalars(scalars);
+  scalars->Delete();
+  return image;
+}
+
+static int TestShiftScale(int dataType, int width, int components,
+                          int offset)
+{
+  const double shift = -0.3;
+  const double scale = 7.1;
+
+  vtkSmartPointer<vtkDataArray> storage;
+  storage.TakeReference(vtkDataArray::CreateDataArray(dataType));
+  vtkSmartPointer<vtkImageData> image =
+    MakeImage(dataType, width, components, offset, storage);
+
+  vtkSmartPointer<vtkImageShiftScale> unclamped =
+    vtkSmartPointer<vtkImageShiftScale>::New();
+  unclamped->SetInput(image);
+  unclamped->SetShift(shift);
+  unclamped->SetScale(scale);
+  unclamped->SetOutputScalarType(dataType);
+  unclamped->ClampOverflowOff();
+  unclamped->Update();
+
+  vtkSmartPointer<vtkImageShiftScale> clamped =
+    vtkSmartPointer<vtkImageShiftScale>::New();
+  clamped->SetInput(image);
+  clamped->SetShift(shift);
+  clamped->SetScale(scale);
+  clamped->SetOutputScalarType(dataType);
+  clamped->ClampOverflowOn();
+  clamped->Update();
+
+  vtkDataArray *in = image->GetPointData()->GetScalars();
+  vtkDataArray *out1 = unclamped->GetOutput()->GetPointData()->GetScalars();
+  vtkDataArray *out2 = clamped->GetOutput()->GetPointData()->GetScalars();
+  if (!out1 || !out2 ||
+      out1->GetNumberOfTuples() != in->GetNumberOfTuples() ||
+      out2->GetNumberOfTuples() != in->GetNumberOfTuples())
+    {
+    cerr << "Wrong output size" << endl;
+    return 0;
+    }
+
+  for (vtkIdType i = 0; i < in->GetNumberOfTuples(); i++)
+    {
+    for (int c = 0; c < components; c++)
+      {
+      double value = (in->GetComponent(i, c) + shift) * scale;
+      if (dataType == VTK_FLOAT)
+        {
+        value = static_cast<float>(value);
+        }
+      if (out1->GetComponent(i, c) != value ||
+          out2->GetComponent(i, c) != value)
+        {
+        cerr << "Wrong value for " << vtkImageScalarTypeNameMacro(dataType)
+             << " width " << width << " components " << components
+             << " offset " << offset << " at " << i << ": "
+             << out1->GetComponent(i, c) << " (unclamped) "
+             << out2->GetComponent(i, c) << " (clamped) " << value
+             << " (expected)" << endl;
+        return 0;
+        }
+      }
+    }
+  return 1;
+}
+
+int TestImageShiftScaleSIMD(int, char *[])
+{
+  // Allocate the outputs aligned, as the rows start on the alignment
+  // boundaries the image dimensions allow.
+  int alignment = vtkDataArray::GetGlobalAlignment();
+  vtkDataArray::SetGlobalAlignment(16);
+
+  static const int widths[] = { 1, 2, 3, 4, 5, 7, 13, 64, 67 };
+  static const int numWidths = sizeof(widths) / sizeof(widths[0]);
+  int status = 1;
+  for (int w = 0; status && w < numWidths; w++)
+    {
+    for (int components = 1; status && components <= 3; components += 2)
+      {
+      for (int offset = 0; status && offset < 4; offset++)
+        {
+        status = TestShiftScale(VTK_FLOAT, widths[w], components, offset);
+        }
+      for (int offset = 0; status && offset < 2; offset++)
+        {
+        status = TestShiftScale(VTK_DOUBLE, widths[w], components, offset);
+        }
+      }
+    }
+
+  vtkDataArray::SetGlobalAlignment(alignment);
+  return !status;
+}
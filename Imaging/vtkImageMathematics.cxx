@@ -18,6 +18,7 @@
 #include "vtkImageData.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkSIMD.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 
 #include <math.h>
@@ -232,6 +233,170 @@ void vtkImageMathematicsExecute1(vtkImageMathematics *self,
 
 
 
+//----------------------------------------------------------------------------
+// Vectorized rows for the two input operations that have them.  They
+// give the same values as the pixel loop of vtkImageMathematicsExecute2
+// and return the number of values computed: the whole row, or 0 when the
+// type or the operation is left to the pixel loop.
+template <class T>
+static int vtkImageMathematicsSpan2(int, const T*, const T*, T*, int)
+{
+  return 0;
+}
+
+#ifdef VTK_USE_SSE2
+//----------------------------------------------------------------------------
+// The SSE2 instructions for four floats or two doubles at a time.
+struct vtkImageMathematicsFloatSSE2
+{
+  typedef float Scalar;
+  typedef __m128 Vector;
+  enum { Width = 4 };
+  static Vector Load(const float *p) { return _mm_load_ps(p); }
+  static Vector LoadU(const float *p) { return _mm_loadu_ps(p); }
+  static void Store(float *p, Vector v) { _mm_store_ps(p, v); }
+  static Vector Add(Vector a, Vector b) { return _mm_add_ps(a, b); }
+  static Vector Sub(Vector a, Vector b) { return _mm_sub_ps(a, b); }
+  static Vector Mul(Vector a, Vector b) { return _mm_mul_ps(a, b); }
+  static Vector Min(Vector a, Vector b) { return _mm_min_ps(a, b); }
+  static Vector Max(Vector a, Vector b) { return _mm_max_ps(a, b); }
+};
+
+struct vtkImageMathematicsDoubleSSE2
+{
+  typedef double Scalar;
+  typedef __m128d Vector;
+  enum { Width = 2 };
+  static Vector Load(const double *p) { return _mm_load_pd(p); }
+  static Vector LoadU(const double *p) { return _mm_loadu_pd(p); }
+  static void Store(double *p, Vector v) { _mm_store_pd(p, v); }
+  static Vector Add(Vector a, Vector b) { return _mm_add_pd(a, b); }
+  static Vector Sub(Vector a, Vector b) { return _mm_sub_pd(a, b); }
+  static Vector Mul(Vector a, Vector b) { return _mm_mul_pd(a, b); }
+  static Vector Min(Vector a, Vector b) { return _mm_min_pd(a, b); }
+  static Vector Max(Vector a, Vector b) { return _mm_max_pd(a, b); }
+};
+
+//----------------------------------------------------------------------------
+// The operations, one value or one vector at a time.  Min and max
+// return the second value when the first is not smaller (larger), as the
+// pixel loop and the SSE2 instructions do.
+template <class S, int op>
+inline typename S::Scalar vtkImageMathematicsScalarOp(typename S::Scalar a,
+                                                      typename S::Scalar b)
+{
+  switch (op)
+    {
+    case VTK_ADD:
+      return a + b;
+    case VTK_SUBTRACT:
+      return a - b;
+    case VTK_MULTIPLY:
+      return a * b;
+    case VTK_MIN:
+      return (a < b) ? a : b;
+    default:
+      return (a > b) ? a : b;
+    }
+}
+
+template <class S, int op>
+inline typename S::Vector vtkImageMathematicsVectorOp(typename S::Vector a,
+                                                      typename S::Vector b)
+{
+  switch (op)
+    {
+    case VTK_ADD:
+      return S::Add(a, b);
+    case VTK_SUBTRACT:
+      return S::Sub(a, b);
+    case VTK_MULTIPLY:
+      return S::Mul(a, b);
+    case VTK_MIN:
+      return S::Min(a, b);
+    default:
+      return S::Max(a, b);
+    }
+}
+
+//----------------------------------------------------------------------------
+// One row: scalar values up to the first aligned output value, then
+// vectors, with aligned loads when the inputs are aligned as well.
+template <class S, int op>
+static int vtkImageMathematicsSSE2Row(const typename S::Scalar *in1,
+                                      const typename S::Scalar *in2,
+                                      typename S::Scalar *out, int n)
+{
+  int i = 0;
+  for (; i < n && !vtkSIMDIsAligned(out + i, 16); ++i)
+    {
+    out[i] = vtkImageMathematicsScalarOp<S, op>(in1[i], in2[i]);
+    }
+
+  if (vtkSIMDIsAligned(in1 + i, 16) && vtkSIMDIsAligned(in2 + i, 16))
+    {
+    for (; i + S::Width <= n; i += S::Width)
+      {
+      S::Store(out + i, vtkImageMathematicsVectorOp<S, op>(
+                 S::Load(in1 + i), S::Load(in2 + i)));
+      }
+    }
+  else
+    {
+    for (; i + S::Width <= n; i += S::Width)
+      {
+      S::Store(out + i, vtkImageMathematicsVectorOp<S, op>(
+                 S::LoadU(in1 + i), S::LoadU(in2 + i)));
+      }
+    }
+
+  for (; i < n; ++i)
+    {
+    out[i] = vtkImageMathematicsScalarOp<S, op>(in1[i], in2[i]);
+    }
+  return n;
+}
+
+//----------------------------------------------------------------------------
+template <class S>
+static int vtkImageMathematicsSSE2Span2(int op,
+                                        const typename S::Scalar *in1,
+                                        const typename S::Scalar *in2,
+                                        typename S::Scalar *out, int n)
+{
+  switch (op)
+    {
+    case VTK_ADD:
+      return vtkImageMathematicsSSE2Row<S, VTK_ADD>(in1, in2, out, n);
+    case VTK_SUBTRACT:
+      return vtkImageMathematicsSSE2Row<S, VTK_SUBTRACT>(in1, in2, out, n);
+    case VTK_MULTIPLY:
+      return vtkImageMathematicsSSE2Row<S, VTK_MULTIPLY>(in1, in2, out, n);
+    case VTK_MIN:
+      return vtkImageMathematicsSSE2Row<S, VTK_MIN>(in1, in2, out, n);
+    case VTK_MAX:
+      return vtkImageMathematicsSSE2Row<S, VTK_MAX>(in1, in2, out, n);
+    }
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+static int vtkImageMathematicsSpan2(int op, const float *in1,
+                                    const float *in2, float *out, int n)
+{
+  return vtkImageMathematicsSSE2Span2<vtkImageMathematicsFloatSSE2>(
+    op, in1, in2, out, n);
+}
+
+//----------------------------------------------------------------------------
+static int vtkImageMathematicsSpan2(int op, const double *in1,
+                                    const double *in2, double *out, int n)
+{
+  return vtkImageMathematicsSSE2Span2<vtkImageMathematicsDoubleSSE2>(
+    op, in1, in2, out, n);
+}
+#endif
+
 //----------------------------------------------------------------------------
 // This templated function executes the filter for any type of data.
 // Handles the two input operations
@@ -286,7 +451,12 @@ void vtkImageMathematicsExecute2(vtkImageMathematics *self,
           }
         count++;
         }
-      for (idxR = 0; idxR < rowLength; idxR++)
+      // The pixel loop does what the vectorized row did not.
+      idxR = vtkImageMathematicsSpan2(op, in1Ptr, in2Ptr, outPtr, rowLength);
+      outPtr += idxR;
+      in1Ptr += idxR;
+      in2Ptr += idxR;
+      for (; idxR < rowLength; idxR++)
         {
         // Pixel operation
         switch (op)